@@ -1,6 +1,8 @@
 #include "Application.h"
 
 #include "CommandQueue.h"
+#include "ComputePipelineLibrary.h"
+#include "GeometryArena.h"
 #include "Game.h"
 #include "DescriptorAllocator.h"
 #include "Window.h"
@@ -77,6 +79,8 @@ void Application::Initialize()
 	{
 		mDescriptorAllocators[i] = std::make_unique<DescriptorAllocator>(static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i));
 	}
+	mComputePipelineLibrary = std::make_unique<ComputePipelineLibrary>();
+	mGeometryArena = std::make_unique<GeometryArena>();
 	msFrameCount = 0;
 }
 
@@ -108,6 +112,8 @@ void Application::Destroy()
 Application::~Application()
 {
 	Flush();
+	mGeometryArena.reset();
+	mComputePipelineLibrary.reset();
 }
 
 ComPtr<IDXGIAdapter4> Application::GetAdapter(bool bUseWarp)
@@ -350,6 +356,16 @@ UINT Application::GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE ty
 	return mDevice->GetDescriptorHandleIncrementSize(type);
 }
 
+ComputePipelineLibrary& Application::GetComputePipelineLibrary() const
+{
+	return *mComputePipelineLibrary;
+}
+
+GeometryArena& Application::GetGeometryArena() const
+{
+	return *mGeometryArena;
+}
+
 static void RemoveWindow(HWND hWnd)
 {
 	WindowMap::iterator windowIter = gsWindows.find(hWnd);
@@ -5,6 +5,8 @@
 #include "DescriptorAllocationBlock.h"
 
 class CommandQueue;
+class ComputePipelineLibrary;
+class GeometryArena;
 class DescriptorAllocator;
 class Game;
 class Window;
@@ -30,6 +32,8 @@ public:
 	void ReleaseTheUsedDescriptors(uint64_t finishedFrame);
 	ComPtr<ID3D12DescriptorHeap> CreateDescriptorHeap(UINT numDescriptors, D3D12_DESCRIPTOR_HEAP_TYPE type);
 	UINT GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE type) const;
+	ComputePipelineLibrary& GetComputePipelineLibrary() const;
+	GeometryArena& GetGeometryArena() const;
 
 	static uint64_t GetFrameCount()
 	{
@@ -58,6 +62,8 @@ private:
 	std::shared_ptr<CommandQueue> mCopyCommandQueue;
 
 	std::unique_ptr<DescriptorAllocator> mDescriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
+	std::unique_ptr<ComputePipelineLibrary> mComputePipelineLibrary;
+	std::unique_ptr<GeometryArena> mGeometryArena;
 
 	bool mTearingSupported;
 	static uint64_t msFrameCount;
@@ -0,0 +1,244 @@
+#include "AtlasPacker.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+SkylinePacker::SkylinePacker(uint32_t width, uint32_t height) : mWidth(width), mHeight(height), mUsedArea(0)
+{
+	mSkyline.push_back({ 0, 0, width });
+}
+
+bool SkylinePacker::Insert(uint32_t width, uint32_t height, AtlasRect& rect)
+{
+	size_t bestIndex = mSkyline.size();
+	uint32_t bestY = UINT32_MAX;
+	uint32_t bestWidth = UINT32_MAX;
+
+	for (size_t i = 0; i < mSkyline.size(); ++i)
+	{
+		uint32_t y;
+		if (Fit(i, width, height, y) && (y + height < bestY || (y + height == bestY && mSkyline[i].Width < bestWidth)))
+		{
+			bestIndex = i;
+			bestY = y + height;
+			bestWidth = mSkyline[i].Width;
+		}
+	}
+
+	if (bestIndex == mSkyline.size())
+	{
+		return false;
+	}
+
+	rect = { mSkyline[bestIndex].X, bestY - height, width, height };
+	AddNode(bestIndex, rect);
+	mUsedArea += static_cast<uint64_t>(width) * height;
+	return true;
+}
+
+float SkylinePacker::GetOccupancy() const
+{
+	return static_cast<float>(static_cast<double>(mUsedArea) / (static_cast<uint64_t>(mWidth) * mHeight));
+}
+
+bool SkylinePacker::Fit(size_t index, uint32_t width, uint32_t height, uint32_t& y) const
+{
+	uint32_t x = mSkyline[index].X;
+	if (x + width > mWidth)
+	{
+		return false;
+	}
+
+	y = 0;
+	int64_t remaining = width;
+	for (size_t i = index; remaining > 0; ++i)
+	{
+		if (i == mSkyline.size())
+		{
+			return false;
+		}
+		y = std::max(y, mSkyline[i].Y);
+		if (y + height > mHeight)
+		{
+			return false;
+		}
+		remaining -= mSkyline[i].Width;
+	}
+	return true;
+}
+
+void SkylinePacker::AddNode(size_t index, const AtlasRect& rect)
+{
+	mSkyline.insert(mSkyline.begin() + index, { rect.X, rect.Y + rect.Height, rect.Width });
+
+	for (size_t i = index + 1; i < mSkyline.size();)
+	{
+		const auto& previous = mSkyline[i - 1];
+		auto& node = mSkyline[i];
+		uint32_t previousEnd = previous.X + previous.Width;
+		if (node.X >= previousEnd)
+		{
+			break;
+		}
+
+		uint32_t shrink = previousEnd - node.X;
+		if (node.Width <= shrink)
+		{
+			mSkyline.erase(mSkyline.begin() + i);
+			continue;
+		}
+		node.X += shrink;
+		node.Width -= shrink;
+		break;
+	}
+
+	for (size_t i = 0; i + 1 < mSkyline.size();)
+	{
+		if (mSkyline[i].Y == mSkyline[i + 1].Y)
+		{
+			mSkyline[i].Width += mSkyline[i + 1].Width;
+			mSkyline.erase(mSkyline.begin() + i + 1);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+AtlasLayout AtlasBuilder::Pack(const std::vector<AtlasRect>& sizes, uint32_t maxAtlasSize, uint32_t padding, uint32_t mipLevels)
+{
+	AtlasLayout layout;
+	layout.MipLevels = std::max(1u, mipLevels);
+	uint32_t blockSize = 1u << (layout.MipLevels - 1);
+	layout.Gutter = std::max(padding, blockSize / 2);
+	layout.AtlasNum = 0;
+	layout.AtlasSize = blockSize;
+	layout.Regions.resize(sizes.size());
+
+	std::vector<AtlasRect> blocks(sizes.size());
+	uint64_t totalArea = 0;
+	for (size_t i = 0; i < sizes.size(); ++i)
+	{
+		blocks[i].Width = (sizes[i].Width + 2 * layout.Gutter + blockSize - 1) / blockSize * blockSize;
+		blocks[i].Height = (sizes[i].Height + 2 * layout.Gutter + blockSize - 1) / blockSize * blockSize;
+		if (blocks[i].Width > maxAtlasSize || blocks[i].Height > maxAtlasSize)
+		{
+			throw std::invalid_argument("Texture is too large for the atlas.");
+		}
+		totalArea += static_cast<uint64_t>(blocks[i].Width) * blocks[i].Height;
+	}
+
+	std::vector<size_t> order(sizes.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+	{
+		return blocks[a].Height != blocks[b].Height ? blocks[a].Height > blocks[b].Height : blocks[a].Width > blocks[b].Width;
+	});
+
+	while (static_cast<uint64_t>(layout.AtlasSize) * layout.AtlasSize < totalArea && layout.AtlasSize < maxAtlasSize)
+	{
+		layout.AtlasSize *= 2;
+	}
+
+	while (true)
+	{
+		std::vector<SkylinePacker> packers;
+		packers.emplace_back(layout.AtlasSize, layout.AtlasSize);
+
+		bool singleAtlas = true;
+		for (size_t i : order)
+		{
+			// Earlier atlases may still have room for smaller blocks, so fill them before opening another.
+			AtlasRect rect;
+			size_t atlas = 0;
+			while (atlas < packers.size() && !packers[atlas].Insert(blocks[i].Width, blocks[i].Height, rect))
+			{
+				++atlas;
+			}
+
+			if (atlas == packers.size())
+			{
+				singleAtlas = false;
+				if (layout.AtlasSize < maxAtlasSize)
+				{
+					break;
+				}
+				packers.emplace_back(layout.AtlasSize, layout.AtlasSize);
+				packers.back().Insert(blocks[i].Width, blocks[i].Height, rect);
+			}
+
+			auto& region = layout.Regions[i];
+			region.AtlasIndex = static_cast<uint32_t>(atlas);
+			region.Rect = rect;
+		}
+
+		if (singleAtlas || layout.AtlasSize >= maxAtlasSize)
+		{
+			layout.AtlasNum = sizes.empty() ? 0 : static_cast<uint32_t>(packers.size());
+			break;
+		}
+		layout.AtlasSize *= 2;
+	}
+
+	float invSize = 1.0f / layout.AtlasSize;
+	for (size_t i = 0; i < sizes.size(); ++i)
+	{
+		auto& region = layout.Regions[i];
+		region.ScaleOffset = DirectX::XMFLOAT4(sizes[i].Width * invSize, sizes[i].Height * invSize, (region.Rect.X + layout.Gutter) * invSize, (region.Rect.Y + layout.Gutter) * invSize);
+	}
+	return layout;
+}
+
+void AtlasBuilder::Blit(const uint32_t* texels, uint32_t width, uint32_t height, uint32_t* atlas, uint32_t atlasSize, const AtlasRect& rect, uint32_t gutter)
+{
+	for (uint32_t y = 0; y < rect.Height; ++y)
+	{
+		int32_t srcY = std::min(std::max(static_cast<int32_t>(y) - static_cast<int32_t>(gutter), 0), static_cast<int32_t>(height) - 1);
+		uint32_t* dst = atlas + static_cast<size_t>(rect.Y + y) * atlasSize + rect.X;
+		const uint32_t* src = texels + static_cast<size_t>(srcY) * width;
+		for (uint32_t x = 0; x < rect.Width; ++x)
+		{
+			int32_t srcX = std::min(std::max(static_cast<int32_t>(x) - static_cast<int32_t>(gutter), 0), static_cast<int32_t>(width) - 1);
+			dst[x] = src[srcX];
+		}
+	}
+}
+
+std::vector<std::vector<uint32_t>> AtlasBuilder::GenerateMips(const std::vector<uint32_t>& atlas, uint32_t atlasSize, uint32_t mipLevels)
+{
+	std::vector<std::vector<uint32_t>> mips(1, atlas);
+	for (uint32_t mip = 1; mip < mipLevels && (atlasSize >> mip) > 0; ++mip)
+	{
+		uint32_t srcSize = atlasSize >> (mip - 1);
+		uint32_t dstSize = atlasSize >> mip;
+		const auto& src = mips.back();
+		std::vector<uint32_t> dst(static_cast<size_t>(dstSize) * dstSize);
+
+		for (uint32_t y = 0; y < dstSize; ++y)
+		{
+			for (uint32_t x = 0; x < dstSize; ++x)
+			{
+				const uint32_t quad[4] = {
+					src[(y * 2) * srcSize + x * 2], src[(y * 2) * srcSize + x * 2 + 1],
+					src[(y * 2 + 1) * srcSize + x * 2], src[(y * 2 + 1) * srcSize + x * 2 + 1],
+				};
+
+				uint32_t texel = 0;
+				for (uint32_t channel = 0; channel < 32; channel += 8)
+				{
+					uint32_t sum = 2;
+					for (uint32_t value : quad)
+					{
+						sum += (value >> channel) & 0xFF;
+					}
+					texel |= (sum / 4) << channel;
+				}
+				dst[y * dstSize + x] = texel;
+			}
+		}
+		mips.push_back(std::move(dst));
+	}
+	return mips;
+}
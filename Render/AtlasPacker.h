@@ -0,0 +1,77 @@
+#ifndef __ATLASPACKER_H_
+#define __ATLASPACKER_H_
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+struct AtlasRect
+{
+	uint32_t X;
+	uint32_t Y;
+	uint32_t Width;
+	uint32_t Height;
+};
+
+class SkylinePacker
+{
+public:
+	SkylinePacker(uint32_t width, uint32_t height);
+
+	bool Insert(uint32_t width, uint32_t height, AtlasRect& rect);
+
+	uint32_t GetWidth() const
+	{
+		return mWidth;
+	}
+
+	uint32_t GetHeight() const
+	{
+		return mHeight;
+	}
+
+	float GetOccupancy() const;
+
+private:
+	struct SkylineNode
+	{
+		uint32_t X;
+		uint32_t Y;
+		uint32_t Width;
+	};
+
+	bool Fit(size_t index, uint32_t width, uint32_t height, uint32_t& y) const;
+	void AddNode(size_t index, const AtlasRect& rect);
+
+	uint32_t mWidth;
+	uint32_t mHeight;
+	uint64_t mUsedArea;
+	std::vector<SkylineNode> mSkyline;
+};
+
+struct AtlasLayout
+{
+	struct Region
+	{
+		uint32_t AtlasIndex;
+		AtlasRect Rect;
+		DirectX::XMFLOAT4 ScaleOffset;
+	};
+
+	uint32_t AtlasSize;
+	uint32_t AtlasNum;
+	uint32_t Gutter;
+	uint32_t MipLevels;
+	std::vector<Region> Regions;
+};
+
+namespace AtlasBuilder
+{
+	AtlasLayout Pack(const std::vector<AtlasRect>& sizes, uint32_t maxAtlasSize, uint32_t padding, uint32_t mipLevels);
+
+	void Blit(const uint32_t* texels, uint32_t width, uint32_t height, uint32_t* atlas, uint32_t atlasSize, const AtlasRect& rect, uint32_t gutter);
+	std::vector<std::vector<uint32_t>> GenerateMips(const std::vector<uint32_t>& atlas, uint32_t atlasSize, uint32_t mipLevels);
+}
+
+#endif
@@ -0,0 +1,489 @@
+#include "BVH.h"
+#include "JobSystem.h"
+
+#include <cfloat>
+
+using namespace DirectX;
+
+struct BVH::BuildObject
+{
+	XMFLOAT3 Min;
+	uint32_t Object;
+	XMFLOAT3 Max;
+	float Padding;
+};
+
+namespace
+{
+	struct Bin
+	{
+		XMFLOAT3 Min;
+		XMFLOAT3 Max;
+		uint32_t Count;
+	};
+
+	void ResetBounds(XMFLOAT3& min, XMFLOAT3& max)
+	{
+		min = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+		max = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	}
+
+	void GrowBounds(XMFLOAT3& min, XMFLOAT3& max, const XMFLOAT3& otherMin, const XMFLOAT3& otherMax)
+	{
+		min = XMFLOAT3(std::min(min.x, otherMin.x), std::min(min.y, otherMin.y), std::min(min.z, otherMin.z));
+		max = XMFLOAT3(std::max(max.x, otherMax.x), std::max(max.y, otherMax.y), std::max(max.z, otherMax.z));
+	}
+
+	float HalfArea(const XMFLOAT3& min, const XMFLOAT3& max)
+	{
+		if (min.x > max.x) return 0.0f;
+
+		float dx = max.x - min.x;
+		float dy = max.y - min.y;
+		float dz = max.z - min.z;
+		return dx * dy + dy * dz + dz * dx;
+	}
+
+	bool IsSameBounds(const XMFLOAT3& minA, const XMFLOAT3& maxA, const XMFLOAT3& minB, const XMFLOAT3& maxB)
+	{
+		return minA.x == minB.x && minA.y == minB.y && minA.z == minB.z && maxA.x == maxB.x && maxA.y == maxB.y && maxA.z == maxB.z;
+	}
+
+	float GetAxis(const XMFLOAT3& v, uint32_t axis)
+	{
+		return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+	}
+
+	float GetCentroid(const XMFLOAT3& min, const XMFLOAT3& max, uint32_t axis)
+	{
+		return (GetAxis(min, axis) + GetAxis(max, axis)) * 0.5f;
+	}
+
+	int ClassifyBox(const XMFLOAT3& min, const XMFLOAT3& max, const XMFLOAT4 planes[6], uint32_t& planeMask)
+	{
+		float centerX = (min.x + max.x) * 0.5f, centerY = (min.y + max.y) * 0.5f, centerZ = (min.z + max.z) * 0.5f;
+		float extentX = (max.x - min.x) * 0.5f, extentY = (max.y - min.y) * 0.5f, extentZ = (max.z - min.z) * 0.5f;
+
+		for (uint32_t i = 0; i < 6; ++i)
+		{
+			if (!(planeMask & (1u << i))) continue;
+
+			const XMFLOAT4& plane = planes[i];
+			float distance = plane.x * centerX + plane.y * centerY + plane.z * centerZ + plane.w;
+			float radius = std::abs(plane.x) * extentX + std::abs(plane.y) * extentY + std::abs(plane.z) * extentZ;
+			if (distance + radius < 0.0f)
+			{
+				return -1;
+			}
+			if (distance - radius >= 0.0f)
+			{
+				planeMask &= ~(1u << i);
+			}
+		}
+		return planeMask == 0 ? 1 : 0;
+	}
+
+	bool IntersectRay(const XMFLOAT3& min, const XMFLOAT3& max, const float origin[3], const float inverseDirection[3], float maxDistance, float& distance)
+	{
+		const float boxMin[3] = { min.x, min.y, min.z };
+		const float boxMax[3] = { max.x, max.y, max.z };
+
+		float tMin = 0.0f;
+		float tMax = maxDistance;
+		for (int i = 0; i < 3; ++i)
+		{
+			float t0 = (boxMin[i] - origin[i]) * inverseDirection[i];
+			float t1 = (boxMax[i] - origin[i]) * inverseDirection[i];
+			tMin = std::max(tMin, std::min(t0, t1));
+			tMax = std::min(tMax, std::max(t0, t1));
+		}
+
+		distance = tMin;
+		return tMin <= tMax;
+	}
+}
+
+BVH::BVH() : mNodeNum(0), mLeafNum(0), mMaxDepth(0), mVisibleNum(0), mBuildMilliseconds(0.0), mCullMilliseconds(0.0) {}
+
+BVH::~BVH() {}
+
+void BVH::Build(const std::vector<BoundingBox>& objectBounds)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	Clear();
+
+	uint32_t objectNum = static_cast<uint32_t>(objectBounds.size());
+	mObjectMin.resize(objectNum);
+	mObjectMax.resize(objectNum);
+	mObjectIndices.resize(objectNum);
+	mObjectLeaves.resize(objectNum);
+
+	std::vector<BuildObject> buildObjects(objectNum);
+	for (uint32_t i = 0; i < objectNum; ++i)
+	{
+		const BoundingBox& bounds = objectBounds[i];
+		mObjectMin[i] = XMFLOAT3(bounds.Center.x - bounds.Extents.x, bounds.Center.y - bounds.Extents.y, bounds.Center.z - bounds.Extents.z);
+		mObjectMax[i] = XMFLOAT3(bounds.Center.x + bounds.Extents.x, bounds.Center.y + bounds.Extents.y, bounds.Center.z + bounds.Extents.z);
+		buildObjects[i] = { mObjectMin[i], i, mObjectMax[i], 0.0f };
+	}
+
+	if (objectNum > 0)
+	{
+		mNodes.resize(objectNum * 2 - 1);
+		mParents.resize(objectNum * 2 - 1);
+		mParents[0] = ~0u;
+		mNodeNum = 1;
+
+		BuildNode(buildObjects.data(), 0, 0, objectNum, 1);
+
+		mNodes.resize(mNodeNum);
+		mParents.resize(mNodeNum);
+
+		for (uint32_t i = 0; i < objectNum; ++i)
+		{
+			mObjectIndices[i] = buildObjects[i].Object;
+		}
+
+		for (uint32_t i = 0; i < mNodes.size(); ++i)
+		{
+			const Node& node = mNodes[i];
+			for (uint32_t j = 0; j < node.Count; ++j)
+			{
+				mObjectLeaves[mObjectIndices[node.LeftFirst + j]] = i;
+			}
+		}
+	}
+
+	mBuildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void BVH::BuildNode(BuildObject* buildObjects, uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth)
+{
+	BuildObject* objects = buildObjects + first;
+
+	Node& node = mNodes[nodeIndex];
+	node.LeftFirst = first;
+	node.Count = count;
+
+	XMFLOAT3 centroidMin, centroidMax;
+	ResetBounds(node.Min, node.Max);
+	ResetBounds(centroidMin, centroidMax);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		GrowBounds(node.Min, node.Max, objects[i].Min, objects[i].Max);
+		XMFLOAT3 centroid((objects[i].Min.x + objects[i].Max.x) * 0.5f, (objects[i].Min.y + objects[i].Max.y) * 0.5f, (objects[i].Min.z + objects[i].Max.z) * 0.5f);
+		GrowBounds(centroidMin, centroidMax, centroid, centroid);
+	}
+
+	uint32_t maxDepth = mMaxDepth;
+	while (depth > maxDepth && !mMaxDepth.compare_exchange_weak(maxDepth, depth)) {}
+
+	if (count == 1)
+	{
+		++mLeafNum;
+		return;
+	}
+
+	uint32_t binNum = std::min(BinNum, std::max(count, 4u));
+	float bestCost = FLT_MAX;
+	uint32_t bestAxis = 0;
+	uint32_t bestSplit = 0;
+	for (uint32_t axis = 0; axis < 3; ++axis)
+	{
+		float axisMin = GetAxis(centroidMin, axis);
+		float axisExtent = GetAxis(centroidMax, axis) - axisMin;
+		if (axisExtent <= 0.0f) continue;
+
+		Bin bins[BinNum];
+		for (uint32_t i = 0; i < binNum; ++i)
+		{
+			ResetBounds(bins[i].Min, bins[i].Max);
+			bins[i].Count = 0;
+		}
+
+		float scale = binNum / axisExtent;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t binIndex = std::min(binNum - 1, static_cast<uint32_t>((GetCentroid(objects[i].Min, objects[i].Max, axis) - axisMin) * scale));
+			GrowBounds(bins[binIndex].Min, bins[binIndex].Max, objects[i].Min, objects[i].Max);
+			++bins[binIndex].Count;
+		}
+
+		float leftAreas[BinNum - 1];
+		uint32_t leftCounts[BinNum - 1];
+		XMFLOAT3 boundsMin, boundsMax;
+		ResetBounds(boundsMin, boundsMax);
+		uint32_t sum = 0;
+		for (uint32_t i = 0; i < binNum - 1; ++i)
+		{
+			GrowBounds(boundsMin, boundsMax, bins[i].Min, bins[i].Max);
+			sum += bins[i].Count;
+			leftAreas[i] = HalfArea(boundsMin, boundsMax);
+			leftCounts[i] = sum;
+		}
+
+		ResetBounds(boundsMin, boundsMax);
+		sum = 0;
+		for (uint32_t i = binNum - 1; i > 0; --i)
+		{
+			GrowBounds(boundsMin, boundsMax, bins[i].Min, bins[i].Max);
+			sum += bins[i].Count;
+			if (leftCounts[i - 1] == 0 || sum == 0) continue;
+
+			float cost = leftAreas[i - 1] * leftCounts[i - 1] + HalfArea(boundsMin, boundsMax) * sum;
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = i;
+			}
+		}
+	}
+
+	uint32_t leftCount = 0;
+	if (bestCost < FLT_MAX)
+	{
+		float splitCost = 1.0f + bestCost / std::max(HalfArea(node.Min, node.Max), FLT_MIN);
+		if (splitCost >= static_cast<float>(count) && count <= MaxLeafObjectNum)
+		{
+			++mLeafNum;
+			return;
+		}
+
+		float axisMin = GetAxis(centroidMin, bestAxis);
+		float scale = binNum / (GetAxis(centroidMax, bestAxis) - axisMin);
+		BuildObject* middle = std::partition(objects, objects + count, [&](const BuildObject& object)
+		{
+			return std::min(binNum - 1, static_cast<uint32_t>((GetCentroid(object.Min, object.Max, bestAxis) - axisMin) * scale)) < bestSplit;
+		});
+		leftCount = static_cast<uint32_t>(middle - objects);
+	}
+
+	if (leftCount == 0 || leftCount == count)
+	{
+		if (count <= MaxLeafObjectNum)
+		{
+			++mLeafNum;
+			return;
+		}
+		leftCount = count / 2;
+	}
+
+	uint32_t children = mNodeNum.fetch_add(2);
+	node.LeftFirst = children;
+	node.Count = 0;
+	mParents[children] = nodeIndex;
+	mParents[children + 1] = nodeIndex;
+
+	if (count > ParallelBuildObjectNum)
+	{
+		JobSystem::Get().ParallelFor(2, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				BuildNode(buildObjects, children + static_cast<uint32_t>(i), i == 0 ? first : first + leftCount, i == 0 ? leftCount : count - leftCount, depth + 1);
+			}
+		});
+	}
+	else
+	{
+		BuildNode(buildObjects, children, first, leftCount, depth + 1);
+		BuildNode(buildObjects, children + 1, first + leftCount, count - leftCount, depth + 1);
+	}
+}
+
+void BVH::UpdateObject(uint32_t object, const BoundingBox& bounds)
+{
+	XMFLOAT3 min(bounds.Center.x - bounds.Extents.x, bounds.Center.y - bounds.Extents.y, bounds.Center.z - bounds.Extents.z);
+	XMFLOAT3 max(bounds.Center.x + bounds.Extents.x, bounds.Center.y + bounds.Extents.y, bounds.Center.z + bounds.Extents.z);
+	if (IsSameBounds(min, max, mObjectMin[object], mObjectMax[object])) return;
+
+	mObjectMin[object] = min;
+	mObjectMax[object] = max;
+
+	uint32_t nodeIndex = mObjectLeaves[object];
+	while (nodeIndex != ~0u)
+	{
+		Node& node = mNodes[nodeIndex];
+		XMFLOAT3 oldMin = node.Min;
+		XMFLOAT3 oldMax = node.Max;
+		UpdateNodeBounds(node);
+		if (IsSameBounds(oldMin, oldMax, node.Min, node.Max)) break;
+
+		nodeIndex = mParents[nodeIndex];
+	}
+}
+
+void BVH::Clear()
+{
+	mNodes.clear();
+	mParents.clear();
+	mObjectIndices.clear();
+	mObjectLeaves.clear();
+	mObjectMin.clear();
+	mObjectMax.clear();
+	mNodeNum = 0;
+	mLeafNum = 0;
+	mMaxDepth = 0;
+}
+
+void BVH::UpdateNodeBounds(Node& node) const
+{
+	ResetBounds(node.Min, node.Max);
+	if (node.Count > 0)
+	{
+		for (uint32_t i = node.LeftFirst; i < node.LeftFirst + node.Count; ++i)
+		{
+			uint32_t object = mObjectIndices[i];
+			GrowBounds(node.Min, node.Max, mObjectMin[object], mObjectMax[object]);
+		}
+	}
+	else
+	{
+		GrowBounds(node.Min, node.Max, mNodes[node.LeftFirst].Min, mNodes[node.LeftFirst].Max);
+		GrowBounds(node.Min, node.Max, mNodes[node.LeftFirst + 1].Min, mNodes[node.LeftFirst + 1].Max);
+	}
+}
+
+void BVH::AppendSubtree(uint32_t nodeIndex, std::vector<uint32_t>& objects) const
+{
+	const Node& node = mNodes[nodeIndex];
+	if (node.Count > 0)
+	{
+		objects.insert(objects.end(), mObjectIndices.begin() + node.LeftFirst, mObjectIndices.begin() + node.LeftFirst + node.Count);
+		return;
+	}
+
+	AppendSubtree(node.LeftFirst, objects);
+	AppendSubtree(node.LeftFirst + 1, objects);
+}
+
+void BVH::CullFrustum(const XMFLOAT4 planes[6], std::vector<uint32_t>& visibleObjects)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	visibleObjects.clear();
+	if (mNodes.empty())
+	{
+		mVisibleNum = 0;
+		mCullMilliseconds = 0.0;
+		return;
+	}
+
+	std::vector<std::pair<uint32_t, uint32_t>> stack;
+	stack.reserve(mMaxDepth + 1);
+	stack.push_back({ 0, 0x3f });
+
+	while (!stack.empty())
+	{
+		uint32_t nodeIndex = stack.back().first;
+		uint32_t planeMask = stack.back().second;
+		stack.pop_back();
+
+		const Node& node = mNodes[nodeIndex];
+		int classification = ClassifyBox(node.Min, node.Max, planes, planeMask);
+		if (classification < 0) continue;
+
+		if (classification > 0)
+		{
+			AppendSubtree(nodeIndex, visibleObjects);
+		}
+		else if (node.Count > 0)
+		{
+			for (uint32_t i = node.LeftFirst; i < node.LeftFirst + node.Count; ++i)
+			{
+				uint32_t object = mObjectIndices[i];
+				uint32_t objectMask = planeMask;
+				if (ClassifyBox(mObjectMin[object], mObjectMax[object], planes, objectMask) >= 0)
+				{
+					visibleObjects.push_back(object);
+				}
+			}
+		}
+		else
+		{
+			stack.push_back({ node.LeftFirst + 1, planeMask });
+			stack.push_back({ node.LeftFirst, planeMask });
+		}
+	}
+
+	mVisibleNum = static_cast<uint32_t>(visibleObjects.size());
+	mCullMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+bool BVH::Raycast(FXMVECTOR origin, FXMVECTOR direction, float maxDistance, RayHit& hit) const
+{
+	hit.Object = InvalidObject;
+	hit.Distance = maxDistance;
+	if (mNodes.empty()) return false;
+
+	XMFLOAT3 rayOrigin, rayDirection;
+	XMStoreFloat3(&rayOrigin, origin);
+	XMStoreFloat3(&rayDirection, direction);
+	const float originArray[3] = { rayOrigin.x, rayOrigin.y, rayOrigin.z };
+	const float inverseDirection[3] = { 1.0f / rayDirection.x, 1.0f / rayDirection.y, 1.0f / rayDirection.z };
+
+	float distance;
+	if (!IntersectRay(mNodes[0].Min, mNodes[0].Max, originArray, inverseDirection, hit.Distance, distance)) return false;
+
+	std::vector<std::pair<uint32_t, float>> stack;
+	stack.reserve(mMaxDepth + 1);
+	stack.push_back({ 0, distance });
+
+	while (!stack.empty())
+	{
+		uint32_t nodeIndex = stack.back().first;
+		float nodeDistance = stack.back().second;
+		stack.pop_back();
+		if (nodeDistance > hit.Distance) continue;
+
+		const Node& node = mNodes[nodeIndex];
+		if (node.Count > 0)
+		{
+			for (uint32_t i = node.LeftFirst; i < node.LeftFirst + node.Count; ++i)
+			{
+				uint32_t object = mObjectIndices[i];
+				if (IntersectRay(mObjectMin[object], mObjectMax[object], originArray, inverseDirection, hit.Distance, distance) && distance < hit.Distance)
+				{
+					hit.Object = object;
+					hit.Distance = distance;
+				}
+			}
+			continue;
+		}
+
+		float leftDistance, rightDistance;
+		bool hitLeft = IntersectRay(mNodes[node.LeftFirst].Min, mNodes[node.LeftFirst].Max, originArray, inverseDirection, hit.Distance, leftDistance);
+		bool hitRight = IntersectRay(mNodes[node.LeftFirst + 1].Min, mNodes[node.LeftFirst + 1].Max, originArray, inverseDirection, hit.Distance, rightDistance);
+		if (hitLeft && hitRight)
+		{
+			bool leftFirst = leftDistance <= rightDistance;
+			stack.push_back(leftFirst ? std::make_pair(node.LeftFirst + 1, rightDistance) : std::make_pair(node.LeftFirst, leftDistance));
+			stack.push_back(leftFirst ? std::make_pair(node.LeftFirst, leftDistance) : std::make_pair(node.LeftFirst + 1, rightDistance));
+		}
+		else if (hitLeft)
+		{
+			stack.push_back({ node.LeftFirst, leftDistance });
+		}
+		else if (hitRight)
+		{
+			stack.push_back({ node.LeftFirst + 1, rightDistance });
+		}
+	}
+
+	return hit.Object != InvalidObject;
+}
+
+BVH::Statistics BVH::GetStatistics() const
+{
+	Statistics statistics;
+	statistics.ObjectNum = GetObjectCount();
+	statistics.NodeNum = static_cast<uint32_t>(mNodes.size());
+	statistics.LeafNum = mLeafNum;
+	statistics.MaxDepth = mMaxDepth;
+	statistics.VisibleNum = mVisibleNum;
+	statistics.BuildMilliseconds = mBuildMilliseconds;
+	statistics.CullMilliseconds = mCullMilliseconds;
+	return statistics;
+}
@@ -0,0 +1,86 @@
+#ifndef __BVH_H_
+#define __BVH_H_
+
+#include "Core.h"
+
+class BVH
+{
+public:
+	struct Node
+	{
+		DirectX::XMFLOAT3 Min;
+		uint32_t LeftFirst;
+		DirectX::XMFLOAT3 Max;
+		uint32_t Count;
+	};
+
+	struct RayHit
+	{
+		uint32_t Object;
+		float Distance;
+	};
+
+	struct Statistics
+	{
+		uint32_t ObjectNum;
+		uint32_t NodeNum;
+		uint32_t LeafNum;
+		uint32_t MaxDepth;
+		uint32_t VisibleNum;
+		double BuildMilliseconds;
+		double CullMilliseconds;
+	};
+
+	static const uint32_t InvalidObject = ~0u;
+	static const uint32_t BinNum = 16;
+	static const uint32_t MaxLeafObjectNum = 8;
+	static const uint32_t ParallelBuildObjectNum = 4096;
+
+	BVH();
+	virtual ~BVH();
+
+	void Build(const std::vector<DirectX::BoundingBox>& objectBounds);
+	void UpdateObject(uint32_t object, const DirectX::BoundingBox& bounds);
+	void Clear();
+
+	uint32_t GetObjectCount() const
+	{
+		return static_cast<uint32_t>(mObjectMin.size());
+	}
+
+	const std::vector<Node>& GetNodes() const
+	{
+		return mNodes;
+	}
+
+	void CullFrustum(const DirectX::XMFLOAT4 planes[6], std::vector<uint32_t>& visibleObjects);
+	bool Raycast(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDistance, RayHit& hit) const;
+
+	Statistics GetStatistics() const;
+
+private:
+	BVH(const BVH& copy) = delete;
+	BVH& operator=(const BVH& other) = delete;
+
+	struct BuildObject;
+
+	void BuildNode(BuildObject* buildObjects, uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth);
+	void UpdateNodeBounds(Node& node) const;
+	void AppendSubtree(uint32_t nodeIndex, std::vector<uint32_t>& objects) const;
+
+	std::vector<Node> mNodes;
+	std::vector<uint32_t> mParents;
+	std::vector<uint32_t> mObjectIndices;
+	std::vector<uint32_t> mObjectLeaves;
+	std::vector<DirectX::XMFLOAT3> mObjectMin;
+	std::vector<DirectX::XMFLOAT3> mObjectMax;
+
+	std::atomic<uint32_t> mNodeNum;
+	std::atomic<uint32_t> mLeafNum;
+	std::atomic<uint32_t> mMaxDepth;
+	uint32_t mVisibleNum;
+	double mBuildMilliseconds;
+	double mCullMilliseconds;
+};
+
+#endif
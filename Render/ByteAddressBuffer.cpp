@@ -1,7 +1,7 @@
 #include "ByteAddressBuffer.h"
 #include "Application.h"
 
-ByteAddressBuffer::ByteAddressBuffer(const std::wstring& name) : Buffer(name)
+ByteAddressBuffer::ByteAddressBuffer(const std::wstring& name) : Buffer(name), mBufferSize(0)
 {
 	mSRV = Application::Get().AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 	mUAV = Application::Get().AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
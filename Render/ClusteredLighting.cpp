@@ -0,0 +1,323 @@
+#include "ClusteredLighting.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace
+{
+	inline XMVECTOR LoadLanes(const std::vector<float>& values, uint32_t first)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(values.data() + first));
+	}
+
+	inline uint32_t ClampCell(float value, uint32_t count)
+	{
+		return static_cast<uint32_t>(std::min(std::max(std::floor(value), 0.0f), count - 1.0f));
+	}
+}
+
+ClusteredLighting::ClusteredLighting()
+	: mFovY(0.0f), mAspectRatio(0.0f), mNearClip(0.0f), mFarClip(0.0f), mTanHalfFovX(0.0f), mTanHalfFovY(0.0f), mDepthScale(0.0f), mDepthBias(0.0f), mStatistics()
+{
+}
+
+ClusteredLighting::~ClusteredLighting() {}
+
+void ClusteredLighting::SetProjection(float fovY, float aspectRatio, float zNear, float zFar)
+{
+	if (fovY == mFovY && aspectRatio == mAspectRatio && zNear == mNearClip && zFar == mFarClip) return;
+
+	if (zNear <= 0.0f || zFar <= zNear)
+	{
+		throw std::exception("Invalid cluster depth range");
+	}
+
+	mFovY = fovY;
+	mAspectRatio = aspectRatio;
+	mNearClip = zNear;
+	mFarClip = zFar;
+	mTanHalfFovY = std::tan(fovY * 0.5f);
+	mTanHalfFovX = mTanHalfFovY * aspectRatio;
+
+	float logDepthRange = std::log(zFar / zNear);
+	mDepthScale = ClusterCountZ / logDepthRange;
+	mDepthBias = -(ClusterCountZ * std::log(zNear)) / logDepthRange;
+
+	for (auto* bounds : { &mClusterMinX, &mClusterMinY, &mClusterMinZ, &mClusterMaxX, &mClusterMaxY, &mClusterMaxZ, &mClusterCenterX, &mClusterCenterY, &mClusterCenterZ, &mClusterRadii })
+	{
+		bounds->resize(ClusterNum);
+	}
+
+	for (uint32_t z = 0; z < ClusterCountZ; ++z)
+	{
+		float sliceNear = zNear * std::pow(zFar / zNear, z / static_cast<float>(ClusterCountZ));
+		float sliceFar = zNear * std::pow(zFar / zNear, (z + 1) / static_cast<float>(ClusterCountZ));
+
+		for (uint32_t y = 0; y < ClusterCountY; ++y)
+		{
+			float top = (1.0f - 2.0f * y / ClusterCountY) * mTanHalfFovY;
+			float bottom = (1.0f - 2.0f * (y + 1) / ClusterCountY) * mTanHalfFovY;
+
+			for (uint32_t x = 0; x < ClusterCountX; ++x)
+			{
+				float left = (2.0f * x / ClusterCountX - 1.0f) * mTanHalfFovX;
+				float right = (2.0f * (x + 1) / ClusterCountX - 1.0f) * mTanHalfFovX;
+
+				uint32_t cluster = x + ClusterCountX * (y + ClusterCountY * z);
+				mClusterMinX[cluster] = std::min(left * sliceNear, left * sliceFar);
+				mClusterMaxX[cluster] = std::max(right * sliceNear, right * sliceFar);
+				mClusterMinY[cluster] = std::min(bottom * sliceNear, bottom * sliceFar);
+				mClusterMaxY[cluster] = std::max(top * sliceNear, top * sliceFar);
+				mClusterMinZ[cluster] = sliceNear;
+				mClusterMaxZ[cluster] = sliceFar;
+
+				float extentX = 0.5f * (mClusterMaxX[cluster] - mClusterMinX[cluster]);
+				float extentY = 0.5f * (mClusterMaxY[cluster] - mClusterMinY[cluster]);
+				float extentZ = 0.5f * (sliceFar - sliceNear);
+				mClusterCenterX[cluster] = mClusterMinX[cluster] + extentX;
+				mClusterCenterY[cluster] = mClusterMinY[cluster] + extentY;
+				mClusterCenterZ[cluster] = sliceNear + extentZ;
+				mClusterRadii[cluster] = std::sqrt(extentX * extentX + extentY * extentY + extentZ * extentZ);
+			}
+		}
+	}
+}
+
+void ClusteredLighting::Clear()
+{
+	mPointSpheres.clear();
+	mSpotSpheres.clear();
+	mSpotCones.clear();
+}
+
+void XM_CALLCONV ClusteredLighting::AddPointLight(FXMVECTOR positionVS, float range)
+{
+	if (mPointSpheres.size() >= MaxLightNum)
+	{
+		throw std::exception("Too many point lights");
+	}
+
+	mPointSpheres.emplace_back();
+	XMStoreFloat4(&mPointSpheres.back(), XMVectorSetW(positionVS, range));
+}
+
+void XM_CALLCONV ClusteredLighting::AddSpotLight(FXMVECTOR positionVS, FXMVECTOR directionVS, float spotAngle, float range)
+{
+	if (mSpotCones.size() >= MaxLightNum)
+	{
+		throw std::exception("Too many spot lights");
+	}
+
+	XMVECTOR direction = XMVector3Normalize(directionVS);
+
+	SpotCone cone;
+	XMStoreFloat3(&cone.Position, positionVS);
+	XMStoreFloat3(&cone.Direction, direction);
+	cone.Range = range;
+
+	float radius = range;
+	float offset = 0.0f;
+	if (spotAngle < XM_PIDIV2)
+	{
+		XMScalarSinCos(&cone.SinAngle, &cone.CosAngle, spotAngle);
+		cone.BackExtent = 0.0f;
+
+		if (range < FLT_MAX)
+		{
+			if (spotAngle <= XM_PIDIV4)
+			{
+				radius = range / (2.0f * cone.CosAngle);
+				offset = radius;
+			}
+			else
+			{
+				radius = range * cone.SinAngle;
+				offset = range * cone.CosAngle;
+			}
+		}
+	}
+	else
+	{
+		cone.SinAngle = 0.0f;
+		cone.CosAngle = -1.0f;
+		cone.BackExtent = range;
+	}
+
+	mSpotCones.push_back(cone);
+	mSpotSpheres.emplace_back();
+	XMStoreFloat4(&mSpotSpheres.back(), XMVectorSetW(XMVectorMultiplyAdd(direction, XMVectorReplicate(offset), positionVS), radius));
+}
+
+void ClusteredLighting::Bin()
+{
+	if (mClusterMinX.empty())
+	{
+		throw std::exception("Cluster projection is not set");
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	uint32_t pointNum = static_cast<uint32_t>(mPointSpheres.size());
+	uint32_t lightNum = pointNum + static_cast<uint32_t>(mSpotCones.size());
+	size_t chunkNum = (lightNum + JobLightNum - 1) / JobLightNum;
+
+	if (mChunkLights.size() < chunkNum)
+	{
+		mChunkLights.resize(chunkNum);
+	}
+	for (size_t chunk = 0; chunk < chunkNum; ++chunk)
+	{
+		mChunkLights[chunk].clear();
+	}
+
+	JobSystem::Get().ParallelFor(lightNum, JobLightNum, [&](size_t begin, size_t end)
+	{
+		std::vector<ClusterLight>& output = mChunkLights[begin / JobLightNum];
+		for (size_t light = begin; light < end; ++light)
+		{
+			BinLight(static_cast<uint32_t>(light), output);
+		}
+	});
+
+	mClusterRanges.assign(ClusterNum, XMUINT2(0, 0));
+	for (size_t chunk = 0; chunk < chunkNum; ++chunk)
+	{
+		for (const ClusterLight& item : mChunkLights[chunk])
+		{
+			mClusterRanges[item.Cluster].y += item.Light < pointNum ? 1 : 0x10000;
+		}
+	}
+
+	uint32_t indexNum = 0;
+	uint32_t maxClusterLightNum = 0;
+	mClusterCursors.resize(ClusterNum);
+	for (uint32_t cluster = 0; cluster < ClusterNum; ++cluster)
+	{
+		XMUINT2& range = mClusterRanges[cluster];
+		uint32_t count = (range.y & 0xffff) + (range.y >> 16);
+		range.x = indexNum;
+		mClusterCursors[cluster] = indexNum;
+		indexNum += count;
+		maxClusterLightNum = std::max(maxClusterLightNum, count);
+	}
+
+	mLightIndices.resize(std::max<uint32_t>(indexNum, 1));
+	for (size_t chunk = 0; chunk < chunkNum; ++chunk)
+	{
+		for (const ClusterLight& item : mChunkLights[chunk])
+		{
+			mLightIndices[mClusterCursors[item.Cluster]++] = item.Light < pointNum ? item.Light : item.Light - pointNum;
+		}
+	}
+
+	mStatistics.LightNum = lightNum;
+	mStatistics.ClusterNum = ClusterNum;
+	mStatistics.IndexNum = indexNum;
+	mStatistics.MaxClusterLightNum = maxClusterLightNum;
+	mStatistics.BinMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+float ClusteredLighting::ComputeRange(float intensity, float attenuation, float cutoff)
+{
+	if (intensity <= cutoff) return 0.0f;
+	if (attenuation <= 0.0f) return FLT_MAX;
+
+	return std::sqrt((intensity / cutoff - 1.0f) / attenuation);
+}
+
+uint32_t ClusteredLighting::GetSlice(float depth) const
+{
+	return ClampCell(std::log(depth) * mDepthScale + mDepthBias, ClusterCountZ);
+}
+
+bool ClusteredLighting::GetClusterRange(const XMFLOAT4& sphere, uint32_t& x0, uint32_t& x1, uint32_t& y0, uint32_t& y1, uint32_t& z0, uint32_t& z1) const
+{
+	float zMin = std::max(sphere.z - sphere.w, mNearClip);
+	float zMax = std::min(sphere.z + sphere.w, mFarClip);
+	if (zMin > zMax) return false;
+
+	float left = std::min((sphere.x - sphere.w) / zMin, (sphere.x - sphere.w) / zMax) / mTanHalfFovX;
+	float right = std::max((sphere.x + sphere.w) / zMin, (sphere.x + sphere.w) / zMax) / mTanHalfFovX;
+	float bottom = std::min((sphere.y - sphere.w) / zMin, (sphere.y - sphere.w) / zMax) / mTanHalfFovY;
+	float top = std::max((sphere.y + sphere.w) / zMin, (sphere.y + sphere.w) / zMax) / mTanHalfFovY;
+	if (left > 1.0f || right < -1.0f || bottom > 1.0f || top < -1.0f) return false;
+
+	x0 = ClampCell((left + 1.0f) * 0.5f * ClusterCountX, ClusterCountX);
+	x1 = ClampCell((right + 1.0f) * 0.5f * ClusterCountX, ClusterCountX);
+	y0 = ClampCell((1.0f - top) * 0.5f * ClusterCountY, ClusterCountY);
+	y1 = ClampCell((1.0f - bottom) * 0.5f * ClusterCountY, ClusterCountY);
+	z0 = GetSlice(zMin);
+	z1 = GetSlice(zMax);
+	return true;
+}
+
+void ClusteredLighting::BinLight(uint32_t light, std::vector<ClusterLight>& output) const
+{
+	uint32_t pointNum = static_cast<uint32_t>(mPointSpheres.size());
+	bool spot = light >= pointNum;
+	const XMFLOAT4& sphere = spot ? mSpotSpheres[light - pointNum] : mPointSpheres[light];
+
+	uint32_t x0, x1, y0, y1, z0, z1;
+	if (!GetClusterRange(sphere, x0, x1, y0, y1, z0, z1)) return;
+
+	XMVECTOR zero = XMVectorZero();
+	XMVECTOR sphereX = XMVectorReplicate(sphere.x);
+	XMVECTOR sphereY = XMVectorReplicate(sphere.y);
+	XMVECTOR sphereZ = XMVectorReplicate(sphere.z);
+	XMVECTOR radiusSq = XMVectorReplicate(sphere.w * sphere.w);
+
+	SpotCone cone = spot ? mSpotCones[light - pointNum] : SpotCone();
+	XMVECTOR apexX = XMVectorReplicate(cone.Position.x);
+	XMVECTOR apexY = XMVectorReplicate(cone.Position.y);
+	XMVECTOR apexZ = XMVectorReplicate(cone.Position.z);
+	XMVECTOR directionX = XMVectorReplicate(cone.Direction.x);
+	XMVECTOR directionY = XMVectorReplicate(cone.Direction.y);
+	XMVECTOR directionZ = XMVectorReplicate(cone.Direction.z);
+	XMVECTOR coneRange = XMVectorReplicate(cone.Range);
+	XMVECTOR backExtent = XMVectorReplicate(cone.BackExtent);
+	XMVECTOR cosAngle = XMVectorReplicate(cone.CosAngle);
+	XMVECTOR sinAngle = XMVectorReplicate(cone.SinAngle);
+
+	for (uint32_t z = z0; z <= z1; ++z)
+	{
+		for (uint32_t y = y0; y <= y1; ++y)
+		{
+			uint32_t row = ClusterCountX * (y + ClusterCountY * z);
+			for (uint32_t x = x0 & ~3u; x <= x1; x += 4)
+			{
+				uint32_t first = row + x;
+
+				XMVECTOR dx = XMVectorMax(XMVectorMax(XMVectorSubtract(LoadLanes(mClusterMinX, first), sphereX), XMVectorSubtract(sphereX, LoadLanes(mClusterMaxX, first))), zero);
+				XMVECTOR dy = XMVectorMax(XMVectorMax(XMVectorSubtract(LoadLanes(mClusterMinY, first), sphereY), XMVectorSubtract(sphereY, LoadLanes(mClusterMaxY, first))), zero);
+				XMVECTOR dz = XMVectorMax(XMVectorMax(XMVectorSubtract(LoadLanes(mClusterMinZ, first), sphereZ), XMVectorSubtract(sphereZ, LoadLanes(mClusterMaxZ, first))), zero);
+				XMVECTOR hit = XMVectorLessOrEqual(XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz))), radiusSq);
+
+				if (spot)
+				{
+					XMVECTOR clusterRadius = LoadLanes(mClusterRadii, first);
+					XMVECTOR vx = XMVectorSubtract(LoadLanes(mClusterCenterX, first), apexX);
+					XMVECTOR vy = XMVectorSubtract(LoadLanes(mClusterCenterY, first), apexY);
+					XMVECTOR vz = XMVectorSubtract(LoadLanes(mClusterCenterZ, first), apexZ);
+					XMVECTOR lengthSq = XMVectorMultiplyAdd(vx, vx, XMVectorMultiplyAdd(vy, vy, XMVectorMultiply(vz, vz)));
+					XMVECTOR axial = XMVectorMultiplyAdd(vx, directionX, XMVectorMultiplyAdd(vy, directionY, XMVectorMultiply(vz, directionZ)));
+					XMVECTOR lateral = XMVectorSqrt(XMVectorMax(XMVectorNegativeMultiplySubtract(axial, axial, lengthSq), zero));
+					XMVECTOR closest = XMVectorNegativeMultiplySubtract(axial, sinAngle, XMVectorMultiply(lateral, cosAngle));
+
+					XMVECTOR outside = XMVectorOrInt(XMVectorGreater(closest, clusterRadius), XMVectorGreater(axial, XMVectorAdd(clusterRadius, coneRange)));
+					outside = XMVectorOrInt(outside, XMVectorLess(axial, XMVectorNegate(XMVectorAdd(clusterRadius, backExtent))));
+					hit = XMVectorAndCInt(hit, outside);
+				}
+
+				uint32_t lanes[4];
+				XMStoreInt4(lanes, hit);
+				for (uint32_t lane = 0; lane < 4; ++lane)
+				{
+					if (lanes[lane])
+					{
+						output.push_back({ first + lane, light });
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,118 @@
+#ifndef __CLUSTEREDLIGHTING_H_
+#define __CLUSTEREDLIGHTING_H_
+
+#include "Core.h"
+
+class ClusteredLighting
+{
+public:
+	struct Statistics
+	{
+		uint32_t LightNum;
+		uint32_t ClusterNum;
+		uint32_t IndexNum;
+		uint32_t MaxClusterLightNum;
+		double BinMilliseconds;
+	};
+
+	static const uint32_t ClusterCountX = 16;
+	static const uint32_t ClusterCountY = 8;
+	static const uint32_t ClusterCountZ = 24;
+	static const uint32_t ClusterNum = ClusterCountX * ClusterCountY * ClusterCountZ;
+	static const size_t MaxLightNum = 0xffff;
+	static const size_t JobLightNum = 256;
+
+	ClusteredLighting();
+	virtual ~ClusteredLighting();
+
+	void SetProjection(float fovY, float aspectRatio, float zNear, float zFar);
+
+	void Clear();
+	void XM_CALLCONV AddPointLight(DirectX::FXMVECTOR positionVS, float range);
+	void XM_CALLCONV AddSpotLight(DirectX::FXMVECTOR positionVS, DirectX::FXMVECTOR directionVS, float spotAngle, float range);
+	void Bin();
+
+	const std::vector<DirectX::XMUINT2>& GetClusterRanges() const
+	{
+		return mClusterRanges;
+	}
+
+	const std::vector<uint32_t>& GetLightIndices() const
+	{
+		return mLightIndices;
+	}
+
+	float GetDepthScale() const
+	{
+		return mDepthScale;
+	}
+
+	float GetDepthBias() const
+	{
+		return mDepthBias;
+	}
+
+	Statistics GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	static float ComputeRange(float intensity, float attenuation, float cutoff);
+
+private:
+	ClusteredLighting(const ClusteredLighting& copy) = delete;
+	ClusteredLighting& operator=(const ClusteredLighting& other) = delete;
+
+	struct SpotCone
+	{
+		DirectX::XMFLOAT3 Position;
+		float Range;
+		DirectX::XMFLOAT3 Direction;
+		float BackExtent;
+		float CosAngle;
+		float SinAngle;
+	};
+
+	struct ClusterLight
+	{
+		uint32_t Cluster;
+		uint32_t Light;
+	};
+
+	bool GetClusterRange(const DirectX::XMFLOAT4& sphere, uint32_t& x0, uint32_t& x1, uint32_t& y0, uint32_t& y1, uint32_t& z0, uint32_t& z1) const;
+	void BinLight(uint32_t light, std::vector<ClusterLight>& output) const;
+	uint32_t GetSlice(float depth) const;
+
+	float mFovY;
+	float mAspectRatio;
+	float mNearClip;
+	float mFarClip;
+	float mTanHalfFovX;
+	float mTanHalfFovY;
+	float mDepthScale;
+	float mDepthBias;
+
+	std::vector<float> mClusterMinX;
+	std::vector<float> mClusterMinY;
+	std::vector<float> mClusterMinZ;
+	std::vector<float> mClusterMaxX;
+	std::vector<float> mClusterMaxY;
+	std::vector<float> mClusterMaxZ;
+	std::vector<float> mClusterCenterX;
+	std::vector<float> mClusterCenterY;
+	std::vector<float> mClusterCenterZ;
+	std::vector<float> mClusterRadii;
+
+	std::vector<DirectX::XMFLOAT4> mPointSpheres;
+	std::vector<DirectX::XMFLOAT4> mSpotSpheres;
+	std::vector<SpotCone> mSpotCones;
+
+	std::vector<std::vector<ClusterLight>> mChunkLights;
+	std::vector<uint32_t> mClusterCursors;
+	std::vector<DirectX::XMUINT2> mClusterRanges;
+	std::vector<uint32_t> mLightIndices;
+
+	Statistics mStatistics;
+};
+
+#endif
@@ -4,9 +4,12 @@
 #include "ByteAddressBuffer.h"
 #include "ConstantBuffer.h"
 #include "CommandQueue.h"
+#include "CommandSignature.h"
+#include "ComputePipelineLibrary.h"
 #include "DynamicDescriptorHeap.h"
 #include "GenerateMipsPSO.h"
 #include "IndexBuffer.h"
+#include "IndirectCullPSO.h"
 #include "PanoToCubemapPSO.h"
 #include "RenderTarget.h"
 #include "Resource.h"
@@ -37,6 +40,8 @@ CommandList::CommandList(D3D12_COMMAND_LIST_TYPE type) : mCommandListType(type)
 		mDynamicDescriptorHeap[i] = std::make_unique<DynamicDescriptorHeap>(static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i));
 		mDescriptorHeaps[i] = nullptr;
 	}
+
+	ResetInputAssemblerState();
 }
 
 CommandList::~CommandList() {}
@@ -117,6 +122,43 @@ void CommandList::CopyResource(Resource& dstRes, const Resource& srcRes)
 	CopyResource(dstRes.GetD3D12Resource(), srcRes.GetD3D12Resource());
 }
 
+void CommandList::CopyBufferRegion(Buffer& dstBuffer, size_t dstOffset, const Buffer& srcBuffer, size_t srcOffset, size_t numBytes)
+{
+	TransitionBarrier(dstBuffer, D3D12_RESOURCE_STATE_COPY_DEST);
+	TransitionBarrier(srcBuffer, D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+	FlushResourceBarriers();
+
+	mCommandList->CopyBufferRegion(dstBuffer.GetD3D12Resource().Get(), dstOffset, srcBuffer.GetD3D12Resource().Get(), srcOffset, numBytes);
+
+	TrackResource(dstBuffer);
+	TrackResource(srcBuffer);
+}
+
+void CommandList::UpdateBufferRegion(Buffer& buffer, size_t offset, size_t numBytes, const void* bufferData)
+{
+	if (numBytes == 0) return;
+
+	auto device = Application::Get().GetDevice();
+
+	ComPtr<ID3D12Resource> uploadResource;
+	ThrowIfFailed(device->CreateCommittedResource(&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(numBytes),
+												  D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&uploadResource)));
+
+	void* mappedData = nullptr;
+	ThrowIfFailed(uploadResource->Map(0, nullptr, &mappedData));
+	memcpy(mappedData, bufferData, numBytes);
+	uploadResource->Unmap(0, nullptr);
+
+	TransitionBarrier(buffer, D3D12_RESOURCE_STATE_COPY_DEST);
+	FlushResourceBarriers();
+
+	mCommandList->CopyBufferRegion(buffer.GetD3D12Resource().Get(), offset, uploadResource.Get(), 0, numBytes);
+
+	TrackResource(uploadResource);
+	TrackResource(buffer);
+}
+
 void CommandList::ResolveSubresource(Resource& dstRes, const Resource& srcRes, uint32_t dstSubresource, uint32_t srcSubresource)
 {
 	TransitionBarrier(dstRes, D3D12_RESOURCE_STATE_RESOLVE_DEST, dstSubresource);
@@ -130,6 +172,21 @@ void CommandList::ResolveSubresource(Resource& dstRes, const Resource& srcRes, u
 	TrackResource(dstRes);
 }
 
+void CommandList::CopyTextureRegion(Texture& dstTexture, uint32_t dstSubresource, const Texture& srcTexture, uint32_t srcSubresource)
+{
+	TransitionBarrier(dstTexture, D3D12_RESOURCE_STATE_COPY_DEST, dstSubresource);
+	TransitionBarrier(srcTexture, D3D12_RESOURCE_STATE_COPY_SOURCE, srcSubresource);
+
+	FlushResourceBarriers();
+
+	CD3DX12_TEXTURE_COPY_LOCATION dstLocation(dstTexture.GetD3D12Resource().Get(), dstSubresource);
+	CD3DX12_TEXTURE_COPY_LOCATION srcLocation(srcTexture.GetD3D12Resource().Get(), srcSubresource);
+	mCommandList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+
+	TrackResource(srcTexture);
+	TrackResource(dstTexture);
+}
+
 
 void CommandList::CopyBuffer(Buffer& buffer, size_t numElements, size_t elementSize, const void* bufferData, D3D12_RESOURCE_FLAGS flags)
 {
@@ -192,6 +249,9 @@ void CommandList::CopyStructuredBuffer(StructuredBuffer& structuredBuffer, size_
 
 void CommandList::SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY primitiveTopology)
 {
+	if (primitiveTopology == mPrimitiveTopology) return;
+
+	mPrimitiveTopology = primitiveTopology;
 	mCommandList->IASetPrimitiveTopology(primitiveTopology);
 }
 
@@ -358,13 +418,10 @@ void CommandList::GenerateMips(Texture& texture)
 
 void CommandList::GenerateMips_UAV(Texture& texture, DXGI_FORMAT format)
 {
-	if (!mGenerateMipsPSO)
-	{
-		mGenerateMipsPSO = std::make_unique<GenerateMipsPSO>();
-	}
+	const auto& generateMipsPSO = Application::Get().GetComputePipelineLibrary().GetGenerateMipsPSO();
 
-	mCommandList->SetPipelineState(mGenerateMipsPSO->GetPipelineState().Get());
-	SetComputeRootSignature(mGenerateMipsPSO->GetRootSignature());
+	mCommandList->SetPipelineState(generateMipsPSO.GetPipelineState().Get());
+	SetComputeRootSignature(generateMipsPSO.GetRootSignature());
 
 	GenerateMipsCB generateMipsCB;
 	generateMipsCB.IsSRGB = Texture::IsSRGBFormat(format);
@@ -415,7 +472,7 @@ void CommandList::GenerateMips_UAV(Texture& texture, DXGI_FORMAT format)
 
 		if (mipCount < 4)
 		{
-			mDynamicDescriptorHeap[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV]->CachingDescriptors(GenerateMips::OutMip, mipCount, 4 - mipCount, mGenerateMipsPSO->GetDefaultUAV());
+			mDynamicDescriptorHeap[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV]->CachingDescriptors(GenerateMips::OutMip, mipCount, 4 - mipCount, generateMipsPSO.GetDefaultUAV());
 		}
 
 		Dispatch(Math::DivideByMultiple(dstWidth, 8), Math::DivideByMultiple(dstHeight, 8));
@@ -438,10 +495,7 @@ void CommandList::PanoToCubemap(Texture& cubemapTexture, const Texture& panoText
 		return;
 	}
 
-	if (!mPanoToCubemapPSO)
-	{
-		mPanoToCubemapPSO = std::make_unique<PanoToCubemapPSO>();
-	}
+	const auto& panoToCubemapPSO = Application::Get().GetComputePipelineLibrary().GetPanoToCubemapPSO();
 
 	auto device = Application::Get().GetDevice();
 
@@ -470,8 +524,8 @@ void CommandList::PanoToCubemap(Texture& cubemapTexture, const Texture& panoText
 
 	TransitionBarrier(stagingTexture, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
-	mCommandList->SetPipelineState(mPanoToCubemapPSO->GetPipelineState().Get());
-	SetComputeRootSignature(mPanoToCubemapPSO->GetRootSignature());
+	mCommandList->SetPipelineState(panoToCubemapPSO.GetPipelineState().Get());
+	SetComputeRootSignature(panoToCubemapPSO.GetRootSignature());
 	PanoToCubemapCB panoToCubemapCB;
 	D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
 	uavDesc.Format = Texture::GetUAVCompatableFormat(cubemapDesc.Format);
@@ -499,7 +553,7 @@ void CommandList::PanoToCubemap(Texture& cubemapTexture, const Texture& panoText
 
 		if (numMips < 5)
 		{
-			mDynamicDescriptorHeap[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV]->CachingDescriptors(PanoToCubemapRS::DstMips, panoToCubemapCB.NumMips, 5 - numMips, mPanoToCubemapPSO->GetDefaultUAV());
+			mDynamicDescriptorHeap[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV]->CachingDescriptors(PanoToCubemapRS::DstMips, panoToCubemapCB.NumMips, 5 - numMips, panoToCubemapPSO.GetDefaultUAV());
 		}
 
 		Dispatch(Math::DivideByMultiple(panoToCubemapCB.CubemapSize, 16), Math::DivideByMultiple(panoToCubemapCB.CubemapSize, 16), 6);
@@ -513,6 +567,43 @@ void CommandList::PanoToCubemap(Texture& cubemapTexture, const Texture& panoText
 	}
 }
 
+void CommandList::CullIndirectCommands(D3D12_GPU_VIRTUAL_ADDRESS commands, D3D12_GPU_VIRTUAL_ADDRESS cullItems, uint32_t commandCount, uint32_t batchCount,
+									   const DirectX::XMFLOAT4 frustumPlanes[6], Buffer& culledCommands, Buffer& batchCounters)
+{
+	if (commandCount == 0) return;
+
+	const auto& indirectCullPSO = Application::Get().GetComputePipelineLibrary().GetIndirectCullPSO();
+
+	size_t counterSize = batchCount * sizeof(uint32_t);
+	auto zeroCounters = mUploadBuffer->Allocate(counterSize, sizeof(uint32_t));
+	memset(zeroCounters.CPUAddress, 0, counterSize);
+
+	TransitionBarrier(batchCounters, D3D12_RESOURCE_STATE_COPY_DEST);
+	FlushResourceBarriers();
+	mCommandList->CopyBufferRegion(batchCounters.GetD3D12Resource().Get(), 0, zeroCounters.Resource, zeroCounters.Offset, counterSize);
+
+	TransitionBarrier(batchCounters, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	TransitionBarrier(culledCommands, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+	SetPipelineState(indirectCullPSO.GetPipelineState());
+	SetComputeRootSignature(indirectCullPSO.GetRootSignature());
+
+	IndirectCullCB indirectCullCB;
+	memcpy(indirectCullCB.FrustumPlanes, frustumPlanes, sizeof(indirectCullCB.FrustumPlanes));
+	indirectCullCB.CommandCount = commandCount;
+	SetCompute32BitConstants(IndirectCullRS::IndirectCullCB, indirectCullCB);
+
+	mCommandList->SetComputeRootShaderResourceView(IndirectCullRS::InputCommands, commands);
+	mCommandList->SetComputeRootShaderResourceView(IndirectCullRS::CullItems, cullItems);
+	mCommandList->SetComputeRootUnorderedAccessView(IndirectCullRS::OutputCommands, culledCommands.GetD3D12Resource()->GetGPUVirtualAddress());
+	mCommandList->SetComputeRootUnorderedAccessView(IndirectCullRS::BatchCounters, batchCounters.GetD3D12Resource()->GetGPUVirtualAddress());
+
+	Dispatch(Math::DivideByMultiple(commandCount, 64));
+
+	TrackResource(culledCommands);
+	TrackResource(batchCounters);
+}
+
 void CommandList::ClearTexture(const Texture& texture, const float clearColor[4])
 {
 	TransitionBarrier(texture, D3D12_RESOURCE_STATE_RENDER_TARGET);
@@ -572,6 +663,9 @@ void CommandList::SetVertexBuffer(uint32_t slot, const VertexBuffer& vertexBuffe
 {
 	TransitionBarrier(vertexBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 	auto vertexBufferView = vertexBuffer.GetVertexBufferView();
+	if (memcmp(&mVertexBufferViews[slot], &vertexBufferView, sizeof(vertexBufferView)) == 0) return;
+
+	mVertexBufferViews[slot] = vertexBufferView;
 	mCommandList->IASetVertexBuffers(slot, 1, &vertexBufferView);
 	TrackResource(vertexBuffer);
 }
@@ -588,6 +682,7 @@ void CommandList::SetDynamicVertexBuffer(uint32_t slot, size_t numVertices, size
 	vertexBufferView.SizeInBytes = static_cast<UINT>(bufferSize);
 	vertexBufferView.StrideInBytes = static_cast<UINT>(vertexSize);
 
+	mVertexBufferViews[slot] = vertexBufferView;
 	mCommandList->IASetVertexBuffers(slot, 1, &vertexBufferView);
 }
 
@@ -596,7 +691,9 @@ void CommandList::SetIndexBuffer(const IndexBuffer& indexBuffer)
 	TransitionBarrier(indexBuffer, D3D12_RESOURCE_STATE_INDEX_BUFFER);
 
 	auto indexBufferView = indexBuffer.GetIndexBufferView();
+	if (memcmp(&mIndexBufferView, &indexBufferView, sizeof(indexBufferView)) == 0) return;
 
+	mIndexBufferView = indexBufferView;
 	mCommandList->IASetIndexBuffer(&indexBufferView);
 
 	TrackResource(indexBuffer);
@@ -615,6 +712,7 @@ void CommandList::SetDynamicIndexBuffer(size_t numIndicies, DXGI_FORMAT indexFor
 	indexBufferView.SizeInBytes = static_cast<UINT>(bufferSize);
 	indexBufferView.Format = indexFormat;
 
+	mIndexBufferView = indexBufferView;
 	mCommandList->IASetIndexBuffer(&indexBufferView);
 }
 
@@ -628,6 +726,17 @@ void CommandList::SetGraphicsDynamicStructuredBuffer(uint32_t slot, size_t numEl
 
 	mCommandList->SetGraphicsRootShaderResourceView(slot, heapAllocation.GPUAddress);
 }
+
+UploadBuffer::BasePointer CommandList::AllocateDynamicBuffer(size_t sizeInBytes, size_t alignment)
+{
+	return mUploadBuffer->Allocate(sizeInBytes, alignment);
+}
+
+void CommandList::SetGraphicsRootShaderResourceView(uint32_t rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS bufferLocation)
+{
+	mCommandList->SetGraphicsRootShaderResourceView(rootParameterIndex, bufferLocation);
+}
+
 void CommandList::SetViewport(const D3D12_VIEWPORT& viewport)
 {
 	SetViewports({ viewport });
@@ -804,6 +913,50 @@ void CommandList::Dispatch(uint32_t numGroupsX, uint32_t numGroupsY, uint32_t nu
 	mCommandList->Dispatch(numGroupsX, numGroupsY, numGroupsZ);
 }
 
+void CommandList::ExecuteIndirect(const CommandSignature& commandSignature, uint32_t maxCommandCount, const UploadBuffer::BasePointer& arguments, uint64_t argumentOffset)
+{
+	if (maxCommandCount == 0) return;
+
+	FlushResourceBarriers();
+
+	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
+	{
+		mDynamicDescriptorHeap[i]->CommitCachingDescriptorsForDraw(*this);
+	}
+
+	mCommandList->ExecuteIndirect(commandSignature.GetCommandSignature().Get(), maxCommandCount, arguments.Resource, arguments.Offset + argumentOffset, nullptr, 0);
+
+	TrackResource(commandSignature.GetCommandSignature());
+}
+
+void CommandList::ExecuteIndirect(const CommandSignature& commandSignature, uint32_t maxCommandCount, const Buffer& argumentBuffer, uint64_t argumentOffset,
+								  const Buffer* countBuffer, uint64_t countOffset)
+{
+	if (maxCommandCount == 0) return;
+
+	TransitionBarrier(argumentBuffer, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+	if (countBuffer)
+	{
+		TransitionBarrier(*countBuffer, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+	}
+	FlushResourceBarriers();
+
+	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
+	{
+		mDynamicDescriptorHeap[i]->CommitCachingDescriptorsForDraw(*this);
+	}
+
+	mCommandList->ExecuteIndirect(commandSignature.GetCommandSignature().Get(), maxCommandCount, argumentBuffer.GetD3D12Resource().Get(), argumentOffset,
+								  countBuffer ? countBuffer->GetD3D12Resource().Get() : nullptr, countOffset);
+
+	TrackResource(commandSignature.GetCommandSignature());
+	TrackResource(argumentBuffer);
+	if (countBuffer)
+	{
+		TrackResource(*countBuffer);
+	}
+}
+
 bool CommandList::Close(CommandList& pendingCommandList)
 {
 
@@ -843,6 +996,8 @@ void CommandList::Reset()
 
 	mRootSignature = nullptr;
 	mComputeCommandList = nullptr;
+
+	ResetInputAssemblerState();
 }
 
 void CommandList::TrackResource(Microsoft::WRL::ComPtr<ID3D12Object> object)
@@ -869,6 +1024,13 @@ void CommandList::SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE heapType, ID3D12D
 	}
 }
 
+void CommandList::ResetInputAssemblerState()
+{
+	mPrimitiveTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+	memset(mVertexBufferViews, 0, sizeof(mVertexBufferViews));
+	mIndexBufferView = {};
+}
+
 void CommandList::BindDescriptorHeaps()
 {
 	UINT numDescriptorHeaps = 0;
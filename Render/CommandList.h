@@ -3,14 +3,14 @@
 
 #include "Core.h"
 #include "TextureUsage.h"
+#include "UploadBuffer.h"
 
 class Buffer;
 class ByteAddressBuffer;
+class CommandSignature;
 class ConstantBuffer;
 class DynamicDescriptorHeap;
-class GenerateMipsPSO;
 class IndexBuffer;
-class PanoToCubemapPSO;
 class RenderTarget;
 class Resource;
 class ResourceStateTracker;
@@ -43,7 +43,10 @@ public:
 	void FlushResourceBarriers();
 	void CopyResource(Resource& dstRes, const Resource& srcRes);
 	void CopyResource(ComPtr<ID3D12Resource> dstRes, ComPtr<ID3D12Resource> srcRes);
+	void CopyBufferRegion(Buffer& dstBuffer, size_t dstOffset, const Buffer& srcBuffer, size_t srcOffset, size_t numBytes);
+	void UpdateBufferRegion(Buffer& buffer, size_t offset, size_t numBytes, const void* bufferData);
 	void ResolveSubresource(Resource& dstRes, const Resource& srcRes, uint32_t dstSubresource = 0, uint32_t srcSubresource = 0);
+	void CopyTextureRegion(Texture& dstTexture, uint32_t dstSubresource, const Texture& srcTexture, uint32_t srcSubresource);
 	void CopyVertexBuffer(VertexBuffer& vertexBuffer, size_t numVertices, size_t vertexStride, const void* vertexBufferData);
 	template<typename T>
 	void CopyVertexBuffer(VertexBuffer& vertexBuffer, const std::vector<T>& vertexBufferData)
@@ -77,6 +80,8 @@ public:
 	void ClearDepthStencilTexture(const Texture& texture, D3D12_CLEAR_FLAGS clearFlags, float depth = 1.0f, uint8_t stencil = 0);
 	void GenerateMips(Texture& texture);
 	void PanoToCubemap(Texture& cubemap, const Texture& pano);
+	void CullIndirectCommands(D3D12_GPU_VIRTUAL_ADDRESS commands, D3D12_GPU_VIRTUAL_ADDRESS cullItems, uint32_t commandCount, uint32_t batchCount,
+							  const DirectX::XMFLOAT4 frustumPlanes[6], Buffer& culledCommands, Buffer& batchCounters);
 	void CopyTextureSubresource(Texture& texture, uint32_t firstSubresource, uint32_t numSubresources, D3D12_SUBRESOURCE_DATA* subresourceData);
 	void SetGraphicsDynamicConstantBuffer(uint32_t rootParameterIndex, size_t sizeInBytes, const void* bufferData);
 	template<typename T>
@@ -127,6 +132,9 @@ public:
 		SetGraphicsDynamicStructuredBuffer(slot, bufferData.size(), sizeof(T), bufferData.data());
 	}
 
+	UploadBuffer::BasePointer AllocateDynamicBuffer(size_t sizeInBytes, size_t alignment);
+	void SetGraphicsRootShaderResourceView(uint32_t rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS bufferLocation);
+
 	void SetViewport(const D3D12_VIEWPORT& viewport);
 	void SetViewports(const std::vector<D3D12_VIEWPORT>& viewports);
 	void SetScissorRect(const D3D12_RECT& scissorRect);
@@ -146,6 +154,9 @@ public:
 	void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t startVertex = 0, uint32_t startInstance = 0);
 	void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t startIndex = 0, int32_t baseVertex = 0, uint32_t startInstance = 0);
 	void Dispatch(uint32_t numGroupsX, uint32_t numGroupsY = 1, uint32_t numGroupsZ = 1);
+	void ExecuteIndirect(const CommandSignature& commandSignature, uint32_t maxCommandCount, const UploadBuffer::BasePointer& arguments, uint64_t argumentOffset = 0);
+	void ExecuteIndirect(const CommandSignature& commandSignature, uint32_t maxCommandCount, const Buffer& argumentBuffer, uint64_t argumentOffset = 0,
+						 const Buffer* countBuffer = nullptr, uint64_t countOffset = 0);
 	bool Close(CommandList& pendingCommandList);
 	void Close();
 	void Reset();
@@ -163,6 +174,7 @@ private:
 	void GenerateMips_UAV(Texture& texture, DXGI_FORMAT format);
 	void CopyBuffer(Buffer& buffer, size_t numElements, size_t elementSize, const void* bufferData, D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE);
 	void BindDescriptorHeaps();
+	void ResetInputAssemblerState();
 
 	using TrackedObjects = std::vector < Microsoft::WRL::ComPtr<ID3D12Object> >;
 
@@ -181,8 +193,9 @@ private:
 
 	ID3D12DescriptorHeap* mDescriptorHeaps[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
 
-	std::unique_ptr<GenerateMipsPSO> mGenerateMipsPSO;
-	std::unique_ptr<PanoToCubemapPSO> mPanoToCubemapPSO;
+	D3D_PRIMITIVE_TOPOLOGY mPrimitiveTopology;
+	D3D12_VERTEX_BUFFER_VIEW mVertexBufferViews[D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+	D3D12_INDEX_BUFFER_VIEW mIndexBufferView;
 
 	TrackedObjects m_TrackedObjects;
 
@@ -0,0 +1,21 @@
+#include "CommandSignature.h"
+#include "Application.h"
+#include "IndirectCommandBuilder.h"
+#include "RootSignature.h"
+
+CommandSignature::CommandSignature(const RootSignature& rootSignature, uint32_t objectIndexParameter)
+{
+	auto device = Application::Get().GetDevice();
+
+	D3D12_INDIRECT_ARGUMENT_DESC argumentDescs[IndirectCommandBuilder::ArgumentNum];
+	IndirectCommandBuilder::GetArgumentDescs(objectIndexParameter, argumentDescs);
+
+	D3D12_COMMAND_SIGNATURE_DESC commandSignatureDesc = {};
+	commandSignatureDesc.ByteStride = static_cast<UINT>(IndirectCommandBuilder::CommandStride);
+	commandSignatureDesc.NumArgumentDescs = IndirectCommandBuilder::ArgumentNum;
+	commandSignatureDesc.pArgumentDescs = argumentDescs;
+
+	ThrowIfFailed(device->CreateCommandSignature(&commandSignatureDesc, rootSignature.GetRootSignature().Get(), IID_PPV_ARGS(&mCommandSignature)));
+}
+
+CommandSignature::~CommandSignature() {}
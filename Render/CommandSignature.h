@@ -0,0 +1,26 @@
+#ifndef __COMMANDSIGNATURE_H_
+#define __COMMANDSIGNATURE_H_
+
+#include "Core.h"
+
+class RootSignature;
+
+class CommandSignature
+{
+public:
+	CommandSignature(const RootSignature& rootSignature, uint32_t objectIndexParameter);
+	virtual ~CommandSignature();
+
+	ComPtr<ID3D12CommandSignature> GetCommandSignature() const
+	{
+		return mCommandSignature;
+	}
+
+private:
+	CommandSignature(const CommandSignature& copy) = delete;
+	CommandSignature& operator=(const CommandSignature& other) = delete;
+
+	ComPtr<ID3D12CommandSignature> mCommandSignature;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include "ComputePipelineLibrary.h"
+
+#include "GenerateMipsPSO.h"
+#include "IndirectCullPSO.h"
+#include "PanoToCubemapPSO.h"
+
+ComputePipelineLibrary::ComputePipelineLibrary() : mGenerateMipsCreated(0), mPanoToCubemapCreated(0), mIndirectCullCreated(0), mRequests(0) {}
+
+ComputePipelineLibrary::~ComputePipelineLibrary() {}
+
+const GenerateMipsPSO& ComputePipelineLibrary::GetGenerateMipsPSO()
+{
+	++mRequests;
+	std::call_once(mGenerateMipsOnce, [this]()
+	{
+		mGenerateMipsPSO = std::make_unique<GenerateMipsPSO>();
+		++mGenerateMipsCreated;
+	});
+	return *mGenerateMipsPSO;
+}
+
+const PanoToCubemapPSO& ComputePipelineLibrary::GetPanoToCubemapPSO()
+{
+	++mRequests;
+	std::call_once(mPanoToCubemapOnce, [this]()
+	{
+		mPanoToCubemapPSO = std::make_unique<PanoToCubemapPSO>();
+		++mPanoToCubemapCreated;
+	});
+	return *mPanoToCubemapPSO;
+}
+
+const IndirectCullPSO& ComputePipelineLibrary::GetIndirectCullPSO()
+{
+	++mRequests;
+	std::call_once(mIndirectCullOnce, [this]()
+	{
+		mIndirectCullPSO = std::make_unique<IndirectCullPSO>();
+		++mIndirectCullCreated;
+	});
+	return *mIndirectCullPSO;
+}
+
+void ComputePipelineLibrary::Prewarm()
+{
+	GetGenerateMipsPSO();
+	GetPanoToCubemapPSO();
+	GetIndirectCullPSO();
+}
+
+ComputePipelineLibrary::Statistics ComputePipelineLibrary::GetStatistics() const
+{
+	Statistics statistics;
+	statistics.GenerateMipsCreated = mGenerateMipsCreated;
+	statistics.PanoToCubemapCreated = mPanoToCubemapCreated;
+	statistics.IndirectCullCreated = mIndirectCullCreated;
+	statistics.Requests = mRequests;
+	return statistics;
+}
@@ -0,0 +1,50 @@
+#ifndef __COMPUTEPIPELINELIBRARY_H_
+#define __COMPUTEPIPELINELIBRARY_H_
+
+#include "Core.h"
+
+class GenerateMipsPSO;
+class IndirectCullPSO;
+class PanoToCubemapPSO;
+
+class ComputePipelineLibrary
+{
+public:
+	struct Statistics
+	{
+		uint32_t GenerateMipsCreated;
+		uint32_t PanoToCubemapCreated;
+		uint32_t IndirectCullCreated;
+		uint64_t Requests;
+	};
+
+	ComputePipelineLibrary();
+	virtual ~ComputePipelineLibrary();
+
+	const GenerateMipsPSO& GetGenerateMipsPSO();
+	const PanoToCubemapPSO& GetPanoToCubemapPSO();
+	const IndirectCullPSO& GetIndirectCullPSO();
+
+	void Prewarm();
+
+	Statistics GetStatistics() const;
+
+private:
+	ComputePipelineLibrary(const ComputePipelineLibrary& copy) = delete;
+	ComputePipelineLibrary& operator=(const ComputePipelineLibrary& other) = delete;
+
+	std::unique_ptr<GenerateMipsPSO> mGenerateMipsPSO;
+	std::unique_ptr<PanoToCubemapPSO> mPanoToCubemapPSO;
+	std::unique_ptr<IndirectCullPSO> mIndirectCullPSO;
+
+	std::once_flag mGenerateMipsOnce;
+	std::once_flag mPanoToCubemapOnce;
+	std::once_flag mIndirectCullOnce;
+
+	std::atomic_uint32_t mGenerateMipsCreated;
+	std::atomic_uint32_t mPanoToCubemapCreated;
+	std::atomic_uint32_t mIndirectCullCreated;
+	std::atomic_uint64_t mRequests;
+};
+
+#endif
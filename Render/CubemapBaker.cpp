@@ -0,0 +1,479 @@
+#include "CubemapBaker.h"
+#include "JobSystem.h"
+
+#include <DirectXPackedVector.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace DirectX;
+
+namespace
+{
+	const float InvPI = 0.31830988618379067153776752674503f;
+	const float Inv2PI = 0.15915494309189533576888376337251f;
+
+	const float RotateUV[CubemapImage::FaceNum][3][3] =
+	{
+		{ {  0,  0,  1 }, {  0, -1,  0 }, { -1,  0,  0 } },
+		{ {  0,  0, -1 }, {  0, -1,  0 }, {  1,  0,  0 } },
+		{ {  1,  0,  0 }, {  0,  0,  1 }, {  0,  1,  0 } },
+		{ {  1,  0,  0 }, {  0,  0, -1 }, {  0, -1,  0 } },
+		{ {  1,  0,  0 }, {  0, -1,  0 }, {  0,  0,  1 } },
+		{ { -1,  0,  0 }, {  0, -1,  0 }, {  0,  0, -1 } },
+	};
+
+	const uint32_t DDSMagic = 0x20534444;
+	const uint32_t DX10FourCC = 0x30315844;
+
+	const uint32_t DXGIFormatR32G32B32A32Float = 2;
+	const uint32_t DXGIFormatR16G16B16A16Float = 10;
+	const uint32_t DXGIFormatR8G8B8A8Unorm = 28;
+	const uint32_t DXGIFormatR8G8B8A8UnormSRGB = 29;
+
+#pragma pack(push, 1)
+	struct DDSPixelFormat
+	{
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t FourCC;
+		uint32_t RGBBitCount;
+		uint32_t RBitMask;
+		uint32_t GBitMask;
+		uint32_t BBitMask;
+		uint32_t ABitMask;
+	};
+
+	struct DDSHeader
+	{
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t Height;
+		uint32_t Width;
+		uint32_t PitchOrLinearSize;
+		uint32_t Depth;
+		uint32_t MipMapCount;
+		uint32_t Reserved1[11];
+		DDSPixelFormat PixelFormat;
+		uint32_t Caps;
+		uint32_t Caps2;
+		uint32_t Caps3;
+		uint32_t Caps4;
+		uint32_t Reserved2;
+	};
+
+	struct DDSHeaderDX10
+	{
+		uint32_t DXGIFormat;
+		uint32_t ResourceDimension;
+		uint32_t MiscFlag;
+		uint32_t ArraySize;
+		uint32_t MiscFlags2;
+	};
+#pragma pack(pop)
+
+	uint32_t GetDXGIFormat(CubemapFormat format)
+	{
+		switch (format)
+		{
+		case CubemapFormat::RGBA8_UNORM:
+			return DXGIFormatR8G8B8A8Unorm;
+		case CubemapFormat::RGBA8_UNORM_SRGB:
+			return DXGIFormatR8G8B8A8UnormSRGB;
+		case CubemapFormat::RGBA16_FLOAT:
+			return DXGIFormatR16G16B16A16Float;
+		default:
+			return DXGIFormatR32G32B32A32Float;
+		}
+	}
+
+	size_t GetBytesPerTexel(uint32_t dxgiFormat)
+	{
+		switch (dxgiFormat)
+		{
+		case DXGIFormatR8G8B8A8Unorm:
+		case DXGIFormatR8G8B8A8UnormSRGB:
+			return 4;
+		case DXGIFormatR16G16B16A16Float:
+			return 8;
+		case DXGIFormatR32G32B32A32Float:
+			return 16;
+		default:
+			return 0;
+		}
+	}
+
+	void EncodeTexels(const XMFLOAT4* texels, size_t texelNum, uint32_t dxgiFormat, uint8_t* dst)
+	{
+		for (size_t i = 0; i < texelNum; ++i)
+		{
+			XMVECTOR texel = XMLoadFloat4(&texels[i]);
+			switch (dxgiFormat)
+			{
+			case DXGIFormatR8G8B8A8Unorm:
+			case DXGIFormatR8G8B8A8UnormSRGB:
+			{
+				XMVECTOR scaled = XMVectorRound(XMVectorScale(XMVectorSaturate(texel), 255.0f));
+				XMFLOAT4 value;
+				XMStoreFloat4(&value, scaled);
+				dst[i * 4 + 0] = static_cast<uint8_t>(value.x);
+				dst[i * 4 + 1] = static_cast<uint8_t>(value.y);
+				dst[i * 4 + 2] = static_cast<uint8_t>(value.z);
+				dst[i * 4 + 3] = static_cast<uint8_t>(value.w);
+			}
+			break;
+			case DXGIFormatR16G16B16A16Float:
+				PackedVector::XMStoreHalf4(reinterpret_cast<PackedVector::XMHALF4*>(dst + i * 8), texel);
+				break;
+			default:
+				memcpy(dst + i * 16, &texels[i], 16);
+				break;
+			}
+		}
+	}
+
+	void DecodeTexels(const uint8_t* src, size_t texelNum, uint32_t dxgiFormat, XMFLOAT4* texels)
+	{
+		for (size_t i = 0; i < texelNum; ++i)
+		{
+			switch (dxgiFormat)
+			{
+			case DXGIFormatR8G8B8A8Unorm:
+			case DXGIFormatR8G8B8A8UnormSRGB:
+				texels[i] = XMFLOAT4(src[i * 4 + 0] / 255.0f, src[i * 4 + 1] / 255.0f, src[i * 4 + 2] / 255.0f, src[i * 4 + 3] / 255.0f);
+				break;
+			case DXGIFormatR16G16B16A16Float:
+				XMStoreFloat4(&texels[i], PackedVector::XMLoadHalf4(reinterpret_cast<const PackedVector::XMHALF4*>(src + i * 8)));
+				break;
+			default:
+				memcpy(&texels[i], src + i * 16, 16);
+				break;
+			}
+		}
+	}
+
+	XMVECTOR SampleBilinear(const PanoramaImage& pano, float u, float v)
+	{
+		float x = u * pano.Width - 0.5f;
+		float y = v * pano.Height - 0.5f;
+		float fx = std::floor(x);
+		float fy = std::floor(y);
+		float tx = x - fx;
+		float ty = y - fy;
+
+		int32_t width = static_cast<int32_t>(pano.Width);
+		int32_t height = static_cast<int32_t>(pano.Height);
+		int32_t x0 = static_cast<int32_t>(fx) % width;
+		x0 = x0 < 0 ? x0 + width : x0;
+		int32_t x1 = (x0 + 1) % width;
+		int32_t y0 = std::min(std::max(static_cast<int32_t>(fy), 0), height - 1);
+		int32_t y1 = std::min(y0 + 1, height - 1);
+
+		XMVECTOR t00 = XMLoadFloat4(&pano.Texels[y0 * pano.Width + x0]);
+		XMVECTOR t10 = XMLoadFloat4(&pano.Texels[y0 * pano.Width + x1]);
+		XMVECTOR t01 = XMLoadFloat4(&pano.Texels[y1 * pano.Width + x0]);
+		XMVECTOR t11 = XMLoadFloat4(&pano.Texels[y1 * pano.Width + x1]);
+
+		XMVECTOR top = XMVectorLerp(t00, t10, tx);
+		XMVECTOR bottom = XMVectorLerp(t01, t11, tx);
+		return XMVectorLerp(top, bottom, ty);
+	}
+}
+
+CubemapImage::CubemapImage() : mSize(0), mMipLevels(0) {}
+
+CubemapImage::CubemapImage(uint32_t size, uint32_t mipLevels) : mSize(size), mMipLevels(mipLevels)
+{
+	if (mMipLevels == 0 || mMipLevels > GetFullMipLevels(size))
+	{
+		mMipLevels = GetFullMipLevels(size);
+	}
+
+	size_t texelNum = 0;
+	mOffsets.resize(FaceNum * mMipLevels);
+	for (uint32_t face = 0; face < FaceNum; ++face)
+	{
+		for (uint32_t mip = 0; mip < mMipLevels; ++mip)
+		{
+			mOffsets[face * mMipLevels + mip] = texelNum;
+			texelNum += static_cast<size_t>(GetMipSize(mip)) * GetMipSize(mip);
+		}
+	}
+	mTexels.resize(texelNum);
+}
+
+XMFLOAT4* CubemapImage::GetTexels(uint32_t face, uint32_t mip)
+{
+	return mTexels.data() + mOffsets[face * mMipLevels + mip];
+}
+
+const XMFLOAT4* CubemapImage::GetTexels(uint32_t face, uint32_t mip) const
+{
+	return mTexels.data() + mOffsets[face * mMipLevels + mip];
+}
+
+uint32_t CubemapImage::GetFullMipLevels(uint32_t size)
+{
+	uint32_t mipLevels = 1;
+	while (size > 1)
+	{
+		size >>= 1;
+		++mipLevels;
+	}
+	return mipLevels;
+}
+
+XMVECTOR XM_CALLCONV CubemapImage::GetTexelDirection(uint32_t face, float u, float v)
+{
+	const auto& r = RotateUV[face];
+	float x = u - 0.5f;
+	float y = v - 0.5f;
+	XMVECTOR dir = XMVectorSet(r[0][0] * x + r[0][1] * y + r[0][2] * 0.5f,
+							   r[1][0] * x + r[1][1] * y + r[1][2] * 0.5f,
+							   r[2][0] * x + r[2][1] * y + r[2][2] * 0.5f, 0.0f);
+	return XMVector3Normalize(dir);
+}
+
+uint32_t XM_CALLCONV CubemapImage::GetFaceCoordinate(FXMVECTOR direction, float& u, float& v)
+{
+	XMFLOAT3 dir;
+	XMStoreFloat3(&dir, direction);
+
+	uint32_t face = 0;
+	float majorAxis = -1.0f;
+	for (uint32_t i = 0; i < FaceNum; ++i)
+	{
+		const auto& r = RotateUV[i];
+		float localZ = r[0][2] * dir.x + r[1][2] * dir.y + r[2][2] * dir.z;
+		if (localZ > majorAxis)
+		{
+			majorAxis = localZ;
+			face = i;
+		}
+	}
+
+	const auto& r = RotateUV[face];
+	float scale = 0.5f / std::max(majorAxis, 1e-6f);
+	u = (r[0][0] * dir.x + r[1][0] * dir.y + r[2][0] * dir.z) * scale + 0.5f;
+	v = (r[0][1] * dir.x + r[1][1] * dir.y + r[2][1] * dir.z) * scale + 0.5f;
+	return face;
+}
+
+CubemapImage CubemapBaker::PanoToCubemap(const PanoramaImage& pano, uint32_t size, uint32_t mipLevels)
+{
+	CubemapImage cubemap(size, mipLevels);
+	if (pano.Width == 0 || pano.Height == 0 || pano.Texels.size() < static_cast<size_t>(pano.Width) * pano.Height)
+	{
+		throw std::invalid_argument("Invalid panorama image.");
+	}
+
+	const float invSize = 1.0f / size;
+	const XMVECTOR laneOffsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+
+	JobSystem::Get().ParallelFor(CubemapImage::FaceNum * size, 16, [&](size_t begin, size_t end)
+	{
+		alignas(16) float panoU[4];
+		alignas(16) float panoV[4];
+
+		for (size_t row = begin; row < end; ++row)
+		{
+			uint32_t face = static_cast<uint32_t>(row / size);
+			uint32_t y = static_cast<uint32_t>(row % size);
+			const auto& r = RotateUV[face];
+			XMFLOAT4* dst = cubemap.GetTexels(face, 0) + static_cast<size_t>(y) * size;
+
+			XMVECTOR localY = XMVectorReplicate((y + 0.5f) * invSize - 0.5f);
+			XMVECTOR half = XMVectorReplicate(0.5f);
+
+			for (uint32_t x = 0; x < size; x += 4)
+			{
+				XMVECTOR localX = XMVectorSubtract(XMVectorScale(XMVectorAdd(XMVectorReplicate(static_cast<float>(x)), laneOffsets), invSize), half);
+
+				XMVECTOR dirX = XMVectorMultiplyAdd(localX, XMVectorReplicate(r[0][0]), XMVectorMultiplyAdd(localY, XMVectorReplicate(r[0][1]), XMVectorScale(half, r[0][2])));
+				XMVECTOR dirY = XMVectorMultiplyAdd(localX, XMVectorReplicate(r[1][0]), XMVectorMultiplyAdd(localY, XMVectorReplicate(r[1][1]), XMVectorScale(half, r[1][2])));
+				XMVECTOR dirZ = XMVectorMultiplyAdd(localX, XMVectorReplicate(r[2][0]), XMVectorMultiplyAdd(localY, XMVectorReplicate(r[2][1]), XMVectorScale(half, r[2][2])));
+
+				XMVECTOR lengthSq = XMVectorMultiplyAdd(dirX, dirX, XMVectorMultiplyAdd(dirY, dirY, XMVectorMultiply(dirZ, dirZ)));
+				XMVECTOR invLength = XMVectorReciprocalSqrt(lengthSq);
+				dirX = XMVectorMultiply(dirX, invLength);
+				dirY = XMVectorMultiply(dirY, invLength);
+				dirZ = XMVectorMultiply(dirZ, invLength);
+
+				XMVECTOR u = XMVectorScale(XMVectorATan2(XMVectorNegate(dirX), XMVectorNegate(dirZ)), Inv2PI);
+				XMVECTOR v = XMVectorScale(XMVectorACos(XMVectorClamp(dirY, XMVectorReplicate(-1.0f), XMVectorReplicate(1.0f))), InvPI);
+
+				XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(panoU), u);
+				XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(panoV), v);
+
+				uint32_t laneNum = std::min(4u, size - x);
+				for (uint32_t lane = 0; lane < laneNum; ++lane)
+				{
+					XMStoreFloat4(&dst[x + lane], SampleBilinear(pano, panoU[lane], panoV[lane]));
+				}
+			}
+		}
+	});
+
+	GenerateMips(cubemap);
+
+	return cubemap;
+}
+
+void CubemapBaker::GenerateMips(CubemapImage& cubemap)
+{
+	for (uint32_t mip = 1; mip < cubemap.GetMipLevels(); ++mip)
+	{
+		uint32_t srcSize = cubemap.GetMipSize(mip - 1);
+		uint32_t dstSize = cubemap.GetMipSize(mip);
+
+		JobSystem::Get().ParallelFor(CubemapImage::FaceNum * dstSize, 32, [&](size_t begin, size_t end)
+		{
+			for (size_t row = begin; row < end; ++row)
+			{
+				uint32_t face = static_cast<uint32_t>(row / dstSize);
+				uint32_t y = static_cast<uint32_t>(row % dstSize);
+				const XMFLOAT4* src = cubemap.GetTexels(face, mip - 1);
+				XMFLOAT4* dst = cubemap.GetTexels(face, mip) + static_cast<size_t>(y) * dstSize;
+
+				uint32_t y0 = std::min(y * 2, srcSize - 1);
+				uint32_t y1 = std::min(y * 2 + 1, srcSize - 1);
+				for (uint32_t x = 0; x < dstSize; ++x)
+				{
+					uint32_t x0 = std::min(x * 2, srcSize - 1);
+					uint32_t x1 = std::min(x * 2 + 1, srcSize - 1);
+
+					XMVECTOR sum = XMVectorAdd(XMVectorAdd(XMLoadFloat4(&src[y0 * srcSize + x0]), XMLoadFloat4(&src[y0 * srcSize + x1])),
+											   XMVectorAdd(XMLoadFloat4(&src[y1 * srcSize + x0]), XMLoadFloat4(&src[y1 * srcSize + x1])));
+					XMStoreFloat4(&dst[x], XMVectorScale(sum, 0.25f));
+				}
+			}
+		});
+	}
+}
+
+uint64_t CubemapBaker::HashBytes(const void* data, size_t size, uint64_t seed)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool CubemapBaker::SaveToDDS(const std::string& fileName, const CubemapImage& cubemap, CubemapFormat format)
+{
+	uint32_t dxgiFormat = GetDXGIFormat(format);
+	size_t bytesPerTexel = GetBytesPerTexel(dxgiFormat);
+
+	DDSHeader header = {};
+	header.Size = sizeof(DDSHeader);
+	header.Flags = 0x1 | 0x2 | 0x4 | 0x8 | 0x1000 | 0x20000;
+	header.Height = cubemap.GetSize();
+	header.Width = cubemap.GetSize();
+	header.PitchOrLinearSize = static_cast<uint32_t>(cubemap.GetSize() * bytesPerTexel);
+	header.MipMapCount = cubemap.GetMipLevels();
+	header.PixelFormat.Size = sizeof(DDSPixelFormat);
+	header.PixelFormat.Flags = 0x4;
+	header.PixelFormat.FourCC = DX10FourCC;
+	header.Caps = 0x1000 | 0x8 | 0x400000;
+	header.Caps2 = 0x200 | 0xFC00;
+
+	DDSHeaderDX10 headerDX10 = {};
+	headerDX10.DXGIFormat = dxgiFormat;
+	headerDX10.ResourceDimension = 3;
+	headerDX10.MiscFlag = 0x4;
+	headerDX10.ArraySize = 1;
+
+	// Written next to the destination and renamed into place, so an interrupted bake never leaves
+	// a truncated file under the final name.
+	std::string tempFileName = fileName + ".tmp";
+	std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&DDSMagic), sizeof(DDSMagic));
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+
+	std::vector<uint8_t> encoded;
+	for (uint32_t face = 0; face < CubemapImage::FaceNum && file; ++face)
+	{
+		for (uint32_t mip = 0; mip < cubemap.GetMipLevels() && file; ++mip)
+		{
+			size_t texelNum = static_cast<size_t>(cubemap.GetMipSize(mip)) * cubemap.GetMipSize(mip);
+			encoded.resize(texelNum * bytesPerTexel);
+			EncodeTexels(cubemap.GetTexels(face, mip), texelNum, dxgiFormat, encoded.data());
+			file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+		}
+	}
+
+	file.close();
+	bool succeeded = static_cast<bool>(file);
+	if (succeeded)
+	{
+		// rename does not replace an existing file on Windows.
+		std::remove(fileName.c_str());
+		succeeded = std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+	}
+	if (!succeeded)
+	{
+		std::remove(tempFileName.c_str());
+	}
+	return succeeded;
+}
+
+bool CubemapBaker::LoadFromDDS(const std::string& fileName, CubemapImage& cubemap)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	uint32_t magic = 0;
+	DDSHeader header = {};
+	DDSHeaderDX10 headerDX10 = {};
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	file.read(reinterpret_cast<char*>(&headerDX10), sizeof(headerDX10));
+	if (!file || magic != DDSMagic || header.PixelFormat.FourCC != DX10FourCC || (headerDX10.MiscFlag & 0x4) == 0 || header.Width != header.Height)
+	{
+		return false;
+	}
+
+	size_t bytesPerTexel = GetBytesPerTexel(headerDX10.DXGIFormat);
+	if (bytesPerTexel == 0)
+	{
+		return false;
+	}
+
+	CubemapImage result(header.Width, std::max(1u, header.MipMapCount));
+	std::vector<uint8_t> encoded;
+	for (uint32_t face = 0; face < CubemapImage::FaceNum && file; ++face)
+	{
+		for (uint32_t mip = 0; mip < result.GetMipLevels() && file; ++mip)
+		{
+			size_t texelNum = static_cast<size_t>(result.GetMipSize(mip)) * result.GetMipSize(mip);
+			encoded.resize(texelNum * bytesPerTexel);
+			if (file.read(reinterpret_cast<char*>(encoded.data()), encoded.size()))
+			{
+				DecodeTexels(encoded.data(), texelNum, headerDX10.DXGIFormat, result.GetTexels(face, mip));
+			}
+		}
+	}
+
+	if (!file)
+	{
+		return false;
+	}
+	cubemap = std::move(result);
+	return true;
+}
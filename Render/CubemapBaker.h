@@ -0,0 +1,74 @@
+#ifndef __CUBEMAPBAKER_H_
+#define __CUBEMAPBAKER_H_
+
+#include <DirectXMath.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class CubemapFormat : uint32_t
+{
+	RGBA8_UNORM,
+	RGBA8_UNORM_SRGB,
+	RGBA16_FLOAT,
+	RGBA32_FLOAT,
+};
+
+struct PanoramaImage
+{
+	uint32_t Width;
+	uint32_t Height;
+	std::vector<DirectX::XMFLOAT4> Texels;
+};
+
+class CubemapImage
+{
+public:
+	static const uint32_t FaceNum = 6;
+
+	CubemapImage();
+	CubemapImage(uint32_t size, uint32_t mipLevels);
+
+	uint32_t GetSize() const
+	{
+		return mSize;
+	}
+
+	uint32_t GetMipLevels() const
+	{
+		return mMipLevels;
+	}
+
+	uint32_t GetMipSize(uint32_t mip) const
+	{
+		return std::max(1u, mSize >> mip);
+	}
+
+	DirectX::XMFLOAT4* GetTexels(uint32_t face, uint32_t mip);
+	const DirectX::XMFLOAT4* GetTexels(uint32_t face, uint32_t mip) const;
+
+	static uint32_t GetFullMipLevels(uint32_t size);
+	static DirectX::XMVECTOR XM_CALLCONV GetTexelDirection(uint32_t face, float u, float v);
+	static uint32_t XM_CALLCONV GetFaceCoordinate(DirectX::FXMVECTOR direction, float& u, float& v);
+
+private:
+	uint32_t mSize;
+	uint32_t mMipLevels;
+	std::vector<size_t> mOffsets;
+	std::vector<DirectX::XMFLOAT4> mTexels;
+};
+
+namespace CubemapBaker
+{
+	CubemapImage PanoToCubemap(const PanoramaImage& pano, uint32_t size, uint32_t mipLevels = 0);
+	void GenerateMips(CubemapImage& cubemap);
+
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+
+	bool SaveToDDS(const std::string& fileName, const CubemapImage& cubemap, CubemapFormat format);
+	bool LoadFromDDS(const std::string& fileName, CubemapImage& cubemap);
+}
+
+#endif
@@ -0,0 +1,192 @@
+#include "CubemapCache.h"
+
+#include "CommandList.h"
+#include "Texture.h"
+
+#include <sstream>
+
+CubemapCache::CubemapCache(const std::wstring& cacheDirectory) : mCacheDirectory(cacheDirectory), mHits(0), mMisses(0), mLastBakeMilliseconds(0.0)
+{
+	if (!fs::exists(mCacheDirectory))
+	{
+		fs::create_directories(mCacheDirectory);
+	}
+}
+
+CubemapCache::~CubemapCache() {}
+
+std::wstring CubemapCache::GetCacheFileName(const std::wstring& panoFileName, uint32_t size, CubemapFormat format) const
+{
+	fs::path filePath = fs::absolute(panoFileName);
+	if (!fs::exists(filePath))
+	{
+		throw std::exception("File not found.");
+	}
+
+	// Keyed on the panorama's path, size and write time rather than its contents, so a warm start
+	// never has to read the source image. Editing the panorama changes the key and bakes a new entry.
+	std::wstring path = filePath.wstring();
+	uint64_t fileSize = static_cast<uint64_t>(fs::file_size(filePath));
+	int64_t writeTime = static_cast<int64_t>(fs::last_write_time(filePath).time_since_epoch().count());
+	uint64_t hash = CubemapBaker::HashBytes(path.data(), path.size() * sizeof(wchar_t));
+	hash = CubemapBaker::HashBytes(&fileSize, sizeof(fileSize), hash);
+	hash = CubemapBaker::HashBytes(&writeTime, sizeof(writeTime), hash);
+
+	std::wstringstream name;
+	name << std::hex << hash << std::dec << L"_" << size << L"_" << static_cast<uint32_t>(format) << L".dds";
+	return (mCacheDirectory / name.str()).wstring();
+}
+
+void CubemapCache::LoadCubemap(CommandList& commandList, Texture& cubemap, const std::wstring& panoFileName, uint32_t size, CubemapFormat format, TextureUsage textureUsage)
+{
+	std::wstring cacheFileName = BakeCubemap(panoFileName, size, format);
+	try
+	{
+		commandList.LoadTextureFromFile(cubemap, cacheFileName, textureUsage);
+	}
+	catch (const std::exception& e)
+	{
+		DiscardEntry(cacheFileName, e.what());
+		commandList.LoadTextureFromFile(cubemap, BakeCubemap(panoFileName, size, format), textureUsage);
+	}
+}
+
+void CubemapCache::LoadEnvironmentLighting(CommandList& commandList, Texture& specularCubemap, IrradianceSH& irradiance, const std::wstring& panoFileName, uint32_t size, CubemapFormat format,
+										   uint32_t specularSize, uint32_t specularMipLevels)
+{
+	fs::path cubemapFileName = BakeCubemap(panoFileName, size, format);
+
+	std::wstringstream specularName;
+	specularName << cubemapFileName.stem().wstring() << L"_specular_" << specularSize << L"_" << specularMipLevels << L".dds";
+	fs::path specularFileName = mCacheDirectory / specularName.str();
+	fs::path irradianceFileName = mCacheDirectory / (cubemapFileName.stem().wstring() + L"_irradiance.sh");
+
+	auto bake = [&]()
+	{
+		++mMisses;
+		auto start = std::chrono::high_resolution_clock::now();
+
+		CubemapImage environment;
+		if (!CubemapBaker::LoadFromDDS(cubemapFileName.string(), environment))
+		{
+			DiscardEntry(cubemapFileName.wstring(), "unreadable cubemap");
+			cubemapFileName = BakeCubemap(panoFileName, size, format);
+			if (!CubemapBaker::LoadFromDDS(cubemapFileName.string(), environment))
+			{
+				throw std::exception("Failed to read cubemap cache.");
+			}
+		}
+
+		irradiance = IBLBaker::ProjectIrradianceSH(environment);
+		CubemapImage specular = IBLBaker::PrefilterSpecular(environment, specularSize, specularMipLevels);
+		if (!IBLBaker::SaveIrradianceSH(irradianceFileName.string(), irradiance) || !CubemapBaker::SaveToDDS(specularFileName.string(), specular, CubemapFormat::RGBA16_FLOAT))
+		{
+			throw std::exception("Failed to write environment lighting cache.");
+		}
+
+		mLastBakeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+
+	if (fs::exists(specularFileName) && IBLBaker::LoadIrradianceSH(irradianceFileName.string(), irradiance))
+	{
+		++mHits;
+	}
+	else
+	{
+		bake();
+	}
+
+	try
+	{
+		commandList.LoadTextureFromFile(specularCubemap, specularFileName.wstring(), TextureUsage::Albedo);
+	}
+	catch (const std::exception& e)
+	{
+		DiscardEntry(specularFileName.wstring(), e.what());
+		bake();
+		commandList.LoadTextureFromFile(specularCubemap, specularFileName.wstring(), TextureUsage::Albedo);
+	}
+}
+
+std::wstring CubemapCache::BakeCubemap(const std::wstring& panoFileName, uint32_t size, CubemapFormat format)
+{
+	std::wstring cacheFileName = GetCacheFileName(panoFileName, size, format);
+	if (fs::exists(cacheFileName))
+	{
+		++mHits;
+	}
+	else
+	{
+		++mMisses;
+		auto start = std::chrono::high_resolution_clock::now();
+
+		CubemapImage image = CubemapBaker::PanoToCubemap(LoadPanorama(panoFileName), size);
+		if (!CubemapBaker::SaveToDDS(fs::path(cacheFileName).string(), image, format))
+		{
+			throw std::exception("Failed to write cubemap cache.");
+		}
+
+		mLastBakeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+	return cacheFileName;
+}
+
+void CubemapCache::DiscardEntry(const std::wstring& cacheFileName, const char* reason)
+{
+	std::wstringstream message;
+	message << L"CubemapCache: rebaking " << cacheFileName << L": " << reason << L"\n";
+	OutputDebugStringW(message.str().c_str());
+
+	fs::remove(cacheFileName);
+}
+
+PanoramaImage CubemapCache::LoadPanorama(const std::wstring& panoFileName) const
+{
+	fs::path filePath(panoFileName);
+
+	TexMetadata metadata;
+	ScratchImage scratchImage;
+	if (filePath.extension() == ".dds")
+	{
+		ThrowIfFailed(LoadFromDDSFile(panoFileName.c_str(), DDS_FLAGS_NONE, &metadata, scratchImage));
+	}
+	else if (filePath.extension() == ".hdr")
+	{
+		ThrowIfFailed(LoadFromHDRFile(panoFileName.c_str(), &metadata, scratchImage));
+	}
+	else if (filePath.extension() == ".tga")
+	{
+		ThrowIfFailed(LoadFromTGAFile(panoFileName.c_str(), &metadata, scratchImage));
+	}
+	else
+	{
+		ThrowIfFailed(LoadFromWICFile(panoFileName.c_str(), WIC_FLAGS_NONE, &metadata, scratchImage));
+	}
+
+	ScratchImage floatImage;
+	const Image* image = scratchImage.GetImage(0, 0, 0);
+	if (metadata.format != DXGI_FORMAT_R32G32B32A32_FLOAT)
+	{
+		ThrowIfFailed(Convert(*image, DXGI_FORMAT_R32G32B32A32_FLOAT, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, floatImage));
+		image = floatImage.GetImage(0, 0, 0);
+	}
+
+	PanoramaImage pano;
+	pano.Width = static_cast<uint32_t>(image->width);
+	pano.Height = static_cast<uint32_t>(image->height);
+	pano.Texels.resize(static_cast<size_t>(pano.Width) * pano.Height);
+	for (uint32_t y = 0; y < pano.Height; ++y)
+	{
+		memcpy(&pano.Texels[static_cast<size_t>(y) * pano.Width], image->pixels + y * image->rowPitch, pano.Width * sizeof(XMFLOAT4));
+	}
+	return pano;
+}
+
+CubemapCache::Statistics CubemapCache::GetStatistics() const
+{
+	Statistics statistics;
+	statistics.Hits = mHits;
+	statistics.Misses = mMisses;
+	statistics.LastBakeMilliseconds = mLastBakeMilliseconds;
+	return statistics;
+}
@@ -0,0 +1,45 @@
+#ifndef __CUBEMAPCACHE_H_
+#define __CUBEMAPCACHE_H_
+
+#include "Core.h"
+#include "CubemapBaker.h"
+#include "IBLBaker.h"
+#include "TextureUsage.h"
+
+class CommandList;
+class Texture;
+
+class CubemapCache
+{
+public:
+	struct Statistics
+	{
+		uint32_t Hits;
+		uint32_t Misses;
+		double LastBakeMilliseconds;
+	};
+
+	CubemapCache(const std::wstring& cacheDirectory);
+	virtual ~CubemapCache();
+
+	void LoadCubemap(CommandList& commandList, Texture& cubemap, const std::wstring& panoFileName, uint32_t size, CubemapFormat format, TextureUsage textureUsage = TextureUsage::Albedo);
+	void LoadEnvironmentLighting(CommandList& commandList, Texture& specularCubemap, IrradianceSH& irradiance, const std::wstring& panoFileName, uint32_t size, CubemapFormat format,
+								 uint32_t specularSize, uint32_t specularMipLevels);
+
+	std::wstring GetCacheFileName(const std::wstring& panoFileName, uint32_t size, CubemapFormat format) const;
+
+	Statistics GetStatistics() const;
+
+private:
+	std::wstring BakeCubemap(const std::wstring& panoFileName, uint32_t size, CubemapFormat format);
+	void DiscardEntry(const std::wstring& cacheFileName, const char* reason);
+	PanoramaImage LoadPanorama(const std::wstring& panoFileName) const;
+
+	fs::path mCacheDirectory;
+
+	uint32_t mHits;
+	uint32_t mMisses;
+	double mLastBakeMilliseconds;
+};
+
+#endif
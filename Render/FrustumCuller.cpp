@@ -0,0 +1,155 @@
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+#include "Meshlet.h"
+
+using namespace DirectX;
+
+namespace
+{
+	struct PlaneSplats
+	{
+		XMVECTOR NormalX;
+		XMVECTOR NormalY;
+		XMVECTOR NormalZ;
+		XMVECTOR Distance;
+		XMVECTOR AbsNormalX;
+		XMVECTOR AbsNormalY;
+		XMVECTOR AbsNormalZ;
+	};
+
+	uint32_t TestBatch(const float* centerX, const float* centerY, const float* centerZ, const float* extentX, const float* extentY, const float* extentZ, const PlaneSplats* planes)
+	{
+		XMVECTOR cx = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(centerX));
+		XMVECTOR cy = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(centerY));
+		XMVECTOR cz = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(centerZ));
+		XMVECTOR ex = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(extentX));
+		XMVECTOR ey = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(extentY));
+		XMVECTOR ez = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(extentZ));
+
+		XMVECTOR outside = XMVectorFalseInt();
+		for (int i = 0; i < 6; ++i)
+		{
+			const PlaneSplats& plane = planes[i];
+			XMVECTOR distance = XMVectorMultiplyAdd(cx, plane.NormalX, XMVectorMultiplyAdd(cy, plane.NormalY, XMVectorMultiplyAdd(cz, plane.NormalZ, plane.Distance)));
+			XMVECTOR radius = XMVectorMultiplyAdd(ex, plane.AbsNormalX, XMVectorMultiplyAdd(ey, plane.AbsNormalY, XMVectorMultiply(ez, plane.AbsNormalZ)));
+			outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(distance, radius), XMVectorZero()));
+		}
+
+		XMUINT4 lanes;
+		XMStoreUInt4(&lanes, outside);
+		return (lanes.x ? 0 : 1) | (lanes.y ? 0 : 2) | (lanes.z ? 0 : 4) | (lanes.w ? 0 : 8);
+	}
+}
+
+FrustumCuller::FrustumCuller() : mObjectNum(0), mStatistics() {}
+
+FrustumCuller::~FrustumCuller() {}
+
+void FrustumCuller::Clear()
+{
+	mCenterX.clear();
+	mCenterY.clear();
+	mCenterZ.clear();
+	mExtentX.clear();
+	mExtentY.clear();
+	mExtentZ.clear();
+	mObjectNum = 0;
+}
+
+void FrustumCuller::Reserve(size_t objectNum)
+{
+	size_t paddedNum = (objectNum + 3) & ~static_cast<size_t>(3);
+	mCenterX.reserve(paddedNum);
+	mCenterY.reserve(paddedNum);
+	mCenterZ.reserve(paddedNum);
+	mExtentX.reserve(paddedNum);
+	mExtentY.reserve(paddedNum);
+	mExtentZ.reserve(paddedNum);
+}
+
+uint32_t FrustumCuller::AddObject(const BoundingBox& bounds)
+{
+	if (mObjectNum == mCenterX.size())
+	{
+		size_t paddedNum = mCenterX.size() + 4;
+		mCenterX.resize(paddedNum, 0.0f);
+		mCenterY.resize(paddedNum, 0.0f);
+		mCenterZ.resize(paddedNum, 0.0f);
+		mExtentX.resize(paddedNum, 0.0f);
+		mExtentY.resize(paddedNum, 0.0f);
+		mExtentZ.resize(paddedNum, 0.0f);
+	}
+
+	uint32_t object = mObjectNum++;
+	SetObject(object, bounds);
+	return object;
+}
+
+void FrustumCuller::SetObject(uint32_t object, const BoundingBox& bounds)
+{
+	assert(object < mObjectNum);
+
+	mCenterX[object] = bounds.Center.x;
+	mCenterY[object] = bounds.Center.y;
+	mCenterZ[object] = bounds.Center.z;
+	mExtentX[object] = bounds.Extents.x;
+	mExtentY[object] = bounds.Extents.y;
+	mExtentZ[object] = bounds.Extents.z;
+}
+
+uint32_t FrustumCuller::Cull(const XMFLOAT4X4& viewProjection, std::vector<uint32_t>& visibleObjects)
+{
+	XMFLOAT4 planes[6];
+	MeshletCuller::ExtractFrustumPlanes(viewProjection, planes);
+	return Cull(planes, visibleObjects);
+}
+
+uint32_t FrustumCuller::Cull(const XMFLOAT4 planes[6], std::vector<uint32_t>& visibleObjects)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	PlaneSplats planeSplats[6];
+	for (int i = 0; i < 6; ++i)
+	{
+		XMVECTOR plane = XMLoadFloat4(&planes[i]);
+		XMVECTOR absPlane = XMVectorAbs(plane);
+		planeSplats[i] = { XMVectorSplatX(plane), XMVectorSplatY(plane), XMVectorSplatZ(plane), XMVectorSplatW(plane),
+			XMVectorSplatX(absPlane), XMVectorSplatY(absPlane), XMVectorSplatZ(absPlane) };
+	}
+
+	size_t batchNum = mCenterX.size() / 4;
+	mBatchMasks.resize(batchNum);
+
+	JobSystem::Get().ParallelFor(batchNum, JobObjectNum / 4, [&](size_t begin, size_t end)
+	{
+		for (size_t batch = begin; batch < end; ++batch)
+		{
+			size_t first = batch * 4;
+			mBatchMasks[batch] = static_cast<uint8_t>(TestBatch(&mCenterX[first], &mCenterY[first], &mCenterZ[first], &mExtentX[first], &mExtentY[first], &mExtentZ[first], planeSplats));
+		}
+	});
+
+	if (batchNum > 0 && (mObjectNum & 3) != 0)
+	{
+		mBatchMasks[batchNum - 1] &= static_cast<uint8_t>((1u << (mObjectNum & 3)) - 1);
+	}
+
+	visibleObjects.clear();
+	for (size_t batch = 0; batch < batchNum; ++batch)
+	{
+		uint32_t mask = mBatchMasks[batch];
+		for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1)
+		{
+			if (mask & 1)
+			{
+				visibleObjects.push_back(static_cast<uint32_t>(batch * 4 + lane));
+			}
+		}
+	}
+
+	mStatistics.ObjectNum = mObjectNum;
+	mStatistics.VisibleNum = static_cast<uint32_t>(visibleObjects.size());
+	mStatistics.CullMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return mObjectNum - mStatistics.VisibleNum;
+}
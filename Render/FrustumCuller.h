@@ -0,0 +1,55 @@
+#ifndef __FRUSTUMCULLER_H_
+#define __FRUSTUMCULLER_H_
+
+#include "Core.h"
+
+class FrustumCuller
+{
+public:
+	struct Statistics
+	{
+		uint32_t ObjectNum;
+		uint32_t VisibleNum;
+		double CullMilliseconds;
+	};
+
+	static const size_t JobObjectNum = 8192;
+
+	FrustumCuller();
+	virtual ~FrustumCuller();
+
+	void Clear();
+	void Reserve(size_t objectNum);
+	uint32_t AddObject(const DirectX::BoundingBox& bounds);
+	void SetObject(uint32_t object, const DirectX::BoundingBox& bounds);
+
+	uint32_t GetObjectCount() const
+	{
+		return mObjectNum;
+	}
+
+	uint32_t Cull(const DirectX::XMFLOAT4X4& viewProjection, std::vector<uint32_t>& visibleObjects);
+	uint32_t Cull(const DirectX::XMFLOAT4 planes[6], std::vector<uint32_t>& visibleObjects);
+
+	Statistics GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+private:
+	FrustumCuller(const FrustumCuller& copy) = delete;
+	FrustumCuller& operator=(const FrustumCuller& other) = delete;
+
+	std::vector<float> mCenterX;
+	std::vector<float> mCenterY;
+	std::vector<float> mCenterZ;
+	std::vector<float> mExtentX;
+	std::vector<float> mExtentY;
+	std::vector<float> mExtentZ;
+	std::vector<uint8_t> mBatchMasks;
+	uint32_t mObjectNum;
+
+	Statistics mStatistics;
+};
+
+#endif
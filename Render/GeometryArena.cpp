@@ -0,0 +1,222 @@
+#include "GeometryArena.h"
+#include "Application.h"
+#include "CommandList.h"
+
+GeometryArena::GeometryArena(size_t initialPoolSize) : mInitialPoolSize(initialPoolSize), mGrowNum(0) {}
+
+GeometryArena::~GeometryArena() {}
+
+GeometryArena::Allocation GeometryArena::AllocateVertices(CommandList& commandList, size_t numVertices, size_t vertexStride, const void* vertexData)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return Allocate(commandList, FindPool(vertexStride, DXGI_FORMAT_UNKNOWN), numVertices, vertexData);
+}
+
+GeometryArena::Allocation GeometryArena::AllocateIndices(CommandList& commandList, size_t numIndices, DXGI_FORMAT indexFormat, const void* indexData)
+{
+	assert((indexFormat == DXGI_FORMAT_R16_UINT || indexFormat == DXGI_FORMAT_R32_UINT) && "Index format must be 16 or 32 bit");
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	return Allocate(commandList, FindPool(indexFormat == DXGI_FORMAT_R16_UINT ? 2 : 4, indexFormat), numIndices, indexData);
+}
+
+void GeometryArena::Free(const Allocation& allocation)
+{
+	if (allocation.Pool == InvalidPool) return;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	Pool& pool = *mPools[allocation.Pool];
+	pool.FreedAllocations.push({ allocation.Offset, allocation.Count, Application::GetFrameCount() });
+	--pool.AllocationNum;
+}
+
+void GeometryArena::ReleaseFreedAllocations(uint64_t finishedFrame)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (auto& pool : mPools)
+	{
+		while (!pool->FreedAllocations.empty() && pool->FreedAllocations.front().FrameNumber <= finishedFrame)
+		{
+			const FreedAllocation& freed = pool->FreedAllocations.front();
+			FreeRange(*pool, freed.Offset, freed.Count);
+			pool->UsedNum -= freed.Count;
+			pool->FreedAllocations.pop();
+		}
+	}
+}
+
+void GeometryArena::SetVertexBuffer(CommandList& commandList, uint32_t slot, const Allocation& allocation) const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	commandList.SetVertexBuffer(slot, *mPools[allocation.Pool]->Vertices);
+}
+
+void GeometryArena::SetIndexBuffer(CommandList& commandList, const Allocation& allocation) const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	commandList.SetIndexBuffer(*mPools[allocation.Pool]->Indices);
+}
+
+GeometryArena::Statistics GeometryArena::GetStatistics() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	Statistics statistics = {};
+	statistics.PoolNum = static_cast<uint32_t>(mPools.size());
+	statistics.GrowNum = mGrowNum;
+	for (const auto& pool : mPools)
+	{
+		statistics.AllocationNum += pool->AllocationNum;
+		statistics.FreeRangeNum += static_cast<uint32_t>(pool->FreeOffsets.size());
+		statistics.CapacityBytes += static_cast<uint64_t>(pool->Capacity) * pool->ElementSize;
+		statistics.UsedBytes += static_cast<uint64_t>(pool->UsedNum) * pool->ElementSize;
+		if (!pool->FreeSizes.empty())
+		{
+			statistics.LargestFreeBytes = std::max<uint64_t>(statistics.LargestFreeBytes, static_cast<uint64_t>(pool->FreeSizes.rbegin()->first) * pool->ElementSize);
+		}
+	}
+	return statistics;
+}
+
+GeometryArena::Allocation GeometryArena::Allocate(CommandList& commandList, uint32_t poolIndex, size_t count, const void* data)
+{
+	if (count == 0)
+	{
+		return { InvalidPool, 0, 0 };
+	}
+	if (count > UINT32_MAX)
+	{
+		throw std::bad_alloc();
+	}
+
+	Pool& pool = *mPools[poolIndex];
+	uint32_t elementNum = static_cast<uint32_t>(count);
+
+	auto smallestRangeIterator = pool.FreeSizes.lower_bound(elementNum);
+	if (smallestRangeIterator == pool.FreeSizes.end())
+	{
+		Grow(commandList, pool, elementNum);
+		smallestRangeIterator = pool.FreeSizes.lower_bound(elementNum);
+	}
+
+	uint32_t rangeSize = smallestRangeIterator->first;
+	auto offsetIterator = smallestRangeIterator->second;
+	uint32_t offset = offsetIterator->first;
+	pool.FreeSizes.erase(smallestRangeIterator);
+	pool.FreeOffsets.erase(offsetIterator);
+	if (rangeSize > elementNum)
+	{
+		AddFreeRange(pool, offset + elementNum, rangeSize - elementNum);
+	}
+
+	pool.UsedNum += elementNum;
+	++pool.AllocationNum;
+
+	if (data)
+	{
+		Buffer& buffer = pool.Vertices ? static_cast<Buffer&>(*pool.Vertices) : static_cast<Buffer&>(*pool.Indices);
+		commandList.UpdateBufferRegion(buffer, offset * pool.ElementSize, count * pool.ElementSize, data);
+	}
+
+	return { poolIndex, offset, elementNum };
+}
+
+uint32_t GeometryArena::FindPool(size_t elementSize, DXGI_FORMAT indexFormat)
+{
+	for (uint32_t i = 0; i < mPools.size(); ++i)
+	{
+		if (mPools[i]->ElementSize == elementSize && mPools[i]->IndexFormat == indexFormat)
+		{
+			return i;
+		}
+	}
+
+	auto pool = std::make_unique<Pool>();
+	pool->IndexFormat = indexFormat;
+	pool->ElementSize = elementSize;
+	pool->Capacity = 0;
+	pool->UsedNum = 0;
+	pool->AllocationNum = 0;
+	if (indexFormat == DXGI_FORMAT_UNKNOWN)
+	{
+		pool->Vertices = std::make_unique<VertexBuffer>(L"GeometryArena Vertices");
+	}
+	else
+	{
+		pool->Indices = std::make_unique<IndexBuffer>(L"GeometryArena Indices");
+	}
+
+	mPools.push_back(std::move(pool));
+	return static_cast<uint32_t>(mPools.size() - 1);
+}
+
+void GeometryArena::Grow(CommandList& commandList, Pool& pool, uint32_t minCount)
+{
+	uint64_t oldCapacity = pool.Capacity;
+	uint64_t newCapacity = std::max({ oldCapacity * 2, oldCapacity + minCount, static_cast<uint64_t>(mInitialPoolSize / pool.ElementSize) });
+	if (newCapacity > UINT32_MAX)
+	{
+		throw std::bad_alloc();
+	}
+
+	if (pool.Vertices)
+	{
+		auto vertices = std::make_unique<VertexBuffer>(L"GeometryArena Vertices");
+		commandList.CopyVertexBuffer(*vertices, static_cast<size_t>(newCapacity), pool.ElementSize, nullptr);
+		if (oldCapacity > 0)
+		{
+			commandList.CopyBufferRegion(*vertices, 0, *pool.Vertices, 0, static_cast<size_t>(oldCapacity * pool.ElementSize));
+		}
+		pool.Vertices = std::move(vertices);
+	}
+	else
+	{
+		auto indices = std::make_unique<IndexBuffer>(L"GeometryArena Indices");
+		commandList.CopyIndexBuffer(*indices, static_cast<size_t>(newCapacity), pool.IndexFormat, nullptr);
+		if (oldCapacity > 0)
+		{
+			commandList.CopyBufferRegion(*indices, 0, *pool.Indices, 0, static_cast<size_t>(oldCapacity * pool.ElementSize));
+		}
+		pool.Indices = std::move(indices);
+	}
+
+	pool.Capacity = static_cast<uint32_t>(newCapacity);
+	FreeRange(pool, static_cast<uint32_t>(oldCapacity), static_cast<uint32_t>(newCapacity - oldCapacity));
+	++mGrowNum;
+}
+
+void GeometryArena::AddFreeRange(Pool& pool, uint32_t offset, uint32_t count)
+{
+	auto offsetIterator = pool.FreeOffsets.emplace(offset, count);
+	auto sizeIterator = pool.FreeSizes.emplace(count, offsetIterator.first);
+	offsetIterator.first->second.FreeSizeListIterator = sizeIterator;
+}
+
+void GeometryArena::FreeRange(Pool& pool, uint32_t offset, uint32_t count)
+{
+	auto nextRangeIterator = pool.FreeOffsets.upper_bound(offset);
+	auto prevRangeIterator = nextRangeIterator;
+	if (prevRangeIterator != pool.FreeOffsets.begin())
+	{
+		prevRangeIterator--;
+	}
+	else
+	{
+		prevRangeIterator = pool.FreeOffsets.end();
+	}
+
+	if (prevRangeIterator != pool.FreeOffsets.end() && offset == prevRangeIterator->first + prevRangeIterator->second.Size)
+	{
+		offset = prevRangeIterator->first;
+		count += prevRangeIterator->second.Size;
+		pool.FreeSizes.erase(prevRangeIterator->second.FreeSizeListIterator);
+		pool.FreeOffsets.erase(prevRangeIterator);
+	}
+	if (nextRangeIterator != pool.FreeOffsets.end() && offset + count == nextRangeIterator->first)
+	{
+		count += nextRangeIterator->second.Size;
+		pool.FreeSizes.erase(nextRangeIterator->second.FreeSizeListIterator);
+		pool.FreeOffsets.erase(nextRangeIterator);
+	}
+	AddFreeRange(pool, offset, count);
+}
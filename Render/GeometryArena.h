@@ -0,0 +1,95 @@
+#ifndef __GEOMETRYARENA_H_
+#define __GEOMETRYARENA_H_
+
+#include "Core.h"
+#include "IndexBuffer.h"
+#include "VertexBuffer.h"
+
+class CommandList;
+
+class GeometryArena
+{
+public:
+	struct Allocation
+	{
+		uint32_t Pool;
+		uint32_t Offset;
+		uint32_t Count;
+	};
+
+	struct Statistics
+	{
+		uint32_t PoolNum;
+		uint32_t AllocationNum;
+		uint32_t FreeRangeNum;
+		uint32_t GrowNum;
+		uint64_t CapacityBytes;
+		uint64_t UsedBytes;
+		uint64_t LargestFreeBytes;
+	};
+
+	static const uint32_t InvalidPool = ~0u;
+
+	explicit GeometryArena(size_t initialPoolSize = 4 * 1024 * 1024);
+	virtual ~GeometryArena();
+
+	Allocation AllocateVertices(CommandList& commandList, size_t numVertices, size_t vertexStride, const void* vertexData);
+	Allocation AllocateIndices(CommandList& commandList, size_t numIndices, DXGI_FORMAT indexFormat, const void* indexData);
+	void Free(const Allocation& allocation);
+	void ReleaseFreedAllocations(uint64_t finishedFrame);
+
+	// Bind the pool buffer holding the allocation. The arena lock is held for the whole call, as a
+	// concurrent allocation may grow the pool and replace its buffer.
+	void SetVertexBuffer(CommandList& commandList, uint32_t slot, const Allocation& allocation) const;
+	void SetIndexBuffer(CommandList& commandList, const Allocation& allocation) const;
+
+	Statistics GetStatistics() const;
+
+private:
+	GeometryArena(const GeometryArena& copy) = delete;
+	GeometryArena& operator=(const GeometryArena& other) = delete;
+
+	struct FreeRangeInfo
+	{
+		FreeRangeInfo(uint32_t size) : Size(size) {}
+		uint32_t Size;
+		std::multimap<uint32_t, std::map<uint32_t, FreeRangeInfo>::iterator>::iterator FreeSizeListIterator;
+	};
+
+	struct FreedAllocation
+	{
+		uint32_t Offset;
+		uint32_t Count;
+		uint64_t FrameNumber;
+	};
+
+	using FreeOffsetList = std::map<uint32_t, FreeRangeInfo>;
+	using FreeSizeList = std::multimap<uint32_t, FreeOffsetList::iterator>;
+
+	struct Pool
+	{
+		std::unique_ptr<VertexBuffer> Vertices;
+		std::unique_ptr<IndexBuffer> Indices;
+		DXGI_FORMAT IndexFormat;
+		size_t ElementSize;
+		uint32_t Capacity;
+		uint32_t UsedNum;
+		uint32_t AllocationNum;
+		FreeOffsetList FreeOffsets;
+		FreeSizeList FreeSizes;
+		std::queue<FreedAllocation> FreedAllocations;
+	};
+
+	Allocation Allocate(CommandList& commandList, uint32_t poolIndex, size_t count, const void* data);
+	uint32_t FindPool(size_t elementSize, DXGI_FORMAT indexFormat);
+	void Grow(CommandList& commandList, Pool& pool, uint32_t minCount);
+	void AddFreeRange(Pool& pool, uint32_t offset, uint32_t count);
+	void FreeRange(Pool& pool, uint32_t offset, uint32_t count);
+
+	std::vector<std::unique_ptr<Pool>> mPools;
+	size_t mInitialPoolSize;
+	uint32_t mGrowNum;
+	mutable std::mutex mMutex;
+};
+
+#endif
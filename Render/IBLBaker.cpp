@@ -0,0 +1,275 @@
+#include "IBLBaker.h"
+#include "JobSystem.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+using namespace DirectX;
+
+namespace
+{
+	const float PI = 3.14159265358979323846f;
+
+	const uint32_t SHMagic = 0x20394853;
+
+	struct PrefilterSample
+	{
+		XMFLOAT3 Direction;
+		float Weight;
+		float Mip;
+	};
+
+	void EvaluateSHBasis(float x, float y, float z, float basis[IrradianceSH::CoefficientNum])
+	{
+		basis[0] = 0.282095f;
+		basis[1] = 0.488603f * y;
+		basis[2] = 0.488603f * z;
+		basis[3] = 0.488603f * x;
+		basis[4] = 1.092548f * x * y;
+		basis[5] = 1.092548f * y * z;
+		basis[6] = 0.315392f * (3.0f * z * z - 1.0f);
+		basis[7] = 1.092548f * x * z;
+		basis[8] = 0.546274f * (x * x - y * y);
+	}
+
+	XMVECTOR SampleFace(const CubemapImage& cubemap, uint32_t face, uint32_t mip, float u, float v)
+	{
+		uint32_t size = cubemap.GetMipSize(mip);
+		const XMFLOAT4* texels = cubemap.GetTexels(face, mip);
+
+		float x = std::min(std::max(u * size - 0.5f, 0.0f), size - 1.0f);
+		float y = std::min(std::max(v * size - 0.5f, 0.0f), size - 1.0f);
+		uint32_t x0 = static_cast<uint32_t>(x);
+		uint32_t y0 = static_cast<uint32_t>(y);
+		uint32_t x1 = std::min(x0 + 1, size - 1);
+		uint32_t y1 = std::min(y0 + 1, size - 1);
+		float tx = x - x0;
+		float ty = y - y0;
+
+		XMVECTOR top = XMVectorLerp(XMLoadFloat4(&texels[y0 * size + x0]), XMLoadFloat4(&texels[y0 * size + x1]), tx);
+		XMVECTOR bottom = XMVectorLerp(XMLoadFloat4(&texels[y1 * size + x0]), XMLoadFloat4(&texels[y1 * size + x1]), tx);
+		return XMVectorLerp(top, bottom, ty);
+	}
+
+	std::vector<PrefilterSample> BuildPrefilterSamples(float roughness, uint32_t sampleNum, uint32_t environmentSize, uint32_t environmentMipLevels)
+	{
+		float alpha = roughness * roughness;
+		float alphaSq = alpha * alpha;
+		float texelSolidAngle = 4.0f * PI / (6.0f * environmentSize * environmentSize);
+
+		std::vector<PrefilterSample> samples;
+		samples.reserve(sampleNum);
+		for (uint32_t i = 0; i < sampleNum; ++i)
+		{
+			uint32_t bits = i;
+			bits = (bits << 16) | (bits >> 16);
+			bits = ((bits & 0x55555555u) << 1) | ((bits & 0xAAAAAAAAu) >> 1);
+			bits = ((bits & 0x33333333u) << 2) | ((bits & 0xCCCCCCCCu) >> 2);
+			bits = ((bits & 0x0F0F0F0Fu) << 4) | ((bits & 0xF0F0F0F0u) >> 4);
+			bits = ((bits & 0x00FF00FFu) << 8) | ((bits & 0xFF00FF00u) >> 8);
+
+			float xi0 = (i + 0.5f) / sampleNum;
+			float xi1 = bits * 2.3283064365386963e-10f;
+
+			float phi = 2.0f * PI * xi0;
+			float cosTheta = std::sqrt((1.0f - xi1) / (1.0f + (alphaSq - 1.0f) * xi1));
+			float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+
+			float hx = sinTheta * std::cos(phi);
+			float hy = sinTheta * std::sin(phi);
+			float hz = cosTheta;
+
+			float lz = 2.0f * hz * hz - 1.0f;
+			if (lz <= 0.0f)
+			{
+				continue;
+			}
+
+			float d = cosTheta * cosTheta * (alphaSq - 1.0f) + 1.0f;
+			float pdf = alphaSq / (PI * d * d) * 0.25f;
+			float sampleSolidAngle = 1.0f / (sampleNum * pdf + 1e-4f);
+			float mip = roughness == 0.0f ? 0.0f : 0.5f * std::log2(sampleSolidAngle / texelSolidAngle) + 1.0f;
+
+			PrefilterSample sample;
+			sample.Direction = XMFLOAT3(2.0f * hz * hx, 2.0f * hz * hy, lz);
+			sample.Weight = lz;
+			sample.Mip = std::min(std::max(mip, 0.0f), environmentMipLevels - 1.0f);
+			samples.push_back(sample);
+		}
+		return samples;
+	}
+}
+
+IrradianceSH IBLBaker::ProjectIrradianceSH(const CubemapImage& environment, uint32_t maxSampleSize)
+{
+	uint32_t mip = 0;
+	while (mip + 1 < environment.GetMipLevels() && environment.GetMipSize(mip) > maxSampleSize)
+	{
+		++mip;
+	}
+	uint32_t size = environment.GetMipSize(mip);
+	float invSize = 1.0f / size;
+
+	XMVECTOR coefficients[IrradianceSH::CoefficientNum] = {};
+	float totalWeight = 0.0f;
+	std::mutex coefficientsMutex;
+
+	JobSystem::Get().ParallelFor(CubemapImage::FaceNum * size, 8, [&](size_t begin, size_t end)
+	{
+		XMVECTOR partial[IrradianceSH::CoefficientNum];
+		for (auto& coefficient : partial)
+		{
+			coefficient = XMVectorZero();
+		}
+		float partialWeight = 0.0f;
+
+		float basis[IrradianceSH::CoefficientNum];
+		for (size_t row = begin; row < end; ++row)
+		{
+			uint32_t face = static_cast<uint32_t>(row / size);
+			uint32_t y = static_cast<uint32_t>(row % size);
+			const XMFLOAT4* texels = environment.GetTexels(face, mip) + static_cast<size_t>(y) * size;
+
+			float v = (y + 0.5f) * invSize;
+			float localY = 2.0f * v - 1.0f;
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				float u = (x + 0.5f) * invSize;
+				float localX = 2.0f * u - 1.0f;
+				float distanceSq = 1.0f + localX * localX + localY * localY;
+				float weight = 4.0f * invSize * invSize / (distanceSq * std::sqrt(distanceSq));
+
+				XMFLOAT3 direction;
+				XMStoreFloat3(&direction, CubemapImage::GetTexelDirection(face, u, v));
+				EvaluateSHBasis(direction.x, direction.y, direction.z, basis);
+
+				XMVECTOR radiance = XMLoadFloat4(&texels[x]);
+				for (uint32_t i = 0; i < IrradianceSH::CoefficientNum; ++i)
+				{
+					partial[i] = XMVectorMultiplyAdd(radiance, XMVectorReplicate(basis[i] * weight), partial[i]);
+				}
+				partialWeight += weight;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(coefficientsMutex);
+		for (uint32_t i = 0; i < IrradianceSH::CoefficientNum; ++i)
+		{
+			coefficients[i] = XMVectorAdd(coefficients[i], partial[i]);
+		}
+		totalWeight += partialWeight;
+	});
+
+	const float bandScale[3] = { 1.0f, 2.0f / 3.0f, 0.25f };
+	float normalization = 4.0f * PI / totalWeight;
+
+	IrradianceSH irradiance;
+	for (uint32_t i = 0; i < IrradianceSH::CoefficientNum; ++i)
+	{
+		uint32_t band = i == 0 ? 0 : (i < 4 ? 1 : 2);
+		XMVECTOR coefficient = XMVectorScale(coefficients[i], normalization * bandScale[band]);
+		XMStoreFloat4(&irradiance.Coefficients[i], XMVectorSetW(coefficient, 0.0f));
+	}
+	return irradiance;
+}
+
+CubemapImage IBLBaker::PrefilterSpecular(const CubemapImage& environment, uint32_t size, uint32_t mipLevels, uint32_t sampleNum)
+{
+	CubemapImage prefiltered(size, mipLevels);
+	float baseMip = std::max(0.0f, std::log2(static_cast<float>(environment.GetSize()) / size));
+
+	for (uint32_t mip = 0; mip < prefiltered.GetMipLevels(); ++mip)
+	{
+		uint32_t mipSize = prefiltered.GetMipSize(mip);
+		float roughness = prefiltered.GetMipLevels() > 1 ? static_cast<float>(mip) / (prefiltered.GetMipLevels() - 1) : 0.0f;
+		auto samples = BuildPrefilterSamples(roughness, sampleNum, environment.GetSize(), environment.GetMipLevels());
+
+		JobSystem::Get().ParallelFor(CubemapImage::FaceNum * mipSize, 4, [&](size_t begin, size_t end)
+		{
+			for (size_t row = begin; row < end; ++row)
+			{
+				uint32_t face = static_cast<uint32_t>(row / mipSize);
+				uint32_t y = static_cast<uint32_t>(row % mipSize);
+				XMFLOAT4* dst = prefiltered.GetTexels(face, mip) + static_cast<size_t>(y) * mipSize;
+
+				for (uint32_t x = 0; x < mipSize; ++x)
+				{
+					XMVECTOR normal = CubemapImage::GetTexelDirection(face, (x + 0.5f) / mipSize, (y + 0.5f) / mipSize);
+					if (roughness == 0.0f)
+					{
+						XMStoreFloat4(&dst[x], SampleCubemap(environment, normal, baseMip));
+						continue;
+					}
+
+					XMVECTOR up = std::fabs(XMVectorGetZ(normal)) < 0.999f ? g_XMIdentityR2 : g_XMIdentityR0;
+					XMVECTOR tangent = XMVector3Normalize(XMVector3Cross(up, normal));
+					XMVECTOR bitangent = XMVector3Cross(normal, tangent);
+
+					XMVECTOR sum = XMVectorZero();
+					float weight = 0.0f;
+					for (const auto& sample : samples)
+					{
+						XMVECTOR direction = XMVectorMultiplyAdd(tangent, XMVectorReplicate(sample.Direction.x),
+															     XMVectorMultiplyAdd(bitangent, XMVectorReplicate(sample.Direction.y), XMVectorScale(normal, sample.Direction.z)));
+						sum = XMVectorMultiplyAdd(SampleCubemap(environment, direction, std::max(sample.Mip, baseMip)), XMVectorReplicate(sample.Weight), sum);
+						weight += sample.Weight;
+					}
+					XMStoreFloat4(&dst[x], XMVectorScale(sum, 1.0f / std::max(weight, 1e-4f)));
+				}
+			}
+		});
+	}
+
+	return prefiltered;
+}
+
+XMVECTOR XM_CALLCONV IBLBaker::SampleCubemap(const CubemapImage& cubemap, FXMVECTOR direction, float mip)
+{
+	float u, v;
+	uint32_t face = CubemapImage::GetFaceCoordinate(direction, u, v);
+
+	mip = std::min(std::max(mip, 0.0f), cubemap.GetMipLevels() - 1.0f);
+	uint32_t mip0 = static_cast<uint32_t>(mip);
+	uint32_t mip1 = std::min(mip0 + 1, cubemap.GetMipLevels() - 1);
+	XMVECTOR sample0 = SampleFace(cubemap, face, mip0, u, v);
+	if (mip1 == mip0)
+	{
+		return sample0;
+	}
+	return XMVectorLerp(sample0, SampleFace(cubemap, face, mip1, u, v), mip - mip0);
+}
+
+bool IBLBaker::SaveIrradianceSH(const std::string& fileName, const IrradianceSH& irradiance)
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&SHMagic), sizeof(SHMagic));
+	file.write(reinterpret_cast<const char*>(irradiance.Coefficients), sizeof(irradiance.Coefficients));
+	return static_cast<bool>(file);
+}
+
+bool IBLBaker::LoadIrradianceSH(const std::string& fileName, IrradianceSH& irradiance)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	uint32_t magic = 0;
+	IrradianceSH result;
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char*>(result.Coefficients), sizeof(result.Coefficients));
+	if (!file || magic != SHMagic)
+	{
+		return false;
+	}
+	irradiance = result;
+	return true;
+}
@@ -0,0 +1,24 @@
+#ifndef __IBLBAKER_H_
+#define __IBLBAKER_H_
+
+#include "CubemapBaker.h"
+
+struct IrradianceSH
+{
+	static const uint32_t CoefficientNum = 9;
+
+	DirectX::XMFLOAT4 Coefficients[CoefficientNum];
+};
+
+namespace IBLBaker
+{
+	IrradianceSH ProjectIrradianceSH(const CubemapImage& environment, uint32_t maxSampleSize = 64);
+	CubemapImage PrefilterSpecular(const CubemapImage& environment, uint32_t size, uint32_t mipLevels, uint32_t sampleNum = 64);
+
+	DirectX::XMVECTOR XM_CALLCONV SampleCubemap(const CubemapImage& cubemap, DirectX::FXMVECTOR direction, float mip);
+
+	bool SaveIrradianceSH(const std::string& fileName, const IrradianceSH& irradiance);
+	bool LoadIrradianceSH(const std::string& fileName, IrradianceSH& irradiance);
+}
+
+#endif
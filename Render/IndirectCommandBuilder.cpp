@@ -0,0 +1,50 @@
+#include "IndirectCommandBuilder.h"
+
+using namespace DirectX;
+
+IndirectCommandBuilder::IndirectCommandBuilder() {}
+
+IndirectCommandBuilder::~IndirectCommandBuilder() {}
+
+void IndirectCommandBuilder::Clear()
+{
+	mCommands.clear();
+	mBatches.clear();
+	mCullItems.clear();
+}
+
+uint32_t IndirectCommandBuilder::BeginBatch()
+{
+	mBatches.push_back({ GetCommandCount(), 0 });
+	return GetBatchCount() - 1;
+}
+
+void IndirectCommandBuilder::Add(uint32_t objectIndex, const D3D12_DRAW_INDEXED_ARGUMENTS& arguments)
+{
+	Add(objectIndex, arguments, BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX)));
+}
+
+void IndirectCommandBuilder::Add(uint32_t objectIndex, const D3D12_DRAW_INDEXED_ARGUMENTS& arguments, const BoundingBox& bounds)
+{
+	if (mBatches.empty())
+	{
+		throw std::exception("Indirect commands must be added to a batch");
+	}
+
+	Batch& batch = mBatches.back();
+	mCommands.push_back({ objectIndex, arguments });
+	mCullItems.push_back({ bounds.Center, GetBatchCount() - 1, bounds.Extents, batch.FirstCommand });
+	++batch.CommandCount;
+}
+
+void IndirectCommandBuilder::GetArgumentDescs(uint32_t objectIndexParameter, D3D12_INDIRECT_ARGUMENT_DESC descs[ArgumentNum])
+{
+	descs[0] = {};
+	descs[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+	descs[0].Constant.RootParameterIndex = objectIndexParameter;
+	descs[0].Constant.DestOffsetIn32BitValues = 0;
+	descs[0].Constant.Num32BitValuesToSet = 1;
+
+	descs[1] = {};
+	descs[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+}
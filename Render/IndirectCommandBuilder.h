@@ -0,0 +1,80 @@
+#ifndef __INDIRECTCOMMANDBUILDER_H_
+#define __INDIRECTCOMMANDBUILDER_H_
+
+#include "Core.h"
+
+class IndirectCommandBuilder
+{
+public:
+	struct Command
+	{
+		uint32_t ObjectIndex;
+		D3D12_DRAW_INDEXED_ARGUMENTS Draw;
+	};
+
+	struct Batch
+	{
+		uint32_t FirstCommand;
+		uint32_t CommandCount;
+	};
+
+	struct CullItem
+	{
+		DirectX::XMFLOAT3 Center;
+		uint32_t Batch;
+		DirectX::XMFLOAT3 Extents;
+		uint32_t BatchFirstCommand;
+	};
+
+	static const uint32_t ArgumentNum = 2;
+	static const size_t CommandStride = sizeof(Command);
+
+	IndirectCommandBuilder();
+	virtual ~IndirectCommandBuilder();
+
+	void Clear();
+	uint32_t BeginBatch();
+	void Add(uint32_t objectIndex, const D3D12_DRAW_INDEXED_ARGUMENTS& arguments);
+	void Add(uint32_t objectIndex, const D3D12_DRAW_INDEXED_ARGUMENTS& arguments, const DirectX::BoundingBox& bounds);
+
+	const std::vector<Command>& GetCommands() const
+	{
+		return mCommands;
+	}
+
+	const std::vector<Batch>& GetBatches() const
+	{
+		return mBatches;
+	}
+
+	const std::vector<CullItem>& GetCullItems() const
+	{
+		return mCullItems;
+	}
+
+	uint32_t GetCommandCount() const
+	{
+		return static_cast<uint32_t>(mCommands.size());
+	}
+
+	uint32_t GetBatchCount() const
+	{
+		return static_cast<uint32_t>(mBatches.size());
+	}
+
+	static void GetArgumentDescs(uint32_t objectIndexParameter, D3D12_INDIRECT_ARGUMENT_DESC descs[ArgumentNum]);
+
+private:
+	IndirectCommandBuilder(const IndirectCommandBuilder& copy) = delete;
+	IndirectCommandBuilder& operator=(const IndirectCommandBuilder& other) = delete;
+
+	std::vector<Command> mCommands;
+	std::vector<Batch> mBatches;
+	std::vector<CullItem> mCullItems;
+};
+
+static_assert(offsetof(IndirectCommandBuilder::Command, Draw) == sizeof(uint32_t), "Object index must precede the draw arguments");
+static_assert(IndirectCommandBuilder::CommandStride == sizeof(uint32_t) + sizeof(D3D12_DRAW_INDEXED_ARGUMENTS), "Indirect commands must be tightly packed");
+static_assert(sizeof(IndirectCommandBuilder::CullItem) == 32, "Cull items must match the culling shader layout");
+
+#endif
@@ -0,0 +1,44 @@
+#include "IndirectCullPSO.h"
+#include "Application.h"
+
+
+IndirectCullPSO::IndirectCullPSO()
+{
+	auto device = Application::Get().GetDevice();
+
+	D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData = {};
+	featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+	if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &featureData, sizeof(featureData))))
+	{
+		featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+	}
+
+	CD3DX12_ROOT_PARAMETER1 rootParameters[IndirectCullRS::NumRootParameters];
+	rootParameters[IndirectCullRS::IndirectCullCB].InitAsConstants(sizeof(IndirectCullCB) / 4, 0);
+	rootParameters[IndirectCullRS::InputCommands].InitAsShaderResourceView(0);
+	rootParameters[IndirectCullRS::CullItems].InitAsShaderResourceView(1);
+	rootParameters[IndirectCullRS::OutputCommands].InitAsUnorderedAccessView(0);
+	rootParameters[IndirectCullRS::BatchCounters].InitAsUnorderedAccessView(1);
+
+	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc(IndirectCullRS::NumRootParameters, rootParameters);
+
+	mRootSignature.SetRootSignatureDesc(rootSignatureDesc.Desc_1_1, featureData.HighestVersion);
+
+	struct PipelineStateStream
+	{
+		CD3DX12_PIPELINE_STATE_STREAM_ROOT_SIGNATURE pRootSignature;
+		CD3DX12_PIPELINE_STATE_STREAM_CS CS;
+	} pipelineStateStream;
+
+	ComPtr<ID3DBlob> shaderIndirectCullCS = Utility::ShaderCompile(L"D:\\Files\\Code\\C++\\RTRender\\RTRender\\Render\\Shader\\IndirectCull_CS.hlsl", nullptr, "main", "cs_5_1");
+	pipelineStateStream.pRootSignature = mRootSignature.GetRootSignature().Get();
+	pipelineStateStream.CS = {
+		reinterpret_cast<BYTE*>(shaderIndirectCullCS->GetBufferPointer()),
+		shaderIndirectCullCS->GetBufferSize()
+	};
+
+	D3D12_PIPELINE_STATE_STREAM_DESC pipelineStateStreamDesc = {
+		sizeof(PipelineStateStream), &pipelineStateStream
+	};
+	ThrowIfFailed(device->CreatePipelineState(&pipelineStateStreamDesc, IID_PPV_ARGS(&mPipelineState)));
+}
@@ -0,0 +1,46 @@
+#ifndef __INDIRECTCULLPSO_H_
+#define __INDIRECTCULLPSO_H_
+
+#include "Core.h"
+#include "RootSignature.h"
+
+struct IndirectCullCB
+{
+	DirectX::XMFLOAT4 FrustumPlanes[6];
+	uint32_t CommandCount;
+};
+
+namespace IndirectCullRS
+{
+	enum
+	{
+		IndirectCullCB,
+		InputCommands,
+		CullItems,
+		OutputCommands,
+		BatchCounters,
+		NumRootParameters
+	};
+}
+
+class IndirectCullPSO
+{
+public:
+	IndirectCullPSO();
+
+	const RootSignature& GetRootSignature() const
+	{
+		return mRootSignature;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> GetPipelineState() const
+	{
+		return mPipelineState;
+	}
+
+private:
+	RootSignature mRootSignature;
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> mPipelineState;
+};
+
+#endif
@@ -0,0 +1,128 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+JobSystem::JobSystem(uint32_t workerNum) : mbRunning(true)
+{
+	if (workerNum == 0)
+	{
+		workerNum = std::max(2u, std::thread::hardware_concurrency()) - 1;
+	}
+
+	mWorkers.reserve(workerNum);
+	for (uint32_t i = 0; i < workerNum; ++i)
+	{
+		mWorkers.emplace_back(&JobSystem::WorkerThread, this);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mJobsMutex);
+		mbRunning = false;
+	}
+	mJobsCV.notify_all();
+
+	for (auto& worker : mWorkers)
+	{
+		worker.join();
+	}
+}
+
+JobSystem& JobSystem::Get()
+{
+	static JobSystem sJobSystem;
+	return sJobSystem;
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grainSize, const RangeFunction& func)
+{
+	if (count == 0) return;
+
+	grainSize = std::max<size_t>(1, grainSize);
+	size_t jobNum = (count + grainSize - 1) / grainSize;
+	if (jobNum == 1 || mWorkers.empty())
+	{
+		func(0, count);
+		return;
+	}
+
+	std::atomic_size_t remainingJobs(jobNum);
+	std::exception_ptr firstException;
+	std::mutex exceptionMutex;
+
+	{
+		std::lock_guard<std::mutex> lock(mJobsMutex);
+		for (size_t i = 0; i < jobNum; ++i)
+		{
+			size_t begin = i * grainSize;
+			size_t end = std::min(count, begin + grainSize);
+			mJobs.push([&, begin, end]()
+			{
+				try
+				{
+					func(begin, end);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> guard(exceptionMutex);
+					if (!firstException)
+					{
+						firstException = std::current_exception();
+					}
+				}
+				--remainingJobs;
+			});
+		}
+	}
+	mJobsCV.notify_all();
+
+	while (remainingJobs > 0)
+	{
+		if (!TryRunPendingJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	if (firstException)
+	{
+		std::rethrow_exception(firstException);
+	}
+}
+
+bool JobSystem::TryRunPendingJob()
+{
+	std::function<void()> job;
+	{
+		std::lock_guard<std::mutex> lock(mJobsMutex);
+		if (mJobs.empty())
+		{
+			return false;
+		}
+		job = std::move(mJobs.front());
+		mJobs.pop();
+	}
+	job();
+	return true;
+}
+
+void JobSystem::WorkerThread()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mJobsMutex);
+			mJobsCV.wait(lock, [this] { return !mbRunning || !mJobs.empty(); });
+			if (!mbRunning && mJobs.empty())
+			{
+				return;
+			}
+			job = std::move(mJobs.front());
+			mJobs.pop();
+		}
+		job();
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef __JOBSYSTEM_H_
+#define __JOBSYSTEM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class JobSystem
+{
+public:
+	using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+	explicit JobSystem(uint32_t workerNum = 0);
+	virtual ~JobSystem();
+
+	static JobSystem& Get();
+
+	void ParallelFor(size_t count, size_t grainSize, const RangeFunction& func);
+
+	uint32_t GetWorkerCount() const
+	{
+		return static_cast<uint32_t>(mWorkers.size());
+	}
+
+private:
+	JobSystem(const JobSystem& copy) = delete;
+	JobSystem& operator=(const JobSystem& other) = delete;
+
+	bool TryRunPendingJob();
+	void WorkerThread();
+
+	std::vector<std::thread> mWorkers;
+	std::queue<std::function<void()>> mJobs;
+	std::mutex mJobsMutex;
+	std::condition_variable mJobsCV;
+	bool mbRunning;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "Mesh.h"
 #include "Application.h"
+#include "JobSystem.h"
 
 const D3D12_INPUT_ELEMENT_DESC VertexPositionNormalTexture::InputElements[] =
 {
@@ -8,87 +9,276 @@ const D3D12_INPUT_ELEMENT_DESC VertexPositionNormalTexture::InputElements[] =
 	{ "TEXCOORD",   0, DXGI_FORMAT_R32G32_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
 };
 
+const D3D12_INPUT_ELEMENT_DESC VertexPositionNormalTextureQuantized::InputElements[] =
+{
+	{ "POSITION",   0, DXGI_FORMAT_R16G16B16A16_SNORM, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",     0, DXGI_FORMAT_R16G16_SNORM,       0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD",   0, DXGI_FORMAT_R16G16_FLOAT,       0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+};
+
 Mesh::Mesh()
-	: mIndexCount(0)
+	: mVertexAllocation({ GeometryArena::InvalidPool, 0, 0 }),
+	mIndexAllocation({ GeometryArena::InvalidPool, 0, 0 }),
+	mIndexCount(0),
+	mStatistics({}),
+	mVertexFormat(VertexFormat::Float),
+	mQuantizationBounds({})
 {}
 
-Mesh::~Mesh() {}
+Mesh::~Mesh()
+{
+	GeometryArena& arena = Application::Get().GetGeometryArena();
+	arena.Free(mVertexAllocation);
+	arena.Free(mIndexAllocation);
+}
 
-void Mesh::Draw(CommandList& commandList)
+void Mesh::Bind(CommandList& commandList) const
 {
+	GeometryArena& arena = Application::Get().GetGeometryArena();
 	commandList.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	commandList.SetVertexBuffer(0, mVertexBuffer);
-	commandList.SetIndexBuffer(mIndexBuffer);
-	commandList.DrawIndexed(mIndexCount);
+	arena.SetVertexBuffer(commandList, 0, mVertexAllocation);
+	arena.SetIndexBuffer(commandList, mIndexAllocation);
 }
 
-std::unique_ptr<Mesh> Mesh::CreateSphere(CommandList& commandList, float diameter, size_t tessellation, bool rhcoords)
+void Mesh::DrawRange(CommandList& commandList, uint32_t indexCount, uint32_t startIndex, uint32_t instanceCount) const
 {
-	VertexCollection vertices;
-	IndexCollection indices;
+	D3D12_DRAW_INDEXED_ARGUMENTS arguments = GetRangeArguments(indexCount, startIndex, instanceCount);
+	commandList.DrawIndexed(arguments.IndexCountPerInstance, arguments.InstanceCount, arguments.StartIndexLocation, arguments.BaseVertexLocation, arguments.StartInstanceLocation);
+}
 
-	if (tessellation < 3)
-		throw std::out_of_range("tessellationΧ");
+D3D12_DRAW_INDEXED_ARGUMENTS Mesh::GetRangeArguments(uint32_t indexCount, uint32_t startIndex, uint32_t instanceCount) const
+{
+	D3D12_DRAW_INDEXED_ARGUMENTS arguments;
+	arguments.IndexCountPerInstance = indexCount;
+	arguments.InstanceCount = instanceCount;
+	arguments.StartIndexLocation = mIndexAllocation.Offset + startIndex;
+	arguments.BaseVertexLocation = static_cast<int32_t>(mVertexAllocation.Offset);
+	arguments.StartInstanceLocation = 0;
+	return arguments;
+}
 
-	float radius = diameter / 2.0f;
-	size_t verticalSegments = tessellation;
-	size_t horizontalSegments = tessellation * 2;
+bool Mesh::SharesBuffers(const Mesh& other) const
+{
+	return mVertexAllocation.Pool == other.mVertexAllocation.Pool && mIndexAllocation.Pool == other.mIndexAllocation.Pool;
+}
 
-	for (size_t i = 0; i <= verticalSegments; i++)
-	{
-		float v = 1 - (float)i / verticalSegments;
+D3D12_DRAW_INDEXED_ARGUMENTS Mesh::GetDrawArguments(uint32_t instanceCount) const
+{
+	return GetRangeArguments(mIndexCount, 0, instanceCount);
+}
+
+D3D12_DRAW_INDEXED_ARGUMENTS Mesh::GetLodDrawArguments(uint32_t lod, uint32_t instanceCount) const
+{
+	const Lod& level = mLods[std::min(lod, GetLodCount() - 1)];
+	return GetRangeArguments(level.IndexCount, level.IndexOffset, instanceCount);
+}
 
-		float latitude = (i * XM_PI / verticalSegments) - XM_PIDIV2;
-		float dy, dxz;
+void Mesh::GetMeshletDrawArguments(const std::vector<uint32_t>& meshlets, std::vector<D3D12_DRAW_INDEXED_ARGUMENTS>& arguments) const
+{
+	arguments.clear();
 
-		XMScalarSinCos(&dy, &dxz, latitude);
+	size_t i = 0;
+	while (i < meshlets.size())
+	{
+		const Meshlet& first = mMeshlets.Meshlets[meshlets[i]];
+		uint32_t primitiveCount = first.PrimitiveCount;
 
-		for (size_t j = 0; j <= horizontalSegments; j++)
+		while (++i < meshlets.size() && meshlets[i] == meshlets[i - 1] + 1)
 		{
-			float u = (float)j / horizontalSegments;
+			primitiveCount += mMeshlets.Meshlets[meshlets[i]].PrimitiveCount;
+		}
 
-			float longitude = j * XM_2PI / horizontalSegments;
-			float dx, dz;
+		arguments.push_back(GetRangeArguments(primitiveCount * 3, first.PrimitiveOffset * 3, 1));
+	}
+}
 
-			XMScalarSinCos(&dx, &dz, longitude);
+void Mesh::Draw(CommandList& commandList)
+{
+	Bind(commandList);
+	DrawRange(commandList, mIndexCount, 0);
+}
 
-			dx *= dxz;
-			dz *= dxz;
+void Mesh::Draw(CommandList& commandList, const std::vector<uint32_t>& meshlets)
+{
+	Bind(commandList);
 
-			XMVECTOR normal = XMVectorSet(dx, dy, dz, 0);
-			XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
+	size_t i = 0;
+	while (i < meshlets.size())
+	{
+		const Meshlet& first = mMeshlets.Meshlets[meshlets[i]];
+		uint32_t primitiveCount = first.PrimitiveCount;
 
-			vertices.push_back(VertexPositionNormalTexture(normal * radius, normal, textureCoordinate));
+		while (++i < meshlets.size() && meshlets[i] == meshlets[i - 1] + 1)
+		{
+			primitiveCount += mMeshlets.Meshlets[meshlets[i]].PrimitiveCount;
 		}
+
+		DrawRange(commandList, primitiveCount * 3, first.PrimitiveOffset * 3);
 	}
+}
+
+XMMATRIX Mesh::GetDequantizationMatrix() const
+{
+	if (mVertexFormat != VertexFormat::Quantized)
+		return XMMatrixIdentity();
+
+	return XMMatrixScaling(mQuantizationBounds.Extent.x, mQuantizationBounds.Extent.y, mQuantizationBounds.Extent.z) *
+		XMMatrixTranslation(mQuantizationBounds.Center.x, mQuantizationBounds.Center.y, mQuantizationBounds.Center.z);
+}
+
+void Mesh::DrawLod(CommandList& commandList, uint32_t lod)
+{
+	const Lod& level = mLods[std::min(lod, GetLodCount() - 1)];
+
+	Bind(commandList);
+	DrawRange(commandList, level.IndexCount, level.IndexOffset);
+}
+
+void Mesh::DrawInstanced(CommandList& commandList, uint32_t instanceCount)
+{
+	Bind(commandList);
+	DrawRange(commandList, mIndexCount, 0, instanceCount);
+}
+
+void Mesh::DrawLodInstanced(CommandList& commandList, uint32_t lod, uint32_t instanceCount)
+{
+	const Lod& level = mLods[std::min(lod, GetLodCount() - 1)];
+
+	Bind(commandList);
+	DrawRange(commandList, level.IndexCount, level.IndexOffset, instanceCount);
+}
+
+uint32_t Mesh::SelectLod(float viewDepth, float scale, CXMMATRIX projection, float viewportHeight, float pixelError) const
+{
+	float pixelsPerUnit = XMVectorGetY(projection.r[1]) * viewportHeight * 0.5f / std::max(viewDepth, 1e-4f);
+
+	uint32_t lod = 0;
+	while (lod + 1 < GetLodCount() && mLods[lod + 1].Error * scale * pixelsPerUnit <= pixelError)
+	{
+		++lod;
+	}
+	return lod;
+}
+
+static const size_t GeneratorJobVertexNum = 4096;
+
+static void ComputeSinCosTable(std::vector<float>& sines, std::vector<float>& cosines, size_t count, float step, float offset)
+{
+	size_t paddedCount = (count + 3) & ~static_cast<size_t>(3);
+	sines.resize(paddedCount);
+	cosines.resize(paddedCount);
+
+	XMVECTOR lane = XMVectorSet(0, 1, 2, 3);
+	XMVECTOR angleStep = XMVectorReplicate(step);
+	XMVECTOR angleOffset = XMVectorReplicate(offset);
+	for (size_t i = 0; i < paddedCount; i += 4)
+	{
+		XMVECTOR angle = XMVectorMultiplyAdd(XMVectorAdd(lane, XMVectorReplicate(static_cast<float>(i))), angleStep, angleOffset);
+
+		XMVECTOR sine, cosine;
+		XMVectorSinCos(&sine, &cosine, angle);
 
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&sines[i]), sine);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&cosines[i]), cosine);
+	}
+}
+
+static inline XMVECTOR LoadLanes(const std::vector<float>& values, size_t i)
+{
+	return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&values[i]));
+}
+
+static inline void StoreLanes(float* lanes, FXMVECTOR value)
+{
+	XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes), value);
+}
+
+void Mesh::GenerateSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation)
+{
+	if (tessellation < 3)
+		throw std::out_of_range("tessellationΧ");
+
+	float radius = diameter / 2.0f;
+	size_t verticalSegments = tessellation;
+	size_t horizontalSegments = tessellation * 2;
 	size_t stride = horizontalSegments + 1;
 
-	for (size_t i = 0; i < verticalSegments; i++)
+	std::vector<float> latitudeSines, latitudeCosines;
+	std::vector<float> longitudeSines, longitudeCosines;
+	ComputeSinCosTable(latitudeSines, latitudeCosines, verticalSegments + 1, XM_PI / verticalSegments, -XM_PIDIV2);
+	ComputeSinCosTable(longitudeSines, longitudeCosines, stride, XM_2PI / horizontalSegments, 0.0f);
+
+	vertices.resize((verticalSegments + 1) * stride);
+	indices.resize(verticalSegments * stride * 6);
+
+	XMVECTOR lane = XMVectorSet(0, 1, 2, 3);
+	XMVECTOR uScale = XMVectorReplicate(1.0f / horizontalSegments);
+	XMVECTOR vRadius = XMVectorReplicate(radius);
+
+	JobSystem::Get().ParallelFor(verticalSegments + 1, std::max<size_t>(1, GeneratorJobVertexNum / stride), [&](size_t begin, size_t end)
 	{
-		for (size_t j = 0; j <= horizontalSegments; j++)
+		for (size_t i = begin; i < end; i++)
 		{
+			float v = 1 - (float)i / verticalSegments;
+			float dy = latitudeSines[i];
+			XMVECTOR dxz = XMVectorReplicate(latitudeCosines[i]);
+
+			VertexPositionNormalTexture* ring = &vertices[i * stride];
+			for (size_t j = 0; j < stride; j += 4)
+			{
+				XMVECTOR dx = XMVectorMultiply(LoadLanes(longitudeSines, j), dxz);
+				XMVECTOR dz = XMVectorMultiply(LoadLanes(longitudeCosines, j), dxz);
+				XMVECTOR u = XMVectorMultiply(XMVectorAdd(lane, XMVectorReplicate((float)j)), uScale);
+
+				alignas(16) float nx[4], nz[4], px[4], pz[4], uu[4];
+				StoreLanes(nx, dx);
+				StoreLanes(nz, dz);
+				StoreLanes(px, XMVectorMultiply(dx, vRadius));
+				StoreLanes(pz, XMVectorMultiply(dz, vRadius));
+				StoreLanes(uu, u);
+
+				size_t count = std::min<size_t>(4, stride - j);
+				for (size_t k = 0; k < count; k++)
+				{
+					ring[j + k] = VertexPositionNormalTexture(XMFLOAT3(px[k], dy * radius, pz[k]), XMFLOAT3(nx[k], dy, nz[k]), XMFLOAT2(uu[k], v));
+				}
+			}
+
+			if (i == verticalSegments)
+				continue;
+
+			uint32_t* ringIndices = &indices[i * stride * 6];
 			size_t nextI = i + 1;
-			size_t nextJ = (j + 1) % stride;
-
-			indices.push_back(static_cast<uint16_t>(i * stride + j));
-			indices.push_back(static_cast<uint16_t>(nextI * stride + j));
-			indices.push_back(static_cast<uint16_t>(i * stride + nextJ));
-
-			indices.push_back(static_cast<uint16_t>(i * stride + nextJ));
-			indices.push_back(static_cast<uint16_t>(nextI * stride + j));
-			indices.push_back(static_cast<uint16_t>(nextI * stride + nextJ));
+			for (size_t j = 0; j <= horizontalSegments; j++)
+			{
+				size_t nextJ = (j + 1) % stride;
+
+				*ringIndices++ = static_cast<uint32_t>(i * stride + j);
+				*ringIndices++ = static_cast<uint32_t>(nextI * stride + j);
+				*ringIndices++ = static_cast<uint32_t>(i * stride + nextJ);
+
+				*ringIndices++ = static_cast<uint32_t>(i * stride + nextJ);
+				*ringIndices++ = static_cast<uint32_t>(nextI * stride + j);
+				*ringIndices++ = static_cast<uint32_t>(nextI * stride + nextJ);
+			}
 		}
-	}
+	});
+}
+
+std::unique_ptr<Mesh> Mesh::CreateSphere(CommandList& commandList, float diameter, size_t tessellation, bool rhcoords, VertexFormat format)
+{
+	VertexCollection vertices;
+	IndexCollection indices;
+	GenerateSphere(vertices, indices, diameter, tessellation);
 
 	std::unique_ptr<Mesh> mesh(new Mesh());
 
-	mesh->Initialize(commandList, vertices, indices, rhcoords);
+	mesh->Initialize(commandList, vertices, indices, rhcoords, format);
 
 	return mesh;
 }
 
-std::unique_ptr<Mesh> Mesh::CreateCube(CommandList& commandList, float size, bool rhcoords)
+void Mesh::GenerateCube(VertexCollection& vertices, IndexCollection& indices, float size)
 {
 	const int FaceCount = 6;
 
@@ -110,9 +300,6 @@ std::unique_ptr<Mesh> Mesh::CreateCube(CommandList& commandList, float size, boo
 		{ 0, 0 },
 	};
 
-	VertexCollection vertices;
-	IndexCollection indices;
-
 	size /= 2;
 
 	for (int i = 0; i < FaceCount; i++)
@@ -123,50 +310,36 @@ std::unique_ptr<Mesh> Mesh::CreateCube(CommandList& commandList, float size, boo
 		XMVECTOR side1 = XMVector3Cross(normal, basis);
 		XMVECTOR side2 = XMVector3Cross(normal, side1);
 		size_t vbase = vertices.size();
-		indices.push_back(static_cast<uint16_t>(vbase + 0));
-		indices.push_back(static_cast<uint16_t>(vbase + 1));
-		indices.push_back(static_cast<uint16_t>(vbase + 2));
+		indices.push_back(static_cast<uint32_t>(vbase + 0));
+		indices.push_back(static_cast<uint32_t>(vbase + 1));
+		indices.push_back(static_cast<uint32_t>(vbase + 2));
 
-		indices.push_back(static_cast<uint16_t>(vbase + 0));
-		indices.push_back(static_cast<uint16_t>(vbase + 2));
-		indices.push_back(static_cast<uint16_t>(vbase + 3));
+		indices.push_back(static_cast<uint32_t>(vbase + 0));
+		indices.push_back(static_cast<uint32_t>(vbase + 2));
+		indices.push_back(static_cast<uint32_t>(vbase + 3));
 
 		vertices.push_back(VertexPositionNormalTexture((normal - side1 - side2) * size, normal, textureCoordinates[0]));
 		vertices.push_back(VertexPositionNormalTexture((normal - side1 + side2) * size, normal, textureCoordinates[1]));
 		vertices.push_back(VertexPositionNormalTexture((normal + side1 + side2) * size, normal, textureCoordinates[2]));
 		vertices.push_back(VertexPositionNormalTexture((normal + side1 - side2) * size, normal, textureCoordinates[3]));
 	}
-
-	std::unique_ptr<Mesh> mesh(new Mesh());
-
-	mesh->Initialize(commandList, vertices, indices, rhcoords);
-
-	return mesh;
 }
 
-static inline XMVECTOR GetCircleVector(size_t i, size_t tessellation)
+std::unique_ptr<Mesh> Mesh::CreateCube(CommandList& commandList, float size, bool rhcoords, VertexFormat format)
 {
-	float angle = i * XM_2PI / tessellation;
-	float dx, dz;
-
-	XMScalarSinCos(&dx, &dz, angle);
-
-	XMVECTORF32 v = { dx, 0, dz, 0 };
-	return v;
-}
+	VertexCollection vertices;
+	IndexCollection indices;
+	GenerateCube(vertices, indices, size);
 
-static inline XMVECTOR GetCircleTangent(size_t i, size_t tessellation)
-{
-	float angle = (i * XM_2PI / tessellation) + XM_PIDIV2;
-	float dx, dz;
+	std::unique_ptr<Mesh> mesh(new Mesh());
 
-	XMScalarSinCos(&dx, &dz, angle);
+	mesh->Initialize(commandList, vertices, indices, rhcoords, format);
 
-	XMVECTORF32 v = { dx, 0, dz, 0 };
-	return v;
+	return mesh;
 }
 
-static void CreateCylinderCap(VertexCollection& vertices, IndexCollection& indices, size_t tessellation, float height, float radius, bool isTop)
+static void CreateCylinderCap(VertexPositionNormalTexture* vertices, uint32_t* indices, size_t vbase, const std::vector<float>& sines, const std::vector<float>& cosines,
+							  size_t tessellation, float height, float radius, bool isTop)
 {
 	for (size_t i = 0; i < tessellation - 2; i++)
 	{
@@ -178,134 +351,194 @@ static void CreateCylinderCap(VertexCollection& vertices, IndexCollection& indic
 			std::swap(i1, i2);
 		}
 
-		size_t vbase = vertices.size();
-		indices.push_back(static_cast<uint16_t>(vbase));
-		indices.push_back(static_cast<uint16_t>(vbase + i1));
-		indices.push_back(static_cast<uint16_t>(vbase + i2));
+		*indices++ = static_cast<uint32_t>(vbase);
+		*indices++ = static_cast<uint32_t>(vbase + i1);
+		*indices++ = static_cast<uint32_t>(vbase + i2);
 	}
 
-	XMVECTOR normal = g_XMIdentityR1;
-	XMVECTOR textureScale = g_XMNegativeOneHalf;
+	XMFLOAT3 normal(0, isTop ? 1.0f : -1.0f, 0);
+	float y = normal.y * height;
 
-	if (!isTop)
-	{
-		normal = -normal;
-		textureScale *= g_XMNegateX;
-	}
+	XMVECTOR vRadius = XMVectorReplicate(radius);
+	XMVECTOR textureScaleU = XMVectorReplicate(isTop ? -0.5f : 0.5f);
+	XMVECTOR textureScaleV = g_XMNegativeOneHalf;
 
-	for (size_t i = 0; i < tessellation; i++)
+	for (size_t i = 0; i < tessellation; i += 4)
 	{
-		XMVECTOR circleVector = GetCircleVector(i, tessellation);
-
-		XMVECTOR position = (circleVector * radius) + (normal * height);
+		XMVECTOR sine = LoadLanes(sines, i);
+		XMVECTOR cosine = LoadLanes(cosines, i);
 
-		XMVECTOR textureCoordinate = XMVectorMultiplyAdd(XMVectorSwizzle<0, 2, 3, 3>(circleVector), textureScale, g_XMOneHalf);
+		alignas(16) float px[4], pz[4], u[4], v[4];
+		StoreLanes(px, XMVectorMultiply(sine, vRadius));
+		StoreLanes(pz, XMVectorMultiply(cosine, vRadius));
+		StoreLanes(u, XMVectorMultiplyAdd(sine, textureScaleU, g_XMOneHalf));
+		StoreLanes(v, XMVectorMultiplyAdd(cosine, textureScaleV, g_XMOneHalf));
 
-		vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+		size_t count = std::min<size_t>(4, tessellation - i);
+		for (size_t k = 0; k < count; k++)
+		{
+			vertices[i + k] = VertexPositionNormalTexture(XMFLOAT3(px[k], y, pz[k]), normal, XMFLOAT2(u[k], v[k]));
+		}
 	}
 }
 
-std::unique_ptr<Mesh> Mesh::CreateCone(CommandList& commandList, float diameter, float height, size_t tessellation, bool rhcoords)
+void Mesh::GenerateCone(VertexCollection& vertices, IndexCollection& indices, float diameter, float height, size_t tessellation)
 {
-	VertexCollection vertices;
-	IndexCollection indices;
-
 	if (tessellation < 3)
 		throw std::out_of_range("tessellationΧ");
 
 	height /= 2;
 
-	XMVECTOR topOffset = g_XMIdentityR1 * height;
-
 	float radius = diameter / 2;
 	size_t stride = tessellation + 1;
 
-	for (size_t i = 0; i <= tessellation; i++)
-	{
-		XMVECTOR circlevec = GetCircleVector(i, tessellation);
-
-		XMVECTOR sideOffset = circlevec * radius;
+	std::vector<float> sines, cosines;
+	ComputeSinCosTable(sines, cosines, stride, XM_2PI / tessellation, 0.0f);
 
-		float u = (float)i / tessellation;
+	vertices.resize(stride * 2 + tessellation);
+	indices.resize(stride * 3 + (tessellation - 2) * 3);
 
-		XMVECTOR textureCoordinate = XMLoadFloat(&u);
+	float slantLength = std::sqrt(4 * height * height + radius * radius);
+	float invSlantLength = slantLength > 0 ? 1.0f / slantLength : 0.0f;
+	float normalY = radius * invSlantLength;
 
-		XMVECTOR pt = sideOffset - topOffset;
+	XMVECTOR lane = XMVectorSet(0, 1, 2, 3);
+	XMVECTOR uScale = XMVectorReplicate(1.0f / tessellation);
+	XMVECTOR vRadius = XMVectorReplicate(radius);
+	XMVECTOR normalScale = XMVectorReplicate(2 * height * invSlantLength);
 
-		XMVECTOR normal = XMVector3Cross(GetCircleTangent(i, tessellation), topOffset - pt);
-		normal = XMVector3Normalize(normal);
+	for (size_t i = 0; i < stride; i += 4)
+	{
+		XMVECTOR sine = LoadLanes(sines, i);
+		XMVECTOR cosine = LoadLanes(cosines, i);
+
+		alignas(16) float nx[4], nz[4], px[4], pz[4], u[4];
+		StoreLanes(nx, XMVectorMultiply(sine, normalScale));
+		StoreLanes(nz, XMVectorMultiply(cosine, normalScale));
+		StoreLanes(px, XMVectorMultiply(sine, vRadius));
+		StoreLanes(pz, XMVectorMultiply(cosine, vRadius));
+		StoreLanes(u, XMVectorMultiply(XMVectorAdd(lane, XMVectorReplicate((float)i)), uScale));
+
+		size_t count = std::min<size_t>(4, stride - i);
+		for (size_t k = 0; k < count; k++)
+		{
+			size_t vertex = (i + k) * 2;
+			XMFLOAT3 normal(nx[k], normalY, nz[k]);
 
-		vertices.push_back(VertexPositionNormalTexture(topOffset, normal, g_XMZero));
-		vertices.push_back(VertexPositionNormalTexture(pt, normal, textureCoordinate + g_XMIdentityR1));
+			vertices[vertex] = VertexPositionNormalTexture(XMFLOAT3(0, height, 0), normal, XMFLOAT2(0, 0));
+			vertices[vertex + 1] = VertexPositionNormalTexture(XMFLOAT3(px[k], -height, pz[k]), normal, XMFLOAT2(u[k], 1));
 
-		indices.push_back(static_cast<uint16_t>(i * 2));
-		indices.push_back(static_cast<uint16_t>((i * 2 + 3) % (stride * 2)));
-		indices.push_back(static_cast<uint16_t>((i * 2 + 1) % (stride * 2)));
+			indices[(i + k) * 3] = static_cast<uint32_t>(vertex);
+			indices[(i + k) * 3 + 1] = static_cast<uint32_t>((vertex + 3) % (stride * 2));
+			indices[(i + k) * 3 + 2] = static_cast<uint32_t>((vertex + 1) % (stride * 2));
+		}
 	}
 
-	CreateCylinderCap(vertices, indices, tessellation, height, radius, false);
+	CreateCylinderCap(&vertices[stride * 2], &indices[stride * 3], stride * 2, sines, cosines, tessellation, height, radius, false);
+}
+
+std::unique_ptr<Mesh> Mesh::CreateCone(CommandList& commandList, float diameter, float height, size_t tessellation, bool rhcoords, VertexFormat format)
+{
+	VertexCollection vertices;
+	IndexCollection indices;
+	GenerateCone(vertices, indices, diameter, height, tessellation);
+
 	std::unique_ptr<Mesh> mesh(new Mesh());
 
-	mesh->Initialize(commandList, vertices, indices, rhcoords);
+	mesh->Initialize(commandList, vertices, indices, rhcoords, format);
 
 	return mesh;
 }
 
-std::unique_ptr<Mesh> Mesh::CreateTorus(CommandList& commandList, float diameter, float thickness, size_t tessellation, bool rhcoords)
+void Mesh::GenerateTorus(VertexCollection& vertices, IndexCollection& indices, float diameter, float thickness, size_t tessellation)
 {
-	VertexCollection vertices;
-	IndexCollection indices;
-
 	if (tessellation < 3)
 		throw std::out_of_range("tessellationΧ");
 
 	size_t stride = tessellation + 1;
 
-	for (size_t i = 0; i <= tessellation; i++)
-	{
-		float u = (float)i / tessellation;
-
-		float outerAngle = i * XM_2PI / tessellation - XM_PIDIV2;
-		XMMATRIX transform = XMMatrixTranslation(diameter / 2, 0, 0) * XMMatrixRotationY(outerAngle);
-
-		for (size_t j = 0; j <= tessellation; j++)
-		{
-			float v = 1 - (float)j / tessellation;
+	float radius = diameter / 2;
+	float halfThickness = thickness / 2;
 
-			float innerAngle = j * XM_2PI / tessellation + XM_PI;
-			float dx, dy;
+	std::vector<float> outerSines, outerCosines;
+	std::vector<float> innerSines, innerCosines;
+	ComputeSinCosTable(outerSines, outerCosines, stride, XM_2PI / tessellation, -XM_PIDIV2);
+	ComputeSinCosTable(innerSines, innerCosines, stride, XM_2PI / tessellation, XM_PI);
 
-			XMScalarSinCos(&dy, &dx, innerAngle);
-			XMVECTOR normal = XMVectorSet(dx, dy, 0, 0);
-			XMVECTOR position = normal * thickness / 2;
-			XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
+	vertices.resize(stride * stride);
+	indices.resize(stride * stride * 6);
 
-			position = XMVector3Transform(position, transform);
-			normal = XMVector3TransformNormal(normal, transform);
+	XMVECTOR lane = XMVectorSet(0, 1, 2, 3);
+	XMVECTOR vScale = XMVectorReplicate(1.0f / tessellation);
+	XMVECTOR vRadius = XMVectorReplicate(radius);
+	XMVECTOR vHalfThickness = XMVectorReplicate(halfThickness);
 
-			vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+	JobSystem::Get().ParallelFor(stride, std::max<size_t>(1, GeneratorJobVertexNum / stride), [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			float u = (float)i / tessellation;
+			XMVECTOR outerSine = XMVectorReplicate(outerSines[i]);
+			XMVECTOR outerCosine = XMVectorReplicate(outerCosines[i]);
+
+			VertexPositionNormalTexture* ring = &vertices[i * stride];
+			for (size_t j = 0; j < stride; j += 4)
+			{
+				XMVECTOR dx = LoadLanes(innerCosines, j);
+				XMVECTOR dy = LoadLanes(innerSines, j);
+				XMVECTOR ringRadius = XMVectorMultiplyAdd(dx, vHalfThickness, vRadius);
+				XMVECTOR v = XMVectorNegativeMultiplySubtract(XMVectorAdd(lane, XMVectorReplicate((float)j)), vScale, g_XMOne);
+
+				alignas(16) float nx[4], ny[4], nz[4], px[4], py[4], pz[4], vv[4];
+				StoreLanes(nx, XMVectorMultiply(dx, outerCosine));
+				StoreLanes(ny, dy);
+				StoreLanes(nz, XMVectorNegate(XMVectorMultiply(dx, outerSine)));
+				StoreLanes(px, XMVectorMultiply(ringRadius, outerCosine));
+				StoreLanes(py, XMVectorMultiply(dy, vHalfThickness));
+				StoreLanes(pz, XMVectorNegate(XMVectorMultiply(ringRadius, outerSine)));
+				StoreLanes(vv, v);
+
+				size_t count = std::min<size_t>(4, stride - j);
+				for (size_t k = 0; k < count; k++)
+				{
+					ring[j + k] = VertexPositionNormalTexture(XMFLOAT3(px[k], py[k], pz[k]), XMFLOAT3(nx[k], ny[k], nz[k]), XMFLOAT2(u, vv[k]));
+				}
+			}
+
+			uint32_t* ringIndices = &indices[i * stride * 6];
 			size_t nextI = (i + 1) % stride;
-			size_t nextJ = (j + 1) % stride;
+			for (size_t j = 0; j <= tessellation; j++)
+			{
+				size_t nextJ = (j + 1) % stride;
+
+				*ringIndices++ = static_cast<uint32_t>(i * stride + j);
+				*ringIndices++ = static_cast<uint32_t>(i * stride + nextJ);
+				*ringIndices++ = static_cast<uint32_t>(nextI * stride + j);
+
+				*ringIndices++ = static_cast<uint32_t>(i * stride + nextJ);
+				*ringIndices++ = static_cast<uint32_t>(nextI * stride + nextJ);
+				*ringIndices++ = static_cast<uint32_t>(nextI * stride + j);
+			}
+		}
+	});
+}
 
-			indices.push_back(static_cast<uint16_t>(i * stride + j));
-			indices.push_back(static_cast<uint16_t>(i * stride + nextJ));
-			indices.push_back(static_cast<uint16_t>(nextI * stride + j));
+std::unique_ptr<Mesh> Mesh::CreateTorus(CommandList& commandList, float diameter, float thickness, size_t tessellation, bool rhcoords, VertexFormat format)
+{
+	VertexCollection vertices;
+	IndexCollection indices;
+	GenerateTorus(vertices, indices, diameter, thickness, tessellation);
 
-			indices.push_back(static_cast<uint16_t>(i * stride + nextJ));
-			indices.push_back(static_cast<uint16_t>(nextI * stride + nextJ));
-			indices.push_back(static_cast<uint16_t>(nextI * stride + j));
-		}
-	}
 	std::unique_ptr<Mesh> mesh(new Mesh());
 
-	mesh->Initialize(commandList, vertices, indices, rhcoords);
+	mesh->Initialize(commandList, vertices, indices, rhcoords, format);
 
 	return mesh;
 }
 
-std::unique_ptr<Mesh> Mesh::CreatePlane(CommandList& commandList, float width, float height, bool rhcoords)
+void Mesh::GeneratePlane(VertexCollection& vertices, IndexCollection& indices, float width, float height)
 {
-	VertexCollection vertices =
+	vertices =
 	{
 		{ XMFLOAT3(-0.5f * width, 0.0f,  0.5f * height), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT2(0.0f, 0.0f) }, 
 		{ XMFLOAT3(0.5f * width, 0.0f,  0.5f * height), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT2(1.0f, 0.0f) }, 
@@ -313,14 +546,21 @@ std::unique_ptr<Mesh> Mesh::CreatePlane(CommandList& commandList, float width, f
 		{ XMFLOAT3(-0.5f * width, 0.0f, -0.5f * height), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT2(0.0f, 1.0f) }  
 	};
 
-	IndexCollection indices =
+	indices =
 	{
 		0, 3, 1, 1, 3, 2
 	};
+}
+
+std::unique_ptr<Mesh> Mesh::CreatePlane(CommandList& commandList, float width, float height, bool rhcoords, VertexFormat format)
+{
+	VertexCollection vertices;
+	IndexCollection indices;
+	GeneratePlane(vertices, indices, width, height);
 
 	std::unique_ptr<Mesh> mesh(new Mesh());
 
-	mesh->Initialize(commandList, vertices, indices, rhcoords);
+	mesh->Initialize(commandList, vertices, indices, rhcoords, format);
 
 	return mesh;
 }
@@ -340,16 +580,268 @@ static void ReverseWinding(IndexCollection& indices, VertexCollection& vertices)
 	}
 }
 
-void Mesh::Initialize(CommandList& commandList, VertexCollection& vertices, IndexCollection& indices, bool rhcoords)
+static const float* GetPositions(const VertexCollection& vertices)
 {
-	if (vertices.size() >= USHRT_MAX)
-		throw std::exception("Too many vertices for 16-bit index buffer");
+	return vertices.empty() ? nullptr : &vertices.data()->position.x;
+}
+
+static void OptimizeMesh(VertexCollection& vertices, IndexCollection& indices, Mesh::Statistics& statistics)
+{
+	const uint32_t CacheSize = 16;
+
+	statistics.Source = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size(), CacheSize);
+
+	std::vector<uint32_t> clusters;
+	indices = MeshOptimizer::OptimizeVertexCache(indices, vertices.size(), CacheSize, &clusters);
+	indices = MeshOptimizer::OptimizeOverdraw(indices, clusters, GetPositions(vertices), vertices.size(), sizeof(VertexPositionNormalTexture), CacheSize);
+
+	size_t uniqueVertexNum = 0;
+	std::vector<uint32_t> remap = MeshOptimizer::OptimizeVertexFetchRemap(indices, vertices.size(), uniqueVertexNum);
+	vertices = MeshOptimizer::RemapVertices(vertices, remap, uniqueVertexNum);
+
+	statistics.Optimized = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size(), CacheSize);
+}
+
+static std::vector<VertexPositionNormalTextureQuantized> QuantizeVertices(const VertexCollection& vertices, const QuantizationBounds& bounds)
+{
+	std::vector<VertexPositionNormalTextureQuantized> quantized(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		VertexQuantization::EncodePosition(&vertices[i].position.x, bounds, quantized[i].position);
+		VertexQuantization::EncodeOctahedral(&vertices[i].normal.x, quantized[i].normal);
+		quantized[i].textureCoordinate[0] = VertexQuantization::FloatToHalf(vertices[i].textureCoordinate.x);
+		quantized[i].textureCoordinate[1] = VertexQuantization::FloatToHalf(vertices[i].textureCoordinate.y);
+	}
+	return quantized;
+}
+
+static std::vector<Mesh::Lod> BuildLods(const VertexCollection& vertices, IndexCollection& indices)
+{
+	const float* positions = GetPositions(vertices);
+	const size_t stride = sizeof(VertexPositionNormalTexture);
+	float targetError = MeshSimplifier::ComputeExtent(positions, vertices.size(), stride) * 0.05f;
+
+	std::vector<Mesh::Lod> lods;
+	lods.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+
+	// Each level halves the previous one within its own error budget, so a LOD's error is the sum
+	// of the levels before it. A level that cannot shed at least 15% of its triangles ends the chain:
+	// meshes whose vertices are all on UV seams or borders (cube, cone, plane) keep only LOD0.
+	IndexCollection source(indices);
+	while (lods.size() < Mesh::MaxLodNum)
+	{
+		float error = 0.0f;
+		IndexCollection simplified = MeshSimplifier::Simplify(source, positions, vertices.size(), stride, source.size() / 2, targetError, &error);
+		if (simplified.empty() || simplified.size() * 100 > source.size() * 85)
+			break;
+
+		simplified = MeshOptimizer::OptimizeVertexCache(simplified, vertices.size());
+
+		lods.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(simplified.size()), lods.back().Error + error });
+		indices.insert(indices.end(), simplified.begin(), simplified.end());
+		source.swap(simplified);
+	}
+
+	return lods;
+}
+
+static void ProcessMesh(VertexCollection& vertices, IndexCollection& indices, bool rhcoords, Mesh::Statistics& statistics, MeshletData& meshlets, std::vector<Mesh::Lod>& lods)
+{
+	if (vertices.size() > UINT_MAX)
+		throw std::exception("Too many vertices for 32-bit index buffer");
+
+	// Without triangles every vertex is unreferenced and the optimizer would drop them all anyway;
+	// a single empty LOD keeps the LOD table valid for callers.
+	if (indices.empty())
+	{
+		vertices.clear();
+		statistics = {};
+		meshlets = MeshletData();
+		lods.assign(1, { 0, 0, 0.0f });
+		return;
+	}
 
 	if (!rhcoords)
 		ReverseWinding(indices, vertices);
 
-	commandList.CopyVertexBuffer(mVertexBuffer, vertices);
-	commandList.CopyIndexBuffer(mIndexBuffer, indices);
+	OptimizeMesh(vertices, indices, statistics);
+
+	meshlets = MeshletBuilder::Build(indices, GetPositions(vertices), vertices.size(), sizeof(VertexPositionNormalTexture));
+
+	lods = BuildLods(vertices, indices);
+}
+
+static std::vector<uint16_t> NarrowIndices(const IndexCollection& indices)
+{
+	std::vector<uint16_t> shortIndices;
+	shortIndices.reserve(indices.size());
+	for (uint32_t index : indices)
+	{
+		shortIndices.push_back(static_cast<uint16_t>(index));
+	}
+	return shortIndices;
+}
+
+void Mesh::Initialize(CommandList& commandList, VertexCollection& vertices, IndexCollection& indices, bool rhcoords, VertexFormat format)
+{
+	ProcessMesh(vertices, indices, rhcoords, mStatistics, mMeshlets, mLods);
+
+	commandList.CopyStructuredBuffer(mMeshletCullBuffer, mMeshlets.CullData);
+
+	if (!vertices.empty())
+	{
+		BoundingBox::CreateFromPoints(mBoundingBox, vertices.size(), &vertices.data()->position, sizeof(VertexPositionNormalTexture));
+		BoundingSphere::CreateFromPoints(mBoundingSphere, vertices.size(), &vertices.data()->position, sizeof(VertexPositionNormalTexture));
+	}
+
+	GeometryArena& arena = Application::Get().GetGeometryArena();
+
+	mVertexFormat = format;
+	if (mVertexFormat == VertexFormat::Quantized)
+	{
+		mQuantizationBounds = VertexQuantization::ComputeBounds(GetPositions(vertices), vertices.size(), sizeof(VertexPositionNormalTexture));
+		std::vector<VertexPositionNormalTextureQuantized> quantized = QuantizeVertices(vertices, mQuantizationBounds);
+		mVertexAllocation = arena.AllocateVertices(commandList, quantized.size(), sizeof(VertexPositionNormalTextureQuantized), quantized.data());
+	}
+	else
+	{
+		mVertexAllocation = arena.AllocateVertices(commandList, vertices.size(), sizeof(VertexPositionNormalTexture), vertices.data());
+	}
+
+	if (vertices.size() <= USHRT_MAX)
+	{
+		std::vector<uint16_t> shortIndices = NarrowIndices(indices);
+		mIndexAllocation = arena.AllocateIndices(commandList, shortIndices.size(), DXGI_FORMAT_R16_UINT, shortIndices.data());
+	}
+	else
+	{
+		mIndexAllocation = arena.AllocateIndices(commandList, indices.size(), DXGI_FORMAT_R32_UINT, indices.data());
+	}
+
+	mIndexCount = mLods[0].IndexCount;
+}
+
+std::unique_ptr<Mesh> Mesh::Create(CommandList& commandList, VertexCollection& vertices, IndexCollection& indices, bool rhcoords, VertexFormat format)
+{
+	std::unique_ptr<Mesh> mesh(new Mesh());
+
+	mesh->Initialize(commandList, vertices, indices, rhcoords, format);
+
+	return mesh;
+}
+
+std::unique_ptr<Mesh> Mesh::CreateFromFile(CommandList& commandList, const std::wstring& fileName)
+{
+	MeshFile file;
+	if (!file.Open(fileName))
+		throw std::exception("Invalid mesh file.");
+
+	const MeshFileHeader& header = file.GetHeader();
+
+	VertexFormat format = static_cast<VertexFormat>(header.VertexFormat);
+	size_t expectedStride = format == VertexFormat::Quantized ? sizeof(VertexPositionNormalTextureQuantized) : sizeof(VertexPositionNormalTexture);
+	if (header.VertexStride != expectedStride)
+		throw std::exception("Mesh file vertex format mismatch.");
+
+	std::unique_ptr<Mesh> mesh(new Mesh());
+
+	mesh->mVertexFormat = format;
+	mesh->mQuantizationBounds = header.Bounds;
+
+	if (format == VertexFormat::Quantized)
+	{
+		mesh->mBoundingBox = BoundingBox(header.Bounds.Center, header.Bounds.Extent);
+		BoundingSphere::CreateFromBoundingBox(mesh->mBoundingSphere, mesh->mBoundingBox);
+	}
+	else
+	{
+		const XMFLOAT3* positions = file.GetArray<XMFLOAT3>(header.Vertices);
+		BoundingBox::CreateFromPoints(mesh->mBoundingBox, header.VertexCount, positions, header.VertexStride);
+		BoundingSphere::CreateFromPoints(mesh->mBoundingSphere, header.VertexCount, positions, header.VertexStride);
+	}
+
+	GeometryArena& arena = Application::Get().GetGeometryArena();
+	mesh->mVertexAllocation = arena.AllocateVertices(commandList, header.VertexCount, header.VertexStride, file.GetBlob(header.Vertices));
+	mesh->mIndexAllocation = arena.AllocateIndices(commandList, header.IndexCount, header.IndexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, file.GetBlob(header.Indices));
+
+	const MeshFileLod* lods = file.GetArray<MeshFileLod>(header.Lods);
+	for (uint32_t i = 0; i < header.LodCount; ++i)
+	{
+		if (lods[i].IndexOffset > header.IndexCount || lods[i].IndexCount > header.IndexCount - lods[i].IndexOffset)
+			throw std::exception("Mesh file LOD out of range.");
+
+		mesh->mLods.push_back({ lods[i].IndexOffset, lods[i].IndexCount, lods[i].Error });
+	}
+	if (mesh->mLods.empty())
+	{
+		mesh->mLods.push_back({ 0, header.IndexCount, 0.0f });
+	}
+
+	MeshletData& meshlets = mesh->mMeshlets;
+	const Meshlet* meshletArray = file.GetArray<Meshlet>(header.Meshlets);
+	const uint32_t* vertexIndices = file.GetArray<uint32_t>(header.MeshletVertices);
+	const uint32_t* primitiveIndices = file.GetArray<uint32_t>(header.MeshletPrimitives);
+	const MeshletCullData* cullData = file.GetArray<MeshletCullData>(header.MeshletCullData);
+	meshlets.Meshlets.assign(meshletArray, meshletArray + header.MeshletCount);
+	meshlets.UniqueVertexIndices.assign(vertexIndices, vertexIndices + header.MeshletVertices.Size / sizeof(uint32_t));
+	meshlets.PrimitiveIndices.assign(primitiveIndices, primitiveIndices + header.MeshletPrimitives.Size / sizeof(uint32_t));
+	meshlets.CullData.assign(cullData, cullData + header.MeshletCount);
+
+	commandList.CopyStructuredBuffer(mesh->mMeshletCullBuffer, meshlets.CullData);
+
+	mesh->mIndexCount = mesh->mLods[0].IndexCount;
+
+	return mesh;
+}
+
+void Mesh::Convert(const std::wstring& fileName, VertexCollection& vertices, IndexCollection& indices, bool rhcoords, VertexFormat format)
+{
+	Statistics statistics = {};
+	MeshletData meshlets;
+	std::vector<Lod> lods;
+	ProcessMesh(vertices, indices, rhcoords, statistics, meshlets, lods);
+
+	std::vector<MeshFileLod> fileLods;
+	for (const Lod& lod : lods)
+	{
+		fileLods.push_back({ lod.IndexOffset, lod.IndexCount, lod.Error });
+	}
+
+	MeshFileContents contents = {};
+	contents.VertexFormat = static_cast<uint32_t>(format);
+	contents.VertexCount = static_cast<uint32_t>(vertices.size());
+	contents.IndexCount = static_cast<uint32_t>(indices.size());
+	contents.Lods = fileLods.data();
+	contents.LodCount = static_cast<uint32_t>(fileLods.size());
+	contents.Meshlets = &meshlets;
+
+	std::vector<VertexPositionNormalTextureQuantized> quantized;
+	if (format == VertexFormat::Quantized)
+	{
+		contents.Bounds = VertexQuantization::ComputeBounds(GetPositions(vertices), vertices.size(), sizeof(VertexPositionNormalTexture));
+		quantized = QuantizeVertices(vertices, contents.Bounds);
+		contents.VertexStride = sizeof(VertexPositionNormalTextureQuantized);
+		contents.Vertices = quantized.data();
+	}
+	else
+	{
+		contents.VertexStride = sizeof(VertexPositionNormalTexture);
+		contents.Vertices = vertices.data();
+	}
+
+	std::vector<uint16_t> shortIndices;
+	if (vertices.size() <= USHRT_MAX)
+	{
+		shortIndices = NarrowIndices(indices);
+		contents.IndexSize = sizeof(uint16_t);
+		contents.Indices = shortIndices.data();
+	}
+	else
+	{
+		contents.IndexSize = sizeof(uint32_t);
+		contents.Indices = indices.data();
+	}
 
-	mIndexCount = static_cast<UINT>(indices.size());
+	if (!MeshFile::Write(fileName, contents))
+		throw std::exception("Failed to write mesh file.");
 }
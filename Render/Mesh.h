@@ -7,6 +7,13 @@
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "Application.h"
+#include "GeometryArena.h"
+#include "Meshlet.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "StructuredBuffer.h"
+#include "VertexQuantization.h"
 
 struct VertexPositionNormalTexture
 {
@@ -34,20 +41,126 @@ struct VertexPositionNormalTexture
 	static const D3D12_INPUT_ELEMENT_DESC InputElements[InputElementCount];
 };
 
+struct VertexPositionNormalTextureQuantized
+{
+	int16_t position[4];
+	int16_t normal[2];
+	uint16_t textureCoordinate[2];
+
+	static const int InputElementCount = 3;
+	static const D3D12_INPUT_ELEMENT_DESC InputElements[InputElementCount];
+};
+
+enum class VertexFormat
+{
+	Float,
+	Quantized,
+};
+
 using VertexCollection = std::vector<VertexPositionNormalTexture>;
-using IndexCollection = std::vector<uint16_t>;
+using IndexCollection = std::vector<uint32_t>;
 
 class Mesh
 {
 public:
+	struct Statistics
+	{
+		VertexCacheStatistics Source;
+		VertexCacheStatistics Optimized;
+	};
+
+	struct Lod
+	{
+		uint32_t IndexOffset;
+		uint32_t IndexCount;
+		float Error;
+	};
+
+	// Meshes get between 1 and MaxLodNum LODs depending on how far they simplify; LOD indices past
+	// the last level clamp to it.
+	static const uint32_t MaxLodNum = 5;
 
 	void Draw(CommandList& commandList);
+	void Draw(CommandList& commandList, const std::vector<uint32_t>& meshlets);
+	void DrawLod(CommandList& commandList, uint32_t lod);
+	void DrawInstanced(CommandList& commandList, uint32_t instanceCount);
+	void DrawLodInstanced(CommandList& commandList, uint32_t lod, uint32_t instanceCount);
+
+	void Bind(CommandList& commandList) const;
+	bool SharesBuffers(const Mesh& other) const;
+	D3D12_DRAW_INDEXED_ARGUMENTS GetDrawArguments(uint32_t instanceCount = 1) const;
+	D3D12_DRAW_INDEXED_ARGUMENTS GetLodDrawArguments(uint32_t lod, uint32_t instanceCount = 1) const;
+	void GetMeshletDrawArguments(const std::vector<uint32_t>& meshlets, std::vector<D3D12_DRAW_INDEXED_ARGUMENTS>& arguments) const;
+
+	uint32_t SelectLod(float viewDepth, float scale, DirectX::CXMMATRIX projection, float viewportHeight, float pixelError = 1.0f) const;
+
+	uint32_t GetLodCount() const
+	{
+		return static_cast<uint32_t>(mLods.size());
+	}
+
+	const Lod& GetLod(uint32_t lod) const
+	{
+		return mLods[lod];
+	}
+
+	Statistics GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	const MeshletData& GetMeshlets() const
+	{
+		return mMeshlets;
+	}
+
+	const StructuredBuffer& GetMeshletCullBuffer() const
+	{
+		return mMeshletCullBuffer;
+	}
+
+	const GeometryArena::Allocation& GetVertexAllocation() const
+	{
+		return mVertexAllocation;
+	}
+
+	const GeometryArena::Allocation& GetIndexAllocation() const
+	{
+		return mIndexAllocation;
+	}
+
+	const DirectX::BoundingBox& GetBoundingBox() const
+	{
+		return mBoundingBox;
+	}
 
-	static std::unique_ptr<Mesh> CreateCube(CommandList& commandList, float size = 1, bool rhcoords = false);
-	static std::unique_ptr<Mesh> CreateSphere(CommandList& commandList, float diameter = 1, size_t tessellation = 16, bool rhcoords = false);
-	static std::unique_ptr<Mesh> CreateCone(CommandList& commandList, float diameter = 1, float height = 1, size_t tessellation = 32, bool rhcoords = false);
-	static std::unique_ptr<Mesh> CreateTorus(CommandList& commandList, float diameter = 1, float thickness = 0.333f, size_t tessellation = 32, bool rhcoords = false);
-	static std::unique_ptr<Mesh> CreatePlane(CommandList& commandList, float width = 1, float height = 1, bool rhcoords = false);
+	const DirectX::BoundingSphere& GetBoundingSphere() const
+	{
+		return mBoundingSphere;
+	}
+
+	static std::unique_ptr<Mesh> CreateCube(CommandList& commandList, float size = 1, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+	static std::unique_ptr<Mesh> CreateSphere(CommandList& commandList, float diameter = 1, size_t tessellation = 16, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+	static std::unique_ptr<Mesh> CreateCone(CommandList& commandList, float diameter = 1, float height = 1, size_t tessellation = 32, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+	static std::unique_ptr<Mesh> CreateTorus(CommandList& commandList, float diameter = 1, float thickness = 0.333f, size_t tessellation = 32, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+	static std::unique_ptr<Mesh> CreatePlane(CommandList& commandList, float width = 1, float height = 1, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+
+	static std::unique_ptr<Mesh> Create(CommandList& commandList, VertexCollection& vertices, IndexCollection& indices, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+	static std::unique_ptr<Mesh> CreateFromFile(CommandList& commandList, const std::wstring& fileName);
+	static void Convert(const std::wstring& fileName, VertexCollection& vertices, IndexCollection& indices, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+
+	static void GenerateCube(VertexCollection& vertices, IndexCollection& indices, float size = 1);
+	static void GenerateSphere(VertexCollection& vertices, IndexCollection& indices, float diameter = 1, size_t tessellation = 16);
+	static void GenerateCone(VertexCollection& vertices, IndexCollection& indices, float diameter = 1, float height = 1, size_t tessellation = 32);
+	static void GenerateTorus(VertexCollection& vertices, IndexCollection& indices, float diameter = 1, float thickness = 0.333f, size_t tessellation = 32);
+	static void GeneratePlane(VertexCollection& vertices, IndexCollection& indices, float width = 1, float height = 1);
+
+	VertexFormat GetVertexFormat() const
+	{
+		return mVertexFormat;
+	}
+
+	DirectX::XMMATRIX GetDequantizationMatrix() const;
 
 protected:
 
@@ -58,12 +171,26 @@ private:
 	Mesh(const Mesh& copy) = delete;
 	virtual ~Mesh();
 
-	void Initialize(CommandList& commandList, VertexCollection& vertices, IndexCollection& indices, bool rhcoords);
+	void Initialize(CommandList& commandList, VertexCollection& vertices, IndexCollection& indices, bool rhcoords, VertexFormat format);
+	void DrawRange(CommandList& commandList, uint32_t indexCount, uint32_t startIndex, uint32_t instanceCount = 1) const;
+	D3D12_DRAW_INDEXED_ARGUMENTS GetRangeArguments(uint32_t indexCount, uint32_t startIndex, uint32_t instanceCount) const;
 
-	VertexBuffer mVertexBuffer;
-	IndexBuffer mIndexBuffer;
+	GeometryArena::Allocation mVertexAllocation;
+	GeometryArena::Allocation mIndexAllocation;
 
 	UINT mIndexCount;
+	Statistics mStatistics;
+
+	std::vector<Lod> mLods;
+
+	VertexFormat mVertexFormat;
+	QuantizationBounds mQuantizationBounds;
+
+	DirectX::BoundingBox mBoundingBox;
+	DirectX::BoundingSphere mBoundingSphere;
+
+	MeshletData mMeshlets;
+	StructuredBuffer mMeshletCullBuffer;
 };
 
 #endif
@@ -0,0 +1,166 @@
+#include "MeshCache.h"
+
+#include "CommandList.h"
+
+#include <iomanip>
+#include <sstream>
+#include <tuple>
+
+namespace
+{
+	const wchar_t* GetShapeName(MeshShape shape)
+	{
+		switch (shape)
+		{
+		case MeshShape::Cube: return L"Cube";
+		case MeshShape::Sphere: return L"Sphere";
+		case MeshShape::Cone: return L"Cone";
+		case MeshShape::Torus: return L"Torus";
+		case MeshShape::Plane: return L"Plane";
+		}
+		return L"Mesh";
+	}
+}
+
+bool MeshCache::Key::operator<(const Key& other) const
+{
+	return std::tie(Shape, Width, Height, Tessellation, RhCoords, Format) < std::tie(other.Shape, other.Width, other.Height, other.Tessellation, other.RhCoords, other.Format);
+}
+
+MeshCache::MeshCache(const std::wstring& cacheDirectory) : mCacheDirectory(cacheDirectory), mHits(0), mMisses(0), mFileLoads(0), mLastBuildMilliseconds(0.0)
+{
+	if (!mCacheDirectory.empty() && !fs::exists(mCacheDirectory))
+	{
+		fs::create_directories(mCacheDirectory);
+	}
+}
+
+MeshCache::~MeshCache() {}
+
+std::shared_ptr<Mesh> MeshCache::GetCube(CommandList& commandList, float size, bool rhcoords, VertexFormat format)
+{
+	return GetMesh(commandList, { MeshShape::Cube, size, 0.0f, 0, rhcoords, format });
+}
+
+std::shared_ptr<Mesh> MeshCache::GetSphere(CommandList& commandList, float diameter, size_t tessellation, bool rhcoords, VertexFormat format)
+{
+	return GetMesh(commandList, { MeshShape::Sphere, diameter, 0.0f, static_cast<uint32_t>(tessellation), rhcoords, format });
+}
+
+std::shared_ptr<Mesh> MeshCache::GetCone(CommandList& commandList, float diameter, float height, size_t tessellation, bool rhcoords, VertexFormat format)
+{
+	return GetMesh(commandList, { MeshShape::Cone, diameter, height, static_cast<uint32_t>(tessellation), rhcoords, format });
+}
+
+std::shared_ptr<Mesh> MeshCache::GetTorus(CommandList& commandList, float diameter, float thickness, size_t tessellation, bool rhcoords, VertexFormat format)
+{
+	return GetMesh(commandList, { MeshShape::Torus, diameter, thickness, static_cast<uint32_t>(tessellation), rhcoords, format });
+}
+
+std::shared_ptr<Mesh> MeshCache::GetPlane(CommandList& commandList, float width, float height, bool rhcoords, VertexFormat format)
+{
+	return GetMesh(commandList, { MeshShape::Plane, width, height, 0, rhcoords, format });
+}
+
+void MeshCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mMeshes.clear();
+}
+
+MeshCache::Statistics MeshCache::GetStatistics() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	Statistics statistics;
+	statistics.MeshNum = static_cast<uint32_t>(mMeshes.size());
+	statistics.Hits = mHits;
+	statistics.Misses = mMisses;
+	statistics.FileLoads = mFileLoads;
+	statistics.LastBuildMilliseconds = mLastBuildMilliseconds;
+	return statistics;
+}
+
+std::shared_ptr<Mesh> MeshCache::GetMesh(CommandList& commandList, const Key& key)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto iter = mMeshes.find(key);
+	if (iter != mMeshes.end())
+	{
+		++mHits;
+		return iter->second;
+	}
+
+	++mMisses;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::shared_ptr<Mesh> mesh = BuildMesh(commandList, key);
+	mMeshes.emplace(key, mesh);
+
+	mLastBuildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return mesh;
+}
+
+std::unique_ptr<Mesh> MeshCache::BuildMesh(CommandList& commandList, const Key& key)
+{
+	VertexCollection vertices;
+	IndexCollection indices;
+
+	if (mCacheDirectory.empty())
+	{
+		Generate(key, vertices, indices);
+		return Mesh::Create(commandList, vertices, indices, key.RhCoords, key.Format);
+	}
+
+	std::wstring fileName = GetCacheFileName(key);
+	if (fs::exists(fileName))
+	{
+		try
+		{
+			std::unique_ptr<Mesh> mesh = Mesh::CreateFromFile(commandList, fileName);
+			++mFileLoads;
+			return mesh;
+		}
+		catch (const std::exception& e)
+		{
+			std::wstringstream message;
+			message << L"MeshCache: regenerating " << fileName << L": " << e.what() << L"\n";
+			OutputDebugStringW(message.str().c_str());
+		}
+	}
+
+	Generate(key, vertices, indices);
+	Mesh::Convert(fileName, vertices, indices, key.RhCoords, key.Format);
+	return Mesh::CreateFromFile(commandList, fileName);
+}
+
+std::wstring MeshCache::GetCacheFileName(const Key& key) const
+{
+	std::wstringstream name;
+	name << GetShapeName(key.Shape) << std::setprecision(9) << L"_" << key.Width << L"_" << key.Height << L"_" << key.Tessellation
+		 << L"_" << (key.RhCoords ? L"rh" : L"lh") << L"_" << static_cast<uint32_t>(key.Format) << L"_v" << CacheVersion << L".mesh";
+	return (mCacheDirectory / name.str()).wstring();
+}
+
+void MeshCache::Generate(const Key& key, VertexCollection& vertices, IndexCollection& indices)
+{
+	switch (key.Shape)
+	{
+	case MeshShape::Cube:
+		Mesh::GenerateCube(vertices, indices, key.Width);
+		break;
+	case MeshShape::Sphere:
+		Mesh::GenerateSphere(vertices, indices, key.Width, key.Tessellation);
+		break;
+	case MeshShape::Cone:
+		Mesh::GenerateCone(vertices, indices, key.Width, key.Height, key.Tessellation);
+		break;
+	case MeshShape::Torus:
+		Mesh::GenerateTorus(vertices, indices, key.Width, key.Height, key.Tessellation);
+		break;
+	case MeshShape::Plane:
+		Mesh::GeneratePlane(vertices, indices, key.Width, key.Height);
+		break;
+	}
+}
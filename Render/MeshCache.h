@@ -0,0 +1,80 @@
+#ifndef __MESHCACHE_H_
+#define __MESHCACHE_H_
+
+#include "Core.h"
+#include "Mesh.h"
+
+class CommandList;
+
+enum class MeshShape : uint32_t
+{
+	Cube,
+	Sphere,
+	Cone,
+	Torus,
+	Plane,
+};
+
+class MeshCache
+{
+public:
+	struct Statistics
+	{
+		uint32_t MeshNum;
+		uint32_t Hits;
+		uint32_t Misses;
+		uint32_t FileLoads;
+		double LastBuildMilliseconds;
+	};
+
+	// Part of every cache file name. Bump it when the generators or the mesh processing
+	// change their output, so files baked by an older build are not picked up.
+	static const uint32_t CacheVersion = 2;
+
+	explicit MeshCache(const std::wstring& cacheDirectory = L"");
+	virtual ~MeshCache();
+
+	std::shared_ptr<Mesh> GetCube(CommandList& commandList, float size = 1, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+	std::shared_ptr<Mesh> GetSphere(CommandList& commandList, float diameter = 1, size_t tessellation = 16, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+	std::shared_ptr<Mesh> GetCone(CommandList& commandList, float diameter = 1, float height = 1, size_t tessellation = 32, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+	std::shared_ptr<Mesh> GetTorus(CommandList& commandList, float diameter = 1, float thickness = 0.333f, size_t tessellation = 32, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+	std::shared_ptr<Mesh> GetPlane(CommandList& commandList, float width = 1, float height = 1, bool rhcoords = false, VertexFormat format = VertexFormat::Float);
+
+	void Clear();
+
+	Statistics GetStatistics() const;
+
+private:
+	MeshCache(const MeshCache& copy) = delete;
+	MeshCache& operator=(const MeshCache& other) = delete;
+
+	struct Key
+	{
+		MeshShape Shape;
+		float Width;
+		float Height;
+		uint32_t Tessellation;
+		bool RhCoords;
+		VertexFormat Format;
+
+		bool operator<(const Key& other) const;
+	};
+
+	std::shared_ptr<Mesh> GetMesh(CommandList& commandList, const Key& key);
+	std::unique_ptr<Mesh> BuildMesh(CommandList& commandList, const Key& key);
+	std::wstring GetCacheFileName(const Key& key) const;
+
+	static void Generate(const Key& key, VertexCollection& vertices, IndexCollection& indices);
+
+	fs::path mCacheDirectory;
+	std::map<Key, std::shared_ptr<Mesh>> mMeshes;
+
+	uint32_t mHits;
+	uint32_t mMisses;
+	uint32_t mFileLoads;
+	double mLastBuildMilliseconds;
+
+	mutable std::mutex mMutex;
+};
+
+#endif
@@ -0,0 +1,247 @@
+#include "MeshFile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	struct PendingBlob
+	{
+		MeshFileBlob* Blob;
+		const void* Data;
+		uint64_t Size;
+	};
+}
+
+MeshFile::MeshFile()
+	: mData(nullptr)
+	, mSize(0)
+#ifdef _WIN32
+	, mFile(INVALID_HANDLE_VALUE)
+	, mMapping(nullptr)
+#else
+	, mFile(-1)
+#endif
+{}
+
+MeshFile::~MeshFile()
+{
+	Close();
+}
+
+bool MeshFile::Open(const std::wstring& fileName)
+{
+	Close();
+
+	std::filesystem::path filePath(fileName);
+
+#ifdef _WIN32
+	mFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (mFile == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(mFile, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+	mSize = static_cast<uint64_t>(fileSize.QuadPart);
+
+	mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mMapping)
+	{
+		Close();
+		return false;
+	}
+
+	mData = static_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+#else
+	mFile = open(filePath.c_str(), O_RDONLY);
+	if (mFile < 0) return false;
+
+	struct stat fileStat;
+	if (fstat(mFile, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+	mSize = static_cast<uint64_t>(fileStat.st_size);
+
+	void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+	mData = (data == MAP_FAILED) ? nullptr : static_cast<const uint8_t*>(data);
+#endif
+
+	if (!mData || !Validate())
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MeshFile::Close()
+{
+#ifdef _WIN32
+	if (mData) UnmapViewOfFile(mData);
+	if (mMapping) CloseHandle(mMapping);
+	if (mFile != INVALID_HANDLE_VALUE) CloseHandle(mFile);
+	mMapping = nullptr;
+	mFile = INVALID_HANDLE_VALUE;
+#else
+	if (mData) munmap(const_cast<uint8_t*>(mData), mSize);
+	if (mFile >= 0) close(mFile);
+	mFile = -1;
+#endif
+	mData = nullptr;
+	mSize = 0;
+}
+
+bool MeshFile::Validate() const
+{
+	if (mSize < sizeof(MeshFileHeader)) return false;
+
+	const MeshFileHeader& header = GetHeader();
+	if (header.Magic != MeshFileHeader::FileMagic || header.Version != MeshFileHeader::FileVersion || header.HeaderSize != sizeof(MeshFileHeader))
+		return false;
+
+	if (header.IndexSize != 2 && header.IndexSize != 4)
+		return false;
+
+	const MeshFileBlob* blobs[] = { &header.Vertices, &header.Indices, &header.Lods, &header.Meshlets, &header.MeshletVertices, &header.MeshletPrimitives, &header.MeshletCullData };
+	for (const MeshFileBlob* blob : blobs)
+	{
+		if (blob->Offset % MeshFileHeader::BlobAlignment != 0 || blob->Offset > mSize || blob->Size > mSize - blob->Offset)
+			return false;
+	}
+
+	if (header.Vertices.Size != static_cast<uint64_t>(header.VertexStride) * header.VertexCount
+		|| header.Indices.Size != static_cast<uint64_t>(header.IndexSize) * header.IndexCount
+		|| header.Lods.Size != header.LodCount * sizeof(MeshFileLod)
+		|| header.Meshlets.Size != header.MeshletCount * sizeof(Meshlet)
+		|| header.MeshletCullData.Size != header.MeshletCount * sizeof(MeshletCullData)
+		|| header.MeshletVertices.Size % sizeof(uint32_t) != 0
+		|| header.MeshletPrimitives.Size % sizeof(uint32_t) != 0)
+		return false;
+
+	// Meshlets index into the unique vertex and primitive lists, and their primitives are drawn
+	// straight from the index buffer, so every range has to stay inside the blobs.
+	const uint64_t uniqueVertexNum = header.MeshletVertices.Size / sizeof(uint32_t);
+	const uint64_t primitiveNum = header.MeshletPrimitives.Size / sizeof(uint32_t);
+	const Meshlet* meshlets = GetArray<Meshlet>(header.Meshlets);
+	const uint32_t* uniqueVertexIndices = GetArray<uint32_t>(header.MeshletVertices);
+	const uint32_t* primitiveIndices = GetArray<uint32_t>(header.MeshletPrimitives);
+
+	for (uint32_t i = 0; i < header.MeshletCount; ++i)
+	{
+		const Meshlet& meshlet = meshlets[i];
+		uint64_t primitiveEnd = static_cast<uint64_t>(meshlet.PrimitiveOffset) + meshlet.PrimitiveCount;
+		if (static_cast<uint64_t>(meshlet.VertexOffset) + meshlet.VertexCount > uniqueVertexNum
+			|| primitiveEnd > primitiveNum || primitiveEnd * 3 > header.IndexCount)
+			return false;
+
+		for (uint32_t j = 0; j < meshlet.PrimitiveCount; ++j)
+		{
+			uint32_t i0, i1, i2;
+			MeshletBuilder::UnpackPrimitive(primitiveIndices[meshlet.PrimitiveOffset + j], i0, i1, i2);
+			if (i0 >= meshlet.VertexCount || i1 >= meshlet.VertexCount || i2 >= meshlet.VertexCount)
+				return false;
+		}
+	}
+
+	for (uint64_t i = 0; i < uniqueVertexNum; ++i)
+	{
+		if (uniqueVertexIndices[i] >= header.VertexCount)
+			return false;
+	}
+
+	return true;
+}
+
+bool MeshFile::Write(const std::wstring& fileName, const MeshFileContents& contents)
+{
+	MeshFileHeader header = {};
+	header.Magic = MeshFileHeader::FileMagic;
+	header.Version = MeshFileHeader::FileVersion;
+	header.HeaderSize = sizeof(MeshFileHeader);
+	header.VertexFormat = contents.VertexFormat;
+	header.VertexStride = contents.VertexStride;
+	header.VertexCount = contents.VertexCount;
+	header.IndexSize = contents.IndexSize;
+	header.IndexCount = contents.IndexCount;
+	header.LodCount = contents.LodCount;
+	header.Bounds = contents.Bounds;
+
+	MeshletData emptyMeshlets;
+	const MeshletData& meshlets = contents.Meshlets ? *contents.Meshlets : emptyMeshlets;
+	header.MeshletCount = static_cast<uint32_t>(meshlets.Meshlets.size());
+
+	PendingBlob pending[] =
+	{
+		{ &header.Vertices, contents.Vertices, static_cast<uint64_t>(contents.VertexStride) * contents.VertexCount },
+		{ &header.Indices, contents.Indices, static_cast<uint64_t>(contents.IndexSize) * contents.IndexCount },
+		{ &header.Lods, contents.Lods, contents.LodCount * sizeof(MeshFileLod) },
+		{ &header.Meshlets, meshlets.Meshlets.data(), meshlets.Meshlets.size() * sizeof(Meshlet) },
+		{ &header.MeshletVertices, meshlets.UniqueVertexIndices.data(), meshlets.UniqueVertexIndices.size() * sizeof(uint32_t) },
+		{ &header.MeshletPrimitives, meshlets.PrimitiveIndices.data(), meshlets.PrimitiveIndices.size() * sizeof(uint32_t) },
+		{ &header.MeshletCullData, meshlets.CullData.data(), meshlets.CullData.size() * sizeof(MeshletCullData) },
+	};
+
+	uint64_t offset = AlignUp(sizeof(MeshFileHeader), MeshFileHeader::BlobAlignment);
+	for (PendingBlob& blob : pending)
+	{
+		blob.Blob->Offset = offset;
+		blob.Blob->Size = blob.Size;
+		offset = AlignUp(offset + blob.Size, MeshFileHeader::BlobAlignment);
+	}
+
+	std::filesystem::path filePath(fileName);
+	std::filesystem::path tempPath = filePath;
+	tempPath += L".tmp";
+
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file) return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		const std::vector<char> padding(MeshFileHeader::BlobAlignment, 0);
+		uint64_t written = sizeof(header);
+		for (const PendingBlob& blob : pending)
+		{
+			file.write(padding.data(), static_cast<std::streamsize>(blob.Blob->Offset - written));
+			if (blob.Size > 0)
+			{
+				file.write(static_cast<const char*>(blob.Data), static_cast<std::streamsize>(blob.Size));
+			}
+			written = blob.Blob->Offset + blob.Size;
+		}
+
+		if (!file) return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, filePath, error);
+	return !error;
+}
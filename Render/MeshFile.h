@@ -0,0 +1,114 @@
+#ifndef __MESHFILE_H_
+#define __MESHFILE_H_
+
+#include "Meshlet.h"
+#include "VertexQuantization.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct MeshFileBlob
+{
+	uint64_t Offset;
+	uint64_t Size;
+};
+
+struct MeshFileLod
+{
+	uint32_t IndexOffset;
+	uint32_t IndexCount;
+	float Error;
+};
+
+struct MeshFileHeader
+{
+	static const uint32_t FileMagic = 0x534d5452;
+	static const uint32_t FileVersion = 1;
+	static const uint32_t BlobAlignment = 64;
+
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t HeaderSize;
+	uint32_t VertexFormat;
+	uint32_t VertexStride;
+	uint32_t VertexCount;
+	uint32_t IndexSize;
+	uint32_t IndexCount;
+	uint32_t LodCount;
+	uint32_t MeshletCount;
+	QuantizationBounds Bounds;
+
+	MeshFileBlob Vertices;
+	MeshFileBlob Indices;
+	MeshFileBlob Lods;
+	MeshFileBlob Meshlets;
+	MeshFileBlob MeshletVertices;
+	MeshFileBlob MeshletPrimitives;
+	MeshFileBlob MeshletCullData;
+};
+
+struct MeshFileContents
+{
+	uint32_t VertexFormat;
+	uint32_t VertexStride;
+	uint32_t VertexCount;
+	const void* Vertices;
+	uint32_t IndexSize;
+	uint32_t IndexCount;
+	const void* Indices;
+	QuantizationBounds Bounds;
+	const MeshFileLod* Lods;
+	uint32_t LodCount;
+	const MeshletData* Meshlets;
+};
+
+class MeshFile
+{
+public:
+	MeshFile();
+	virtual ~MeshFile();
+
+	bool Open(const std::wstring& fileName);
+	void Close();
+
+	bool IsOpen() const
+	{
+		return mData != nullptr;
+	}
+
+	const MeshFileHeader& GetHeader() const
+	{
+		return *reinterpret_cast<const MeshFileHeader*>(mData);
+	}
+
+	const void* GetBlob(const MeshFileBlob& blob) const
+	{
+		return mData + blob.Offset;
+	}
+
+	template<typename T>
+	const T* GetArray(const MeshFileBlob& blob) const
+	{
+		return reinterpret_cast<const T*>(mData + blob.Offset);
+	}
+
+	static bool Write(const std::wstring& fileName, const MeshFileContents& contents);
+
+private:
+	MeshFile(const MeshFile& copy) = delete;
+	MeshFile& operator=(const MeshFile& other) = delete;
+
+	bool Validate() const;
+
+	const uint8_t* mData;
+	uint64_t mSize;
+#ifdef _WIN32
+	void* mFile;
+	void* mMapping;
+#else
+	int mFile;
+#endif
+};
+
+#endif
@@ -0,0 +1,331 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+	struct TriangleAdjacency
+	{
+		std::vector<uint32_t> Counts;
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Triangles;
+	};
+
+	TriangleAdjacency BuildAdjacency(const std::vector<uint32_t>& indices, size_t vertexNum)
+	{
+		TriangleAdjacency adjacency;
+		adjacency.Counts.assign(vertexNum, 0);
+		adjacency.Offsets.assign(vertexNum, 0);
+		adjacency.Triangles.resize(indices.size());
+
+		for (uint32_t index : indices)
+		{
+			++adjacency.Counts[index];
+		}
+
+		uint32_t offset = 0;
+		for (size_t i = 0; i < vertexNum; ++i)
+		{
+			adjacency.Offsets[i] = offset;
+			offset += adjacency.Counts[i];
+		}
+
+		std::vector<uint32_t> fill = adjacency.Offsets;
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			adjacency.Triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		return adjacency;
+	}
+
+	const float* GetPosition(const float* positions, size_t positionStride, uint32_t index)
+	{
+		return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + index * positionStride);
+	}
+
+	uint32_t CountCacheMisses(const uint32_t* indices, size_t indexNum, std::vector<uint32_t>& cacheTime, uint32_t& time, uint32_t cacheSize)
+	{
+		uint32_t misses = 0;
+		for (size_t i = 0; i < indexNum; ++i)
+		{
+			uint32_t index = indices[i];
+			if (time - cacheTime[index] > cacheSize)
+			{
+				cacheTime[index] = time++;
+				++misses;
+			}
+		}
+		return misses;
+	}
+}
+
+VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexNum, uint32_t cacheSize)
+{
+	assert(indices.size() % 3 == 0);
+
+	VertexCacheStatistics statistics = {};
+	if (indices.empty()) return statistics;
+
+	std::vector<uint32_t> cacheTime(vertexNum, 0);
+	uint32_t time = cacheSize + 1;
+	statistics.VerticesTransformed = CountCacheMisses(indices.data(), indices.size(), cacheTime, time, cacheSize);
+
+	std::vector<bool> referenced(vertexNum, false);
+	size_t uniqueVertexNum = 0;
+	for (uint32_t index : indices)
+	{
+		if (!referenced[index])
+		{
+			referenced[index] = true;
+			++uniqueVertexNum;
+		}
+	}
+
+	statistics.ACMR = static_cast<float>(statistics.VerticesTransformed) / (indices.size() / 3);
+	statistics.ATVR = static_cast<float>(statistics.VerticesTransformed) / uniqueVertexNum;
+
+	return statistics;
+}
+
+std::vector<uint32_t> MeshOptimizer::OptimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexNum, uint32_t cacheSize, std::vector<uint32_t>* clusters)
+{
+	assert(indices.size() % 3 == 0);
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	if (clusters)
+	{
+		clusters->clear();
+	}
+	if (indices.empty()) return result;
+
+	TriangleAdjacency adjacency = BuildAdjacency(indices, vertexNum);
+
+	std::vector<uint32_t> liveTriangles = adjacency.Counts;
+	std::vector<uint32_t> cacheTime(vertexNum, 0);
+	std::vector<bool> emitted(indices.size() / 3, false);
+	std::vector<uint32_t> deadEnd;
+	std::vector<uint32_t> candidates;
+	deadEnd.reserve(indices.size());
+	candidates.reserve(64);
+
+	uint32_t time = cacheSize + 1;
+	uint32_t cursor = 0;
+
+	auto skipDeadEnd = [&]() -> uint32_t
+	{
+		while (!deadEnd.empty())
+		{
+			uint32_t vertex = deadEnd.back();
+			deadEnd.pop_back();
+			if (liveTriangles[vertex] > 0) return vertex;
+		}
+		while (cursor < vertexNum)
+		{
+			if (liveTriangles[cursor] > 0) return cursor;
+			++cursor;
+		}
+		return InvalidIndex;
+	};
+
+	uint32_t fanning = skipDeadEnd();
+	if (clusters)
+	{
+		clusters->push_back(0);
+	}
+
+	while (fanning != InvalidIndex)
+	{
+		candidates.clear();
+
+		uint32_t begin = adjacency.Offsets[fanning];
+		uint32_t end = begin + adjacency.Counts[fanning];
+		for (uint32_t t = begin; t < end; ++t)
+		{
+			uint32_t triangle = adjacency.Triangles[t];
+			if (emitted[triangle]) continue;
+
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				uint32_t vertex = indices[triangle * 3 + k];
+				result.push_back(vertex);
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				--liveTriangles[vertex];
+
+				if (time - cacheTime[vertex] > cacheSize)
+				{
+					cacheTime[vertex] = time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		uint32_t next = InvalidIndex;
+		int32_t bestPriority = -1;
+		for (uint32_t vertex : candidates)
+		{
+			if (liveTriangles[vertex] == 0) continue;
+
+			int32_t priority = 0;
+			if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+			{
+				priority = static_cast<int32_t>(time - cacheTime[vertex]);
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				next = vertex;
+			}
+		}
+
+		if (next == InvalidIndex)
+		{
+			next = skipDeadEnd();
+			if (clusters && next != InvalidIndex)
+			{
+				uint32_t triangleNum = static_cast<uint32_t>(result.size() / 3);
+				if (clusters->back() != triangleNum)
+				{
+					clusters->push_back(triangleNum);
+				}
+			}
+		}
+
+		fanning = next;
+	}
+
+	assert(result.size() == indices.size());
+	return result;
+}
+
+std::vector<uint32_t> MeshOptimizer::OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusters, const float* positions, size_t vertexNum, size_t positionStride, uint32_t cacheSize, float threshold)
+{
+	assert(indices.size() % 3 == 0);
+
+	size_t triangleNum = indices.size() / 3;
+	if (triangleNum == 0 || clusters.empty()) return indices;
+
+	std::vector<uint32_t> cacheTime(vertexNum, 0);
+	uint32_t time = cacheSize + 1;
+
+	std::vector<uint32_t> softClusters;
+	for (size_t c = 0; c < clusters.size(); ++c)
+	{
+		uint32_t begin = clusters[c];
+		uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : static_cast<uint32_t>(triangleNum);
+
+		time += cacheSize + 1;
+		uint32_t clusterMisses = CountCacheMisses(&indices[begin * 3], (end - begin) * 3, cacheTime, time, cacheSize);
+		float clusterThreshold = threshold * clusterMisses / (end - begin);
+
+		softClusters.push_back(begin);
+
+		time += cacheSize + 1;
+		uint32_t misses = 0;
+		uint32_t start = begin;
+		for (uint32_t t = begin; t < end; ++t)
+		{
+			misses += CountCacheMisses(&indices[t * 3], 3, cacheTime, time, cacheSize);
+
+			if (t + 1 < end && static_cast<float>(misses) / (t + 1 - start) <= clusterThreshold)
+			{
+				softClusters.push_back(t + 1);
+				time += cacheSize + 1;
+				misses = 0;
+				start = t + 1;
+			}
+		}
+	}
+
+	float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+	for (uint32_t index : indices)
+	{
+		const float* p = GetPosition(positions, positionStride, index);
+		meshCentroid[0] += p[0];
+		meshCentroid[1] += p[1];
+		meshCentroid[2] += p[2];
+	}
+	for (float& component : meshCentroid)
+	{
+		component /= indices.size();
+	}
+
+	std::vector<float> sortKeys(softClusters.size());
+	for (size_t c = 0; c < softClusters.size(); ++c)
+	{
+		uint32_t begin = softClusters[c];
+		uint32_t end = (c + 1 < softClusters.size()) ? softClusters[c + 1] : static_cast<uint32_t>(triangleNum);
+
+		float centroid[3] = { 0.0f, 0.0f, 0.0f };
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		float areaSum = 0.0f;
+
+		for (uint32_t t = begin; t < end; ++t)
+		{
+			const float* p0 = GetPosition(positions, positionStride, indices[t * 3 + 0]);
+			const float* p1 = GetPosition(positions, positionStride, indices[t * 3 + 1]);
+			const float* p2 = GetPosition(positions, positionStride, indices[t * 3 + 2]);
+
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for (int k = 0; k < 3; ++k)
+			{
+				centroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+				normal[k] += n[k];
+			}
+			areaSum += area;
+		}
+
+		float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		float invArea = areaSum > 0.0f ? 1.0f / areaSum : 0.0f;
+		float invNormal = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+
+		float key = 0.0f;
+		for (int k = 0; k < 3; ++k)
+		{
+			key += (centroid[k] * invArea - meshCentroid[k]) * normal[k] * invNormal;
+		}
+		sortKeys[c] = key;
+	}
+
+	std::vector<uint32_t> order(softClusters.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (uint32_t c : order)
+	{
+		uint32_t begin = softClusters[c];
+		uint32_t end = (c + 1 < softClusters.size()) ? softClusters[c + 1] : static_cast<uint32_t>(triangleNum);
+		result.insert(result.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+	}
+
+	return result;
+}
+
+std::vector<uint32_t> MeshOptimizer::OptimizeVertexFetchRemap(std::vector<uint32_t>& indices, size_t vertexNum, size_t& uniqueVertexNum)
+{
+	std::vector<uint32_t> remap(vertexNum, InvalidIndex);
+	uint32_t next = 0;
+
+	for (uint32_t& index : indices)
+	{
+		if (remap[index] == InvalidIndex)
+		{
+			remap[index] = next++;
+		}
+		index = remap[index];
+	}
+
+	uniqueVertexNum = next;
+	return remap;
+}
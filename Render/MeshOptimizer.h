@@ -0,0 +1,40 @@
+#ifndef __MESHOPTIMIZER_H_
+#define __MESHOPTIMIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct VertexCacheStatistics
+{
+	uint32_t VerticesTransformed;
+	float ACMR;
+	float ATVR;
+};
+
+namespace MeshOptimizer
+{
+	static const uint32_t InvalidIndex = ~0u;
+
+	VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexNum, uint32_t cacheSize = 16);
+
+	std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexNum, uint32_t cacheSize = 16, std::vector<uint32_t>* clusters = nullptr);
+	std::vector<uint32_t> OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusters, const float* positions, size_t vertexNum, size_t positionStride, uint32_t cacheSize = 16, float threshold = 1.05f);
+	std::vector<uint32_t> OptimizeVertexFetchRemap(std::vector<uint32_t>& indices, size_t vertexNum, size_t& uniqueVertexNum);
+
+	template<typename T>
+	std::vector<T> RemapVertices(const std::vector<T>& vertices, const std::vector<uint32_t>& remap, size_t uniqueVertexNum)
+	{
+		std::vector<T> result(uniqueVertexNum);
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			if (remap[i] != InvalidIndex)
+			{
+				result[remap[i]] = vertices[i];
+			}
+		}
+		return result;
+	}
+}
+
+#endif
@@ -0,0 +1,337 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+	struct Quadric
+	{
+		double A00, A11, A22;
+		double A10, A20, A21;
+		double B0, B1, B2;
+		double C;
+		double W;
+	};
+
+	struct Collapse
+	{
+		uint32_t Source;
+		uint32_t Target;
+		double Error;
+	};
+
+	const float* GetPosition(const float* positions, size_t positionStride, uint32_t index)
+	{
+		return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + index * positionStride);
+	}
+
+	void ComputeNormal(const float* p0, const float* p1, const float* p2, double normal[3])
+	{
+		double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+		normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	}
+
+	void AddPlane(Quadric& q, double a, double b, double c, double d, double weight)
+	{
+		q.A00 += weight * a * a;
+		q.A11 += weight * b * b;
+		q.A22 += weight * c * c;
+		q.A10 += weight * a * b;
+		q.A20 += weight * a * c;
+		q.A21 += weight * b * c;
+		q.B0 += weight * a * d;
+		q.B1 += weight * b * d;
+		q.B2 += weight * c * d;
+		q.C += weight * d * d;
+		q.W += weight;
+	}
+
+	void AddQuadric(Quadric& q, const Quadric& other)
+	{
+		q.A00 += other.A00;
+		q.A11 += other.A11;
+		q.A22 += other.A22;
+		q.A10 += other.A10;
+		q.A20 += other.A20;
+		q.A21 += other.A21;
+		q.B0 += other.B0;
+		q.B1 += other.B1;
+		q.B2 += other.B2;
+		q.C += other.C;
+		q.W += other.W;
+	}
+
+	double EvaluateQuadric(const Quadric& q, const float* p)
+	{
+		double x = p[0], y = p[1], z = p[2];
+
+		double error = q.A00 * x * x + q.A11 * y * y + q.A22 * z * z
+			+ 2.0 * (q.A10 * x * y + q.A20 * x * z + q.A21 * y * z)
+			+ 2.0 * (q.B0 * x + q.B1 * y + q.B2 * z)
+			+ q.C;
+
+		return q.W > 0.0 ? std::max(0.0, error / q.W) : 0.0;
+	}
+
+	// Accumulated error after collapsing source onto target: the source's quadric distance to the
+	// target on top of what the source already carried, and never less than the target carried.
+	double GetCollapseError(const Quadric& sourceQuadric, double sourceError, double targetError, const float* targetPosition)
+	{
+		return std::max(targetError, sourceError + std::sqrt(EvaluateQuadric(sourceQuadric, targetPosition)));
+	}
+
+	std::vector<bool> FindLockedVertices(const std::vector<uint32_t>& indices, const float* positions, size_t vertexNum, size_t positionStride)
+	{
+		std::vector<uint32_t> order(vertexNum);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+		{
+			const float* pa = GetPosition(positions, positionStride, a);
+			const float* pb = GetPosition(positions, positionStride, b);
+			return std::lexicographical_compare(pa, pa + 3, pb, pb + 3);
+		});
+
+		std::vector<uint32_t> wedge(vertexNum);
+		std::vector<bool> locked(vertexNum, false);
+		for (size_t begin = 0; begin < vertexNum;)
+		{
+			const float* p = GetPosition(positions, positionStride, order[begin]);
+			size_t end = begin + 1;
+			while (end < vertexNum && std::equal(p, p + 3, GetPosition(positions, positionStride, order[end])))
+			{
+				++end;
+			}
+
+			for (size_t i = begin; i < end; ++i)
+			{
+				wedge[order[i]] = order[begin];
+				locked[order[i]] = (end - begin) > 1;
+			}
+			begin = end;
+		}
+
+		std::vector<uint64_t> edges;
+		edges.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (size_t k = 0; k < 3; ++k)
+			{
+				uint64_t a = wedge[indices[i + k]];
+				uint64_t b = wedge[indices[i + (k + 1) % 3]];
+				if (a != b) edges.push_back((a << 32) | b);
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+
+		std::vector<bool> border(vertexNum, false);
+		for (uint64_t edge : edges)
+		{
+			uint64_t reverse = (edge << 32) | (edge >> 32);
+			if (!std::binary_search(edges.begin(), edges.end(), reverse))
+			{
+				border[static_cast<uint32_t>(edge >> 32)] = true;
+				border[static_cast<uint32_t>(edge)] = true;
+			}
+		}
+
+		for (size_t i = 0; i < vertexNum; ++i)
+		{
+			if (border[wedge[i]]) locked[i] = true;
+		}
+
+		return locked;
+	}
+
+	bool HasFlip(const std::vector<uint32_t>& indices, const uint32_t* trianglesBegin, const uint32_t* trianglesEnd, uint32_t source, uint32_t target, const float* positions, size_t positionStride)
+	{
+		const float* targetPosition = GetPosition(positions, positionStride, target);
+
+		for (const uint32_t* triangle = trianglesBegin; triangle != trianglesEnd; ++triangle)
+		{
+			const uint32_t* corners = &indices[*triangle * 3];
+			if (corners[0] == target || corners[1] == target || corners[2] == target) continue;
+
+			const float* p[3];
+			const float* q[3];
+			for (int k = 0; k < 3; ++k)
+			{
+				p[k] = GetPosition(positions, positionStride, corners[k]);
+				q[k] = corners[k] == source ? targetPosition : p[k];
+			}
+
+			double before[3], after[3];
+			ComputeNormal(p[0], p[1], p[2], before);
+			ComputeNormal(q[0], q[1], q[2], after);
+
+			if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+std::vector<uint32_t> MeshSimplifier::Simplify(const std::vector<uint32_t>& indices, const float* positions, size_t vertexNum, size_t positionStride, size_t targetIndexNum, float targetError, float* resultError)
+{
+	assert(indices.size() % 3 == 0);
+
+	std::vector<uint32_t> result = indices;
+	double maxError = 0.0;
+
+	std::vector<bool> locked = FindLockedVertices(indices, positions, vertexNum, positionStride);
+
+	std::vector<Quadric> quadrics(vertexNum, Quadric());
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const float* p0 = GetPosition(positions, positionStride, indices[i + 0]);
+
+		double normal[3];
+		ComputeNormal(p0, GetPosition(positions, positionStride, indices[i + 1]), GetPosition(positions, positionStride, indices[i + 2]), normal);
+
+		double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length <= 0.0) continue;
+
+		double a = normal[0] / length, b = normal[1] / length, c = normal[2] / length;
+		double d = -(a * p0[0] + b * p0[1] + c * p0[2]);
+
+		for (size_t k = 0; k < 3; ++k)
+		{
+			AddPlane(quadrics[indices[i + k]], a, b, c, d, length * 0.5);
+		}
+	}
+
+	// Distance each vertex's neighbourhood may already have moved through earlier collapses. A
+	// collapse adds its own quadric distance on top of the source's, so the limit bounds the
+	// accumulated error rather than each collapse on its own.
+	std::vector<double> vertexError(vertexNum, 0.0);
+
+	std::vector<uint32_t> triangleOffsets(vertexNum + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> remap(vertexNum);
+	std::vector<bool> touched(vertexNum);
+
+	while (result.size() > targetIndexNum)
+	{
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+		for (uint32_t index : result)
+		{
+			++triangleOffsets[index + 1];
+		}
+		std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+
+		adjacency.resize(result.size());
+		std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (size_t i = 0; i < result.size(); ++i)
+		{
+			adjacency[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			for (size_t k = 0; k < 3; ++k)
+			{
+				uint32_t a = result[i + k];
+				uint32_t b = result[i + (k + 1) % 3];
+
+				if (!locked[a])
+				{
+					collapses.push_back({ a, b, GetCollapseError(quadrics[a], vertexError[a], vertexError[b], GetPosition(positions, positionStride, b)) });
+				}
+				if (!locked[b])
+				{
+					collapses.push_back({ b, a, GetCollapseError(quadrics[b], vertexError[b], vertexError[a], GetPosition(positions, positionStride, a)) });
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Error < b.Error; });
+
+		std::iota(remap.begin(), remap.end(), 0);
+		std::fill(touched.begin(), touched.end(), false);
+
+		size_t triangleNum = result.size() / 3;
+		size_t collapseNum = 0;
+
+		for (const Collapse& collapse : collapses)
+		{
+			if (collapse.Error > targetError) break;
+			if (triangleNum * 3 <= targetIndexNum) break;
+			if (touched[collapse.Source] || touched[collapse.Target]) continue;
+
+			const uint32_t* trianglesBegin = adjacency.data() + triangleOffsets[collapse.Source];
+			const uint32_t* trianglesEnd = adjacency.data() + triangleOffsets[collapse.Source + 1];
+			if (HasFlip(result, trianglesBegin, trianglesEnd, collapse.Source, collapse.Target, positions, positionStride)) continue;
+
+			for (const uint32_t* triangle = trianglesBegin; triangle != trianglesEnd; ++triangle)
+			{
+				for (size_t k = 0; k < 3; ++k)
+				{
+					uint32_t corner = result[*triangle * 3 + k];
+					touched[corner] = true;
+					if (corner == collapse.Target) --triangleNum;
+				}
+			}
+
+			remap[collapse.Source] = collapse.Target;
+			AddQuadric(quadrics[collapse.Target], quadrics[collapse.Source]);
+			vertexError[collapse.Target] = collapse.Error;
+			maxError = std::max(maxError, collapse.Error);
+			++collapseNum;
+		}
+
+		if (collapseNum == 0) break;
+
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			uint32_t a = remap[result[i + 0]];
+			uint32_t b = remap[result[i + 1]];
+			uint32_t c = remap[result[i + 2]];
+			if (a == b || b == c || c == a) continue;
+
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	if (resultError)
+	{
+		*resultError = static_cast<float>(maxError);
+	}
+
+	return result;
+}
+
+float MeshSimplifier::ComputeExtent(const float* positions, size_t vertexNum, size_t positionStride)
+{
+	if (vertexNum == 0) return 0.0f;
+
+	const float* first = GetPosition(positions, positionStride, 0);
+	float minimum[3] = { first[0], first[1], first[2] };
+	float maximum[3] = { first[0], first[1], first[2] };
+
+	for (size_t i = 1; i < vertexNum; ++i)
+	{
+		const float* p = GetPosition(positions, positionStride, static_cast<uint32_t>(i));
+		for (int k = 0; k < 3; ++k)
+		{
+			minimum[k] = std::min(minimum[k], p[k]);
+			maximum[k] = std::max(maximum[k], p[k]);
+		}
+	}
+
+	return std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+}
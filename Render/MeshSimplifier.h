@@ -0,0 +1,17 @@
+#ifndef __MESHSIMPLIFIER_H_
+#define __MESHSIMPLIFIER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MeshSimplifier
+{
+	// targetError limits the quadric distance accumulated over chained collapses, an object-space
+	// estimate of how far the surface moved; resultError receives the largest accumulated value.
+	std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const float* positions, size_t vertexNum, size_t positionStride, size_t targetIndexNum, float targetError, float* resultError = nullptr);
+
+	float ComputeExtent(const float* positions, size_t vertexNum, size_t positionStride);
+}
+
+#endif
@@ -0,0 +1,342 @@
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	struct Float3
+	{
+		float X;
+		float Y;
+		float Z;
+	};
+
+	Float3 GetPosition(const float* positions, size_t positionStride, uint32_t index)
+	{
+		const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + index * positionStride);
+		return { p[0], p[1], p[2] };
+	}
+
+	Float3 Subtract(const Float3& a, const Float3& b)
+	{
+		return { a.X - b.X, a.Y - b.Y, a.Z - b.Z };
+	}
+
+	Float3 Cross(const Float3& a, const Float3& b)
+	{
+		return { a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X };
+	}
+
+	float Dot(const Float3& a, const Float3& b)
+	{
+		return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+	}
+
+	float Length(const Float3& a)
+	{
+		return std::sqrt(Dot(a, a));
+	}
+
+	XMFLOAT4 ComputeBoundingSphere(const std::vector<Float3>& points)
+	{
+		size_t minIndex[3] = { 0, 0, 0 };
+		size_t maxIndex[3] = { 0, 0, 0 };
+		for (size_t i = 1; i < points.size(); ++i)
+		{
+			const float* p = &points[i].X;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				if (p[axis] < (&points[minIndex[axis]].X)[axis]) minIndex[axis] = i;
+				if (p[axis] > (&points[maxIndex[axis]].X)[axis]) maxIndex[axis] = i;
+			}
+		}
+
+		int widestAxis = 0;
+		float widestSpan = -1.0f;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float span = Length(Subtract(points[maxIndex[axis]], points[minIndex[axis]]));
+			if (span > widestSpan)
+			{
+				widestSpan = span;
+				widestAxis = axis;
+			}
+		}
+
+		const Float3& p0 = points[minIndex[widestAxis]];
+		const Float3& p1 = points[maxIndex[widestAxis]];
+		Float3 center = { (p0.X + p1.X) * 0.5f, (p0.Y + p1.Y) * 0.5f, (p0.Z + p1.Z) * 0.5f };
+		float radius = widestSpan * 0.5f;
+
+		for (const Float3& point : points)
+		{
+			Float3 offset = Subtract(point, center);
+			float distance = Length(offset);
+			if (distance > radius)
+			{
+				float shift = (distance - radius) * 0.5f / distance;
+				center = { center.X + offset.X * shift, center.Y + offset.Y * shift, center.Z + offset.Z * shift };
+				radius = (radius + distance) * 0.5f;
+			}
+		}
+
+		return XMFLOAT4(center.X, center.Y, center.Z, radius);
+	}
+
+	MeshletCullData ComputeCullData(const Meshlet& meshlet, const MeshletData& data, const float* positions, size_t positionStride)
+	{
+		MeshletCullData cullData = {};
+
+		std::vector<Float3> points(meshlet.VertexCount);
+		for (uint32_t i = 0; i < meshlet.VertexCount; ++i)
+		{
+			points[i] = GetPosition(positions, positionStride, data.UniqueVertexIndices[meshlet.VertexOffset + i]);
+		}
+		cullData.BoundingSphere = ComputeBoundingSphere(points);
+
+		std::vector<Float3> normals;
+		std::vector<Float3> corners;
+		normals.reserve(meshlet.PrimitiveCount);
+		corners.reserve(meshlet.PrimitiveCount);
+
+		Float3 axis = { 0.0f, 0.0f, 0.0f };
+		for (uint32_t i = 0; i < meshlet.PrimitiveCount; ++i)
+		{
+			uint32_t i0, i1, i2;
+			MeshletBuilder::UnpackPrimitive(data.PrimitiveIndices[meshlet.PrimitiveOffset + i], i0, i1, i2);
+
+			Float3 normal = Cross(Subtract(points[i1], points[i0]), Subtract(points[i2], points[i0]));
+			float length = Length(normal);
+			if (length <= 0.0f) continue;
+
+			normal = { normal.X / length, normal.Y / length, normal.Z / length };
+			normals.push_back(normal);
+			corners.push_back(points[i0]);
+			axis = { axis.X + normal.X, axis.Y + normal.Y, axis.Z + normal.Z };
+		}
+
+		float axisLength = Length(axis);
+		if (normals.empty() || axisLength <= 0.0f)
+		{
+			cullData.NormalCone = MeshletBuilder::PackNormalCone(0.0f, 0.0f, 0.0f, 1.0f);
+			return cullData;
+		}
+
+		XMFLOAT4 quantized = MeshletBuilder::UnpackNormalCone(MeshletBuilder::PackNormalCone(axis.X / axisLength, axis.Y / axisLength, axis.Z / axisLength, 1.0f));
+		Float3 quantizedAxis = { quantized.x, quantized.y, quantized.z };
+		float quantizedLength = Length(quantizedAxis);
+		quantizedAxis = { quantizedAxis.X / quantizedLength, quantizedAxis.Y / quantizedLength, quantizedAxis.Z / quantizedLength };
+
+		float minDot = 1.0f;
+		for (const Float3& normal : normals)
+		{
+			minDot = std::min(minDot, Dot(normal, quantizedAxis));
+		}
+
+		if (minDot <= 0.1f)
+		{
+			cullData.NormalCone = MeshletBuilder::PackNormalCone(quantizedAxis.X, quantizedAxis.Y, quantizedAxis.Z, 1.0f);
+			return cullData;
+		}
+
+		Float3 center = { cullData.BoundingSphere.x, cullData.BoundingSphere.y, cullData.BoundingSphere.z };
+		float apexOffset = 0.0f;
+		for (size_t i = 0; i < normals.size(); ++i)
+		{
+			float distance = Dot(Subtract(center, corners[i]), normals[i]) / Dot(quantizedAxis, normals[i]);
+			apexOffset = std::max(apexOffset, distance);
+		}
+
+		cullData.NormalCone = MeshletBuilder::PackNormalCone(quantizedAxis.X, quantizedAxis.Y, quantizedAxis.Z, std::sqrt(1.0f - minDot * minDot));
+		cullData.ApexOffset = apexOffset;
+
+		return cullData;
+	}
+}
+
+MeshletData MeshletBuilder::Build(const std::vector<uint32_t>& indices, const float* positions, size_t vertexNum, size_t positionStride, uint32_t maxVertices, uint32_t maxPrimitives)
+{
+	assert(indices.size() % 3 == 0);
+	assert(maxVertices >= 3 && maxVertices <= 256 && maxPrimitives >= 1);
+
+	MeshletData data;
+	if (indices.empty()) return data;
+
+	std::vector<uint8_t> localIndex(vertexNum, 0xff);
+
+	Meshlet meshlet = {};
+	auto flush = [&]()
+	{
+		for (uint32_t i = 0; i < meshlet.VertexCount; ++i)
+		{
+			localIndex[data.UniqueVertexIndices[meshlet.VertexOffset + i]] = 0xff;
+		}
+		data.Meshlets.push_back(meshlet);
+
+		meshlet.VertexOffset += meshlet.VertexCount;
+		meshlet.PrimitiveOffset += meshlet.PrimitiveCount;
+		meshlet.VertexCount = 0;
+		meshlet.PrimitiveCount = 0;
+	};
+
+	for (size_t t = 0; t < indices.size(); t += 3)
+	{
+		uint32_t newVertexNum = 0;
+		for (size_t k = 0; k < 3; ++k)
+		{
+			if (localIndex[indices[t + k]] == 0xff) ++newVertexNum;
+		}
+
+		if (meshlet.VertexCount + newVertexNum > maxVertices || meshlet.PrimitiveCount + 1 > maxPrimitives)
+		{
+			flush();
+		}
+
+		uint32_t local[3];
+		for (size_t k = 0; k < 3; ++k)
+		{
+			uint32_t index = indices[t + k];
+			if (localIndex[index] == 0xff)
+			{
+				localIndex[index] = static_cast<uint8_t>(meshlet.VertexCount++);
+				data.UniqueVertexIndices.push_back(index);
+			}
+			local[k] = localIndex[index];
+		}
+
+		data.PrimitiveIndices.push_back(PackPrimitive(local[0], local[1], local[2]));
+		++meshlet.PrimitiveCount;
+	}
+
+	if (meshlet.PrimitiveCount > 0)
+	{
+		flush();
+	}
+
+	data.CullData.reserve(data.Meshlets.size());
+	for (const Meshlet& m : data.Meshlets)
+	{
+		data.CullData.push_back(ComputeCullData(m, data, positions, positionStride));
+	}
+
+	return data;
+}
+
+uint32_t MeshletBuilder::PackPrimitive(uint32_t i0, uint32_t i1, uint32_t i2)
+{
+	return (i0 & 0xff) | ((i1 & 0xff) << 8) | ((i2 & 0xff) << 16);
+}
+
+void MeshletBuilder::UnpackPrimitive(uint32_t primitive, uint32_t& i0, uint32_t& i1, uint32_t& i2)
+{
+	i0 = primitive & 0xff;
+	i1 = (primitive >> 8) & 0xff;
+	i2 = (primitive >> 16) & 0xff;
+}
+
+uint32_t MeshletBuilder::PackNormalCone(float axisX, float axisY, float axisZ, float cutoff)
+{
+	auto packSnorm = [](float value) -> uint32_t
+	{
+		int quantized = static_cast<int>(std::round(std::max(-1.0f, std::min(1.0f, value)) * 127.0f));
+		return static_cast<uint32_t>(quantized) & 0xff;
+	};
+
+	uint32_t packedCutoff = static_cast<uint32_t>(std::ceil(std::max(0.0f, std::min(1.0f, cutoff)) * 255.0f));
+
+	return packSnorm(axisX) | (packSnorm(axisY) << 8) | (packSnorm(axisZ) << 16) | (packedCutoff << 24);
+}
+
+XMFLOAT4 MeshletBuilder::UnpackNormalCone(uint32_t normalCone)
+{
+	auto unpackSnorm = [](uint32_t value) -> float
+	{
+		return static_cast<int8_t>(value & 0xff) / 127.0f;
+	};
+
+	return XMFLOAT4(unpackSnorm(normalCone), unpackSnorm(normalCone >> 8), unpackSnorm(normalCone >> 16), (normalCone >> 24) / 255.0f);
+}
+
+void MeshletCuller::ExtractFrustumPlanes(const XMFLOAT4X4& viewProjection, XMFLOAT4 planes[6])
+{
+	XMFLOAT4 columns[4];
+	for (int c = 0; c < 4; ++c)
+	{
+		columns[c] = XMFLOAT4(viewProjection.m[0][c], viewProjection.m[1][c], viewProjection.m[2][c], viewProjection.m[3][c]);
+	}
+
+	auto combine = [](const XMFLOAT4& a, const XMFLOAT4& b, float sign) -> XMFLOAT4
+	{
+		return XMFLOAT4(a.x + sign * b.x, a.y + sign * b.y, a.z + sign * b.z, a.w + sign * b.w);
+	};
+
+	planes[0] = combine(columns[3], columns[0], 1.0f);
+	planes[1] = combine(columns[3], columns[0], -1.0f);
+	planes[2] = combine(columns[3], columns[1], 1.0f);
+	planes[3] = combine(columns[3], columns[1], -1.0f);
+	planes[4] = columns[2];
+	planes[5] = combine(columns[3], columns[2], -1.0f);
+
+	for (int i = 0; i < 6; ++i)
+	{
+		float length = std::sqrt(planes[i].x * planes[i].x + planes[i].y * planes[i].y + planes[i].z * planes[i].z);
+		planes[i] = XMFLOAT4(planes[i].x / length, planes[i].y / length, planes[i].z / length, planes[i].w / length);
+	}
+}
+
+bool MeshletCuller::IsVisible(const MeshletCullData& cullData, const XMFLOAT4 planes[6], const XMFLOAT3& cameraPosition)
+{
+	const XMFLOAT4& sphere = cullData.BoundingSphere;
+	for (int i = 0; i < 6; ++i)
+	{
+		if (planes[i].x * sphere.x + planes[i].y * sphere.y + planes[i].z * sphere.z + planes[i].w < -sphere.w)
+		{
+			return false;
+		}
+	}
+
+	XMFLOAT4 cone = MeshletBuilder::UnpackNormalCone(cullData.NormalCone);
+	if (cone.w >= 1.0f)
+	{
+		return true;
+	}
+
+	// The snorm8 axis is only approximately unit length, and ApexOffset was measured along the
+	// normalized axis.
+	float coneLength = std::sqrt(cone.x * cone.x + cone.y * cone.y + cone.z * cone.z);
+	float axisX = cone.x / coneLength;
+	float axisY = cone.y / coneLength;
+	float axisZ = cone.z / coneLength;
+
+	float apexX = sphere.x - axisX * cullData.ApexOffset;
+	float apexY = sphere.y - axisY * cullData.ApexOffset;
+	float apexZ = sphere.z - axisZ * cullData.ApexOffset;
+
+	float viewX = apexX - cameraPosition.x;
+	float viewY = apexY - cameraPosition.y;
+	float viewZ = apexZ - cameraPosition.z;
+	float viewLength = std::sqrt(viewX * viewX + viewY * viewY + viewZ * viewZ);
+	if (viewLength <= 0.0f)
+	{
+		return true;
+	}
+
+	return (viewX * axisX + viewY * axisY + viewZ * axisZ) / viewLength < cone.w;
+}
+
+uint32_t MeshletCuller::Cull(const MeshletData& meshlets, const XMFLOAT4 planes[6], const XMFLOAT3& cameraPosition, std::vector<uint32_t>& visibleMeshlets)
+{
+	visibleMeshlets.clear();
+	for (size_t i = 0; i < meshlets.CullData.size(); ++i)
+	{
+		if (IsVisible(meshlets.CullData[i], planes, cameraPosition))
+		{
+			visibleMeshlets.push_back(static_cast<uint32_t>(i));
+		}
+	}
+	return static_cast<uint32_t>(meshlets.CullData.size() - visibleMeshlets.size());
+}
@@ -0,0 +1,55 @@
+#ifndef __MESHLET_H_
+#define __MESHLET_H_
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Meshlet
+{
+	uint32_t VertexOffset;
+	uint32_t VertexCount;
+	uint32_t PrimitiveOffset;
+	uint32_t PrimitiveCount;
+};
+
+struct MeshletCullData
+{
+	DirectX::XMFLOAT4 BoundingSphere;
+	uint32_t NormalCone;
+	float ApexOffset;
+};
+
+struct MeshletData
+{
+	std::vector<Meshlet> Meshlets;
+	std::vector<uint32_t> UniqueVertexIndices;
+	std::vector<uint32_t> PrimitiveIndices;
+	std::vector<MeshletCullData> CullData;
+};
+
+namespace MeshletBuilder
+{
+	static const uint32_t MaxVertices = 64;
+	static const uint32_t MaxPrimitives = 124;
+
+	MeshletData Build(const std::vector<uint32_t>& indices, const float* positions, size_t vertexNum, size_t positionStride, uint32_t maxVertices = MaxVertices, uint32_t maxPrimitives = MaxPrimitives);
+
+	uint32_t PackPrimitive(uint32_t i0, uint32_t i1, uint32_t i2);
+	void UnpackPrimitive(uint32_t primitive, uint32_t& i0, uint32_t& i1, uint32_t& i2);
+
+	uint32_t PackNormalCone(float axisX, float axisY, float axisZ, float cutoff);
+	DirectX::XMFLOAT4 UnpackNormalCone(uint32_t normalCone);
+}
+
+namespace MeshletCuller
+{
+	void ExtractFrustumPlanes(const DirectX::XMFLOAT4X4& viewProjection, DirectX::XMFLOAT4 planes[6]);
+
+	bool IsVisible(const MeshletCullData& cullData, const DirectX::XMFLOAT4 planes[6], const DirectX::XMFLOAT3& cameraPosition);
+	uint32_t Cull(const MeshletData& meshlets, const DirectX::XMFLOAT4 planes[6], const DirectX::XMFLOAT3& cameraPosition, std::vector<uint32_t>& visibleMeshlets);
+}
+
+#endif
@@ -0,0 +1,1216 @@
+#include "ModelImporter.h"
+#include "HighResolutionClock.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cwctype>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	const uint32_t InvalidIndex = ~0u;
+
+	struct ParsedPrimitive
+	{
+		ImportedPrimitive Data;
+		bool HasNormals;
+	};
+
+	std::vector<uint8_t> ReadFile(const fs::path& filePath)
+	{
+		std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+		if (!file)
+			throw std::exception("Failed to open model file.");
+
+		std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		if (!file)
+			throw std::exception("Failed to read model file.");
+
+		return data;
+	}
+
+	struct JsonValue
+	{
+		enum class Type
+		{
+			Null,
+			Bool,
+			Number,
+			String,
+			Array,
+			Object,
+		};
+
+		Type ValueType = Type::Null;
+		bool Bool = false;
+		double Number = 0.0;
+		std::string String;
+		std::vector<JsonValue> Array;
+		std::vector<std::pair<std::string, JsonValue>> Object;
+
+		const JsonValue* Find(const char* key) const
+		{
+			for (const auto& member : Object)
+			{
+				if (member.first == key) return &member.second;
+			}
+			return nullptr;
+		}
+
+		const JsonValue& At(size_t index) const
+		{
+			if (ValueType != Type::Array || index >= Array.size())
+				throw std::exception("glTF index out of range.");
+			return Array[index];
+		}
+
+		int64_t GetInt(const char* key, int64_t defaultValue) const
+		{
+			const JsonValue* value = Find(key);
+			return (value && value->ValueType == Type::Number) ? static_cast<int64_t>(value->Number) : defaultValue;
+		}
+	};
+
+	class JsonParser
+	{
+	public:
+		JsonParser(const char* begin, const char* end) : mCurrent(begin), mEnd(end), mDepth(0) {}
+
+		JsonValue Parse()
+		{
+			JsonValue value = ParseValue();
+			SkipWhitespace();
+			if (mCurrent != mEnd)
+				throw std::exception("Unexpected data after JSON document.");
+			return value;
+		}
+
+	private:
+		static const uint32_t MaxDepth = 256;
+
+		void SkipWhitespace()
+		{
+			while (mCurrent != mEnd && (*mCurrent == ' ' || *mCurrent == '\t' || *mCurrent == '\n' || *mCurrent == '\r'))
+			{
+				++mCurrent;
+			}
+		}
+
+		char Next()
+		{
+			if (mCurrent == mEnd)
+				throw std::exception("Unexpected end of JSON document.");
+			return *mCurrent++;
+		}
+
+		void Expect(const char* literal)
+		{
+			for (; *literal; ++literal)
+			{
+				if (Next() != *literal)
+					throw std::exception("Invalid JSON literal.");
+			}
+		}
+
+		JsonValue ParseValue()
+		{
+			SkipWhitespace();
+			if (mCurrent == mEnd)
+				throw std::exception("Unexpected end of JSON document.");
+
+			JsonValue value;
+			switch (*mCurrent)
+			{
+			case '{':
+				value.ValueType = JsonValue::Type::Object;
+				ParseContainer('}', [&]()
+				{
+					SkipWhitespace();
+					std::string key = ParseString();
+					SkipWhitespace();
+					if (Next() != ':')
+						throw std::exception("Expected ':' in JSON object.");
+					value.Object.emplace_back(std::move(key), ParseValue());
+				});
+				break;
+			case '[':
+				value.ValueType = JsonValue::Type::Array;
+				ParseContainer(']', [&]() { value.Array.push_back(ParseValue()); });
+				break;
+			case '"':
+				value.ValueType = JsonValue::Type::String;
+				value.String = ParseString();
+				break;
+			case 't':
+				Expect("true");
+				value.ValueType = JsonValue::Type::Bool;
+				value.Bool = true;
+				break;
+			case 'f':
+				Expect("false");
+				value.ValueType = JsonValue::Type::Bool;
+				break;
+			case 'n':
+				Expect("null");
+				break;
+			default:
+				value.ValueType = JsonValue::Type::Number;
+				value.Number = ParseNumber();
+				break;
+			}
+			return value;
+		}
+
+		template<typename Function>
+		void ParseContainer(char close, Function parseElement)
+		{
+			if (++mDepth > MaxDepth)
+				throw std::exception("JSON document nested too deeply.");
+
+			++mCurrent;
+			SkipWhitespace();
+			if (mCurrent != mEnd && *mCurrent == close)
+			{
+				++mCurrent;
+			}
+			else
+			{
+				while (true)
+				{
+					parseElement();
+					SkipWhitespace();
+					char c = Next();
+					if (c == close) break;
+					if (c != ',')
+						throw std::exception("Expected ',' in JSON container.");
+				}
+			}
+
+			--mDepth;
+		}
+
+		uint32_t ParseHex4()
+		{
+			uint32_t code = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				char c = Next();
+				code <<= 4;
+				if (c >= '0' && c <= '9') code |= c - '0';
+				else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+				else throw std::exception("Invalid JSON unicode escape.");
+			}
+			return code;
+		}
+
+		static void AppendUtf8(std::string& result, uint32_t code)
+		{
+			if (code < 0x80)
+			{
+				result += static_cast<char>(code);
+			}
+			else if (code < 0x800)
+			{
+				result += static_cast<char>(0xc0 | (code >> 6));
+				result += static_cast<char>(0x80 | (code & 0x3f));
+			}
+			else if (code < 0x10000)
+			{
+				result += static_cast<char>(0xe0 | (code >> 12));
+				result += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+				result += static_cast<char>(0x80 | (code & 0x3f));
+			}
+			else
+			{
+				result += static_cast<char>(0xf0 | (code >> 18));
+				result += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+				result += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+				result += static_cast<char>(0x80 | (code & 0x3f));
+			}
+		}
+
+		std::string ParseString()
+		{
+			if (Next() != '"')
+				throw std::exception("Expected JSON string.");
+
+			std::string result;
+			while (true)
+			{
+				char c = Next();
+				if (c == '"') break;
+				if (c != '\\')
+				{
+					result += c;
+					continue;
+				}
+
+				c = Next();
+				switch (c)
+				{
+				case '"': result += '"'; break;
+				case '\\': result += '\\'; break;
+				case '/': result += '/'; break;
+				case 'b': result += '\b'; break;
+				case 'f': result += '\f'; break;
+				case 'n': result += '\n'; break;
+				case 'r': result += '\r'; break;
+				case 't': result += '\t'; break;
+				case 'u':
+				{
+					uint32_t code = ParseHex4();
+					if (code >= 0xd800 && code < 0xdc00)
+					{
+						Expect("\\u");
+						uint32_t low = ParseHex4();
+						if (low < 0xdc00 || low >= 0xe000)
+							throw std::exception("Invalid JSON surrogate pair.");
+						code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+					}
+					AppendUtf8(result, code);
+					break;
+				}
+				default:
+					throw std::exception("Invalid JSON escape.");
+				}
+			}
+			return result;
+		}
+
+		double ParseNumber()
+		{
+			const char* begin = mCurrent;
+			while (mCurrent != mEnd && *mCurrent && (std::strchr("+-.eE", *mCurrent) || (*mCurrent >= '0' && *mCurrent <= '9')))
+			{
+				++mCurrent;
+			}
+
+			std::string text(begin, mCurrent);
+			char* parsedEnd = nullptr;
+			double number = std::strtod(text.c_str(), &parsedEnd);
+			if (text.empty() || parsedEnd != text.c_str() + text.size())
+				throw std::exception("Invalid JSON number.");
+			return number;
+		}
+
+		const char* mCurrent;
+		const char* mEnd;
+		uint32_t mDepth;
+	};
+
+	struct ObjVertexKey
+	{
+		uint32_t Position;
+		uint32_t Texcoord;
+		uint32_t Normal;
+
+		bool operator==(const ObjVertexKey& other) const
+		{
+			return Position == other.Position && Texcoord == other.Texcoord && Normal == other.Normal;
+		}
+	};
+
+	struct ObjVertexKeyHash
+	{
+		size_t operator()(const ObjVertexKey& key) const
+		{
+			return (key.Position * 73856093u) ^ (key.Texcoord * 19349663u) ^ (key.Normal * 83492791u);
+		}
+	};
+
+	const char* SkipSpaces(const char* p)
+	{
+		while (*p == ' ' || *p == '\t') ++p;
+		return p;
+	}
+
+	uint32_t ResolveObjIndex(long index, size_t count)
+	{
+		long resolved = index < 0 ? static_cast<long>(count) + index : index - 1;
+		if (resolved < 0 || static_cast<size_t>(resolved) >= count)
+			throw std::exception("OBJ face index out of range.");
+		return static_cast<uint32_t>(resolved);
+	}
+
+	std::vector<ParsedPrimitive> ParseObj(const fs::path& filePath)
+	{
+		std::ifstream file(filePath);
+		if (!file)
+			throw std::exception("Failed to open model file.");
+
+		std::vector<DirectX::XMFLOAT3> positions;
+		std::vector<DirectX::XMFLOAT3> normals;
+		std::vector<DirectX::XMFLOAT2> texcoords;
+
+		std::vector<ParsedPrimitive> primitives(1);
+		primitives.back().HasNormals = true;
+		std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> vertexMap;
+		std::vector<uint32_t> polygon;
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			const char* p = SkipSpaces(line.c_str());
+			char* end = nullptr;
+
+			if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+			{
+				float x = std::strtof(p + 1, &end);
+				float y = std::strtof(end, &end);
+				float z = std::strtof(end, &end);
+				positions.emplace_back(x, y, z);
+			}
+			else if (p[0] == 'v' && p[1] == 'n')
+			{
+				float x = std::strtof(p + 2, &end);
+				float y = std::strtof(end, &end);
+				float z = std::strtof(end, &end);
+				normals.emplace_back(x, y, z);
+			}
+			else if (p[0] == 'v' && p[1] == 't')
+			{
+				float u = std::strtof(p + 2, &end);
+				float v = std::strtof(end, &end);
+				texcoords.emplace_back(u, 1.0f - v);
+			}
+			else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+			{
+				ParsedPrimitive& primitive = primitives.back();
+				polygon.clear();
+
+				p = SkipSpaces(p + 1);
+				while (*p && *p != '#' && *p != '\r')
+				{
+					ObjVertexKey key = { ResolveObjIndex(std::strtol(p, &end, 10), positions.size()), InvalidIndex, InvalidIndex };
+					p = end;
+					if (*p == '/')
+					{
+						++p;
+						if (*p != '/')
+						{
+							key.Texcoord = ResolveObjIndex(std::strtol(p, &end, 10), texcoords.size());
+							p = end;
+						}
+						if (*p == '/')
+						{
+							key.Normal = ResolveObjIndex(std::strtol(p + 1, &end, 10), normals.size());
+							p = end;
+						}
+					}
+					p = SkipSpaces(p);
+
+					auto result = vertexMap.emplace(key, static_cast<uint32_t>(primitive.Data.Vertices.size()));
+					if (result.second)
+					{
+						DirectX::XMFLOAT3 normal = key.Normal != InvalidIndex ? normals[key.Normal] : DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+						DirectX::XMFLOAT2 texcoord = key.Texcoord != InvalidIndex ? texcoords[key.Texcoord] : DirectX::XMFLOAT2(0.0f, 0.0f);
+						primitive.Data.Vertices.push_back(VertexPositionNormalTexture(positions[key.Position], normal, texcoord));
+						primitive.HasNormals = primitive.HasNormals && key.Normal != InvalidIndex;
+					}
+					polygon.push_back(result.first->second);
+				}
+
+				for (size_t i = 2; i < polygon.size(); ++i)
+				{
+					primitive.Data.Indices.push_back(polygon[0]);
+					primitive.Data.Indices.push_back(polygon[i - 1]);
+					primitive.Data.Indices.push_back(polygon[i]);
+				}
+			}
+			else if (std::strncmp(p, "o ", 2) == 0 || std::strncmp(p, "g ", 2) == 0 || std::strncmp(p, "usemtl ", 7) == 0)
+			{
+				if (!primitives.back().Data.Indices.empty())
+				{
+					primitives.emplace_back();
+					primitives.back().HasNormals = true;
+					vertexMap.clear();
+				}
+				std::string& name = primitives.back().Data.Name;
+				name = SkipSpaces(std::strchr(p, ' '));
+				name.erase(name.find_last_not_of(" \t\r") + 1);
+			}
+		}
+
+		primitives.erase(std::remove_if(primitives.begin(), primitives.end(), [](const ParsedPrimitive& primitive) { return primitive.Data.Indices.empty(); }), primitives.end());
+		return primitives;
+	}
+
+	std::vector<uint8_t> DecodeBase64(const std::string& text, size_t begin)
+	{
+		std::vector<uint8_t> result;
+		result.reserve((text.size() - begin) / 4 * 3);
+
+		uint32_t bits = 0;
+		int bitNum = 0;
+		for (size_t i = begin; i < text.size() && text[i] != '='; ++i)
+		{
+			char c = text[i];
+			uint32_t value;
+			if (c >= 'A' && c <= 'Z') value = c - 'A';
+			else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+			else if (c >= '0' && c <= '9') value = c - '0' + 52;
+			else if (c == '+') value = 62;
+			else if (c == '/') value = 63;
+			else throw std::exception("Invalid base64 data.");
+
+			bits = (bits << 6) | value;
+			bitNum += 6;
+			if (bitNum >= 8)
+			{
+				bitNum -= 8;
+				result.push_back(static_cast<uint8_t>(bits >> bitNum));
+			}
+		}
+		return result;
+	}
+
+	std::string DecodeUri(const std::string& uri)
+	{
+		std::string result;
+		for (size_t i = 0; i < uri.size(); ++i)
+		{
+			if (uri[i] == '%' && i + 2 < uri.size())
+			{
+				result += static_cast<char>(std::strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16));
+				i += 2;
+			}
+			else
+			{
+				result += uri[i];
+			}
+		}
+		return result;
+	}
+
+	struct GltfDocument
+	{
+		JsonValue Json;
+		std::vector<std::vector<uint8_t>> Buffers;
+	};
+
+	struct AccessorView
+	{
+		const uint8_t* Data;
+		size_t Count;
+		size_t Stride;
+		size_t ComponentSize;
+		int64_t ComponentType;
+		int64_t ComponentNum;
+		bool Normalized;
+	};
+
+	struct PrimitiveInstance
+	{
+		const JsonValue* Primitive;
+		std::array<float, 16> Transform;
+		std::string Name;
+	};
+
+	uint32_t ReadUint32(const std::vector<uint8_t>& data, size_t offset)
+	{
+		uint32_t value;
+		std::memcpy(&value, data.data() + offset, sizeof(value));
+		return value;
+	}
+
+	GltfDocument LoadGltf(const fs::path& filePath)
+	{
+		const uint32_t GlbMagic = 0x46546c67;
+		const uint32_t JsonChunk = 0x4e4f534a;
+		const uint32_t BinChunk = 0x004e4942;
+
+		std::vector<uint8_t> file = ReadFile(filePath);
+
+		const char* jsonBegin = reinterpret_cast<const char*>(file.data());
+		const char* jsonEnd = jsonBegin + file.size();
+		std::vector<uint8_t> binary;
+
+		if (file.size() >= 12 && ReadUint32(file, 0) == GlbMagic)
+		{
+			if (ReadUint32(file, 4) != 2 || ReadUint32(file, 8) > file.size())
+				throw std::exception("Unsupported GLB header.");
+
+			size_t length = ReadUint32(file, 8);
+			jsonBegin = jsonEnd = nullptr;
+			for (size_t offset = 12; offset + 8 <= length;)
+			{
+				size_t chunkLength = ReadUint32(file, offset);
+				uint32_t chunkType = ReadUint32(file, offset + 4);
+				offset += 8;
+				if (chunkLength > length - offset)
+					throw std::exception("GLB chunk out of range.");
+
+				if (chunkType == JsonChunk && !jsonBegin)
+				{
+					jsonBegin = reinterpret_cast<const char*>(file.data() + offset);
+					jsonEnd = jsonBegin + chunkLength;
+				}
+				else if (chunkType == BinChunk && binary.empty())
+				{
+					binary.assign(file.begin() + offset, file.begin() + offset + chunkLength);
+				}
+				offset += (chunkLength + 3) & ~size_t(3);
+			}
+
+			if (!jsonBegin)
+				throw std::exception("GLB file has no JSON chunk.");
+		}
+
+		GltfDocument document;
+		document.Json = JsonParser(jsonBegin, jsonEnd).Parse();
+
+		if (const JsonValue* buffers = document.Json.Find("buffers"))
+		{
+			for (const JsonValue& buffer : buffers->Array)
+			{
+				const JsonValue* uri = buffer.Find("uri");
+				std::vector<uint8_t> data;
+				if (!uri)
+				{
+					data = std::move(binary);
+				}
+				else if (uri->String.compare(0, 5, "data:") == 0)
+				{
+					size_t comma = uri->String.find(',');
+					if (comma == std::string::npos || uri->String.rfind(";base64", comma) == std::string::npos)
+						throw std::exception("Unsupported glTF data URI.");
+					data = DecodeBase64(uri->String, comma + 1);
+				}
+				else
+				{
+					data = ReadFile(filePath.parent_path() / fs::u8path(DecodeUri(uri->String)));
+				}
+
+				if (static_cast<int64_t>(data.size()) < buffer.GetInt("byteLength", 0))
+					throw std::exception("glTF buffer is smaller than its byteLength.");
+				document.Buffers.push_back(std::move(data));
+			}
+		}
+
+		return document;
+	}
+
+	AccessorView GetAccessor(const GltfDocument& document, int64_t accessorIndex)
+	{
+		const JsonValue* accessors = document.Json.Find("accessors");
+		const JsonValue* bufferViews = document.Json.Find("bufferViews");
+		if (!accessors || !bufferViews || accessorIndex < 0)
+			throw std::exception("glTF accessor out of range.");
+
+		const JsonValue& accessor = accessors->At(static_cast<size_t>(accessorIndex));
+		if (accessor.Find("sparse") || !accessor.Find("bufferView"))
+			throw std::exception("Sparse or empty glTF accessors are not supported.");
+
+		AccessorView view = {};
+		view.Count = static_cast<size_t>(accessor.GetInt("count", 0));
+		view.ComponentType = accessor.GetInt("componentType", 0);
+		const JsonValue* normalized = accessor.Find("normalized");
+		view.Normalized = normalized && normalized->Bool;
+
+		switch (view.ComponentType)
+		{
+		case 5120: case 5121: view.ComponentSize = 1; break;
+		case 5122: case 5123: view.ComponentSize = 2; break;
+		case 5125: case 5126: view.ComponentSize = 4; break;
+		default: throw std::exception("Unsupported glTF component type.");
+		}
+
+		const JsonValue* type = accessor.Find("type");
+		const std::string typeName = type ? type->String : std::string();
+		if (typeName == "SCALAR") view.ComponentNum = 1;
+		else if (typeName == "VEC2") view.ComponentNum = 2;
+		else if (typeName == "VEC3") view.ComponentNum = 3;
+		else if (typeName == "VEC4") view.ComponentNum = 4;
+		else throw std::exception("Unsupported glTF accessor type.");
+
+		const JsonValue& bufferView = bufferViews->At(static_cast<size_t>(accessor.GetInt("bufferView", 0)));
+		int64_t bufferIndex = bufferView.GetInt("buffer", -1);
+		if (bufferIndex < 0 || static_cast<size_t>(bufferIndex) >= document.Buffers.size())
+			throw std::exception("glTF buffer out of range.");
+
+		const std::vector<uint8_t>& buffer = document.Buffers[static_cast<size_t>(bufferIndex)];
+		size_t viewOffset = static_cast<size_t>(bufferView.GetInt("byteOffset", 0));
+		size_t viewLength = static_cast<size_t>(bufferView.GetInt("byteLength", 0));
+		size_t accessorOffset = static_cast<size_t>(accessor.GetInt("byteOffset", 0));
+		size_t elementSize = view.ComponentSize * static_cast<size_t>(view.ComponentNum);
+		view.Stride = static_cast<size_t>(bufferView.GetInt("byteStride", 0));
+		if (view.Stride == 0) view.Stride = elementSize;
+
+		if (viewOffset > buffer.size() || viewLength > buffer.size() - viewOffset || view.Count > viewLength
+			|| (view.Count > 0 && (accessorOffset > viewLength || (view.Count - 1) * view.Stride + elementSize > viewLength - accessorOffset)))
+			throw std::exception("glTF accessor out of range.");
+
+		view.Data = buffer.data() + viewOffset + accessorOffset;
+		return view;
+	}
+
+	float ReadComponent(const AccessorView& view, size_t element, int64_t component)
+	{
+		const uint8_t* p = view.Data + element * view.Stride + component * view.ComponentSize;
+		switch (view.ComponentType)
+		{
+		case 5120: { int8_t v = static_cast<int8_t>(*p); return view.Normalized ? std::max(v / 127.0f, -1.0f) : v; }
+		case 5121: return view.Normalized ? *p / 255.0f : *p;
+		case 5122: { int16_t v; std::memcpy(&v, p, sizeof(v)); return view.Normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+		case 5123: { uint16_t v; std::memcpy(&v, p, sizeof(v)); return view.Normalized ? v / 65535.0f : v; }
+		case 5125: { uint32_t v; std::memcpy(&v, p, sizeof(v)); return static_cast<float>(v); }
+		default: { float v; std::memcpy(&v, p, sizeof(v)); return v; }
+		}
+	}
+
+	uint32_t ReadIndex(const AccessorView& view, size_t element)
+	{
+		const uint8_t* p = view.Data + element * view.Stride;
+		switch (view.ComponentType)
+		{
+		case 5121: return *p;
+		case 5123: { uint16_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+		case 5125: { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+		default: throw std::exception("Invalid glTF index component type.");
+		}
+	}
+
+	std::array<float, 16> Multiply(const std::array<float, 16>& a, const std::array<float, 16>& b)
+	{
+		std::array<float, 16> result;
+		for (int i = 0; i < 4; ++i)
+		{
+			for (int j = 0; j < 4; ++j)
+			{
+				result[i * 4 + j] = a[i * 4 + 0] * b[0 * 4 + j] + a[i * 4 + 1] * b[1 * 4 + j] + a[i * 4 + 2] * b[2 * 4 + j] + a[i * 4 + 3] * b[3 * 4 + j];
+			}
+		}
+		return result;
+	}
+
+	std::array<float, 16> GetNodeTransform(const JsonValue& node)
+	{
+		std::array<float, 16> transform = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+		if (const JsonValue* matrix = node.Find("matrix"))
+		{
+			if (matrix->Array.size() != 16)
+				throw std::exception("Invalid glTF node matrix.");
+
+			// glTF matrices are column-major column-vector, which is the row-major row-vector layout used here.
+			for (size_t i = 0; i < 16; ++i)
+			{
+				transform[i] = static_cast<float>(matrix->Array[i].Number);
+			}
+			return transform;
+		}
+
+		auto readVector = [&](const char* key, float* values, size_t count)
+		{
+			if (const JsonValue* value = node.Find(key))
+			{
+				for (size_t i = 0; i < count && i < value->Array.size(); ++i)
+				{
+					values[i] = static_cast<float>(value->Array[i].Number);
+				}
+			}
+		};
+
+		float t[3] = { 0, 0, 0 };
+		float r[4] = { 0, 0, 0, 1 };
+		float s[3] = { 1, 1, 1 };
+		readVector("translation", t, 3);
+		readVector("rotation", r, 4);
+		readVector("scale", s, 3);
+
+		float x = r[0], y = r[1], z = r[2], w = r[3];
+		float rows[3][3] =
+		{
+			{ 1 - 2 * (y * y + z * z), 2 * (x * y + w * z), 2 * (x * z - w * y) },
+			{ 2 * (x * y - w * z), 1 - 2 * (x * x + z * z), 2 * (y * z + w * x) },
+			{ 2 * (x * z + w * y), 2 * (y * z - w * x), 1 - 2 * (x * x + y * y) },
+		};
+
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				transform[i * 4 + j] = rows[i][j] * s[i];
+			}
+			transform[12 + i] = t[i];
+		}
+		return transform;
+	}
+
+	void CollectInstances(const GltfDocument& document, int64_t nodeIndex, const std::array<float, 16>& parent, uint32_t depth, std::vector<PrimitiveInstance>& instances)
+	{
+		const uint32_t MaxNodeDepth = 64;
+		if (depth > MaxNodeDepth)
+			throw std::exception("glTF node hierarchy too deep.");
+
+		const JsonValue* nodes = document.Json.Find("nodes");
+		if (!nodes || nodeIndex < 0)
+			throw std::exception("glTF node out of range.");
+
+		const JsonValue& node = nodes->At(static_cast<size_t>(nodeIndex));
+		std::array<float, 16> transform = Multiply(GetNodeTransform(node), parent);
+
+		int64_t meshIndex = node.GetInt("mesh", -1);
+		if (meshIndex >= 0)
+		{
+			const JsonValue* meshes = document.Json.Find("meshes");
+			if (!meshes)
+				throw std::exception("glTF mesh out of range.");
+
+			const JsonValue& mesh = meshes->At(static_cast<size_t>(meshIndex));
+			const JsonValue* name = mesh.Find("name");
+			if (const JsonValue* primitives = mesh.Find("primitives"))
+			{
+				for (const JsonValue& primitive : primitives->Array)
+				{
+					instances.push_back({ &primitive, transform, name ? name->String : std::string() });
+				}
+			}
+		}
+
+		if (const JsonValue* children = node.Find("children"))
+		{
+			for (const JsonValue& child : children->Array)
+			{
+				CollectInstances(document, static_cast<int64_t>(child.Number), transform, depth + 1, instances);
+			}
+		}
+	}
+
+	ParsedPrimitive ReadPrimitive(const GltfDocument& document, const PrimitiveInstance& instance)
+	{
+		const JsonValue& primitive = *instance.Primitive;
+		if (primitive.GetInt("mode", 4) != 4)
+			throw std::exception("Only triangle list glTF primitives are supported.");
+
+		const JsonValue* attributes = primitive.Find("attributes");
+		if (!attributes || !attributes->Find("POSITION"))
+			throw std::exception("glTF primitive has no POSITION attribute.");
+
+		AccessorView positions = GetAccessor(document, attributes->GetInt("POSITION", -1));
+		if (positions.ComponentNum != 3)
+			throw std::exception("Invalid glTF POSITION accessor.");
+
+		ParsedPrimitive result;
+		result.Data.Name = instance.Name;
+		result.HasNormals = attributes->Find("NORMAL") != nullptr;
+
+		AccessorView normals = {};
+		if (result.HasNormals)
+		{
+			normals = GetAccessor(document, attributes->GetInt("NORMAL", -1));
+			if (normals.ComponentNum != 3 || normals.Count != positions.Count)
+				throw std::exception("Invalid glTF NORMAL accessor.");
+		}
+
+		AccessorView texcoords = {};
+		bool hasTexcoords = attributes->Find("TEXCOORD_0") != nullptr;
+		if (hasTexcoords)
+		{
+			texcoords = GetAccessor(document, attributes->GetInt("TEXCOORD_0", -1));
+			if (texcoords.ComponentNum != 2 || texcoords.Count != positions.Count)
+				throw std::exception("Invalid glTF TEXCOORD_0 accessor.");
+		}
+
+		const std::array<float, 16>& m = instance.Transform;
+		const float* r0 = &m[0];
+		const float* r1 = &m[4];
+		const float* r2 = &m[8];
+		float cofactor[3][3] =
+		{
+			{ r1[1] * r2[2] - r1[2] * r2[1], r1[2] * r2[0] - r1[0] * r2[2], r1[0] * r2[1] - r1[1] * r2[0] },
+			{ r2[1] * r0[2] - r2[2] * r0[1], r2[2] * r0[0] - r2[0] * r0[2], r2[0] * r0[1] - r2[1] * r0[0] },
+			{ r0[1] * r1[2] - r0[2] * r1[1], r0[2] * r1[0] - r0[0] * r1[2], r0[0] * r1[1] - r0[1] * r1[0] },
+		};
+		float determinant = r0[0] * cofactor[0][0] + r0[1] * cofactor[0][1] + r0[2] * cofactor[0][2];
+		float normalSign = determinant < 0.0f ? -1.0f : 1.0f;
+
+		VertexCollection& vertices = result.Data.Vertices;
+		vertices.resize(positions.Count);
+		for (size_t i = 0; i < positions.Count; ++i)
+		{
+			float p[3] = { ReadComponent(positions, i, 0), ReadComponent(positions, i, 1), ReadComponent(positions, i, 2) };
+			vertices[i].position = DirectX::XMFLOAT3(
+				p[0] * m[0] + p[1] * m[4] + p[2] * m[8] + m[12],
+				p[0] * m[1] + p[1] * m[5] + p[2] * m[9] + m[13],
+				p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + m[14]);
+
+			vertices[i].normal = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+			if (result.HasNormals)
+			{
+				float n[3] = { ReadComponent(normals, i, 0), ReadComponent(normals, i, 1), ReadComponent(normals, i, 2) };
+				float t[3];
+				for (int k = 0; k < 3; ++k)
+				{
+					t[k] = (n[0] * cofactor[0][k] + n[1] * cofactor[1][k] + n[2] * cofactor[2][k]) * normalSign;
+				}
+				float length = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+				if (length > 0.0f)
+				{
+					vertices[i].normal = DirectX::XMFLOAT3(t[0] / length, t[1] / length, t[2] / length);
+				}
+			}
+
+			vertices[i].textureCoordinate = hasTexcoords ? DirectX::XMFLOAT2(ReadComponent(texcoords, i, 0), ReadComponent(texcoords, i, 1)) : DirectX::XMFLOAT2(0.0f, 0.0f);
+		}
+
+		IndexCollection& indices = result.Data.Indices;
+		if (primitive.Find("indices"))
+		{
+			AccessorView indexView = GetAccessor(document, primitive.GetInt("indices", -1));
+			if (indexView.ComponentNum != 1)
+				throw std::exception("Invalid glTF index accessor.");
+
+			indices.resize(indexView.Count);
+			for (size_t i = 0; i < indexView.Count; ++i)
+			{
+				indices[i] = ReadIndex(indexView, i);
+				if (indices[i] >= positions.Count)
+					throw std::exception("glTF index out of range.");
+			}
+		}
+		else
+		{
+			indices.resize(positions.Count);
+			for (size_t i = 0; i < positions.Count; ++i)
+			{
+				indices[i] = static_cast<uint32_t>(i);
+			}
+		}
+
+		indices.resize(indices.size() - indices.size() % 3);
+		if (determinant < 0.0f)
+		{
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				std::swap(indices[i + 1], indices[i + 2]);
+			}
+		}
+
+		return result;
+	}
+
+	std::vector<ParsedPrimitive> ParseGltf(const fs::path& filePath)
+	{
+		GltfDocument document = LoadGltf(filePath);
+		const std::array<float, 16> identity = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+		std::vector<PrimitiveInstance> instances;
+		const JsonValue* scenes = document.Json.Find("scenes");
+		if (scenes && !scenes->Array.empty())
+		{
+			const JsonValue& scene = scenes->At(static_cast<size_t>(document.Json.GetInt("scene", 0)));
+			if (const JsonValue* nodes = scene.Find("nodes"))
+			{
+				for (const JsonValue& node : nodes->Array)
+				{
+					CollectInstances(document, static_cast<int64_t>(node.Number), identity, 0, instances);
+				}
+			}
+		}
+		else if (const JsonValue* meshes = document.Json.Find("meshes"))
+		{
+			for (const JsonValue& mesh : meshes->Array)
+			{
+				const JsonValue* name = mesh.Find("name");
+				if (const JsonValue* primitives = mesh.Find("primitives"))
+				{
+					for (const JsonValue& primitive : primitives->Array)
+					{
+						instances.push_back({ &primitive, identity, name ? name->String : std::string() });
+					}
+				}
+			}
+		}
+
+		std::vector<ParsedPrimitive> primitives(instances.size());
+		JobSystem::Get().ParallelFor(instances.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				primitives[i] = ReadPrimitive(document, instances[i]);
+			}
+		});
+
+		primitives.erase(std::remove_if(primitives.begin(), primitives.end(), [](const ParsedPrimitive& primitive) { return primitive.Data.Indices.empty(); }), primitives.end());
+		return primitives;
+	}
+
+	size_t HashBytes(const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+		return hash;
+	}
+
+	// Maps every element to the first element with identical bytes in its leading keySize bytes.
+	template<typename T>
+	std::vector<uint32_t> FindDuplicates(const std::vector<T>& elements, size_t keySize)
+	{
+		size_t tableSize = 1;
+		while (tableSize < elements.size() * 2) tableSize <<= 1;
+
+		std::vector<uint32_t> table(tableSize, InvalidIndex);
+		std::vector<uint32_t> canonical(elements.size());
+		for (size_t i = 0; i < elements.size(); ++i)
+		{
+			size_t slot = HashBytes(&elements[i], keySize) & (tableSize - 1);
+			while (table[slot] != InvalidIndex && std::memcmp(&elements[table[slot]], &elements[i], keySize) != 0)
+			{
+				slot = (slot + 1) & (tableSize - 1);
+			}
+			if (table[slot] == InvalidIndex)
+			{
+				table[slot] = static_cast<uint32_t>(i);
+			}
+			canonical[i] = table[slot];
+		}
+		return canonical;
+	}
+
+	void WeldVertices(ImportedPrimitive& primitive)
+	{
+		VertexCollection& vertices = primitive.Vertices;
+		std::vector<uint32_t> canonical = FindDuplicates(vertices, sizeof(VertexPositionNormalTexture));
+
+		std::vector<uint32_t> remap(vertices.size(), InvalidIndex);
+		VertexCollection welded;
+		welded.reserve(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			if (canonical[i] == i)
+			{
+				remap[i] = static_cast<uint32_t>(welded.size());
+				welded.push_back(vertices[i]);
+			}
+			else
+			{
+				remap[i] = remap[canonical[i]];
+			}
+		}
+		vertices.swap(welded);
+
+		IndexCollection& indices = primitive.Indices;
+		size_t write = 0;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			uint32_t a = remap[indices[i + 0]];
+			uint32_t b = remap[indices[i + 1]];
+			uint32_t c = remap[indices[i + 2]];
+			if (a == b || b == c || c == a) continue;
+
+			indices[write++] = a;
+			indices[write++] = b;
+			indices[write++] = c;
+		}
+		indices.resize(write);
+	}
+
+	void GenerateNormals(ImportedPrimitive& primitive)
+	{
+		VertexCollection& vertices = primitive.Vertices;
+		std::vector<uint32_t> canonical = FindDuplicates(vertices, sizeof(DirectX::XMFLOAT3));
+		std::vector<DirectX::XMFLOAT3> normals(vertices.size(), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+
+		const IndexCollection& indices = primitive.Indices;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const DirectX::XMFLOAT3& p0 = vertices[indices[i + 0]].position;
+			const DirectX::XMFLOAT3& p1 = vertices[indices[i + 1]].position;
+			const DirectX::XMFLOAT3& p2 = vertices[indices[i + 2]].position;
+
+			float e1[3] = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+			float e2[3] = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+
+			for (size_t k = 0; k < 3; ++k)
+			{
+				DirectX::XMFLOAT3& normal = normals[canonical[indices[i + k]]];
+				normal.x += n[0];
+				normal.y += n[1];
+				normal.z += n[2];
+			}
+		}
+
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			const DirectX::XMFLOAT3& n = normals[canonical[i]];
+			float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+			vertices[i].normal = length > 0.0f ? DirectX::XMFLOAT3(n.x / length, n.y / length, n.z / length) : DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f);
+		}
+	}
+
+	void GenerateTangents(ImportedPrimitive& primitive)
+	{
+		const VertexCollection& vertices = primitive.Vertices;
+		const IndexCollection& indices = primitive.Indices;
+		std::vector<float> tangents(vertices.size() * 3, 0.0f);
+		std::vector<float> bitangents(vertices.size() * 3, 0.0f);
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const VertexPositionNormalTexture& v0 = vertices[indices[i + 0]];
+			const VertexPositionNormalTexture& v1 = vertices[indices[i + 1]];
+			const VertexPositionNormalTexture& v2 = vertices[indices[i + 2]];
+
+			float x1[3] = { v1.position.x - v0.position.x, v1.position.y - v0.position.y, v1.position.z - v0.position.z };
+			float x2[3] = { v2.position.x - v0.position.x, v2.position.y - v0.position.y, v2.position.z - v0.position.z };
+			float s1 = v1.textureCoordinate.x - v0.textureCoordinate.x;
+			float s2 = v2.textureCoordinate.x - v0.textureCoordinate.x;
+			float t1 = v1.textureCoordinate.y - v0.textureCoordinate.y;
+			float t2 = v2.textureCoordinate.y - v0.textureCoordinate.y;
+
+			float determinant = s1 * t2 - s2 * t1;
+			if (std::abs(determinant) < 1e-20f) continue;
+
+			float r = 1.0f / determinant;
+			for (size_t k = 0; k < 3; ++k)
+			{
+				float sdir = (t2 * x1[k] - t1 * x2[k]) * r;
+				float tdir = (s1 * x2[k] - s2 * x1[k]) * r;
+				for (size_t c = 0; c < 3; ++c)
+				{
+					tangents[indices[i + c] * 3 + k] += sdir;
+					bitangents[indices[i + c] * 3 + k] += tdir;
+				}
+			}
+		}
+
+		primitive.Tangents.resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			const DirectX::XMFLOAT3& n = vertices[i].normal;
+			const float* t = &tangents[i * 3];
+			const float* b = &bitangents[i * 3];
+
+			float d = n.x * t[0] + n.y * t[1] + n.z * t[2];
+			float tangent[3] = { t[0] - n.x * d, t[1] - n.y * d, t[2] - n.z * d };
+			float length = std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+			if (length < 1e-6f)
+			{
+				float axis[3] = { std::abs(n.x) < 0.9f ? 1.0f : 0.0f, std::abs(n.x) < 0.9f ? 0.0f : 1.0f, 0.0f };
+				d = n.x * axis[0] + n.y * axis[1];
+				tangent[0] = axis[0] - n.x * d;
+				tangent[1] = axis[1] - n.y * d;
+				tangent[2] = -n.z * d;
+				length = std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+			}
+			tangent[0] /= length;
+			tangent[1] /= length;
+			tangent[2] /= length;
+
+			float cross[3] = { n.y * tangent[2] - n.z * tangent[1], n.z * tangent[0] - n.x * tangent[2], n.x * tangent[1] - n.y * tangent[0] };
+			float handedness = (cross[0] * b[0] + cross[1] * b[1] + cross[2] * b[2]) < 0.0f ? -1.0f : 1.0f;
+
+			primitive.Tangents[i] = DirectX::XMFLOAT4(tangent[0], tangent[1], tangent[2], handedness);
+		}
+	}
+
+	void ConvertToLeftHanded(ImportedPrimitive& primitive)
+	{
+		for (VertexPositionNormalTexture& vertex : primitive.Vertices)
+		{
+			vertex.position.z = -vertex.position.z;
+			vertex.normal.z = -vertex.normal.z;
+		}
+
+		IndexCollection& indices = primitive.Indices;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			std::swap(indices[i + 1], indices[i + 2]);
+		}
+	}
+
+	template<typename Function>
+	void ForEachPrimitive(std::vector<ParsedPrimitive>& primitives, Function function)
+	{
+		JobSystem::Get().ParallelFor(primitives.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				function(primitives[i]);
+			}
+		});
+	}
+}
+
+std::vector<ImportedPrimitive> ModelImporter::Import(const std::wstring& fileName, ImportStatistics* statistics, bool rhcoords)
+{
+	fs::path filePath(fileName);
+	if (!fs::exists(filePath))
+		throw std::exception("File not found.");
+
+	std::wstring extension = filePath.extension().wstring();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+
+	ImportStatistics result = {};
+	HighResolutionClock clock;
+
+	std::vector<ParsedPrimitive> primitives;
+	if (extension == L".obj")
+		primitives = ParseObj(filePath);
+	else if (extension == L".gltf" || extension == L".glb")
+		primitives = ParseGltf(filePath);
+	else
+		throw std::exception("Unsupported model format.");
+
+	if (!rhcoords)
+	{
+		ForEachPrimitive(primitives, [](ParsedPrimitive& primitive) { ConvertToLeftHanded(primitive.Data); });
+	}
+
+	clock.Tick();
+	result.ParseMilliseconds = clock.GetDeltaMilliseconds();
+
+	for (const ParsedPrimitive& primitive : primitives)
+	{
+		result.VertexNum += static_cast<uint32_t>(primitive.Data.Vertices.size());
+	}
+
+	ForEachPrimitive(primitives, [](ParsedPrimitive& primitive) { WeldVertices(primitive.Data); });
+	clock.Tick();
+	result.WeldMilliseconds = clock.GetDeltaMilliseconds();
+
+	ForEachPrimitive(primitives, [](ParsedPrimitive& primitive)
+	{
+		if (!primitive.HasNormals) GenerateNormals(primitive.Data);
+	});
+	clock.Tick();
+	result.NormalMilliseconds = clock.GetDeltaMilliseconds();
+
+	ForEachPrimitive(primitives, [](ParsedPrimitive& primitive) { GenerateTangents(primitive.Data); });
+	clock.Tick();
+	result.TangentMilliseconds = clock.GetDeltaMilliseconds();
+
+	std::vector<ImportedPrimitive> imported;
+	imported.reserve(primitives.size());
+	for (ParsedPrimitive& primitive : primitives)
+	{
+		result.WeldedVertexNum += static_cast<uint32_t>(primitive.Data.Vertices.size());
+		result.IndexNum += static_cast<uint32_t>(primitive.Data.Indices.size());
+		imported.push_back(std::move(primitive.Data));
+	}
+	result.PrimitiveNum = static_cast<uint32_t>(imported.size());
+
+	if (statistics)
+	{
+		*statistics = result;
+	}
+
+	return imported;
+}
@@ -0,0 +1,38 @@
+#ifndef __MODELIMPORTER_H_
+#define __MODELIMPORTER_H_
+
+#include "Mesh.h"
+
+#include <string>
+#include <vector>
+
+struct ImportedPrimitive
+{
+	std::string Name;
+	VertexCollection Vertices;
+	IndexCollection Indices;
+	std::vector<DirectX::XMFLOAT4> Tangents;
+};
+
+struct ImportStatistics
+{
+	uint32_t PrimitiveNum;
+	uint32_t VertexNum;
+	uint32_t IndexNum;
+	uint32_t WeldedVertexNum;
+	double ParseMilliseconds;
+	double WeldMilliseconds;
+	double NormalMilliseconds;
+	double TangentMilliseconds;
+};
+
+namespace ModelImporter
+{
+	// OBJ and glTF are right-handed with counter-clockwise front faces. Unless rhcoords is set,
+	// Z is mirrored and the winding reversed, so the primitives are already in the left-handed,
+	// clockwise-front convention of the renderer. Pass them to Mesh::Create with rhcoords = true:
+	// its left-handed path is meant for the built-in shapes and only reverses winding and U.
+	std::vector<ImportedPrimitive> Import(const std::wstring& fileName, ImportStatistics* statistics = nullptr, bool rhcoords = false);
+}
+
+#endif
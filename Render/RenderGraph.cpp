@@ -0,0 +1,608 @@
+#include "RenderGraph.h"
+#include "Application.h"
+#include "CommandList.h"
+#include "ResourceStateTracker.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+	const uint32_t UnusedPass = ~0u;
+
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	bool IsSameDesc(const D3D12_RESOURCE_DESC& a, const D3D12_RESOURCE_DESC& b)
+	{
+		return a.Dimension == b.Dimension && a.Alignment == b.Alignment && a.Width == b.Width && a.Height == b.Height && a.DepthOrArraySize == b.DepthOrArraySize
+			&& a.MipLevels == b.MipLevels && a.Format == b.Format && a.SampleDesc.Count == b.SampleDesc.Count && a.SampleDesc.Quality == b.SampleDesc.Quality
+			&& a.Layout == b.Layout && a.Flags == b.Flags;
+	}
+
+	std::wstring GetStateName(D3D12_RESOURCE_STATES state)
+	{
+		static const std::pair<D3D12_RESOURCE_STATES, const wchar_t*> stateNames[] =
+		{
+			{ D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, L"VERTEX_AND_CONSTANT_BUFFER" },
+			{ D3D12_RESOURCE_STATE_INDEX_BUFFER, L"INDEX_BUFFER" },
+			{ D3D12_RESOURCE_STATE_RENDER_TARGET, L"RENDER_TARGET" },
+			{ D3D12_RESOURCE_STATE_UNORDERED_ACCESS, L"UNORDERED_ACCESS" },
+			{ D3D12_RESOURCE_STATE_DEPTH_WRITE, L"DEPTH_WRITE" },
+			{ D3D12_RESOURCE_STATE_DEPTH_READ, L"DEPTH_READ" },
+			{ D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, L"NON_PIXEL_SHADER_RESOURCE" },
+			{ D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, L"PIXEL_SHADER_RESOURCE" },
+			{ D3D12_RESOURCE_STATE_STREAM_OUT, L"STREAM_OUT" },
+			{ D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, L"INDIRECT_ARGUMENT" },
+			{ D3D12_RESOURCE_STATE_COPY_DEST, L"COPY_DEST" },
+			{ D3D12_RESOURCE_STATE_COPY_SOURCE, L"COPY_SOURCE" },
+			{ D3D12_RESOURCE_STATE_RESOLVE_DEST, L"RESOLVE_DEST" },
+			{ D3D12_RESOURCE_STATE_RESOLVE_SOURCE, L"RESOLVE_SOURCE" },
+		};
+
+		std::wstring name;
+		for (const auto& stateName : stateNames)
+		{
+			if ((state & stateName.first) == stateName.first)
+			{
+				if (!name.empty()) name += L"|";
+				name += stateName.second;
+			}
+		}
+		return name.empty() ? L"COMMON" : name;
+	}
+}
+
+void RenderGraph::PassBuilder::Read(ResourceHandle resource, D3D12_RESOURCE_STATES state)
+{
+	assert(resource < mGraph.mResources.size() && "Invalid render graph resource");
+	assert(IsReadOnlyState(state) && "Read access must use a read-only state");
+
+	mGraph.mPasses[mPass].Accesses.push_back({ resource, state, true, false });
+}
+
+void RenderGraph::PassBuilder::Write(ResourceHandle resource, D3D12_RESOURCE_STATES state)
+{
+	assert(resource < mGraph.mResources.size() && "Invalid render graph resource");
+
+	mGraph.mPasses[mPass].Accesses.push_back({ resource, state, false, true });
+}
+
+void RenderGraph::PassBuilder::ReadWrite(ResourceHandle resource, D3D12_RESOURCE_STATES state)
+{
+	assert(resource < mGraph.mResources.size() && "Invalid render graph resource");
+
+	mGraph.mPasses[mPass].Accesses.push_back({ resource, state, true, true });
+}
+
+void RenderGraph::PassBuilder::SetSideEffect()
+{
+	mGraph.mPasses[mPass].HasSideEffect = true;
+}
+
+RenderGraph::RenderGraph()
+	: mTransientNum(0), mRequiredHeapSize(0), mHeapAlignment(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT), mbCompiled(false), mHeapSize(0)
+{}
+
+RenderGraph::~RenderGraph()
+{
+	for (auto& transient : mTransientTextures)
+	{
+		if (transient.Resource)
+		{
+			ResourceStateTracker::RemoveGlobalResourceState(transient.Resource->GetD3D12Resource().Get());
+		}
+	}
+}
+
+RenderGraph::ResourceHandle RenderGraph::CreateTexture(const std::wstring& name, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* clearValue, TextureUsage textureUsage)
+{
+	if ((desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) == 0)
+		throw std::exception("Transient textures must be render targets or depth stencils.");
+
+	ResourceNode resource = {};
+	resource.Name = name;
+	resource.Desc = desc;
+	resource.HasClearValue = clearValue != nullptr;
+	if (clearValue)
+	{
+		resource.ClearValue = *clearValue;
+	}
+	resource.Usage = textureUsage;
+	resource.FirstPass = UnusedPass;
+	resource.TransientIndex = mTransientNum++;
+
+	mResources.push_back(resource);
+	mbCompiled = false;
+	return static_cast<ResourceHandle>(mResources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::ImportTexture(const std::wstring& name, const Texture& texture, bool isOutput)
+{
+	ResourceNode resource = {};
+	resource.Name = name;
+	resource.Desc = texture.GetD3D12ResourceDesc();
+	resource.Usage = texture.GetTextureUsage();
+	resource.Imported = &texture;
+	resource.IsOutput = isOutput;
+	resource.FirstPass = UnusedPass;
+	resource.TransientIndex = ~0u;
+
+	mResources.push_back(resource);
+	mbCompiled = false;
+	return static_cast<ResourceHandle>(mResources.size() - 1);
+}
+
+void RenderGraph::AddPass(const std::wstring& name, const SetupFunction& setup, const ExecuteFunction& execute)
+{
+	PassNode pass = {};
+	pass.Name = name;
+	pass.Execute = execute;
+	mPasses.push_back(std::move(pass));
+
+	PassBuilder builder(*this, static_cast<uint32_t>(mPasses.size() - 1));
+	setup(builder);
+
+	mbCompiled = false;
+}
+
+void RenderGraph::Reset()
+{
+	mPasses.clear();
+	mResources.clear();
+	mSchedule.clear();
+	mTransientNum = 0;
+	mRequiredHeapSize = 0;
+	mbCompiled = false;
+}
+
+void RenderGraph::Compile(const AllocationInfoFunction& getAllocationInfo)
+{
+	AllocationInfoFunction allocationInfo = getAllocationInfo;
+	if (!allocationInfo)
+	{
+		auto device = Application::Get().GetDevice();
+		allocationInfo = [device](const D3D12_RESOURCE_DESC& desc)
+		{
+			return device->GetResourceAllocationInfo(0, 1, &desc);
+		};
+	}
+
+	CullPasses();
+	ComputeLifetimes();
+	AllocateTransients(allocationInfo);
+	ComputeBarriers();
+
+	mbCompiled = true;
+}
+
+void RenderGraph::CullPasses()
+{
+	std::vector<bool> neededResources(mResources.size());
+	for (size_t i = 0; i < mResources.size(); ++i)
+	{
+		neededResources[i] = mResources[i].IsOutput;
+	}
+
+	for (size_t i = mPasses.size(); i-- > 0;)
+	{
+		PassNode& pass = mPasses[i];
+
+		pass.IsCulled = !pass.HasSideEffect;
+		for (const auto& access : pass.Accesses)
+		{
+			if (access.IsWrite && neededResources[access.Resource])
+			{
+				pass.IsCulled = false;
+			}
+		}
+		if (pass.IsCulled) continue;
+
+		for (const auto& access : pass.Accesses)
+		{
+			if (access.IsWrite)
+			{
+				neededResources[access.Resource] = false;
+			}
+		}
+		for (const auto& access : pass.Accesses)
+		{
+			if (access.IsRead)
+			{
+				neededResources[access.Resource] = true;
+			}
+		}
+	}
+
+	mSchedule.clear();
+	for (uint32_t i = 0; i < mPasses.size(); ++i)
+	{
+		if (!mPasses[i].IsCulled)
+		{
+			mSchedule.push_back(i);
+		}
+	}
+}
+
+void RenderGraph::ComputeLifetimes()
+{
+	for (auto& resource : mResources)
+	{
+		resource.FirstPass = UnusedPass;
+		resource.LastPass = 0;
+	}
+
+	for (uint32_t i = 0; i < mSchedule.size(); ++i)
+	{
+		for (const auto& access : mPasses[mSchedule[i]].Accesses)
+		{
+			ResourceNode& resource = mResources[access.Resource];
+			resource.FirstPass = std::min(resource.FirstPass, i);
+			resource.LastPass = std::max(resource.LastPass, i);
+		}
+	}
+}
+
+void RenderGraph::AllocateTransients(const AllocationInfoFunction& getAllocationInfo)
+{
+	mRequiredHeapSize = 0;
+	mHeapAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+	std::vector<ResourceHandle> transients;
+	for (ResourceHandle i = 0; i < mResources.size(); ++i)
+	{
+		ResourceNode& resource = mResources[i];
+		resource.Size = 0;
+		resource.Alignment = 0;
+		resource.HeapOffset = 0;
+		resource.IsAliased = false;
+
+		if (resource.Imported || resource.FirstPass == UnusedPass) continue;
+
+		D3D12_RESOURCE_ALLOCATION_INFO info = getAllocationInfo(resource.Desc);
+		resource.Size = info.SizeInBytes;
+		resource.Alignment = std::max<uint64_t>(info.Alignment, 1);
+		mHeapAlignment = std::max(mHeapAlignment, resource.Alignment);
+		transients.push_back(i);
+	}
+
+	std::stable_sort(transients.begin(), transients.end(), [this](ResourceHandle a, ResourceHandle b)
+	{
+		return mResources[a].Size > mResources[b].Size;
+	});
+
+	std::vector<ResourceHandle> placed;
+	std::vector<std::pair<uint64_t, uint64_t>> occupiedRanges;
+	for (ResourceHandle handle : transients)
+	{
+		ResourceNode& resource = mResources[handle];
+
+		occupiedRanges.clear();
+		for (ResourceHandle other : placed)
+		{
+			const ResourceNode& otherResource = mResources[other];
+			if (otherResource.FirstPass <= resource.LastPass && resource.FirstPass <= otherResource.LastPass)
+			{
+				occupiedRanges.push_back({ otherResource.HeapOffset, otherResource.HeapOffset + otherResource.Size });
+			}
+		}
+		std::sort(occupiedRanges.begin(), occupiedRanges.end());
+
+		uint64_t offset = 0;
+		for (const auto& range : occupiedRanges)
+		{
+			if (offset + resource.Size <= range.first) break;
+			offset = std::max(offset, AlignUp(range.second, resource.Alignment));
+		}
+
+		resource.HeapOffset = offset;
+		mRequiredHeapSize = std::max(mRequiredHeapSize, offset + resource.Size);
+		placed.push_back(handle);
+	}
+
+	for (size_t i = 0; i < placed.size(); ++i)
+	{
+		for (size_t j = i + 1; j < placed.size(); ++j)
+		{
+			ResourceNode& a = mResources[placed[i]];
+			ResourceNode& b = mResources[placed[j]];
+			if (a.HeapOffset < b.HeapOffset + b.Size && b.HeapOffset < a.HeapOffset + a.Size)
+			{
+				a.IsAliased = true;
+				b.IsAliased = true;
+			}
+		}
+	}
+}
+
+void RenderGraph::ComputeBarriers()
+{
+	struct Usage
+	{
+		uint32_t SchedulePass;
+		D3D12_RESOURCE_STATES State;
+		bool IsWrite;
+	};
+
+	std::vector<std::vector<Usage>> usages(mResources.size());
+	for (uint32_t i = 0; i < mSchedule.size(); ++i)
+	{
+		PassNode& pass = mPasses[mSchedule[i]];
+		pass.Barriers.clear();
+
+		for (const auto& access : pass.Accesses)
+		{
+			auto& resourceUsages = usages[access.Resource];
+			if (resourceUsages.empty() || resourceUsages.back().SchedulePass != i)
+			{
+				resourceUsages.push_back({ i, access.State, access.IsWrite });
+				continue;
+			}
+
+			Usage& usage = resourceUsages.back();
+			if (access.IsWrite)
+			{
+				if (usage.IsWrite && usage.State != access.State)
+					throw std::exception("Render graph pass writes a resource in two different states.");
+
+				usage.State = access.State;
+				usage.IsWrite = true;
+			}
+			else if (!usage.IsWrite)
+			{
+				usage.State |= access.State;
+			}
+		}
+	}
+
+	for (ResourceHandle handle = 0; handle < mResources.size(); ++handle)
+	{
+		std::vector<Usage> groups;
+		for (const Usage& usage : usages[handle])
+		{
+			if (!groups.empty() && !groups.back().IsWrite && !usage.IsWrite)
+			{
+				groups.back().State |= usage.State;
+			}
+			else
+			{
+				groups.push_back(usage);
+			}
+		}
+		if (groups.empty()) continue;
+
+		if (mResources[handle].IsAliased)
+		{
+			mPasses[mSchedule[groups[0].SchedulePass]].Barriers.push_back({ BarrierType::Aliasing, handle, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COMMON, false });
+		}
+		mPasses[mSchedule[groups[0].SchedulePass]].Barriers.push_back({ BarrierType::Transition, handle, D3D12_RESOURCE_STATE_COMMON, groups[0].State, false });
+
+		for (size_t i = 1; i < groups.size(); ++i)
+		{
+			PassNode& pass = mPasses[mSchedule[groups[i].SchedulePass]];
+			if (groups[i].State != groups[i - 1].State)
+			{
+				pass.Barriers.push_back({ BarrierType::Transition, handle, groups[i - 1].State, groups[i].State, true });
+			}
+			else if (groups[i].State == D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+			{
+				pass.Barriers.push_back({ BarrierType::UAV, handle, groups[i].State, groups[i].State, true });
+			}
+		}
+	}
+}
+
+void RenderGraph::CreateTransientTextures()
+{
+	auto device = Application::Get().GetDevice();
+
+	if (mRequiredHeapSize > 0 && (!mHeap || mRequiredHeapSize > mHeapSize || mHeap->GetDesc().Alignment < mHeapAlignment))
+	{
+		for (auto& transient : mTransientTextures)
+		{
+			if (transient.Resource)
+			{
+				ResourceStateTracker::RemoveGlobalResourceState(transient.Resource->GetD3D12Resource().Get());
+			}
+		}
+		mTransientTextures.clear();
+
+		D3D12_HEAP_DESC heapDesc = {};
+		heapDesc.SizeInBytes = AlignUp(mRequiredHeapSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+		heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		heapDesc.Alignment = mHeapAlignment;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+
+		ThrowIfFailed(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&mHeap)));
+		mHeapSize = heapDesc.SizeInBytes;
+	}
+
+	if (mTransientTextures.size() < mTransientNum)
+	{
+		mTransientTextures.resize(mTransientNum);
+	}
+
+	for (const ResourceNode& resource : mResources)
+	{
+		if (resource.Imported || resource.FirstPass == UnusedPass) continue;
+
+		TransientTexture& transient = mTransientTextures[resource.TransientIndex];
+		if (transient.Resource && transient.HeapOffset == resource.HeapOffset && IsSameDesc(transient.Desc, resource.Desc)) continue;
+
+		if (transient.Resource)
+		{
+			ResourceStateTracker::RemoveGlobalResourceState(transient.Resource->GetD3D12Resource().Get());
+		}
+
+		ComPtr<ID3D12Resource> placedResource;
+		ThrowIfFailed(device->CreatePlacedResource(mHeap.Get(), resource.HeapOffset, &resource.Desc, D3D12_RESOURCE_STATE_COMMON,
+												   resource.HasClearValue ? &resource.ClearValue : nullptr, IID_PPV_ARGS(&placedResource)));
+		ResourceStateTracker::AddGlobalResourceState(placedResource.Get(), D3D12_RESOURCE_STATE_COMMON);
+
+		transient.Desc = resource.Desc;
+		transient.HeapOffset = resource.HeapOffset;
+		transient.Resource = std::make_unique<Texture>(placedResource, resource.Usage, resource.Name);
+	}
+}
+
+void RenderGraph::Execute(CommandList& commandList)
+{
+	if (!mbCompiled)
+	{
+		Compile();
+	}
+
+	CreateTransientTextures();
+	if (mHeap)
+	{
+		commandList.TrackResource(mHeap);
+	}
+
+	for (uint32_t passIndex : mSchedule)
+	{
+		const PassNode& pass = mPasses[passIndex];
+		for (const Barrier& barrier : pass.Barriers)
+		{
+			const Texture& texture = GetTexture(barrier.Resource);
+			switch (barrier.Type)
+			{
+			case BarrierType::Aliasing:
+				commandList.AliasingBarrier(ComPtr<ID3D12Resource>(), texture.GetD3D12Resource());
+				break;
+			case BarrierType::Transition:
+				commandList.TransitionBarrier(texture, barrier.StateAfter);
+				break;
+			case BarrierType::UAV:
+				commandList.UAVBarrier(texture);
+				break;
+			}
+			commandList.TrackResource(texture);
+		}
+
+		pass.Execute(commandList, *this);
+	}
+}
+
+const Texture& RenderGraph::GetTexture(ResourceHandle resource) const
+{
+	const ResourceNode& node = mResources[resource];
+	if (node.Imported)
+	{
+		return *node.Imported;
+	}
+
+	assert(node.TransientIndex < mTransientTextures.size() && mTransientTextures[node.TransientIndex].Resource && "Transient texture is only available while executing");
+	return *mTransientTextures[node.TransientIndex].Resource;
+}
+
+bool RenderGraph::IsPassCulled(uint32_t pass) const
+{
+	return mPasses[pass].IsCulled;
+}
+
+bool RenderGraph::IsReadOnlyState(D3D12_RESOURCE_STATES state)
+{
+	const D3D12_RESOURCE_STATES readOnlyStates = D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER | D3D12_RESOURCE_STATE_INDEX_BUFFER | D3D12_RESOURCE_STATE_DEPTH_READ
+		| D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT
+		| D3D12_RESOURCE_STATE_COPY_SOURCE | D3D12_RESOURCE_STATE_RESOLVE_SOURCE;
+
+	return state != D3D12_RESOURCE_STATE_COMMON && (state & ~readOnlyStates) == 0;
+}
+
+std::wstring RenderGraph::Dump() const
+{
+	Statistics statistics = GetStatistics();
+
+	std::wstringstream dump;
+	dump << std::fixed << std::setprecision(2);
+	dump << L"RenderGraph: " << statistics.PassNum << L" passes (" << statistics.CulledPassNum << L" culled), " << statistics.TransitionNum << L" transitions, "
+		 << statistics.AliasingNum << L" aliasing barriers, " << statistics.UAVBarrierNum << L" UAV barriers\n";
+	dump << L"Heap: " << statistics.HeapBytes / (1024.0 * 1024.0) << L" MB for " << statistics.TransientNum << L" transients ("
+		 << statistics.UnaliasedBytes / (1024.0 * 1024.0) << L" MB without aliasing)\n";
+
+	uint32_t scheduleIndex = 0;
+	for (const PassNode& pass : mPasses)
+	{
+		if (pass.IsCulled)
+		{
+			dump << L"[-] " << pass.Name << L" (culled)\n";
+			continue;
+		}
+
+		dump << L"[" << scheduleIndex++ << L"] " << pass.Name << L"\n";
+		for (const Barrier& barrier : pass.Barriers)
+		{
+			const std::wstring& name = mResources[barrier.Resource].Name;
+			switch (barrier.Type)
+			{
+			case BarrierType::Aliasing:
+				dump << L"    alias      " << name << L"\n";
+				break;
+			case BarrierType::Transition:
+				dump << L"    transition " << name << L": " << (barrier.StateBeforeKnown ? GetStateName(barrier.StateBefore) : L"?") << L" -> " << GetStateName(barrier.StateAfter) << L"\n";
+				break;
+			case BarrierType::UAV:
+				dump << L"    uav        " << name << L"\n";
+				break;
+			}
+		}
+	}
+
+	dump << L"Resources:\n";
+	for (const ResourceNode& resource : mResources)
+	{
+		dump << L"    " << resource.Name << L": " << (resource.Imported ? (resource.IsOutput ? L"imported output" : L"imported") : L"transient");
+		if (resource.FirstPass == UnusedPass)
+		{
+			dump << L", unused\n";
+			continue;
+		}
+
+		dump << L", passes " << resource.FirstPass << L"-" << resource.LastPass;
+		if (!resource.Imported)
+		{
+			dump << L", offset " << resource.HeapOffset << L", size " << resource.Size << (resource.IsAliased ? L", aliased" : L"");
+		}
+		dump << L"\n";
+	}
+
+	return dump.str();
+}
+
+RenderGraph::Statistics RenderGraph::GetStatistics() const
+{
+	Statistics statistics = {};
+	statistics.PassNum = static_cast<uint32_t>(mPasses.size());
+	statistics.HeapBytes = mRequiredHeapSize;
+
+	for (const PassNode& pass : mPasses)
+	{
+		if (pass.IsCulled)
+		{
+			++statistics.CulledPassNum;
+			continue;
+		}
+
+		for (const Barrier& barrier : pass.Barriers)
+		{
+			switch (barrier.Type)
+			{
+			case BarrierType::Aliasing: ++statistics.AliasingNum; break;
+			case BarrierType::Transition: ++statistics.TransitionNum; break;
+			case BarrierType::UAV: ++statistics.UAVBarrierNum; break;
+			}
+		}
+	}
+
+	for (const ResourceNode& resource : mResources)
+	{
+		if (resource.Imported || resource.FirstPass == UnusedPass) continue;
+
+		++statistics.TransientNum;
+		statistics.UnaliasedBytes += AlignUp(resource.Size, resource.Alignment);
+	}
+
+	return statistics;
+}
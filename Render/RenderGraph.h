@@ -0,0 +1,152 @@
+#ifndef __RENDERGRAPH_H_
+#define __RENDERGRAPH_H_
+
+#include "Core.h"
+#include "Texture.h"
+#include "TextureUsage.h"
+
+class CommandList;
+
+class RenderGraph
+{
+public:
+	using ResourceHandle = uint32_t;
+	static const ResourceHandle InvalidResource = ~0u;
+
+	struct Statistics
+	{
+		uint32_t PassNum;
+		uint32_t CulledPassNum;
+		uint32_t TransitionNum;
+		uint32_t AliasingNum;
+		uint32_t UAVBarrierNum;
+		uint32_t TransientNum;
+		uint64_t HeapBytes;
+		uint64_t UnaliasedBytes;
+	};
+
+	class PassBuilder
+	{
+	public:
+		void Read(ResourceHandle resource, D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		void Write(ResourceHandle resource, D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_RENDER_TARGET);
+		// Writes on top of the previous contents, so the passes producing them are kept.
+		void ReadWrite(ResourceHandle resource, D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_RENDER_TARGET);
+		void SetSideEffect();
+
+	private:
+		friend class RenderGraph;
+
+		PassBuilder(RenderGraph& graph, uint32_t pass) : mGraph(graph), mPass(pass) {}
+
+		RenderGraph& mGraph;
+		uint32_t mPass;
+	};
+
+	using SetupFunction = std::function<void(PassBuilder& builder)>;
+	using ExecuteFunction = std::function<void(CommandList& commandList, const RenderGraph& graph)>;
+	using AllocationInfoFunction = std::function<D3D12_RESOURCE_ALLOCATION_INFO(const D3D12_RESOURCE_DESC& desc)>;
+
+	RenderGraph();
+	virtual ~RenderGraph();
+
+	ResourceHandle CreateTexture(const std::wstring& name, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* clearValue = nullptr, TextureUsage textureUsage = TextureUsage::RenderTarget);
+	ResourceHandle ImportTexture(const std::wstring& name, const Texture& texture, bool isOutput = false);
+	void AddPass(const std::wstring& name, const SetupFunction& setup, const ExecuteFunction& execute);
+
+	void Compile(const AllocationInfoFunction& getAllocationInfo = nullptr);
+	void Execute(CommandList& commandList);
+	void Reset();
+
+	const Texture& GetTexture(ResourceHandle resource) const;
+	bool IsPassCulled(uint32_t pass) const;
+
+	std::wstring Dump() const;
+	Statistics GetStatistics() const;
+
+private:
+	RenderGraph(const RenderGraph& copy) = delete;
+	RenderGraph& operator=(const RenderGraph& other) = delete;
+
+	enum class BarrierType
+	{
+		Transition,
+		Aliasing,
+		UAV,
+	};
+
+	struct Barrier
+	{
+		BarrierType Type;
+		ResourceHandle Resource;
+		D3D12_RESOURCE_STATES StateBefore;
+		D3D12_RESOURCE_STATES StateAfter;
+		bool StateBeforeKnown;
+	};
+
+	struct ResourceAccess
+	{
+		ResourceHandle Resource;
+		D3D12_RESOURCE_STATES State;
+		bool IsRead;
+		bool IsWrite;
+	};
+
+	struct PassNode
+	{
+		std::wstring Name;
+		ExecuteFunction Execute;
+		std::vector<ResourceAccess> Accesses;
+		bool HasSideEffect;
+		bool IsCulled;
+		std::vector<Barrier> Barriers;
+	};
+
+	struct ResourceNode
+	{
+		std::wstring Name;
+		D3D12_RESOURCE_DESC Desc;
+		D3D12_CLEAR_VALUE ClearValue;
+		bool HasClearValue;
+		TextureUsage Usage;
+		const Texture* Imported;
+		bool IsOutput;
+
+		uint32_t FirstPass;
+		uint32_t LastPass;
+		uint64_t Size;
+		uint64_t Alignment;
+		uint64_t HeapOffset;
+		bool IsAliased;
+		uint32_t TransientIndex;
+	};
+
+	struct TransientTexture
+	{
+		D3D12_RESOURCE_DESC Desc;
+		uint64_t HeapOffset;
+		std::unique_ptr<Texture> Resource;
+	};
+
+	void CullPasses();
+	void ComputeLifetimes();
+	void AllocateTransients(const AllocationInfoFunction& getAllocationInfo);
+	void ComputeBarriers();
+	void CreateTransientTextures();
+
+	static bool IsReadOnlyState(D3D12_RESOURCE_STATES state);
+
+	std::vector<PassNode> mPasses;
+	std::vector<ResourceNode> mResources;
+	std::vector<uint32_t> mSchedule;
+	uint32_t mTransientNum;
+	uint64_t mRequiredHeapSize;
+	uint64_t mHeapAlignment;
+	bool mbCompiled;
+
+	ComPtr<ID3D12Heap> mHeap;
+	uint64_t mHeapSize;
+	std::vector<TransientTexture> mTransientTextures;
+};
+
+#endif
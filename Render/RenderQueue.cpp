@@ -0,0 +1,479 @@
+#include "RenderQueue.h"
+#include "ByteAddressBuffer.h"
+#include "CommandList.h"
+#include "IndirectCommandBuilder.h"
+#include "Mesh.h"
+#include "RootSignature.h"
+#include "StructuredBuffer.h"
+#include "Texture.h"
+
+RenderQueue::RenderQueue() : mMaterialSize(0), mObjectConstantSize(0), mObjectDataAddress(0), mMaterialDataAddress(0), mbSorted(true), mStatistics()
+{
+	mIndirectCommands = std::make_unique<IndirectCommandBuilder>();
+}
+
+RenderQueue::~RenderQueue() {}
+
+uint32_t RenderQueue::AddRootSignature(const RootSignature& rootSignature, const SetupFunction& setup)
+{
+	if (mRootSignatures.size() >= MaxRootSignatureNum)
+	{
+		throw std::exception("Too many root signatures in render queue");
+	}
+
+	mRootSignatures.push_back({ &rootSignature, setup });
+	return static_cast<uint32_t>(mRootSignatures.size() - 1);
+}
+
+uint32_t RenderQueue::AddPipelineState(ComPtr<ID3D12PipelineState> pipelineState)
+{
+	for (uint32_t i = 0; i < mPipelineStates.size(); ++i)
+	{
+		if (mPipelineStates[i] == pipelineState)
+		{
+			return i;
+		}
+	}
+
+	if (mPipelineStates.size() >= MaxPipelineStateNum)
+	{
+		throw std::exception("Too many pipeline states in render queue");
+	}
+
+	mPipelineStates.push_back(pipelineState);
+	return static_cast<uint32_t>(mPipelineStates.size() - 1);
+}
+
+uint32_t RenderQueue::AddMaterial(const Texture& texture, size_t sizeInBytes, const void* constants)
+{
+	if (mMaterialTextures.size() >= MaxMaterialNum)
+	{
+		throw std::exception("Too many materials in render queue");
+	}
+
+	if (mMaterialSize == 0)
+	{
+		mMaterialSize = sizeInBytes;
+	}
+	else if (mMaterialSize != sizeInBytes)
+	{
+		throw std::exception("Material constants must have the same size within a render queue");
+	}
+
+	mMaterialTextures.push_back(&texture);
+	mMaterialData.insert(mMaterialData.end(), static_cast<const uint8_t*>(constants), static_cast<const uint8_t*>(constants) + sizeInBytes);
+	return static_cast<uint32_t>(mMaterialTextures.size() - 1);
+}
+
+void RenderQueue::SetObjectWriter(size_t sizeInBytes, const ObjectWriter& writer)
+{
+	if (!mDrawItems.empty())
+	{
+		throw std::exception("Object writer must be set before any draw is submitted");
+	}
+
+	mObjectConstantSize = sizeInBytes;
+	mObjectWriter = writer;
+}
+
+void RenderQueue::Submit(Layer layer, uint32_t rootSignature, uint32_t pipelineState, uint32_t material, float viewDepth, Mesh& mesh, size_t sizeInBytes, const void* constants, uint32_t lod, const std::vector<uint32_t>* meshlets)
+{
+	if (mObjectWriter)
+	{
+		throw std::exception("Render queue with an object writer only accepts object submissions");
+	}
+
+	if (mObjectConstantSize == 0)
+	{
+		mObjectConstantSize = sizeInBytes;
+	}
+	else if (mObjectConstantSize != sizeInBytes)
+	{
+		throw std::exception("Object constants must have the same size within a render queue");
+	}
+
+	uint32_t constantOffset = static_cast<uint32_t>(mObjectConstants.size());
+	mObjectConstants.insert(mObjectConstants.end(), static_cast<const uint8_t*>(constants), static_cast<const uint8_t*>(constants) + sizeInBytes);
+	AddDrawItem(layer, rootSignature, pipelineState, material, viewDepth, mesh, constantOffset, 0, lod, meshlets);
+}
+
+void RenderQueue::SubmitObject(Layer layer, uint32_t rootSignature, uint32_t pipelineState, uint32_t material, float viewDepth, Mesh& mesh, uint32_t object, uint32_t lod, const std::vector<uint32_t>* meshlets)
+{
+	if (!mObjectWriter)
+	{
+		throw std::exception("Render queue has no object writer");
+	}
+
+	AddDrawItem(layer, rootSignature, pipelineState, material, viewDepth, mesh, 0, object, lod, meshlets);
+}
+
+void RenderQueue::AddDrawItem(Layer layer, uint32_t rootSignature, uint32_t pipelineState, uint32_t material, float viewDepth, Mesh& mesh, uint32_t constantOffset, uint32_t object, uint32_t lod, const std::vector<uint32_t>* meshlets)
+{
+	assert(rootSignature < mRootSignatures.size() && pipelineState < mPipelineStates.size() && material < mMaterialTextures.size());
+
+	DrawItem item;
+	item.Geometry = &mesh;
+	item.Lod = lod;
+	item.Meshlets = meshlets;
+	item.RootSignature = rootSignature;
+	item.PipelineState = pipelineState;
+	item.Material = material;
+	item.ConstantOffset = constantOffset;
+	item.Object = object;
+
+	mPackets.push_back({ MakeSortKey(layer, rootSignature, pipelineState, material, viewDepth), static_cast<uint32_t>(mDrawItems.size()) });
+	mDrawItems.push_back(item);
+	mbSorted = false;
+}
+
+void RenderQueue::Sort()
+{
+	if (mbSorted) return;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	mStatistics.SortPasses = RadixSort(mPackets, mScratch);
+	mStatistics.SortMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	mbSorted = true;
+}
+
+void RenderQueue::Execute(CommandList& commandList, const Bindings& bindings)
+{
+	BeginExecute();
+	if (mPackets.empty()) return;
+
+	UploadFrameData(commandList);
+
+	StateCache cache = { ~0u, ~0u, nullptr };
+	for (uint32_t objectIndex = 0; objectIndex < mPackets.size();)
+	{
+		const DrawItem& item = mDrawItems[mPackets[objectIndex].Payload];
+		ApplyState(commandList, bindings, item, cache);
+
+		uint32_t instanceCount = GetInstanceCount(objectIndex);
+		commandList.SetGraphics32BitConstants(bindings.DrawConstants, objectIndex);
+
+		if (item.Meshlets)
+		{
+			item.Geometry->Draw(commandList, *item.Meshlets);
+		}
+		else if (item.Lod != FullMesh)
+		{
+			item.Geometry->DrawLodInstanced(commandList, item.Lod, instanceCount);
+		}
+		else
+		{
+			item.Geometry->DrawInstanced(commandList, instanceCount);
+		}
+
+		objectIndex += instanceCount;
+		++mStatistics.DrawNum;
+	}
+}
+
+void RenderQueue::ExecuteIndirect(CommandList& commandList, const Bindings& bindings, const CommandSignature& commandSignature, const Culling* culling)
+{
+	if (culling && !mObjectWriter)
+	{
+		throw std::exception("GPU culling requires a render queue with an object writer");
+	}
+
+	BeginExecute();
+	if (mPackets.empty()) return;
+
+	UploadFrameData(commandList);
+
+	mIndirectCommands->Clear();
+	mIndirectBatchItems.clear();
+	for (uint32_t objectIndex = 0; objectIndex < mPackets.size();)
+	{
+		uint32_t payload = mPackets[objectIndex].Payload;
+		const DrawItem& item = mDrawItems[payload];
+		if (mIndirectBatchItems.empty() || !CanBatch(mDrawItems[mIndirectBatchItems.back()], item))
+		{
+			mIndirectCommands->BeginBatch();
+			mIndirectBatchItems.push_back(payload);
+		}
+
+		uint32_t instanceCount = item.Meshlets || culling ? 1 : GetInstanceCount(objectIndex);
+		if (item.Meshlets)
+		{
+			item.Geometry->GetMeshletDrawArguments(*item.Meshlets, mDrawArguments);
+		}
+		else
+		{
+			mDrawArguments.assign(1, item.Lod != FullMesh ? item.Geometry->GetLodDrawArguments(item.Lod, instanceCount) : item.Geometry->GetDrawArguments(instanceCount));
+		}
+
+		for (const D3D12_DRAW_INDEXED_ARGUMENTS& arguments : mDrawArguments)
+		{
+			if (culling)
+			{
+				mIndirectCommands->Add(objectIndex, arguments, (*culling->ObjectBounds)[item.Object]);
+			}
+			else
+			{
+				mIndirectCommands->Add(objectIndex, arguments);
+			}
+		}
+
+		objectIndex += instanceCount;
+	}
+
+	uint32_t commandCount = mIndirectCommands->GetCommandCount();
+	uint32_t batchCount = mIndirectCommands->GetBatchCount();
+	mStatistics.IndirectCommandNum = commandCount;
+	if (commandCount == 0) return;
+
+	size_t commandBytes = commandCount * IndirectCommandBuilder::CommandStride;
+	auto commands = commandList.AllocateDynamicBuffer(commandBytes, DataAlignment);
+	memcpy(commands.CPUAddress, mIndirectCommands->GetCommands().data(), commandBytes);
+	mStatistics.UploadBytes += commandBytes;
+
+	if (culling)
+	{
+		size_t cullItemBytes = commandCount * sizeof(IndirectCommandBuilder::CullItem);
+		auto cullItems = commandList.AllocateDynamicBuffer(cullItemBytes, DataAlignment);
+		memcpy(cullItems.CPUAddress, mIndirectCommands->GetCullItems().data(), cullItemBytes);
+		mStatistics.UploadBytes += cullItemBytes;
+
+		if (!mCulledCommands)
+		{
+			mCulledCommands = std::make_unique<StructuredBuffer>(L"Culled Indirect Commands");
+			mBatchCounters = std::make_unique<ByteAddressBuffer>(L"Indirect Batch Counters");
+		}
+
+		if (mCulledCommands->GetNumElements() < commandCount)
+		{
+			commandList.CopyStructuredBuffer(*mCulledCommands, commandCount, IndirectCommandBuilder::CommandStride, nullptr);
+		}
+		if (mBatchCounters->GetBufferSize() < batchCount * sizeof(uint32_t))
+		{
+			commandList.CopyByteAddressBuffer(*mBatchCounters, batchCount * sizeof(uint32_t), nullptr);
+		}
+
+		commandList.CullIndirectCommands(commands.GPUAddress, cullItems.GPUAddress, commandCount, batchCount, culling->FrustumPlanes, *mCulledCommands, *mBatchCounters);
+	}
+
+	StateCache cache = { ~0u, ~0u, nullptr };
+	for (uint32_t batchIndex = 0; batchIndex < batchCount; ++batchIndex)
+	{
+		const IndirectCommandBuilder::Batch& batch = mIndirectCommands->GetBatches()[batchIndex];
+		const DrawItem& item = mDrawItems[mIndirectBatchItems[batchIndex]];
+		if (batch.CommandCount == 0) continue;
+
+		ApplyState(commandList, bindings, item, cache);
+		item.Geometry->Bind(commandList);
+
+		uint64_t argumentOffset = batch.FirstCommand * IndirectCommandBuilder::CommandStride;
+		if (culling)
+		{
+			commandList.ExecuteIndirect(commandSignature, batch.CommandCount, *mCulledCommands, argumentOffset, mBatchCounters.get(), batchIndex * sizeof(uint32_t));
+		}
+		else
+		{
+			commandList.ExecuteIndirect(commandSignature, batch.CommandCount, commands, argumentOffset);
+		}
+		++mStatistics.DrawNum;
+	}
+}
+
+void RenderQueue::BeginExecute()
+{
+	Sort();
+
+	mStatistics.PacketNum = static_cast<uint32_t>(mPackets.size());
+	mStatistics.DrawNum = 0;
+	mStatistics.IndirectCommandNum = 0;
+	mStatistics.RootSignatureChanges = 0;
+	mStatistics.PipelineStateChanges = 0;
+	mStatistics.TextureChanges = 0;
+	mStatistics.UploadBytes = 0;
+}
+
+void RenderQueue::UploadFrameData(CommandList& commandList)
+{
+	size_t objectStride = Math::AlignUp(mObjectConstantSize + sizeof(uint32_t), DataAlignment);
+	auto objectData = commandList.AllocateDynamicBuffer(mPackets.size() * objectStride, DataAlignment);
+	if (mObjectWriter)
+	{
+		mSortedObjects.resize(mPackets.size());
+		for (size_t i = 0; i < mPackets.size(); ++i)
+		{
+			mSortedObjects[i] = mDrawItems[mPackets[i].Payload].Object;
+		}
+		mObjectWriter(mSortedObjects.data(), mSortedObjects.size(), objectData.CPUAddress, objectStride);
+	}
+
+	uint8_t* object = static_cast<uint8_t*>(objectData.CPUAddress);
+	for (const Packet& packet : mPackets)
+	{
+		const DrawItem& item = mDrawItems[packet.Payload];
+		uint32_t materialIndex[4] = { item.Material, 0, 0, 0 };
+		if (!mObjectWriter)
+		{
+			memcpy(object, mObjectConstants.data() + item.ConstantOffset, mObjectConstantSize);
+		}
+		memcpy(object + mObjectConstantSize, materialIndex, objectStride - mObjectConstantSize);
+		object += objectStride;
+	}
+
+	auto materialData = commandList.AllocateDynamicBuffer(mMaterialData.size(), DataAlignment);
+	memcpy(materialData.CPUAddress, mMaterialData.data(), mMaterialData.size());
+	mStatistics.UploadBytes = mPackets.size() * objectStride + mMaterialData.size();
+
+	mObjectDataAddress = objectData.GPUAddress;
+	mMaterialDataAddress = materialData.GPUAddress;
+}
+
+void RenderQueue::ApplyState(CommandList& commandList, const Bindings& bindings, const DrawItem& item, StateCache& cache)
+{
+	if (item.RootSignature != cache.RootSignature)
+	{
+		const RootSignatureEntry& entry = mRootSignatures[item.RootSignature];
+		commandList.SetGraphicsRootSignature(*entry.Signature);
+		commandList.SetGraphicsRootShaderResourceView(bindings.ObjectData, mObjectDataAddress);
+		commandList.SetGraphicsRootShaderResourceView(bindings.MaterialData, mMaterialDataAddress);
+		if (entry.Setup)
+		{
+			entry.Setup(commandList);
+		}
+
+		cache.RootSignature = item.RootSignature;
+		cache.BoundTexture = nullptr;
+		++mStatistics.RootSignatureChanges;
+	}
+
+	if (item.PipelineState != cache.PipelineState)
+	{
+		commandList.SetPipelineState(mPipelineStates[item.PipelineState]);
+		cache.PipelineState = item.PipelineState;
+		++mStatistics.PipelineStateChanges;
+	}
+
+	const Texture* texture = mMaterialTextures[item.Material];
+	if (texture != cache.BoundTexture)
+	{
+		commandList.SetShaderResourceView(bindings.Textures, 0, *texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		cache.BoundTexture = texture;
+		++mStatistics.TextureChanges;
+	}
+}
+
+uint32_t RenderQueue::GetInstanceCount(uint32_t objectIndex) const
+{
+	const DrawItem& item = mDrawItems[mPackets[objectIndex].Payload];
+
+	uint32_t instanceCount = 1;
+	while (objectIndex + instanceCount < mPackets.size() && CanInstance(item, mDrawItems[mPackets[objectIndex + instanceCount].Payload]))
+	{
+		++instanceCount;
+	}
+	return instanceCount;
+}
+
+bool RenderQueue::CanInstance(const DrawItem& first, const DrawItem& next) const
+{
+	return !first.Meshlets && !next.Meshlets &&
+		first.Geometry == next.Geometry &&
+		first.Lod == next.Lod &&
+		first.RootSignature == next.RootSignature &&
+		first.PipelineState == next.PipelineState &&
+		mMaterialTextures[first.Material] == mMaterialTextures[next.Material];
+}
+
+bool RenderQueue::CanBatch(const DrawItem& first, const DrawItem& next) const
+{
+	return first.Geometry->SharesBuffers(*next.Geometry) &&
+		first.RootSignature == next.RootSignature &&
+		first.PipelineState == next.PipelineState &&
+		mMaterialTextures[first.Material] == mMaterialTextures[next.Material];
+}
+
+void RenderQueue::Reset()
+{
+	mRootSignatures.clear();
+	mPipelineStates.clear();
+	mMaterialTextures.clear();
+	mMaterialData.clear();
+	mMaterialSize = 0;
+	mDrawItems.clear();
+	mObjectConstants.clear();
+	mObjectConstantSize = 0;
+	mObjectWriter = nullptr;
+	mPackets.clear();
+	mbSorted = true;
+}
+
+uint64_t RenderQueue::MakeSortKey(Layer layer, uint32_t rootSignature, uint32_t pipelineState, uint32_t material, float viewDepth)
+{
+	uint32_t depthBits = 0;
+	if (viewDepth > 0.0f)
+	{
+		memcpy(&depthBits, &viewDepth, sizeof(depthBits));
+	}
+
+	uint64_t state = (static_cast<uint64_t>(rootSignature & (MaxRootSignatureNum - 1)) << 26) |
+		(static_cast<uint64_t>(pipelineState & (MaxPipelineStateNum - 1)) << 16) |
+		(material & (MaxMaterialNum - 1));
+
+	if (layer == Layer::Opaque)
+	{
+		return (state << 32) | depthBits;
+	}
+
+	uint64_t inverseDepth = (~depthBits >> 1) & 0x7fffffff;
+	return (1ull << 63) | (inverseDepth << 31) | state;
+}
+
+uint32_t RenderQueue::RadixSort(std::vector<Packet>& packets, std::vector<Packet>& scratch)
+{
+	const size_t count = packets.size();
+	if (count < 2) return 0;
+
+	uint32_t histograms[8][256] = {};
+	for (const Packet& packet : packets)
+	{
+		uint64_t key = packet.Key;
+		for (uint32_t digit = 0; digit < 8; ++digit)
+		{
+			++histograms[digit][(key >> (digit * 8)) & 0xff];
+		}
+	}
+
+	scratch.resize(count);
+	Packet* source = packets.data();
+	Packet* destination = scratch.data();
+	uint32_t passNum = 0;
+
+	for (uint32_t digit = 0; digit < 8; ++digit)
+	{
+		uint32_t* histogram = histograms[digit];
+		uint32_t shift = digit * 8;
+		if (histogram[(source[0].Key >> shift) & 0xff] == count)
+		{
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (uint32_t bucket = 0; bucket < 256; ++bucket)
+		{
+			uint32_t bucketSize = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketSize;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			destination[histogram[(source[i].Key >> shift) & 0xff]++] = source[i];
+		}
+
+		std::swap(source, destination);
+		++passNum;
+	}
+
+	if (source != packets.data())
+	{
+		packets.swap(scratch);
+	}
+	return passNum;
+}
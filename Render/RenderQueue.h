@@ -0,0 +1,170 @@
+#ifndef __RENDERQUEUE_H_
+#define __RENDERQUEUE_H_
+
+#include "Core.h"
+
+class ByteAddressBuffer;
+class CommandList;
+class CommandSignature;
+class IndirectCommandBuilder;
+class Mesh;
+class RootSignature;
+class StructuredBuffer;
+class Texture;
+
+class RenderQueue
+{
+public:
+	enum class Layer : uint32_t
+	{
+		Opaque,
+		Transparent,
+	};
+
+	struct Packet
+	{
+		uint64_t Key;
+		uint32_t Payload;
+	};
+
+	struct Bindings
+	{
+		uint32_t DrawConstants;
+		uint32_t ObjectData;
+		uint32_t MaterialData;
+		uint32_t Textures;
+	};
+
+	struct Culling
+	{
+		const std::vector<DirectX::BoundingBox>* ObjectBounds;
+		DirectX::XMFLOAT4 FrustumPlanes[6];
+	};
+
+	struct Statistics
+	{
+		uint32_t PacketNum;
+		uint32_t DrawNum;
+		uint32_t IndirectCommandNum;
+		uint32_t RootSignatureChanges;
+		uint32_t PipelineStateChanges;
+		uint32_t TextureChanges;
+		uint32_t SortPasses;
+		size_t UploadBytes;
+		double SortMilliseconds;
+	};
+
+	using SetupFunction = std::function<void(CommandList& commandList)>;
+	using ObjectWriter = std::function<void(const uint32_t* objects, size_t count, void* destination, size_t stride)>;
+
+	static const uint32_t FullMesh = ~0u;
+	static const uint32_t MaxRootSignatureNum = 1 << 5;
+	static const uint32_t MaxPipelineStateNum = 1 << 10;
+	static const uint32_t MaxMaterialNum = 1 << 16;
+	static const size_t DataAlignment = 16;
+
+	RenderQueue();
+	virtual ~RenderQueue();
+
+	uint32_t AddRootSignature(const RootSignature& rootSignature, const SetupFunction& setup = nullptr);
+	uint32_t AddPipelineState(ComPtr<ID3D12PipelineState> pipelineState);
+	uint32_t AddMaterial(const Texture& texture, size_t sizeInBytes, const void* constants);
+	template<typename T>
+	uint32_t AddMaterial(const Texture& texture, const T& constants)
+	{
+		return AddMaterial(texture, sizeof(T), &constants);
+	}
+
+	void Submit(Layer layer, uint32_t rootSignature, uint32_t pipelineState, uint32_t material, float viewDepth, Mesh& mesh, size_t sizeInBytes, const void* constants, uint32_t lod = FullMesh, const std::vector<uint32_t>* meshlets = nullptr);
+	template<typename T>
+	void Submit(Layer layer, uint32_t rootSignature, uint32_t pipelineState, uint32_t material, float viewDepth, Mesh& mesh, const T& constants, uint32_t lod = FullMesh, const std::vector<uint32_t>* meshlets = nullptr)
+	{
+		Submit(layer, rootSignature, pipelineState, material, viewDepth, mesh, sizeof(T), &constants, lod, meshlets);
+	}
+
+	void SetObjectWriter(size_t sizeInBytes, const ObjectWriter& writer);
+	void SubmitObject(Layer layer, uint32_t rootSignature, uint32_t pipelineState, uint32_t material, float viewDepth, Mesh& mesh, uint32_t object, uint32_t lod = FullMesh, const std::vector<uint32_t>* meshlets = nullptr);
+
+	void Sort();
+	void Execute(CommandList& commandList, const Bindings& bindings);
+	void ExecuteIndirect(CommandList& commandList, const Bindings& bindings, const CommandSignature& commandSignature, const Culling* culling = nullptr);
+	void Reset();
+
+	const std::vector<Packet>& GetPackets() const
+	{
+		return mPackets;
+	}
+
+	Statistics GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	static uint64_t MakeSortKey(Layer layer, uint32_t rootSignature, uint32_t pipelineState, uint32_t material, float viewDepth);
+	static uint32_t RadixSort(std::vector<Packet>& packets, std::vector<Packet>& scratch);
+
+private:
+	RenderQueue(const RenderQueue& copy) = delete;
+	RenderQueue& operator=(const RenderQueue& other) = delete;
+
+	struct RootSignatureEntry
+	{
+		const RootSignature* Signature;
+		SetupFunction Setup;
+	};
+
+
+	struct DrawItem
+	{
+		Mesh* Geometry;
+		uint32_t Lod;
+		const std::vector<uint32_t>* Meshlets;
+		uint32_t RootSignature;
+		uint32_t PipelineState;
+		uint32_t Material;
+		uint32_t ConstantOffset;
+		uint32_t Object;
+	};
+
+	struct StateCache
+	{
+		uint32_t RootSignature;
+		uint32_t PipelineState;
+		const Texture* BoundTexture;
+	};
+
+	void BeginExecute();
+	void UploadFrameData(CommandList& commandList);
+	void ApplyState(CommandList& commandList, const Bindings& bindings, const DrawItem& item, StateCache& cache);
+	uint32_t GetInstanceCount(uint32_t objectIndex) const;
+	bool CanInstance(const DrawItem& first, const DrawItem& next) const;
+	bool CanBatch(const DrawItem& first, const DrawItem& next) const;
+	void AddDrawItem(Layer layer, uint32_t rootSignature, uint32_t pipelineState, uint32_t material, float viewDepth, Mesh& mesh, uint32_t constantOffset, uint32_t object, uint32_t lod, const std::vector<uint32_t>* meshlets);
+
+	std::vector<RootSignatureEntry> mRootSignatures;
+	std::vector<ComPtr<ID3D12PipelineState>> mPipelineStates;
+	std::vector<const Texture*> mMaterialTextures;
+	std::vector<uint8_t> mMaterialData;
+	size_t mMaterialSize;
+	std::vector<DrawItem> mDrawItems;
+	std::vector<uint8_t> mObjectConstants;
+	size_t mObjectConstantSize;
+	ObjectWriter mObjectWriter;
+	std::vector<uint32_t> mSortedObjects;
+	D3D12_GPU_VIRTUAL_ADDRESS mObjectDataAddress;
+	D3D12_GPU_VIRTUAL_ADDRESS mMaterialDataAddress;
+
+	std::unique_ptr<IndirectCommandBuilder> mIndirectCommands;
+	std::vector<uint32_t> mIndirectBatchItems;
+	std::vector<D3D12_DRAW_INDEXED_ARGUMENTS> mDrawArguments;
+	std::unique_ptr<StructuredBuffer> mCulledCommands;
+	std::unique_ptr<ByteAddressBuffer> mBatchCounters;
+
+	std::vector<Packet> mPackets;
+	std::vector<Packet> mScratch;
+	bool mbSorted;
+
+	Statistics mStatistics;
+};
+
+#endif
@@ -0,0 +1,244 @@
+#include "Scene.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace
+{
+	const uint8_t LocalDirty = 1;
+	const uint8_t Collected = 2;
+}
+
+const Scene::Entity Scene::InvalidEntity;
+
+Scene::Scene() : mStatistics() {}
+
+Scene::~Scene() {}
+
+Scene::Entity Scene::CreateEntity(Entity parent)
+{
+	return CreateEntity(XMVectorZero(), XMQuaternionIdentity(), XMVectorSplatOne(), parent);
+}
+
+Scene::Entity Scene::CreateEntity(FXMVECTOR position, FXMVECTOR rotation, FXMVECTOR scale, Entity parent)
+{
+	if (parent != InvalidEntity && parent >= mParents.size())
+	{
+		throw std::exception("Invalid parent entity");
+	}
+
+	Entity entity = static_cast<Entity>(mParents.size());
+
+	mPositions.emplace_back();
+	mRotations.emplace_back();
+	mScales.emplace_back();
+	XMStoreFloat3(&mPositions.back(), position);
+	XMStoreFloat4(&mRotations.back(), rotation);
+	XMStoreFloat3(&mScales.back(), scale);
+	mParents.push_back(parent);
+	mWorldMatrices.emplace_back();
+	XMStoreFloat4x4(&mWorldMatrices.back(), XMMatrixIdentity());
+
+	mFirstChildren.push_back(InvalidEntity);
+	mNextSiblings.push_back(InvalidEntity);
+	mDepths.push_back(0);
+	mDirtyFlags.push_back(0);
+
+	if (parent != InvalidEntity)
+	{
+		mNextSiblings[entity] = mFirstChildren[parent];
+		mFirstChildren[parent] = entity;
+		mDepths[entity] = mDepths[parent] + 1;
+	}
+
+	MarkDirty(entity);
+	return entity;
+}
+
+void Scene::Clear()
+{
+	mPositions.clear();
+	mRotations.clear();
+	mScales.clear();
+	mParents.clear();
+	mWorldMatrices.clear();
+	mFirstChildren.clear();
+	mNextSiblings.clear();
+	mDepths.clear();
+	mDirtyFlags.clear();
+	mDirtyEntities.clear();
+	mUpdatedEntities.clear();
+}
+
+void XM_CALLCONV Scene::SetPosition(Entity entity, FXMVECTOR position)
+{
+	if (XMVector3Equal(XMLoadFloat3(&mPositions[entity]), position)) return;
+
+	XMStoreFloat3(&mPositions[entity], position);
+	MarkDirty(entity);
+}
+
+void XM_CALLCONV Scene::SetRotation(Entity entity, FXMVECTOR rotation)
+{
+	if (XMVector4Equal(XMLoadFloat4(&mRotations[entity]), rotation)) return;
+
+	XMStoreFloat4(&mRotations[entity], rotation);
+	MarkDirty(entity);
+}
+
+void XM_CALLCONV Scene::SetScale(Entity entity, FXMVECTOR scale)
+{
+	if (XMVector3Equal(XMLoadFloat3(&mScales[entity]), scale)) return;
+
+	XMStoreFloat3(&mScales[entity], scale);
+	MarkDirty(entity);
+}
+
+void XM_CALLCONV Scene::SetTransform(Entity entity, FXMVECTOR position, FXMVECTOR rotation, FXMVECTOR scale)
+{
+	if (XMVector3Equal(XMLoadFloat3(&mPositions[entity]), position) &&
+		XMVector4Equal(XMLoadFloat4(&mRotations[entity]), rotation) &&
+		XMVector3Equal(XMLoadFloat3(&mScales[entity]), scale))
+	{
+		return;
+	}
+
+	XMStoreFloat3(&mPositions[entity], position);
+	XMStoreFloat4(&mRotations[entity], rotation);
+	XMStoreFloat3(&mScales[entity], scale);
+	MarkDirty(entity);
+}
+
+void XM_CALLCONV Scene::SetLocalMatrix(Entity entity, FXMMATRIX localMatrix)
+{
+	XMVECTOR scale, rotation, position;
+	if (!XMMatrixDecompose(&scale, &rotation, &position, localMatrix))
+	{
+		throw std::exception("Local matrix can not be decomposed");
+	}
+	SetTransform(entity, position, rotation, scale);
+}
+
+XMVECTOR Scene::GetPosition(Entity entity) const
+{
+	return XMLoadFloat3(&mPositions[entity]);
+}
+
+XMVECTOR Scene::GetRotation(Entity entity) const
+{
+	return XMLoadFloat4(&mRotations[entity]);
+}
+
+XMVECTOR Scene::GetScale(Entity entity) const
+{
+	return XMLoadFloat3(&mScales[entity]);
+}
+
+XMMATRIX Scene::GetWorldMatrix(Entity entity) const
+{
+	return XMLoadFloat4x4(&mWorldMatrices[entity]);
+}
+
+void Scene::UpdateWorldMatrices()
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	mUpdatedEntities.clear();
+	mLevelOffsets.clear();
+
+	if (!mDirtyEntities.empty())
+	{
+		for (Entity entity : mDirtyEntities)
+		{
+			CollectSubtree(entity);
+		}
+		mDirtyEntities.clear();
+
+		uint32_t maxDepth = 0;
+		for (Entity entity : mUpdatedEntities)
+		{
+			maxDepth = std::max(maxDepth, mDepths[entity]);
+		}
+
+		mLevelOffsets.assign(maxDepth + 2, 0);
+		for (Entity entity : mUpdatedEntities)
+		{
+			++mLevelOffsets[mDepths[entity] + 1];
+		}
+		for (uint32_t level = 1; level < mLevelOffsets.size(); ++level)
+		{
+			mLevelOffsets[level] += mLevelOffsets[level - 1];
+		}
+
+		mStack.resize(mUpdatedEntities.size());
+		mLevelCursors.assign(mLevelOffsets.begin(), mLevelOffsets.end() - 1);
+		for (Entity entity : mUpdatedEntities)
+		{
+			mStack[mLevelCursors[mDepths[entity]]++] = entity;
+			mDirtyFlags[entity] = 0;
+		}
+		mUpdatedEntities.swap(mStack);
+
+		for (uint32_t level = 0; level + 1 < mLevelOffsets.size(); ++level)
+		{
+			const Entity* entities = mUpdatedEntities.data() + mLevelOffsets[level];
+			size_t count = mLevelOffsets[level + 1] - mLevelOffsets[level];
+
+			JobSystem::Get().ParallelFor(count, JobEntityNum, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					Entity entity = entities[i];
+					XMMATRIX worldMatrix = XMMatrixScalingFromVector(XMLoadFloat3(&mScales[entity])) *
+						XMMatrixRotationQuaternion(XMLoadFloat4(&mRotations[entity])) *
+						XMMatrixTranslationFromVector(XMLoadFloat3(&mPositions[entity]));
+
+					Entity parent = mParents[entity];
+					if (parent != InvalidEntity)
+					{
+						worldMatrix = worldMatrix * XMLoadFloat4x4(&mWorldMatrices[parent]);
+					}
+					XMStoreFloat4x4(&mWorldMatrices[entity], worldMatrix);
+				}
+			});
+		}
+	}
+
+	mStatistics.EntityNum = GetEntityCount();
+	mStatistics.UpdatedNum = static_cast<uint32_t>(mUpdatedEntities.size());
+	mStatistics.LevelNum = mLevelOffsets.empty() ? 0 : static_cast<uint32_t>(mLevelOffsets.size() - 1);
+	mStatistics.UpdateMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void Scene::MarkDirty(Entity entity)
+{
+	if ((mDirtyFlags[entity] & LocalDirty) == 0)
+	{
+		mDirtyFlags[entity] |= LocalDirty;
+		mDirtyEntities.push_back(entity);
+	}
+}
+
+void Scene::CollectSubtree(Entity root)
+{
+	mStack.clear();
+	mStack.push_back(root);
+
+	while (!mStack.empty())
+	{
+		Entity entity = mStack.back();
+		mStack.pop_back();
+
+		if (mDirtyFlags[entity] & Collected)
+		{
+			continue;
+		}
+		mDirtyFlags[entity] |= Collected;
+		mUpdatedEntities.push_back(entity);
+
+		for (Entity child = mFirstChildren[entity]; child != InvalidEntity; child = mNextSiblings[child])
+		{
+			mStack.push_back(child);
+		}
+	}
+}
@@ -0,0 +1,94 @@
+#ifndef __SCENE_H_
+#define __SCENE_H_
+
+#include "Core.h"
+
+class Scene
+{
+public:
+	using Entity = uint32_t;
+
+	struct Statistics
+	{
+		uint32_t EntityNum;
+		uint32_t UpdatedNum;
+		uint32_t LevelNum;
+		double UpdateMilliseconds;
+	};
+
+	static const Entity InvalidEntity = ~0u;
+	static const size_t JobEntityNum = 1024;
+
+	Scene();
+	virtual ~Scene();
+
+	Entity CreateEntity(Entity parent = InvalidEntity);
+	Entity CreateEntity(DirectX::FXMVECTOR position, DirectX::FXMVECTOR rotation, DirectX::FXMVECTOR scale, Entity parent = InvalidEntity);
+	void Clear();
+
+	void XM_CALLCONV SetPosition(Entity entity, DirectX::FXMVECTOR position);
+	void XM_CALLCONV SetRotation(Entity entity, DirectX::FXMVECTOR rotation);
+	void XM_CALLCONV SetScale(Entity entity, DirectX::FXMVECTOR scale);
+	void XM_CALLCONV SetTransform(Entity entity, DirectX::FXMVECTOR position, DirectX::FXMVECTOR rotation, DirectX::FXMVECTOR scale);
+	void XM_CALLCONV SetLocalMatrix(Entity entity, DirectX::FXMMATRIX localMatrix);
+
+	DirectX::XMVECTOR GetPosition(Entity entity) const;
+	DirectX::XMVECTOR GetRotation(Entity entity) const;
+	DirectX::XMVECTOR GetScale(Entity entity) const;
+	DirectX::XMMATRIX GetWorldMatrix(Entity entity) const;
+
+	Entity GetParent(Entity entity) const
+	{
+		return mParents[entity];
+	}
+
+	uint32_t GetEntityCount() const
+	{
+		return static_cast<uint32_t>(mParents.size());
+	}
+
+	const std::vector<DirectX::XMFLOAT4X4>& GetWorldMatrices() const
+	{
+		return mWorldMatrices;
+	}
+
+	const std::vector<Entity>& GetUpdatedEntities() const
+	{
+		return mUpdatedEntities;
+	}
+
+	void UpdateWorldMatrices();
+
+	Statistics GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+private:
+	Scene(const Scene& copy) = delete;
+	Scene& operator=(const Scene& other) = delete;
+
+	void MarkDirty(Entity entity);
+	void CollectSubtree(Entity root);
+
+	std::vector<DirectX::XMFLOAT3> mPositions;
+	std::vector<DirectX::XMFLOAT4> mRotations;
+	std::vector<DirectX::XMFLOAT3> mScales;
+	std::vector<Entity> mParents;
+	std::vector<DirectX::XMFLOAT4X4> mWorldMatrices;
+
+	std::vector<Entity> mFirstChildren;
+	std::vector<Entity> mNextSiblings;
+	std::vector<uint32_t> mDepths;
+	std::vector<uint8_t> mDirtyFlags;
+
+	std::vector<Entity> mDirtyEntities;
+	std::vector<Entity> mUpdatedEntities;
+	std::vector<uint32_t> mLevelOffsets;
+	std::vector<uint32_t> mLevelCursors;
+	std::vector<Entity> mStack;
+
+	Statistics mStatistics;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#define BLOCK_SIZE 64
+
+struct IndirectCull
+{
+    float4 FrustumPlanes[6];
+    uint CommandCount;
+};
+
+struct IndirectCommand
+{
+    uint ObjectIndex;
+    uint IndexCountPerInstance;
+    uint InstanceCount;
+    uint StartIndexLocation;
+    int BaseVertexLocation;
+    uint StartInstanceLocation;
+};
+
+struct CullItem
+{
+    float3 Center;
+    uint Batch;
+    float3 Extents;
+    uint BatchFirstCommand;
+};
+
+ConstantBuffer<IndirectCull> IndirectCullCB : register(b0);
+StructuredBuffer<IndirectCommand> InputCommands : register(t0);
+StructuredBuffer<CullItem> CullItems : register(t1);
+
+RWStructuredBuffer<IndirectCommand> OutputCommands : register(u0);
+RWByteAddressBuffer BatchCounters : register(u1);
+
+bool IsVisible(float3 center, float3 extents)
+{
+    [unroll]
+    for (uint i = 0; i < 6; ++i)
+    {
+        float4 plane = IndirectCullCB.FrustumPlanes[i];
+        if (dot(plane.xyz, center) + dot(abs(plane.xyz), extents) + plane.w < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+[numthreads(BLOCK_SIZE, 1, 1)]
+void main(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    uint command = DispatchThreadID.x;
+    if (command >= IndirectCullCB.CommandCount)
+    {
+        return;
+    }
+
+    CullItem item = CullItems[command];
+    if (!IsVisible(item.Center, item.Extents))
+    {
+        return;
+    }
+
+    uint slot;
+    BatchCounters.InterlockedAdd(item.Batch * 4, 1, slot);
+    OutputCommands[item.BatchFirstCommand + slot] = InputCommands[command];
+}
@@ -0,0 +1,115 @@
+#include "TextureAtlas.h"
+
+#include "CommandList.h"
+
+TextureAtlas::TextureAtlas(uint32_t maxAtlasSize, uint32_t maxTextureSize, uint32_t padding, uint32_t mipLevels)
+	: mMaxAtlasSize(maxAtlasSize), mMaxTextureSize(maxTextureSize), mPadding(padding), mMipLevels(mipLevels) {}
+
+TextureAtlas::~TextureAtlas() {}
+
+bool TextureAtlas::Add(const std::wstring& fileName)
+{
+	fs::path filePath(fileName);
+	if (!fs::exists(filePath))
+	{
+		throw std::exception("File not found.");
+	}
+
+	TexMetadata metadata;
+	ScratchImage scratchImage;
+	if (filePath.extension() == ".dds")
+	{
+		ThrowIfFailed(LoadFromDDSFile(fileName.c_str(), DDS_FLAGS_NONE, &metadata, scratchImage));
+	}
+	else if (filePath.extension() == ".tga")
+	{
+		ThrowIfFailed(LoadFromTGAFile(fileName.c_str(), &metadata, scratchImage));
+	}
+	else
+	{
+		ThrowIfFailed(LoadFromWICFile(fileName.c_str(), WIC_FLAGS_NONE, &metadata, scratchImage));
+	}
+
+	if (metadata.width > mMaxTextureSize || metadata.height > mMaxTextureSize || metadata.dimension != TEX_DIMENSION_TEXTURE2D || IsCompressed(metadata.format))
+	{
+		return false;
+	}
+
+	ScratchImage convertedImage;
+	const Image* image = scratchImage.GetImage(0, 0, 0);
+	if (metadata.format != DXGI_FORMAT_R8G8B8A8_UNORM)
+	{
+		ThrowIfFailed(Convert(*image, DXGI_FORMAT_R8G8B8A8_UNORM, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, convertedImage));
+		image = convertedImage.GetImage(0, 0, 0);
+	}
+
+	Source source;
+	source.FileName = fileName;
+	source.Width = static_cast<uint32_t>(image->width);
+	source.Height = static_cast<uint32_t>(image->height);
+	source.Texels.resize(static_cast<size_t>(source.Width) * source.Height);
+	for (uint32_t y = 0; y < source.Height; ++y)
+	{
+		memcpy(&source.Texels[static_cast<size_t>(y) * source.Width], image->pixels + y * image->rowPitch, source.Width * sizeof(uint32_t));
+	}
+	mSources.push_back(std::move(source));
+	return true;
+}
+
+void TextureAtlas::Build(CommandList& commandList)
+{
+	std::vector<AtlasRect> sizes;
+	for (const auto& source : mSources)
+	{
+		sizes.push_back({ 0, 0, source.Width, source.Height });
+	}
+
+	AtlasLayout layout = AtlasBuilder::Pack(sizes, mMaxAtlasSize, mPadding, mMipLevels);
+
+	std::vector<std::vector<uint32_t>> atlases(layout.AtlasNum, std::vector<uint32_t>(static_cast<size_t>(layout.AtlasSize) * layout.AtlasSize));
+	for (size_t i = 0; i < mSources.size(); ++i)
+	{
+		const auto& source = mSources[i];
+		const auto& region = layout.Regions[i];
+		AtlasBuilder::Blit(source.Texels.data(), source.Width, source.Height, atlases[region.AtlasIndex].data(), layout.AtlasSize, region.Rect, layout.Gutter);
+
+		mRegions[source.FileName] = { region.AtlasIndex, region.ScaleOffset };
+	}
+
+	for (uint32_t atlasIndex = 0; atlasIndex < layout.AtlasNum; ++atlasIndex)
+	{
+		auto mips = AtlasBuilder::GenerateMips(atlases[atlasIndex], layout.AtlasSize, layout.MipLevels);
+
+		auto desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, layout.AtlasSize, layout.AtlasSize, 1, static_cast<UINT16>(mips.size()));
+		Texture texture(desc, nullptr, TextureUsage::Albedo, L"TextureAtlas" + std::to_wstring(atlasIndex));
+
+		std::vector<D3D12_SUBRESOURCE_DATA> subresources(mips.size());
+		for (size_t mip = 0; mip < mips.size(); ++mip)
+		{
+			uint32_t mipSize = layout.AtlasSize >> mip;
+			subresources[mip].pData = mips[mip].data();
+			subresources[mip].RowPitch = mipSize * sizeof(uint32_t);
+			subresources[mip].SlicePitch = subresources[mip].RowPitch * mipSize;
+		}
+		commandList.CopyTextureSubresource(texture, 0, static_cast<uint32_t>(subresources.size()), subresources.data());
+
+		mTextures.push_back(texture);
+	}
+
+	mSources.clear();
+}
+
+bool TextureAtlas::Contains(const std::wstring& fileName) const
+{
+	return mRegions.find(fileName) != mRegions.end();
+}
+
+const TextureAtlas::Region& TextureAtlas::GetRegion(const std::wstring& fileName) const
+{
+	auto iter = mRegions.find(fileName);
+	if (iter == mRegions.end())
+	{
+		throw std::exception("Texture is not in the atlas.");
+	}
+	return iter->second;
+}
@@ -0,0 +1,57 @@
+#ifndef __TEXTUREATLAS_H_
+#define __TEXTUREATLAS_H_
+
+#include "Core.h"
+#include "AtlasPacker.h"
+#include "Texture.h"
+
+class CommandList;
+
+class TextureAtlas
+{
+public:
+	struct Region
+	{
+		uint32_t AtlasIndex;
+		XMFLOAT4 ScaleOffset;
+	};
+
+	TextureAtlas(uint32_t maxAtlasSize = 1024, uint32_t maxTextureSize = 256, uint32_t padding = 2, uint32_t mipLevels = 4);
+	virtual ~TextureAtlas();
+
+	bool Add(const std::wstring& fileName);
+	void Build(CommandList& commandList);
+
+	bool Contains(const std::wstring& fileName) const;
+	const Region& GetRegion(const std::wstring& fileName) const;
+
+	const Texture& GetTexture(uint32_t atlasIndex) const
+	{
+		return mTextures[atlasIndex];
+	}
+
+	uint32_t GetAtlasCount() const
+	{
+		return static_cast<uint32_t>(mTextures.size());
+	}
+
+private:
+	struct Source
+	{
+		std::wstring FileName;
+		uint32_t Width;
+		uint32_t Height;
+		std::vector<uint32_t> Texels;
+	};
+
+	uint32_t mMaxAtlasSize;
+	uint32_t mMaxTextureSize;
+	uint32_t mPadding;
+	uint32_t mMipLevels;
+
+	std::vector<Source> mSources;
+	std::vector<Texture> mTextures;
+	std::map<std::wstring, Region> mRegions;
+};
+
+#endif
@@ -0,0 +1,448 @@
+#include "TextureStreamer.h"
+
+#include "Application.h"
+#include "CommandList.h"
+
+#include <fstream>
+#include <sstream>
+
+TextureStreamer::TextureStreamer(const std::wstring& cookDirectory, uint64_t budgetBytes, uint32_t tailSize)
+	: mCookDirectory(cookDirectory), mTailSize(tailSize), mBudgetBytes(budgetBytes), mInFlightBytes(0), mbRunning(true)
+{
+	if (!fs::exists(mCookDirectory))
+	{
+		fs::create_directories(mCookDirectory);
+	}
+
+	mIOThread = std::thread(&TextureStreamer::IOThread, this);
+	SetThreadPriority(mIOThread.native_handle(), THREAD_PRIORITY_LOWEST);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mIOMutex);
+		mbRunning = false;
+	}
+	mIOCV.notify_all();
+	mIOThread.join();
+}
+
+StreamedTexture* TextureStreamer::LoadTexture(CommandList& commandList, const std::wstring& fileName, TextureUsage textureUsage)
+{
+	auto texture = std::make_unique<StreamedTexture>();
+	texture->mName = fileName;
+	texture->mFileName = fs::path(fileName).extension() == ".dds" ? fileName : CookTexture(fileName);
+	texture->mTexture.SetTextureUsage(textureUsage);
+	texture->mTexture.SetName(fileName);
+	texture->mScreenSize = 0.0f;
+	texture->mFixedBytes = 0;
+	texture->mbStreamable = ParseLayout(*texture);
+
+	if (texture->mbStreamable)
+	{
+		uint32_t mipLevels = texture->GetMipLevels();
+		for (uint32_t mip = texture->mTailMip; mip < mipLevels; ++mip)
+		{
+			texture->mMips[mip].Data = ReadMip(*texture, mip);
+			texture->mMips[mip].State = StreamedTexture::MipState::Loaded;
+		}
+		texture->mResidentMip = mipLevels;
+		ApplyResidency(commandList, *texture, texture->mTailMip);
+	}
+	else
+	{
+		commandList.LoadTextureFromFile(texture->mTexture, texture->mFileName, textureUsage);
+
+		auto desc = texture->mTexture.GetD3D12ResourceDesc();
+		texture->mDesc = desc;
+		texture->mFixedBytes = Application::Get().GetDevice()->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+		texture->mResidentMip = 0;
+		texture->mTailMip = 0;
+		texture->mTargetMip = 0;
+	}
+
+	mTextures.push_back(std::move(texture));
+	return mTextures.back().get();
+}
+
+void TextureStreamer::RequestScreenSize(StreamedTexture* texture, float screenSize)
+{
+	texture->mScreenSize = std::max(texture->mScreenSize, screenSize);
+}
+
+void TextureStreamer::Update(CommandList& commandList)
+{
+	uint64_t budgetBytes = mBudgetBytes;
+	uint64_t residentBytes = 0;
+	uint64_t targetBytes = 0;
+
+	std::vector<StreamedTexture*> textures;
+	for (auto& texture : mTextures)
+	{
+		if (texture->mbStreamable)
+		{
+			textures.push_back(texture.get());
+			residentBytes += GetResidentBytes(*texture, texture->mResidentMip);
+		}
+		else
+		{
+			residentBytes += texture->mFixedBytes;
+			targetBytes += texture->mFixedBytes;
+		}
+	}
+
+	std::stable_sort(textures.begin(), textures.end(), [](const StreamedTexture* a, const StreamedTexture* b)
+	{
+		return a->mScreenSize > b->mScreenSize;
+	});
+
+	for (auto texture : textures)
+	{
+		uint32_t targetMip = texture->mTailMip;
+		if (texture->mScreenSize > 0.0f)
+		{
+			float texelNum = static_cast<float>(std::max<UINT64>(texture->mDesc.Width, texture->mDesc.Height));
+			float mip = std::floor(std::log2(std::max(texelNum / texture->mScreenSize, 1.0f)));
+			targetMip = std::min(static_cast<uint32_t>(mip), texture->mTailMip);
+		}
+
+		while (targetMip < texture->mTailMip && targetBytes + GetResidentBytes(*texture, targetMip) > budgetBytes)
+		{
+			++targetMip;
+		}
+
+		texture->mTargetMip = targetMip;
+		targetBytes += GetResidentBytes(*texture, targetMip);
+	}
+
+	for (auto iter = textures.rbegin(); iter != textures.rend() && residentBytes > budgetBytes; ++iter)
+	{
+		auto texture = *iter;
+		if (texture->mResidentMip < texture->mTargetMip)
+		{
+			residentBytes -= GetResidentBytes(*texture, texture->mResidentMip) - GetResidentBytes(*texture, texture->mTargetMip);
+			ApplyResidency(commandList, *texture, texture->mTargetMip);
+		}
+	}
+
+	std::vector<uint32_t> loadedMips(textures.size());
+	{
+		std::lock_guard<std::mutex> lock(mIOMutex);
+
+		for (auto& request : mIORequests)
+		{
+			request.Texture->mMips[request.Mip].State = StreamedTexture::MipState::Unloaded;
+		}
+		mIORequests.clear();
+
+		for (size_t i = 0; i < textures.size(); ++i)
+		{
+			auto texture = textures[i];
+			for (uint32_t mip = 0; mip < texture->mTargetMip; ++mip)
+			{
+				auto& mipData = texture->mMips[mip];
+				if (mipData.State == StreamedTexture::MipState::Loaded)
+				{
+					mipData.Data = std::vector<uint8_t>();
+					mipData.State = StreamedTexture::MipState::Unloaded;
+				}
+			}
+
+			for (uint32_t mip = texture->mResidentMip; mip > texture->mTargetMip; --mip)
+			{
+				auto& mipData = texture->mMips[mip - 1];
+				if (mipData.State == StreamedTexture::MipState::Unloaded)
+				{
+					mipData.State = StreamedTexture::MipState::Queued;
+					mIORequests.push_back({ texture, mip - 1 });
+				}
+			}
+
+			uint32_t loadedMip = texture->mResidentMip;
+			while (loadedMip > texture->mTargetMip && texture->mMips[loadedMip - 1].State == StreamedTexture::MipState::Loaded)
+			{
+				--loadedMip;
+			}
+			loadedMips[i] = loadedMip;
+		}
+	}
+	mIOCV.notify_one();
+
+	for (size_t i = 0; i < textures.size(); ++i)
+	{
+		if (loadedMips[i] < textures[i]->mResidentMip)
+		{
+			ApplyResidency(commandList, *textures[i], loadedMips[i]);
+		}
+		textures[i]->mScreenSize = 0.0f;
+	}
+}
+
+void TextureStreamer::SetBudget(uint64_t budgetBytes)
+{
+	mBudgetBytes = budgetBytes;
+}
+
+uint64_t TextureStreamer::GetBudget() const
+{
+	return mBudgetBytes;
+}
+
+TextureStreamer::Statistics TextureStreamer::GetStatistics() const
+{
+	Statistics statistics = {};
+	statistics.TextureNum = static_cast<uint32_t>(mTextures.size());
+	statistics.BudgetBytes = mBudgetBytes;
+
+	for (auto& texture : mTextures)
+	{
+		if (texture->mbStreamable)
+		{
+			statistics.ResidentMips += texture->GetMipLevels() - texture->mResidentMip;
+			statistics.TotalMips += texture->GetMipLevels();
+			statistics.ResidentBytes += GetResidentBytes(*texture, texture->mResidentMip);
+		}
+		else
+		{
+			statistics.ResidentMips += texture->mDesc.MipLevels;
+			statistics.TotalMips += texture->mDesc.MipLevels;
+			statistics.ResidentBytes += texture->mFixedBytes;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mIOMutex);
+	for (auto& request : mIORequests)
+	{
+		statistics.PendingBytes += request.Texture->mMips[request.Mip].SlicePitch;
+	}
+	statistics.PendingBytes += mInFlightBytes;
+	statistics.PendingRequests = static_cast<uint32_t>(mIORequests.size()) + (mInFlightBytes > 0 ? 1 : 0);
+	return statistics;
+}
+
+float XM_CALLCONV TextureStreamer::ComputeScreenSize(FXMVECTOR center, float radius, CXMMATRIX viewMatrix, CXMMATRIX projectionMatrix, float viewportHeight)
+{
+	float distance = XMVectorGetX(XMVector3Length(XMVector3TransformCoord(center, viewMatrix)));
+	if (distance <= radius)
+	{
+		return viewportHeight;
+	}
+	return radius * XMVectorGetY(projectionMatrix.r[1]) * viewportHeight / distance;
+}
+
+std::wstring TextureStreamer::CookTexture(const std::wstring& fileName) const
+{
+	fs::path sourcePath(fileName);
+
+	// The stem keeps the cook directory readable; the hash of the absolute path, extension included,
+	// keeps textures with the same stem from different folders or formats apart.
+	std::wstringstream cookedName;
+	cookedName << sourcePath.stem().wstring() << L"_" << std::hex << std::hash<std::wstring>()(fs::absolute(sourcePath).wstring()) << L".dds";
+	fs::path cookedPath = mCookDirectory / cookedName.str();
+	if (fs::exists(cookedPath) && fs::last_write_time(cookedPath) >= fs::last_write_time(sourcePath))
+	{
+		return cookedPath.wstring();
+	}
+
+	TexMetadata metadata;
+	ScratchImage scratchImage;
+	if (sourcePath.extension() == ".hdr")
+	{
+		ThrowIfFailed(LoadFromHDRFile(fileName.c_str(), &metadata, scratchImage));
+	}
+	else if (sourcePath.extension() == ".tga")
+	{
+		ThrowIfFailed(LoadFromTGAFile(fileName.c_str(), &metadata, scratchImage));
+	}
+	else
+	{
+		ThrowIfFailed(LoadFromWICFile(fileName.c_str(), WIC_FLAGS_NONE, &metadata, scratchImage));
+	}
+
+	ScratchImage mipChain;
+	ThrowIfFailed(GenerateMipMaps(*scratchImage.GetImage(0, 0, 0), TEX_FILTER_DEFAULT, 0, mipChain));
+
+	// Written next to the destination and renamed into place: a truncated file left by an
+	// interrupted cook would be newer than its source and trusted on the next launch.
+	fs::path tempPath = cookedPath;
+	tempPath += L".tmp";
+	HRESULT hr = SaveToDDSFile(mipChain.GetImages(), mipChain.GetImageCount(), mipChain.GetMetadata(), DDS_FLAGS_FORCE_DX10_EXT, tempPath.c_str());
+	if (FAILED(hr))
+	{
+		fs::remove(tempPath);
+		ThrowIfFailed(hr);
+	}
+	fs::remove(cookedPath);
+	fs::rename(tempPath, cookedPath);
+
+	return cookedPath.wstring();
+}
+
+bool TextureStreamer::ParseLayout(StreamedTexture& texture) const
+{
+	TexMetadata metadata;
+	if (FAILED(GetMetadataFromDDSFile(texture.mFileName.c_str(), DDS_FLAGS_NONE, metadata)) || metadata.dimension != TEX_DIMENSION_TEXTURE2D || metadata.arraySize != 1 ||
+		metadata.IsCubemap() || IsPlanar(metadata.format) || IsPalettized(metadata.format))
+	{
+		return false;
+	}
+
+	uint32_t width = static_cast<uint32_t>(metadata.width);
+	uint32_t height = static_cast<uint32_t>(metadata.height);
+	if (IsCompressed(metadata.format) && ((width & (width - 1)) != 0 || (height & (height - 1)) != 0))
+	{
+		return false;
+	}
+
+	std::ifstream file(texture.mFileName.c_str(), std::ios::binary | std::ios::ate);
+	uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+	uint32_t header[32] = {};
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!file)
+	{
+		return false;
+	}
+
+	uint64_t offset = header[21] == MAKEFOURCC('D', 'X', '1', '0') ? sizeof(header) + 20 : sizeof(header);
+	uint32_t mipLevels = static_cast<uint32_t>(metadata.mipLevels);
+	texture.mMips.resize(mipLevels);
+	for (uint32_t mip = 0; mip < mipLevels; ++mip)
+	{
+		auto& mipData = texture.mMips[mip];
+		if (FAILED(ComputePitch(metadata.format, std::max(1u, width >> mip), std::max(1u, height >> mip), mipData.RowPitch, mipData.SlicePitch)))
+		{
+			return false;
+		}
+		mipData.Offset = offset;
+		mipData.State = StreamedTexture::MipState::Unloaded;
+		offset += mipData.SlicePitch;
+	}
+
+	if (offset != fileSize)
+	{
+		texture.mMips.clear();
+		return false;
+	}
+
+	uint32_t tailMip = 0;
+	while (tailMip + 1 < mipLevels && std::max(width >> tailMip, height >> tailMip) > mTailSize)
+	{
+		++tailMip;
+	}
+
+	texture.mDesc = CD3DX12_RESOURCE_DESC::Tex2D(metadata.format, width, height, 1, static_cast<UINT16>(mipLevels));
+	texture.mTailMip = tailMip;
+	texture.mTargetMip = tailMip;
+	return true;
+}
+
+std::vector<uint8_t> TextureStreamer::ReadMip(const StreamedTexture& texture, uint32_t mip) const
+{
+	const auto& mipData = texture.mMips[mip];
+	std::vector<uint8_t> data(mipData.SlicePitch);
+
+	std::ifstream file(texture.mFileName.c_str(), std::ios::binary);
+	file.seekg(mipData.Offset);
+	file.read(reinterpret_cast<char*>(data.data()), data.size());
+	if (!file)
+	{
+		throw std::exception("Failed to read texture mip.");
+	}
+	return data;
+}
+
+void TextureStreamer::ApplyResidency(CommandList& commandList, StreamedTexture& texture, uint32_t residentMip)
+{
+	uint32_t mipLevels = texture.GetMipLevels();
+	uint32_t oldResidentMip = texture.mResidentMip;
+
+	D3D12_RESOURCE_DESC desc = texture.mDesc;
+	desc.Width = std::max<UINT64>(1, desc.Width >> residentMip);
+	desc.Height = std::max(1u, desc.Height >> residentMip);
+	desc.MipLevels = static_cast<UINT16>(mipLevels - residentMip);
+
+	Texture residentTexture(desc, nullptr, texture.mTexture.GetTextureUsage(), texture.mName);
+
+	uint32_t uploadEnd = std::min(oldResidentMip, mipLevels);
+	std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+	for (uint32_t mip = residentMip; mip < uploadEnd; ++mip)
+	{
+		const auto& mipData = texture.mMips[mip];
+
+		D3D12_SUBRESOURCE_DATA subresource;
+		subresource.pData = mipData.Data.data();
+		subresource.RowPitch = static_cast<LONG_PTR>(mipData.RowPitch);
+		subresource.SlicePitch = static_cast<LONG_PTR>(mipData.SlicePitch);
+		subresources.push_back(subresource);
+	}
+
+	if (!subresources.empty())
+	{
+		commandList.CopyTextureSubresource(residentTexture, 0, static_cast<uint32_t>(subresources.size()), subresources.data());
+	}
+
+	for (uint32_t mip = std::max(residentMip, oldResidentMip); mip < mipLevels; ++mip)
+	{
+		commandList.CopyTextureRegion(residentTexture, mip - residentMip, texture.mTexture, mip - oldResidentMip);
+	}
+
+	for (uint32_t mip = residentMip; mip < uploadEnd; ++mip)
+	{
+		auto& mipData = texture.mMips[mip];
+		mipData.Data = std::vector<uint8_t>();
+		mipData.State = StreamedTexture::MipState::Unloaded;
+	}
+
+	texture.mTexture = residentTexture;
+	texture.mResidentMip = residentMip;
+}
+
+uint64_t TextureStreamer::GetResidentBytes(const StreamedTexture& texture, uint32_t firstMip) const
+{
+	uint64_t bytes = 0;
+	for (uint32_t mip = firstMip; mip < texture.GetMipLevels(); ++mip)
+	{
+		bytes += texture.mMips[mip].SlicePitch;
+	}
+	return bytes;
+}
+
+void TextureStreamer::IOThread()
+{
+	std::unique_lock<std::mutex> lock(mIOMutex);
+	while (true)
+	{
+		mIOCV.wait(lock, [this] { return !mbRunning || !mIORequests.empty(); });
+		if (!mbRunning)
+		{
+			return;
+		}
+
+		IORequest request = mIORequests.front();
+		mIORequests.pop_front();
+		auto& mipData = request.Texture->mMips[request.Mip];
+		mInFlightBytes = mipData.SlicePitch;
+		lock.unlock();
+
+		std::vector<uint8_t> data;
+		bool succeeded = true;
+		try
+		{
+			data = ReadMip(*request.Texture, request.Mip);
+		}
+		catch (...)
+		{
+			succeeded = false;
+		}
+
+		lock.lock();
+		mInFlightBytes = 0;
+		if (succeeded)
+		{
+			mipData.Data = std::move(data);
+			mipData.State = StreamedTexture::MipState::Loaded;
+		}
+	}
+}
@@ -0,0 +1,131 @@
+#ifndef __TEXTURESTREAMER_H_
+#define __TEXTURESTREAMER_H_
+
+#include "Core.h"
+#include "Texture.h"
+
+#include <deque>
+
+class CommandList;
+
+class StreamedTexture
+{
+public:
+	const Texture& GetTexture() const
+	{
+		return mTexture;
+	}
+
+	uint32_t GetMipLevels() const
+	{
+		return static_cast<uint32_t>(mMips.size());
+	}
+
+	uint32_t GetResidentMip() const
+	{
+		return mResidentMip;
+	}
+
+	uint32_t GetTargetMip() const
+	{
+		return mTargetMip;
+	}
+
+	bool IsStreamable() const
+	{
+		return mbStreamable;
+	}
+
+private:
+	friend class TextureStreamer;
+
+	enum class MipState : uint8_t
+	{
+		Unloaded,
+		Queued,
+		Loaded,
+	};
+
+	struct Mip
+	{
+		uint64_t Offset;
+		size_t RowPitch;
+		size_t SlicePitch;
+		MipState State;
+		std::vector<uint8_t> Data;
+	};
+
+	std::wstring mName;
+	std::wstring mFileName;
+	D3D12_RESOURCE_DESC mDesc;
+	std::vector<Mip> mMips;
+	Texture mTexture;
+	uint32_t mResidentMip;
+	uint32_t mTailMip;
+	uint32_t mTargetMip;
+	float mScreenSize;
+	uint64_t mFixedBytes;
+	bool mbStreamable;
+};
+
+class TextureStreamer
+{
+public:
+	struct Statistics
+	{
+		uint32_t TextureNum;
+		uint32_t ResidentMips;
+		uint32_t TotalMips;
+		uint64_t ResidentBytes;
+		uint64_t PendingBytes;
+		uint64_t BudgetBytes;
+		uint32_t PendingRequests;
+	};
+
+	TextureStreamer(const std::wstring& cookDirectory, uint64_t budgetBytes, uint32_t tailSize = 64);
+	virtual ~TextureStreamer();
+
+	StreamedTexture* LoadTexture(CommandList& commandList, const std::wstring& fileName, TextureUsage textureUsage = TextureUsage::Albedo);
+
+	void RequestScreenSize(StreamedTexture* texture, float screenSize);
+	void Update(CommandList& commandList);
+
+	void SetBudget(uint64_t budgetBytes);
+	uint64_t GetBudget() const;
+
+	Statistics GetStatistics() const;
+
+	static float XM_CALLCONV ComputeScreenSize(FXMVECTOR center, float radius, CXMMATRIX viewMatrix, CXMMATRIX projectionMatrix, float viewportHeight);
+
+private:
+	TextureStreamer(const TextureStreamer& copy) = delete;
+	TextureStreamer& operator=(const TextureStreamer& other) = delete;
+
+	struct IORequest
+	{
+		StreamedTexture* Texture;
+		uint32_t Mip;
+	};
+
+	std::wstring CookTexture(const std::wstring& fileName) const;
+	bool ParseLayout(StreamedTexture& texture) const;
+	std::vector<uint8_t> ReadMip(const StreamedTexture& texture, uint32_t mip) const;
+	void ApplyResidency(CommandList& commandList, StreamedTexture& texture, uint32_t residentMip);
+	uint64_t GetResidentBytes(const StreamedTexture& texture, uint32_t firstMip) const;
+	void IOThread();
+
+	fs::path mCookDirectory;
+	uint32_t mTailSize;
+	std::atomic_uint64_t mBudgetBytes;
+
+	std::vector<std::unique_ptr<StreamedTexture>> mTextures;
+
+	std::deque<IORequest> mIORequests;
+	uint64_t mInFlightBytes;
+	mutable std::mutex mIOMutex;
+	std::condition_variable mIOCV;
+	std::thread mIOThread;
+	bool mbRunning;
+};
+
+#endif
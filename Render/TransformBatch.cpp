@@ -0,0 +1,227 @@
+#include "TransformBatch.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+TransformBatch::TransformBatch() : mViewType(TransformType::Rigid), mStatistics()
+{
+	XMStoreFloat4x4(&mView, XMMatrixIdentity());
+	XMStoreFloat4x4(&mViewProjection, XMMatrixIdentity());
+}
+
+TransformBatch::~TransformBatch() {}
+
+void TransformBatch::Clear()
+{
+	mModels.clear();
+	mTypes.clear();
+	mPrefixIndices.clear();
+	mPrefixes.clear();
+}
+
+void TransformBatch::Reserve(size_t objectNum)
+{
+	mModels.reserve(objectNum);
+	mTypes.reserve(objectNum);
+	mPrefixIndices.reserve(objectNum);
+}
+
+uint32_t XM_CALLCONV TransformBatch::AddPrefix(FXMMATRIX prefix)
+{
+	mPrefixes.emplace_back();
+	XMStoreFloat4x4(&mPrefixes.back(), prefix);
+	return static_cast<uint32_t>(mPrefixes.size() - 1);
+}
+
+uint32_t XM_CALLCONV TransformBatch::Add(FXMMATRIX model, uint32_t prefix)
+{
+	return Add(model, Classify(model), prefix);
+}
+
+uint32_t XM_CALLCONV TransformBatch::Add(FXMMATRIX model, TransformType type, uint32_t prefix)
+{
+	assert(prefix == NoPrefix || prefix < mPrefixes.size());
+
+	mModels.emplace_back();
+	XMStoreFloat4x4(&mModels.back(), model);
+	mTypes.push_back(type);
+	mPrefixIndices.push_back(prefix);
+	return static_cast<uint32_t>(mModels.size() - 1);
+}
+
+void XM_CALLCONV TransformBatch::SetViewProjection(FXMMATRIX view, CXMMATRIX viewProjection)
+{
+	XMStoreFloat4x4(&mView, view);
+	XMStoreFloat4x4(&mViewProjection, viewProjection);
+	mViewType = Classify(view);
+}
+
+void TransformBatch::Compute(void* destination, size_t stride)
+{
+	mSequence.resize(mModels.size());
+	for (uint32_t i = 0; i < mSequence.size(); ++i)
+	{
+		mSequence[i] = i;
+	}
+	Compute(mSequence.data(), mSequence.size(), destination, stride);
+}
+
+void TransformBatch::Compute(const uint32_t* objects, size_t count, void* destination, size_t stride)
+{
+	assert(stride >= OutputSize);
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	uint8_t* output = static_cast<uint8_t*>(destination);
+	size_t groupNum = (count + 3) / 4;
+	JobSystem::Get().ParallelFor(groupNum, JobObjectNum / 4, [&](size_t begin, size_t end)
+	{
+		for (size_t group = begin; group < end; ++group)
+		{
+			size_t first = group * 4;
+			ComputeGroup(objects + first, static_cast<uint32_t>(std::min<size_t>(4, count - first)), output + first * stride, stride);
+		}
+	});
+
+	uint32_t generalNum = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		generalNum += std::min(mTypes[objects[i]], mViewType) == TransformType::General ? 1 : 0;
+	}
+
+	mStatistics.ObjectNum = GetObjectCount();
+	mStatistics.ComputedNum = static_cast<uint32_t>(count);
+	mStatistics.GeneralNum = generalNum;
+	mStatistics.ComputeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+TransformBatch::TransformType XM_CALLCONV TransformBatch::Classify(FXMMATRIX matrix)
+{
+	const float tolerance = 1e-4f;
+
+	if (!XMVector4NearEqual(XMMatrixTranspose(matrix).r[3], g_XMIdentityR3, XMVectorReplicate(tolerance)))
+	{
+		return TransformType::General;
+	}
+
+	float lengthSq0 = XMVectorGetX(XMVector3LengthSq(matrix.r[0]));
+	float lengthSq1 = XMVectorGetX(XMVector3LengthSq(matrix.r[1]));
+	float lengthSq2 = XMVectorGetX(XMVector3LengthSq(matrix.r[2]));
+	float dot01 = XMVectorGetX(XMVector3Dot(matrix.r[0], matrix.r[1]));
+	float dot02 = XMVectorGetX(XMVector3Dot(matrix.r[0], matrix.r[2]));
+	float dot12 = XMVectorGetX(XMVector3Dot(matrix.r[1], matrix.r[2]));
+
+	float epsilon = tolerance * std::max({ lengthSq0, lengthSq1, lengthSq2 });
+	if (lengthSq0 <= 0.0f || std::abs(dot01) > epsilon || std::abs(dot02) > epsilon || std::abs(dot12) > epsilon ||
+		std::abs(lengthSq0 - lengthSq1) > epsilon || std::abs(lengthSq0 - lengthSq2) > epsilon)
+	{
+		return TransformType::General;
+	}
+
+	return std::abs(lengthSq0 - 1.0f) <= tolerance ? TransformType::Rigid : TransformType::UniformScale;
+}
+
+void TransformBatch::ComputeGroup(const uint32_t* objects, uint32_t laneNum, uint8_t* destination, size_t stride) const
+{
+	XMMATRIX view = XMLoadFloat4x4(&mView);
+	XMMATRIX viewProjection = XMLoadFloat4x4(&mViewProjection);
+
+	XMMATRIX modelViews[4];
+	uint32_t generalLanes[4];
+	bool anyGeneral = false;
+	bool allRigid = true;
+	for (uint32_t lane = 0; lane < 4; ++lane)
+	{
+		uint32_t object = objects[std::min(lane, laneNum - 1)];
+		modelViews[lane] = XMMatrixMultiply(XMLoadFloat4x4(&mModels[object]), view);
+
+		TransformType type = std::min(mTypes[object], mViewType);
+		generalLanes[lane] = type == TransformType::General ? 0xffffffff : 0;
+		anyGeneral |= type == TransformType::General;
+		allRigid &= type == TransformType::Rigid;
+	}
+
+	XMVECTOR a[3][3];
+	for (uint32_t row = 0; row < 3; ++row)
+	{
+		XMMATRIX lanes = XMMatrixTranspose(XMMATRIX(modelViews[0].r[row], modelViews[1].r[row], modelViews[2].r[row], modelViews[3].r[row]));
+		a[row][0] = lanes.r[0];
+		a[row][1] = lanes.r[1];
+		a[row][2] = lanes.r[2];
+	}
+	XMMATRIX translations = XMMatrixTranspose(XMMATRIX(modelViews[0].r[3], modelViews[1].r[3], modelViews[2].r[3], modelViews[3].r[3]));
+
+	XMVECTOR n[3][3];
+	if (allRigid)
+	{
+		memcpy(n, a, sizeof(n));
+	}
+	else
+	{
+		XMVECTOR inverseScaleSq = XMVectorReciprocal(XMVectorMultiplyAdd(a[0][0], a[0][0], XMVectorMultiplyAdd(a[0][1], a[0][1], XMVectorMultiply(a[0][2], a[0][2]))));
+		for (uint32_t row = 0; row < 3; ++row)
+		{
+			for (uint32_t column = 0; column < 3; ++column)
+			{
+				n[row][column] = XMVectorMultiply(a[row][column], inverseScaleSq);
+			}
+		}
+	}
+
+	if (anyGeneral)
+	{
+		XMVECTOR cofactors[3][3];
+		cofactors[0][0] = XMVectorNegativeMultiplySubtract(a[1][2], a[2][1], XMVectorMultiply(a[1][1], a[2][2]));
+		cofactors[0][1] = XMVectorNegativeMultiplySubtract(a[1][0], a[2][2], XMVectorMultiply(a[1][2], a[2][0]));
+		cofactors[0][2] = XMVectorNegativeMultiplySubtract(a[1][1], a[2][0], XMVectorMultiply(a[1][0], a[2][1]));
+		cofactors[1][0] = XMVectorNegativeMultiplySubtract(a[0][1], a[2][2], XMVectorMultiply(a[0][2], a[2][1]));
+		cofactors[1][1] = XMVectorNegativeMultiplySubtract(a[0][2], a[2][0], XMVectorMultiply(a[0][0], a[2][2]));
+		cofactors[1][2] = XMVectorNegativeMultiplySubtract(a[0][0], a[2][1], XMVectorMultiply(a[0][1], a[2][0]));
+		cofactors[2][0] = XMVectorNegativeMultiplySubtract(a[0][2], a[1][1], XMVectorMultiply(a[0][1], a[1][2]));
+		cofactors[2][1] = XMVectorNegativeMultiplySubtract(a[0][0], a[1][2], XMVectorMultiply(a[0][2], a[1][0]));
+		cofactors[2][2] = XMVectorNegativeMultiplySubtract(a[0][1], a[1][0], XMVectorMultiply(a[0][0], a[1][1]));
+
+		XMVECTOR determinant = XMVectorMultiplyAdd(a[0][0], cofactors[0][0], XMVectorMultiplyAdd(a[0][1], cofactors[0][1], XMVectorMultiply(a[0][2], cofactors[0][2])));
+		XMVECTOR inverseDeterminant = XMVectorReciprocal(determinant);
+		XMVECTOR generalMask = XMLoadInt4(generalLanes);
+
+		for (uint32_t row = 0; row < 3; ++row)
+		{
+			for (uint32_t column = 0; column < 3; ++column)
+			{
+				n[row][column] = XMVectorSelect(n[row][column], XMVectorMultiply(cofactors[row][column], inverseDeterminant), generalMask);
+			}
+		}
+	}
+
+	XMMATRIX normalRows[3];
+	for (uint32_t row = 0; row < 3; ++row)
+	{
+		XMVECTOR w = XMVectorNegate(XMVectorMultiplyAdd(n[row][0], translations.r[0], XMVectorMultiplyAdd(n[row][1], translations.r[1], XMVectorMultiply(n[row][2], translations.r[2]))));
+		normalRows[row] = XMMatrixTranspose(XMMATRIX(n[row][0], n[row][1], n[row][2], w));
+	}
+
+	for (uint32_t lane = 0; lane < laneNum; ++lane)
+	{
+		uint32_t object = objects[lane];
+		XMMATRIX model = XMLoadFloat4x4(&mModels[object]);
+		XMMATRIX modelView = modelViews[lane];
+		XMMATRIX modelViewProjection = XMMatrixMultiply(model, viewProjection);
+		XMMATRIX normalMatrix(normalRows[0].r[lane], normalRows[1].r[lane], normalRows[2].r[lane], g_XMIdentityR3);
+
+		uint32_t prefix = mPrefixIndices[object];
+		if (prefix != NoPrefix)
+		{
+			XMMATRIX prefixMatrix = XMLoadFloat4x4(&mPrefixes[prefix]);
+			model = XMMatrixMultiply(prefixMatrix, model);
+			modelView = XMMatrixMultiply(prefixMatrix, modelView);
+			modelViewProjection = XMMatrixMultiply(prefixMatrix, modelViewProjection);
+		}
+
+		XMFLOAT4X4* output = reinterpret_cast<XMFLOAT4X4*>(destination + lane * stride);
+		XMStoreFloat4x4(&output[0], model);
+		XMStoreFloat4x4(&output[1], modelView);
+		XMStoreFloat4x4(&output[2], normalMatrix);
+		XMStoreFloat4x4(&output[3], modelViewProjection);
+	}
+}
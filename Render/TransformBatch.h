@@ -0,0 +1,77 @@
+#ifndef __TRANSFORMBATCH_H_
+#define __TRANSFORMBATCH_H_
+
+#include "Core.h"
+
+class TransformBatch
+{
+public:
+	enum class TransformType : uint8_t
+	{
+		General,
+		UniformScale,
+		Rigid,
+	};
+
+	struct Statistics
+	{
+		uint32_t ObjectNum;
+		uint32_t ComputedNum;
+		uint32_t GeneralNum;
+		double ComputeMilliseconds;
+	};
+
+	static const uint32_t NoPrefix = ~0u;
+	static const size_t JobObjectNum = 1024;
+	static const size_t OutputSize = sizeof(DirectX::XMFLOAT4X4) * 4;
+
+	TransformBatch();
+	virtual ~TransformBatch();
+
+	void Clear();
+	void Reserve(size_t objectNum);
+	uint32_t XM_CALLCONV AddPrefix(DirectX::FXMMATRIX prefix);
+	uint32_t XM_CALLCONV Add(DirectX::FXMMATRIX model, uint32_t prefix = NoPrefix);
+	uint32_t XM_CALLCONV Add(DirectX::FXMMATRIX model, TransformType type, uint32_t prefix = NoPrefix);
+	void XM_CALLCONV SetViewProjection(DirectX::FXMMATRIX view, DirectX::CXMMATRIX viewProjection);
+
+	uint32_t GetObjectCount() const
+	{
+		return static_cast<uint32_t>(mModels.size());
+	}
+
+	DirectX::XMMATRIX GetModelMatrix(uint32_t object) const
+	{
+		return DirectX::XMLoadFloat4x4(&mModels[object]);
+	}
+
+	void Compute(void* destination, size_t stride);
+	void Compute(const uint32_t* objects, size_t count, void* destination, size_t stride);
+
+	Statistics GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	static TransformType XM_CALLCONV Classify(DirectX::FXMMATRIX matrix);
+
+private:
+	TransformBatch(const TransformBatch& copy) = delete;
+	TransformBatch& operator=(const TransformBatch& other) = delete;
+
+	void ComputeGroup(const uint32_t* objects, uint32_t laneNum, uint8_t* destination, size_t stride) const;
+
+	std::vector<DirectX::XMFLOAT4X4> mModels;
+	std::vector<TransformType> mTypes;
+	std::vector<uint32_t> mPrefixIndices;
+	std::vector<DirectX::XMFLOAT4X4> mPrefixes;
+	std::vector<uint32_t> mSequence;
+
+	DirectX::XMFLOAT4X4 mView;
+	DirectX::XMFLOAT4X4 mViewProjection;
+	TransformType mViewType;
+
+	Statistics mStatistics;
+};
+
+#endif
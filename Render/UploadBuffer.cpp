@@ -8,9 +8,9 @@ UploadBuffer::~UploadBuffer() {}
 
 UploadBuffer::BasePointer UploadBuffer::Allocate(size_t allocateSize, size_t alignment)
 {
-	if (allocateSize > mBlockSize)
+	if (Math::AlignUp(allocateSize, alignment) > mBlockSize)
 	{
-		throw std::bad_alloc();
+		return MakeLargeBlock(allocateSize, alignment)->Allocate(allocateSize, alignment);
 	}
 
 	if (!mUsingBlock || !mUsingBlock->HasSpace(allocateSize, alignment))
@@ -36,6 +36,29 @@ std::shared_ptr<UploadBuffer::Block> UploadBuffer::MakeBlock()
 	return block;
 }
 
+// Allocations bigger than a page get a dedicated block rounded up to whole pages,
+// kept across Reset and reused by later allocations that fit in it.
+std::shared_ptr<UploadBuffer::Block> UploadBuffer::MakeLargeBlock(size_t allocateSize, size_t alignment)
+{
+	auto fits = std::find_if(mFreeLargeBlockPool.begin(), mFreeLargeBlockPool.end(), [=](const std::shared_ptr<Block>& block)
+	{
+		return block->HasSpace(allocateSize, alignment);
+	});
+
+	std::shared_ptr<Block> block;
+	if (fits != mFreeLargeBlockPool.end())
+	{
+		block = *fits;
+		mFreeLargeBlockPool.erase(fits);
+	}
+	else
+	{
+		block = std::make_shared<Block>(Math::AlignUp(Math::AlignUp(allocateSize, alignment), mBlockSize));
+		mLargeBlockPool.push_back(block);
+	}
+	return block;
+}
+
 void UploadBuffer::Reset()
 {
 	mUsingBlock = nullptr;
@@ -44,12 +67,24 @@ void UploadBuffer::Reset()
 	{
 		block->Reset();
 	}
+
+	mFreeLargeBlockPool = mLargeBlockPool;
+	std::sort(mFreeLargeBlockPool.begin(), mFreeLargeBlockPool.end(), [](const std::shared_ptr<Block>& a, const std::shared_ptr<Block>& b)
+	{
+		return a->GetSize() < b->GetSize();
+	});
+	for (auto block : mFreeLargeBlockPool)
+	{
+		block->Reset();
+	}
 }
 
 UploadBuffer::Block::Block(size_t size) : mBlockSize(size), mOffset(0), mCPUBasePointer(nullptr), mGPUBasePointer(D3D12_GPU_VIRTUAL_ADDRESS(0))
 {
 	auto device = Application::Get().GetDevice();
-	ThrowIfFailed(device->CreateCommittedResource(&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(mBlockSize),
+	CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(mBlockSize);
+	ThrowIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
 												  D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mResource)));
 	mGPUBasePointer = mResource->GetGPUVirtualAddress();
 	mResource->Map(0, nullptr, &mCPUBasePointer);
@@ -83,6 +118,8 @@ UploadBuffer::BasePointer UploadBuffer::Block::Allocate(size_t allocateSize, siz
 	BasePointer allocateBlockPointer;
 	allocateBlockPointer.CPUAddress = static_cast<uint8_t*>(mCPUBasePointer) + mOffset;
 	allocateBlockPointer.GPUAddress = mGPUBasePointer + mOffset;
+	allocateBlockPointer.Resource = mResource.Get();
+	allocateBlockPointer.Offset = mOffset;
 	mOffset += alignedSize;
 	return allocateBlockPointer;
 }
@@ -12,6 +12,8 @@ public:
 	{
 		void* CPUAddress;
 		D3D12_GPU_VIRTUAL_ADDRESS GPUAddress;
+		ID3D12Resource* Resource;
+		size_t Offset;
 	};
 
 	explicit UploadBuffer(size_t blockSize = _2MB);
@@ -26,6 +28,7 @@ private:
 	{
 		Block(size_t size);
 		~Block();
+		size_t GetSize() const { return mBlockSize; }
 		bool HasSpace(size_t blockSize, size_t alignment) const;
 		BasePointer Allocate(size_t allocateSize, size_t alignment);
 		void Reset();
@@ -42,8 +45,11 @@ private:
 
 	using BlockPool = std::deque<std::shared_ptr<Block>>;
 	std::shared_ptr<Block> MakeBlock();
+	std::shared_ptr<Block> MakeLargeBlock(size_t allocateSize, size_t alignment);
 	BlockPool mBlockPool;
 	BlockPool mFreeBlockPool;
+	BlockPool mLargeBlockPool;
+	BlockPool mFreeLargeBlockPool;
 	std::shared_ptr<Block> mUsingBlock;
 
 	size_t mBlockSize;
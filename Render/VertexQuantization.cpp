@@ -0,0 +1,193 @@
+#include "VertexQuantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	const float SnormScale = 32767.0f;
+
+	int16_t FloatToSnorm(float value)
+	{
+		return static_cast<int16_t>(std::round(std::max(-1.0f, std::min(1.0f, value)) * SnormScale));
+	}
+
+	float SnormToFloat(int16_t value)
+	{
+		return std::max(-1.0f, value / SnormScale);
+	}
+
+	float SignNotZero(float value)
+	{
+		return value >= 0.0f ? 1.0f : -1.0f;
+	}
+}
+
+QuantizationBounds VertexQuantization::ComputeBounds(const float* positions, size_t vertexNum, size_t positionStride)
+{
+	QuantizationBounds bounds = { DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f) };
+	if (vertexNum == 0) return bounds;
+
+	float minimum[3] = { positions[0], positions[1], positions[2] };
+	float maximum[3] = { positions[0], positions[1], positions[2] };
+
+	for (size_t i = 1; i < vertexNum; ++i)
+	{
+		const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + i * positionStride);
+		for (int k = 0; k < 3; ++k)
+		{
+			minimum[k] = std::min(minimum[k], p[k]);
+			maximum[k] = std::max(maximum[k], p[k]);
+		}
+	}
+
+	bounds.Center = DirectX::XMFLOAT3((minimum[0] + maximum[0]) * 0.5f, (minimum[1] + maximum[1]) * 0.5f, (minimum[2] + maximum[2]) * 0.5f);
+	bounds.Extent = DirectX::XMFLOAT3(
+		std::max((maximum[0] - minimum[0]) * 0.5f, 1e-6f),
+		std::max((maximum[1] - minimum[1]) * 0.5f, 1e-6f),
+		std::max((maximum[2] - minimum[2]) * 0.5f, 1e-6f));
+
+	return bounds;
+}
+
+void VertexQuantization::EncodePosition(const float position[3], const QuantizationBounds& bounds, int16_t encoded[4])
+{
+	encoded[0] = FloatToSnorm((position[0] - bounds.Center.x) / bounds.Extent.x);
+	encoded[1] = FloatToSnorm((position[1] - bounds.Center.y) / bounds.Extent.y);
+	encoded[2] = FloatToSnorm((position[2] - bounds.Center.z) / bounds.Extent.z);
+	encoded[3] = static_cast<int16_t>(SnormScale);
+}
+
+void VertexQuantization::DecodePosition(const int16_t encoded[4], const QuantizationBounds& bounds, float position[3])
+{
+	position[0] = SnormToFloat(encoded[0]) * bounds.Extent.x + bounds.Center.x;
+	position[1] = SnormToFloat(encoded[1]) * bounds.Extent.y + bounds.Center.y;
+	position[2] = SnormToFloat(encoded[2]) * bounds.Extent.z + bounds.Center.z;
+}
+
+float VertexQuantization::GetMaxPositionError(const QuantizationBounds& bounds)
+{
+	return std::max(bounds.Extent.x, std::max(bounds.Extent.y, bounds.Extent.z)) / SnormScale;
+}
+
+void VertexQuantization::EncodeOctahedral(const float normal[3], int16_t encoded[2])
+{
+	float length = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+	if (length <= 0.0f)
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	float x = normal[0] / length;
+	float y = normal[1] / length;
+	if (normal[2] < 0.0f)
+	{
+		float foldedX = (1.0f - std::abs(y)) * SignNotZero(x);
+		float foldedY = (1.0f - std::abs(x)) * SignNotZero(y);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	encoded[0] = FloatToSnorm(x);
+	encoded[1] = FloatToSnorm(y);
+}
+
+void VertexQuantization::DecodeOctahedral(const int16_t encoded[2], float normal[3])
+{
+	float x = SnormToFloat(encoded[0]);
+	float y = SnormToFloat(encoded[1]);
+	float z = 1.0f - std::abs(x) - std::abs(y);
+	if (z < 0.0f)
+	{
+		float foldedX = (1.0f - std::abs(y)) * SignNotZero(x);
+		float foldedY = (1.0f - std::abs(x)) * SignNotZero(y);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	float length = std::sqrt(x * x + y * y + z * z);
+	normal[0] = x / length;
+	normal[1] = y / length;
+	normal[2] = z / length;
+}
+
+uint16_t VertexQuantization::FloatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t magnitude = bits & 0x7fffffff;
+
+	if (magnitude >= 0x7f800000)
+	{
+		return static_cast<uint16_t>(sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0));
+	}
+	if (magnitude >= 0x477ff000)
+	{
+		return static_cast<uint16_t>(sign | 0x7c00);
+	}
+	if (magnitude < 0x38800000)
+	{
+		if (magnitude < 0x33000000)
+		{
+			return static_cast<uint16_t>(sign);
+		}
+		uint32_t shift = 113 - (magnitude >> 23);
+		uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+		uint32_t half = mantissa >> (shift + 13);
+		uint32_t remainder = mantissa & ((1u << (shift + 13)) - 1);
+		uint32_t halfway = 1u << (shift + 12);
+		if (remainder > halfway || (remainder == halfway && (half & 1)))
+		{
+			++half;
+		}
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	uint32_t half = (magnitude - 0x38000000) >> 13;
+	uint32_t remainder = magnitude & 0x1fff;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+	{
+		++half;
+	}
+	return static_cast<uint16_t>(sign | half);
+}
+
+float VertexQuantization::HalfToFloat(uint16_t value)
+{
+	uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1f;
+	uint32_t mantissa = value & 0x3ff;
+
+	uint32_t bits;
+	if (exponent == 0x1f)
+	{
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else if (exponent != 0)
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else if (mantissa != 0)
+	{
+		exponent = 113;
+		while ((mantissa & 0x400) == 0)
+		{
+			mantissa <<= 1;
+			--exponent;
+		}
+		bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+	}
+	else
+	{
+		bits = sign;
+	}
+
+	float result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
@@ -0,0 +1,30 @@
+#ifndef __VERTEXQUANTIZATION_H_
+#define __VERTEXQUANTIZATION_H_
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+
+struct QuantizationBounds
+{
+	DirectX::XMFLOAT3 Center;
+	DirectX::XMFLOAT3 Extent;
+};
+
+namespace VertexQuantization
+{
+	QuantizationBounds ComputeBounds(const float* positions, size_t vertexNum, size_t positionStride);
+
+	void EncodePosition(const float position[3], const QuantizationBounds& bounds, int16_t encoded[4]);
+	void DecodePosition(const int16_t encoded[4], const QuantizationBounds& bounds, float position[3]);
+	float GetMaxPositionError(const QuantizationBounds& bounds);
+
+	void EncodeOctahedral(const float normal[3], int16_t encoded[2]);
+	void DecodeOctahedral(const int16_t encoded[2], float normal[3]);
+
+	uint16_t FloatToHalf(float value);
+	float HalfToFloat(uint16_t value);
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include "CommandQueue.h"
 #include "CommandList.h"
 #include "Game.h"
+#include "GeometryArena.h"
 #include "GUI.h"
 #include "RenderTarget.h"
 #include "ResourceStateTracker.h"
@@ -343,6 +344,7 @@ UINT Window::Present(const Texture& texture)
 	mCurrentBackBufferIndex = mDxgiSwapChain->GetCurrentBackBufferIndex();
 	commandQueue->WaitForFenceValue(mFenceValues[mCurrentBackBufferIndex]);
 	Application::Get().ReleaseTheUsedDescriptors(mFrameValues[mCurrentBackBufferIndex]);
+	Application::Get().GetGeometryArena().ReleaseFreedAllocations(mFrameValues[mCurrentBackBufferIndex]);
 
 	return mCurrentBackBufferIndex;
 }
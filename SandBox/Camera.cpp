@@ -91,6 +91,21 @@ float Camera::GetFoV() const
     return mvFoV;
 }
 
+float Camera::GetAspectRatio() const
+{
+    return mAspectRatio;
+}
+
+float Camera::GetNearClip() const
+{
+    return mzNear;
+}
+
+float Camera::GetFarClip() const
+{
+    return mzFar;
+}
+
 
 void XM_CALLCONV Camera::SetTranslation( FXMVECTOR translation )
 {
@@ -25,6 +25,9 @@ public:
     DirectX::XMMATRIX GetInverseProjectionMatrix() const;
     void SetFoV(float fovy);
     float GetFoV() const;
+    float GetAspectRatio() const;
+    float GetNearClip() const;
+    float GetFarClip() const;
     void XM_CALLCONV SetTranslation( DirectX::FXMVECTOR translation );
     DirectX::XMVECTOR GetTranslation() const;
     void XM_CALLCONV SetRotation( DirectX::FXMVECTOR rotation );
@@ -6,8 +6,8 @@
 struct Material
 {
     Material(DirectX::XMFLOAT4 emissive = { 0.0f, 0.0f, 0.0f, 1.0f }, DirectX::XMFLOAT4 ambient = { 0.1f, 0.1f, 0.1f, 1.0f }, DirectX::XMFLOAT4 diffuse = { 1.0f, 1.0f, 1.0f, 1.0f },
-             DirectX::XMFLOAT4 specular = { 1.0f, 1.0f, 1.0f, 1.0f }, float specularPower = 128.0f)
-        : Emissive( emissive ), Ambient( ambient ), Diffuse( diffuse ), Specular( specular ), SpecularPower( specularPower ) {}
+             DirectX::XMFLOAT4 specular = { 1.0f, 1.0f, 1.0f, 1.0f }, float specularPower = 128.0f, DirectX::XMFLOAT4 textureScaleOffset = { 1.0f, 1.0f, 0.0f, 0.0f })
+        : Emissive( emissive ), Ambient( ambient ), Diffuse( diffuse ), Specular( specular ), SpecularPower( specularPower ), TextureScaleOffset( textureScaleOffset ) {}
 
     DirectX::XMFLOAT4 Emissive;
     DirectX::XMFLOAT4 Ambient;
@@ -15,6 +15,7 @@ struct Material
     DirectX::XMFLOAT4 Specular;
     float SpecularPower;
     uint32_t Padding[3];
+    DirectX::XMFLOAT4 TextureScaleOffset;
     
     static const Material Red;
     static const Material Green;
@@ -3,6 +3,8 @@
 #include "../Render/application.h"
 #include "../Render/commandQueue.h"
 #include "../Render/CommandList.h"
+#include "../Render/ComputePipelineLibrary.h"
+#include "../Render/GeometryArena.h"
 #include "../Render/Helpers.h"
 #include "Light.h"
 #include "Material.h"
@@ -37,8 +39,12 @@ struct Mat
 
 struct LightProperties
 {
-    uint32_t NumPointLights;
-    uint32_t NumSpotLights;
+    uint32_t ClusterCountX;
+    uint32_t ClusterCountY;
+    uint32_t ClusterCountZ;
+    float ClusterDepthScale;
+    float ClusterDepthBias;
+    XMFLOAT2 InverseScreenSize;
 };
 
 enum TonemapMethod : uint32_t
@@ -70,14 +76,33 @@ struct TonemapParameters
 
 TonemapParameters gTonemapParameters;
 
+struct EnvironmentLighting
+{
+    XMFLOAT4 Irradiance[IrradianceSH::CoefficientNum];
+    XMMATRIX InverseViewMatrix;
+    float SpecularMipLevels;
+    float Intensity;
+    float Padding[2];
+};
+
+float gEnvironmentIntensity = 0.3f;
+bool gIndirectDraws = false;
+bool gGPUCulling = false;
+bool gBVHCulling = true;
+
 enum RootParameters
 {
-    MatricesCB,        
-    MaterialCB,        
+    DrawConstants,
+    ObjectData,
+    MaterialData,
     LightPropertiesCB, 
     PointLights,       
     SpotLights,        
+    LightClusters,
+    LightIndices,
     Textures,          
+    EnvironmentCB,
+    EnvironmentMap,
     NumRootParameters
 };
 
@@ -108,7 +133,7 @@ XMMATRIX XM_CALLCONV LookAtMatrix(FXMVECTOR Position, FXMVECTOR Direction, FXMVE
 
 Renderer::Renderer(const std::wstring& name, int width, int height, bool vSync)
     : super(name, width, height, vSync), mScissorRect(CD3DX12_RECT(0, 0, LONG_MAX, LONG_MAX)), mForward(0), mBackward(0), mLeft(0), mRight(0), mUp(0), mDown(0), mPitch(0)
-    , mYaw(0), mAnimateLights(false), mShift(false), mWidth(0), mHeight(0), mRenderScale(1.0f)
+    , mYaw(0), mAnimateLights(false), mShift(false), mWidth(0), mHeight(0), mRenderScale(1.0f), mHDRFormat(DXGI_FORMAT_R16G16B16A16_FLOAT), mDepthBufferFormat(DXGI_FORMAT_D32_FLOAT), mHDRSize(1, 1), mCulledMeshlets(0), mSphereLod(0), mPickedObject(-1)
 {
 
     XMVECTOR cameraPos = XMVectorSet(0, 5, -20, 1);
@@ -133,57 +158,66 @@ Renderer::~Renderer()
 bool Renderer::LoadContent()
 {
     auto device = Application::Get().GetDevice();
+    Application::Get().GetComputePipelineLibrary().Prewarm();
+
     auto commandQueue = Application::Get().GetCommandQueue(D3D12_COMMAND_LIST_TYPE_COPY);
     auto commandList = commandQueue->GetCommandList();
 
-    mCubeMesh = Mesh::CreateCube(*commandList);
-    mSphereMesh = Mesh::CreateSphere(*commandList);
-    mConeMesh = Mesh::CreateCone(*commandList);
-    mTorusMesh = Mesh::CreateTorus(*commandList);
-    mPlaneMesh = Mesh::CreatePlane(*commandList);
-    mSkyboxMesh = Mesh::CreateCube(*commandList, 1.0f, true);
-
-    commandList->LoadTextureFromFile(mDefaultTexture, L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\DefaultWhite.bmp");
-    commandList->LoadTextureFromFile(mDirectXTexture, L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\Marble014_2K_Color.jpg");
-    commandList->LoadTextureFromFile(mSphereTexture, L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\grassCube1024.dds");
-    commandList->LoadTextureFromFile(mCubeTexture, L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\Cover.jpg");
-    commandList->LoadTextureFromFile(mSkyboxTexture, L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\kloppenheim_07.jpg");
-
-    auto cubemapDesc = mSkyboxTexture.GetD3D12ResourceDesc();
-    cubemapDesc.Width = cubemapDesc.Height = 1024;
-    cubemapDesc.DepthOrArraySize = 6;
-    cubemapDesc.MipLevels = 0;
-
-    mSkyboxCubemap = Texture(cubemapDesc, nullptr, TextureUsage::Albedo, L"SkyboxCubemap");
-
-    commandList->PanoToCubemap(mSkyboxCubemap, mSkyboxTexture);
-
-    DXGI_FORMAT HDRFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
-    DXGI_FORMAT depthBufferFormat = DXGI_FORMAT_D32_FLOAT;
-
-    auto colorDesc = CD3DX12_RESOURCE_DESC::Tex2D(HDRFormat, mWidth, mHeight);
-    colorDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
-
-    D3D12_CLEAR_VALUE colorClearValue;
-    colorClearValue.Format = colorDesc.Format;
-    colorClearValue.Color[0] = 0.4f;
-    colorClearValue.Color[1] = 0.6f;
-    colorClearValue.Color[2] = 0.9f;
-    colorClearValue.Color[3] = 1.0f;
-
-    Texture HDRTexture = Texture(colorDesc, &colorClearValue, TextureUsage::RenderTarget, L"HDR Texture");
+    mMeshCache = std::make_unique<MeshCache>(L"D:\\Files\\Code\\C++\\RTRender\\Cache\\Meshes");
+    mCubeMesh = mMeshCache->GetCube(*commandList);
+    mSphereMesh = mMeshCache->GetSphere(*commandList);
+    mConeMesh = mMeshCache->GetCone(*commandList);
+    mTorusMesh = mMeshCache->GetTorus(*commandList, 1.0f, 0.333f, 32, false, VertexFormat::Quantized);
+    mPlaneMesh = mMeshCache->GetPlane(*commandList);
+    mSkyboxMesh = mMeshCache->GetCube(*commandList, 1.0f, true);
+
+    mTextureAtlas = std::make_unique<TextureAtlas>();
+    mTextureAtlas->Add(L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\DefaultWhite.bmp");
+    mTextureAtlas->Build(*commandList);
+    mDefaultTextureRegion = mTextureAtlas->GetRegion(L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\DefaultWhite.bmp");
+
+    mTextureStreamer = std::make_unique<TextureStreamer>(L"D:\\Files\\Code\\C++\\RTRender\\Cache\\Textures", 64ull * 1024 * 1024);
+    mDirectXTexture = mTextureStreamer->LoadTexture(*commandList, L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\Marble014_2K_Color.jpg");
+    mSphereTexture = mTextureStreamer->LoadTexture(*commandList, L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\grassCube1024.dds");
+    mCubeTexture = mTextureStreamer->LoadTexture(*commandList, L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\Cover.jpg");
+
+    mCubemapCache = std::make_unique<CubemapCache>(L"D:\\Files\\Code\\C++\\RTRender\\Cache\\Cubemaps");
+    mCubemapCache->LoadCubemap(*commandList, mSkyboxCubemap, L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\kloppenheim_07.jpg", 1024, CubemapFormat::RGBA8_UNORM);
+    mCubemapCache->LoadEnvironmentLighting(*commandList, mSpecularCubemap, mIrradianceSH, L"D:\\Files\\Code\\C++\\RTRender\\Assets\\Textures\\kloppenheim_07.jpg", 1024, CubemapFormat::RGBA8_UNORM, 128, 6);
+
+    mRenderGraph = std::make_unique<RenderGraph>();
+    mRenderQueue = std::make_unique<RenderQueue>();
+    mFrustumCuller = std::make_unique<FrustumCuller>();
+    mSceneBVH = std::make_unique<BVH>();
+    mTransformBatch = std::make_unique<TransformBatch>();
+    mClusteredLighting = std::make_unique<ClusteredLighting>();
+
+    mScene = std::make_unique<Scene>();
+    mSphereEntity = mScene->CreateEntity(XMVectorSet(-4.0f, 2.0f, -4.0f, 1.0f), XMQuaternionIdentity(), XMVectorReplicate(4.0f));
+    mCubeEntity = mScene->CreateEntity(XMVectorSet(4.0f, 4.0f, 4.0f, 1.0f), XMQuaternionRotationRollPitchYaw(0.0f, XMConvertToRadians(45.0f), 0.0f), XMVectorSet(4.0f, 8.0f, 4.0f, 0.0f));
+    mTorusEntity = mScene->CreateEntity(XMVectorSet(4.0f, 0.6f, -4.0f, 1.0f), XMQuaternionRotationRollPitchYaw(0.0f, XMConvertToRadians(45.0f), 0.0f), XMVectorReplicate(4.0f));
 
-    auto depthDesc = CD3DX12_RESOURCE_DESC::Tex2D(depthBufferFormat, mWidth, mHeight);
-    depthDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
-
-    D3D12_CLEAR_VALUE depthClearValue;
-    depthClearValue.Format = depthDesc.Format;
-    depthClearValue.DepthStencil = { 1.0f, 0 };
+    {
+        float scalePlane = 20.0f;
+        float translateOffset = scalePlane / 2.0f;
+        XMVECTOR wallScale = XMVectorSet(scalePlane, 1.0f, scalePlane, 0.0f);
+
+        mRoomEntity = mScene->CreateEntity();
+        mWallEntities = {
+            mScene->CreateEntity(XMVectorZero(), XMQuaternionIdentity(), wallScale, mRoomEntity),
+            mScene->CreateEntity(XMVectorSet(0.0f, translateOffset, translateOffset, 1.0f), XMQuaternionRotationRollPitchYaw(XMConvertToRadians(-90.0f), 0.0f, 0.0f), wallScale, mRoomEntity),
+            mScene->CreateEntity(XMVectorSet(0.0f, translateOffset * 2.0f, 0.0f, 1.0f), XMQuaternionRotationRollPitchYaw(XMConvertToRadians(180.0f), 0.0f, 0.0f), wallScale, mRoomEntity),
+            mScene->CreateEntity(XMVectorSet(0.0f, translateOffset, -translateOffset, 1.0f), XMQuaternionRotationRollPitchYaw(XMConvertToRadians(90.0f), 0.0f, 0.0f), wallScale, mRoomEntity),
+            mScene->CreateEntity(XMVectorSet(-translateOffset, translateOffset, 0.0f, 1.0f), XMQuaternionRotationRollPitchYaw(XMConvertToRadians(-90.0f), XMConvertToRadians(-90.0f), 0.0f), wallScale, mRoomEntity),
+            mScene->CreateEntity(XMVectorSet(translateOffset, translateOffset, 0.0f, 1.0f), XMQuaternionRotationRollPitchYaw(XMConvertToRadians(-90.0f), XMConvertToRadians(90.0f), 0.0f), wallScale, mRoomEntity),
+        };
+    }
 
-    Texture depthTexture = Texture(depthDesc, &depthClearValue, TextureUsage::Depth, L"Depth Render Target");
+    RescaleHDRRenderTarget(mRenderScale);
 
-    mHDRRenderTarget.AttachTexture(AttachmentPoint::Color0, HDRTexture);
-    mHDRRenderTarget.AttachTexture(AttachmentPoint::DepthStencil, depthTexture);
+    D3D12_RT_FORMAT_ARRAY hdrRTVFormats = {};
+    hdrRTVFormats.NumRenderTargets = 1;
+    hdrRTVFormats.RTFormats[0] = mHDRFormat;
 
     D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData = {};
     featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
@@ -232,7 +266,7 @@ bool Renderer::LoadContent()
         skyboxPipelineStateStream.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
         skyboxPipelineStateStream.VS = CD3DX12_SHADER_BYTECODE(vs.Get());
         skyboxPipelineStateStream.PS = CD3DX12_SHADER_BYTECODE(ps.Get());
-        skyboxPipelineStateStream.RTVFormats = mHDRRenderTarget.GetRenderTargetFormats();
+        skyboxPipelineStateStream.RTVFormats = hdrRTVFormats;
 
         D3D12_PIPELINE_STATE_STREAM_DESC skyboxPipelineStateStreamDesc = {
             sizeof(SkyboxPipelineState), &skyboxPipelineStateStream
@@ -247,14 +281,20 @@ bool Renderer::LoadContent()
 														D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS | D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS;
 
         CD3DX12_DESCRIPTOR_RANGE1 descriptorRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 2);
+        CD3DX12_DESCRIPTOR_RANGE1 environmentRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 3);
 
         CD3DX12_ROOT_PARAMETER1 rootParameters[RootParameters::NumRootParameters];
-        rootParameters[RootParameters::MatricesCB].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_VERTEX);
-        rootParameters[RootParameters::MaterialCB].InitAsConstantBufferView(0, 1, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL);
+        rootParameters[RootParameters::DrawConstants].InitAsConstants(1, 0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+        rootParameters[RootParameters::ObjectData].InitAsShaderResourceView(0, 1, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_VERTEX);
+        rootParameters[RootParameters::MaterialData].InitAsShaderResourceView(1, 1, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL);
         rootParameters[RootParameters::LightPropertiesCB].InitAsConstants(sizeof(LightProperties) / 4, 1, 0, D3D12_SHADER_VISIBILITY_PIXEL);
         rootParameters[RootParameters::PointLights].InitAsShaderResourceView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL);
         rootParameters[RootParameters::SpotLights].InitAsShaderResourceView(1, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL);
+        rootParameters[RootParameters::LightClusters].InitAsShaderResourceView(4, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL);
+        rootParameters[RootParameters::LightIndices].InitAsShaderResourceView(5, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL);
         rootParameters[RootParameters::Textures].InitAsDescriptorTable(1, &descriptorRange, D3D12_SHADER_VISIBILITY_PIXEL);
+        rootParameters[RootParameters::EnvironmentCB].InitAsConstantBufferView(2, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL);
+        rootParameters[RootParameters::EnvironmentMap].InitAsDescriptorTable(1, &environmentRange, D3D12_SHADER_VISIBILITY_PIXEL);
 
         CD3DX12_STATIC_SAMPLER_DESC linearRepeatSampler(0, D3D12_FILTER_COMPARISON_MIN_MAG_MIP_LINEAR);
         CD3DX12_STATIC_SAMPLER_DESC anisotropicSampler(0, D3D12_FILTER_ANISOTROPIC);
@@ -263,6 +303,7 @@ bool Renderer::LoadContent()
         rootSignatureDescription.Init_1_1(RootParameters::NumRootParameters, rootParameters, 1, &linearRepeatSampler, rootSignatureFlags);
 
         mHDRRootSignature.SetRootSignatureDesc(rootSignatureDescription.Desc_1_1, featureData.HighestVersion);
+        mHDRCommandSignature = std::make_unique<CommandSignature>(mHDRRootSignature, RootParameters::DrawConstants);
 
         struct HDRPipelineStateStream
         {
@@ -280,13 +321,20 @@ bool Renderer::LoadContent()
         hdrPipelineStateStream.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
         hdrPipelineStateStream.VS = CD3DX12_SHADER_BYTECODE(vs.Get());
         hdrPipelineStateStream.PS = CD3DX12_SHADER_BYTECODE(ps.Get());
-        hdrPipelineStateStream.DSVFormat = mHDRRenderTarget.GetDepthStencilFormat();
-        hdrPipelineStateStream.RTVFormats = mHDRRenderTarget.GetRenderTargetFormats();
+        hdrPipelineStateStream.DSVFormat = mDepthBufferFormat;
+        hdrPipelineStateStream.RTVFormats = hdrRTVFormats;
 
         D3D12_PIPELINE_STATE_STREAM_DESC hdrPipelineStateStreamDesc = {
             sizeof(HDRPipelineStateStream), &hdrPipelineStateStream
         };
         ThrowIfFailed(device->CreatePipelineState(&hdrPipelineStateStreamDesc, IID_PPV_ARGS(&mHDRPipelineState)));
+
+        const D3D_SHADER_MACRO quantizedDefines[] = { { "QUANTIZED_VERTEX", "1" }, { nullptr, nullptr } };
+        ComPtr<ID3DBlob> quantizedVS = Utility::ShaderCompile(L"D:\\Files\\Code\\C++\\RTRender\\RTRender\\SandBox\\Shader\\HDR_VS.hlsl", quantizedDefines, "main", "vs_5_1");
+
+        hdrPipelineStateStream.InputLayout = { VertexPositionNormalTextureQuantized::InputElements, VertexPositionNormalTextureQuantized::InputElementCount };
+        hdrPipelineStateStream.VS = CD3DX12_SHADER_BYTECODE(quantizedVS.Get());
+        ThrowIfFailed(device->CreatePipelineState(&hdrPipelineStateStreamDesc, IID_PPV_ARGS(&mHDRQuantizedPipelineState)));
     }
     {
         CD3DX12_DESCRIPTOR_RANGE1 descriptorRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
@@ -345,7 +393,7 @@ void Renderer::RescaleHDRRenderTarget(float scale)
     width = clamp<uint32_t>(width, 1, D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION);
     height = clamp<uint32_t>(height, 1, D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION);
 
-    mHDRRenderTarget.Resize(width, height);
+    mHDRSize = XMUINT2(width, height);
 }
 
 void Renderer::OnResize(ResizeEventArgs& e)
@@ -438,6 +486,12 @@ void Renderer::OnUpdate(UpdateEventArgs& e)
         XMVECTOR positionVS = XMVector3TransformCoord(positionWS, viewMatrix);
         XMStoreFloat4(&l.PositionVS, positionVS);
 
+        if (i == mPointLightEntities.size())
+        {
+            mPointLightEntities.push_back(mScene->CreateEntity());
+        }
+        mScene->SetPosition(mPointLightEntities[i], positionWS);
+
         l.Color = XMFLOAT4(LightColors[i]);
         l.Intensity = 1.0f;
         l.Attenuation = 0.0f;
@@ -463,11 +517,33 @@ void Renderer::OnUpdate(UpdateEventArgs& e)
         XMStoreFloat4(&l.DirectionWS, directionWS);
         XMStoreFloat4(&l.DirectionVS, directionVS);
 
+        if (i == mSpotLightEntities.size())
+        {
+            mSpotLightEntities.push_back(mScene->CreateEntity());
+        }
+        mScene->SetLocalMatrix(mSpotLightEntities[i], XMMatrixRotationX(XMConvertToRadians(-90.0f)) * LookAtMatrix(positionWS, directionWS, XMVectorSet(0, 1, 0, 0)));
+
         l.Color = XMFLOAT4(LightColors[numPointLights + i]);
         l.Intensity = 1.0f;
         l.SpotAngle = XMConvertToRadians(45.0f);
         l.Attenuation = 0.0f;
     }
+
+    const float lightCutoff = 1.0f / 256.0f;
+
+    mClusteredLighting->SetProjection(XMConvertToRadians(mCamera.GetFoV()), mCamera.GetAspectRatio(), mCamera.GetNearClip(), mCamera.GetFarClip());
+    mClusteredLighting->Clear();
+    for (const PointLight& l : mPointLights)
+    {
+        mClusteredLighting->AddPointLight(XMLoadFloat4(&l.PositionVS), ClusteredLighting::ComputeRange(l.Intensity, l.Attenuation, lightCutoff));
+    }
+    for (const SpotLight& l : mSpotLights)
+    {
+        mClusteredLighting->AddSpotLight(XMLoadFloat4(&l.PositionVS), XMLoadFloat4(&l.DirectionVS), l.SpotAngle, ClusteredLighting::ComputeRange(l.Intensity, l.Attenuation, lightCutoff));
+    }
+    mClusteredLighting->Bin();
+
+    mScene->UpdateWorldMatrices();
 }
 
 static void ShowHelpMarker(const char* desc)
@@ -532,6 +608,7 @@ void Renderer::OnGUI()
 {
     static bool showDemoWindow = false;
     static bool showOptions = true;
+    static bool showStatistics = false;
 
     if (ImGui::BeginMainMenuBar())
     {
@@ -548,6 +625,7 @@ void Renderer::OnGUI()
         {
             ImGui::MenuItem("ImGui Demo", nullptr, &showDemoWindow);
             ImGui::MenuItem("Tonemapping", nullptr, &showOptions);
+            ImGui::MenuItem("Statistics", nullptr, &showStatistics);
 
             ImGui::EndMenu();
         }
@@ -566,6 +644,10 @@ void Renderer::OnGUI()
                 mpWindow->SetFullscreen(fullscreen);
             }
 
+            ImGui::MenuItem("Indirect draws", nullptr, &gIndirectDraws);
+            ImGui::MenuItem("GPU culling", nullptr, &gGPUCulling, gIndirectDraws);
+            ImGui::MenuItem("BVH culling", nullptr, &gBVHCulling, !(gIndirectDraws && gGPUCulling));
+
             ImGui::EndMenu();
         }
 
@@ -577,7 +659,7 @@ void Renderer::OnGUI()
             ImGui::SliderFloat("Resolution Scale", &renderScale, 0.1f, 2.0f);
             renderScale = clamp(renderScale, 0.0f, 2.0f);
 
-            auto size = mHDRRenderTarget.GetSize();
+            auto size = mHDRSize;
             ImGui::SameLine();
             sprintf_s(buffer, _countof(buffer), "(%ux%u)", size.x, size.y);
             ImGui::Text(buffer);
@@ -613,6 +695,8 @@ void Renderer::OnGUI()
             ImGui::SameLine(); ShowHelpMarker("Adjust the overall exposure of the HDR scene.");
             ImGui::SliderFloat("Gamma", &gTonemapParameters.Gamma, 0.01f, 5.0f);
             ImGui::SameLine(); ShowHelpMarker("Adjust the Gamma of the output image.");
+            ImGui::SliderFloat("Environment Intensity", &gEnvironmentIntensity, 0.0f, 2.0f);
+            ImGui::SameLine(); ShowHelpMarker("Scale the image based lighting baked from the skybox.");
 
             const char* toneMappingMethods[] = {
                 "Linear",
@@ -665,219 +749,419 @@ void Renderer::OnGUI()
         ImGui::End();
 
     }
-}
-
-void XM_CALLCONV ComputeMatrices(FXMMATRIX model, CXMMATRIX view, CXMMATRIX viewProjection, Mat& mat)
-{
-    mat.ModelMatrix = model;
-    mat.ModelViewMatrix = model * view;
-    mat.InverseTransposeModelViewMatrix = XMMatrixTranspose(XMMatrixInverse(nullptr, mat.ModelViewMatrix));
-    mat.ModelViewProjectionMatrix = model * viewProjection;
-}
-
-void Renderer::OnRender(RenderEventArgs& e)
-{
-    super::OnRender(e);
-
-    auto commandQueue = Application::Get().GetCommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT);
-    auto commandList = commandQueue->GetCommandList();
 
+    if (showStatistics)
     {
-        FLOAT clearColor[] = { 0.4f, 0.6f, 0.9f, 1.0f };
+        ImGui::Begin("Statistics", &showStatistics);
+        {
+            auto pipelineStatistics = Application::Get().GetComputePipelineLibrary().GetStatistics();
+            ImGui::Text("GenerateMips PSO created: %u", pipelineStatistics.GenerateMipsCreated);
+            ImGui::Text("PanoToCubemap PSO created: %u", pipelineStatistics.PanoToCubemapCreated);
+            ImGui::Text("IndirectCull PSO created: %u", pipelineStatistics.IndirectCullCreated);
+            ImGui::Text("Compute pipeline requests: %llu", pipelineStatistics.Requests);
+
+            auto cubemapStatistics = mCubemapCache->GetStatistics();
+            ImGui::Text("Cubemap cache hits: %u, misses: %u", cubemapStatistics.Hits, cubemapStatistics.Misses);
+            ImGui::Text("Last cubemap bake: %.2f ms", cubemapStatistics.LastBakeMilliseconds);
+
+            auto meshStatistics = mMeshCache->GetStatistics();
+            ImGui::Text("Mesh cache: %u meshes, hits: %u, misses: %u, file loads: %u", meshStatistics.MeshNum, meshStatistics.Hits, meshStatistics.Misses, meshStatistics.FileLoads);
+            ImGui::Text("Last mesh build: %.2f ms", meshStatistics.LastBuildMilliseconds);
+
+            auto streamingStatistics = mTextureStreamer->GetStatistics();
+            ImGui::Text("Streamed textures: %u", streamingStatistics.TextureNum);
+            ImGui::Text("Resident mips: %u / %u", streamingStatistics.ResidentMips, streamingStatistics.TotalMips);
+            ImGui::Text("Resident memory: %.2f MB", streamingStatistics.ResidentBytes / (1024.0 * 1024.0));
+            ImGui::Text("Pending IO: %u requests, %.2f MB", streamingStatistics.PendingRequests, streamingStatistics.PendingBytes / (1024.0 * 1024.0));
+
+            int budget = static_cast<int>(streamingStatistics.BudgetBytes / (1024 * 1024));
+            if (ImGui::SliderInt("Texture Budget (MB)", &budget, 1, 512))
+            {
+                mTextureStreamer->SetBudget(static_cast<uint64_t>(budget) * 1024 * 1024);
+            }
 
-        commandList->ClearTexture(mHDRRenderTarget.GetTexture(AttachmentPoint::Color0), clearColor);
-        commandList->ClearDepthStencilTexture(mHDRRenderTarget.GetTexture(AttachmentPoint::DepthStencil), D3D12_CLEAR_FLAG_DEPTH);
-    }
+            auto sphereStatistics = mSphereMesh->GetStatistics();
+            ImGui::Text("Sphere ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f", sphereStatistics.Source.ACMR, sphereStatistics.Optimized.ACMR, sphereStatistics.Source.ATVR, sphereStatistics.Optimized.ATVR);
+            auto torusStatistics = mTorusMesh->GetStatistics();
+            ImGui::Text("Torus ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f", torusStatistics.Source.ACMR, torusStatistics.Optimized.ACMR, torusStatistics.Source.ATVR, torusStatistics.Optimized.ATVR);
+            ImGui::Text("Sphere LOD: %u / %u, error %.4f", mSphereLod, mSphereMesh->GetLodCount(), mSphereMesh->GetLod(mSphereLod).Error);
+            ImGui::Text("Torus meshlets culled: %u / %u", mCulledMeshlets, static_cast<uint32_t>(mTorusMesh->GetMeshlets().Meshlets.size()));
+
+            auto arenaStatistics = Application::Get().GetGeometryArena().GetStatistics();
+            ImGui::Text("Geometry arena: %.2f / %.2f MB, %u allocations, %u pools", arenaStatistics.UsedBytes / (1024.0 * 1024.0), arenaStatistics.CapacityBytes / (1024.0 * 1024.0), arenaStatistics.AllocationNum, arenaStatistics.PoolNum);
+            ImGui::Text("Arena free ranges: %u, largest %.2f MB, grows %u", arenaStatistics.FreeRangeNum, arenaStatistics.LargestFreeBytes / (1024.0 * 1024.0), arenaStatistics.GrowNum);
+
+            auto graphStatistics = mRenderGraph->GetStatistics();
+            ImGui::Text("Render graph: %u passes (%u culled), %u transients", graphStatistics.PassNum, graphStatistics.CulledPassNum, graphStatistics.TransientNum);
+            ImGui::Text("Graph barriers: %u transitions, %u aliasing, %u UAV", graphStatistics.TransitionNum, graphStatistics.AliasingNum, graphStatistics.UAVBarrierNum);
+            ImGui::Text("Transient heap: %.2f MB (%.2f MB unaliased)", graphStatistics.HeapBytes / (1024.0 * 1024.0), graphStatistics.UnaliasedBytes / (1024.0 * 1024.0));
+            if (ImGui::Button("Dump Render Graph"))
+            {
+                OutputDebugStringW(mRenderGraph->Dump().c_str());
+            }
 
-    commandList->SetRenderTarget(mHDRRenderTarget);
-    commandList->SetViewport(mHDRRenderTarget.GetViewport());
-    commandList->SetScissorRect(mScissorRect);
-	{
-    
-        auto viewMatrix = XMMatrixTranspose(XMMatrixRotationQuaternion(mCamera.GetRotation()));
-        auto projMatrix = mCamera.GetProjectionMatrix();
-        auto viewProjMatrix = viewMatrix * projMatrix;
+            auto cullStatistics = mFrustumCuller->GetStatistics();
+            auto bvhStatistics = mSceneBVH->GetStatistics();
+            if (gBVHCulling)
+            {
+                ImGui::Text("Objects visible: %u / %u, BVH culled in %.3f ms", bvhStatistics.VisibleNum, bvhStatistics.ObjectNum, bvhStatistics.CullMilliseconds);
+            }
+            else
+            {
+                ImGui::Text("Objects visible: %u / %u, culled in %.3f ms", cullStatistics.VisibleNum, cullStatistics.ObjectNum, cullStatistics.CullMilliseconds);
+            }
 
-        commandList->SetPipelineState(mSkyboxPipelineState);
-        commandList->SetGraphicsRootSignature(mSkyboxSignature);
+            ImGui::Text("Scene BVH: %u nodes, depth %u, built in %.3f ms", bvhStatistics.NodeNum, bvhStatistics.MaxDepth, bvhStatistics.BuildMilliseconds);
+            ImGui::Text("Picked object: %d", mPickedObject);
 
-        commandList->SetGraphics32BitConstants(0, viewProjMatrix);
+            auto sceneStatistics = mScene->GetStatistics();
+            ImGui::Text("Scene: %u / %u transforms updated in %.3f ms", sceneStatistics.UpdatedNum, sceneStatistics.EntityNum, sceneStatistics.UpdateMilliseconds);
 
-        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-        srvDesc.Format = mSkyboxCubemap.GetD3D12ResourceDesc().Format;
-        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
-        srvDesc.TextureCube.MipLevels = (UINT)-1; 
+            auto queueStatistics = mRenderQueue->GetStatistics();
+            ImGui::Text("Render queue: %u packets in %u draws, sorted in %.3f ms (%u passes)", queueStatistics.PacketNum, queueStatistics.DrawNum, queueStatistics.SortMilliseconds, queueStatistics.SortPasses);
+            ImGui::Text("State changes: %u root signatures, %u PSOs, %u textures", queueStatistics.RootSignatureChanges, queueStatistics.PipelineStateChanges, queueStatistics.TextureChanges);
+            ImGui::Text("Object and material upload: %.1f KB", queueStatistics.UploadBytes / 1024.0);
+            if (gIndirectDraws)
+            {
+                ImGui::Text("Indirect: %u commands in %u ExecuteIndirect calls%s", queueStatistics.IndirectCommandNum, queueStatistics.DrawNum, gGPUCulling ? ", GPU culled" : "");
+            }
 
-        commandList->SetShaderResourceView(1, 0, mSkyboxCubemap, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, 0, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, &srvDesc);
+            auto transformStatistics = mTransformBatch->GetStatistics();
+            ImGui::Text("Transforms: %u / %u computed (%u general) in %.3f ms", transformStatistics.ComputedNum, transformStatistics.ObjectNum, transformStatistics.GeneralNum, transformStatistics.ComputeMilliseconds);
 
-        mSkyboxMesh->Draw(*commandList);
+            auto clusterStatistics = mClusteredLighting->GetStatistics();
+            ImGui::Text("Light clusters: %u lights, %u indices (max %u per cluster), binned in %.3f ms", clusterStatistics.LightNum, clusterStatistics.IndexNum, clusterStatistics.MaxClusterLightNum, clusterStatistics.BinMilliseconds);
+        }
+        ImGui::End();
     }
+}
 
+Material AtlasMaterial(const Material& material, const TextureAtlas::Region& region)
+{
+    Material atlasMaterial = material;
+    atlasMaterial.TextureScaleOffset = region.ScaleOffset;
+    return atlasMaterial;
+}
 
-    commandList->SetPipelineState(mHDRPipelineState);
-    commandList->SetGraphicsRootSignature(mHDRRootSignature);
-
-    LightProperties lightProps;
-    lightProps.NumPointLights = static_cast<uint32_t>(mPointLights.size());
-    lightProps.NumSpotLights = static_cast<uint32_t>(mSpotLights.size());
+void Renderer::OnRender(RenderEventArgs& e)
+{
+    super::OnRender(e);
 
-    commandList->SetGraphics32BitConstants(RootParameters::LightPropertiesCB, lightProps);
-    commandList->SetGraphicsDynamicStructuredBuffer(RootParameters::PointLights, mPointLights);
-    commandList->SetGraphicsDynamicStructuredBuffer(RootParameters::SpotLights, mSpotLights);
+    auto commandQueue = Application::Get().GetCommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT);
+    auto commandList = commandQueue->GetCommandList();
 
-    XMMATRIX translationMatrix = XMMatrixTranslation(-4.0f, 2.0f, -4.0f);
-    XMMATRIX rotationMatrix = XMMatrixIdentity();
-    XMMATRIX scaleMatrix = XMMatrixScaling(4.0f, 4.0f, 4.0f);
-    XMMATRIX worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
-    XMMATRIX viewMatrix = mCamera.GetViewMatrix();
-    XMMATRIX viewProjectionMatrix = viewMatrix * mCamera.GetProjectionMatrix();
+    auto colorDesc = CD3DX12_RESOURCE_DESC::Tex2D(mHDRFormat, mHDRSize.x, mHDRSize.y);
+    colorDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
 
-    Mat matrices;
-    ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+    D3D12_CLEAR_VALUE colorClearValue;
+    colorClearValue.Format = colorDesc.Format;
+    colorClearValue.Color[0] = 0.4f;
+    colorClearValue.Color[1] = 0.6f;
+    colorClearValue.Color[2] = 0.9f;
+    colorClearValue.Color[3] = 1.0f;
 
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MaterialCB, Material::White);
-    commandList->SetShaderResourceView(RootParameters::Textures, 0, mSphereTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    auto depthDesc = CD3DX12_RESOURCE_DESC::Tex2D(mDepthBufferFormat, mHDRSize.x, mHDRSize.y);
+    depthDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
 
-    mSphereMesh->Draw(*commandList);
+    D3D12_CLEAR_VALUE depthClearValue;
+    depthClearValue.Format = depthDesc.Format;
+    depthClearValue.DepthStencil = { 1.0f, 0 };
 
-    translationMatrix = XMMatrixTranslation(4.0f, 4.0f, 4.0f);
-    rotationMatrix = XMMatrixRotationY(XMConvertToRadians(45.0f));
-    scaleMatrix = XMMatrixScaling(4.0f, 8.0f, 4.0f);
-    worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
+    mRenderGraph->Reset();
+    auto hdrTexture = mRenderGraph->CreateTexture(L"HDR Texture", colorDesc, &colorClearValue, TextureUsage::RenderTarget);
+    auto depthTexture = mRenderGraph->CreateTexture(L"Depth Render Target", depthDesc, &depthClearValue, TextureUsage::Depth);
+    auto backBuffer = mRenderGraph->ImportTexture(L"Back Buffer", mpWindow->GetRenderTarget().GetTexture(AttachmentPoint::Color0), true);
 
-    ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+    mRenderGraph->AddPass(L"Skybox", [&](RenderGraph::PassBuilder& builder)
+    {
+        builder.Write(hdrTexture, D3D12_RESOURCE_STATE_RENDER_TARGET);
+        builder.Write(depthTexture, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    },
+    [&](CommandList& commandList, const RenderGraph& graph)
+    {
+        const Texture& hdr = graph.GetTexture(hdrTexture);
+        const Texture& depth = graph.GetTexture(depthTexture);
+        if (mHDRRenderTarget.GetTexture(AttachmentPoint::Color0).GetD3D12Resource() != hdr.GetD3D12Resource() ||
+            mHDRRenderTarget.GetTexture(AttachmentPoint::DepthStencil).GetD3D12Resource() != depth.GetD3D12Resource())
+        {
+            mHDRRenderTarget.AttachTexture(AttachmentPoint::Color0, hdr);
+            mHDRRenderTarget.AttachTexture(AttachmentPoint::DepthStencil, depth);
+        }
 
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MaterialCB, Material::White);
-    commandList->SetShaderResourceView(RootParameters::Textures, 0, mCubeTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        {
+            FLOAT clearColor[] = { 0.4f, 0.6f, 0.9f, 1.0f };
 
-    mCubeMesh->Draw(*commandList);
+            commandList.ClearTexture(graph.GetTexture(hdrTexture), clearColor);
+            commandList.ClearDepthStencilTexture(graph.GetTexture(depthTexture), D3D12_CLEAR_FLAG_DEPTH);
+        }
 
-    translationMatrix = XMMatrixTranslation(4.0f, 0.6f, -4.0f);
-    rotationMatrix = XMMatrixRotationY(XMConvertToRadians(45.0f));
-    scaleMatrix = XMMatrixScaling(4.0f, 4.0f, 4.0f);
-    worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
+        commandList.SetRenderTarget(mHDRRenderTarget);
+        commandList.SetViewport(mHDRRenderTarget.GetViewport());
+        commandList.SetScissorRect(mScissorRect);
+        {
+            auto viewMatrix = XMMatrixTranspose(XMMatrixRotationQuaternion(mCamera.GetRotation()));
+            auto projMatrix = mCamera.GetProjectionMatrix();
+            auto viewProjMatrix = viewMatrix * projMatrix;
 
-    ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+            commandList.SetPipelineState(mSkyboxPipelineState);
+            commandList.SetGraphicsRootSignature(mSkyboxSignature);
 
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MaterialCB, Material::Ruby);
-    commandList->SetShaderResourceView(RootParameters::Textures, 0, mDefaultTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+            commandList.SetGraphics32BitConstants(0, viewProjMatrix);
 
-    mTorusMesh->Draw(*commandList);
+            D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.Format = mSkyboxCubemap.GetD3D12ResourceDesc().Format;
+            srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+            srvDesc.TextureCube.MipLevels = (UINT)-1; 
 
-    float scalePlane = 20.0f;
-    float translateOffset = scalePlane / 2.0f;
+            commandList.SetShaderResourceView(1, 0, mSkyboxCubemap, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, 0, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, &srvDesc);
 
-    translationMatrix = XMMatrixTranslation(0.0f, 0.0f, 0.0f);
-    rotationMatrix = XMMatrixIdentity();
-    scaleMatrix = XMMatrixScaling(scalePlane, 1.0f, scalePlane);
-    worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
+            mSkyboxMesh->Draw(commandList);
+        }
+    });
 
-    ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+    mRenderGraph->AddPass(L"Geometry", [&](RenderGraph::PassBuilder& builder)
+    {
+        builder.ReadWrite(hdrTexture, D3D12_RESOURCE_STATE_RENDER_TARGET);
+        builder.ReadWrite(depthTexture, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    },
+    [&](CommandList& commandList, const RenderGraph& graph)
+    {
+        commandList.SetRenderTarget(mHDRRenderTarget);
+        commandList.SetViewport(mHDRRenderTarget.GetViewport());
+        commandList.SetScissorRect(mScissorRect);
+
+        D3D12_VIEWPORT hdrViewport = mHDRRenderTarget.GetViewport();
+
+        LightProperties lightProps;
+        lightProps.ClusterCountX = ClusteredLighting::ClusterCountX;
+        lightProps.ClusterCountY = ClusteredLighting::ClusterCountY;
+        lightProps.ClusterCountZ = ClusteredLighting::ClusterCountZ;
+        lightProps.ClusterDepthScale = mClusteredLighting->GetDepthScale();
+        lightProps.ClusterDepthBias = mClusteredLighting->GetDepthBias();
+        lightProps.InverseScreenSize = XMFLOAT2(1.0f / hdrViewport.Width, 1.0f / hdrViewport.Height);
+
+        EnvironmentLighting environmentLighting;
+        memcpy(environmentLighting.Irradiance, mIrradianceSH.Coefficients, sizeof(environmentLighting.Irradiance));
+        environmentLighting.InverseViewMatrix = XMMatrixInverse(nullptr, mCamera.GetViewMatrix());
+        environmentLighting.SpecularMipLevels = static_cast<float>(mSpecularCubemap.GetD3D12ResourceDesc().MipLevels);
+        environmentLighting.Intensity = gEnvironmentIntensity;
+
+        D3D12_SHADER_RESOURCE_VIEW_DESC environmentSRVDesc = {};
+        environmentSRVDesc.Format = mSpecularCubemap.GetD3D12ResourceDesc().Format;
+        environmentSRVDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        environmentSRVDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+        environmentSRVDesc.TextureCube.MipLevels = (UINT)-1;
+
+        XMMATRIX viewMatrix = mCamera.GetViewMatrix();
+        XMMATRIX viewProjectionMatrix = viewMatrix * mCamera.GetProjectionMatrix();
 
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MaterialCB, Material::White);
-    commandList->SetShaderResourceView(RootParameters::Textures, 0, mDirectXTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        {
+            XMMATRIX projectionMatrix = mCamera.GetProjectionMatrix();
+            float viewportHeight = mHDRRenderTarget.GetViewport().Height;
 
-    mPlaneMesh->Draw(*commandList);
+            auto requestScreenSize = [&](StreamedTexture* texture, const Mesh& mesh, Scene::Entity entity)
+            {
+                BoundingBox bounds;
+                mesh.GetBoundingBox().Transform(bounds, mScene->GetWorldMatrix(entity));
+                float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&bounds.Extents)));
+                XMVECTOR center = XMVectorSetW(XMLoadFloat3(&bounds.Center), 1.0f);
+                mTextureStreamer->RequestScreenSize(texture, TextureStreamer::ComputeScreenSize(center, radius, viewMatrix, projectionMatrix, viewportHeight));
+            };
 
-    translationMatrix = XMMatrixTranslation(0, translateOffset, translateOffset);
-    rotationMatrix = XMMatrixRotationX(XMConvertToRadians(-90));
-    worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
+            requestScreenSize(mSphereTexture, *mSphereMesh, mSphereEntity);
+            requestScreenSize(mCubeTexture, *mCubeMesh, mCubeEntity);
 
-    ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+            // Floor, ceiling and the two walls facing along Z carry the streamed texture, see wallMaterials.
+            for (size_t i = 0; i < 4; ++i)
+            {
+                requestScreenSize(mDirectXTexture, *mPlaneMesh, mWallEntities[i]);
+            }
 
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
+            mTextureStreamer->Update(commandList);
+        }
 
-    mPlaneMesh->Draw(*commandList);
+        mRenderQueue->Reset();
+        mRenderQueue->SetObjectWriter(sizeof(Mat), [&](const uint32_t* objects, size_t count, void* destination, size_t stride)
+        {
+            mTransformBatch->Compute(objects, count, destination, stride);
+        });
 
-    translationMatrix = XMMatrixTranslation(0, translateOffset * 2.0f, 0);
-    rotationMatrix = XMMatrixRotationX(XMConvertToRadians(180));
-    worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
+        uint32_t hdrRootSignature = mRenderQueue->AddRootSignature(mHDRRootSignature, [&](CommandList& commandList)
+        {
+            commandList.SetGraphics32BitConstants(RootParameters::LightPropertiesCB, lightProps);
+            commandList.SetGraphicsDynamicStructuredBuffer(RootParameters::PointLights, mPointLights);
+            commandList.SetGraphicsDynamicStructuredBuffer(RootParameters::SpotLights, mSpotLights);
+            commandList.SetGraphicsDynamicStructuredBuffer(RootParameters::LightClusters, mClusteredLighting->GetClusterRanges());
+            commandList.SetGraphicsDynamicStructuredBuffer(RootParameters::LightIndices, mClusteredLighting->GetLightIndices());
+            commandList.SetGraphicsDynamicConstantBuffer(RootParameters::EnvironmentCB, environmentLighting);
+            commandList.SetShaderResourceView(RootParameters::EnvironmentMap, 0, mSpecularCubemap, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, 0, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, &environmentSRVDesc);
+        });
+        uint32_t hdrPipeline = mRenderQueue->AddPipelineState(mHDRPipelineState);
+        uint32_t quantizedPipeline = mRenderQueue->AddPipelineState(mHDRQuantizedPipelineState);
+
+        const Texture& atlasTexture = mTextureAtlas->GetTexture(mDefaultTextureRegion.AtlasIndex);
+        uint32_t sphereMaterial = mRenderQueue->AddMaterial(mSphereTexture->GetTexture(), Material::White);
+        uint32_t cubeMaterial = mRenderQueue->AddMaterial(mCubeTexture->GetTexture(), Material::White);
+        uint32_t torusMaterial = mRenderQueue->AddMaterial(atlasTexture, AtlasMaterial(Material::Ruby, mDefaultTextureRegion));
+        uint32_t wallMaterial = mRenderQueue->AddMaterial(mDirectXTexture->GetTexture(), Material::White);
+        uint32_t redWallMaterial = mRenderQueue->AddMaterial(atlasTexture, AtlasMaterial(Material::Red, mDefaultTextureRegion));
+        uint32_t blueWallMaterial = mRenderQueue->AddMaterial(atlasTexture, AtlasMaterial(Material::Blue, mDefaultTextureRegion));
+
+        struct ObjectDraw
+        {
+            Mesh* Geometry;
+            uint32_t PipelineState;
+            uint32_t Material;
+            uint32_t Lod;
+            const std::vector<uint32_t>* Meshlets;
+            float ViewDepth;
+        };
+        std::vector<ObjectDraw> objectDraws;
+        std::vector<BoundingBox> objectBounds;
+        mFrustumCuller->Clear();
+        mTransformBatch->Clear();
+        mTransformBatch->SetViewProjection(viewMatrix, viewProjectionMatrix);
 
-    ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+        auto submit = [&](uint32_t pipelineState, uint32_t material, Mesh& mesh, FXMMATRIX worldMatrix, uint32_t lod = RenderQueue::FullMesh, const std::vector<uint32_t>* meshlets = nullptr, uint32_t prefix = TransformBatch::NoPrefix)
+        {
+            mTransformBatch->Add(worldMatrix, prefix);
 
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
+            BoundingBox bounds;
+            mesh.GetBoundingBox().Transform(bounds, worldMatrix);
+            mFrustumCuller->AddObject(bounds);
+            objectBounds.push_back(bounds);
 
-    mPlaneMesh->Draw(*commandList);
+            float viewDepth = XMVectorGetZ(XMVector3TransformCoord(worldMatrix.r[3], viewMatrix));
+            objectDraws.push_back({ &mesh, pipelineState, material, lod, meshlets, viewDepth });
+        };
 
-    translationMatrix = XMMatrixTranslation(0, translateOffset, -translateOffset);
-    rotationMatrix = XMMatrixRotationX(XMConvertToRadians(90));
-    worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
+        XMMATRIX worldMatrix = mScene->GetWorldMatrix(mSphereEntity);
 
-    ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+        {
+            float sphereDepth = XMVectorGetZ(XMVector3TransformCoord(worldMatrix.r[3], viewMatrix)) - 2.0f;
+            mSphereLod = mSphereMesh->SelectLod(sphereDepth, 4.0f, mCamera.GetProjectionMatrix(), mHDRRenderTarget.GetViewport().Height);
+        }
 
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
+        submit(hdrPipeline, sphereMaterial, *mSphereMesh, worldMatrix, mSphereLod);
 
-    mPlaneMesh->Draw(*commandList);
+        worldMatrix = mScene->GetWorldMatrix(mCubeEntity);
+        submit(hdrPipeline, cubeMaterial, *mCubeMesh, worldMatrix);
 
-    translationMatrix = XMMatrixTranslation(-translateOffset, translateOffset, 0);
-    rotationMatrix = XMMatrixRotationX(XMConvertToRadians(-90)) * XMMatrixRotationY(XMConvertToRadians(-90));
-    worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
+        worldMatrix = mScene->GetWorldMatrix(mTorusEntity);
 
-    ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+        {
+            XMFLOAT4X4 modelViewProjection;
+            XMStoreFloat4x4(&modelViewProjection, worldMatrix * viewProjectionMatrix);
+            XMFLOAT4 frustumPlanes[6];
+            MeshletCuller::ExtractFrustumPlanes(modelViewProjection, frustumPlanes);
+
+            XMFLOAT3 cameraPosition;
+            XMStoreFloat3(&cameraPosition, XMVector3TransformCoord(mCamera.GetTranslation(), XMMatrixInverse(nullptr, worldMatrix)));
+            mCulledMeshlets = MeshletCuller::Cull(mTorusMesh->GetMeshlets(), frustumPlanes, cameraPosition, mVisibleMeshlets);
+        }
 
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MaterialCB, Material::Red);
-    commandList->SetShaderResourceView(RootParameters::Textures, 0, mDefaultTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        submit(quantizedPipeline, torusMaterial, *mTorusMesh, worldMatrix, RenderQueue::FullMesh, &mVisibleMeshlets, mTransformBatch->AddPrefix(mTorusMesh->GetDequantizationMatrix()));
 
-    mPlaneMesh->Draw(*commandList);
+        const uint32_t wallMaterials[] = { wallMaterial, wallMaterial, wallMaterial, wallMaterial, redWallMaterial, blueWallMaterial };
+        for (size_t i = 0; i < mWallEntities.size(); ++i)
+        {
+            worldMatrix = mScene->GetWorldMatrix(mWallEntities[i]);
+            submit(hdrPipeline, wallMaterials[i], *mPlaneMesh, worldMatrix);
+        }
 
-    translationMatrix = XMMatrixTranslation(translateOffset, translateOffset, 0);
-    rotationMatrix = XMMatrixRotationX(XMConvertToRadians(-90)) * XMMatrixRotationY(XMConvertToRadians(90));
-    worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
+        Material lightMaterial;
+        lightMaterial.Specular = { 0, 0, 0, 1 };
+        lightMaterial.TextureScaleOffset = mDefaultTextureRegion.ScaleOffset;
+        for (size_t i = 0; i < mPointLights.size(); ++i)
+        {
+            lightMaterial.Emissive = mPointLights[i].Color;
+            worldMatrix = mScene->GetWorldMatrix(mPointLightEntities[i]);
+            submit(hdrPipeline, mRenderQueue->AddMaterial(atlasTexture, lightMaterial), *mSphereMesh, worldMatrix);
+        }
 
-    ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+        for (size_t i = 0; i < mSpotLights.size(); ++i)
+        {
+            lightMaterial.Emissive = mSpotLights[i].Color;
+            worldMatrix = mScene->GetWorldMatrix(mSpotLightEntities[i]);
+            submit(hdrPipeline, mRenderQueue->AddMaterial(atlasTexture, lightMaterial), *mConeMesh, worldMatrix);
+        }
 
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
-    commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MaterialCB, Material::Blue);
-    mPlaneMesh->Draw(*commandList);
+        // Refitted rather than rebuilt while the object set is unchanged; it serves both CPU culling and picking.
+        if (mSceneBVH->GetObjectCount() != objectBounds.size())
+        {
+            mSceneBVH->Build(objectBounds);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < objectBounds.size(); ++i)
+            {
+                mSceneBVH->UpdateObject(i, objectBounds[i]);
+            }
+        }
 
-    Material lightMaterial;
-    lightMaterial.Specular = { 0, 0, 0, 1 };
-    for (const auto& l : mPointLights)
-    {
-        lightMaterial.Emissive = l.Color;
-        XMVECTOR lightPos = XMLoadFloat4(&l.PositionWS);
-        worldMatrix = XMMatrixTranslationFromVector(lightPos);
-        ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+        XMFLOAT4X4 cullViewProjection;
+        XMStoreFloat4x4(&cullViewProjection, viewProjectionMatrix);
+        bool gpuCulling = gIndirectDraws && gGPUCulling;
+        if (gpuCulling)
+        {
+            mVisibleObjects.resize(objectDraws.size());
+            for (uint32_t object = 0; object < mVisibleObjects.size(); ++object)
+            {
+                mVisibleObjects[object] = object;
+            }
+        }
+        else if (gBVHCulling)
+        {
+            XMFLOAT4 frustumPlanes[6];
+            MeshletCuller::ExtractFrustumPlanes(cullViewProjection, frustumPlanes);
+            mSceneBVH->CullFrustum(frustumPlanes, mVisibleObjects);
+        }
+        else
+        {
+            mFrustumCuller->Cull(cullViewProjection, mVisibleObjects);
+        }
 
-        commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
-        commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MaterialCB, lightMaterial);
+        for (uint32_t object : mVisibleObjects)
+        {
+            const ObjectDraw& draw = objectDraws[object];
+            mRenderQueue->SubmitObject(RenderQueue::Layer::Opaque, hdrRootSignature, draw.PipelineState, draw.Material, draw.ViewDepth, *draw.Geometry, object, draw.Lod, draw.Meshlets);
+        }
 
-        mSphereMesh->Draw(*commandList);
-    }
+        RenderQueue::Bindings bindings = { RootParameters::DrawConstants, RootParameters::ObjectData, RootParameters::MaterialData, RootParameters::Textures };
+        if (gIndirectDraws)
+        {
+            RenderQueue::Culling culling;
+            culling.ObjectBounds = &objectBounds;
+            MeshletCuller::ExtractFrustumPlanes(cullViewProjection, culling.FrustumPlanes);
+            mRenderQueue->ExecuteIndirect(commandList, bindings, *mHDRCommandSignature, gpuCulling ? &culling : nullptr);
+        }
+        else
+        {
+            mRenderQueue->Execute(commandList, bindings);
+        }
+    });
 
-    for (const auto& l : mSpotLights)
+    mRenderGraph->AddPass(L"Tonemap", [&](RenderGraph::PassBuilder& builder)
     {
-        lightMaterial.Emissive = l.Color;
-        XMVECTOR lightPos = XMLoadFloat4(&l.PositionWS);
-        XMVECTOR lightDir = XMLoadFloat4(&l.DirectionWS);
-        XMVECTOR up = XMVectorSet(0, 1, 0, 0);
-
-        rotationMatrix = XMMatrixRotationX(XMConvertToRadians(-90.0f));
-        worldMatrix = rotationMatrix * LookAtMatrix(lightPos, lightDir, up);
-
-        ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
-
-        commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MatricesCB, matrices);
-        commandList->SetGraphicsDynamicConstantBuffer(RootParameters::MaterialCB, lightMaterial);
-
-        mConeMesh->Draw(*commandList);
-    }
+        builder.Read(hdrTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        builder.Write(backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    },
+    [&](CommandList& commandList, const RenderGraph& graph)
+    {
+        commandList.SetRenderTarget(mpWindow->GetRenderTarget());
+        commandList.SetViewport(mpWindow->GetRenderTarget().GetViewport());
+        commandList.SetPipelineState(mSDRPipelineState);
+        commandList.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        commandList.SetGraphicsRootSignature(mSDRRootSignature);
+        commandList.SetGraphics32BitConstants(0, gTonemapParameters);
+        commandList.SetShaderResourceView(1, 0, graph.GetTexture(hdrTexture), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 
-    commandList->SetRenderTarget(mpWindow->GetRenderTarget());
-    commandList->SetViewport(mpWindow->GetRenderTarget().GetViewport());
-    commandList->SetPipelineState(mSDRPipelineState);
-    commandList->SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    commandList->SetGraphicsRootSignature(mSDRRootSignature);
-    commandList->SetGraphics32BitConstants(0, gTonemapParameters);
-    commandList->SetShaderResourceView(1, 0, mHDRRenderTarget.GetTexture(Color0), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        commandList.Draw(3);
+    });
 
-    commandList->Draw(3);
+    mRenderGraph->Compile();
+    mRenderGraph->Execute(*commandList);
 
     commandQueue->ExecuteCommandList(commandList);
 
@@ -1011,6 +1295,16 @@ void Renderer::OnMouseMoved(MouseMotionEventArgs& e)
 
             mYaw -= e.RelX * mouseSpeed;
         }
+
+        XMMATRIX viewMatrix = mCamera.GetViewMatrix();
+        XMMATRIX projectionMatrix = mCamera.GetProjectionMatrix();
+        float mouseX = static_cast<float>(e.X);
+        float mouseY = static_cast<float>(e.Y);
+        XMVECTOR rayStart = XMVector3Unproject(XMVectorSet(mouseX, mouseY, 0.0f, 1.0f), 0.0f, 0.0f, static_cast<float>(mWidth), static_cast<float>(mHeight), 0.0f, 1.0f, projectionMatrix, viewMatrix, XMMatrixIdentity());
+        XMVECTOR rayEnd = XMVector3Unproject(XMVectorSet(mouseX, mouseY, 1.0f, 1.0f), 0.0f, 0.0f, static_cast<float>(mWidth), static_cast<float>(mHeight), 0.0f, 1.0f, projectionMatrix, viewMatrix, XMMatrixIdentity());
+
+        BVH::RayHit hit;
+        mPickedObject = mSceneBVH->Raycast(rayStart, XMVector3Normalize(rayEnd - rayStart), FLT_MAX, hit) ? static_cast<int>(hit.Object) : -1;
     }
 }
 
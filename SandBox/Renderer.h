@@ -1,14 +1,26 @@
 #pragma once
 
 #include "Camera.h"
+#include "../Render/CubemapCache.h"
 #include "../Render/game.h""
 #include "../Render/IndexBuffer.h"
 #include "Light.h"
 #include "../Render/window.h"
+#include "../Render/BVH.h"
+#include "../Render/ClusteredLighting.h"
+#include "../Render/CommandSignature.h"
+#include "../Render/FrustumCuller.h"
 #include "../Render/Mesh.h"
+#include "../Render/MeshCache.h"
+#include "../Render/RenderGraph.h"
+#include "../Render/RenderQueue.h"
 #include "../Render/RenderTarget.h"
+#include "../Render/Scene.h"
 #include "../Render/RootSignature.h"
 #include "../Render/Texture.h"
+#include "../Render/TextureAtlas.h"
+#include "../Render/TextureStreamer.h"
+#include "../Render/TransformBatch.h"
 #include "../Render/VertexBuffer.h"
 
 #include <DirectXMath.h>
@@ -38,29 +50,58 @@ protected:
     void OnGUI();
 
 private:
-    std::unique_ptr<Mesh> mCubeMesh;
-    std::unique_ptr<Mesh> mSphereMesh;
-    std::unique_ptr<Mesh> mConeMesh;
-    std::unique_ptr<Mesh> mTorusMesh;
-    std::unique_ptr<Mesh> mPlaneMesh;
-
-    std::unique_ptr<Mesh> mSkyboxMesh;
-
-    Texture mDefaultTexture;
-    Texture mDirectXTexture;
-    Texture mSphereTexture;
-    Texture mCubeTexture;
-    Texture mSkyboxTexture;
-    Texture mSkyboxCubemap;
+    std::shared_ptr<Mesh> mCubeMesh;
+    std::shared_ptr<Mesh> mSphereMesh;
+    std::shared_ptr<Mesh> mConeMesh;
+    std::shared_ptr<Mesh> mTorusMesh;
+    std::shared_ptr<Mesh> mPlaneMesh;
+
+    std::shared_ptr<Mesh> mSkyboxMesh;
+
+    std::vector<uint32_t> mVisibleMeshlets;
+    uint32_t mCulledMeshlets;
+    uint32_t mSphereLod;
+    int mPickedObject;
 
+    std::unique_ptr<TextureAtlas> mTextureAtlas;
+    TextureAtlas::Region mDefaultTextureRegion;
+
+    StreamedTexture* mDirectXTexture;
+    StreamedTexture* mSphereTexture;
+    StreamedTexture* mCubeTexture;
+    Texture mSkyboxCubemap;
+    Texture mSpecularCubemap;
+    IrradianceSH mIrradianceSH;
+
+    std::unique_ptr<MeshCache> mMeshCache;
+    std::unique_ptr<CubemapCache> mCubemapCache;
+    std::unique_ptr<TextureStreamer> mTextureStreamer;
+
+    std::unique_ptr<RenderGraph> mRenderGraph;
+    std::unique_ptr<RenderQueue> mRenderQueue;
+    std::unique_ptr<FrustumCuller> mFrustumCuller;
+    std::vector<uint32_t> mVisibleObjects;
+    std::unique_ptr<BVH> mSceneBVH;
+    std::unique_ptr<TransformBatch> mTransformBatch;
+    std::unique_ptr<ClusteredLighting> mClusteredLighting;
+    std::unique_ptr<Scene> mScene;
+    Scene::Entity mSphereEntity;
+    Scene::Entity mCubeEntity;
+    Scene::Entity mTorusEntity;
+    Scene::Entity mRoomEntity;
+    std::vector<Scene::Entity> mWallEntities;
+    std::vector<Scene::Entity> mPointLightEntities;
+    std::vector<Scene::Entity> mSpotLightEntities;
     RenderTarget mHDRRenderTarget;
     RootSignature mSkyboxSignature;
     RootSignature mHDRRootSignature;
+    std::unique_ptr<CommandSignature> mHDRCommandSignature;
     RootSignature mSDRRootSignature;
 
 
 	ComPtr<ID3D12PipelineState> mSkyboxPipelineState;
     ComPtr<ID3D12PipelineState> mHDRPipelineState;
+    ComPtr<ID3D12PipelineState> mHDRQuantizedPipelineState;
     ComPtr<ID3D12PipelineState> mSDRPipelineState;
 
     D3D12_RECT mScissorRect;
@@ -91,6 +132,9 @@ private:
     int mHeight;
 
     float mRenderScale;
+    DXGI_FORMAT mHDRFormat;
+    DXGI_FORMAT mDepthBufferFormat;
+    DirectX::XMUINT2 mHDRSize;
 
     std::vector<PointLight> mPointLights;
     std::vector<SpotLight> mSpotLights;
@@ -3,6 +3,8 @@ struct PixelShaderInput
     float4 PositionVS : POSITION;
     float3 NormalVS   : NORMAL;
     float2 TexCoord   : TEXCOORD;
+    nointerpolation uint MaterialIndex : MATERIAL;
+    float4 Position   : SV_Position;
 };
 
 struct Material
@@ -13,6 +15,7 @@ struct Material
     float4 Specular;
     float  SpecularPower;
     float3 Padding;
+    float4 TextureScaleOffset;
 };
 
 struct PointLight
@@ -42,8 +45,21 @@ struct SpotLight
 
 struct LightProperties
 {
-    uint NumPointLights;
-    uint NumSpotLights;
+    uint   ClusterCountX;
+    uint   ClusterCountY;
+    uint   ClusterCountZ;
+    float  ClusterDepthScale;
+    float  ClusterDepthBias;
+    float2 InverseScreenSize;
+};
+
+struct EnvironmentLighting
+{
+    float4 Irradiance[9];
+    matrix InverseViewMatrix;
+    float  SpecularMipLevels;
+    float  Intensity;
+    float2 Padding;
 };
 
 struct LightResult
@@ -52,12 +68,16 @@ struct LightResult
     float4 Specular;
 };
 
-ConstantBuffer<Material> MaterialCB : register( b0, space1 );
 ConstantBuffer<LightProperties> LightPropertiesCB : register( b1 );
+ConstantBuffer<EnvironmentLighting> EnvironmentCB : register( b2 );
 
 StructuredBuffer<PointLight> PointLights : register( t0 );
 StructuredBuffer<SpotLight> SpotLights : register( t1 );
+StructuredBuffer<uint2> LightClusters : register( t4 );
+StructuredBuffer<uint> LightIndices : register( t5 );
+StructuredBuffer<Material> Materials : register( t1, space1 );
 Texture2D DiffuseTexture            : register( t2 );
+TextureCube SpecularCubemap         : register( t3 );
 
 SamplerState LinearRepeatSampler    : register(s0);
 
@@ -71,12 +91,12 @@ float DoDiffuse( float3 N, float3 L )
     return max( 0, dot( N, L ) );
 }
 
-float DoSpecular( float3 V, float3 N, float3 L )
+float DoSpecular( float3 V, float3 N, float3 L, float specularPower )
 {
     float3 R = normalize( reflect( -L, N ) );
     float RdotV = max( 0, dot( R, V ) );
 
-    return pow( RdotV, MaterialCB.SpecularPower );
+    return pow( RdotV, specularPower );
 }
 
 float DoAttenuation( float attenuation, float distance )
@@ -92,7 +112,7 @@ float DoSpotCone( float3 spotDir, float3 L, float spotAngle )
     return smoothstep( minCos, maxCos, cosAngle );
 }
 
-LightResult DoPointLight( PointLight light, float3 V, float3 P, float3 N )
+LightResult DoPointLight( PointLight light, float3 V, float3 P, float3 N, float specularPower )
 {
     LightResult result;
     float3 L = ( light.PositionVS.xyz - P );
@@ -102,12 +122,12 @@ LightResult DoPointLight( PointLight light, float3 V, float3 P, float3 N )
     float attenuation = DoAttenuation( light.Attenuation, d );
 
     result.Diffuse = DoDiffuse( N, L ) * attenuation * light.Color * light.Intensity;
-    result.Specular = DoSpecular( V, N, L ) * attenuation * light.Color * light.Intensity;
+    result.Specular = DoSpecular( V, N, L, specularPower ) * attenuation * light.Color * light.Intensity;
 
     return result;
 }
 
-LightResult DoSpotLight( SpotLight light, float3 V, float3 P, float3 N )
+LightResult DoSpotLight( SpotLight light, float3 V, float3 P, float3 N, float specularPower )
 {
     LightResult result;
     float3 L = ( light.PositionVS.xyz - P );
@@ -119,31 +139,77 @@ LightResult DoSpotLight( SpotLight light, float3 V, float3 P, float3 N )
     float spotIntensity = DoSpotCone( light.DirectionVS.xyz, L, light.SpotAngle );
 
     result.Diffuse = DoDiffuse( N, L ) * attenuation * spotIntensity * light.Color * light.Intensity;
-    result.Specular = DoSpecular( V, N, L ) * attenuation * spotIntensity * light.Color * light.Intensity;
+    result.Specular = DoSpecular( V, N, L, specularPower ) * attenuation * spotIntensity * light.Color * light.Intensity;
 
     return result;
 }
 
-LightResult DoLighting( float3 P, float3 N )
+float3 DoIrradiance( float3 N )
+{
+    float3 result = EnvironmentCB.Irradiance[0].rgb * 0.282095;
+    result += EnvironmentCB.Irradiance[1].rgb * 0.488603 * N.y;
+    result += EnvironmentCB.Irradiance[2].rgb * 0.488603 * N.z;
+    result += EnvironmentCB.Irradiance[3].rgb * 0.488603 * N.x;
+    result += EnvironmentCB.Irradiance[4].rgb * 1.092548 * N.x * N.y;
+    result += EnvironmentCB.Irradiance[5].rgb * 1.092548 * N.y * N.z;
+    result += EnvironmentCB.Irradiance[6].rgb * 0.315392 * ( 3.0 * N.z * N.z - 1.0 );
+    result += EnvironmentCB.Irradiance[7].rgb * 1.092548 * N.x * N.z;
+    result += EnvironmentCB.Irradiance[8].rgb * 0.546274 * ( N.x * N.x - N.y * N.y );
+    return max( result, 0 );
+}
+
+LightResult DoEnvironmentLighting( float3 P, float3 N, float specularPower )
+{
+    LightResult result;
+    float3 V = normalize( -P );
+    float3 R = reflect( -V, N );
+
+    float3 NWS = normalize( mul( (float3x3)EnvironmentCB.InverseViewMatrix, N ) );
+    float3 RWS = normalize( mul( (float3x3)EnvironmentCB.InverseViewMatrix, R ) );
+
+    float roughness = sqrt( 2.0 / ( specularPower + 2.0 ) );
+    float mip = roughness * ( EnvironmentCB.SpecularMipLevels - 1.0 );
+
+    result.Diffuse = float4( DoIrradiance( NWS ), 1.0 ) * EnvironmentCB.Intensity;
+    result.Specular = SpecularCubemap.SampleLevel( LinearRepeatSampler, RWS, mip ) * EnvironmentCB.Intensity;
+
+    return result;
+}
+
+uint2 GetLightCluster( float3 P, float2 screenPosition )
+{
+    uint3 clusterCount = uint3( LightPropertiesCB.ClusterCountX, LightPropertiesCB.ClusterCountY, LightPropertiesCB.ClusterCountZ );
+    uint3 cluster;
+    cluster.xy = min( uint2( screenPosition * LightPropertiesCB.InverseScreenSize * clusterCount.xy ), clusterCount.xy - 1 );
+    cluster.z = uint( clamp( log( P.z ) * LightPropertiesCB.ClusterDepthScale + LightPropertiesCB.ClusterDepthBias, 0.0, clusterCount.z - 1.0 ) );
+
+    return LightClusters[cluster.x + clusterCount.x * ( cluster.y + clusterCount.y * cluster.z )];
+}
+
+LightResult DoLighting( float3 P, float3 N, float specularPower, float2 screenPosition )
 {
     uint i;
 
+    uint2 cluster = GetLightCluster( P, screenPosition );
+    uint offset = cluster.x;
+    uint numPointLights = cluster.y & 0xffff;
+    uint numSpotLights = cluster.y >> 16;
 
     float3 V = normalize( -P );
 
     LightResult totalResult = (LightResult)0;
 
-    for ( i = 0; i < LightPropertiesCB.NumPointLights; ++i )
+    for ( i = 0; i < numPointLights; ++i )
     {
-        LightResult result = DoPointLight( PointLights[i], V, P, N );
+        LightResult result = DoPointLight( PointLights[LightIndices[offset + i]], V, P, N, specularPower );
 
         totalResult.Diffuse += result.Diffuse;
         totalResult.Specular += result.Specular;
     }
 
-    for ( i = 0; i < LightPropertiesCB.NumSpotLights; ++i )
+    for ( i = 0; i < numSpotLights; ++i )
     {
-        LightResult result = DoSpotLight( SpotLights[i], V, P, N );
+        LightResult result = DoSpotLight( SpotLights[LightIndices[offset + numPointLights + i]], V, P, N, specularPower );
 
         totalResult.Diffuse += result.Diffuse;
         totalResult.Specular += result.Specular;
@@ -154,13 +220,18 @@ LightResult DoLighting( float3 P, float3 N )
 
 float4 main( PixelShaderInput IN ) : SV_Target
 {
-    LightResult lit = DoLighting( IN.PositionVS.xyz, normalize( IN.NormalVS ) );
-
-    float4 emissive = MaterialCB.Emissive;
-    float4 ambient = MaterialCB.Ambient;
-    float4 diffuse = MaterialCB.Diffuse * lit.Diffuse;
-    float4 specular = MaterialCB.Specular * lit.Specular;
-    float4 texColor = DiffuseTexture.Sample( LinearRepeatSampler, IN.TexCoord );
+    Material material = Materials[IN.MaterialIndex];
+
+    float3 N = normalize( IN.NormalVS );
+    LightResult lit = DoLighting( IN.PositionVS.xyz, N, material.SpecularPower, IN.Position.xy );
+    LightResult environment = DoEnvironmentLighting( IN.PositionVS.xyz, N, material.SpecularPower );
+
+    float4 emissive = material.Emissive;
+    float4 ambient = material.Ambient;
+    float4 diffuse = material.Diffuse * ( lit.Diffuse + environment.Diffuse );
+    float4 specular = material.Specular * ( lit.Specular + environment.Specular );
+    float2 texCoord = IN.TexCoord * material.TextureScaleOffset.xy + material.TextureScaleOffset.zw;
+    float4 texColor = DiffuseTexture.Sample( LinearRepeatSampler, texCoord );
 
     return ( emissive + ambient + diffuse + specular ) * texColor;
 }
\ No newline at end of file
@@ -6,31 +6,75 @@ struct Mat
     matrix ModelViewProjectionMatrix;
 };
 
-ConstantBuffer<Mat> MatCB : register(b0);
+struct ObjectData
+{
+    Mat Matrices;
+    uint MaterialIndex;
+    uint3 Padding;
+};
+
+struct DrawConstants
+{
+    uint ObjectIndex;
+};
+
+ConstantBuffer<DrawConstants> DrawCB : register(b0);
+StructuredBuffer<ObjectData> Objects : register(t0, space1);
+
+#ifdef QUANTIZED_VERTEX
+struct VertexPositionNormalTexture
+{
+    float4 Position : POSITION;
+    float2 Normal   : NORMAL;
+    float2 TexCoord : TEXCOORD;
+};
 
+float3 OctahedralDecode( float2 e )
+{
+    float3 n = float3( e.x, e.y, 1.0f - abs( e.x ) - abs( e.y ) );
+    if ( n.z < 0.0f )
+    {
+        n.xy = ( 1.0f - abs( n.yx ) ) * ( n.xy >= 0.0f ? 1.0f : -1.0f );
+    }
+    return normalize( n );
+}
+#else
 struct VertexPositionNormalTexture
 {
     float3 Position : POSITION;
     float3 Normal   : NORMAL;
     float2 TexCoord : TEXCOORD;
 };
+#endif
 
 struct VertexShaderOutput
 {
     float4 PositionVS : POSITION;
     float3 NormalVS   : NORMAL;
     float2 TexCoord   : TEXCOORD;
+    nointerpolation uint MaterialIndex : MATERIAL;
     float4 Position   : SV_Position;
 };
 
-VertexShaderOutput main(VertexPositionNormalTexture IN)
+VertexShaderOutput main(VertexPositionNormalTexture IN, uint InstanceID : SV_InstanceID)
 {
     VertexShaderOutput OUT;
 
-    OUT.Position = mul( MatCB.ModelViewProjectionMatrix, float4(IN.Position, 1.0f));
-    OUT.PositionVS = mul( MatCB.ModelViewMatrix, float4(IN.Position, 1.0f));
-    OUT.NormalVS = mul((float3x3)MatCB.InverseTransposeModelViewMatrix, IN.Normal);
+#ifdef QUANTIZED_VERTEX
+    float3 position = IN.Position.xyz;
+    float3 normal = OctahedralDecode( IN.Normal );
+#else
+    float3 position = IN.Position;
+    float3 normal = IN.Normal;
+#endif
+
+    ObjectData object = Objects[DrawCB.ObjectIndex + InstanceID];
+
+    OUT.Position = mul( object.Matrices.ModelViewProjectionMatrix, float4(position, 1.0f));
+    OUT.PositionVS = mul( object.Matrices.ModelViewMatrix, float4(position, 1.0f));
+    OUT.NormalVS = mul((float3x3)object.Matrices.InverseTransposeModelViewMatrix, normal);
     OUT.TexCoord = IN.TexCoord;
+    OUT.MaterialIndex = object.MaterialIndex;
 
     return OUT;
 }
\ No newline at end of file
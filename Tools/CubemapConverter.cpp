@@ -0,0 +1,225 @@
+// Bakes an equirectangular panorama into a cubemap .dds on the CPU, the same bake CubemapCache
+// runs on a cache miss.
+//
+//   CubemapConverter <input.hdr> <output.dds> [-size <n>] [-mips <n>] [-format rgba8|rgba8srgb|rgba16f|rgba32f]
+//
+// Reads Radiance .hdr panoramas, flat or run-length encoded. Mips default to the full chain,
+// -mips 1 writes the top level only.
+
+#include "CubemapBaker.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+	void PrintUsage()
+	{
+		printf("usage: CubemapConverter <input.hdr> <output.dds> [-size <n>] [-mips <n>] [-format rgba8|rgba8srgb|rgba16f|rgba32f]\n");
+	}
+
+	bool ParseFormat(const char* name, CubemapFormat& format)
+	{
+		const std::pair<const char*, CubemapFormat> formats[] =
+		{
+			{ "rgba8", CubemapFormat::RGBA8_UNORM },
+			{ "rgba8srgb", CubemapFormat::RGBA8_UNORM_SRGB },
+			{ "rgba16f", CubemapFormat::RGBA16_FLOAT },
+			{ "rgba32f", CubemapFormat::RGBA32_FLOAT },
+		};
+		for (const auto& entry : formats)
+		{
+			if (std::strcmp(name, entry.first) == 0)
+			{
+				format = entry.second;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ReadScanline(std::ifstream& file, uint32_t width, std::vector<uint8_t>& rgbe)
+	{
+		rgbe.resize(static_cast<size_t>(width) * 4);
+		uint8_t head[4];
+		if (!file.read(reinterpret_cast<char*>(head), 4))
+		{
+			return false;
+		}
+
+		// New-style run-length scanlines start with 2, 2 and the width; anything else is flat.
+		if (width < 8 || width > 0x7FFF || head[0] != 2 || head[1] != 2 || (head[2] & 0x80) != 0)
+		{
+			memcpy(rgbe.data(), head, 4);
+			return static_cast<bool>(file.read(reinterpret_cast<char*>(rgbe.data() + 4), rgbe.size() - 4));
+		}
+		if ((static_cast<uint32_t>(head[2]) << 8 | head[3]) != width)
+		{
+			return false;
+		}
+
+		// Each of the four channels is run-length encoded separately.
+		for (uint32_t channel = 0; channel < 4; ++channel)
+		{
+			uint32_t x = 0;
+			while (x < width)
+			{
+				uint8_t count = 0;
+				if (!file.read(reinterpret_cast<char*>(&count), 1))
+				{
+					return false;
+				}
+
+				if (count > 128)
+				{
+					count -= 128;
+					uint8_t value = 0;
+					if (count > width - x || !file.read(reinterpret_cast<char*>(&value), 1))
+					{
+						return false;
+					}
+					for (uint8_t i = 0; i < count; ++i, ++x)
+					{
+						rgbe[x * 4 + channel] = value;
+					}
+				}
+				else
+				{
+					if (count == 0 || count > width - x)
+					{
+						return false;
+					}
+					for (uint8_t i = 0; i < count; ++i, ++x)
+					{
+						char value = 0;
+						if (!file.read(&value, 1))
+						{
+							return false;
+						}
+						rgbe[x * 4 + channel] = static_cast<uint8_t>(value);
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	PanoramaImage LoadHDR(const char* fileName)
+	{
+		std::ifstream file(fileName, std::ios::binary);
+		if (!file)
+		{
+			throw std::runtime_error("File not found.");
+		}
+
+		std::string line;
+		if (!std::getline(file, line) || (line != "#?RADIANCE" && line != "#?RGBE"))
+		{
+			throw std::runtime_error("Not a Radiance HDR file.");
+		}
+		while (std::getline(file, line) && !line.empty())
+		{
+			if (line.compare(0, 7, "FORMAT=") == 0 && line != "FORMAT=32-bit_rle_rgbe")
+			{
+				throw std::runtime_error("Unsupported HDR pixel format.");
+			}
+		}
+
+		// Only the standard orientation, top row first and left to right.
+		char resolution[64] = {};
+		int height = 0;
+		int width = 0;
+		if (!std::getline(file, line) || sscanf(line.c_str(), "-Y %d +X %d%63s", &height, &width, resolution) != 2 || width <= 0 || height <= 0)
+		{
+			throw std::runtime_error("Unsupported HDR resolution line.");
+		}
+
+		PanoramaImage pano;
+		pano.Width = static_cast<uint32_t>(width);
+		pano.Height = static_cast<uint32_t>(height);
+		pano.Texels.resize(static_cast<size_t>(pano.Width) * pano.Height);
+
+		std::vector<uint8_t> rgbe;
+		for (uint32_t y = 0; y < pano.Height; ++y)
+		{
+			if (!ReadScanline(file, pano.Width, rgbe))
+			{
+				throw std::runtime_error("Truncated or corrupt HDR scanline.");
+			}
+
+			DirectX::XMFLOAT4* row = &pano.Texels[static_cast<size_t>(y) * pano.Width];
+			for (uint32_t x = 0; x < pano.Width; ++x)
+			{
+				const uint8_t* texel = &rgbe[x * 4];
+				float scale = texel[3] == 0 ? 0.0f : std::ldexp(1.0f, texel[3] - (128 + 8));
+				row[x] = DirectX::XMFLOAT4(texel[0] * scale, texel[1] * scale, texel[2] * scale, 1.0f);
+			}
+		}
+		return pano;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	uint32_t size = 1024;
+	uint32_t mipLevels = 0;
+	CubemapFormat format = CubemapFormat::RGBA8_UNORM;
+	for (int i = 3; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-size") == 0 && i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+		{
+			size = static_cast<uint32_t>(std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "-mips") == 0 && i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+		{
+			mipLevels = static_cast<uint32_t>(std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "-format") == 0 && i + 1 < argc && ParseFormat(argv[i + 1], format))
+		{
+			++i;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	try
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		PanoramaImage pano = LoadHDR(argv[1]);
+		double loadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		start = std::chrono::high_resolution_clock::now();
+		CubemapImage cubemap = CubemapBaker::PanoToCubemap(pano, size, mipLevels);
+		double bakeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		if (!CubemapBaker::SaveToDDS(argv[2], cubemap, format))
+		{
+			printf("%s: failed to write cubemap\n", argv[2]);
+			return 1;
+		}
+
+		printf("%s: %ux%u panorama, load %.2f ms\n", argv[1], pano.Width, pano.Height, loadMilliseconds);
+		printf("%s: %u cubemap, %u mips, bake %.2f ms\n", argv[2], cubemap.GetSize(), cubemap.GetMipLevels(), bakeMilliseconds);
+	}
+	catch (const std::exception& e)
+	{
+		printf("%s: %s\n", argv[1], e.what());
+		return 1;
+	}
+
+	return 0;
+}
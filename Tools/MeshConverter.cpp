@@ -0,0 +1,98 @@
+// Bakes an OBJ or glTF model into a .mesh file that Mesh::CreateFromFile maps directly.
+//
+//   MeshConverter <input.obj|.gltf|.glb> <output.mesh> [-quantized] [-rh]
+//
+// All primitives are merged into one mesh. Without -rh the model is converted to the
+// renderer's left-handed convention by the importer.
+
+#include "Mesh.h"
+#include "MeshFile.h"
+#include "ModelImporter.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	void PrintUsage()
+	{
+		printf("usage: MeshConverter <input.obj|.gltf|.glb> <output.mesh> [-quantized] [-rh]\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	VertexFormat format = VertexFormat::Float;
+	bool rhcoords = false;
+	for (int i = 3; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-quantized") == 0)
+		{
+			format = VertexFormat::Quantized;
+		}
+		else if (std::strcmp(argv[i], "-rh") == 0)
+		{
+			rhcoords = true;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	try
+	{
+		ImportStatistics statistics = {};
+		std::vector<ImportedPrimitive> primitives = ModelImporter::Import(fs::path(argv[1]).wstring(), &statistics, rhcoords);
+
+		VertexCollection vertices;
+		IndexCollection indices;
+		for (const ImportedPrimitive& primitive : primitives)
+		{
+			uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
+			vertices.insert(vertices.end(), primitive.Vertices.begin(), primitive.Vertices.end());
+			for (uint32_t index : primitive.Indices)
+			{
+				indices.push_back(baseVertex + index);
+			}
+		}
+
+		if (indices.empty())
+		{
+			printf("%s: no triangles to convert\n", argv[1]);
+			return 1;
+		}
+
+		// The importer already produced the target convention, so Convert must leave the winding alone.
+		auto start = std::chrono::high_resolution_clock::now();
+		Mesh::Convert(fs::path(argv[2]).wstring(), vertices, indices, true, format);
+		double convertMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		MeshFile file;
+		if (!file.Open(fs::path(argv[2]).wstring()))
+		{
+			printf("%s: written file does not validate\n", argv[2]);
+			return 1;
+		}
+
+		const MeshFileHeader& header = file.GetHeader();
+		printf("%s: %u primitives, %u vertices (%u welded), %u indices, parse %.2f ms\n", argv[1],
+			   statistics.PrimitiveNum, statistics.VertexNum, statistics.WeldedVertexNum, statistics.IndexNum, statistics.ParseMilliseconds);
+		printf("%s: %u vertices, %u-bit indices, %u LODs, %u meshlets, convert %.2f ms\n", argv[2],
+			   header.VertexCount, header.IndexSize * 8, header.LodCount, header.MeshletCount, convertMilliseconds);
+	}
+	catch (const std::exception& e)
+	{
+		printf("%s: %s\n", argv[1], e.what());
+		return 1;
+	}
+
+	return 0;
+}
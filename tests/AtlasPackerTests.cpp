@@ -0,0 +1,222 @@
+#include "AtlasPacker.h"
+#include "TestHarness.h"
+
+#include <random>
+
+namespace
+{
+	std::vector<AtlasRect> CreateSizes(size_t count, uint32_t maxSize, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<uint32_t> size(1, maxSize);
+
+		std::vector<AtlasRect> sizes(count);
+		for (AtlasRect& rect : sizes)
+		{
+			rect = { 0, 0, size(random), size(random) };
+		}
+		return sizes;
+	}
+
+	bool Overlaps(const AtlasRect& a, const AtlasRect& b)
+	{
+		return a.X < b.X + b.Width && b.X < a.X + a.Width && a.Y < b.Y + b.Height && b.Y < a.Y + a.Height;
+	}
+
+	void CheckLayout(const AtlasLayout& layout, const std::vector<AtlasRect>& sizes)
+	{
+		uint32_t blockSize = 1u << (layout.MipLevels - 1);
+		CHECK_EQUAL(sizes.size(), layout.Regions.size());
+		for (size_t i = 0; i < layout.Regions.size(); ++i)
+		{
+			const AtlasLayout::Region& region = layout.Regions[i];
+			const AtlasRect& rect = region.Rect;
+			CHECK(region.AtlasIndex < layout.AtlasNum);
+
+			// Inside the atlas, with room for the texture and its gutter on every side.
+			CHECK(rect.X + rect.Width <= layout.AtlasSize);
+			CHECK(rect.Y + rect.Height <= layout.AtlasSize);
+			CHECK(sizes[i].Width + 2 * layout.Gutter <= rect.Width);
+			CHECK(sizes[i].Height + 2 * layout.Gutter <= rect.Height);
+
+			// Aligned to whole blocks of the last mip, so downsampling never averages two regions.
+			CHECK_EQUAL(0u, rect.X % blockSize);
+			CHECK_EQUAL(0u, rect.Y % blockSize);
+			CHECK_EQUAL(0u, rect.Width % blockSize);
+			CHECK_EQUAL(0u, rect.Height % blockSize);
+
+			for (size_t j = 0; j < i; ++j)
+			{
+				if (layout.Regions[j].AtlasIndex == region.AtlasIndex)
+				{
+					CHECK(!Overlaps(rect, layout.Regions[j].Rect));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE(SkylinePackerFillsWithoutOverlap)
+{
+	SkylinePacker packer(128, 128);
+	std::vector<AtlasRect> rects;
+	for (const AtlasRect& size : CreateSizes(200, 24, 1))
+	{
+		AtlasRect rect;
+		if (!packer.Insert(size.Width, size.Height, rect)) continue;
+		CHECK_EQUAL(size.Width, rect.Width);
+		CHECK_EQUAL(size.Height, rect.Height);
+		CHECK(rect.X + rect.Width <= 128 && rect.Y + rect.Height <= 128);
+		for (const AtlasRect& other : rects)
+		{
+			CHECK(!Overlaps(rect, other));
+		}
+		rects.push_back(rect);
+	}
+	CHECK(packer.GetOccupancy() > 0.7f);
+
+	AtlasRect rect;
+	CHECK(!packer.Insert(129, 1, rect));
+}
+
+TEST_CASE(PackedRegionsAreAlignedAndDisjoint)
+{
+	for (uint32_t mipLevels : { 1, 3, 5 })
+	{
+		std::vector<AtlasRect> sizes = CreateSizes(150, 100, mipLevels);
+		AtlasLayout layout = AtlasBuilder::Pack(sizes, 4096, 2, mipLevels);
+		CHECK_EQUAL(1u, layout.AtlasNum);
+		CHECK_EQUAL(mipLevels, layout.MipLevels);
+		CHECK(layout.Gutter >= 2);
+		CHECK(layout.Gutter >= (1u << (mipLevels - 1)) / 2);
+		CheckLayout(layout, sizes);
+	}
+
+	AtlasLayout empty = AtlasBuilder::Pack({}, 1024, 0, 1);
+	CHECK_EQUAL(0u, empty.AtlasNum);
+	CHECK_THROWS(AtlasBuilder::Pack({ { 0, 0, 2000, 10 } }, 1024, 0, 1));
+}
+
+TEST_CASE(ScaleOffsetMapsToUngutteredTexels)
+{
+	std::vector<AtlasRect> sizes = CreateSizes(40, 64, 7);
+	AtlasLayout layout = AtlasBuilder::Pack(sizes, 2048, 3, 4);
+	for (size_t i = 0; i < sizes.size(); ++i)
+	{
+		const AtlasLayout::Region& region = layout.Regions[i];
+		// uv * scale + offset: uv 0 lands on the first texel past the gutter, uv 1 on the far edge of the texture.
+		float size = static_cast<float>(layout.AtlasSize);
+		CHECK_NEAR(region.Rect.X + layout.Gutter, region.ScaleOffset.z * size, 1e-3);
+		CHECK_NEAR(region.Rect.Y + layout.Gutter, region.ScaleOffset.w * size, 1e-3);
+		CHECK_NEAR(region.Rect.X + layout.Gutter + sizes[i].Width, (region.ScaleOffset.x + region.ScaleOffset.z) * size, 1e-3);
+		CHECK_NEAR(region.Rect.Y + layout.Gutter + sizes[i].Height, (region.ScaleOffset.y + region.ScaleOffset.w) * size, 1e-3);
+	}
+}
+
+TEST_CASE(SpillsIntoMoreAtlasesAtMaxSize)
+{
+	std::vector<AtlasRect> sizes = CreateSizes(300, 120, 11);
+	AtlasLayout layout = AtlasBuilder::Pack(sizes, 512, 1, 2);
+	CHECK_EQUAL(512u, layout.AtlasSize);
+	CHECK(layout.AtlasNum > 1);
+	CheckLayout(layout, sizes);
+}
+
+TEST_CASE(SpillReusesEarlierAtlases)
+{
+	// Two tall blocks fill an atlas each and leave a 56 texel strip; the two short ones belong in
+	// those strips, not in a third atlas.
+	std::vector<AtlasRect> sizes = { { 0, 0, 256, 200 }, { 0, 0, 256, 200 }, { 0, 0, 256, 50 }, { 0, 0, 256, 50 } };
+	AtlasLayout layout = AtlasBuilder::Pack(sizes, 256, 0, 1);
+	CHECK_EQUAL(2u, layout.AtlasNum);
+	CHECK(layout.Regions[2].AtlasIndex != layout.Regions[3].AtlasIndex);
+	CheckLayout(layout, sizes);
+}
+
+TEST_CASE(BlitClampsEdgesIntoGutter)
+{
+	const uint32_t width = 4, height = 3, gutter = 2;
+	std::vector<uint32_t> texels(width * height);
+	for (uint32_t i = 0; i < texels.size(); ++i)
+	{
+		texels[i] = 100 + i;
+	}
+
+	const uint32_t atlasSize = 16;
+	std::vector<uint32_t> atlas(atlasSize * atlasSize, 0);
+	AtlasRect rect = { 4, 2, width + 2 * gutter, height + 2 * gutter };
+	AtlasBuilder::Blit(texels.data(), width, height, atlas.data(), atlasSize, rect, gutter);
+
+	for (uint32_t y = 0; y < atlasSize; ++y)
+	{
+		for (uint32_t x = 0; x < atlasSize; ++x)
+		{
+			uint32_t value = atlas[y * atlasSize + x];
+			bool inside = x >= rect.X && x < rect.X + rect.Width && y >= rect.Y && y < rect.Y + rect.Height;
+			if (!inside)
+			{
+				CHECK_EQUAL(0u, value);
+				continue;
+			}
+
+			int32_t srcX = std::min(std::max(static_cast<int32_t>(x - rect.X) - static_cast<int32_t>(gutter), 0), static_cast<int32_t>(width) - 1);
+			int32_t srcY = std::min(std::max(static_cast<int32_t>(y - rect.Y) - static_cast<int32_t>(gutter), 0), static_cast<int32_t>(height) - 1);
+			CHECK_EQUAL(texels[srcY * width + srcX], value);
+		}
+	}
+
+	// Spot checks: the gutter corner repeats the corner texel, the texture itself is copied unchanged.
+	CHECK_EQUAL(texels[0], atlas[rect.Y * atlasSize + rect.X]);
+	CHECK_EQUAL(texels[width * height - 1], atlas[(rect.Y + rect.Height - 1) * atlasSize + rect.X + rect.Width - 1]);
+	CHECK_EQUAL(texels[1 * width + 2], atlas[(rect.Y + gutter + 1) * atlasSize + rect.X + gutter + 2]);
+}
+
+TEST_CASE(GenerateMipsDimensions)
+{
+	std::vector<uint32_t> atlas(64 * 64, 0x10203040);
+	std::vector<std::vector<uint32_t>> mips = AtlasBuilder::GenerateMips(atlas, 64, 4);
+	CHECK_EQUAL(4u, mips.size());
+	for (uint32_t mip = 0; mip < mips.size(); ++mip)
+	{
+		CHECK_EQUAL(static_cast<size_t>((64 >> mip) * (64 >> mip)), mips[mip].size());
+		CHECK(std::all_of(mips[mip].begin(), mips[mip].end(), [](uint32_t texel) { return texel == 0x10203040; }));
+	}
+
+	// The chain stops at 1x1 however many levels are asked for.
+	CHECK_EQUAL(7u, AtlasBuilder::GenerateMips(atlas, 64, 20).size());
+}
+
+TEST_CASE(MipsNeverMixRegions)
+{
+	const uint32_t MipLevels = 4;
+	std::vector<AtlasRect> sizes = CreateSizes(30, 40, 5);
+	AtlasLayout layout = AtlasBuilder::Pack(sizes, 1024, 0, MipLevels);
+	CHECK_EQUAL(1u, layout.AtlasNum);
+
+	// Each region a solid colour; every mip texel inside a region must keep exactly that colour.
+	std::vector<uint32_t> atlas(static_cast<size_t>(layout.AtlasSize) * layout.AtlasSize, 0);
+	for (size_t i = 0; i < sizes.size(); ++i)
+	{
+		std::vector<uint32_t> texels(sizes[i].Width * sizes[i].Height, 0xFF000000 | static_cast<uint32_t>(i * 0x050A0F));
+		AtlasBuilder::Blit(texels.data(), sizes[i].Width, sizes[i].Height, atlas.data(), layout.AtlasSize, layout.Regions[i].Rect, layout.Gutter);
+	}
+
+	std::vector<std::vector<uint32_t>> mips = AtlasBuilder::GenerateMips(atlas, layout.AtlasSize, MipLevels);
+	CHECK_EQUAL(MipLevels, mips.size());
+	for (size_t i = 0; i < sizes.size(); ++i)
+	{
+		uint32_t color = 0xFF000000 | static_cast<uint32_t>(i * 0x050A0F);
+		const AtlasRect& rect = layout.Regions[i].Rect;
+		for (uint32_t mip = 0; mip < MipLevels; ++mip)
+		{
+			uint32_t mipSize = layout.AtlasSize >> mip;
+			for (uint32_t y = rect.Y >> mip; y < (rect.Y + rect.Height) >> mip; ++y)
+			{
+				for (uint32_t x = rect.X >> mip; x < (rect.X + rect.Width) >> mip; ++x)
+				{
+					CHECK_EQUAL(color, mips[mip][y * mipSize + x]);
+				}
+			}
+		}
+	}
+}
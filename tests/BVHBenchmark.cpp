@@ -0,0 +1,159 @@
+#include "BVH.h"
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+#include "Meshlet.h"
+#include "TestHarness.h"
+
+#include <cfloat>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	// Same min/max plane test the BVH applies to leaf objects.
+	bool IsInsidePlanes(const XMFLOAT4 planes[6], const BoundingBox& box)
+	{
+		XMFLOAT3 min(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+		XMFLOAT3 max(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+		for (int i = 0; i < 6; ++i)
+		{
+			const XMFLOAT4& plane = planes[i];
+			float distance = plane.x * (min.x + max.x) * 0.5f + plane.y * (min.y + max.y) * 0.5f + plane.z * (min.z + max.z) * 0.5f + plane.w;
+			float radius = std::fabs(plane.x) * (max.x - min.x) * 0.5f + std::fabs(plane.y) * (max.y - min.y) * 0.5f + std::fabs(plane.z) * (max.z - min.z) * 0.5f;
+			if (distance + radius < 0.0f) return false;
+		}
+		return true;
+	}
+
+	uint32_t CountMismatches(const XMFLOAT4 planes[6], const std::vector<BoundingBox>& boxes, std::vector<uint32_t> visible)
+	{
+		std::vector<uint32_t> expected;
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			if (IsInsidePlanes(planes, boxes[i])) expected.push_back(i);
+		}
+
+		std::sort(visible.begin(), visible.end());
+		if (visible.size() != expected.size()) return static_cast<uint32_t>(std::max(visible.size(), expected.size()));
+
+		uint32_t mismatchNum = 0;
+		for (size_t i = 0; i < visible.size(); ++i)
+		{
+			if (visible[i] != expected[i]) ++mismatchNum;
+		}
+		return mismatchNum;
+	}
+
+	// Brute-force slab test against every box; distance is 0 when the origin is inside.
+	float NearestHit(const std::vector<BoundingBox>& boxes, const XMFLOAT3& origin, const XMFLOAT3& direction)
+	{
+		const float rayOrigin[3] = { origin.x, origin.y, origin.z };
+		const float rayDirection[3] = { direction.x, direction.y, direction.z };
+
+		float nearest = FLT_MAX;
+		for (const BoundingBox& box : boxes)
+		{
+			const float center[3] = { box.Center.x, box.Center.y, box.Center.z };
+			const float extents[3] = { box.Extents.x, box.Extents.y, box.Extents.z };
+			float tMin = 0.0f;
+			float tMax = nearest;
+			for (int i = 0; i < 3; ++i)
+			{
+				float t0 = (center[i] - extents[i] - rayOrigin[i]) / rayDirection[i];
+				float t1 = (center[i] + extents[i] - rayOrigin[i]) / rayDirection[i];
+				tMin = std::max(tMin, std::min(t0, t1));
+				tMax = std::min(tMax, std::max(t0, t1));
+			}
+			if (tMin <= tMax) nearest = tMin;
+		}
+		return nearest;
+	}
+}
+
+TEST_CASE(BuildRefitAndQueryUpToOneMillionObjects)
+{
+	XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 5.0f, -20.0f, 1.0f), XMVectorSet(10.0f, 0.0f, 30.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	XMMATRIX projection = XMMatrixPerspectiveFovLH(XMConvertToRadians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+	XMFLOAT4X4 viewProjection;
+	XMStoreFloat4x4(&viewProjection, view * projection);
+	XMFLOAT4 planes[6];
+	MeshletCuller::ExtractFrustumPlanes(viewProjection, planes);
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-120.0f, 120.0f);
+	std::uniform_real_distribution<float> extent(0.05f, 6.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	const uint32_t RayNum = 1000;
+	const uint32_t CheckedRayNum = 32;
+
+	printf("%8s %9s %6s %9s %9s %10s %8s %12s %8s\n", "objects", "build ms", "depth", "refit ms", "cull ms", "flat ms", "visible", "1k rays ms", "exact");
+	for (size_t objectNum : { 1000, 10000, 100000, 1000000 })
+	{
+		std::vector<BoundingBox> boxes(objectNum);
+		for (BoundingBox& box : boxes)
+		{
+			box = BoundingBox(XMFLOAT3(position(random), position(random) * 0.25f, position(random)), XMFLOAT3(extent(random), extent(random), extent(random)));
+		}
+
+		BVH bvh;
+		double buildTime = Test::Measure(3, [&]() { bvh.Build(boxes); });
+
+		// Every object moves a little each frame, as animated scene objects do.
+		std::vector<BoundingBox> moved = boxes;
+		int frame = 0;
+		double refitTime = Test::Measure(3, [&]()
+		{
+			float offset = (++frame % 2) ? 0.25f : -0.25f;
+			for (uint32_t i = 0; i < objectNum; ++i)
+			{
+				moved[i].Center.x = boxes[i].Center.x + offset;
+				bvh.UpdateObject(i, moved[i]);
+			}
+		});
+
+		std::vector<uint32_t> visible;
+		visible.reserve(objectNum);
+		double cullTime = Test::Measure(10, [&]() { bvh.CullFrustum(planes, visible); });
+		uint32_t mismatchNum = CountMismatches(planes, moved, visible);
+
+		FrustumCuller culler;
+		culler.Reserve(objectNum);
+		for (const BoundingBox& box : moved)
+		{
+			culler.AddObject(box);
+		}
+		std::vector<uint32_t> flatVisible;
+		flatVisible.reserve(objectNum);
+		double flatTime = Test::Measure(10, [&]() { culler.Cull(planes, flatVisible); });
+
+		std::vector<XMFLOAT3> directions(RayNum);
+		for (XMFLOAT3& direction : directions)
+		{
+			XMStoreFloat3(&direction, XMVector3Normalize(XMVectorSet(unit(random), unit(random) * 0.25f, unit(random), 0.0f)));
+		}
+		XMFLOAT3 origin(0.0f, 5.0f, -20.0f);
+		std::vector<BVH::RayHit> hits(RayNum);
+		double rayTime = Test::Measure(3, [&]()
+		{
+			for (uint32_t i = 0; i < RayNum; ++i)
+			{
+				bvh.Raycast(XMLoadFloat3(&origin), XMLoadFloat3(&directions[i]), FLT_MAX, hits[i]);
+			}
+		});
+
+		for (uint32_t i = 0; i < CheckedRayNum; ++i)
+		{
+			float expected = NearestHit(moved, origin, directions[i]);
+			CHECK_EQUAL(expected < FLT_MAX, hits[i].Object != BVH::InvalidObject);
+			if (expected < FLT_MAX) CHECK_NEAR(expected, hits[i].Distance, 1e-3);
+		}
+
+		BVH::Statistics statistics = bvh.GetStatistics();
+		printf("%8zu %9.3f %6u %9.3f %9.3f %10.3f %8u %12.3f %8s\n", objectNum, buildTime, statistics.MaxDepth, refitTime, cullTime, flatTime, statistics.VisibleNum, rayTime, mismatchNum == 0 ? "yes" : "no");
+		CHECK_EQUAL(0u, mismatchNum);
+		CHECK_EQUAL(flatVisible.size(), visible.size());
+	}
+	printf("%u job system workers\n", JobSystem::Get().GetWorkerCount() + 1);
+}
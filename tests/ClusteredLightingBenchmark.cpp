@@ -0,0 +1,52 @@
+#include "ClusteredLighting.h"
+#include "JobSystem.h"
+#include "TestHarness.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	// Lights spread through and around a 45 degree frustum, half of them spots, a few unbounded.
+	void AddLights(ClusteredLighting& lighting, uint32_t lightNum)
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		lighting.Clear();
+		for (uint32_t i = 0; i < lightNum; ++i)
+		{
+			XMVECTOR position = XMVectorSet((unit(random) - 0.5f) * 120.0f, (unit(random) - 0.5f) * 60.0f, unit(random) * 110.0f - 5.0f, 1.0f);
+			float range = unit(random) < 0.002f ? FLT_MAX : 0.5f + unit(random) * 6.0f;
+			if (i % 2 == 0)
+			{
+				lighting.AddPointLight(position, range);
+			}
+			else
+			{
+				XMVECTOR direction = XMVectorSet(unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f, 0.0f);
+				float angle = unit(random) < 0.1f ? 1.8f : 0.1f + unit(random) * 1.3f;
+				lighting.AddSpotLight(position, direction, angle, range);
+			}
+		}
+	}
+}
+
+TEST_CASE(BinTenThousandLights)
+{
+	ClusteredLighting lighting;
+	lighting.SetProjection(XMConvertToRadians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+	for (uint32_t lightNum : { 1000u, 10000u, 60000u })
+	{
+		AddLights(lighting, lightNum);
+		lighting.Bin();
+
+		double best = Test::Measure(10, [&]() { lighting.Bin(); });
+		ClusteredLighting::Statistics statistics = lighting.GetStatistics();
+		printf("%6u lights: bin %.3f ms (best of 10, %u workers), %u indices, max %u per cluster\n",
+			   lightNum, best, JobSystem::Get().GetWorkerCount() + 1, statistics.IndexNum, statistics.MaxClusterLightNum);
+		CHECK_EQUAL(lightNum, statistics.LightNum);
+	}
+}
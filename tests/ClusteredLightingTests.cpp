@@ -0,0 +1,325 @@
+#include "ClusteredLighting.h"
+#include "TestHarness.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	const float FovY = XMConvertToRadians(45.0f);
+	const float AspectRatio = 16.0f / 9.0f;
+	const float NearClip = 0.1f;
+	const float FarClip = 100.0f;
+
+	struct TestLight
+	{
+		XMFLOAT3 Position;
+		XMFLOAT3 Direction;
+		float SpotAngle;
+		float Range;
+	};
+
+	struct Scene
+	{
+		std::vector<TestLight> PointLights;
+		std::vector<TestLight> SpotLights;
+	};
+
+	void Bin(ClusteredLighting& lighting, const Scene& scene)
+	{
+		lighting.SetProjection(FovY, AspectRatio, NearClip, FarClip);
+		lighting.Clear();
+		for (const TestLight& light : scene.PointLights)
+		{
+			lighting.AddPointLight(XMLoadFloat3(&light.Position), light.Range);
+		}
+		for (const TestLight& light : scene.SpotLights)
+		{
+			lighting.AddSpotLight(XMLoadFloat3(&light.Position), XMLoadFloat3(&light.Direction), light.SpotAngle, light.Range);
+		}
+		lighting.Bin();
+	}
+
+	// GetLightCluster in HDR_PS.hlsl, with the screen position as a 0-1 fraction.
+	uint32_t GetShaderCluster(const ClusteredLighting& lighting, float screenX, float screenY, float depth)
+	{
+		uint32_t x = std::min(static_cast<uint32_t>(screenX * ClusteredLighting::ClusterCountX), ClusteredLighting::ClusterCountX - 1);
+		uint32_t y = std::min(static_cast<uint32_t>(screenY * ClusteredLighting::ClusterCountY), ClusteredLighting::ClusterCountY - 1);
+		float slice = std::log(depth) * lighting.GetDepthScale() + lighting.GetDepthBias();
+		uint32_t z = static_cast<uint32_t>(std::min(std::max(slice, 0.0f), ClusteredLighting::ClusterCountZ - 1.0f));
+		return x + ClusteredLighting::ClusterCountX * (y + ClusteredLighting::ClusterCountY * z);
+	}
+
+	bool IsLit(const TestLight& light, const XMFLOAT3& point, bool spot)
+	{
+		double dx = point.x - light.Position.x;
+		double dy = point.y - light.Position.y;
+		double dz = point.z - light.Position.z;
+		double distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+		// Stay clear of the boundary so float rounding in the binner cannot flip the answer.
+		if (distance >= light.Range * 0.999) return false;
+		if (!spot || distance == 0.0) return true;
+
+		double cosAngle = (dx * light.Direction.x + dy * light.Direction.y + dz * light.Direction.z) / distance;
+		return cosAngle > std::cos(light.SpotAngle) + 1e-4;
+	}
+
+	bool ClusterContains(const ClusteredLighting& lighting, uint32_t cluster, uint32_t light, bool spot)
+	{
+		const XMUINT2& range = lighting.GetClusterRanges()[cluster];
+		uint32_t pointNum = range.y & 0xffff;
+		uint32_t first = range.x + (spot ? pointNum : 0);
+		uint32_t last = first + (spot ? range.y >> 16 : pointNum);
+
+		const auto& indices = lighting.GetLightIndices();
+		return std::find(indices.begin() + first, indices.begin() + last, light) != indices.begin() + last;
+	}
+
+	// Samples view-space points inside the frustum up to maxDepth and checks that every light
+	// reaching a point is listed in the cluster the pixel shader would fetch for it.
+	uint32_t CheckCoverage(const ClusteredLighting& lighting, const Scene& scene, uint32_t sampleNum, float maxDepth, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		float tanHalfFovY = std::tan(FovY * 0.5f);
+		float tanHalfFovX = tanHalfFovY * AspectRatio;
+
+		uint32_t litNum = 0;
+		for (uint32_t sample = 0; sample < sampleNum; ++sample)
+		{
+			float screenX = unit(random);
+			float screenY = unit(random);
+			float depth = NearClip * std::pow(maxDepth / NearClip, unit(random));
+			XMFLOAT3 point((screenX * 2.0f - 1.0f) * tanHalfFovX * depth, (1.0f - screenY * 2.0f) * tanHalfFovY * depth, depth);
+			uint32_t cluster = GetShaderCluster(lighting, screenX, screenY, depth);
+
+			for (uint32_t light = 0; light < scene.PointLights.size(); ++light)
+			{
+				if (!IsLit(scene.PointLights[light], point, false)) continue;
+				++litNum;
+				CHECK(ClusterContains(lighting, cluster, light, false));
+			}
+			for (uint32_t light = 0; light < scene.SpotLights.size(); ++light)
+			{
+				if (!IsLit(scene.SpotLights[light], point, true)) continue;
+				++litNum;
+				CHECK(ClusterContains(lighting, cluster, light, true));
+			}
+		}
+		return litNum;
+	}
+
+	TestLight PointLight(float x, float y, float z, float range)
+	{
+		return { XMFLOAT3(x, y, z), XMFLOAT3(0.0f, 0.0f, 1.0f), 0.0f, range };
+	}
+
+	TestLight SpotLight(float x, float y, float z, float dx, float dy, float dz, float angleDegrees, float range)
+	{
+		float length = std::sqrt(dx * dx + dy * dy + dz * dz);
+		return { XMFLOAT3(x, y, z), XMFLOAT3(dx / length, dy / length, dz / length), XMConvertToRadians(angleDegrees), range };
+	}
+}
+
+TEST_CASE(RandomLightsCoverEveryLitPixel)
+{
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	Scene scene;
+	for (int i = 0; i < 400; ++i)
+	{
+		float x = (unit(random) - 0.5f) * 120.0f;
+		float y = (unit(random) - 0.5f) * 60.0f;
+		float z = unit(random) * 110.0f - 5.0f;
+		float range = 0.5f + unit(random) * 6.0f;
+		if (i % 2 == 0)
+		{
+			scene.PointLights.push_back(PointLight(x, y, z, range));
+		}
+		else
+		{
+			float angle = unit(random) < 0.2f ? 90.0f + unit(random) * 80.0f : 5.0f + unit(random) * 80.0f;
+			scene.SpotLights.push_back(SpotLight(x, y, z, unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f, angle, range));
+		}
+	}
+
+	ClusteredLighting lighting;
+	Bin(lighting, scene);
+	CHECK(CheckCoverage(lighting, scene, 20000, FarClip, 11) > 1000);
+}
+
+TEST_CASE(WideConesCoverEveryLitPixel)
+{
+	Scene scene;
+	scene.SpotLights.push_back(SpotLight(0.0f, 0.0f, 5.0f, 0.0f, 0.0f, 1.0f, 90.0f, 8.0f));
+	scene.SpotLights.push_back(SpotLight(2.0f, 1.0f, 10.0f, 1.0f, 0.0f, -1.0f, 120.0f, 6.0f));
+	scene.SpotLights.push_back(SpotLight(-3.0f, 0.0f, 20.0f, 0.0f, 1.0f, 0.0f, 179.0f, 10.0f));
+	scene.SpotLights.push_back(SpotLight(0.0f, -2.0f, 4.0f, 0.0f, 0.0f, -1.0f, 95.0f, 3.0f));
+
+	ClusteredLighting lighting;
+	Bin(lighting, scene);
+	CHECK(CheckCoverage(lighting, scene, 20000, 40.0f, 13) > 1000);
+}
+
+TEST_CASE(UnboundedLightsReachEveryCluster)
+{
+	float range = ClusteredLighting::ComputeRange(1.0f, 0.0f, 1.0f / 256.0f);
+	CHECK_EQUAL(FLT_MAX, range);
+
+	Scene scene;
+	scene.PointLights.push_back(PointLight(3.0f, -2.0f, 50.0f, range));
+	scene.SpotLights.push_back(SpotLight(0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 100.0f, range));
+	scene.SpotLights.push_back(SpotLight(0.0f, 0.0f, 10.0f, 0.0f, 0.0f, 1.0f, 30.0f, range));
+
+	ClusteredLighting lighting;
+	Bin(lighting, scene);
+
+	for (uint32_t cluster = 0; cluster < ClusteredLighting::ClusterNum; ++cluster)
+	{
+		CHECK(ClusterContains(lighting, cluster, 0, false));
+		CHECK(ClusterContains(lighting, cluster, 0, true));
+	}
+	CHECK(CheckCoverage(lighting, scene, 5000, FarClip, 17) > 5000);
+}
+
+TEST_CASE(LightsStraddlingTheNearPlane)
+{
+	Scene scene;
+	scene.PointLights.push_back(PointLight(0.0f, 0.0f, 0.05f, 0.5f));
+	scene.PointLights.push_back(PointLight(0.2f, 0.1f, -0.5f, 1.0f));
+	scene.PointLights.push_back(PointLight(0.0f, 0.0f, -2.0f, 1.0f));
+	scene.SpotLights.push_back(SpotLight(0.0f, 0.0f, -0.3f, 0.0f, 0.0f, 1.0f, 40.0f, 2.0f));
+	scene.SpotLights.push_back(SpotLight(0.1f, 0.0f, 0.0f, 1.0f, 0.0f, 0.2f, 100.0f, 1.5f));
+
+	ClusteredLighting lighting;
+	Bin(lighting, scene);
+	CHECK(CheckCoverage(lighting, scene, 40000, 3.0f, 19) > 1000);
+
+	// Entirely behind the camera.
+	for (uint32_t cluster = 0; cluster < ClusteredLighting::ClusterNum; ++cluster)
+	{
+		CHECK(!ClusterContains(lighting, cluster, 2, false));
+	}
+}
+
+TEST_CASE(PointLightsAgreeWithBruteForceClusterBounds)
+{
+	std::mt19937 random(23);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	Scene scene;
+	for (int i = 0; i < 200; ++i)
+	{
+		scene.PointLights.push_back(PointLight((unit(random) - 0.5f) * 40.0f, (unit(random) - 0.5f) * 20.0f, unit(random) * 50.0f, 0.2f + unit(random) * 4.0f));
+	}
+
+	ClusteredLighting lighting;
+	Bin(lighting, scene);
+
+	double tanHalfFovY = std::tan(FovY * 0.5);
+	double tanHalfFovX = tanHalfFovY * AspectRatio;
+	uint32_t mismatchNum = 0;
+	uint32_t hitNum = 0;
+	uint32_t centerNum = 0;
+	for (uint32_t z = 0; z < ClusteredLighting::ClusterCountZ; ++z)
+	{
+		double sliceNear = NearClip * std::pow(double(FarClip) / NearClip, z / double(ClusteredLighting::ClusterCountZ));
+		double sliceFar = NearClip * std::pow(double(FarClip) / NearClip, (z + 1) / double(ClusteredLighting::ClusterCountZ));
+		for (uint32_t y = 0; y < ClusteredLighting::ClusterCountY; ++y)
+		{
+			double top = (1.0 - 2.0 * y / ClusteredLighting::ClusterCountY) * tanHalfFovY;
+			double bottom = (1.0 - 2.0 * (y + 1) / ClusteredLighting::ClusterCountY) * tanHalfFovY;
+			for (uint32_t x = 0; x < ClusteredLighting::ClusterCountX; ++x)
+			{
+				double left = (2.0 * x / ClusteredLighting::ClusterCountX - 1.0) * tanHalfFovX;
+				double right = (2.0 * (x + 1) / ClusteredLighting::ClusterCountX - 1.0) * tanHalfFovX;
+				double minimum[3] = { std::min(left * sliceNear, left * sliceFar), std::min(bottom * sliceNear, bottom * sliceFar), sliceNear };
+				double maximum[3] = { std::max(right * sliceNear, right * sliceFar), std::max(top * sliceNear, top * sliceFar), sliceFar };
+				uint32_t cluster = x + ClusteredLighting::ClusterCountX * (y + ClusteredLighting::ClusterCountY * z);
+
+				double sliceCenter = 0.5 * (sliceNear + sliceFar);
+				double cellCenter[3] = { 0.5 * (left + right) * sliceCenter, 0.5 * (top + bottom) * sliceCenter, sliceCenter };
+
+				for (uint32_t light = 0; light < scene.PointLights.size(); ++light)
+				{
+					const TestLight& point = scene.PointLights[light];
+					const double center[3] = { point.Position.x, point.Position.y, point.Position.z };
+					double distanceSq = 0.0;
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						double d = std::max(std::max(minimum[axis] - center[axis], center[axis] - maximum[axis]), 0.0);
+						distanceSq += d * d;
+					}
+
+					// Binned lights must touch the cluster's AABB, and a light containing the cell's
+					// center point must be binned. The coverage tests handle the cell edges.
+					double margin = 1e-4 * point.Range;
+					bool outside = distanceSq > (point.Range + margin) * (point.Range + margin);
+					double cx = cellCenter[0] - center[0];
+					double cy = cellCenter[1] - center[1];
+					double cz = cellCenter[2] - center[2];
+					bool containsCenter = cx * cx + cy * cy + cz * cz < (point.Range - margin) * (point.Range - margin);
+					bool binned = ClusterContains(lighting, cluster, light, false);
+					hitNum += binned ? 1 : 0;
+					centerNum += containsCenter ? 1 : 0;
+					if ((outside && binned) || (containsCenter && !binned)) ++mismatchNum;
+				}
+			}
+		}
+	}
+
+	CHECK_EQUAL(0u, mismatchNum);
+	CHECK(centerNum > 100);
+	CHECK_EQUAL(hitNum, lighting.GetStatistics().IndexNum);
+}
+
+TEST_CASE(IndicesArePackedPerCluster)
+{
+	std::mt19937 random(29);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	Scene scene;
+	for (int i = 0; i < 300; ++i)
+	{
+		TestLight light = SpotLight((unit(random) - 0.5f) * 40.0f, (unit(random) - 0.5f) * 20.0f, unit(random) * 50.0f, 0.0f, 0.0f, 1.0f, 60.0f, 1.0f + unit(random) * 5.0f);
+		(i % 3 ? scene.PointLights : scene.SpotLights).push_back(light);
+	}
+
+	ClusteredLighting lighting;
+	Bin(lighting, scene);
+
+	const auto& ranges = lighting.GetClusterRanges();
+	const auto& indices = lighting.GetLightIndices();
+	uint32_t offset = 0;
+	for (uint32_t cluster = 0; cluster < ClusteredLighting::ClusterNum; ++cluster)
+	{
+		uint32_t pointNum = ranges[cluster].y & 0xffff;
+		uint32_t spotNum = ranges[cluster].y >> 16;
+		CHECK_EQUAL(offset, ranges[cluster].x);
+
+		for (uint32_t i = 0; i < pointNum; ++i)
+		{
+			CHECK(indices[offset + i] < scene.PointLights.size());
+			if (i > 0) CHECK(indices[offset + i] > indices[offset + i - 1]);
+		}
+		for (uint32_t i = 0; i < spotNum; ++i)
+		{
+			CHECK(indices[offset + pointNum + i] < scene.SpotLights.size());
+			if (i > 0) CHECK(indices[offset + pointNum + i] > indices[offset + pointNum + i - 1]);
+		}
+		offset += pointNum + spotNum;
+	}
+	CHECK_EQUAL(offset, lighting.GetStatistics().IndexNum);
+}
+
+TEST_CASE(InvalidUseThrows)
+{
+	ClusteredLighting lighting;
+	CHECK_THROWS(lighting.Bin());
+	CHECK_THROWS(lighting.SetProjection(FovY, AspectRatio, 0.0f, FarClip));
+	CHECK_THROWS(lighting.SetProjection(FovY, AspectRatio, 10.0f, 1.0f));
+}
@@ -0,0 +1,97 @@
+#include "ComputePipelineLibrary.h"
+#include "GenerateMipsPSO.h"
+#include "IndirectCullPSO.h"
+#include "PanoToCubemapPSO.h"
+#include "TestHarness.h"
+
+TEST_CASE(ConcurrentRequestsCreateEachPSOOnce)
+{
+	const uint32_t ThreadNum = 8;
+	const uint32_t RequestNum = 200;
+
+	const uint32_t createdBefore[] = { GenerateMipsPSO::GetCreatedNum(), PanoToCubemapPSO::GetCreatedNum(), IndirectCullPSO::GetCreatedNum() };
+
+	ComputePipelineLibrary library;
+	std::atomic_uint32_t ready(0);
+	std::vector<const void*> results(ThreadNum * 3);
+	std::vector<std::thread> threads;
+	for (uint32_t thread = 0; thread < ThreadNum; ++thread)
+	{
+		threads.emplace_back([&, thread]()
+		{
+			// Start together so the first request for each PSO comes from several threads at once,
+			// and in a different order per thread.
+			++ready;
+			while (ready < ThreadNum)
+			{
+				std::this_thread::yield();
+			}
+
+			for (uint32_t i = 0; i < RequestNum; ++i)
+			{
+				switch ((thread + i) % 3)
+				{
+				case 0:
+					results[thread * 3 + 0] = &library.GetGenerateMipsPSO();
+					break;
+				case 1:
+					results[thread * 3 + 1] = &library.GetPanoToCubemapPSO();
+					break;
+				default:
+					results[thread * 3 + 2] = &library.GetIndirectCullPSO();
+					break;
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	ComputePipelineLibrary::Statistics statistics = library.GetStatistics();
+	CHECK_EQUAL(1u, statistics.GenerateMipsCreated);
+	CHECK_EQUAL(1u, statistics.PanoToCubemapCreated);
+	CHECK_EQUAL(1u, statistics.IndirectCullCreated);
+	CHECK_EQUAL(static_cast<uint64_t>(ThreadNum) * RequestNum, statistics.Requests);
+
+	// Every thread got the same instance, and no other was ever constructed.
+	for (uint32_t thread = 1; thread < ThreadNum; ++thread)
+	{
+		for (uint32_t pso = 0; pso < 3; ++pso)
+		{
+			CHECK(results[thread * 3 + pso] == results[pso]);
+		}
+	}
+	CHECK_EQUAL(createdBefore[0] + 1, GenerateMipsPSO::GetCreatedNum());
+	CHECK_EQUAL(createdBefore[1] + 1, PanoToCubemapPSO::GetCreatedNum());
+	CHECK_EQUAL(createdBefore[2] + 1, IndirectCullPSO::GetCreatedNum());
+
+	// Prewarm after the fact only counts requests.
+	library.Prewarm();
+	statistics = library.GetStatistics();
+	CHECK_EQUAL(1u, statistics.GenerateMipsCreated);
+	CHECK_EQUAL(1u, statistics.PanoToCubemapCreated);
+	CHECK_EQUAL(1u, statistics.IndirectCullCreated);
+	CHECK_EQUAL(static_cast<uint64_t>(ThreadNum) * RequestNum + 3, statistics.Requests);
+}
+
+TEST_CASE(PrewarmCreatesEveryPSO)
+{
+	ComputePipelineLibrary library;
+	ComputePipelineLibrary::Statistics statistics = library.GetStatistics();
+	CHECK_EQUAL(0u, statistics.GenerateMipsCreated + statistics.PanoToCubemapCreated + statistics.IndirectCullCreated);
+	CHECK_EQUAL(0u, statistics.Requests);
+
+	library.Prewarm();
+	statistics = library.GetStatistics();
+	CHECK_EQUAL(1u, statistics.GenerateMipsCreated);
+	CHECK_EQUAL(1u, statistics.PanoToCubemapCreated);
+	CHECK_EQUAL(1u, statistics.IndirectCullCreated);
+	CHECK_EQUAL(3u, statistics.Requests);
+
+	const GenerateMipsPSO& generateMips = library.GetGenerateMipsPSO();
+	CHECK(&generateMips == &library.GetGenerateMipsPSO());
+	CHECK_EQUAL(1u, library.GetStatistics().GenerateMipsCreated);
+	CHECK_EQUAL(5u, library.GetStatistics().Requests);
+}
@@ -0,0 +1,249 @@
+#include "CubemapBaker.h"
+#include "TestHarness.h"
+
+#include <filesystem>
+#include <random>
+
+using namespace DirectX;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	const double PI = 3.14159265358979323846;
+
+	PanoramaImage CreatePanorama(uint32_t width, uint32_t height, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> value(0.0f, 1.0f);
+
+		PanoramaImage pano = { width, height, std::vector<XMFLOAT4>(static_cast<size_t>(width) * height) };
+		for (XMFLOAT4& texel : pano.Texels)
+		{
+			texel = XMFLOAT4(value(random), value(random), value(random), value(random));
+		}
+		return pano;
+	}
+
+	// Direction through texel (u, v) of a face in Direct3D cube order (+X, -X, +Y, -Y, +Z, -Z),
+	// u to the right and v down, from the face table rather than the baker's rotation matrices.
+	void GetReferenceDirection(uint32_t face, double u, double v, double dir[3])
+	{
+		double s = 2.0 * u - 1.0;
+		double t = 2.0 * v - 1.0;
+		const double faces[CubemapImage::FaceNum][3] =
+		{
+			{ 1.0, -t, -s },
+			{ -1.0, -t, s },
+			{ s, 1.0, t },
+			{ s, -1.0, -t },
+			{ s, -t, 1.0 },
+			{ -s, -t, -1.0 },
+		};
+
+		double length = std::sqrt(faces[face][0] * faces[face][0] + faces[face][1] * faces[face][1] + faces[face][2] * faces[face][2]);
+		for (int i = 0; i < 3; ++i)
+		{
+			dir[i] = faces[face][i] / length;
+		}
+	}
+
+	// Scalar equirectangular lookup with the GPU bake's mapping (PanoToCubemap_CS.hlsl): longitude
+	// wraps, latitude clamps at the poles, bilinear between texel centers.
+	XMFLOAT4 SampleReference(const PanoramaImage& pano, const double dir[3])
+	{
+		double u = std::atan2(-dir[0], -dir[2]) / (2.0 * PI);
+		double v = std::acos(std::min(std::max(dir[1], -1.0), 1.0)) / PI;
+
+		double x = u * pano.Width - 0.5;
+		double y = v * pano.Height - 0.5;
+		double tx = x - std::floor(x);
+		double ty = y - std::floor(y);
+
+		int64_t width = pano.Width;
+		int64_t height = pano.Height;
+		int64_t x0 = ((static_cast<int64_t>(std::floor(x)) % width) + width) % width;
+		int64_t x1 = (x0 + 1) % width;
+		int64_t y0 = std::min(std::max(static_cast<int64_t>(std::floor(y)), int64_t(0)), height - 1);
+		int64_t y1 = std::min(y0 + 1, height - 1);
+
+		auto texel = [&](int64_t tx, int64_t ty) { return &pano.Texels[ty * width + tx].x; };
+		float result[4];
+		for (int c = 0; c < 4; ++c)
+		{
+			double top = texel(x0, y0)[c] + (texel(x1, y0)[c] - texel(x0, y0)[c]) * tx;
+			double bottom = texel(x0, y1)[c] + (texel(x1, y1)[c] - texel(x0, y1)[c]) * tx;
+			result[c] = static_cast<float>(top + (bottom - top) * ty);
+		}
+		return XMFLOAT4(result[0], result[1], result[2], result[3]);
+	}
+
+	float GetMaxDifference(const XMFLOAT4& a, const XMFLOAT4& b)
+	{
+		return std::max(std::max(std::fabs(a.x - b.x), std::fabs(a.y - b.y)), std::max(std::fabs(a.z - b.z), std::fabs(a.w - b.w)));
+	}
+
+	fs::path MakeTempDirectory(const char* name)
+	{
+		fs::path directory = fs::temp_directory_path() / "CubemapBakerTests" / name;
+		fs::remove_all(directory);
+		fs::create_directories(directory);
+		return directory;
+	}
+}
+
+TEST_CASE(PanoToCubemapMatchesScalarReference)
+{
+	PanoramaImage pano = CreatePanorama(96, 48, 1);
+
+	// Sizes that are not a multiple of four cover the partial lane group at the end of each row. Odd
+	// sizes are left out: their centre texel on the +Y and -Y faces sits on a pole, where the
+	// longitude is undefined.
+	for (uint32_t size : { 4, 6, 16, 34 })
+	{
+		CubemapImage cubemap = CubemapBaker::PanoToCubemap(pano, size, 1);
+		CHECK_EQUAL(size, cubemap.GetSize());
+		CHECK_EQUAL(1u, cubemap.GetMipLevels());
+
+		float maxDifference = 0.0f;
+		for (uint32_t face = 0; face < CubemapImage::FaceNum; ++face)
+		{
+			const XMFLOAT4* texels = cubemap.GetTexels(face, 0);
+			for (uint32_t y = 0; y < size; ++y)
+			{
+				for (uint32_t x = 0; x < size; ++x)
+				{
+					double dir[3];
+					GetReferenceDirection(face, (x + 0.5) / size, (y + 0.5) / size, dir);
+					maxDifference = std::max(maxDifference, GetMaxDifference(SampleReference(pano, dir), texels[y * size + x]));
+				}
+			}
+		}
+		CHECK(maxDifference < 1e-3f);
+	}
+
+	CHECK_THROWS(CubemapBaker::PanoToCubemap(PanoramaImage{ 4, 4, std::vector<XMFLOAT4>(3) }, 4));
+}
+
+TEST_CASE(TexelDirectionRoundTrips)
+{
+	const uint32_t Size = 8;
+	for (uint32_t face = 0; face < CubemapImage::FaceNum; ++face)
+	{
+		for (uint32_t y = 0; y < Size; ++y)
+		{
+			for (uint32_t x = 0; x < Size; ++x)
+			{
+				float u = (x + 0.5f) / Size;
+				float v = (y + 0.5f) / Size;
+				double reference[3];
+				GetReferenceDirection(face, u, v, reference);
+
+				XMVECTOR dir = CubemapImage::GetTexelDirection(face, u, v);
+				CHECK(XMVector3NearEqual(XMVectorSet(static_cast<float>(reference[0]), static_cast<float>(reference[1]), static_cast<float>(reference[2]), 0.0f), dir, XMVectorReplicate(1e-5f)));
+
+				float faceU, faceV;
+				CHECK_EQUAL(face, CubemapImage::GetFaceCoordinate(dir, faceU, faceV));
+				CHECK_NEAR(u, faceU, 1e-5);
+				CHECK_NEAR(v, faceV, 1e-5);
+			}
+		}
+	}
+}
+
+TEST_CASE(MipsAverageTwoByTwoBlocks)
+{
+	CubemapImage cubemap = CubemapBaker::PanoToCubemap(CreatePanorama(64, 32, 2), 16);
+	CHECK_EQUAL(5u, cubemap.GetMipLevels());
+	CHECK_EQUAL(1u, cubemap.GetMipSize(4));
+
+	for (uint32_t face = 0; face < CubemapImage::FaceNum; ++face)
+	{
+		for (uint32_t mip = 1; mip < cubemap.GetMipLevels(); ++mip)
+		{
+			uint32_t size = cubemap.GetMipSize(mip);
+			uint32_t srcSize = cubemap.GetMipSize(mip - 1);
+			const XMFLOAT4* src = cubemap.GetTexels(face, mip - 1);
+			const XMFLOAT4* dst = cubemap.GetTexels(face, mip);
+			for (uint32_t y = 0; y < size; ++y)
+			{
+				for (uint32_t x = 0; x < size; ++x)
+				{
+					const XMFLOAT4* block[] = { &src[2 * y * srcSize + 2 * x], &src[2 * y * srcSize + 2 * x + 1], &src[(2 * y + 1) * srcSize + 2 * x], &src[(2 * y + 1) * srcSize + 2 * x + 1] };
+					XMFLOAT4 average((block[0]->x + block[1]->x + block[2]->x + block[3]->x) * 0.25f, (block[0]->y + block[1]->y + block[2]->y + block[3]->y) * 0.25f,
+									 (block[0]->z + block[1]->z + block[2]->z + block[3]->z) * 0.25f, (block[0]->w + block[1]->w + block[2]->w + block[3]->w) * 0.25f);
+					CHECK(GetMaxDifference(average, dst[y * size + x]) < 1e-6f);
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE(DDSRoundTripsEveryFormat)
+{
+	fs::path directory = MakeTempDirectory("RoundTrip");
+	CubemapImage cubemap = CubemapBaker::PanoToCubemap(CreatePanorama(64, 32, 3), 8);
+
+	// Half of the 8-bit step, the 11-bit half mantissa on values below one, and exact floats.
+	const std::pair<CubemapFormat, float> formats[] =
+	{
+		{ CubemapFormat::RGBA8_UNORM, 0.5f / 255.0f + 1e-6f },
+		{ CubemapFormat::RGBA8_UNORM_SRGB, 0.5f / 255.0f + 1e-6f },
+		{ CubemapFormat::RGBA16_FLOAT, 1.0f / 2048.0f },
+		{ CubemapFormat::RGBA32_FLOAT, 0.0f },
+	};
+	for (const auto& format : formats)
+	{
+		std::string fileName = (directory / ("cubemap_" + std::to_string(static_cast<uint32_t>(format.first)) + ".dds")).string();
+		CHECK(CubemapBaker::SaveToDDS(fileName, cubemap, format.first));
+		CHECK(!fs::exists(fileName + ".tmp"));
+
+		CubemapImage loaded;
+		CHECK(CubemapBaker::LoadFromDDS(fileName, loaded));
+		CHECK_EQUAL(cubemap.GetSize(), loaded.GetSize());
+		CHECK_EQUAL(cubemap.GetMipLevels(), loaded.GetMipLevels());
+
+		float maxDifference = 0.0f;
+		for (uint32_t face = 0; face < CubemapImage::FaceNum; ++face)
+		{
+			for (uint32_t mip = 0; mip < cubemap.GetMipLevels(); ++mip)
+			{
+				size_t texelNum = static_cast<size_t>(cubemap.GetMipSize(mip)) * cubemap.GetMipSize(mip);
+				for (size_t i = 0; i < texelNum; ++i)
+				{
+					maxDifference = std::max(maxDifference, GetMaxDifference(cubemap.GetTexels(face, mip)[i], loaded.GetTexels(face, mip)[i]));
+				}
+			}
+		}
+		CHECK(maxDifference <= format.second);
+	}
+
+	// A truncated file is rejected rather than half loaded.
+	std::string truncated = (directory / "truncated.dds").string();
+	CHECK(CubemapBaker::SaveToDDS(truncated, cubemap, CubemapFormat::RGBA32_FLOAT));
+	fs::resize_file(truncated, fs::file_size(truncated) / 2);
+	CubemapImage loaded;
+	CHECK(!CubemapBaker::LoadFromDDS(truncated, loaded));
+	CHECK(!CubemapBaker::LoadFromDDS((directory / "missing.dds").string(), loaded));
+}
+
+TEST_CASE(HalfConversionRoundsAndSaturates)
+{
+	// Values the half encoding represents exactly, one that rounds, and one past the half range.
+	CubemapImage cubemap(1, 1);
+	for (uint32_t face = 0; face < CubemapImage::FaceNum; ++face)
+	{
+		cubemap.GetTexels(face, 0)[0] = XMFLOAT4(1.0f, -2.5f, 1.0f / 3.0f, 1e6f);
+	}
+
+	std::string fileName = (MakeTempDirectory("Half") / "half.dds").string();
+	CHECK(CubemapBaker::SaveToDDS(fileName, cubemap, CubemapFormat::RGBA16_FLOAT));
+	CubemapImage loaded;
+	CHECK(CubemapBaker::LoadFromDDS(fileName, loaded));
+
+	const XMFLOAT4& texel = loaded.GetTexels(CubemapImage::FaceNum - 1, 0)[0];
+	CHECK_EQUAL(1.0f, texel.x);
+	CHECK_EQUAL(-2.5f, texel.y);
+	CHECK_NEAR(1.0 / 3.0, texel.z, 1e-4);
+	CHECK(std::isinf(texel.w));
+}
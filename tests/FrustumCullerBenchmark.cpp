@@ -0,0 +1,55 @@
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+#include "Meshlet.h"
+#include "TestHarness.h"
+
+#include <random>
+
+using namespace DirectX;
+
+TEST_CASE(CullUpToOneMillionObjects)
+{
+	XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 5.0f, -20.0f, 1.0f), XMVectorSet(10.0f, 0.0f, 30.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	XMMATRIX projection = XMMatrixPerspectiveFovLH(XMConvertToRadians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+	XMFLOAT4X4 viewProjection;
+	XMStoreFloat4x4(&viewProjection, view * projection);
+	BoundingFrustum frustum;
+	BoundingFrustum(projection).Transform(frustum, XMMatrixInverse(nullptr, view));
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-120.0f, 120.0f);
+	std::uniform_real_distribution<float> extent(0.05f, 6.0f);
+
+	printf("%8s %12s %14s %9s %8s %8s\n", "objects", "culler ms", "Intersects ms", "speedup", "visible", "exact");
+	for (size_t objectNum : { 1000, 10000, 100000, 1000000 })
+	{
+		std::vector<BoundingBox> boxes(objectNum);
+		FrustumCuller culler;
+		culler.Reserve(objectNum);
+		for (BoundingBox& box : boxes)
+		{
+			box = BoundingBox(XMFLOAT3(position(random), position(random) * 0.25f, position(random)), XMFLOAT3(extent(random), extent(random), extent(random)));
+			culler.AddObject(box);
+		}
+
+		std::vector<uint32_t> visible;
+		visible.reserve(objectNum);
+		double cullerTime = Test::Measure(10, [&]() { culler.Cull(viewProjection, visible); });
+
+		std::vector<uint32_t> scalarVisible;
+		scalarVisible.reserve(objectNum);
+		double scalarTime = Test::Measure(3, [&]()
+		{
+			scalarVisible.clear();
+			for (uint32_t i = 0; i < objectNum; ++i)
+			{
+				if (frustum.Intersects(boxes[i])) scalarVisible.push_back(i);
+			}
+		});
+
+		printf("%8zu %12.3f %14.3f %8.1fx %8zu %8zu\n", objectNum, cullerTime, scalarTime, scalarTime / cullerTime, visible.size(), scalarVisible.size());
+		CHECK(visible.size() >= scalarVisible.size());
+	}
+	printf("%u job system workers\n", JobSystem::Get().GetWorkerCount() + 1);
+}
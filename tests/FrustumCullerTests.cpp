@@ -0,0 +1,175 @@
+#include "FrustumCuller.h"
+#include "Meshlet.h"
+#include "TestHarness.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	struct Camera
+	{
+		XMFLOAT4X4 ViewProjection;
+		XMFLOAT4 Planes[6];
+		BoundingFrustum Frustum;
+	};
+
+	Camera CreateCamera(FXMVECTOR eye, FXMVECTOR target)
+	{
+		XMMATRIX view = XMMatrixLookAtLH(eye, target, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		XMMATRIX projection = XMMatrixPerspectiveFovLH(XMConvertToRadians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+		Camera camera;
+		XMStoreFloat4x4(&camera.ViewProjection, view * projection);
+		MeshletCuller::ExtractFrustumPlanes(camera.ViewProjection, camera.Planes);
+		BoundingFrustum(projection).Transform(camera.Frustum, XMMatrixInverse(nullptr, view));
+		return camera;
+	}
+
+	bool IsInsidePlanes(const XMFLOAT4 planes[6], const BoundingBox& box)
+	{
+		for (int i = 0; i < 6; ++i)
+		{
+			const XMFLOAT4& plane = planes[i];
+			float distance = plane.x * box.Center.x + plane.y * box.Center.y + plane.z * box.Center.z + plane.w;
+			float radius = std::fabs(plane.x) * box.Extents.x + std::fabs(plane.y) * box.Extents.y + std::fabs(plane.z) * box.Extents.z;
+			if (distance + radius < 0.0f) return false;
+		}
+		return true;
+	}
+
+	std::vector<BoundingBox> CreateBoxes(size_t boxNum, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> position(-120.0f, 120.0f);
+		std::uniform_real_distribution<float> extent(0.05f, 6.0f);
+
+		std::vector<BoundingBox> boxes(boxNum);
+		for (BoundingBox& box : boxes)
+		{
+			box = BoundingBox(XMFLOAT3(position(random), position(random) * 0.25f, position(random)), XMFLOAT3(extent(random), extent(random), extent(random)));
+		}
+		return boxes;
+	}
+
+	// The culler must return exactly the boxes the scalar plane test keeps, and never
+	// drop a box the exact frustum test says is visible.
+	void CheckAgainstScalar(const Camera& camera, const std::vector<BoundingBox>& boxes)
+	{
+		FrustumCuller culler;
+		culler.Reserve(boxes.size());
+		for (const BoundingBox& box : boxes)
+		{
+			culler.AddObject(box);
+		}
+
+		std::vector<uint32_t> visible;
+		uint32_t culledNum = culler.Cull(camera.ViewProjection, visible);
+
+		std::vector<uint32_t> expected;
+		uint32_t wrongNum = 0;
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			if (IsInsidePlanes(camera.Planes, boxes[i]))
+			{
+				expected.push_back(i);
+			}
+			else if (camera.Frustum.Intersects(boxes[i]))
+			{
+				++wrongNum;
+			}
+		}
+
+		CHECK(visible == expected);
+		CHECK_EQUAL(0u, wrongNum);
+		CHECK_EQUAL(static_cast<uint32_t>(boxes.size()), culledNum + static_cast<uint32_t>(visible.size()));
+		CHECK_EQUAL(static_cast<uint32_t>(visible.size()), culler.GetStatistics().VisibleNum);
+	}
+}
+
+TEST_CASE(MatchesScalarTestForEveryPadding)
+{
+	Camera camera = CreateCamera(XMVectorSet(0.0f, 5.0f, -20.0f, 1.0f), XMVectorSet(10.0f, 0.0f, 30.0f, 1.0f));
+	for (size_t boxNum : { 0, 1, 3, 4, 5, 7, 8, 1001 })
+	{
+		CheckAgainstScalar(camera, CreateBoxes(boxNum, static_cast<uint32_t>(boxNum)));
+	}
+}
+
+TEST_CASE(MatchesScalarTestFromManyViews)
+{
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+
+	std::vector<BoundingBox> boxes = CreateBoxes(20000, 99);
+	for (int view = 0; view < 16; ++view)
+	{
+		XMVECTOR eye = XMVectorSet(position(random), position(random) * 0.2f, position(random), 1.0f);
+		XMVECTOR target = XMVectorSet(position(random), position(random) * 0.2f, position(random), 1.0f);
+		CheckAgainstScalar(CreateCamera(eye, target), boxes);
+	}
+}
+
+TEST_CASE(ExactlyVisibleBoxesSurviveTheCull)
+{
+	Camera camera = CreateCamera(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f));
+
+	// Boxes hugging the near plane, the far plane and each side plane from outside and inside.
+	std::vector<BoundingBox> boxes =
+	{
+		BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.05f), XMFLOAT3(0.1f, 0.1f, 0.06f)),
+		BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.01f, 0.01f, 0.01f)),
+		BoundingBox(XMFLOAT3(0.0f, 0.0f, 100.5f), XMFLOAT3(1.0f, 1.0f, 0.6f)),
+		BoundingBox(XMFLOAT3(0.0f, 0.0f, 101.0f), XMFLOAT3(1.0f, 1.0f, 0.5f)),
+		BoundingBox(XMFLOAT3(38.0f, 0.0f, 50.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)),
+		BoundingBox(XMFLOAT3(-38.0f, 0.0f, 50.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)),
+		BoundingBox(XMFLOAT3(0.0f, 21.5f, 50.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)),
+		BoundingBox(XMFLOAT3(0.0f, -25.0f, 50.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)),
+		BoundingBox(XMFLOAT3(0.0f, 0.0f, 50.0f), XMFLOAT3(500.0f, 500.0f, 500.0f)),
+	};
+	CheckAgainstScalar(camera, boxes);
+
+	FrustumCuller culler;
+	for (const BoundingBox& box : boxes)
+	{
+		culler.AddObject(box);
+	}
+	std::vector<uint32_t> visible;
+	culler.Cull(camera.Planes, visible);
+	CHECK(std::find(visible.begin(), visible.end(), 0u) != visible.end());
+	CHECK(std::find(visible.begin(), visible.end(), 1u) == visible.end());
+	CHECK(std::find(visible.begin(), visible.end(), 3u) == visible.end());
+	CHECK(std::find(visible.begin(), visible.end(), 7u) == visible.end());
+	CHECK(std::find(visible.begin(), visible.end(), 8u) != visible.end());
+}
+
+TEST_CASE(SetObjectAndClearUpdateTheCull)
+{
+	Camera camera = CreateCamera(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f));
+	BoundingBox inside(XMFLOAT3(0.0f, 0.0f, 10.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+	BoundingBox behind(XMFLOAT3(0.0f, 0.0f, -10.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+
+	FrustumCuller culler;
+	culler.AddObject(inside);
+	culler.AddObject(behind);
+	culler.AddObject(inside);
+
+	std::vector<uint32_t> visible;
+	CHECK_EQUAL(1u, culler.Cull(camera.Planes, visible));
+	CHECK(visible == std::vector<uint32_t>({ 0, 2 }));
+
+	culler.SetObject(0, behind);
+	culler.SetObject(1, inside);
+	culler.Cull(camera.Planes, visible);
+	CHECK(visible == std::vector<uint32_t>({ 1, 2 }));
+
+	culler.Clear();
+	CHECK_EQUAL(0u, culler.GetObjectCount());
+	CHECK_EQUAL(0u, culler.Cull(camera.Planes, visible));
+	CHECK(visible.empty());
+
+	culler.AddObject(inside);
+	culler.Cull(camera.Planes, visible);
+	CHECK(visible == std::vector<uint32_t>({ 0 }));
+}
@@ -0,0 +1,194 @@
+#include "Application.h"
+#include "CommandList.h"
+#include "GeometryArena.h"
+#include "TestHarness.h"
+
+namespace
+{
+	// Four byte elements and a 100 element first pool keep the offsets easy to follow.
+	const size_t Stride = 4;
+	const size_t InitialPoolSize = 100 * Stride;
+
+	GeometryArena::Allocation Allocate(GeometryArena& arena, CommandList& commandList, uint32_t count, uint32_t firstValue = 0)
+	{
+		std::vector<uint32_t> data(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			data[i] = firstValue + i;
+		}
+		return arena.AllocateVertices(commandList, count, Stride, data.data());
+	}
+
+	// Frees an allocation and releases it straight away, as if the GPU had already finished.
+	void Release(GeometryArena& arena, const GeometryArena::Allocation& allocation)
+	{
+		Application::SetFrameCount(Application::GetFrameCount() + 1);
+		arena.Free(allocation);
+		arena.ReleaseFreedAllocations(Application::GetFrameCount());
+	}
+
+	const VertexBuffer& GetBoundVertexBuffer(const GeometryArena& arena, const GeometryArena::Allocation& allocation)
+	{
+		CommandList commandList;
+		arena.SetVertexBuffer(commandList, 0, allocation);
+		return *reinterpret_cast<const VertexBuffer*>(commandList.GetCalls("SetVertexBuffer").back().Arguments[1]);
+	}
+}
+
+TEST_CASE(FreedNeighboursMergeOnBothSides)
+{
+	CommandList commandList;
+	GeometryArena arena(InitialPoolSize);
+
+	GeometryArena::Allocation allocations[5];
+	for (uint32_t i = 0; i < 5; ++i)
+	{
+		allocations[i] = Allocate(arena, commandList, 10);
+		CHECK_EQUAL(i * 10, allocations[i].Offset);
+	}
+	CHECK_EQUAL(1u, arena.GetStatistics().FreeRangeNum);
+
+	// [10, 20) and [30, 40) stay separate from each other and from the tail at 50.
+	Release(arena, allocations[1]);
+	Release(arena, allocations[3]);
+	CHECK_EQUAL(3u, arena.GetStatistics().FreeRangeNum);
+
+	// [20, 30) closes the gap between its two free neighbours.
+	Release(arena, allocations[2]);
+	CHECK_EQUAL(2u, arena.GetStatistics().FreeRangeNum);
+	CHECK_EQUAL(50 * Stride, arena.GetStatistics().LargestFreeBytes);
+
+	// [40, 50) merges with [10, 40) before it and the tail after it.
+	Release(arena, allocations[4]);
+	CHECK_EQUAL(1u, arena.GetStatistics().FreeRangeNum);
+	CHECK_EQUAL(90 * Stride, arena.GetStatistics().LargestFreeBytes);
+
+	// [0, 10) merges with what follows it, leaving the whole pool as one range.
+	Release(arena, allocations[0]);
+	GeometryArena::Statistics statistics = arena.GetStatistics();
+	CHECK_EQUAL(1u, statistics.FreeRangeNum);
+	CHECK_EQUAL(0u, statistics.AllocationNum);
+	CHECK_EQUAL(0u, statistics.UsedBytes);
+	CHECK_EQUAL(InitialPoolSize, statistics.LargestFreeBytes);
+	CHECK_EQUAL(0u, Allocate(arena, commandList, 100).Offset);
+	CHECK_EQUAL(1u, arena.GetStatistics().GrowNum);
+}
+
+TEST_CASE(BestFitPicksSmallestRange)
+{
+	CommandList commandList;
+	GeometryArena arena(InitialPoolSize);
+
+	// Holes of 5 at 10 and 3 at 25, then the 62 element tail at 38.
+	Allocate(arena, commandList, 10);
+	GeometryArena::Allocation b = Allocate(arena, commandList, 5);
+	Allocate(arena, commandList, 10);
+	GeometryArena::Allocation d = Allocate(arena, commandList, 3);
+	GeometryArena::Allocation e = Allocate(arena, commandList, 10);
+	CHECK_EQUAL(28u, e.Offset);
+	Release(arena, b);
+	Release(arena, d);
+
+	// An exact fit, the smaller of the two ranges that fit, then past the 1 element left over.
+	CHECK_EQUAL(25u, Allocate(arena, commandList, 3).Offset);
+	CHECK_EQUAL(10u, Allocate(arena, commandList, 4).Offset);
+	CHECK_EQUAL(38u, Allocate(arena, commandList, 2).Offset);
+	CHECK_EQUAL(14u, Allocate(arena, commandList, 1).Offset);
+
+	GeometryArena::Statistics statistics = arena.GetStatistics();
+	CHECK_EQUAL(1u, statistics.FreeRangeNum);
+	CHECK_EQUAL(60 * Stride, statistics.LargestFreeBytes);
+	CHECK_EQUAL(40 * Stride, statistics.UsedBytes);
+	CHECK_EQUAL(1u, statistics.GrowNum);
+}
+
+TEST_CASE(ReleaseWaitsForFrame)
+{
+	CommandList commandList;
+	GeometryArena arena(InitialPoolSize);
+
+	GeometryArena::Allocation first = Allocate(arena, commandList, 10);
+	GeometryArena::Allocation second = Allocate(arena, commandList, 10);
+	Allocate(arena, commandList, 10);
+
+	Application::SetFrameCount(100);
+	arena.Free(first);
+	Application::SetFrameCount(101);
+	arena.Free(second);
+	CHECK_EQUAL(1u, arena.GetStatistics().AllocationNum);
+
+	// Frames the GPU has not finished keep their ranges out of the free lists, so nothing reuses them.
+	arena.ReleaseFreedAllocations(99);
+	CHECK_EQUAL(30 * Stride, arena.GetStatistics().UsedBytes);
+	CHECK_EQUAL(1u, arena.GetStatistics().FreeRangeNum);
+
+	arena.ReleaseFreedAllocations(100);
+	CHECK_EQUAL(20 * Stride, arena.GetStatistics().UsedBytes);
+	CHECK_EQUAL(2u, arena.GetStatistics().FreeRangeNum);
+
+	GeometryArena::Allocation reused = Allocate(arena, commandList, 10);
+	CHECK_EQUAL(0u, reused.Offset);
+	CHECK_EQUAL(1u, arena.GetStatistics().FreeRangeNum);
+
+	arena.ReleaseFreedAllocations(101);
+	CHECK_EQUAL(20 * Stride, arena.GetStatistics().UsedBytes);
+	CHECK_EQUAL(2u, arena.GetStatistics().FreeRangeNum);
+}
+
+TEST_CASE(GrowKeepsOffsetsAndData)
+{
+	CommandList commandList;
+	GeometryArena arena(InitialPoolSize);
+
+	GeometryArena::Allocation first = Allocate(arena, commandList, 60, 1000);
+	CHECK_EQUAL(100 * Stride, GetBoundVertexBuffer(arena, first).GetData().size());
+
+	// 60 more do not fit the 40 left: the pool doubles and the old tail joins the new space.
+	GeometryArena::Allocation second = Allocate(arena, commandList, 60, 2000);
+	GeometryArena::Statistics statistics = arena.GetStatistics();
+	CHECK_EQUAL(1u, statistics.PoolNum);
+	CHECK_EQUAL(2u, statistics.GrowNum);
+	CHECK_EQUAL(200 * Stride, statistics.CapacityBytes);
+	CHECK_EQUAL(first.Pool, second.Pool);
+	CHECK_EQUAL(60u, second.Offset);
+	CHECK_EQUAL(80 * Stride, statistics.LargestFreeBytes);
+
+	const VertexBuffer& after = GetBoundVertexBuffer(arena, first);
+	CHECK_EQUAL(200 * Stride, after.GetData().size());
+	CHECK_EQUAL(1u, commandList.GetCalls("CopyBufferRegion").size());
+	const uint32_t* values = reinterpret_cast<const uint32_t*>(after.GetData().data());
+	for (uint32_t i = 0; i < 60; ++i)
+	{
+		CHECK_EQUAL(1000 + i, values[first.Offset + i]);
+		CHECK_EQUAL(2000 + i, values[second.Offset + i]);
+	}
+}
+
+TEST_CASE(IndexFormatsUseSeparatePools)
+{
+	CommandList commandList;
+	GeometryArena arena(InitialPoolSize);
+
+	std::vector<uint16_t> shortIndices = { 0, 1, 2 };
+	std::vector<uint32_t> longIndices = { 0, 1, 2 };
+	GeometryArena::Allocation shortAllocation = arena.AllocateIndices(commandList, shortIndices.size(), DXGI_FORMAT_R16_UINT, shortIndices.data());
+	GeometryArena::Allocation longAllocation = arena.AllocateIndices(commandList, longIndices.size(), DXGI_FORMAT_R32_UINT, longIndices.data());
+	GeometryArena::Allocation vertexAllocation = Allocate(arena, commandList, 3);
+	CHECK(shortAllocation.Pool != longAllocation.Pool);
+	CHECK(vertexAllocation.Pool != longAllocation.Pool);
+	CHECK_EQUAL(3u, arena.GetStatistics().PoolNum);
+
+	CommandList bindList;
+	arena.SetIndexBuffer(bindList, shortAllocation);
+	arena.SetIndexBuffer(bindList, longAllocation);
+	std::vector<CommandList::Call> calls = bindList.GetCalls("SetIndexBuffer");
+	CHECK_EQUAL(2u, calls.size());
+	CHECK_EQUAL(DXGI_FORMAT_R16_UINT, reinterpret_cast<const IndexBuffer*>(calls[0].Arguments[0])->GetIndexFormat());
+	CHECK_EQUAL(DXGI_FORMAT_R32_UINT, reinterpret_cast<const IndexBuffer*>(calls[1].Arguments[0])->GetIndexFormat());
+
+	// Empty allocations take no pool and free as a no-op.
+	GeometryArena::Allocation empty = arena.AllocateVertices(commandList, 0, Stride, nullptr);
+	CHECK(empty.Pool == GeometryArena::InvalidPool);
+	arena.Free(empty);
+	CHECK_EQUAL(3u, arena.GetStatistics().AllocationNum);
+}
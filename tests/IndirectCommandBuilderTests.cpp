@@ -0,0 +1,194 @@
+#include "IndirectCommandBuilder.h"
+#include "TestHarness.h"
+
+using namespace DirectX;
+
+namespace
+{
+	const D3D12_DRAW_INDEXED_ARGUMENTS SphereDraw = { 36, 1, 100, 5, 0 };
+	const D3D12_DRAW_INDEXED_ARGUMENTS CubeDraw = { 6, 3, 7, -2, 0 };
+	const D3D12_DRAW_INDEXED_ARGUMENTS TorusDraw = { 12, 1, 13, 2, 0 };
+
+	uint32_t ReadWord(const void* data, size_t offset)
+	{
+		uint32_t word;
+		memcpy(&word, static_cast<const uint8_t*>(data) + offset, sizeof(word));
+		return word;
+	}
+
+	float ReadFloat(const void* data, size_t offset)
+	{
+		float value;
+		memcpy(&value, static_cast<const uint8_t*>(data) + offset, sizeof(value));
+		return value;
+	}
+
+	// Batch 0: two commands, batch 1: empty, batch 2: one unbounded and one bounded command.
+	void BuildScene(IndirectCommandBuilder& builder)
+	{
+		builder.BeginBatch();
+		builder.Add(0, SphereDraw, BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)));
+		builder.Add(1, CubeDraw, BoundingBox(XMFLOAT3(50.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 2.0f, 3.0f)));
+		builder.BeginBatch();
+		builder.BeginBatch();
+		builder.Add(4, TorusDraw);
+		builder.Add(5, TorusDraw, BoundingBox(XMFLOAT3(0.0f, 0.0f, -3.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)));
+	}
+
+	// Mirrors IndirectCull_CS.hlsl: plane test, per-batch counter, compacted write.
+	bool IsVisible(const XMFLOAT4 planes[6], const IndirectCommandBuilder::CullItem& item)
+	{
+		for (int i = 0; i < 6; ++i)
+		{
+			const XMFLOAT4& plane = planes[i];
+			float distance = plane.x * item.Center.x + plane.y * item.Center.y + plane.z * item.Center.z;
+			float radius = std::fabs(plane.x) * item.Extents.x + std::fabs(plane.y) * item.Extents.y + std::fabs(plane.z) * item.Extents.z;
+			if (distance + radius + plane.w < 0.0f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST_CASE(CommandLayoutMatchesSignatureStride)
+{
+	CHECK_EQUAL(24u, IndirectCommandBuilder::CommandStride);
+	CHECK_EQUAL(0u, offsetof(IndirectCommandBuilder::Command, ObjectIndex));
+	CHECK_EQUAL(4u, offsetof(IndirectCommandBuilder::Command, Draw));
+	CHECK_EQUAL(32u, sizeof(IndirectCommandBuilder::CullItem));
+	CHECK_EQUAL(12u, offsetof(IndirectCommandBuilder::CullItem, Batch));
+	CHECK_EQUAL(16u, offsetof(IndirectCommandBuilder::CullItem, Extents));
+	CHECK_EQUAL(28u, offsetof(IndirectCommandBuilder::CullItem, BatchFirstCommand));
+}
+
+TEST_CASE(AddWithoutBatchThrows)
+{
+	IndirectCommandBuilder builder;
+	CHECK_THROWS(builder.Add(0, SphereDraw));
+	CHECK_EQUAL(0u, builder.GetCommandCount());
+}
+
+TEST_CASE(BatchesRecordFirstCommandAndCount)
+{
+	IndirectCommandBuilder builder;
+	BuildScene(builder);
+
+	CHECK_EQUAL(4u, builder.GetCommandCount());
+	CHECK_EQUAL(3u, builder.GetBatchCount());
+
+	const auto& batches = builder.GetBatches();
+	CHECK_EQUAL(0u, batches[0].FirstCommand);
+	CHECK_EQUAL(2u, batches[0].CommandCount);
+	CHECK_EQUAL(2u, batches[1].FirstCommand);
+	CHECK_EQUAL(0u, batches[1].CommandCount);
+	CHECK_EQUAL(2u, batches[2].FirstCommand);
+	CHECK_EQUAL(2u, batches[2].CommandCount);
+}
+
+TEST_CASE(CommandBytesMatchDrawIndexedArguments)
+{
+	IndirectCommandBuilder builder;
+	BuildScene(builder);
+
+	const uint32_t expectedObjects[] = { 0, 1, 4, 5 };
+	const D3D12_DRAW_INDEXED_ARGUMENTS* expectedDraws[] = { &SphereDraw, &CubeDraw, &TorusDraw, &TorusDraw };
+
+	const void* commands = builder.GetCommands().data();
+	for (uint32_t i = 0; i < builder.GetCommandCount(); ++i)
+	{
+		size_t offset = i * IndirectCommandBuilder::CommandStride;
+		const D3D12_DRAW_INDEXED_ARGUMENTS& draw = *expectedDraws[i];
+
+		CHECK_EQUAL(expectedObjects[i], ReadWord(commands, offset));
+		CHECK_EQUAL(draw.IndexCountPerInstance, ReadWord(commands, offset + 4));
+		CHECK_EQUAL(draw.InstanceCount, ReadWord(commands, offset + 8));
+		CHECK_EQUAL(draw.StartIndexLocation, ReadWord(commands, offset + 12));
+		CHECK_EQUAL(draw.BaseVertexLocation, static_cast<int32_t>(ReadWord(commands, offset + 16)));
+		CHECK_EQUAL(draw.StartInstanceLocation, ReadWord(commands, offset + 20));
+	}
+}
+
+TEST_CASE(CullItemsPointAtTheirBatch)
+{
+	IndirectCommandBuilder builder;
+	BuildScene(builder);
+
+	const auto& items = builder.GetCullItems();
+	CHECK_EQUAL(builder.GetCommandCount(), static_cast<uint32_t>(items.size()));
+
+	const uint32_t expectedBatches[] = { 0, 0, 2, 2 };
+	const uint32_t expectedFirstCommands[] = { 0, 0, 2, 2 };
+	for (size_t i = 0; i < items.size(); ++i)
+	{
+		CHECK_EQUAL(expectedBatches[i], items[i].Batch);
+		CHECK_EQUAL(expectedFirstCommands[i], items[i].BatchFirstCommand);
+
+		size_t offset = i * sizeof(IndirectCommandBuilder::CullItem);
+		CHECK_EQUAL(expectedBatches[i], ReadWord(items.data(), offset + 12));
+		CHECK_EQUAL(expectedFirstCommands[i], ReadWord(items.data(), offset + 28));
+	}
+
+	CHECK_EQUAL(50.0f, ReadFloat(items.data(), 32 + 0));
+	CHECK_EQUAL(2.0f, ReadFloat(items.data(), 32 + 20));
+	CHECK_EQUAL(3.0f, ReadFloat(items.data(), 32 + 24));
+	CHECK_EQUAL(FLT_MAX, items[2].Extents.x);
+	CHECK_EQUAL(-3.0f, ReadFloat(items.data(), 3 * 32 + 8));
+}
+
+TEST_CASE(ArgumentDescsSetObjectIndexThenDraw)
+{
+	D3D12_INDIRECT_ARGUMENT_DESC descs[IndirectCommandBuilder::ArgumentNum];
+	IndirectCommandBuilder::GetArgumentDescs(7, descs);
+
+	CHECK_EQUAL(2u, IndirectCommandBuilder::ArgumentNum);
+	CHECK_EQUAL(D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT, descs[0].Type);
+	CHECK_EQUAL(7u, descs[0].Constant.RootParameterIndex);
+	CHECK_EQUAL(0u, descs[0].Constant.DestOffsetIn32BitValues);
+	CHECK_EQUAL(1u, descs[0].Constant.Num32BitValuesToSet);
+	CHECK_EQUAL(D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED, descs[1].Type);
+}
+
+TEST_CASE(CompactionKeepsVisibleCommandsInTheirBatch)
+{
+	IndirectCommandBuilder builder;
+	BuildScene(builder);
+
+	// Axis-aligned box |x|, |y|, |z| <= 10.
+	const XMFLOAT4 planes[6] =
+	{
+		{ 1.0f, 0.0f, 0.0f, 10.0f }, { -1.0f, 0.0f, 0.0f, 10.0f },
+		{ 0.0f, 1.0f, 0.0f, 10.0f }, { 0.0f, -1.0f, 0.0f, 10.0f },
+		{ 0.0f, 0.0f, 1.0f, 10.0f }, { 0.0f, 0.0f, -1.0f, 10.0f },
+	};
+
+	const auto& items = builder.GetCullItems();
+	std::vector<IndirectCommandBuilder::Command> output(builder.GetCommandCount());
+	std::vector<uint32_t> counters(builder.GetBatchCount());
+	for (uint32_t i = 0; i < builder.GetCommandCount(); ++i)
+	{
+		if (!IsVisible(planes, items[i])) continue;
+
+		uint32_t slot = counters[items[i].Batch]++;
+		output[items[i].BatchFirstCommand + slot] = builder.GetCommands()[i];
+	}
+
+	CHECK_EQUAL(1u, counters[0]);
+	CHECK_EQUAL(0u, counters[1]);
+	CHECK_EQUAL(2u, counters[2]);
+	CHECK_EQUAL(0u, output[0].ObjectIndex);
+	CHECK_EQUAL(9u, output[2].ObjectIndex + output[3].ObjectIndex);
+}
+
+TEST_CASE(ClearRemovesEverything)
+{
+	IndirectCommandBuilder builder;
+	BuildScene(builder);
+	builder.Clear();
+
+	CHECK_EQUAL(0u, builder.GetCommandCount());
+	CHECK_EQUAL(0u, builder.GetBatchCount());
+	CHECK(builder.GetCullItems().empty());
+	CHECK_THROWS(builder.Add(0, SphereDraw));
+}
@@ -0,0 +1,88 @@
+#include "MeshCache.h"
+#include "CommandList.h"
+#include "TestHarness.h"
+
+#include <fstream>
+
+namespace
+{
+	// A fresh cache directory per test case.
+	fs::path MakeCacheDirectory(const char* name)
+	{
+		fs::path directory = fs::temp_directory_path() / "MeshCacheTests" / name;
+		fs::remove_all(directory);
+		return directory;
+	}
+
+	std::vector<fs::path> ListFiles(const fs::path& directory)
+	{
+		std::vector<fs::path> files;
+		for (const fs::directory_entry& entry : fs::directory_iterator(directory))
+		{
+			files.push_back(entry.path());
+		}
+		return files;
+	}
+
+	MeshCache::Statistics LoadSphere(const fs::path& directory)
+	{
+		CommandList commandList;
+		MeshCache cache(directory.wstring());
+		std::shared_ptr<Mesh> mesh = cache.GetSphere(commandList, 1.0f, 12);
+		CHECK(mesh != nullptr);
+		return cache.GetStatistics();
+	}
+
+	void PatchHeader(const fs::path& file, size_t offset, uint32_t value)
+	{
+		std::fstream stream(file, std::ios::binary | std::ios::in | std::ios::out);
+		stream.seekp(offset);
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+}
+
+TEST_CASE(CacheFileNameCarriesTheCacheVersion)
+{
+	fs::path directory = MakeCacheDirectory("Name");
+	LoadSphere(directory);
+
+	std::vector<fs::path> files = ListFiles(directory);
+	CHECK_EQUAL(1u, files.size());
+
+	std::string suffix = "_v" + std::to_string(MeshCache::CacheVersion) + ".mesh";
+	std::string name = files[0].filename().string();
+	CHECK(name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+TEST_CASE(SecondCacheLoadsTheBakedFile)
+{
+	fs::path directory = MakeCacheDirectory("Reload");
+	CHECK_EQUAL(0u, LoadSphere(directory).FileLoads);
+	CHECK_EQUAL(1u, LoadSphere(directory).FileLoads);
+}
+
+TEST_CASE(TruncatedFileIsRegenerated)
+{
+	fs::path directory = MakeCacheDirectory("Truncated");
+	LoadSphere(directory);
+
+	fs::path file = ListFiles(directory)[0];
+	fs::resize_file(file, sizeof(MeshFileHeader) / 2);
+
+	MeshCache::Statistics statistics = LoadSphere(directory);
+	CHECK_EQUAL(0u, statistics.FileLoads);
+	CHECK_EQUAL(1u, statistics.Misses);
+	CHECK_EQUAL(1u, LoadSphere(directory).FileLoads);
+}
+
+TEST_CASE(HeaderVersionMismatchIsRegenerated)
+{
+	fs::path directory = MakeCacheDirectory("Version");
+	LoadSphere(directory);
+
+	fs::path file = ListFiles(directory)[0];
+	PatchHeader(file, offsetof(MeshFileHeader, Version), MeshFileHeader::FileVersion + 1);
+
+	CHECK_EQUAL(0u, LoadSphere(directory).FileLoads);
+	CHECK_EQUAL(1u, LoadSphere(directory).FileLoads);
+}
@@ -0,0 +1,42 @@
+#include "Mesh.h"
+#include "MeshFile.h"
+#include "TestHarness.h"
+
+// Load time of a baked .mesh file against generating and processing the same mesh at startup.
+TEST_CASE(LoadBakedSpheres)
+{
+	fs::path directory = fs::temp_directory_path() / "MeshFileBenchmark";
+	fs::create_directories(directory);
+
+	printf("%12s %9s %10s %9s %10s %12s %14s %9s\n", "tessellation", "vertices", "file KB", "bake ms", "open ms", "from file ms", "generate ms", "speedup");
+	for (size_t tessellation : { 64, 256, 768 })
+	{
+		std::wstring fileName = (directory / ("Sphere" + std::to_string(tessellation) + ".mesh")).wstring();
+
+		double bakeTime = Test::Measure(1, [&]()
+		{
+			VertexCollection vertices;
+			IndexCollection indices;
+			Mesh::GenerateSphere(vertices, indices, 1.0f, tessellation);
+			Mesh::Convert(fileName, vertices, indices);
+		});
+
+		MeshFile file;
+		double openTime = Test::Measure(5, [&]()
+		{
+			file.Close();
+			CHECK(file.Open(fileName));
+		});
+		uint32_t vertexCount = file.GetHeader().VertexCount;
+		file.Close();
+
+		// The geometry arena double keeps every upload, so the full loads run only a few times and
+		// the runtime generate path, which takes seconds at the top end, only once.
+		CommandList commandList;
+		double loadTime = Test::Measure(3, [&]() { CHECK(Mesh::CreateFromFile(commandList, fileName) != nullptr); });
+		double generateTime = Test::Measure(1, [&]() { CHECK(Mesh::CreateSphere(commandList, 1.0f, tessellation) != nullptr); });
+
+		printf("%12zu %9u %10ju %9.2f %10.3f %12.3f %14.3f %8.1fx\n", tessellation, vertexCount, static_cast<uintmax_t>(fs::file_size(directory / ("Sphere" + std::to_string(tessellation) + ".mesh")) / 1024),
+			bakeTime, openTime, loadTime, generateTime, generateTime / loadTime);
+	}
+}
@@ -0,0 +1,117 @@
+#include "Mesh.h"
+#include "MeshFile.h"
+#include "TestHarness.h"
+
+#include <fstream>
+
+namespace
+{
+	fs::path GetTempFile(const char* name)
+	{
+		fs::path directory = fs::temp_directory_path() / "MeshFileTests";
+		fs::create_directories(directory);
+		return directory / name;
+	}
+
+	std::vector<uint8_t> BakeSphere()
+	{
+		fs::path path = GetTempFile("Sphere.mesh");
+		VertexCollection vertices;
+		IndexCollection indices;
+		Mesh::GenerateSphere(vertices, indices, 1.0f, 24);
+		Mesh::Convert(path.wstring(), vertices, indices);
+
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	template<typename T>
+	T* GetArray(std::vector<uint8_t>& bytes, const MeshFileBlob& blob)
+	{
+		return reinterpret_cast<T*>(bytes.data() + blob.Offset);
+	}
+
+	// Writes a patched copy of a baked file and reports whether MeshFile accepts it.
+	template<typename Function>
+	bool OpensAfter(Function patch)
+	{
+		std::vector<uint8_t> bytes = BakeSphere();
+		MeshFileHeader& header = *reinterpret_cast<MeshFileHeader*>(bytes.data());
+		patch(bytes, header);
+
+		fs::path path = GetTempFile("Patched.mesh");
+		{
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		}
+
+		MeshFile file;
+		return file.Open(path.wstring());
+	}
+}
+
+TEST_CASE(BakedFileValidates)
+{
+	CHECK(OpensAfter([](std::vector<uint8_t>&, MeshFileHeader& header)
+	{
+		CHECK(header.MeshletCount > 1);
+		CHECK(header.LodCount > 1);
+	}));
+}
+
+TEST_CASE(TruncatedFileIsRejected)
+{
+	CHECK(!OpensAfter([](std::vector<uint8_t>& bytes, MeshFileHeader&) { bytes.resize(bytes.size() - 64); }));
+	CHECK(!OpensAfter([](std::vector<uint8_t>& bytes, MeshFileHeader&) { bytes.resize(sizeof(MeshFileHeader) - 1); }));
+}
+
+TEST_CASE(HeaderMismatchIsRejected)
+{
+	CHECK(!OpensAfter([](std::vector<uint8_t>&, MeshFileHeader& header) { ++header.Version; }));
+	CHECK(!OpensAfter([](std::vector<uint8_t>&, MeshFileHeader& header) { header.IndexSize = 3; }));
+	CHECK(!OpensAfter([](std::vector<uint8_t>&, MeshFileHeader& header) { ++header.VertexCount; }));
+}
+
+TEST_CASE(MeshletRangesOutsideTheirBlobsAreRejected)
+{
+	CHECK(!OpensAfter([](std::vector<uint8_t>& bytes, MeshFileHeader& header)
+	{
+		GetArray<Meshlet>(bytes, header.Meshlets)[header.MeshletCount - 1].VertexOffset = static_cast<uint32_t>(header.MeshletVertices.Size / sizeof(uint32_t));
+	}));
+	CHECK(!OpensAfter([](std::vector<uint8_t>& bytes, MeshFileHeader& header)
+	{
+		GetArray<Meshlet>(bytes, header.Meshlets)[0].PrimitiveCount = static_cast<uint32_t>(header.MeshletPrimitives.Size / sizeof(uint32_t)) + 1;
+	}));
+	CHECK(!OpensAfter([](std::vector<uint8_t>& bytes, MeshFileHeader& header)
+	{
+		// Still inside the primitive list, but past the end of the index buffer.
+		header.IndexCount = GetArray<Meshlet>(bytes, header.Meshlets)[header.MeshletCount - 1].PrimitiveOffset * 3;
+		header.Indices.Size = static_cast<uint64_t>(header.IndexCount) * header.IndexSize;
+		header.LodCount = 0;
+		header.Lods.Size = 0;
+	}));
+}
+
+TEST_CASE(MeshletIndicesOutOfRangeAreRejected)
+{
+	CHECK(!OpensAfter([](std::vector<uint8_t>& bytes, MeshFileHeader& header)
+	{
+		GetArray<uint32_t>(bytes, header.MeshletVertices)[0] = header.VertexCount;
+	}));
+	CHECK(!OpensAfter([](std::vector<uint8_t>& bytes, MeshFileHeader& header)
+	{
+		const Meshlet& meshlet = GetArray<Meshlet>(bytes, header.Meshlets)[1];
+		GetArray<uint32_t>(bytes, header.MeshletPrimitives)[meshlet.PrimitiveOffset] = MeshletBuilder::PackPrimitive(0, meshlet.VertexCount, 1);
+	}));
+}
+
+TEST_CASE(CreateFromFileThrowsOnInvalidFile)
+{
+	CommandList commandList;
+	fs::path path = GetTempFile("Garbage.mesh");
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file << "not a mesh";
+	}
+	CHECK_THROWS(Mesh::CreateFromFile(commandList, path.wstring()));
+}
@@ -0,0 +1,291 @@
+#include "Mesh.h"
+#include "JobSystem.h"
+#include "TestHarness.h"
+
+using namespace DirectX;
+
+// The scalar generators Mesh used before they were vectorized, kept as the reference. Constants
+// the test DirectXMath subset lacks are spelled out with XMVectorSet.
+namespace Reference
+{
+	void GenerateSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation)
+	{
+		float radius = diameter / 2.0f;
+		size_t verticalSegments = tessellation;
+		size_t horizontalSegments = tessellation * 2;
+
+		for (size_t i = 0; i <= verticalSegments; i++)
+		{
+			float v = 1 - (float)i / verticalSegments;
+
+			float latitude = (i * XM_PI / verticalSegments) - XM_PIDIV2;
+			float dy, dxz;
+			XMScalarSinCos(&dy, &dxz, latitude);
+
+			for (size_t j = 0; j <= horizontalSegments; j++)
+			{
+				float u = (float)j / horizontalSegments;
+
+				float longitude = j * XM_2PI / horizontalSegments;
+				float dx, dz;
+				XMScalarSinCos(&dx, &dz, longitude);
+
+				dx *= dxz;
+				dz *= dxz;
+
+				XMVECTOR normal = XMVectorSet(dx, dy, dz, 0);
+				XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
+				vertices.push_back(VertexPositionNormalTexture(normal * radius, normal, textureCoordinate));
+			}
+		}
+
+		size_t stride = horizontalSegments + 1;
+		for (size_t i = 0; i < verticalSegments; i++)
+		{
+			for (size_t j = 0; j <= horizontalSegments; j++)
+			{
+				size_t nextI = i + 1;
+				size_t nextJ = (j + 1) % stride;
+
+				indices.push_back(static_cast<uint32_t>(i * stride + j));
+				indices.push_back(static_cast<uint32_t>(nextI * stride + j));
+				indices.push_back(static_cast<uint32_t>(i * stride + nextJ));
+
+				indices.push_back(static_cast<uint32_t>(i * stride + nextJ));
+				indices.push_back(static_cast<uint32_t>(nextI * stride + j));
+				indices.push_back(static_cast<uint32_t>(nextI * stride + nextJ));
+			}
+		}
+	}
+
+	XMVECTOR GetCircleVector(size_t i, size_t tessellation)
+	{
+		float angle = i * XM_2PI / tessellation;
+		float dx, dz;
+		XMScalarSinCos(&dx, &dz, angle);
+		return XMVectorSet(dx, 0, dz, 0);
+	}
+
+	XMVECTOR GetCircleTangent(size_t i, size_t tessellation)
+	{
+		float angle = (i * XM_2PI / tessellation) + XM_PIDIV2;
+		float dx, dz;
+		XMScalarSinCos(&dx, &dz, angle);
+		return XMVectorSet(dx, 0, dz, 0);
+	}
+
+	void CreateCylinderCap(VertexCollection& vertices, IndexCollection& indices, size_t tessellation, float height, float radius, bool isTop)
+	{
+		for (size_t i = 0; i < tessellation - 2; i++)
+		{
+			size_t i1 = (i + 1) % tessellation;
+			size_t i2 = (i + 2) % tessellation;
+			if (isTop)
+			{
+				std::swap(i1, i2);
+			}
+
+			size_t vbase = vertices.size();
+			indices.push_back(static_cast<uint32_t>(vbase));
+			indices.push_back(static_cast<uint32_t>(vbase + i1));
+			indices.push_back(static_cast<uint32_t>(vbase + i2));
+		}
+
+		XMVECTOR normal = XMVectorSet(0, 1, 0, 0);
+		XMVECTOR textureScale = XMVectorReplicate(-0.5f);
+		if (!isTop)
+		{
+			normal = -normal;
+			textureScale = XMVectorSet(0.5f, -0.5f, -0.5f, -0.5f);
+		}
+
+		for (size_t i = 0; i < tessellation; i++)
+		{
+			XMVECTOR circleVector = GetCircleVector(i, tessellation);
+			XMVECTOR position = (circleVector * radius) + (normal * height);
+			XMVECTOR textureCoordinate = XMVectorMultiplyAdd(XMVectorSet(XMVectorGetX(circleVector), XMVectorGetZ(circleVector), 0, 0), textureScale, XMVectorReplicate(0.5f));
+			vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+		}
+	}
+
+	void GenerateCone(VertexCollection& vertices, IndexCollection& indices, float diameter, float height, size_t tessellation)
+	{
+		height /= 2;
+		XMVECTOR topOffset = XMVectorSet(0, height, 0, 0);
+
+		float radius = diameter / 2;
+		size_t stride = tessellation + 1;
+
+		for (size_t i = 0; i <= tessellation; i++)
+		{
+			XMVECTOR circlevec = GetCircleVector(i, tessellation);
+			XMVECTOR sideOffset = circlevec * radius;
+
+			float u = (float)i / tessellation;
+
+			XMVECTOR pt = sideOffset - topOffset;
+			XMVECTOR normal = XMVector3Normalize(XMVector3Cross(GetCircleTangent(i, tessellation), topOffset - pt));
+
+			vertices.push_back(VertexPositionNormalTexture(topOffset, normal, XMVectorZero()));
+			vertices.push_back(VertexPositionNormalTexture(pt, normal, XMVectorSet(u, 1, 0, 0)));
+
+			indices.push_back(static_cast<uint32_t>(i * 2));
+			indices.push_back(static_cast<uint32_t>((i * 2 + 3) % (stride * 2)));
+			indices.push_back(static_cast<uint32_t>((i * 2 + 1) % (stride * 2)));
+		}
+
+		CreateCylinderCap(vertices, indices, tessellation, height, radius, false);
+	}
+
+	void GenerateTorus(VertexCollection& vertices, IndexCollection& indices, float diameter, float thickness, size_t tessellation)
+	{
+		size_t stride = tessellation + 1;
+
+		for (size_t i = 0; i <= tessellation; i++)
+		{
+			float u = (float)i / tessellation;
+
+			float outerAngle = i * XM_2PI / tessellation - XM_PIDIV2;
+			XMMATRIX transform = XMMatrixTranslation(diameter / 2, 0, 0) * XMMatrixRotationY(outerAngle);
+
+			for (size_t j = 0; j <= tessellation; j++)
+			{
+				float v = 1 - (float)j / tessellation;
+
+				float innerAngle = j * XM_2PI / tessellation + XM_PI;
+				float dx, dy;
+				XMScalarSinCos(&dy, &dx, innerAngle);
+
+				XMVECTOR normal = XMVectorSet(dx, dy, 0, 0);
+				XMVECTOR position = normal * thickness / 2;
+				XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
+
+				position = XMVector3Transform(position, transform);
+				normal = XMVector3TransformNormal(normal, transform);
+				vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+
+				size_t nextI = (i + 1) % stride;
+				size_t nextJ = (j + 1) % stride;
+
+				indices.push_back(static_cast<uint32_t>(i * stride + j));
+				indices.push_back(static_cast<uint32_t>(i * stride + nextJ));
+				indices.push_back(static_cast<uint32_t>(nextI * stride + j));
+
+				indices.push_back(static_cast<uint32_t>(i * stride + nextJ));
+				indices.push_back(static_cast<uint32_t>(nextI * stride + nextJ));
+				indices.push_back(static_cast<uint32_t>(nextI * stride + j));
+			}
+		}
+	}
+}
+
+namespace
+{
+	const float MaxError = 1e-5f;
+
+	enum class Shape
+	{
+		Sphere,
+		Cone,
+		Torus,
+	};
+
+	const char* ShapeNames[] = { "sphere", "cone", "torus" };
+
+	void Generate(Shape shape, bool reference, VertexCollection& vertices, IndexCollection& indices, size_t tessellation)
+	{
+		vertices.clear();
+		indices.clear();
+		switch (shape)
+		{
+		case Shape::Sphere:
+			reference ? Reference::GenerateSphere(vertices, indices, 1.0f, tessellation) : Mesh::GenerateSphere(vertices, indices, 1.0f, tessellation);
+			break;
+		case Shape::Cone:
+			reference ? Reference::GenerateCone(vertices, indices, 1.0f, 1.0f, tessellation) : Mesh::GenerateCone(vertices, indices, 1.0f, 1.0f, tessellation);
+			break;
+		case Shape::Torus:
+			reference ? Reference::GenerateTorus(vertices, indices, 1.0f, 0.333f, tessellation) : Mesh::GenerateTorus(vertices, indices, 1.0f, 0.333f, tessellation);
+			break;
+		}
+	}
+
+	// Largest component difference across positions, normals and texture coordinates, or
+	// infinity when the vertex counts or index buffers differ.
+	float Compare(const VertexCollection& expected, const IndexCollection& expectedIndices, const VertexCollection& actual, const IndexCollection& actualIndices)
+	{
+		if (expected.size() != actual.size() || expectedIndices != actualIndices) return INFINITY;
+
+		float error = 0.0f;
+		for (size_t i = 0; i < expected.size(); ++i)
+		{
+			const VertexPositionNormalTexture& a = expected[i];
+			const VertexPositionNormalTexture& b = actual[i];
+			error = std::max({ error,
+				std::fabs(a.position.x - b.position.x), std::fabs(a.position.y - b.position.y), std::fabs(a.position.z - b.position.z),
+				std::fabs(a.normal.x - b.normal.x), std::fabs(a.normal.y - b.normal.y), std::fabs(a.normal.z - b.normal.z),
+				std::fabs(a.textureCoordinate.x - b.textureCoordinate.x), std::fabs(a.textureCoordinate.y - b.textureCoordinate.y) });
+		}
+		return error;
+	}
+}
+
+TEST_CASE(GeneratorsMatchScalarReference)
+{
+	for (Shape shape : { Shape::Sphere, Shape::Cone, Shape::Torus })
+	{
+		for (size_t tessellation : { 3, 4, 5, 7, 16, 33, 100 })
+		{
+			VertexCollection expected, actual;
+			IndexCollection expectedIndices, actualIndices;
+			Generate(shape, true, expected, expectedIndices, tessellation);
+			Generate(shape, false, actual, actualIndices, tessellation);
+			CHECK(Compare(expected, expectedIndices, actual, actualIndices) < MaxError);
+		}
+	}
+}
+
+TEST_CASE(GeneratorsAgainstScalarReference)
+{
+	// Create adds meshlets, LODs and the upload on top of the generator; at 2048 that takes
+	// minutes, so it is only timed at the smaller tessellations.
+	printf("%7s %12s %10s %13s %10s %8s %10s %10s\n", "shape", "tessellation", "vertices", "reference ms", "vector ms", "speedup", "max error", "create ms");
+	CommandList commandList;
+	for (Shape shape : { Shape::Sphere, Shape::Cone, Shape::Torus })
+	{
+		for (size_t tessellation : { 16, 256, 2048 })
+		{
+			int repeat = tessellation < 2048 ? 5 : 1;
+			VertexCollection expected, actual;
+			IndexCollection expectedIndices, actualIndices;
+			double referenceTime = Test::Measure(repeat, [&]() { Generate(shape, true, expected, expectedIndices, tessellation); });
+			double vectorTime = Test::Measure(repeat, [&]() { Generate(shape, false, actual, actualIndices, tessellation); });
+			float error = Compare(expected, expectedIndices, actual, actualIndices);
+			CHECK(error < MaxError);
+
+			size_t vertexNum = actual.size();
+			VertexCollection().swap(expected);
+			IndexCollection().swap(expectedIndices);
+			VertexCollection().swap(actual);
+			IndexCollection().swap(actualIndices);
+
+			char createTime[16] = "-";
+			if (tessellation <= 256)
+			{
+				double time = Test::Measure(1, [&]()
+				{
+					switch (shape)
+					{
+					case Shape::Sphere: Mesh::CreateSphere(commandList, 1.0f, tessellation); break;
+					case Shape::Cone: Mesh::CreateCone(commandList, 1.0f, 1.0f, tessellation); break;
+					case Shape::Torus: Mesh::CreateTorus(commandList, 1.0f, 0.333f, tessellation); break;
+					}
+				});
+				snprintf(createTime, sizeof(createTime), "%.2f", time);
+			}
+
+			printf("%7s %12zu %10zu %13.3f %10.3f %7.1fx %10.1e %10s\n", ShapeNames[static_cast<int>(shape)], tessellation, vertexNum, referenceTime, vectorTime, referenceTime / vectorTime, error, createTime);
+		}
+	}
+	printf("%u job system workers\n", JobSystem::Get().GetWorkerCount() + 1);
+}
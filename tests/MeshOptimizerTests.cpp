@@ -0,0 +1,171 @@
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "TestHarness.h"
+
+#include <random>
+
+namespace
+{
+	// A triangle as its three indices rotated so the smallest comes first, which keeps the winding.
+	struct Triangle
+	{
+		uint32_t Indices[3];
+
+		bool operator<(const Triangle& other) const
+		{
+			return std::lexicographical_compare(Indices, Indices + 3, other.Indices, other.Indices + 3);
+		}
+
+		bool operator==(const Triangle& other) const
+		{
+			return std::equal(Indices, Indices + 3, other.Indices);
+		}
+	};
+
+	std::vector<Triangle> GetTriangles(const std::vector<uint32_t>& indices)
+	{
+		std::vector<Triangle> triangles(indices.size() / 3);
+		for (size_t i = 0; i < triangles.size(); ++i)
+		{
+			const uint32_t* t = &indices[i * 3];
+			size_t first = std::min_element(t, t + 3) - t;
+			for (size_t k = 0; k < 3; ++k)
+			{
+				triangles[i].Indices[k] = t[(first + k) % 3];
+			}
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	// A grid whose triangles are shuffled, so the input order has no locality at all.
+	std::vector<uint32_t> CreateShuffledGrid(uint32_t size, std::vector<float>& positions)
+	{
+		positions.clear();
+		for (uint32_t y = 0; y <= size; ++y)
+		{
+			for (uint32_t x = 0; x <= size; ++x)
+			{
+				positions.insert(positions.end(), { static_cast<float>(x), static_cast<float>(y), 0.0f });
+			}
+		}
+
+		std::vector<Triangle> triangles;
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				uint32_t i = y * (size + 1) + x;
+				triangles.push_back({ { i, i + size + 1, i + 1 } });
+				triangles.push_back({ { i + 1, i + size + 1, i + size + 2 } });
+			}
+		}
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937(7));
+
+		std::vector<uint32_t> indices;
+		for (const Triangle& triangle : triangles)
+		{
+			indices.insert(indices.end(), triangle.Indices, triangle.Indices + 3);
+		}
+		return indices;
+	}
+}
+
+TEST_CASE(EmptyInputIsHandled)
+{
+	std::vector<uint32_t> indices;
+	VertexCacheStatistics statistics = MeshOptimizer::AnalyzeVertexCache(indices, 0);
+	CHECK_EQUAL(0u, statistics.VerticesTransformed);
+
+	std::vector<uint32_t> clusters(3, 1);
+	CHECK(MeshOptimizer::OptimizeVertexCache(indices, 0, 16, &clusters).empty());
+	CHECK(clusters.empty());
+	CHECK(MeshOptimizer::OptimizeOverdraw(indices, clusters, nullptr, 0, 12).empty());
+
+	size_t uniqueVertexNum = 1;
+	CHECK(MeshOptimizer::OptimizeVertexFetchRemap(indices, 0, uniqueVertexNum).empty());
+	CHECK_EQUAL(0u, uniqueVertexNum);
+}
+
+TEST_CASE(EmptyMeshCreatesSingleEmptyLod)
+{
+	CommandList commandList;
+	for (VertexFormat format : { VertexFormat::Float, VertexFormat::Quantized })
+	{
+		VertexCollection vertices;
+		IndexCollection indices;
+		std::unique_ptr<Mesh> mesh = Mesh::Create(commandList, vertices, indices, false, format);
+		CHECK_EQUAL(1u, mesh->GetLodCount());
+		CHECK_EQUAL(0u, mesh->GetLod(0).IndexCount);
+		CHECK(mesh->GetMeshlets().Meshlets.empty());
+	}
+
+	// Vertices no triangle references are dropped, as the optimizer would drop them.
+	VertexCollection vertices(3);
+	IndexCollection indices;
+	std::unique_ptr<Mesh> mesh = Mesh::Create(commandList, vertices, indices);
+	CHECK(vertices.empty());
+	CHECK_EQUAL(0u, mesh->GetLod(0).IndexCount);
+}
+
+TEST_CASE(VertexCacheOptimizationKeepsTrianglesAndLowersACMR)
+{
+	std::vector<float> positions;
+	std::vector<uint32_t> indices = CreateShuffledGrid(48, positions);
+	size_t vertexNum = positions.size() / 3;
+
+	std::vector<uint32_t> clusters;
+	std::vector<uint32_t> optimized = MeshOptimizer::OptimizeVertexCache(indices, vertexNum, 16, &clusters);
+	CHECK(GetTriangles(indices) == GetTriangles(optimized));
+
+	CHECK(!clusters.empty());
+	CHECK_EQUAL(0u, clusters[0]);
+	CHECK(std::is_sorted(clusters.begin(), clusters.end()));
+
+	VertexCacheStatistics before = MeshOptimizer::AnalyzeVertexCache(indices, vertexNum);
+	VertexCacheStatistics after = MeshOptimizer::AnalyzeVertexCache(optimized, vertexNum);
+	CHECK(before.ACMR > 1.5f);
+	CHECK(after.ACMR < 0.8f);
+	CHECK(after.ATVR < before.ATVR);
+}
+
+TEST_CASE(OverdrawOptimizationKeepsTrianglesAndCacheEfficiency)
+{
+	std::vector<float> positions;
+	std::vector<uint32_t> indices = CreateShuffledGrid(48, positions);
+	size_t vertexNum = positions.size() / 3;
+
+	std::vector<uint32_t> clusters;
+	std::vector<uint32_t> cacheOptimized = MeshOptimizer::OptimizeVertexCache(indices, vertexNum, 16, &clusters);
+	std::vector<uint32_t> optimized = MeshOptimizer::OptimizeOverdraw(cacheOptimized, clusters, positions.data(), vertexNum, sizeof(float) * 3, 16, 1.05f);
+	CHECK(GetTriangles(indices) == GetTriangles(optimized));
+
+	// Reordering clusters may cost at most the threshold in cache efficiency, plus cluster seams.
+	float cacheACMR = MeshOptimizer::AnalyzeVertexCache(cacheOptimized, vertexNum).ACMR;
+	CHECK(MeshOptimizer::AnalyzeVertexCache(optimized, vertexNum).ACMR <= cacheACMR * 1.1f);
+}
+
+TEST_CASE(VertexFetchRemapOrdersVerticesByFirstUse)
+{
+	std::vector<uint32_t> indices = { 4, 2, 0, 2, 4, 5 };
+	std::vector<int> vertices = { 10, 11, 12, 13, 14, 15 };
+
+	size_t uniqueVertexNum = 0;
+	std::vector<uint32_t> remap = MeshOptimizer::OptimizeVertexFetchRemap(indices, vertices.size(), uniqueVertexNum);
+	CHECK_EQUAL(4u, uniqueVertexNum);
+	CHECK(indices == std::vector<uint32_t>({ 0, 1, 2, 1, 0, 3 }));
+	CHECK_EQUAL(MeshOptimizer::InvalidIndex, remap[1]);
+	CHECK_EQUAL(MeshOptimizer::InvalidIndex, remap[3]);
+
+	std::vector<int> remapped = MeshOptimizer::RemapVertices(vertices, remap, uniqueVertexNum);
+	CHECK(remapped == std::vector<int>({ 14, 12, 10, 15 }));
+}
+
+TEST_CASE(MeshStatisticsReportImprovedACMR)
+{
+	CommandList commandList;
+	std::unique_ptr<Mesh> mesh = Mesh::CreateTorus(commandList, 1.0f, 0.333f, 48);
+	Mesh::Statistics statistics = mesh->GetStatistics();
+	CHECK(statistics.Optimized.ACMR <= statistics.Source.ACMR);
+	CHECK(statistics.Optimized.ATVR >= 1.0f);
+}
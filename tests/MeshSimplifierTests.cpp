@@ -0,0 +1,189 @@
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "TestHarness.h"
+
+using namespace DirectX;
+
+namespace
+{
+	const size_t Stride = sizeof(VertexPositionNormalTexture);
+
+	// The reported error is a quadric distance, an estimate rather than a strict bound on the
+	// surface deviation; measured deviations stay within this factor of it.
+	const float ErrorEstimateSlack = 1.25f;
+
+	const float* GetPositions(const VertexCollection& vertices)
+	{
+		return &vertices.data()->position.x;
+	}
+
+	// How far the surface sinks below the unit-diameter sphere, measured at triangle
+	// centroids and edge midpoints; the vertices themselves never move.
+	float GetSphereDeviation(const VertexCollection& vertices, const IndexCollection& indices)
+	{
+		float deviation = 0.0f;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			XMVECTOR p[3];
+			for (int k = 0; k < 3; ++k)
+			{
+				p[k] = XMLoadFloat3(&vertices[indices[i + k]].position);
+			}
+
+			XMVECTOR samples[] = { (p[0] + p[1] + p[2]) / 3.0f, (p[0] + p[1]) * 0.5f, (p[1] + p[2]) * 0.5f, (p[2] + p[0]) * 0.5f };
+			for (XMVECTOR sample : samples)
+			{
+				deviation = std::max(deviation, 0.5f - XMVectorGetX(XMVector3Length(sample)));
+			}
+		}
+		return deviation;
+	}
+
+	float GetArea(const VertexCollection& vertices, const IndexCollection& indices)
+	{
+		float area = 0.0f;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			XMVECTOR p0 = XMLoadFloat3(&vertices[indices[i + 0]].position);
+			XMVECTOR p1 = XMLoadFloat3(&vertices[indices[i + 1]].position);
+			XMVECTOR p2 = XMLoadFloat3(&vertices[indices[i + 2]].position);
+			area += XMVectorGetX(XMVector3Length(XMVector3Cross(p1 - p0, p2 - p0))) * 0.5f;
+		}
+		return area;
+	}
+
+	// A flat size x size grid of quads in the XZ plane, facing up.
+	void GenerateGrid(VertexCollection& vertices, IndexCollection& indices, uint32_t size)
+	{
+		for (uint32_t y = 0; y <= size; ++y)
+		{
+			for (uint32_t x = 0; x <= size; ++x)
+			{
+				vertices.push_back(VertexPositionNormalTexture(XMVectorSet(static_cast<float>(x), 0.0f, static_cast<float>(y), 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), XMVectorZero()));
+			}
+		}
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				uint32_t i = y * (size + 1) + x;
+				indices.insert(indices.end(), { i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2 });
+			}
+		}
+	}
+}
+
+TEST_CASE(EmptyInputSimplifiesToEmpty)
+{
+	IndexCollection indices;
+	float error = 1.0f;
+	CHECK(MeshSimplifier::Simplify(indices, nullptr, 0, Stride, 0, 1.0f, &error).empty());
+	CHECK_EQUAL(0.0f, error);
+	CHECK_EQUAL(0.0f, MeshSimplifier::ComputeExtent(nullptr, 0, Stride));
+}
+
+TEST_CASE(ReportedErrorBoundsSphereDeviation)
+{
+	VertexCollection vertices;
+	IndexCollection indices;
+	Mesh::GenerateSphere(vertices, indices, 1.0f, 32);
+
+	float baseDeviation = GetSphereDeviation(vertices, indices);
+	for (float targetError : { 0.002f, 0.005f, 0.05f })
+	{
+		float error = 0.0f;
+		IndexCollection simplified = MeshSimplifier::Simplify(indices, GetPositions(vertices), vertices.size(), Stride, indices.size() / 2, targetError, &error);
+		CHECK(simplified.size() < indices.size());
+		CHECK(error <= targetError);
+		CHECK(GetSphereDeviation(vertices, simplified) - baseDeviation <= error * ErrorEstimateSlack);
+	}
+}
+
+TEST_CASE(TargetErrorBoundsAccumulatedError)
+{
+	VertexCollection vertices;
+	IndexCollection indices;
+	Mesh::GenerateSphere(vertices, indices, 1.0f, 32);
+
+	// With no triangle target the simplifier keeps collapsing until the error budget is spent; a
+	// per-collapse limit would let the error grow far past it across chained collapses.
+	const float TargetError = 0.02f;
+	float error = 0.0f;
+	IndexCollection simplified = MeshSimplifier::Simplify(indices, GetPositions(vertices), vertices.size(), Stride, 0, TargetError, &error);
+	CHECK(simplified.size() * 4 < indices.size());
+	CHECK(error <= TargetError);
+	CHECK(GetSphereDeviation(vertices, simplified) - GetSphereDeviation(vertices, indices) <= TargetError * ErrorEstimateSlack);
+}
+
+TEST_CASE(FlatInteriorCollapsesWithoutError)
+{
+	VertexCollection vertices;
+	IndexCollection indices;
+	GenerateGrid(vertices, indices, 16);
+
+	// Interior vertices of a plane cost nothing to remove; the border is locked so the outline and
+	// with it the area stay exactly the same.
+	float error = 1.0f;
+	IndexCollection simplified = MeshSimplifier::Simplify(indices, GetPositions(vertices), vertices.size(), Stride, 0, 0.0f, &error);
+	CHECK(simplified.size() * 4 < indices.size());
+	CHECK_EQUAL(0.0f, error);
+	CHECK_NEAR(GetArea(vertices, indices), GetArea(vertices, simplified), 1e-3);
+}
+
+TEST_CASE(SeamVerticesStayLocked)
+{
+	// Every cube vertex shares its position with the other faces' copies.
+	VertexCollection vertices;
+	IndexCollection indices;
+	Mesh::GenerateCube(vertices, indices, 1.0f);
+
+	IndexCollection simplified = MeshSimplifier::Simplify(indices, GetPositions(vertices), vertices.size(), Stride, 0, 1.0f);
+	CHECK(simplified == indices);
+}
+
+TEST_CASE(MeshLodChains)
+{
+	CommandList commandList;
+
+	// Sphere and torus reach at least three LODs from tessellation 16 on; each level is smaller
+	// and its error no lower than the one before.
+	for (size_t tessellation : { 16, 32, 64 })
+	{
+		std::unique_ptr<Mesh> meshes[] = { Mesh::CreateSphere(commandList, 1.0f, tessellation), Mesh::CreateTorus(commandList, 1.0f, 0.333f, tessellation) };
+		for (const std::unique_ptr<Mesh>& mesh : meshes)
+		{
+			CHECK(mesh->GetLodCount() >= 3);
+			CHECK(mesh->GetLodCount() <= Mesh::MaxLodNum);
+			CHECK_EQUAL(0.0f, mesh->GetLod(0).Error);
+			for (uint32_t lod = 1; lod < mesh->GetLodCount(); ++lod)
+			{
+				CHECK(mesh->GetLod(lod).IndexCount < mesh->GetLod(lod - 1).IndexCount);
+				CHECK(mesh->GetLod(lod).Error >= mesh->GetLod(lod - 1).Error);
+			}
+		}
+	}
+
+	// The fallback: a mesh that cannot simplify keeps LOD0, and any LOD index clamps to it.
+	std::unique_ptr<Mesh> cube = Mesh::CreateCube(commandList);
+	CHECK_EQUAL(1u, cube->GetLodCount());
+	CHECK_EQUAL(cube->GetLodDrawArguments(0).IndexCountPerInstance, cube->GetLodDrawArguments(Mesh::MaxLodNum).IndexCountPerInstance);
+	CHECK_EQUAL(0u, cube->SelectLod(1000.0f, 1.0f, XMMatrixPerspectiveFovLH(XM_PIDIV4, 1.0f, 0.1f, 100.0f), 1080.0f));
+}
+
+TEST_CASE(SelectLodCoarsensWithDistance)
+{
+	CommandList commandList;
+	std::unique_ptr<Mesh> sphere = Mesh::CreateSphere(commandList, 1.0f, 32);
+	XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+	CHECK_EQUAL(0u, sphere->SelectLod(0.5f, 1.0f, projection, 1080.0f));
+	CHECK_EQUAL(sphere->GetLodCount() - 1, sphere->SelectLod(10000.0f, 1.0f, projection, 1080.0f));
+
+	uint32_t previous = 0;
+	for (float depth = 0.5f; depth < 10000.0f; depth *= 2.0f)
+	{
+		uint32_t lod = sphere->SelectLod(depth, 1.0f, projection, 1080.0f);
+		CHECK(lod >= previous);
+		previous = lod;
+	}
+}
@@ -0,0 +1,101 @@
+#include "Application.h"
+#include "Mesh.h"
+#include "TestHarness.h"
+
+namespace
+{
+	// A width x height grid of vertices, two triangles per cell.
+	void GenerateGrid(VertexCollection& vertices, IndexCollection& indices, uint32_t width, uint32_t height)
+	{
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				DirectX::XMVECTOR position = DirectX::XMVectorSet(static_cast<float>(x), 0.0f, static_cast<float>(y), 0.0f);
+				vertices.push_back(VertexPositionNormalTexture(position, DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), DirectX::XMVectorZero()));
+			}
+		}
+
+		for (uint32_t y = 0; y + 1 < height; ++y)
+		{
+			for (uint32_t x = 0; x + 1 < width; ++x)
+			{
+				uint32_t i = y * width + x;
+				indices.insert(indices.end(), { i, i + width, i + 1, i + 1, i + width, i + width + 1 });
+			}
+		}
+	}
+
+	// Checks the uploaded index format against the vertex count and reads the indices back,
+	// so a 16-bit buffer that silently wrapped would show up as an index out of range.
+	void CheckIndexFormat(const Mesh& mesh, DXGI_FORMAT expectedFormat)
+	{
+		GeometryArena& arena = Application::Get().GetGeometryArena();
+		const GeometryArena::Allocation& vertexAllocation = mesh.GetVertexAllocation();
+		const GeometryArena::Allocation& indexAllocation = mesh.GetIndexAllocation();
+		CHECK_EQUAL(expectedFormat, arena.GetIndexFormat(indexAllocation));
+		CHECK_EQUAL(expectedFormat == DXGI_FORMAT_R16_UINT, vertexAllocation.Count <= USHRT_MAX);
+
+		uint32_t maxIndex = 0;
+		for (uint32_t i = 0; i < indexAllocation.Count; ++i)
+		{
+			uint32_t index = expectedFormat == DXGI_FORMAT_R16_UINT ?
+				static_cast<const uint16_t*>(arena.GetData(indexAllocation))[i] :
+				static_cast<const uint32_t*>(arena.GetData(indexAllocation))[i];
+			maxIndex = std::max(maxIndex, index);
+		}
+		CHECK_EQUAL(vertexAllocation.Count - 1, maxIndex);
+	}
+}
+
+TEST_CASE(IndexFormatAtExactBoundary)
+{
+	CommandList commandList;
+
+	// 255 x 257 = 65535 vertices still fits 16-bit indices; 256 x 256 = 65536 does not.
+	VertexCollection vertices;
+	IndexCollection indices;
+	GenerateGrid(vertices, indices, 255, 257);
+	std::unique_ptr<Mesh> below = Mesh::Create(commandList, vertices, indices);
+	CHECK_EQUAL(65535u, below->GetVertexAllocation().Count);
+	CheckIndexFormat(*below, DXGI_FORMAT_R16_UINT);
+
+	vertices.clear();
+	indices.clear();
+	GenerateGrid(vertices, indices, 256, 256);
+	std::unique_ptr<Mesh> above = Mesh::Create(commandList, vertices, indices);
+	CHECK_EQUAL(65536u, above->GetVertexAllocation().Count);
+	CheckIndexFormat(*above, DXGI_FORMAT_R32_UINT);
+}
+
+TEST_CASE(SphereIndexFormatAroundBoundary)
+{
+	CommandList commandList;
+
+	// (t + 1) * (2t + 1) vertices: 65341 at 180, 66066 at 181.
+	std::unique_ptr<Mesh> below = Mesh::CreateSphere(commandList, 1.0f, 180);
+	CHECK_EQUAL(65341u, below->GetVertexAllocation().Count);
+	CheckIndexFormat(*below, DXGI_FORMAT_R16_UINT);
+
+	std::unique_ptr<Mesh> above = Mesh::CreateSphere(commandList, 1.0f, 181);
+	CHECK_EQUAL(66066u, above->GetVertexAllocation().Count);
+	CheckIndexFormat(*above, DXGI_FORMAT_R32_UINT);
+}
+
+TEST_CASE(TorusIndexFormatAroundBoundary)
+{
+	CommandList commandList;
+
+	// (t + 1)^2 vertices: 65025 at 254, 65536 at 255.
+	std::unique_ptr<Mesh> below = Mesh::CreateTorus(commandList, 1.0f, 0.333f, 254);
+	CHECK_EQUAL(65025u, below->GetVertexAllocation().Count);
+	CheckIndexFormat(*below, DXGI_FORMAT_R16_UINT);
+
+	std::unique_ptr<Mesh> above = Mesh::CreateTorus(commandList, 1.0f, 0.333f, 255);
+	CHECK_EQUAL(65536u, above->GetVertexAllocation().Count);
+	CheckIndexFormat(*above, DXGI_FORMAT_R32_UINT);
+
+	// Quantized vertices take the same path.
+	std::unique_ptr<Mesh> quantized = Mesh::CreateTorus(commandList, 1.0f, 0.333f, 255, false, VertexFormat::Quantized);
+	CheckIndexFormat(*quantized, DXGI_FORMAT_R32_UINT);
+}
@@ -0,0 +1,275 @@
+#include "Mesh.h"
+#include "Meshlet.h"
+#include "TestHarness.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	struct TestMesh
+	{
+		const char* Name;
+		VertexCollection Vertices;
+		IndexCollection Indices;
+		MeshletData Meshlets;
+	};
+
+	const float* GetPositions(const VertexCollection& vertices)
+	{
+		return &vertices.data()->position.x;
+	}
+
+	// The generated shapes plus a triangle soup, so meshlets fill up on primitives as well as vertices.
+	std::vector<TestMesh> CreateMeshes()
+	{
+		std::vector<TestMesh> meshes(4);
+		meshes[0].Name = "sphere";
+		Mesh::GenerateSphere(meshes[0].Vertices, meshes[0].Indices, 2.0f, 24);
+		meshes[1].Name = "torus";
+		Mesh::GenerateTorus(meshes[1].Vertices, meshes[1].Indices, 2.0f, 0.5f, 32);
+		meshes[2].Name = "cube";
+		Mesh::GenerateCube(meshes[2].Vertices, meshes[2].Indices, 1.0f);
+
+		meshes[3].Name = "soup";
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+		for (int i = 0; i < 300; ++i)
+		{
+			meshes[3].Vertices.push_back(VertexPositionNormalTexture(XMVectorSet(position(random), position(random), position(random), 0.0f), XMVectorZero(), XMVectorZero()));
+		}
+		std::uniform_int_distribution<uint32_t> vertex(0, 7);
+		for (int i = 0; i < 1000; ++i)
+		{
+			// Triangles over a small window of vertices, so many share vertices within a meshlet.
+			uint32_t base = (i / 4) % 290;
+			meshes[3].Indices.insert(meshes[3].Indices.end(), { base + vertex(random), base + 8 + vertex(random) % 2, base + 2 + vertex(random) % 6 });
+		}
+
+		for (TestMesh& mesh : meshes)
+		{
+			// Meshes build meshlets from cache-optimized indices, which keeps clusters compact.
+			mesh.Indices = MeshOptimizer::OptimizeVertexCache(mesh.Indices, mesh.Vertices.size());
+			mesh.Meshlets = MeshletBuilder::Build(mesh.Indices, GetPositions(mesh.Vertices), mesh.Vertices.size(), sizeof(VertexPositionNormalTexture));
+		}
+		return meshes;
+	}
+
+	XMVECTOR GetVertex(const TestMesh& mesh, const Meshlet& meshlet, uint32_t local)
+	{
+		return XMLoadFloat3(&mesh.Vertices[mesh.Meshlets.UniqueVertexIndices[meshlet.VertexOffset + local]].position);
+	}
+
+	// Planes every point passes, so only the normal cone decides.
+	void GetAllPassPlanes(XMFLOAT4 planes[6])
+	{
+		for (int i = 0; i < 6; ++i)
+		{
+			planes[i] = XMFLOAT4(i % 3 == 0 ? 1.0f : 0.0f, i % 3 == 1 ? 1.0f : 0.0f, i % 3 == 2 ? 1.0f : 0.0f, 1e9f);
+		}
+	}
+
+	bool IsSphereInsidePlanes(const XMFLOAT4& sphere, const XMFLOAT4 planes[6])
+	{
+		for (int i = 0; i < 6; ++i)
+		{
+			if (planes[i].x * sphere.x + planes[i].y * sphere.y + planes[i].z * sphere.z + planes[i].w < -sphere.w) return false;
+		}
+		return true;
+	}
+
+	std::vector<XMFLOAT3> CreateCameraPositions(uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::normal_distribution<float> gaussian;
+		std::uniform_real_distribution<float> distance(1.5f, 20.0f);
+
+		std::vector<XMFLOAT3> positions(200);
+		for (XMFLOAT3& position : positions)
+		{
+			XMStoreFloat3(&position, XMVector3Normalize(XMVectorSet(gaussian(random), gaussian(random), gaussian(random), 0.0f)) * distance(random));
+		}
+		return positions;
+	}
+}
+
+TEST_CASE(MeshletsRespectLimits)
+{
+	for (const TestMesh& mesh : CreateMeshes())
+	{
+		CHECK(!mesh.Meshlets.Meshlets.empty());
+		CHECK_EQUAL(mesh.Meshlets.Meshlets.size(), mesh.Meshlets.CullData.size());
+		for (const Meshlet& meshlet : mesh.Meshlets.Meshlets)
+		{
+			CHECK(meshlet.VertexCount >= 3 && meshlet.VertexCount <= MeshletBuilder::MaxVertices);
+			CHECK(meshlet.PrimitiveCount >= 1 && meshlet.PrimitiveCount <= MeshletBuilder::MaxPrimitives);
+		}
+	}
+
+	// Smaller limits are honoured too.
+	std::vector<TestMesh> meshes = CreateMeshes();
+	const TestMesh& sphere = meshes[0];
+	MeshletData small = MeshletBuilder::Build(sphere.Indices, GetPositions(sphere.Vertices), sphere.Vertices.size(), sizeof(VertexPositionNormalTexture), 16, 8);
+	for (const Meshlet& meshlet : small.Meshlets)
+	{
+		CHECK(meshlet.VertexCount <= 16);
+		CHECK(meshlet.PrimitiveCount <= 8);
+	}
+}
+
+TEST_CASE(MeshletRangesCoverInputExactly)
+{
+	for (const TestMesh& mesh : CreateMeshes())
+	{
+		const MeshletData& data = mesh.Meshlets;
+		uint32_t vertexOffset = 0;
+		uint32_t primitiveOffset = 0;
+		IndexCollection rebuilt;
+		for (const Meshlet& meshlet : data.Meshlets)
+		{
+			// Ranges are contiguous and back to back.
+			CHECK_EQUAL(vertexOffset, meshlet.VertexOffset);
+			CHECK_EQUAL(primitiveOffset, meshlet.PrimitiveOffset);
+			vertexOffset += meshlet.VertexCount;
+			primitiveOffset += meshlet.PrimitiveCount;
+
+			// Vertices within a meshlet are unique.
+			std::vector<uint32_t> unique(data.UniqueVertexIndices.begin() + meshlet.VertexOffset, data.UniqueVertexIndices.begin() + meshlet.VertexOffset + meshlet.VertexCount);
+			std::sort(unique.begin(), unique.end());
+			CHECK(std::adjacent_find(unique.begin(), unique.end()) == unique.end());
+
+			for (uint32_t i = 0; i < meshlet.PrimitiveCount; ++i)
+			{
+				uint32_t local[3];
+				MeshletBuilder::UnpackPrimitive(data.PrimitiveIndices[meshlet.PrimitiveOffset + i], local[0], local[1], local[2]);
+				for (uint32_t index : local)
+				{
+					CHECK(index < meshlet.VertexCount);
+					rebuilt.push_back(data.UniqueVertexIndices[meshlet.VertexOffset + index]);
+				}
+			}
+		}
+		CHECK_EQUAL(data.UniqueVertexIndices.size(), static_cast<size_t>(vertexOffset));
+		CHECK_EQUAL(data.PrimitiveIndices.size(), static_cast<size_t>(primitiveOffset));
+		CHECK(rebuilt == mesh.Indices);
+	}
+}
+
+TEST_CASE(VerticesInsideBoundingSpheres)
+{
+	for (const TestMesh& mesh : CreateMeshes())
+	{
+		for (size_t m = 0; m < mesh.Meshlets.Meshlets.size(); ++m)
+		{
+			const Meshlet& meshlet = mesh.Meshlets.Meshlets[m];
+			const XMFLOAT4& sphere = mesh.Meshlets.CullData[m].BoundingSphere;
+			XMVECTOR center = XMVectorSet(sphere.x, sphere.y, sphere.z, 0.0f);
+			for (uint32_t i = 0; i < meshlet.VertexCount; ++i)
+			{
+				float distance = XMVectorGetX(XMVector3Length(GetVertex(mesh, meshlet, i) - center));
+				CHECK(distance <= sphere.w * 1.0001f + 1e-6f);
+			}
+		}
+	}
+}
+
+TEST_CASE(NormalConeIsConservative)
+{
+	XMFLOAT4 planes[6];
+	GetAllPassPlanes(planes);
+
+	for (const TestMesh& mesh : CreateMeshes())
+	{
+		uint32_t culledNum = 0;
+		for (const XMFLOAT3& camera : CreateCameraPositions(2))
+		{
+			XMVECTOR cameraPosition = XMLoadFloat3(&camera);
+			for (size_t m = 0; m < mesh.Meshlets.Meshlets.size(); ++m)
+			{
+				if (MeshletCuller::IsVisible(mesh.Meshlets.CullData[m], planes, camera)) continue;
+				++culledNum;
+
+				// A culled cluster may only hold triangles facing away from the camera.
+				const Meshlet& meshlet = mesh.Meshlets.Meshlets[m];
+				for (uint32_t i = 0; i < meshlet.PrimitiveCount; ++i)
+				{
+					uint32_t i0, i1, i2;
+					MeshletBuilder::UnpackPrimitive(mesh.Meshlets.PrimitiveIndices[meshlet.PrimitiveOffset + i], i0, i1, i2);
+					XMVECTOR p0 = GetVertex(mesh, meshlet, i0);
+					XMVECTOR normal = XMVector3Cross(GetVertex(mesh, meshlet, i1) - p0, GetVertex(mesh, meshlet, i2) - p0);
+					CHECK(XMVectorGetX(XMVector3Dot(normal, cameraPosition - p0)) <= 1e-6f);
+				}
+			}
+		}
+
+		// Closed smooth shapes must actually cull back-facing clusters, or the check above proves nothing.
+		if (mesh.Name == std::string("sphere") || mesh.Name == std::string("torus"))
+		{
+			CHECK(culledNum > 0);
+		}
+	}
+}
+
+TEST_CASE(CullMatchesBruteForce)
+{
+	XMFLOAT4 allPass[6];
+	GetAllPassPlanes(allPass);
+
+	std::vector<XMFLOAT3> cameras = CreateCameraPositions(3);
+	for (const TestMesh& mesh : CreateMeshes())
+	{
+		// The same meshlets with the cone disabled, so Cull reduces to the sphere test alone.
+		MeshletData sphereOnly = mesh.Meshlets;
+		for (MeshletCullData& cullData : sphereOnly.CullData)
+		{
+			cullData.NormalCone = MeshletBuilder::PackNormalCone(0.0f, 0.0f, 0.0f, 1.0f);
+		}
+
+		for (const XMFLOAT3& camera : cameras)
+		{
+			// Looking at a point beside the mesh, so part of it falls outside the frustum.
+			XMMATRIX view = XMMatrixLookAtLH(XMLoadFloat3(&camera), XMVectorSet(1.0f, 0.5f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+			XMMATRIX projection = XMMatrixPerspectiveFovLH(XMConvertToRadians(30.0f), 1.0f, 0.1f, 15.0f);
+			XMFLOAT4X4 viewProjection;
+			XMStoreFloat4x4(&viewProjection, view * projection);
+			XMFLOAT4 planes[6];
+			MeshletCuller::ExtractFrustumPlanes(viewProjection, planes);
+
+			std::vector<uint32_t> expectedSphere;
+			std::vector<uint32_t> expected;
+			for (uint32_t m = 0; m < mesh.Meshlets.CullData.size(); ++m)
+			{
+				if (!IsSphereInsidePlanes(mesh.Meshlets.CullData[m].BoundingSphere, planes)) continue;
+				expectedSphere.push_back(m);
+				if (MeshletCuller::IsVisible(mesh.Meshlets.CullData[m], allPass, camera)) expected.push_back(m);
+			}
+
+			std::vector<uint32_t> visible;
+			uint32_t culledNum = MeshletCuller::Cull(sphereOnly, planes, camera, visible);
+			CHECK(visible == expectedSphere);
+			CHECK_EQUAL(static_cast<uint32_t>(mesh.Meshlets.Meshlets.size() - expectedSphere.size()), culledNum);
+
+			culledNum = MeshletCuller::Cull(mesh.Meshlets, planes, camera, visible);
+			CHECK(visible == expected);
+			CHECK_EQUAL(static_cast<uint32_t>(mesh.Meshlets.Meshlets.size() - expected.size()), culledNum);
+		}
+	}
+}
+
+TEST_CASE(NormalConePacking)
+{
+	XMFLOAT4 cone = MeshletBuilder::UnpackNormalCone(MeshletBuilder::PackNormalCone(0.0f, -1.0f, 0.5f, 0.3f));
+	CHECK_NEAR(0.0f, cone.x, 1.0 / 127);
+	CHECK_NEAR(-1.0f, cone.y, 1.0 / 127);
+	CHECK_NEAR(0.5f, cone.z, 1.0 / 127);
+	// The cutoff rounds up, so the unpacked cone is never narrower than the packed one.
+	CHECK(cone.w >= 0.3f);
+	CHECK_NEAR(0.3f, cone.w, 1.0 / 255);
+
+	uint32_t i0, i1, i2;
+	MeshletBuilder::UnpackPrimitive(MeshletBuilder::PackPrimitive(63, 0, 255), i0, i1, i2);
+	CHECK_EQUAL(63u, i0);
+	CHECK_EQUAL(0u, i1);
+	CHECK_EQUAL(255u, i2);
+}
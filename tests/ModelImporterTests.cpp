@@ -0,0 +1,152 @@
+#include "ModelImporter.h"
+#include "TestHarness.h"
+
+using namespace DirectX;
+
+namespace
+{
+	std::wstring GetSample(const char* name)
+	{
+		return (fs::path(TEST_SAMPLES_DIR) / name).wstring();
+	}
+
+	XMVECTOR FaceNormal(const ImportedPrimitive& primitive, size_t triangle)
+	{
+		XMVECTOR p0 = XMLoadFloat3(&primitive.Vertices[primitive.Indices[triangle * 3 + 0]].position);
+		XMVECTOR p1 = XMLoadFloat3(&primitive.Vertices[primitive.Indices[triangle * 3 + 1]].position);
+		XMVECTOR p2 = XMLoadFloat3(&primitive.Vertices[primitive.Indices[triangle * 3 + 2]].position);
+		return XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+	}
+
+	// The winding has to agree with the shading normals in both conventions, mirrored nodes included.
+	void CheckWindingFollowsNormals(const std::vector<ImportedPrimitive>& primitives)
+	{
+		for (const ImportedPrimitive& primitive : primitives)
+		{
+			for (size_t i = 0; i < primitive.Indices.size() / 3; ++i)
+			{
+				XMVECTOR normal = XMLoadFloat3(&primitive.Vertices[primitive.Indices[i * 3]].normal);
+				CHECK(XMVectorGetX(XMVector3Dot(FaceNormal(primitive, i), normal)) > 0.0f);
+			}
+		}
+	}
+
+	void CheckTangentFrames(const ImportedPrimitive& primitive)
+	{
+		CHECK_EQUAL(primitive.Vertices.size(), primitive.Tangents.size());
+		for (size_t i = 0; i < primitive.Tangents.size(); ++i)
+		{
+			XMVECTOR tangent = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&primitive.Tangents[i]));
+			XMVECTOR normal = XMLoadFloat3(&primitive.Vertices[i].normal);
+			CHECK_NEAR(1.0, XMVectorGetX(XMVector3Length(tangent)), 1e-5);
+			CHECK_NEAR(0.0, XMVectorGetX(XMVector3Dot(tangent, normal)), 1e-5);
+			CHECK_EQUAL(1.0f, std::fabs(primitive.Tangents[i].w));
+		}
+	}
+}
+
+TEST_CASE(ObjCubeCounts)
+{
+	ImportStatistics statistics = {};
+	std::vector<ImportedPrimitive> primitives = ModelImporter::Import(GetSample("cube.obj"), &statistics);
+
+	CHECK_EQUAL(1u, primitives.size());
+	CHECK_EQUAL(std::string("Cube"), primitives[0].Name);
+	CHECK_EQUAL(24u, primitives[0].Vertices.size());
+	CHECK_EQUAL(36u, primitives[0].Indices.size());
+	CHECK_EQUAL(1u, statistics.PrimitiveNum);
+	CHECK_EQUAL(24u, statistics.VertexNum);
+	CHECK_EQUAL(24u, statistics.WeldedVertexNum);
+	CHECK_EQUAL(36u, statistics.IndexNum);
+	CheckTangentFrames(primitives[0]);
+}
+
+TEST_CASE(GltfQuadIsWelded)
+{
+	ImportStatistics statistics = {};
+	std::vector<ImportedPrimitive> primitives = ModelImporter::Import(GetSample("quad.gltf"), &statistics);
+
+	// One mesh referenced by two nodes; the duplicated corner is welded away in both.
+	CHECK_EQUAL(2u, primitives.size());
+	CHECK_EQUAL(10u, statistics.VertexNum);
+	CHECK_EQUAL(8u, statistics.WeldedVertexNum);
+	CHECK_EQUAL(12u, statistics.IndexNum);
+	for (const ImportedPrimitive& primitive : primitives)
+	{
+		CHECK_EQUAL(std::string("Quad"), primitive.Name);
+		CHECK_EQUAL(4u, primitive.Vertices.size());
+		CHECK_EQUAL(6u, primitive.Indices.size());
+		CheckTangentFrames(primitive);
+	}
+}
+
+TEST_CASE(GlbMatchesEmbeddedGltf)
+{
+	std::vector<ImportedPrimitive> gltf = ModelImporter::Import(GetSample("quad.gltf"));
+	std::vector<ImportedPrimitive> glb = ModelImporter::Import(GetSample("quad.glb"));
+
+	CHECK_EQUAL(gltf.size(), glb.size());
+	for (size_t i = 0; i < gltf.size() && i < glb.size(); ++i)
+	{
+		CHECK(gltf[i].Indices == glb[i].Indices);
+		CHECK_EQUAL(gltf[i].Vertices.size(), glb[i].Vertices.size());
+		CHECK(memcmp(gltf[i].Vertices.data(), glb[i].Vertices.data(), gltf[i].Vertices.size() * sizeof(VertexPositionNormalTexture)) == 0);
+	}
+}
+
+TEST_CASE(LeftHandedImportMirrorsZ)
+{
+	std::vector<ImportedPrimitive> leftHanded = ModelImporter::Import(GetSample("quad.gltf"));
+	std::vector<ImportedPrimitive> rightHanded = ModelImporter::Import(GetSample("quad.gltf"), nullptr, true);
+
+	for (const VertexPositionNormalTexture& vertex : rightHanded[0].Vertices)
+	{
+		CHECK_EQUAL(1.0f, vertex.position.z);
+		CHECK_EQUAL(1.0f, vertex.normal.z);
+	}
+	for (const VertexPositionNormalTexture& vertex : leftHanded[0].Vertices)
+	{
+		CHECK_EQUAL(-1.0f, vertex.position.z);
+		CHECK_EQUAL(-1.0f, vertex.normal.z);
+	}
+
+	// Mirroring flips the handedness of the tangent frame.
+	CHECK_EQUAL(-rightHanded[0].Tangents[0].w, leftHanded[0].Tangents[0].w);
+}
+
+TEST_CASE(WindingFollowsNormals)
+{
+	for (bool rhcoords : { false, true })
+	{
+		CheckWindingFollowsNormals(ModelImporter::Import(GetSample("cube.obj"), nullptr, rhcoords));
+		CheckWindingFollowsNormals(ModelImporter::Import(GetSample("quad.gltf"), nullptr, rhcoords));
+		CheckWindingFollowsNormals(ModelImporter::Import(GetSample("quad.glb"), nullptr, rhcoords));
+	}
+}
+
+TEST_CASE(MirroredNodeKeepsFacingAndFlipsTangents)
+{
+	std::vector<ImportedPrimitive> primitives = ModelImporter::Import(GetSample("quad.gltf"));
+	const ImportedPrimitive& front = primitives[0];
+	const ImportedPrimitive& mirrored = primitives[1];
+
+	// The second node is scaled by -1 in X and moved to x = 3.
+	for (const VertexPositionNormalTexture& vertex : mirrored.Vertices)
+	{
+		CHECK(vertex.position.x >= 2.0f && vertex.position.x <= 3.0f);
+		CHECK_EQUAL(-1.0f, vertex.normal.z);
+	}
+
+	// U runs along +X in the source, so the tangent follows the node's X axis.
+	for (size_t i = 0; i < front.Tangents.size(); ++i)
+	{
+		CHECK_NEAR(1.0, front.Tangents[i].x, 1e-5);
+		CHECK_NEAR(-1.0, mirrored.Tangents[i].x, 1e-5);
+	}
+}
+
+TEST_CASE(InvalidFilesThrow)
+{
+	CHECK_THROWS(ModelImporter::Import(GetSample("missing.obj")));
+	CHECK_THROWS(ModelImporter::Import(fs::path(TEST_SAMPLES_DIR).wstring()));
+}
@@ -0,0 +1,242 @@
+#include "RenderGraph.h"
+#include "Application.h"
+#include "CommandList.h"
+#include "TestHarness.h"
+
+namespace
+{
+	const uint64_t MB = 1024 * 1024;
+
+	D3D12_RESOURCE_DESC ColorDesc(UINT64 size)
+	{
+		auto desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, size, static_cast<UINT>(size));
+		desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+		return desc;
+	}
+
+	D3D12_RESOURCE_DESC DepthDesc(UINT64 size)
+	{
+		auto desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_D32_FLOAT, size, static_cast<UINT>(size));
+		desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+		return desc;
+	}
+
+	// Width in MB, so sizes in the tests read directly.
+	D3D12_RESOURCE_ALLOCATION_INFO AllocationInfo(const D3D12_RESOURCE_DESC& desc)
+	{
+		return { desc.Width * MB, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT };
+	}
+
+	void NoExecute(CommandList& commandList, const RenderGraph& graph) {}
+
+	ComPtr<ID3D12Resource> CreateBackBuffer()
+	{
+		auto desc = ColorDesc(1);
+		ComPtr<ID3D12Resource> resource;
+		Application::Get().GetDevice()->CreateCommittedResource(nullptr, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&resource));
+		return resource;
+	}
+
+	uint64_t GetHeapOffset(const Texture& texture)
+	{
+		return static_cast<TestResource*>(texture.GetD3D12Resource().Get())->GetHeapOffset();
+	}
+}
+
+TEST_CASE(PassesWithoutConsumersAreCulled)
+{
+	Texture backBuffer(CreateBackBuffer(), TextureUsage::RenderTarget, L"Back Buffer");
+
+	RenderGraph graph;
+	auto color = graph.CreateTexture(L"Color", ColorDesc(1));
+	auto unused = graph.CreateTexture(L"Unused", ColorDesc(1));
+	auto output = graph.ImportTexture(L"Back Buffer", backBuffer, true);
+
+	graph.AddPass(L"Scene", [&](RenderGraph::PassBuilder& builder) { builder.Write(color); }, NoExecute);
+	graph.AddPass(L"Debug", [&](RenderGraph::PassBuilder& builder) { builder.Write(unused); }, NoExecute);
+	graph.AddPass(L"Capture", [&](RenderGraph::PassBuilder& builder) { builder.Read(unused); builder.SetSideEffect(); }, NoExecute);
+	graph.AddPass(L"Orphan", [&](RenderGraph::PassBuilder& builder) { builder.Read(color); }, NoExecute);
+	graph.AddPass(L"Present", [&](RenderGraph::PassBuilder& builder) { builder.Read(color); builder.Write(output); }, NoExecute);
+	graph.Compile(AllocationInfo);
+
+	CHECK(!graph.IsPassCulled(0));
+	CHECK(!graph.IsPassCulled(1));
+	CHECK(!graph.IsPassCulled(2));
+	CHECK(graph.IsPassCulled(3));
+	CHECK(!graph.IsPassCulled(4));
+	CHECK_EQUAL(1u, graph.GetStatistics().CulledPassNum);
+}
+
+TEST_CASE(ReadWriteKeepsTheDepthPrepass)
+{
+	Texture backBuffer(CreateBackBuffer(), TextureUsage::RenderTarget, L"Back Buffer");
+
+	RenderGraph graph;
+	auto color = graph.CreateTexture(L"Color", ColorDesc(1));
+	auto depth = graph.CreateTexture(L"Depth", DepthDesc(1), nullptr, TextureUsage::Depth);
+	auto output = graph.ImportTexture(L"Back Buffer", backBuffer, true);
+
+	graph.AddPass(L"Depth Prepass", [&](RenderGraph::PassBuilder& builder) { builder.Write(depth, D3D12_RESOURCE_STATE_DEPTH_WRITE); }, NoExecute);
+	graph.AddPass(L"Geometry", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.Write(color);
+		builder.ReadWrite(depth, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+	}, NoExecute);
+	graph.AddPass(L"Present", [&](RenderGraph::PassBuilder& builder) { builder.Read(color); builder.Write(output); }, NoExecute);
+	graph.Compile(AllocationInfo);
+
+	CHECK(!graph.IsPassCulled(0));
+	CHECK(!graph.IsPassCulled(1));
+	CHECK(!graph.IsPassCulled(2));
+}
+
+TEST_CASE(WriteDiscardsThePreviousProducer)
+{
+	Texture backBuffer(CreateBackBuffer(), TextureUsage::RenderTarget, L"Back Buffer");
+
+	RenderGraph graph;
+	auto color = graph.CreateTexture(L"Color", ColorDesc(1));
+	auto output = graph.ImportTexture(L"Back Buffer", backBuffer, true);
+
+	graph.AddPass(L"Clear", [&](RenderGraph::PassBuilder& builder) { builder.Write(color); }, NoExecute);
+	graph.AddPass(L"Fullscreen", [&](RenderGraph::PassBuilder& builder) { builder.Write(color); }, NoExecute);
+	graph.AddPass(L"Overlay", [&](RenderGraph::PassBuilder& builder) { builder.ReadWrite(color); }, NoExecute);
+	graph.AddPass(L"Present", [&](RenderGraph::PassBuilder& builder) { builder.Read(color); builder.Write(output); }, NoExecute);
+	graph.Compile(AllocationInfo);
+
+	CHECK(graph.IsPassCulled(0));
+	CHECK(!graph.IsPassCulled(1));
+	CHECK(!graph.IsPassCulled(2));
+	CHECK(!graph.IsPassCulled(3));
+}
+
+TEST_CASE(DisjointLifetimesShareHeapMemory)
+{
+	Texture backBuffer(CreateBackBuffer(), TextureUsage::RenderTarget, L"Back Buffer");
+
+	// A: passes 0-1, B: 1-2, C: 2-3. A and C never overlap, so C fits in A's range.
+	RenderGraph graph;
+	auto a = graph.CreateTexture(L"A", ColorDesc(4));
+	auto b = graph.CreateTexture(L"B", ColorDesc(2));
+	auto c = graph.CreateTexture(L"C", ColorDesc(3));
+	auto output = graph.ImportTexture(L"Back Buffer", backBuffer, true);
+
+	graph.AddPass(L"0", [&](RenderGraph::PassBuilder& builder) { builder.Write(a); }, NoExecute);
+	graph.AddPass(L"1", [&](RenderGraph::PassBuilder& builder) { builder.Read(a); builder.Write(b); }, NoExecute);
+	graph.AddPass(L"2", [&](RenderGraph::PassBuilder& builder) { builder.Read(b); builder.Write(c); }, NoExecute);
+	graph.AddPass(L"3", [&](RenderGraph::PassBuilder& builder) { builder.Read(c); builder.Write(output); }, NoExecute);
+	graph.Compile(AllocationInfo);
+
+	RenderGraph::Statistics statistics = graph.GetStatistics();
+	CHECK_EQUAL(3u, statistics.TransientNum);
+	CHECK_EQUAL(9 * MB, statistics.UnaliasedBytes);
+	CHECK_EQUAL(6 * MB, statistics.HeapBytes);
+	CHECK_EQUAL(2u, statistics.AliasingNum);
+
+	CommandList commandList;
+	graph.Execute(commandList);
+	CHECK_EQUAL(0ull, GetHeapOffset(graph.GetTexture(a)));
+	CHECK_EQUAL(4 * MB, GetHeapOffset(graph.GetTexture(b)));
+	CHECK_EQUAL(0ull, GetHeapOffset(graph.GetTexture(c)));
+	CHECK_EQUAL(2u, commandList.GetCalls("AliasingBarrier").size());
+}
+
+TEST_CASE(OverlappingLifetimesNeverAlias)
+{
+	Texture backBuffer(CreateBackBuffer(), TextureUsage::RenderTarget, L"Back Buffer");
+
+	RenderGraph graph;
+	auto a = graph.CreateTexture(L"A", ColorDesc(1));
+	auto b = graph.CreateTexture(L"B", ColorDesc(2));
+	auto output = graph.ImportTexture(L"Back Buffer", backBuffer, true);
+
+	graph.AddPass(L"0", [&](RenderGraph::PassBuilder& builder) { builder.Write(a); builder.Write(b); }, NoExecute);
+	graph.AddPass(L"1", [&](RenderGraph::PassBuilder& builder) { builder.Read(a); builder.Read(b); builder.Write(output); }, NoExecute);
+	graph.Compile(AllocationInfo);
+
+	RenderGraph::Statistics statistics = graph.GetStatistics();
+	CHECK_EQUAL(3 * MB, statistics.HeapBytes);
+	CHECK_EQUAL(0u, statistics.AliasingNum);
+}
+
+TEST_CASE(BarriersFollowStateChanges)
+{
+	Texture backBuffer(CreateBackBuffer(), TextureUsage::RenderTarget, L"Back Buffer");
+
+	RenderGraph graph;
+	auto color = graph.CreateTexture(L"Color", ColorDesc(1));
+	auto output = graph.ImportTexture(L"Back Buffer", backBuffer, true);
+
+	graph.AddPass(L"Scene", [&](RenderGraph::PassBuilder& builder) { builder.Write(color); }, NoExecute);
+	graph.AddPass(L"Blur X", [&](RenderGraph::PassBuilder& builder) { builder.ReadWrite(color, D3D12_RESOURCE_STATE_UNORDERED_ACCESS); }, NoExecute);
+	graph.AddPass(L"Blur Y", [&](RenderGraph::PassBuilder& builder) { builder.ReadWrite(color, D3D12_RESOURCE_STATE_UNORDERED_ACCESS); }, NoExecute);
+	graph.AddPass(L"Sample", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.Read(color, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		builder.Read(color, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+		builder.ReadWrite(output);
+	}, NoExecute);
+
+	std::vector<std::wstring> executed;
+	graph.AddPass(L"Present", [&](RenderGraph::PassBuilder& builder) { builder.Read(color, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE); builder.ReadWrite(output); },
+		[&](CommandList& commandList, const RenderGraph& graph) { executed.push_back(L"Present"); });
+
+	CommandList commandList;
+	graph.Execute(commandList);
+
+	ID3D12Resource* colorResource = graph.GetTexture(color).GetD3D12Resource().Get();
+	std::vector<D3D12_RESOURCE_STATES> colorStates;
+	for (const auto& call : commandList.GetCalls("TransitionBarrier"))
+	{
+		if (call.Resource == colorResource) colorStates.push_back(call.State);
+	}
+
+	const D3D12_RESOURCE_STATES shaderResource = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+	CHECK_EQUAL(3u, colorStates.size());
+	CHECK(colorStates[0] == D3D12_RESOURCE_STATE_RENDER_TARGET);
+	CHECK(colorStates[1] == D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	CHECK(colorStates[2] == shaderResource);
+
+	CHECK_EQUAL(1u, commandList.GetCalls("UAVBarrier").size());
+	CHECK_EQUAL(4u, graph.GetStatistics().TransitionNum);
+	CHECK_EQUAL(1u, executed.size());
+}
+
+TEST_CASE(ConflictingWriteStatesThrow)
+{
+	RenderGraph graph;
+	auto color = graph.CreateTexture(L"Color", ColorDesc(1));
+
+	graph.AddPass(L"Bad", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.Write(color, D3D12_RESOURCE_STATE_RENDER_TARGET);
+		builder.Write(color, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+		builder.SetSideEffect();
+	}, NoExecute);
+
+	CHECK_THROWS(graph.Compile(AllocationInfo));
+	CHECK_THROWS(graph.CreateTexture(L"Plain", CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, 1, 1)));
+}
+
+TEST_CASE(TransientsAreReusedAcrossFrames)
+{
+	Texture backBuffer(CreateBackBuffer(), TextureUsage::RenderTarget, L"Back Buffer");
+	TestDevice& device = Application::Get().GetTestDevice();
+
+	RenderGraph graph;
+	device.ResetStatistics();
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		graph.Reset();
+		auto color = graph.CreateTexture(L"Color", ColorDesc(1));
+		auto output = graph.ImportTexture(L"Back Buffer", backBuffer, true);
+		graph.AddPass(L"Scene", [&](RenderGraph::PassBuilder& builder) { builder.Write(color); }, NoExecute);
+		graph.AddPass(L"Present", [&](RenderGraph::PassBuilder& builder) { builder.Read(color); builder.Write(output); }, NoExecute);
+
+		CommandList commandList;
+		graph.Execute(commandList);
+	}
+
+	CHECK_EQUAL(1u, device.GetStatistics().HeapNum);
+	CHECK_EQUAL(1u, device.GetStatistics().PlacedResourceNum);
+}
@@ -0,0 +1,69 @@
+#include "RenderQueue.h"
+#include "TestHarness.h"
+
+#include <random>
+
+namespace
+{
+	// Packets as the sandbox submits them: mostly opaque, a few pipelines, many materials.
+	std::vector<RenderQueue::Packet> CreatePackets(size_t packetNum, uint32_t materialNum, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<uint32_t> pipelineState(0, 7);
+		std::uniform_int_distribution<uint32_t> material(0, materialNum - 1);
+		std::uniform_real_distribution<float> depth(0.1f, 500.0f);
+		std::uniform_int_distribution<uint32_t> layer(0, 9);
+
+		std::vector<RenderQueue::Packet> packets(packetNum);
+		for (uint32_t i = 0; i < packetNum; ++i)
+		{
+			RenderQueue::Layer packetLayer = layer(random) == 0 ? RenderQueue::Layer::Transparent : RenderQueue::Layer::Opaque;
+			packets[i] = { RenderQueue::MakeSortKey(packetLayer, 0, pipelineState(random), material(random), depth(random)), i };
+		}
+		return packets;
+	}
+}
+
+TEST_CASE(SortUpToOneMillionPackets)
+{
+	printf("%8s %10s %9s %12s %15s %8s %8s\n", "packets", "materials", "radix ms", "std::sort ms", "stable_sort ms", "speedup", "passes");
+	for (size_t packetNum : { 10000, 100000, 1000000 })
+	{
+		for (uint32_t materialNum : { 16u, 4096u })
+		{
+			const std::vector<RenderQueue::Packet> packets = CreatePackets(packetNum, materialNum, static_cast<uint32_t>(packetNum) + materialNum);
+			auto less = [](const RenderQueue::Packet& a, const RenderQueue::Packet& b) { return a.Key < b.Key; };
+
+			std::vector<RenderQueue::Packet> sorted;
+			std::vector<RenderQueue::Packet> scratch;
+			uint32_t passNum = 0;
+			double radixTime = Test::Measure(10, [&]()
+			{
+				sorted = packets;
+				passNum = RenderQueue::RadixSort(sorted, scratch);
+			});
+
+			std::vector<RenderQueue::Packet> reference;
+			double sortTime = Test::Measure(10, [&]()
+			{
+				reference = packets;
+				std::sort(reference.begin(), reference.end(), less);
+			});
+
+			double stableSortTime = Test::Measure(10, [&]()
+			{
+				reference = packets;
+				std::stable_sort(reference.begin(), reference.end(), less);
+			});
+
+			uint32_t mismatchNum = 0;
+			for (size_t i = 0; i < packetNum; ++i)
+			{
+				if (sorted[i].Payload != reference[i].Payload) ++mismatchNum;
+			}
+			CHECK_EQUAL(0u, mismatchNum);
+
+			printf("%8zu %10u %9.3f %12.3f %15.3f %7.1fx %8u\n", packetNum, materialNum, radixTime, sortTime, stableSortTime, stableSortTime / radixTime, passNum);
+		}
+	}
+}
@@ -0,0 +1,312 @@
+#include "RenderQueue.h"
+#include "CommandSignature.h"
+#include "IndirectCommandBuilder.h"
+#include "Mesh.h"
+#include "RootSignature.h"
+#include "Texture.h"
+#include "TestHarness.h"
+
+using namespace DirectX;
+
+namespace
+{
+	// Large enough that the per-object upload spans several 2 MB upload pages.
+	const uint32_t ObjectNum = 24000;
+	const size_t ObjectSize = 256;
+	const size_t ObjectStride = 272;
+
+	uint32_t ReadWord(const void* data, size_t offset)
+	{
+		uint32_t word;
+		memcpy(&word, static_cast<const uint8_t*>(data) + offset, sizeof(word));
+		return word;
+	}
+
+	struct Scene
+	{
+		Scene()
+		{
+			CommandList commandList;
+			Meshes.push_back(Mesh::CreateCube(commandList));
+			Meshes.push_back(Mesh::CreateSphere(commandList, 1.0f, 8));
+			Meshes.push_back(Mesh::CreateTorus(commandList, 1.0f, 0.333f, 8));
+
+			for (int i = 0; i < 2; ++i)
+			{
+				PipelineStates[i].Attach(new ID3D12PipelineState());
+			}
+
+			for (uint32_t i = 0; i < ObjectNum; ++i)
+			{
+				Bounds.push_back(BoundingBox(XMFLOAT3(static_cast<float>(i), 1.0f, 2.0f), XMFLOAT3(0.5f, 0.5f, 0.5f)));
+			}
+		}
+
+		static uint32_t GetMaterial(uint32_t object)
+		{
+			return (object / 7) % 3;
+		}
+
+		void Submit(RenderQueue& queue)
+		{
+			uint32_t rootSignature = queue.AddRootSignature(Signature);
+			uint32_t pipelineStates[2] = { queue.AddPipelineState(PipelineStates[0]), queue.AddPipelineState(PipelineStates[1]) };
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				XMFLOAT4 constants(static_cast<float>(i), 0.0f, 0.0f, 0.0f);
+				queue.AddMaterial(Textures[i % 2], constants);
+			}
+
+			queue.SetObjectWriter(ObjectSize, [this](const uint32_t* objects, size_t count, void* destination, size_t stride)
+			{
+				SortedObjects.assign(objects, objects + count);
+				for (size_t i = 0; i < count; ++i)
+				{
+					memset(static_cast<uint8_t*>(destination) + i * stride, 0xcd, ObjectSize);
+					memcpy(static_cast<uint8_t*>(destination) + i * stride, &objects[i], sizeof(uint32_t));
+				}
+			});
+
+			for (uint32_t i = 0; i < ObjectNum; ++i)
+			{
+				float viewDepth = 1.0f + static_cast<float>((i * 7919) % 1000);
+				queue.SubmitObject(RenderQueue::Layer::Opaque, rootSignature, pipelineStates[(i / 11) % 2], GetMaterial(i), viewDepth, *Meshes[i % 3], i);
+			}
+		}
+
+		// The per-object block ends with the material index, in sorted draw order.
+		void CheckObjectData(const CommandList::DynamicAllocation& objectData) const
+		{
+			CHECK_EQUAL(ObjectNum * ObjectStride, objectData.Size);
+			CHECK_EQUAL(static_cast<size_t>(ObjectNum), SortedObjects.size());
+
+			uint32_t mismatchNum = 0;
+			for (uint32_t i = 0; i < SortedObjects.size(); ++i)
+			{
+				uint32_t object = SortedObjects[i];
+				if (ReadWord(objectData.Pointer.CPUAddress, i * ObjectStride) != object ||
+					ReadWord(objectData.Pointer.CPUAddress, i * ObjectStride + ObjectSize) != GetMaterial(object))
+				{
+					++mismatchNum;
+				}
+			}
+			CHECK_EQUAL(0u, mismatchNum);
+		}
+
+		std::vector<std::unique_ptr<Mesh>> Meshes;
+		RootSignature Signature;
+		ComPtr<ID3D12PipelineState> PipelineStates[2];
+		Texture Textures[2];
+		std::vector<BoundingBox> Bounds;
+		std::vector<uint32_t> SortedObjects;
+	};
+
+	const RenderQueue::Bindings TestBindings = { 0, 1, 2, 3 };
+
+	bool Overlaps(const CommandList::DynamicAllocation& a, const CommandList::DynamicAllocation& b)
+	{
+		return a.Pointer.GPUAddress < b.Pointer.GPUAddress + b.Size && b.Pointer.GPUAddress < a.Pointer.GPUAddress + a.Size;
+	}
+
+	void CheckDisjoint(const std::vector<CommandList::DynamicAllocation>& allocations)
+	{
+		for (size_t i = 0; i < allocations.size(); ++i)
+		{
+			for (size_t j = i + 1; j < allocations.size(); ++j)
+			{
+				CHECK(!Overlaps(allocations[i], allocations[j]));
+			}
+		}
+	}
+}
+
+TEST_CASE(ExecuteDrawsEveryObjectOnce)
+{
+	Scene scene;
+	RenderQueue queue;
+	scene.Submit(queue);
+
+	CommandList commandList;
+	queue.Execute(commandList, TestBindings);
+
+	const auto& allocations = commandList.GetDynamicAllocations();
+	CHECK_EQUAL(2u, allocations.size());
+	scene.CheckObjectData(allocations[0]);
+
+	auto constants = commandList.GetCalls("SetGraphics32BitConstants");
+	auto draws = commandList.GetCalls("DrawIndexed");
+	CHECK_EQUAL(constants.size(), draws.size());
+	CHECK_EQUAL(static_cast<size_t>(queue.GetStatistics().DrawNum), draws.size());
+
+	uint64_t objectIndex = 0;
+	for (size_t i = 0; i < draws.size(); ++i)
+	{
+		CHECK_EQUAL(objectIndex, constants[i].Arguments[1]);
+		objectIndex += draws[i].Arguments[1];
+	}
+	CHECK_EQUAL(static_cast<uint64_t>(ObjectNum), objectIndex);
+}
+
+TEST_CASE(ExecuteIndirectUploadsInstancedCommands)
+{
+	Scene scene;
+	RenderQueue queue;
+	scene.Submit(queue);
+
+	CommandList commandList;
+	CommandSignature commandSignature(scene.Signature, TestBindings.DrawConstants);
+	queue.ExecuteIndirect(commandList, TestBindings, commandSignature);
+
+	RenderQueue::Statistics statistics = queue.GetStatistics();
+	uint32_t commandCount = statistics.IndirectCommandNum;
+	CHECK(commandCount > 0 && commandCount < ObjectNum);
+
+	const auto& allocations = commandList.GetDynamicAllocations();
+	CHECK_EQUAL(3u, allocations.size());
+	scene.CheckObjectData(allocations[0]);
+	CHECK_EQUAL(commandCount * IndirectCommandBuilder::CommandStride, allocations[2].Size);
+	CheckDisjoint(allocations);
+
+	// Instanced commands cover the sorted objects back to back.
+	const void* commands = allocations[2].Pointer.CPUAddress;
+	uint32_t objectIndex = 0;
+	for (uint32_t i = 0; i < commandCount; ++i)
+	{
+		size_t offset = i * IndirectCommandBuilder::CommandStride;
+		CHECK_EQUAL(objectIndex, ReadWord(commands, offset));
+		objectIndex += ReadWord(commands, offset + 8);
+	}
+	CHECK_EQUAL(ObjectNum, objectIndex);
+
+	uint64_t executedNum = 0;
+	for (const CommandList::Call& call : commandList.GetCalls("ExecuteIndirect"))
+	{
+		uint64_t address = call.Arguments[1];
+		CHECK(address >= allocations[2].Pointer.GPUAddress && address + call.Arguments[0] * IndirectCommandBuilder::CommandStride <= allocations[2].Pointer.GPUAddress + allocations[2].Size);
+		executedNum += call.Arguments[0];
+	}
+	CHECK_EQUAL(static_cast<uint64_t>(commandCount), executedNum);
+	CHECK_EQUAL(ObjectNum * ObjectStride + 3 * sizeof(XMFLOAT4) + commandCount * IndirectCommandBuilder::CommandStride, statistics.UploadBytes);
+}
+
+TEST_CASE(ExecuteIndirectWithCullingUploadsEveryObject)
+{
+	Scene scene;
+	RenderQueue queue;
+	scene.Submit(queue);
+
+	RenderQueue::Culling culling = {};
+	culling.ObjectBounds = &scene.Bounds;
+
+	CommandList commandList;
+	CommandSignature commandSignature(scene.Signature, TestBindings.DrawConstants);
+	queue.ExecuteIndirect(commandList, TestBindings, commandSignature, &culling);
+	CHECK_EQUAL(ObjectNum, queue.GetStatistics().IndirectCommandNum);
+
+	const auto& allocations = commandList.GetDynamicAllocations();
+	CHECK_EQUAL(4u, allocations.size());
+	scene.CheckObjectData(allocations[0]);
+	CHECK_EQUAL(ObjectNum * IndirectCommandBuilder::CommandStride, allocations[2].Size);
+	CHECK_EQUAL(ObjectNum * sizeof(IndirectCommandBuilder::CullItem), allocations[3].Size);
+	CheckDisjoint(allocations);
+
+	// One command per object, each carrying the bounds of the object it draws.
+	const void* commands = allocations[2].Pointer.CPUAddress;
+	const auto* cullItems = static_cast<const IndirectCommandBuilder::CullItem*>(allocations[3].Pointer.CPUAddress);
+	uint32_t mismatchNum = 0;
+	for (uint32_t i = 0; i < ObjectNum; ++i)
+	{
+		const BoundingBox& bounds = scene.Bounds[scene.SortedObjects[i]];
+		if (ReadWord(commands, i * IndirectCommandBuilder::CommandStride) != i ||
+			ReadWord(commands, i * IndirectCommandBuilder::CommandStride + 8) != 1 ||
+			cullItems[i].Center.x != bounds.Center.x)
+		{
+			++mismatchNum;
+		}
+	}
+	CHECK_EQUAL(0u, mismatchNum);
+
+	auto cull = commandList.GetCalls("CullIndirectCommands");
+	CHECK_EQUAL(1u, cull.size());
+	CHECK_EQUAL(allocations[2].Pointer.GPUAddress, cull[0].Arguments[0]);
+	CHECK_EQUAL(allocations[3].Pointer.GPUAddress, cull[0].Arguments[1]);
+	CHECK_EQUAL(static_cast<uint64_t>(ObjectNum), cull[0].Arguments[2]);
+
+	uint64_t executedNum = 0;
+	for (const CommandList::Call& call : commandList.GetCalls("ExecuteIndirect"))
+	{
+		CHECK_EQUAL(1u, call.Arguments[2]);
+		executedNum += call.Arguments[0];
+	}
+	CHECK_EQUAL(static_cast<uint64_t>(ObjectNum), executedNum);
+}
+
+TEST_CASE(OpaqueKeysSortFrontToBack)
+{
+	const float depths[] = { 40.0f, 0.5f, 7.0f, 1000.0f, 7.25f, 3.0f };
+
+	std::vector<RenderQueue::Packet> packets;
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		packets.push_back({ RenderQueue::MakeSortKey(RenderQueue::Layer::Opaque, 1, 2, 3, depths[i]), i });
+	}
+	// Behind the camera clamps to the nearest depth.
+	packets.push_back({ RenderQueue::MakeSortKey(RenderQueue::Layer::Opaque, 1, 2, 3, -5.0f), 6 });
+	// State outranks depth, so a lower pipeline state sorts first even when far away.
+	packets.push_back({ RenderQueue::MakeSortKey(RenderQueue::Layer::Opaque, 1, 1, 3, 5000.0f), 7 });
+
+	std::vector<RenderQueue::Packet> scratch;
+	RenderQueue::RadixSort(packets, scratch);
+
+	const uint32_t expected[] = { 7, 6, 1, 5, 2, 4, 0, 3 };
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		CHECK_EQUAL(expected[i], packets[i].Payload);
+	}
+}
+
+TEST_CASE(TransparentKeysSortBackToFrontAfterOpaque)
+{
+	const float depths[] = { 40.0f, 0.5f, 7.0f, 1000.0f, 7.25f, 3.0f };
+
+	std::vector<RenderQueue::Packet> packets;
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		// Alternate states; depth must still win for blending to be correct.
+		packets.push_back({ RenderQueue::MakeSortKey(RenderQueue::Layer::Transparent, 1, i % 2, 3, depths[i]), i });
+	}
+	packets.push_back({ RenderQueue::MakeSortKey(RenderQueue::Layer::Opaque, 31, 1023, 65535, 1e30f), 6 });
+
+	std::vector<RenderQueue::Packet> scratch;
+	RenderQueue::RadixSort(packets, scratch);
+
+	const uint32_t expected[] = { 6, 3, 0, 4, 2, 5, 1 };
+	for (uint32_t i = 0; i < 7; ++i)
+	{
+		CHECK_EQUAL(expected[i], packets[i].Payload);
+	}
+}
+
+TEST_CASE(RadixSortMatchesStableSort)
+{
+	std::vector<RenderQueue::Packet> packets;
+	for (uint32_t i = 0; i < 5000; ++i)
+	{
+		RenderQueue::Layer layer = i % 5 == 0 ? RenderQueue::Layer::Transparent : RenderQueue::Layer::Opaque;
+		// Few distinct depths so equal keys are common and stability is exercised.
+		packets.push_back({ RenderQueue::MakeSortKey(layer, i % 3, (i * 7) % 11, (i * 13) % 17, static_cast<float>((i * 31) % 23)), i });
+	}
+
+	std::vector<RenderQueue::Packet> expected = packets;
+	std::stable_sort(expected.begin(), expected.end(), [](const RenderQueue::Packet& a, const RenderQueue::Packet& b) { return a.Key < b.Key; });
+
+	std::vector<RenderQueue::Packet> scratch;
+	CHECK(RenderQueue::RadixSort(packets, scratch) > 0);
+
+	uint32_t mismatchNum = 0;
+	for (size_t i = 0; i < packets.size(); ++i)
+	{
+		if (packets[i].Payload != expected[i].Payload) ++mismatchNum;
+	}
+	CHECK_EQUAL(0u, mismatchNum);
+}
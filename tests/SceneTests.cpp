@@ -0,0 +1,199 @@
+#include "Scene.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+
+using namespace DirectX;
+
+namespace
+{
+	std::vector<Scene::Entity> GetSortedUpdatedEntities(const Scene& scene)
+	{
+		std::vector<Scene::Entity> entities = scene.GetUpdatedEntities();
+		std::sort(entities.begin(), entities.end());
+		return entities;
+	}
+
+	XMFLOAT3 GetWorldPosition(const Scene& scene, Scene::Entity entity)
+	{
+		XMFLOAT3 position;
+		XMStoreFloat3(&position, XMVector3Transform(XMVectorZero(), scene.GetWorldMatrix(entity)));
+		return position;
+	}
+}
+
+TEST_CASE(ParentChangeDirtiesWholeSubtree)
+{
+	// root -> a -> (b -> d, c), and a second root with its own child that must stay untouched.
+	Scene scene;
+	Scene::Entity root = scene.CreateEntity(XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), XMQuaternionIdentity(), XMVectorSplatOne());
+	Scene::Entity a = scene.CreateEntity(XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), XMQuaternionIdentity(), XMVectorSplatOne(), root);
+	Scene::Entity b = scene.CreateEntity(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), XMQuaternionIdentity(), XMVectorSplatOne(), a);
+	Scene::Entity c = scene.CreateEntity(XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), XMQuaternionIdentity(), XMVectorSplatOne(), a);
+	Scene::Entity d = scene.CreateEntity(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), XMQuaternionIdentity(), XMVectorSplatOne(), b);
+	Scene::Entity other = scene.CreateEntity(XMVectorSet(5.0f, 0.0f, 0.0f, 0.0f), XMQuaternionIdentity(), XMVectorSplatOne());
+	Scene::Entity otherChild = scene.CreateEntity(XMVectorSet(0.0f, 5.0f, 0.0f, 0.0f), XMQuaternionIdentity(), XMVectorSplatOne(), other);
+
+	scene.UpdateWorldMatrices();
+	CHECK_EQUAL(7u, scene.GetStatistics().UpdatedNum);
+	CHECK_EQUAL(4u, scene.GetStatistics().LevelNum);
+	CHECK_NEAR(2.0f, GetWorldPosition(scene, d).x, 1e-5);
+	CHECK_NEAR(2.0f, GetWorldPosition(scene, d).y, 1e-5);
+
+	// Moving a reaches its descendants and nothing else.
+	scene.SetPosition(a, XMVectorSet(3.0f, 0.0f, 0.0f, 0.0f));
+	scene.UpdateWorldMatrices();
+	CHECK_EQUAL(4u, scene.GetStatistics().UpdatedNum);
+	CHECK_EQUAL(7u, scene.GetStatistics().EntityNum);
+	CHECK((GetSortedUpdatedEntities(scene) == std::vector<Scene::Entity>{ a, b, c, d }));
+	CHECK_NEAR(4.0f, GetWorldPosition(scene, b).x, 1e-5);
+	CHECK_NEAR(4.0f, GetWorldPosition(scene, c).x, 1e-5);
+	CHECK_NEAR(1.0f, GetWorldPosition(scene, c).z, 1e-5);
+	CHECK_NEAR(4.0f, GetWorldPosition(scene, d).x, 1e-5);
+	CHECK_NEAR(2.0f, GetWorldPosition(scene, d).y, 1e-5);
+	CHECK_NEAR(5.0f, GetWorldPosition(scene, otherChild).y, 1e-5);
+
+	// A dirty descendant inside a dirty subtree is updated once, not twice.
+	scene.SetScale(d, XMVectorReplicate(2.0f));
+	scene.SetRotation(a, XMQuaternionRotationAxis(XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), XM_PIDIV2));
+	scene.UpdateWorldMatrices();
+	CHECK((GetSortedUpdatedEntities(scene) == std::vector<Scene::Entity>{ a, b, c, d }));
+
+	// A leaf only updates itself.
+	scene.SetPosition(c, XMVectorZero());
+	scene.UpdateWorldMatrices();
+	CHECK((scene.GetUpdatedEntities() == std::vector<Scene::Entity>{ c }));
+}
+
+TEST_CASE(UnchangedSetterDirtiesNothing)
+{
+	Scene scene;
+	XMVECTOR position = XMVectorSet(1.0f, 2.0f, 3.0f, 0.0f);
+	XMVECTOR rotation = XMQuaternionRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), 0.5f);
+	XMVECTOR scale = XMVectorSet(1.0f, 2.0f, 1.0f, 0.0f);
+	Scene::Entity parent = scene.CreateEntity(position, rotation, scale);
+	scene.CreateEntity(position, rotation, scale, parent);
+	Scene::Entity translated = scene.CreateEntity(position, XMQuaternionIdentity(), XMVectorSplatOne());
+	scene.UpdateWorldMatrices();
+	CHECK_EQUAL(3u, scene.GetStatistics().UpdatedNum);
+
+	scene.SetPosition(parent, position);
+	scene.SetRotation(parent, rotation);
+	scene.SetScale(parent, scale);
+	scene.SetTransform(parent, position, rotation, scale);
+	scene.SetLocalMatrix(translated, XMMatrixTranslationFromVector(position));
+	scene.UpdateWorldMatrices();
+	CHECK_EQUAL(0u, scene.GetStatistics().UpdatedNum);
+	CHECK_EQUAL(0u, scene.GetStatistics().LevelNum);
+	CHECK(scene.GetUpdatedEntities().empty());
+
+	// The same check still lets a real change through afterwards.
+	scene.SetScale(parent, XMVectorSplatOne());
+	scene.UpdateWorldMatrices();
+	CHECK_EQUAL(2u, scene.GetStatistics().UpdatedNum);
+}
+
+TEST_CASE(ChildrenUpdateAfterParentsAcrossLevels)
+{
+	// Enough entities per level to split each level across several jobs. Every entity moves one
+	// unit along x from its parent, so its world x is its depth plus one only when the parent's
+	// matrix was already final.
+	const uint32_t LevelNum = 5;
+	const uint32_t RootNum = static_cast<uint32_t>(Scene::JobEntityNum) * 3 + 7;
+
+	Scene scene;
+	XMVECTOR offset = XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+	std::vector<std::vector<Scene::Entity>> levels(LevelNum);
+	for (uint32_t i = 0; i < RootNum; ++i)
+	{
+		levels[0].push_back(scene.CreateEntity(offset, XMQuaternionIdentity(), XMVectorSplatOne()));
+	}
+	for (uint32_t level = 1; level < LevelNum; ++level)
+	{
+		for (Scene::Entity parent : levels[level - 1])
+		{
+			levels[level].push_back(scene.CreateEntity(offset, XMQuaternionIdentity(), XMVectorSplatOne(), parent));
+		}
+	}
+
+	auto checkDepthOrder = [&]()
+	{
+		const std::vector<Scene::Entity>& updated = scene.GetUpdatedEntities();
+		std::vector<uint32_t> depths(scene.GetEntityCount());
+		for (uint32_t level = 0; level < LevelNum; ++level)
+		{
+			for (Scene::Entity entity : levels[level])
+			{
+				depths[entity] = level;
+			}
+		}
+		for (size_t i = 1; i < updated.size(); ++i)
+		{
+			CHECK(depths[updated[i - 1]] <= depths[updated[i]]);
+		}
+	};
+
+	scene.UpdateWorldMatrices();
+	CHECK_EQUAL(RootNum * LevelNum, scene.GetStatistics().UpdatedNum);
+	CHECK_EQUAL(LevelNum, scene.GetStatistics().LevelNum);
+	checkDepthOrder();
+	for (uint32_t level = 0; level < LevelNum; ++level)
+	{
+		for (Scene::Entity entity : levels[level])
+		{
+			CHECK_NEAR(level + 1.0f, GetWorldPosition(scene, entity).x, 1e-4);
+		}
+	}
+
+	// Mark the deepest entities before their ancestors, so the dirty list runs against the
+	// hierarchy; the update must still go top down.
+	for (Scene::Entity entity : levels[LevelNum - 1])
+	{
+		scene.SetPosition(entity, XMVectorSet(2.0f, 0.0f, 0.0f, 0.0f));
+	}
+	for (Scene::Entity entity : levels[1])
+	{
+		scene.SetPosition(entity, XMVectorSet(3.0f, 0.0f, 0.0f, 0.0f));
+	}
+	scene.UpdateWorldMatrices();
+	CHECK_EQUAL(RootNum * (LevelNum - 1), scene.GetStatistics().UpdatedNum);
+	CHECK_EQUAL(LevelNum, scene.GetStatistics().LevelNum);
+	checkDepthOrder();
+	for (uint32_t level = 0; level < LevelNum; ++level)
+	{
+		float expected = level + 1.0f + (level >= 1 ? 2.0f : 0.0f) + (level == LevelNum - 1 ? 1.0f : 0.0f);
+		for (Scene::Entity entity : levels[level])
+		{
+			CHECK_NEAR(expected, GetWorldPosition(scene, entity).x, 1e-4);
+		}
+	}
+}
+
+TEST_CASE(NoOpUpdateTouchesNothing)
+{
+	Scene scene;
+	Scene::Entity root = scene.CreateEntity(XMVectorSet(1.0f, 2.0f, 3.0f, 0.0f), XMQuaternionIdentity(), XMVectorSplatOne());
+	for (uint32_t i = 0; i < 10; ++i)
+	{
+		scene.CreateEntity(XMVectorSet(static_cast<float>(i), 0.0f, 0.0f, 0.0f), XMQuaternionIdentity(), XMVectorSplatOne(), root);
+	}
+	scene.UpdateWorldMatrices();
+	CHECK_EQUAL(11u, scene.GetStatistics().UpdatedNum);
+	std::vector<XMFLOAT4X4> worldMatrices = scene.GetWorldMatrices();
+
+	for (uint32_t frame = 0; frame < 3; ++frame)
+	{
+		scene.UpdateWorldMatrices();
+		Scene::Statistics statistics = scene.GetStatistics();
+		CHECK_EQUAL(0u, statistics.UpdatedNum);
+		CHECK_EQUAL(0u, statistics.LevelNum);
+		CHECK_EQUAL(11u, statistics.EntityNum);
+		CHECK(scene.GetUpdatedEntities().empty());
+	}
+	for (uint32_t entity = 0; entity < scene.GetEntityCount(); ++entity)
+	{
+		CHECK(memcmp(&worldMatrices[entity], &scene.GetWorldMatrices()[entity], sizeof(XMFLOAT4X4)) == 0);
+	}
+
+	CHECK_THROWS(scene.CreateEntity(scene.GetEntityCount()));
+}
@@ -0,0 +1,164 @@
+#include "TransformBatch.h"
+#include "JobSystem.h"
+#include "TestHarness.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	struct Mat
+	{
+		XMMATRIX ModelMatrix;
+		XMMATRIX ModelViewMatrix;
+		XMMATRIX InverseTransposeModelViewMatrix;
+		XMMATRIX ModelViewProjectionMatrix;
+	};
+
+	// The per-draw path the sandbox used before TransformBatch.
+	void XM_CALLCONV ComputeMatrices(FXMMATRIX model, CXMMATRIX view, CXMMATRIX viewProjection, Mat& mat)
+	{
+		mat.ModelMatrix = model;
+		mat.ModelViewMatrix = model * view;
+		mat.InverseTransposeModelViewMatrix = XMMatrixTranspose(XMMatrixInverse(nullptr, mat.ModelViewMatrix));
+		mat.ModelViewProjectionMatrix = model * viewProjection;
+	}
+
+	void XM_CALLCONV ComputeQuantizedMatrices(FXMMATRIX dequantization, CXMMATRIX model, CXMMATRIX view, CXMMATRIX viewProjection, Mat& mat)
+	{
+		ComputeMatrices(model, view, viewProjection, mat);
+		mat.ModelMatrix = dequantization * mat.ModelMatrix;
+		mat.ModelViewMatrix = dequantization * mat.ModelViewMatrix;
+		mat.ModelViewProjectionMatrix = dequantization * mat.ModelViewProjectionMatrix;
+	}
+
+	enum class Set
+	{
+		Rigid,
+		Uniform,
+		General,
+		Mixed,
+	};
+
+	const char* SetNames[] = { "rigid", "uniform", "general", "mixed" };
+
+	struct Object
+	{
+		XMFLOAT4X4 Model;
+		bool Prefixed;
+	};
+
+	std::vector<Object> CreateObjects(Set set, size_t objectNum, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+		std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+		std::uniform_int_distribution<int> choice(0, 7);
+
+		std::vector<Object> objects(objectNum);
+		for (Object& object : objects)
+		{
+			Set objectSet = set == Set::Mixed ? static_cast<Set>(choice(random) % 3) : set;
+			XMMATRIX rotation = XMMatrixRotationRollPitchYaw(angle(random), angle(random), angle(random));
+			XMMATRIX translation = XMMatrixTranslation(position(random), position(random), position(random));
+
+			XMMATRIX scaling = XMMatrixIdentity();
+			if (objectSet == Set::Uniform)
+			{
+				float s = scale(random);
+				scaling = XMMatrixScaling(s, s, s);
+			}
+			else if (objectSet == Set::General)
+			{
+				// Non-uniform scale after a rotation also shears the result.
+				scaling = XMMatrixScaling(scale(random), scale(random), scale(random)) * XMMatrixRotationRollPitchYaw(angle(random), angle(random), angle(random)) * XMMatrixScaling(scale(random), 1.0f, scale(random));
+			}
+
+			XMStoreFloat4x4(&object.Model, scaling * rotation * translation);
+			object.Prefixed = set == Set::Mixed && choice(random) == 0;
+		}
+		return objects;
+	}
+
+	// Largest element difference, relative to the largest element of the reference matrix.
+	float XM_CALLCONV RelativeDeviation(FXMMATRIX reference, const XMFLOAT4X4& actual)
+	{
+		XMFLOAT4X4 expected;
+		XMStoreFloat4x4(&expected, reference);
+
+		float magnitude = 0.0f;
+		float difference = 0.0f;
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				magnitude = std::max(magnitude, std::fabs(expected.m[row][column]));
+				difference = std::max(difference, std::fabs(expected.m[row][column] - actual.m[row][column]));
+			}
+		}
+		return difference / std::max(magnitude, 1e-6f);
+	}
+}
+
+TEST_CASE(BatchMatchesPerDrawMatrices)
+{
+	const size_t ObjectNum = 100000;
+	const float MaxDeviation = 1e-3f;
+
+	XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 5.0f, -20.0f, 1.0f), XMVectorSet(10.0f, 0.0f, 30.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	XMMATRIX viewProjection = view * XMMatrixPerspectiveFovLH(XMConvertToRadians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	XMMATRIX dequantization = XMMatrixScaling(2.0f, 2.0f, 0.5f) * XMMatrixTranslation(-1.0f, -1.0f, -0.25f);
+
+	printf("%8s %8s %12s %10s %9s %9s %13s\n", "set", "objects", "per-draw ms", "batch ms", "speedup", "general", "max deviation");
+	for (Set set : { Set::Rigid, Set::Uniform, Set::General, Set::Mixed })
+	{
+		std::vector<Object> objects = CreateObjects(set, ObjectNum, static_cast<uint32_t>(set) + 1);
+
+		std::vector<Mat> reference(ObjectNum);
+		double perDrawTime = Test::Measure(5, [&]()
+		{
+			for (size_t i = 0; i < ObjectNum; ++i)
+			{
+				XMMATRIX model = XMLoadFloat4x4(&objects[i].Model);
+				if (objects[i].Prefixed)
+				{
+					ComputeQuantizedMatrices(dequantization, model, view, viewProjection, reference[i]);
+				}
+				else
+				{
+					ComputeMatrices(model, view, viewProjection, reference[i]);
+				}
+			}
+		});
+
+		TransformBatch batch;
+		batch.Reserve(ObjectNum);
+		batch.SetViewProjection(view, viewProjection);
+		uint32_t prefix = batch.AddPrefix(dequantization);
+		for (const Object& object : objects)
+		{
+			batch.Add(XMLoadFloat4x4(&object.Model), object.Prefixed ? prefix : TransformBatch::NoPrefix);
+		}
+
+		std::vector<XMFLOAT4X4> output(ObjectNum * 4);
+		double batchTime = Test::Measure(5, [&]() { batch.Compute(output.data(), TransformBatch::OutputSize); });
+
+		float maxDeviation = 0.0f;
+		for (size_t i = 0; i < ObjectNum; ++i)
+		{
+			maxDeviation = std::max(maxDeviation, RelativeDeviation(reference[i].ModelMatrix, output[i * 4 + 0]));
+			maxDeviation = std::max(maxDeviation, RelativeDeviation(reference[i].ModelViewMatrix, output[i * 4 + 1]));
+			maxDeviation = std::max(maxDeviation, RelativeDeviation(reference[i].InverseTransposeModelViewMatrix, output[i * 4 + 2]));
+			maxDeviation = std::max(maxDeviation, RelativeDeviation(reference[i].ModelViewProjectionMatrix, output[i * 4 + 3]));
+		}
+
+		TransformBatch::Statistics statistics = batch.GetStatistics();
+		printf("%8s %8zu %12.3f %10.3f %8.1fx %9u %13.2e\n", SetNames[static_cast<int>(set)], ObjectNum, perDrawTime, batchTime, perDrawTime / batchTime, statistics.GeneralNum, maxDeviation);
+		CHECK(maxDeviation < MaxDeviation);
+		if (set == Set::Rigid || set == Set::Uniform) CHECK_EQUAL(0u, statistics.GeneralNum);
+		if (set == Set::General) CHECK_EQUAL(static_cast<uint32_t>(ObjectNum), statistics.GeneralNum);
+	}
+	printf("%u job system workers\n", JobSystem::Get().GetWorkerCount() + 1);
+}
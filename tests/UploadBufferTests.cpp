@@ -0,0 +1,92 @@
+#include "UploadBuffer.h"
+#include "Application.h"
+#include "TestHarness.h"
+
+namespace
+{
+	const size_t PageSize = _2MB;
+
+	uint32_t GetCommittedResourceNum()
+	{
+		return Application::Get().GetTestDevice().GetStatistics().CommittedResourceNum;
+	}
+}
+
+TEST_CASE(SmallAllocationsShareAPage)
+{
+	UploadBuffer buffer;
+	uint32_t resourceNum = GetCommittedResourceNum();
+
+	auto first = buffer.Allocate(100, 256);
+	auto second = buffer.Allocate(100, 256);
+	CHECK_EQUAL(resourceNum + 1, GetCommittedResourceNum());
+	CHECK(first.Resource == second.Resource);
+	CHECK_EQUAL(0u, first.Offset);
+	CHECK_EQUAL(256u, second.Offset);
+	CHECK_EQUAL(first.GPUAddress + 256, second.GPUAddress);
+	CHECK(static_cast<uint8_t*>(first.CPUAddress) + 256 == second.CPUAddress);
+
+	auto third = buffer.Allocate(PageSize - 256, 256);
+	CHECK(third.Resource != first.Resource);
+	CHECK_EQUAL(resourceNum + 2, GetCommittedResourceNum());
+}
+
+TEST_CASE(AllocationsLargerThanAPageGetTheirOwnBlock)
+{
+	UploadBuffer buffer;
+	uint32_t resourceNum = GetCommittedResourceNum();
+
+	// 20k objects at 272 bytes each, the RenderQueue per-object stride.
+	const size_t objectBytes = 20000 * 272;
+	auto small = buffer.Allocate(64, 16);
+	auto large = buffer.Allocate(objectBytes, 16);
+	auto after = buffer.Allocate(64, 16);
+
+	CHECK(large.Resource != small.Resource);
+	CHECK(after.Resource == small.Resource);
+	CHECK_EQUAL(0u, large.Offset);
+	CHECK(large.Resource->GetDesc().Width >= objectBytes);
+	CHECK_EQUAL(0u, large.Resource->GetDesc().Width % PageSize);
+	CHECK_EQUAL(resourceNum + 2, GetCommittedResourceNum());
+
+	memset(large.CPUAddress, 0xab, objectBytes);
+	CHECK_EQUAL(0xab, static_cast<uint8_t*>(large.CPUAddress)[objectBytes - 1]);
+}
+
+TEST_CASE(LargeBlocksAreReusedAfterReset)
+{
+	UploadBuffer buffer;
+	uint32_t resourceNum = GetCommittedResourceNum();
+
+	auto big = buffer.Allocate(3 * PageSize, 256);
+	auto bigger = buffer.Allocate(5 * PageSize + 1, 256);
+	CHECK(big.Resource != bigger.Resource);
+	CHECK_EQUAL(resourceNum + 2, GetCommittedResourceNum());
+
+	buffer.Reset();
+	auto smaller = buffer.Allocate(2 * PageSize + 1, 256);
+	auto biggest = buffer.Allocate(5 * PageSize + 1, 256);
+	CHECK(smaller.Resource == big.Resource);
+	CHECK(biggest.Resource == bigger.Resource);
+	CHECK_EQUAL(resourceNum + 2, GetCommittedResourceNum());
+
+	auto extra = buffer.Allocate(3 * PageSize, 256);
+	CHECK(extra.Resource != big.Resource && extra.Resource != bigger.Resource);
+	CHECK_EQUAL(resourceNum + 3, GetCommittedResourceNum());
+}
+
+TEST_CASE(PagesAreReusedAfterReset)
+{
+	UploadBuffer buffer;
+	uint32_t resourceNum = GetCommittedResourceNum();
+
+	for (int frame = 0; frame < 4; ++frame)
+	{
+		for (int i = 0; i < 10; ++i)
+		{
+			buffer.Allocate(PageSize / 4, 256);
+		}
+		buffer.Reset();
+	}
+	CHECK_EQUAL(resourceNum + 3, GetCommittedResourceNum());
+}
@@ -0,0 +1,195 @@
+#include "VertexQuantization.h"
+#include "TestHarness.h"
+
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	// Float rounding in the decode itself, on top of the quantization step.
+	float GetFloatSlack(const QuantizationBounds& bounds)
+	{
+		float magnitude = std::max({ std::fabs(bounds.Center.x), std::fabs(bounds.Center.y), std::fabs(bounds.Center.z) }) +
+			std::max({ bounds.Extent.x, bounds.Extent.y, bounds.Extent.z });
+		return magnitude * 4e-7f;
+	}
+
+	float GetPositionError(const float position[3], const QuantizationBounds& bounds)
+	{
+		int16_t encoded[4];
+		float decoded[3];
+		VertexQuantization::EncodePosition(position, bounds, encoded);
+		VertexQuantization::DecodePosition(encoded, bounds, decoded);
+		return std::max({ std::fabs(decoded[0] - position[0]), std::fabs(decoded[1] - position[1]), std::fabs(decoded[2] - position[2]) });
+	}
+
+	float GetNormalErrorDegrees(const float normal[3])
+	{
+		int16_t encoded[2];
+		float decoded[3];
+		VertexQuantization::EncodeOctahedral(normal, encoded);
+		VertexQuantization::DecodeOctahedral(encoded, decoded);
+		// atan2 of the cross and dot products stays accurate for tiny angles, where acos does not.
+		XMVECTOR a = XMVectorSet(normal[0], normal[1], normal[2], 0.0f);
+		XMVECTOR b = XMVectorSet(decoded[0], decoded[1], decoded[2], 0.0f);
+		return XMConvertToDegrees(std::atan2(XMVectorGetX(XMVector3Length(XMVector3Cross(a, b))), XMVectorGetX(XMVector3Dot(a, b))));
+	}
+}
+
+TEST_CASE(PositionErrorWithinReportedBound)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	// A unit cube, a large offset scene-sized box and a box flat along one axis.
+	const float boxes[][6] = {
+		{ -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f },
+		{ 900.0f, -20.0f, 4000.0f, 1100.0f, 40.0f, 4500.0f },
+		{ -5.0f, 2.0f, -5.0f, 5.0f, 2.0f, 5.0f },
+	};
+
+	for (const float* box : boxes)
+	{
+		std::vector<float> positions;
+		for (int i = 0; i < 10000; ++i)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				positions.push_back(box[k] + unit(random) * (box[k + 3] - box[k]));
+			}
+		}
+		// The box corners, so the extremes of the snorm range are covered.
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				positions.push_back((corner >> k) & 1 ? box[k + 3] : box[k]);
+			}
+		}
+
+		size_t vertexNum = positions.size() / 3;
+		QuantizationBounds bounds = VertexQuantization::ComputeBounds(positions.data(), vertexNum, sizeof(float) * 3);
+		float maxError = VertexQuantization::GetMaxPositionError(bounds);
+		float slack = GetFloatSlack(bounds);
+
+		float error = 0.0f;
+		for (size_t i = 0; i < vertexNum; ++i)
+		{
+			error = std::max(error, GetPositionError(&positions[i * 3], bounds));
+		}
+		CHECK(error <= maxError + slack);
+		// Rounding to nearest keeps the error within half a step; the reported bound is a full step.
+		CHECK(error <= maxError * 0.5f + slack);
+	}
+}
+
+TEST_CASE(PositionBoundsCornersUseFullRange)
+{
+	const float positions[] = { -2.0f, 0.0f, 10.0f, 6.0f, 1.0f, 12.0f };
+	QuantizationBounds bounds = VertexQuantization::ComputeBounds(positions, 2, sizeof(float) * 3);
+	CHECK_NEAR(2.0f, bounds.Center.x, 1e-6);
+	CHECK_NEAR(4.0f, bounds.Extent.x, 1e-6);
+
+	int16_t encoded[4];
+	VertexQuantization::EncodePosition(positions, bounds, encoded);
+	CHECK_EQUAL(-32767, encoded[0]);
+	CHECK_EQUAL(-32767, encoded[1]);
+	CHECK_EQUAL(-32767, encoded[2]);
+	CHECK_EQUAL(32767, encoded[3]);
+
+	VertexQuantization::EncodePosition(positions + 3, bounds, encoded);
+	CHECK_EQUAL(32767, encoded[0]);
+	CHECK_EQUAL(32767, encoded[1]);
+	CHECK_EQUAL(32767, encoded[2]);
+}
+
+TEST_CASE(OctahedralNormalErrorBelowBound)
+{
+	// 16-bit octahedral steps are about 0.0036 degrees at their coarsest, near the octahedron's edges.
+	const float MaxErrorDegrees = 0.005f;
+
+	std::mt19937 random(2);
+	std::normal_distribution<float> gaussian;
+
+	float error = 0.0f;
+	for (int i = 0; i < 100000; ++i)
+	{
+		XMFLOAT3 normal;
+		XMStoreFloat3(&normal, XMVector3Normalize(XMVectorSet(gaussian(random), gaussian(random), gaussian(random), 0.0f)));
+		error = std::max(error, GetNormalErrorDegrees(&normal.x));
+	}
+	CHECK(error < MaxErrorDegrees);
+
+	// Axes and the z = 0 equator, where the lower hemisphere fold meets the upper one.
+	const float edges[][3] = {
+		{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+		{ 0.70710678f, 0.70710678f, 0 }, { -0.70710678f, 0.70710678f, 0 }, { 0.70710678f, -0.70710678f, 0 }, { -0.70710678f, -0.70710678f, 0 },
+		{ 0.57735027f, -0.57735027f, -0.57735027f }, { -0.57735027f, 0.57735027f, -0.57735027f },
+	};
+	for (const float* normal : edges)
+	{
+		CHECK(GetNormalErrorDegrees(normal) < MaxErrorDegrees);
+	}
+}
+
+TEST_CASE(OctahedralNormalsDecodeToUnitLength)
+{
+	for (int x = -32767; x <= 32767; x += 257)
+	{
+		for (int y = -32767; y <= 32767; y += 263)
+		{
+			const int16_t encoded[2] = { static_cast<int16_t>(x), static_cast<int16_t>(y) };
+			float normal[3];
+			VertexQuantization::DecodeOctahedral(encoded, normal);
+			CHECK_NEAR(1.0f, std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]), 1e-5);
+		}
+	}
+}
+
+TEST_CASE(HalfTextureCoordinatesWithinHalfUlp)
+{
+	// Texture coordinates in [0, 1] and tiled up to 64; half keeps 11 significant bits.
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::uniform_real_distribution<float> tiled(-64.0f, 64.0f);
+
+	for (int i = 0; i < 100000; ++i)
+	{
+		for (float value : { unit(random), tiled(random) })
+		{
+			float decoded = VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(value));
+			float bound = std::max(std::fabs(value) * std::ldexp(1.0f, -11), std::ldexp(1.0f, -25));
+			CHECK(std::fabs(decoded - value) <= bound);
+		}
+	}
+
+	// Every 1/1024 step in [0, 1] is exact.
+	for (int i = 0; i <= 1024; ++i)
+	{
+		float value = i / 1024.0f;
+		CHECK_EQUAL(value, VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(value)));
+	}
+}
+
+TEST_CASE(HalfRoundTripsAndSpecialValues)
+{
+	for (uint32_t bits = 0; bits <= 0xffff; ++bits)
+	{
+		uint16_t half = static_cast<uint16_t>(bits);
+		float value = VertexQuantization::HalfToFloat(half);
+		if (std::isnan(value))
+		{
+			CHECK(std::isnan(VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(value))));
+			continue;
+		}
+		CHECK_EQUAL(half, VertexQuantization::FloatToHalf(value));
+	}
+
+	CHECK_EQUAL(65504.0f, VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(65504.0f)));
+	CHECK(std::isinf(VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(65520.0f))));
+	CHECK_EQUAL(0x8000, VertexQuantization::FloatToHalf(-0.0f));
+	// Halfway between 1 and the next half rounds to even.
+	CHECK_EQUAL(0x3c00, VertexQuantization::FloatToHalf(1.0f + std::ldexp(1.0f, -11)));
+}
@@ -0,0 +1,45 @@
+#ifndef __RENDER_CORE_H_
+#define __RENDER_CORE_H_
+
+// Stand-in for Render/Core.h when building Render sources into the CPU tests.
+// It keeps the same namespaces and standard headers but replaces the Windows
+// and Direct3D includes with D3D12Types.h, so no device or SDK is needed.
+
+#include "D3D12Types.h"
+using namespace Microsoft::WRL;
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+using namespace DirectX;
+
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <thread>
+#include <vector>
+#include <queue>
+#include <set>
+#include <functional>
+
+namespace fs = std::filesystem;
+
+#include "Helpers.h"
+
+#endif
@@ -0,0 +1,425 @@
+#ifndef __D3D12TYPES_H_
+#define __D3D12TYPES_H_
+
+// The part of the Direct3D 12 API surface that the Render sources under test
+// touch. Values match d3d12.h; interfaces are plain reference-counted classes
+// so that test doubles can implement them without a device.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+#include <utility>
+
+using BYTE = uint8_t;
+using UINT = uint32_t;
+using UINT64 = uint64_t;
+using SIZE_T = size_t;
+using HRESULT = int32_t;
+
+#define S_OK ((HRESULT)0L)
+#define E_FAIL ((HRESULT)0x80004005L)
+#define E_NOTIMPL ((HRESULT)0x80004001L)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+
+// Debugger output goes to stderr; wide strings are narrowed so the stream keeps one orientation.
+inline void OutputDebugStringA(const char* message)
+{
+	fputs(message, stderr);
+}
+
+inline void OutputDebugStringW(const wchar_t* message)
+{
+	for (; *message; ++message)
+	{
+		fputc(*message < 0x80 ? static_cast<char>(*message) : '?', stderr);
+	}
+}
+
+#define DEFINE_ENUM_FLAG_OPERATORS(ENUMTYPE) \
+	inline constexpr ENUMTYPE operator|(ENUMTYPE a, ENUMTYPE b) { return ENUMTYPE(uint64_t(a) | uint64_t(b)); } \
+	inline ENUMTYPE& operator|=(ENUMTYPE& a, ENUMTYPE b) { return a = a | b; } \
+	inline constexpr ENUMTYPE operator&(ENUMTYPE a, ENUMTYPE b) { return ENUMTYPE(uint64_t(a) & uint64_t(b)); } \
+	inline ENUMTYPE& operator&=(ENUMTYPE& a, ENUMTYPE b) { return a = a & b; } \
+	inline constexpr ENUMTYPE operator~(ENUMTYPE a) { return ENUMTYPE(~uint64_t(a)); }
+
+using D3D12_GPU_VIRTUAL_ADDRESS = uint64_t;
+
+#define D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES 0xffffffff
+
+enum DXGI_FORMAT
+{
+	DXGI_FORMAT_UNKNOWN = 0,
+	DXGI_FORMAT_R32G32B32A32_FLOAT = 2,
+	DXGI_FORMAT_R32G32B32_FLOAT = 6,
+	DXGI_FORMAT_R16G16B16A16_FLOAT = 10,
+	DXGI_FORMAT_R16G16B16A16_SNORM = 13,
+	DXGI_FORMAT_R32G32_FLOAT = 16,
+	DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+	DXGI_FORMAT_R16G16_FLOAT = 34,
+	DXGI_FORMAT_R16G16_SNORM = 37,
+	DXGI_FORMAT_D32_FLOAT = 40,
+	DXGI_FORMAT_R32_FLOAT = 41,
+	DXGI_FORMAT_R32_UINT = 42,
+	DXGI_FORMAT_R16_UINT = 57,
+};
+
+struct DXGI_SAMPLE_DESC
+{
+	UINT Count;
+	UINT Quality;
+};
+
+enum D3D12_RESOURCE_STATES
+{
+	D3D12_RESOURCE_STATE_COMMON = 0,
+	D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER = 0x1,
+	D3D12_RESOURCE_STATE_INDEX_BUFFER = 0x2,
+	D3D12_RESOURCE_STATE_RENDER_TARGET = 0x4,
+	D3D12_RESOURCE_STATE_UNORDERED_ACCESS = 0x8,
+	D3D12_RESOURCE_STATE_DEPTH_WRITE = 0x10,
+	D3D12_RESOURCE_STATE_DEPTH_READ = 0x20,
+	D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE = 0x40,
+	D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE = 0x80,
+	D3D12_RESOURCE_STATE_STREAM_OUT = 0x100,
+	D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT = 0x200,
+	D3D12_RESOURCE_STATE_COPY_DEST = 0x400,
+	D3D12_RESOURCE_STATE_COPY_SOURCE = 0x800,
+	D3D12_RESOURCE_STATE_RESOLVE_DEST = 0x1000,
+	D3D12_RESOURCE_STATE_RESOLVE_SOURCE = 0x2000,
+	D3D12_RESOURCE_STATE_GENERIC_READ = 0x1 | 0x2 | 0x40 | 0x80 | 0x200 | 0x800,
+};
+DEFINE_ENUM_FLAG_OPERATORS(D3D12_RESOURCE_STATES)
+
+enum D3D12_RESOURCE_FLAGS
+{
+	D3D12_RESOURCE_FLAG_NONE = 0,
+	D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET = 0x1,
+	D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL = 0x2,
+	D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS = 0x4,
+	D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE = 0x8,
+};
+DEFINE_ENUM_FLAG_OPERATORS(D3D12_RESOURCE_FLAGS)
+
+enum D3D12_RESOURCE_DIMENSION
+{
+	D3D12_RESOURCE_DIMENSION_UNKNOWN = 0,
+	D3D12_RESOURCE_DIMENSION_BUFFER = 1,
+	D3D12_RESOURCE_DIMENSION_TEXTURE1D = 2,
+	D3D12_RESOURCE_DIMENSION_TEXTURE2D = 3,
+	D3D12_RESOURCE_DIMENSION_TEXTURE3D = 4,
+};
+
+enum D3D12_TEXTURE_LAYOUT
+{
+	D3D12_TEXTURE_LAYOUT_UNKNOWN = 0,
+	D3D12_TEXTURE_LAYOUT_ROW_MAJOR = 1,
+};
+
+struct D3D12_RESOURCE_DESC
+{
+	D3D12_RESOURCE_DIMENSION Dimension;
+	UINT64 Alignment;
+	UINT64 Width;
+	UINT Height;
+	uint16_t DepthOrArraySize;
+	uint16_t MipLevels;
+	DXGI_FORMAT Format;
+	DXGI_SAMPLE_DESC SampleDesc;
+	D3D12_TEXTURE_LAYOUT Layout;
+	D3D12_RESOURCE_FLAGS Flags;
+};
+
+struct D3D12_DEPTH_STENCIL_VALUE
+{
+	float Depth;
+	uint8_t Stencil;
+};
+
+struct D3D12_CLEAR_VALUE
+{
+	DXGI_FORMAT Format;
+	union
+	{
+		float Color[4];
+		D3D12_DEPTH_STENCIL_VALUE DepthStencil;
+	};
+};
+
+struct D3D12_RESOURCE_ALLOCATION_INFO
+{
+	UINT64 SizeInBytes;
+	UINT64 Alignment;
+};
+
+const UINT64 D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT = 65536;
+
+enum D3D12_HEAP_TYPE
+{
+	D3D12_HEAP_TYPE_DEFAULT = 1,
+	D3D12_HEAP_TYPE_UPLOAD = 2,
+	D3D12_HEAP_TYPE_READBACK = 3,
+};
+
+enum D3D12_HEAP_FLAGS
+{
+	D3D12_HEAP_FLAG_NONE = 0,
+	D3D12_HEAP_FLAG_DENY_BUFFERS = 0x4,
+	D3D12_HEAP_FLAG_DENY_NON_RT_DS_TEXTURES = 0x80,
+	D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES = 0x44,
+};
+DEFINE_ENUM_FLAG_OPERATORS(D3D12_HEAP_FLAGS)
+
+struct D3D12_HEAP_PROPERTIES
+{
+	D3D12_HEAP_TYPE Type;
+	UINT CPUPageProperty;
+	UINT MemoryPoolPreference;
+	UINT CreationNodeMask;
+	UINT VisibleNodeMask;
+};
+
+struct D3D12_HEAP_DESC
+{
+	UINT64 SizeInBytes;
+	D3D12_HEAP_PROPERTIES Properties;
+	UINT64 Alignment;
+	D3D12_HEAP_FLAGS Flags;
+};
+
+struct D3D12_RANGE
+{
+	SIZE_T Begin;
+	SIZE_T End;
+};
+
+struct D3D12_DRAW_INDEXED_ARGUMENTS
+{
+	UINT IndexCountPerInstance;
+	UINT InstanceCount;
+	UINT StartIndexLocation;
+	int32_t BaseVertexLocation;
+	UINT StartInstanceLocation;
+};
+
+enum D3D12_INDIRECT_ARGUMENT_TYPE
+{
+	D3D12_INDIRECT_ARGUMENT_TYPE_DRAW = 0,
+	D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED = 1,
+	D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH = 2,
+	D3D12_INDIRECT_ARGUMENT_TYPE_VERTEX_BUFFER_VIEW = 3,
+	D3D12_INDIRECT_ARGUMENT_TYPE_INDEX_BUFFER_VIEW = 4,
+	D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT = 5,
+	D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW = 6,
+	D3D12_INDIRECT_ARGUMENT_TYPE_SHADER_RESOURCE_VIEW = 7,
+	D3D12_INDIRECT_ARGUMENT_TYPE_UNORDERED_ACCESS_VIEW = 8,
+};
+
+struct D3D12_INDIRECT_ARGUMENT_DESC
+{
+	D3D12_INDIRECT_ARGUMENT_TYPE Type;
+	union
+	{
+		struct
+		{
+			UINT Slot;
+		} VertexBuffer;
+		struct
+		{
+			UINT RootParameterIndex;
+			UINT DestOffsetIn32BitValues;
+			UINT Num32BitValuesToSet;
+		} Constant;
+		struct
+		{
+			UINT RootParameterIndex;
+		} ConstantBufferView;
+		struct
+		{
+			UINT RootParameterIndex;
+		} ShaderResourceView;
+		struct
+		{
+			UINT RootParameterIndex;
+		} UnorderedAccessView;
+	};
+};
+
+enum D3D12_INPUT_CLASSIFICATION
+{
+	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA = 0,
+	D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA = 1,
+};
+
+const UINT D3D12_APPEND_ALIGNED_ELEMENT = 0xffffffff;
+
+struct D3D12_INPUT_ELEMENT_DESC
+{
+	const char* SemanticName;
+	UINT SemanticIndex;
+	DXGI_FORMAT Format;
+	UINT InputSlot;
+	UINT AlignedByteOffset;
+	D3D12_INPUT_CLASSIFICATION InputSlotClass;
+	UINT InstanceDataStepRate;
+};
+
+enum D3D_PRIMITIVE_TOPOLOGY
+{
+	D3D_PRIMITIVE_TOPOLOGY_UNDEFINED = 0,
+	D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST = 4,
+};
+
+struct IID
+{
+};
+using REFIID = const IID&;
+
+#define IID_PPV_ARGS(ppType) IID(), reinterpret_cast<void**>(ppType)
+
+class IUnknown
+{
+public:
+	virtual ~IUnknown() {}
+
+	UINT AddRef()
+	{
+		return ++mReferenceCount;
+	}
+
+	UINT Release()
+	{
+		UINT count = --mReferenceCount;
+		if (count == 0)
+		{
+			delete this;
+		}
+		return count;
+	}
+
+private:
+	std::atomic<UINT> mReferenceCount{ 1 };
+};
+
+class ID3D12Object : public IUnknown {};
+
+class ID3D12Resource : public ID3D12Object
+{
+public:
+	virtual HRESULT Map(UINT subresource, const D3D12_RANGE* readRange, void** data) = 0;
+	virtual void Unmap(UINT subresource, const D3D12_RANGE* writtenRange) = 0;
+	virtual D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() = 0;
+	virtual D3D12_RESOURCE_DESC GetDesc() = 0;
+};
+
+class ID3D12Heap : public ID3D12Object
+{
+public:
+	virtual D3D12_HEAP_DESC GetDesc() = 0;
+};
+
+class ID3D12PipelineState : public ID3D12Object {};
+class ID3D12RootSignature : public ID3D12Object {};
+class ID3D12CommandSignature : public ID3D12Object {};
+
+class ID3D12Device : public ID3D12Object
+{
+public:
+	virtual HRESULT CreateCommittedResource(const D3D12_HEAP_PROPERTIES* heapProperties, D3D12_HEAP_FLAGS heapFlags, const D3D12_RESOURCE_DESC* desc,
+											D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue, REFIID riid, void** resource) = 0;
+	virtual HRESULT CreateHeap(const D3D12_HEAP_DESC* desc, REFIID riid, void** heap) = 0;
+	virtual HRESULT CreatePlacedResource(ID3D12Heap* heap, UINT64 heapOffset, const D3D12_RESOURCE_DESC* desc, D3D12_RESOURCE_STATES initialState,
+										 const D3D12_CLEAR_VALUE* clearValue, REFIID riid, void** resource) = 0;
+	virtual D3D12_RESOURCE_ALLOCATION_INFO GetResourceAllocationInfo(UINT visibleMask, UINT numResourceDescs, const D3D12_RESOURCE_DESC* resourceDescs) = 0;
+};
+
+class ID3D12Device2 : public ID3D12Device {};
+
+namespace Microsoft
+{
+	namespace WRL
+	{
+		template<typename T>
+		class ComPtr
+		{
+		public:
+			ComPtr() : mPointer(nullptr) {}
+			ComPtr(std::nullptr_t) : mPointer(nullptr) {}
+			ComPtr(T* pointer) : mPointer(pointer) { InternalAddRef(); }
+			ComPtr(const ComPtr& other) : mPointer(other.mPointer) { InternalAddRef(); }
+			ComPtr(ComPtr&& other) noexcept : mPointer(other.mPointer) { other.mPointer = nullptr; }
+			template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+			ComPtr(const ComPtr<U>& other) : mPointer(other.Get()) { InternalAddRef(); }
+			~ComPtr() { InternalRelease(); }
+
+			ComPtr& operator=(ComPtr other)
+			{
+				std::swap(mPointer, other.mPointer);
+				return *this;
+			}
+
+			T* Get() const { return mPointer; }
+			T* operator->() const { return mPointer; }
+			explicit operator bool() const { return mPointer != nullptr; }
+
+			T** GetAddressOf() { return &mPointer; }
+			T** ReleaseAndGetAddressOf()
+			{
+				InternalRelease();
+				return &mPointer;
+			}
+			T** operator&() { return ReleaseAndGetAddressOf(); }
+
+			void Reset() { InternalRelease(); }
+			void Attach(T* pointer)
+			{
+				InternalRelease();
+				mPointer = pointer;
+			}
+
+			bool operator==(const ComPtr& other) const { return mPointer == other.mPointer; }
+			bool operator!=(const ComPtr& other) const { return mPointer != other.mPointer; }
+
+		private:
+			void InternalAddRef()
+			{
+				if (mPointer) mPointer->AddRef();
+			}
+
+			void InternalRelease()
+			{
+				T* pointer = mPointer;
+				mPointer = nullptr;
+				if (pointer) pointer->Release();
+			}
+
+			T* mPointer;
+		};
+	}
+}
+
+struct CD3DX12_HEAP_PROPERTIES : public D3D12_HEAP_PROPERTIES
+{
+	explicit CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE type)
+		: D3D12_HEAP_PROPERTIES{ type, 0, 0, 1, 1 } {}
+};
+
+struct CD3DX12_RESOURCE_DESC : public D3D12_RESOURCE_DESC
+{
+	explicit CD3DX12_RESOURCE_DESC(const D3D12_RESOURCE_DESC& desc) : D3D12_RESOURCE_DESC(desc) {}
+
+	static CD3DX12_RESOURCE_DESC Buffer(UINT64 width, D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE)
+	{
+		return CD3DX12_RESOURCE_DESC({ D3D12_RESOURCE_DIMENSION_BUFFER, 0, width, 1, 1, 1, DXGI_FORMAT_UNKNOWN, { 1, 0 }, D3D12_TEXTURE_LAYOUT_ROW_MAJOR, flags });
+	}
+
+	static CD3DX12_RESOURCE_DESC Tex2D(DXGI_FORMAT format, UINT64 width, UINT height, uint16_t arraySize = 1, uint16_t mipLevels = 0,
+									   UINT sampleCount = 1, UINT sampleQuality = 0, D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE)
+	{
+		return CD3DX12_RESOURCE_DESC({ D3D12_RESOURCE_DIMENSION_TEXTURE2D, 0, width, height, arraySize, mipLevels, format, { sampleCount, sampleQuality }, D3D12_TEXTURE_LAYOUT_UNKNOWN, flags });
+	}
+};
+
+#endif
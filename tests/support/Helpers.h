@@ -0,0 +1,53 @@
+#ifndef __RTR_HELPERS_H_
+#define __RTR_HELPERS_H_
+
+// Device-free part of Render/Helpers.h.
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "D3D12Types.h"
+
+inline void ThrowIfFailed(HRESULT hr)
+{
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("HRESULT failure");
+	}
+}
+
+namespace Math
+{
+	template <typename T>
+	inline T AlignUpWithMask(T value, size_t mask)
+	{
+		return (T)(((size_t)value + mask) & ~mask);
+	}
+
+	template <typename T>
+	inline T AlignDownWithMask(T value, size_t mask)
+	{
+		return (T)((size_t)value & ~mask);
+	}
+
+	template <typename T>
+	inline T AlignUp(T value, size_t alignment)
+	{
+		return AlignUpWithMask(value, alignment - 1);
+	}
+
+	template <typename T>
+	inline T AlignDown(T value, size_t alignment)
+	{
+		return AlignDownWithMask(value, alignment - 1);
+	}
+
+	template <typename T>
+	inline T DivideByMultiple(T value, size_t alignment)
+	{
+		return (T)((value + alignment - 1) / alignment);
+	}
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef __TESTHARNESS_H_
+#define __TESTHARNESS_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Test
+{
+	using Function = void(*)();
+
+	struct Case
+	{
+		const char* Name;
+		Function Run;
+	};
+
+	std::vector<Case>& GetCases();
+	void ReportFailure(const char* file, int line, const std::string& message);
+
+	struct Registrar
+	{
+		Registrar(const char* name, Function run)
+		{
+			GetCases().push_back({ name, run });
+		}
+	};
+
+	template<typename T>
+	std::string ToString(const T& value)
+	{
+		std::ostringstream stream;
+		stream << value;
+		return stream.str();
+	}
+
+	// Best wall time of several runs, in milliseconds.
+	template<typename Function>
+	double Measure(int repeat, Function&& function)
+	{
+		double best = 1e30;
+		for (int i = 0; i < repeat; ++i)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			function();
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+		}
+		return best;
+	}
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static Test::Registrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) Test::ReportFailure(__FILE__, __LINE__, #condition); } while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+	do { \
+		auto&& expectedValue = (expected); \
+		auto&& actualValue = (actual); \
+		if (!(expectedValue == actualValue)) \
+			Test::ReportFailure(__FILE__, __LINE__, std::string(#expected " == " #actual " (") + Test::ToString(expectedValue) + " vs " + Test::ToString(actualValue) + ")"); \
+	} while (0)
+
+#define CHECK_NEAR(expected, actual, tolerance) \
+	do { \
+		double expectedValue = (expected); \
+		double actualValue = (actual); \
+		if (!(std::fabs(expectedValue - actualValue) <= (tolerance))) \
+			Test::ReportFailure(__FILE__, __LINE__, std::string(#expected " ~= " #actual " (") + Test::ToString(expectedValue) + " vs " + Test::ToString(actualValue) + ")"); \
+	} while (0)
+
+#define CHECK_THROWS(expression) \
+	do { \
+		bool threw = false; \
+		try { expression; } catch (...) { threw = true; } \
+		if (!threw) Test::ReportFailure(__FILE__, __LINE__, #expression " did not throw"); \
+	} while (0)
+
+#endif
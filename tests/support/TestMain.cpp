@@ -0,0 +1,59 @@
+#include "TestHarness.h"
+
+#include <cstring>
+#include <exception>
+
+namespace Test
+{
+	namespace
+	{
+		int gFailureNum = 0;
+	}
+
+	std::vector<Case>& GetCases()
+	{
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	void ReportFailure(const char* file, int line, const std::string& message)
+	{
+		std::printf("%s(%d): check failed: %s\n", file, line, message.c_str());
+		++gFailureNum;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+
+	int failedCaseNum = 0;
+	int runCaseNum = 0;
+	for (const Test::Case& testCase : Test::GetCases())
+	{
+		if (filter && !std::strstr(testCase.Name, filter)) continue;
+
+		int failureNum = Test::gFailureNum;
+		std::printf("[ RUN  ] %s\n", testCase.Name);
+		try
+		{
+			testCase.Run();
+		}
+		catch (const std::exception& e)
+		{
+			Test::ReportFailure(testCase.Name, 0, std::string("unexpected exception: ") + e.what());
+		}
+		catch (...)
+		{
+			Test::ReportFailure(testCase.Name, 0, "unexpected exception");
+		}
+
+		bool passed = failureNum == Test::gFailureNum;
+		std::printf("[ %s ] %s\n", passed ? " OK " : "FAIL", testCase.Name);
+		failedCaseNum += passed ? 0 : 1;
+		++runCaseNum;
+	}
+
+	std::printf("%d of %d cases passed\n", runCaseNum - failedCaseNum, runCaseNum);
+	return failedCaseNum == 0 && runCaseNum > 0 ? 0 : 1;
+}
@@ -0,0 +1,328 @@
+#ifndef __COMPAT_DIRECTXCOLLISION_H_
+#define __COMPAT_DIRECTXCOLLISION_H_
+
+// Subset of DirectXCollision used by the Render sources under test, for hosts
+// without the Windows SDK. Intersection tests are exact separating-axis tests,
+// matching the SDK results for the shapes covered here.
+
+#include "DirectXMath.h"
+
+#include <algorithm>
+
+namespace DirectX
+{
+	enum ContainmentType
+	{
+		DISJOINT = 0,
+		INTERSECTS = 1,
+		CONTAINS = 2,
+	};
+
+	struct BoundingBox;
+
+	struct BoundingSphere
+	{
+		XMFLOAT3 Center;
+		float Radius;
+
+		BoundingSphere() : Center(0, 0, 0), Radius(1.0f) {}
+		constexpr BoundingSphere(const XMFLOAT3& center, float radius) : Center(center), Radius(radius) {}
+
+		static void CreateFromPoints(BoundingSphere& out, size_t count, const XMFLOAT3* points, size_t stride)
+		{
+			XMFLOAT3 minPoint(FLT_MAX, FLT_MAX, FLT_MAX);
+			XMFLOAT3 maxPoint(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(points);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const XMFLOAT3& point = *reinterpret_cast<const XMFLOAT3*>(bytes + i * stride);
+				minPoint = XMFLOAT3(std::min(minPoint.x, point.x), std::min(minPoint.y, point.y), std::min(minPoint.z, point.z));
+				maxPoint = XMFLOAT3(std::max(maxPoint.x, point.x), std::max(maxPoint.y, point.y), std::max(maxPoint.z, point.z));
+			}
+
+			out.Center = XMFLOAT3((minPoint.x + maxPoint.x) * 0.5f, (minPoint.y + maxPoint.y) * 0.5f, (minPoint.z + maxPoint.z) * 0.5f);
+			float radiusSq = 0.0f;
+			for (size_t i = 0; i < count; ++i)
+			{
+				const XMFLOAT3& point = *reinterpret_cast<const XMFLOAT3*>(bytes + i * stride);
+				float dx = point.x - out.Center.x, dy = point.y - out.Center.y, dz = point.z - out.Center.z;
+				radiusSq = std::max(radiusSq, dx * dx + dy * dy + dz * dz);
+			}
+			out.Radius = std::sqrt(radiusSq);
+		}
+
+		static void CreateFromBoundingBox(BoundingSphere& out, const BoundingBox& box);
+	};
+
+	struct BoundingBox
+	{
+		static const size_t CORNER_COUNT = 8;
+
+		XMFLOAT3 Center;
+		XMFLOAT3 Extents;
+
+		BoundingBox() : Center(0, 0, 0), Extents(1.0f, 1.0f, 1.0f) {}
+		constexpr BoundingBox(const XMFLOAT3& center, const XMFLOAT3& extents) : Center(center), Extents(extents) {}
+
+		void GetCorners(XMFLOAT3* corners) const
+		{
+			for (size_t i = 0; i < CORNER_COUNT; ++i)
+			{
+				corners[i] = XMFLOAT3(Center.x + ((i & 1) ? Extents.x : -Extents.x),
+									  Center.y + ((i & 2) ? Extents.y : -Extents.y),
+									  Center.z + ((i & 4) ? Extents.z : -Extents.z));
+			}
+		}
+
+		void XM_CALLCONV Transform(BoundingBox& out, FXMMATRIX m) const
+		{
+			XMFLOAT3 corners[CORNER_COUNT];
+			GetCorners(corners);
+
+			XMVECTOR minPoint = g_XMFltMax;
+			XMVECTOR maxPoint = XMVectorNegate(g_XMFltMax);
+			for (const XMFLOAT3& corner : corners)
+			{
+				XMVECTOR point = XMVector3Transform(XMLoadFloat3(&corner), m);
+				minPoint = XMVectorMin(minPoint, point);
+				maxPoint = XMVectorMax(maxPoint, point);
+			}
+
+			XMStoreFloat3(&out.Center, XMVectorMultiply(XMVectorAdd(minPoint, maxPoint), g_XMOneHalf));
+			XMStoreFloat3(&out.Extents, XMVectorMultiply(XMVectorSubtract(maxPoint, minPoint), g_XMOneHalf));
+		}
+
+		bool Intersects(const BoundingBox& box) const
+		{
+			return std::fabs(Center.x - box.Center.x) <= Extents.x + box.Extents.x &&
+				std::fabs(Center.y - box.Center.y) <= Extents.y + box.Extents.y &&
+				std::fabs(Center.z - box.Center.z) <= Extents.z + box.Extents.z;
+		}
+
+		bool Intersects(const BoundingSphere& sphere) const
+		{
+			float distanceSq = 0.0f;
+			const float center[3] = { sphere.Center.x - Center.x, sphere.Center.y - Center.y, sphere.Center.z - Center.z };
+			const float extents[3] = { Extents.x, Extents.y, Extents.z };
+			for (int i = 0; i < 3; ++i)
+			{
+				float excess = std::max(std::fabs(center[i]) - extents[i], 0.0f);
+				distanceSq += excess * excess;
+			}
+			return distanceSq <= sphere.Radius * sphere.Radius;
+		}
+
+		static void CreateFromPoints(BoundingBox& out, size_t count, const XMFLOAT3* points, size_t stride)
+		{
+			XMVECTOR minPoint = g_XMFltMax;
+			XMVECTOR maxPoint = XMVectorNegate(g_XMFltMax);
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(points);
+			for (size_t i = 0; i < count; ++i)
+			{
+				XMVECTOR point = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(bytes + i * stride));
+				minPoint = XMVectorMin(minPoint, point);
+				maxPoint = XMVectorMax(maxPoint, point);
+			}
+
+			XMStoreFloat3(&out.Center, XMVectorMultiply(XMVectorAdd(minPoint, maxPoint), g_XMOneHalf));
+			XMStoreFloat3(&out.Extents, XMVectorMultiply(XMVectorSubtract(maxPoint, minPoint), g_XMOneHalf));
+		}
+
+		static void XM_CALLCONV CreateFromPoints(BoundingBox& out, FXMVECTOR point1, FXMVECTOR point2)
+		{
+			XMVECTOR minPoint = XMVectorMin(point1, point2);
+			XMVECTOR maxPoint = XMVectorMax(point1, point2);
+			XMStoreFloat3(&out.Center, XMVectorMultiply(XMVectorAdd(minPoint, maxPoint), g_XMOneHalf));
+			XMStoreFloat3(&out.Extents, XMVectorMultiply(XMVectorSubtract(maxPoint, minPoint), g_XMOneHalf));
+		}
+
+		static void CreateMerged(BoundingBox& out, const BoundingBox& a, const BoundingBox& b)
+		{
+			XMVECTOR centerA = XMLoadFloat3(&a.Center), extentsA = XMLoadFloat3(&a.Extents);
+			XMVECTOR centerB = XMLoadFloat3(&b.Center), extentsB = XMLoadFloat3(&b.Extents);
+			CreateFromPoints(out, XMVectorMin(XMVectorSubtract(centerA, extentsA), XMVectorSubtract(centerB, extentsB)),
+							 XMVectorMax(XMVectorAdd(centerA, extentsA), XMVectorAdd(centerB, extentsB)));
+		}
+	};
+
+	inline void BoundingSphere::CreateFromBoundingBox(BoundingSphere& out, const BoundingBox& box)
+	{
+		out.Center = box.Center;
+		out.Radius = std::sqrt(box.Extents.x * box.Extents.x + box.Extents.y * box.Extents.y + box.Extents.z * box.Extents.z);
+	}
+
+	struct BoundingFrustum
+	{
+		static const size_t CORNER_COUNT = 8;
+
+		XMFLOAT3 Origin;
+		XMFLOAT4 Orientation;
+
+		float RightSlope;
+		float LeftSlope;
+		float TopSlope;
+		float BottomSlope;
+		float Near, Far;
+
+		BoundingFrustum()
+			: Origin(0, 0, 0), Orientation(0, 0, 0, 1.0f), RightSlope(1.0f), LeftSlope(-1.0f), TopSlope(1.0f), BottomSlope(-1.0f), Near(0), Far(1.0f) {}
+
+		BoundingFrustum(CXMMATRIX projection)
+		{
+			CreateFromMatrix(*this, projection);
+		}
+
+		void GetCorners(XMFLOAT3* corners) const
+		{
+			const XMVECTOR localCorners[CORNER_COUNT] =
+			{
+				XMVectorSet(LeftSlope * Near, TopSlope * Near, Near, 0.0f),
+				XMVectorSet(RightSlope * Near, TopSlope * Near, Near, 0.0f),
+				XMVectorSet(RightSlope * Near, BottomSlope * Near, Near, 0.0f),
+				XMVectorSet(LeftSlope * Near, BottomSlope * Near, Near, 0.0f),
+				XMVectorSet(LeftSlope * Far, TopSlope * Far, Far, 0.0f),
+				XMVectorSet(RightSlope * Far, TopSlope * Far, Far, 0.0f),
+				XMVectorSet(RightSlope * Far, BottomSlope * Far, Far, 0.0f),
+				XMVectorSet(LeftSlope * Far, BottomSlope * Far, Far, 0.0f),
+			};
+
+			XMVECTOR orientation = XMLoadFloat4(&Orientation);
+			XMVECTOR origin = XMLoadFloat3(&Origin);
+			for (size_t i = 0; i < CORNER_COUNT; ++i)
+			{
+				XMStoreFloat3(&corners[i], XMVectorAdd(XMVector3Rotate(localCorners[i], orientation), origin));
+			}
+		}
+
+		void XM_CALLCONV Transform(BoundingFrustum& out, FXMMATRIX m) const
+		{
+			XMVECTOR scaleSq = XMVectorMax(XMVectorMax(XMVector3LengthSq(m.r[0]), XMVector3LengthSq(m.r[1])), XMVector3LengthSq(m.r[2]));
+			float scale = std::sqrt(XMVectorGetX(scaleSq));
+
+			XMMATRIX rotation(XMVectorScale(m.r[0], 1.0f / scale), XMVectorScale(m.r[1], 1.0f / scale), XMVectorScale(m.r[2], 1.0f / scale), g_XMIdentityR3);
+			XMVECTOR orientation = XMQuaternionMultiply(XMLoadFloat4(&Orientation), XMQuaternionRotationMatrix(rotation));
+			XMVECTOR origin = XMVector3Transform(XMLoadFloat3(&Origin), m);
+
+			XMStoreFloat3(&out.Origin, origin);
+			XMStoreFloat4(&out.Orientation, XMQuaternionNormalize(orientation));
+			out.RightSlope = RightSlope;
+			out.LeftSlope = LeftSlope;
+			out.TopSlope = TopSlope;
+			out.BottomSlope = BottomSlope;
+			out.Near = Near * scale;
+			out.Far = Far * scale;
+		}
+
+		bool Intersects(const BoundingBox& box) const
+		{
+			XMFLOAT3 frustumCorners[CORNER_COUNT];
+			XMFLOAT3 boxCorners[BoundingBox::CORNER_COUNT];
+			GetCorners(frustumCorners);
+			box.GetCorners(boxCorners);
+
+			auto separates = [&](XMVECTOR axis)
+			{
+				if (XMVectorGetX(XMVector3LengthSq(axis)) < 1e-12f)
+				{
+					return false;
+				}
+
+				float frustumMin = FLT_MAX, frustumMax = -FLT_MAX, boxMin = FLT_MAX, boxMax = -FLT_MAX;
+				for (size_t i = 0; i < CORNER_COUNT; ++i)
+				{
+					float frustumDistance = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&frustumCorners[i]), axis));
+					float boxDistance = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&boxCorners[i]), axis));
+					frustumMin = std::min(frustumMin, frustumDistance);
+					frustumMax = std::max(frustumMax, frustumDistance);
+					boxMin = std::min(boxMin, boxDistance);
+					boxMax = std::max(boxMax, boxDistance);
+				}
+				return frustumMax < boxMin || boxMax < frustumMin;
+			};
+
+			auto corner = [&](size_t i) { return XMLoadFloat3(&frustumCorners[i]); };
+			const XMVECTOR frustumEdges[6] =
+			{
+				XMVectorSubtract(corner(1), corner(0)),
+				XMVectorSubtract(corner(3), corner(0)),
+				XMVectorSubtract(corner(4), corner(0)),
+				XMVectorSubtract(corner(5), corner(1)),
+				XMVectorSubtract(corner(6), corner(2)),
+				XMVectorSubtract(corner(7), corner(3)),
+			};
+			const XMVECTOR frustumNormals[5] =
+			{
+				XMVector3Cross(frustumEdges[0], frustumEdges[1]),
+				XMVector3Cross(frustumEdges[2], frustumEdges[1]),
+				XMVector3Cross(frustumEdges[0], frustumEdges[3]),
+				XMVector3Cross(frustumEdges[4], frustumEdges[0]),
+				XMVector3Cross(frustumEdges[1], frustumEdges[3]),
+			};
+			const XMVECTOR boxAxes[3] = { g_XMIdentityR0, g_XMIdentityR1, g_XMIdentityR2 };
+
+			for (const XMVECTOR& axis : boxAxes)
+			{
+				if (separates(axis)) return false;
+			}
+			for (const XMVECTOR& normal : frustumNormals)
+			{
+				if (separates(normal)) return false;
+			}
+			for (const XMVECTOR& axis : boxAxes)
+			{
+				for (const XMVECTOR& edge : frustumEdges)
+				{
+					if (separates(XMVector3Cross(axis, edge))) return false;
+				}
+			}
+			return true;
+		}
+
+		static void XM_CALLCONV CreateFromMatrix(BoundingFrustum& out, FXMMATRIX projection, bool rhcoords = false)
+		{
+			static const XMVECTORF32 homogenousPoints[6] =
+			{
+				{ { {  1.0f,  0.0f, 1.0f, 1.0f } } },
+				{ { { -1.0f,  0.0f, 1.0f, 1.0f } } },
+				{ { {  0.0f,  1.0f, 1.0f, 1.0f } } },
+				{ { {  0.0f, -1.0f, 1.0f, 1.0f } } },
+				{ { {  0.0f,  0.0f, 0.0f, 1.0f } } },
+				{ { {  0.0f,  0.0f, 1.0f, 1.0f } } },
+			};
+
+			XMMATRIX inverse = XMMatrixInverse(nullptr, projection);
+			XMVECTOR points[6];
+			for (int i = 0; i < 6; ++i)
+			{
+				points[i] = XMVector4Transform(homogenousPoints[i], inverse);
+			}
+
+			out.Origin = XMFLOAT3(0.0f, 0.0f, 0.0f);
+			out.Orientation = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+
+			for (int i = 0; i < 4; ++i)
+			{
+				points[i] = XMVectorMultiply(points[i], XMVectorReciprocal(XMVectorSplatZ(points[i])));
+			}
+			out.RightSlope = XMVectorGetX(points[0]);
+			out.LeftSlope = XMVectorGetX(points[1]);
+			out.TopSlope = XMVectorGetY(points[2]);
+			out.BottomSlope = XMVectorGetY(points[3]);
+
+			points[4] = XMVectorMultiply(points[4], XMVectorReciprocal(XMVectorSplatW(points[4])));
+			points[5] = XMVectorMultiply(points[5], XMVectorReciprocal(XMVectorSplatW(points[5])));
+			if (rhcoords)
+			{
+				out.Near = -XMVectorGetZ(points[4]);
+				out.Far = -XMVectorGetZ(points[5]);
+			}
+			else
+			{
+				out.Near = XMVectorGetZ(points[4]);
+				out.Far = XMVectorGetZ(points[5]);
+			}
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,732 @@
+#ifndef __COMPAT_DIRECTXMATH_H_
+#define __COMPAT_DIRECTXMATH_H_
+
+// Subset of DirectXMath used by the Render sources under test, for hosts
+// without the Windows SDK. Semantics follow the SSE2 path of the SDK headers.
+
+#include <emmintrin.h>
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#define XM_CALLCONV
+#define XM_ALIGNED_STRUCT(x) struct alignas(x)
+
+namespace DirectX
+{
+	constexpr float XM_PI = 3.141592654f;
+	constexpr float XM_2PI = 6.283185307f;
+	constexpr float XM_1DIVPI = 0.318309886f;
+	constexpr float XM_1DIV2PI = 0.159154943f;
+	constexpr float XM_PIDIV2 = 1.570796327f;
+	constexpr float XM_PIDIV4 = 0.785398163f;
+
+	inline constexpr float XMConvertToRadians(float degrees) { return degrees * (XM_PI / 180.0f); }
+	inline constexpr float XMConvertToDegrees(float radians) { return radians * (180.0f / XM_PI); }
+
+	using XMVECTOR = __m128;
+	using FXMVECTOR = const XMVECTOR;
+	using GXMVECTOR = const XMVECTOR;
+	using HXMVECTOR = const XMVECTOR;
+	using CXMVECTOR = const XMVECTOR&;
+
+	struct XMMATRIX;
+	using FXMMATRIX = const XMMATRIX&;
+	using CXMMATRIX = const XMMATRIX&;
+
+	struct XMFLOAT2
+	{
+		float x, y;
+
+		XMFLOAT2() = default;
+		constexpr XMFLOAT2(float x, float y) : x(x), y(y) {}
+	};
+
+	struct XMFLOAT3
+	{
+		float x, y, z;
+
+		XMFLOAT3() = default;
+		constexpr XMFLOAT3(float x, float y, float z) : x(x), y(y), z(z) {}
+	};
+
+	struct XMFLOAT4
+	{
+		float x, y, z, w;
+
+		XMFLOAT4() = default;
+		constexpr XMFLOAT4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+	};
+
+	struct alignas(16) XMFLOAT4A : public XMFLOAT4
+	{
+		XMFLOAT4A() = default;
+		constexpr XMFLOAT4A(float x, float y, float z, float w) : XMFLOAT4(x, y, z, w) {}
+	};
+
+	struct XMUINT2
+	{
+		uint32_t x, y;
+
+		XMUINT2() = default;
+		constexpr XMUINT2(uint32_t x, uint32_t y) : x(x), y(y) {}
+	};
+
+	struct XMUINT3
+	{
+		uint32_t x, y, z;
+
+		XMUINT3() = default;
+		constexpr XMUINT3(uint32_t x, uint32_t y, uint32_t z) : x(x), y(y), z(z) {}
+	};
+
+	struct XMUINT4
+	{
+		uint32_t x, y, z, w;
+
+		XMUINT4() = default;
+		constexpr XMUINT4(uint32_t x, uint32_t y, uint32_t z, uint32_t w) : x(x), y(y), z(z), w(w) {}
+	};
+
+	struct XMFLOAT4X4
+	{
+		union
+		{
+			struct
+			{
+				float _11, _12, _13, _14;
+				float _21, _22, _23, _24;
+				float _31, _32, _33, _34;
+				float _41, _42, _43, _44;
+			};
+			float m[4][4];
+		};
+
+		XMFLOAT4X4() = default;
+		constexpr XMFLOAT4X4(float m00, float m01, float m02, float m03,
+							 float m10, float m11, float m12, float m13,
+							 float m20, float m21, float m22, float m23,
+							 float m30, float m31, float m32, float m33)
+			: _11(m00), _12(m01), _13(m02), _14(m03),
+			_21(m10), _22(m11), _23(m12), _24(m13),
+			_31(m20), _32(m21), _33(m22), _34(m23),
+			_41(m30), _42(m31), _43(m32), _44(m33) {}
+
+		float operator()(size_t row, size_t column) const { return m[row][column]; }
+		float& operator()(size_t row, size_t column) { return m[row][column]; }
+	};
+
+	struct alignas(16) XMVECTORF32
+	{
+		union
+		{
+			float f[4];
+			XMVECTOR v;
+		};
+
+		operator XMVECTOR() const { return v; }
+		operator const float*() const { return f; }
+	};
+
+	struct alignas(16) XMVECTORU32
+	{
+		union
+		{
+			uint32_t u[4];
+			XMVECTOR v;
+		};
+
+		operator XMVECTOR() const { return v; }
+	};
+
+	struct alignas(16) XMVECTORI32
+	{
+		union
+		{
+			int32_t i[4];
+			XMVECTOR v;
+		};
+
+		operator XMVECTOR() const { return v; }
+	};
+
+	struct alignas(16) XMMATRIX
+	{
+		XMVECTOR r[4];
+
+		XMMATRIX() = default;
+		XMMATRIX(FXMVECTOR r0, FXMVECTOR r1, FXMVECTOR r2, CXMVECTOR r3) : r{ r0, r1, r2, r3 } {}
+		XMMATRIX(float m00, float m01, float m02, float m03,
+				 float m10, float m11, float m12, float m13,
+				 float m20, float m21, float m22, float m23,
+				 float m30, float m31, float m32, float m33)
+			: r{ _mm_setr_ps(m00, m01, m02, m03), _mm_setr_ps(m10, m11, m12, m13), _mm_setr_ps(m20, m21, m22, m23), _mm_setr_ps(m30, m31, m32, m33) } {}
+
+		XMMATRIX& operator*=(FXMMATRIX other);
+		XMMATRIX operator*(FXMMATRIX other) const;
+	};
+
+	alignas(16) constexpr XMVECTORF32 g_XMZero = { { { 0.0f, 0.0f, 0.0f, 0.0f } } };
+	alignas(16) constexpr XMVECTORF32 g_XMOne = { { { 1.0f, 1.0f, 1.0f, 1.0f } } };
+	alignas(16) constexpr XMVECTORF32 g_XMNegativeOne = { { { -1.0f, -1.0f, -1.0f, -1.0f } } };
+	alignas(16) constexpr XMVECTORF32 g_XMOneHalf = { { { 0.5f, 0.5f, 0.5f, 0.5f } } };
+	alignas(16) constexpr XMVECTORF32 g_XMNegativeOneHalf = { { { -0.5f, -0.5f, -0.5f, -0.5f } } };
+	alignas(16) constexpr XMVECTORF32 g_XMIdentityR0 = { { { 1.0f, 0.0f, 0.0f, 0.0f } } };
+	alignas(16) constexpr XMVECTORF32 g_XMIdentityR1 = { { { 0.0f, 1.0f, 0.0f, 0.0f } } };
+	alignas(16) constexpr XMVECTORF32 g_XMIdentityR2 = { { { 0.0f, 0.0f, 1.0f, 0.0f } } };
+	alignas(16) constexpr XMVECTORF32 g_XMIdentityR3 = { { { 0.0f, 0.0f, 0.0f, 1.0f } } };
+	alignas(16) constexpr XMVECTORF32 g_XMFltMax = { { { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX } } };
+	alignas(16) constexpr XMVECTORU32 g_XMAbsMask = { { { 0x7fffffff, 0x7fffffff, 0x7fffffff, 0x7fffffff } } };
+	alignas(16) constexpr XMVECTORU32 g_XMSelect1110 = { { { 0xffffffff, 0xffffffff, 0xffffffff, 0 } } };
+
+	// Vector construction and access
+
+	inline XMVECTOR XM_CALLCONV XMVectorZero() { return _mm_setzero_ps(); }
+	inline XMVECTOR XM_CALLCONV XMVectorSet(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+	inline XMVECTOR XM_CALLCONV XMVectorReplicate(float value) { return _mm_set_ps1(value); }
+	inline XMVECTOR XM_CALLCONV XMVectorSplatOne() { return g_XMOne; }
+	inline XMVECTOR XM_CALLCONV XMVectorFalseInt() { return _mm_setzero_ps(); }
+	inline XMVECTOR XM_CALLCONV XMVectorTrueInt() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+
+	inline XMVECTOR XM_CALLCONV XMVectorSplatX(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)); }
+	inline XMVECTOR XM_CALLCONV XMVectorSplatY(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)); }
+	inline XMVECTOR XM_CALLCONV XMVectorSplatZ(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)); }
+	inline XMVECTOR XM_CALLCONV XMVectorSplatW(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+	inline float XM_CALLCONV XMVectorGetX(FXMVECTOR v) { return _mm_cvtss_f32(v); }
+	inline float XM_CALLCONV XMVectorGetY(FXMVECTOR v) { return _mm_cvtss_f32(XMVectorSplatY(v)); }
+	inline float XM_CALLCONV XMVectorGetZ(FXMVECTOR v) { return _mm_cvtss_f32(XMVectorSplatZ(v)); }
+	inline float XM_CALLCONV XMVectorGetW(FXMVECTOR v) { return _mm_cvtss_f32(XMVectorSplatW(v)); }
+
+	inline XMVECTOR XM_CALLCONV XMVectorSetW(FXMVECTOR v, float w)
+	{
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, v);
+		lanes[3] = w;
+		return _mm_load_ps(lanes);
+	}
+
+	// Loads and stores
+
+	inline XMVECTOR XM_CALLCONV XMLoadFloat2(const XMFLOAT2* source) { return _mm_setr_ps(source->x, source->y, 0.0f, 0.0f); }
+	inline XMVECTOR XM_CALLCONV XMLoadFloat3(const XMFLOAT3* source) { return _mm_setr_ps(source->x, source->y, source->z, 0.0f); }
+	inline XMVECTOR XM_CALLCONV XMLoadFloat4(const XMFLOAT4* source) { return _mm_loadu_ps(&source->x); }
+	inline XMVECTOR XM_CALLCONV XMLoadFloat4A(const XMFLOAT4A* source) { return _mm_load_ps(&source->x); }
+	inline XMVECTOR XM_CALLCONV XMLoadInt4(const uint32_t* source) { return _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source))); }
+	inline XMVECTOR XM_CALLCONV XMLoadUInt4(const XMUINT4* source) { return XMLoadInt4(&source->x); }
+
+	inline void XM_CALLCONV XMStoreFloat2(XMFLOAT2* destination, FXMVECTOR v)
+	{
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, v);
+		destination->x = lanes[0];
+		destination->y = lanes[1];
+	}
+
+	inline void XM_CALLCONV XMStoreFloat3(XMFLOAT3* destination, FXMVECTOR v)
+	{
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, v);
+		destination->x = lanes[0];
+		destination->y = lanes[1];
+		destination->z = lanes[2];
+	}
+
+	inline void XM_CALLCONV XMStoreFloat4(XMFLOAT4* destination, FXMVECTOR v) { _mm_storeu_ps(&destination->x, v); }
+	inline void XM_CALLCONV XMStoreFloat4A(XMFLOAT4A* destination, FXMVECTOR v) { _mm_store_ps(&destination->x, v); }
+	inline void XM_CALLCONV XMStoreInt4(uint32_t* destination, FXMVECTOR v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_castps_si128(v)); }
+	inline void XM_CALLCONV XMStoreUInt4(XMUINT4* destination, FXMVECTOR v) { XMStoreInt4(&destination->x, v); }
+
+	inline XMMATRIX XM_CALLCONV XMLoadFloat4x4(const XMFLOAT4X4* source)
+	{
+		return XMMATRIX(_mm_loadu_ps(source->m[0]), _mm_loadu_ps(source->m[1]), _mm_loadu_ps(source->m[2]), _mm_loadu_ps(source->m[3]));
+	}
+
+	inline void XM_CALLCONV XMStoreFloat4x4(XMFLOAT4X4* destination, FXMMATRIX m)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			_mm_storeu_ps(destination->m[i], m.r[i]);
+		}
+	}
+
+	// Arithmetic
+
+	inline XMVECTOR XM_CALLCONV XMVectorAdd(FXMVECTOR a, FXMVECTOR b) { return _mm_add_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorSubtract(FXMVECTOR a, FXMVECTOR b) { return _mm_sub_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorMultiply(FXMVECTOR a, FXMVECTOR b) { return _mm_mul_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorDivide(FXMVECTOR a, FXMVECTOR b) { return _mm_div_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorMultiplyAdd(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	inline XMVECTOR XM_CALLCONV XMVectorNegativeMultiplySubtract(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+	inline XMVECTOR XM_CALLCONV XMVectorScale(FXMVECTOR v, float scale) { return _mm_mul_ps(v, _mm_set_ps1(scale)); }
+	inline XMVECTOR XM_CALLCONV XMVectorNegate(FXMVECTOR v) { return _mm_sub_ps(_mm_setzero_ps(), v); }
+	inline XMVECTOR XM_CALLCONV XMVectorAbs(FXMVECTOR v) { return _mm_and_ps(v, g_XMAbsMask); }
+	inline XMVECTOR XM_CALLCONV XMVectorMin(FXMVECTOR a, FXMVECTOR b) { return _mm_min_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorMax(FXMVECTOR a, FXMVECTOR b) { return _mm_max_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorClamp(FXMVECTOR v, FXMVECTOR min, FXMVECTOR max) { return _mm_min_ps(_mm_max_ps(min, v), max); }
+	inline XMVECTOR XM_CALLCONV XMVectorSaturate(FXMVECTOR v) { return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), g_XMOne); }
+	inline XMVECTOR XM_CALLCONV XMVectorReciprocal(FXMVECTOR v) { return _mm_div_ps(g_XMOne, v); }
+	inline XMVECTOR XM_CALLCONV XMVectorSqrt(FXMVECTOR v) { return _mm_sqrt_ps(v); }
+	inline XMVECTOR XM_CALLCONV XMVectorReciprocalSqrt(FXMVECTOR v) { return _mm_div_ps(g_XMOne, _mm_sqrt_ps(v)); }
+
+	// Round half to even. Adding and subtracting 2^23 with the lane's sign leaves no fraction bits;
+	// lanes at or above 2^23 are already integral and pass through.
+	inline XMVECTOR XM_CALLCONV XMVectorRound(FXMVECTOR v)
+	{
+		XMVECTOR sign = _mm_andnot_ps(g_XMAbsMask, v);
+		XMVECTOR magic = _mm_or_ps(sign, _mm_set_ps1(8388608.0f));
+		XMVECTOR rounded = _mm_sub_ps(_mm_add_ps(v, magic), magic);
+		XMVECTOR inRange = _mm_cmple_ps(_mm_and_ps(v, g_XMAbsMask), _mm_set_ps1(8388608.0f));
+		return _mm_or_ps(_mm_and_ps(inRange, rounded), _mm_andnot_ps(inRange, v));
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorLerp(FXMVECTOR a, FXMVECTOR b, float t) { return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set_ps1(t))); }
+
+	// Comparison and bitwise selection
+
+	inline XMVECTOR XM_CALLCONV XMVectorEqual(FXMVECTOR a, FXMVECTOR b) { return _mm_cmpeq_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorLess(FXMVECTOR a, FXMVECTOR b) { return _mm_cmplt_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorLessOrEqual(FXMVECTOR a, FXMVECTOR b) { return _mm_cmple_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorGreater(FXMVECTOR a, FXMVECTOR b) { return _mm_cmpgt_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorGreaterOrEqual(FXMVECTOR a, FXMVECTOR b) { return _mm_cmpge_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorAndInt(FXMVECTOR a, FXMVECTOR b) { return _mm_and_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorAndCInt(FXMVECTOR a, FXMVECTOR b) { return _mm_andnot_ps(b, a); }
+	inline XMVECTOR XM_CALLCONV XMVectorOrInt(FXMVECTOR a, FXMVECTOR b) { return _mm_or_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorXorInt(FXMVECTOR a, FXMVECTOR b) { return _mm_xor_ps(a, b); }
+	inline XMVECTOR XM_CALLCONV XMVectorSelect(FXMVECTOR a, FXMVECTOR b, FXMVECTOR control) { return _mm_or_ps(_mm_andnot_ps(control, a), _mm_and_ps(b, control)); }
+
+	inline bool XM_CALLCONV XMVector4NearEqual(FXMVECTOR a, FXMVECTOR b, FXMVECTOR epsilon)
+	{
+		XMVECTOR delta = XMVectorAbs(_mm_sub_ps(a, b));
+		return _mm_movemask_ps(_mm_cmple_ps(delta, epsilon)) == 0xf;
+	}
+
+	inline bool XM_CALLCONV XMVector3NearEqual(FXMVECTOR a, FXMVECTOR b, FXMVECTOR epsilon)
+	{
+		XMVECTOR delta = XMVectorAbs(_mm_sub_ps(a, b));
+		return (_mm_movemask_ps(_mm_cmple_ps(delta, epsilon)) & 0x7) == 0x7;
+	}
+
+	inline bool XM_CALLCONV XMVector4Equal(FXMVECTOR a, FXMVECTOR b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)) == 0xf; }
+	inline bool XM_CALLCONV XMVector3Equal(FXMVECTOR a, FXMVECTOR b) { return (_mm_movemask_ps(_mm_cmpeq_ps(a, b)) & 0x7) == 0x7; }
+
+	// Trigonometry
+
+	inline void XMScalarSinCos(float* sine, float* cosine, float angle)
+	{
+		*sine = std::sin(angle);
+		*cosine = std::cos(angle);
+	}
+
+	inline void XM_CALLCONV XMVectorSinCos(XMVECTOR* sine, XMVECTOR* cosine, FXMVECTOR angle)
+	{
+		alignas(16) float lanes[4], sines[4], cosines[4];
+		_mm_store_ps(lanes, angle);
+		for (int i = 0; i < 4; ++i)
+		{
+			XMScalarSinCos(&sines[i], &cosines[i], lanes[i]);
+		}
+		*sine = _mm_load_ps(sines);
+		*cosine = _mm_load_ps(cosines);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorACos(FXMVECTOR v)
+	{
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, v);
+		for (float& lane : lanes)
+		{
+			lane = std::acos(lane);
+		}
+		return _mm_load_ps(lanes);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorATan2(FXMVECTOR y, FXMVECTOR x)
+	{
+		alignas(16) float ys[4], xs[4];
+		_mm_store_ps(ys, y);
+		_mm_store_ps(xs, x);
+		for (int i = 0; i < 4; ++i)
+		{
+			ys[i] = std::atan2(ys[i], xs[i]);
+		}
+		return _mm_load_ps(ys);
+	}
+
+	// 2D, 3D and 4D vector operations
+
+	inline XMVECTOR XM_CALLCONV XMVector3Dot(FXMVECTOR a, FXMVECTOR b)
+	{
+		XMVECTOR product = _mm_mul_ps(a, b);
+		XMVECTOR sum = _mm_add_ss(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1)));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 2, 2, 2)));
+		return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector4Dot(FXMVECTOR a, FXMVECTOR b)
+	{
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, _mm_mul_ps(a, b));
+		return _mm_set_ps1((lanes[0] + lanes[1]) + (lanes[2] + lanes[3]));
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector3Cross(FXMVECTOR a, FXMVECTOR b)
+	{
+		XMVECTOR aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+		XMVECTOR bZXY = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+		XMVECTOR aZXY = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+		XMVECTOR bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		return _mm_and_ps(_mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX)), g_XMSelect1110);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector3LengthSq(FXMVECTOR v) { return XMVector3Dot(v, v); }
+	inline XMVECTOR XM_CALLCONV XMVector3Length(FXMVECTOR v) { return _mm_sqrt_ps(XMVector3Dot(v, v)); }
+	inline XMVECTOR XM_CALLCONV XMVector4Length(FXMVECTOR v) { return _mm_sqrt_ps(XMVector4Dot(v, v)); }
+
+	inline XMVECTOR XM_CALLCONV XMVector3Normalize(FXMVECTOR v)
+	{
+		XMVECTOR length = XMVector3Length(v);
+		XMVECTOR result = _mm_div_ps(v, length);
+		return _mm_andnot_ps(_mm_cmpeq_ps(length, _mm_setzero_ps()), result);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector4Normalize(FXMVECTOR v)
+	{
+		XMVECTOR length = XMVector4Length(v);
+		XMVECTOR result = _mm_div_ps(v, length);
+		return _mm_andnot_ps(_mm_cmpeq_ps(length, _mm_setzero_ps()), result);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector3Transform(FXMVECTOR v, FXMMATRIX m)
+	{
+		XMVECTOR result = _mm_mul_ps(XMVectorSplatX(v), m.r[0]);
+		result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatY(v), m.r[1]));
+		result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatZ(v), m.r[2]));
+		return _mm_add_ps(result, m.r[3]);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector3TransformCoord(FXMVECTOR v, FXMMATRIX m)
+	{
+		XMVECTOR result = XMVector3Transform(v, m);
+		return _mm_div_ps(result, XMVectorSplatW(result));
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector3TransformNormal(FXMVECTOR v, FXMMATRIX m)
+	{
+		XMVECTOR result = _mm_mul_ps(XMVectorSplatX(v), m.r[0]);
+		result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatY(v), m.r[1]));
+		return _mm_add_ps(result, _mm_mul_ps(XMVectorSplatZ(v), m.r[2]));
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector4Transform(FXMVECTOR v, FXMMATRIX m)
+	{
+		XMVECTOR result = XMVector3TransformNormal(v, m);
+		return _mm_add_ps(result, _mm_mul_ps(XMVectorSplatW(v), m.r[3]));
+	}
+
+	inline XMVECTOR XM_CALLCONV XMPlaneNormalize(FXMVECTOR plane)
+	{
+		XMVECTOR length = XMVector3Length(plane);
+		return _mm_div_ps(plane, length);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMPlaneDotCoord(FXMVECTOR plane, FXMVECTOR point)
+	{
+		return XMVector4Dot(plane, XMVectorSelect(g_XMOne, point, g_XMSelect1110));
+	}
+
+	// Quaternions
+
+	inline XMVECTOR XM_CALLCONV XMQuaternionIdentity() { return g_XMIdentityR3; }
+
+	inline XMVECTOR XM_CALLCONV XMQuaternionMultiply(FXMVECTOR q1, FXMVECTOR q2)
+	{
+		alignas(16) float a[4], b[4];
+		_mm_store_ps(a, q1);
+		_mm_store_ps(b, q2);
+		// Result represents the rotation q1 followed by q2
+		return XMVectorSet(
+			b[3] * a[0] + b[0] * a[3] + b[1] * a[2] - b[2] * a[1],
+			b[3] * a[1] - b[0] * a[2] + b[1] * a[3] + b[2] * a[0],
+			b[3] * a[2] + b[0] * a[1] - b[1] * a[0] + b[2] * a[3],
+			b[3] * a[3] - b[0] * a[0] - b[1] * a[1] - b[2] * a[2]);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMQuaternionConjugate(FXMVECTOR q)
+	{
+		return _mm_mul_ps(q, XMVectorSet(-1.0f, -1.0f, -1.0f, 1.0f));
+	}
+
+	inline XMVECTOR XM_CALLCONV XMQuaternionNormalize(FXMVECTOR q) { return XMVector4Normalize(q); }
+
+	inline XMVECTOR XM_CALLCONV XMQuaternionRotationRollPitchYaw(float pitch, float yaw, float roll)
+	{
+		float sp, cp, sy, cy, sr, cr;
+		XMScalarSinCos(&sp, &cp, pitch * 0.5f);
+		XMScalarSinCos(&sy, &cy, yaw * 0.5f);
+		XMScalarSinCos(&sr, &cr, roll * 0.5f);
+		return XMVectorSet(
+			cr * sp * cy + sr * cp * sy,
+			cr * cp * sy - sr * sp * cy,
+			sr * cp * cy - cr * sp * sy,
+			cr * cp * cy + sr * sp * sy);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMQuaternionRotationAxis(FXMVECTOR axis, float angle)
+	{
+		float sine, cosine;
+		XMScalarSinCos(&sine, &cosine, angle * 0.5f);
+		return XMVectorSetW(_mm_mul_ps(XMVector3Normalize(axis), _mm_set_ps1(sine)), cosine);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector3Rotate(FXMVECTOR v, FXMVECTOR rotation)
+	{
+		XMVECTOR a = _mm_and_ps(v, g_XMSelect1110);
+		XMVECTOR result = XMQuaternionMultiply(XMQuaternionConjugate(rotation), a);
+		return XMQuaternionMultiply(result, rotation);
+	}
+
+	// Matrices
+
+	inline XMMATRIX XM_CALLCONV XMMatrixIdentity()
+	{
+		return XMMATRIX(g_XMIdentityR0, g_XMIdentityR1, g_XMIdentityR2, g_XMIdentityR3);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixMultiply(FXMMATRIX a, CXMMATRIX b)
+	{
+		XMMATRIX result;
+		for (int i = 0; i < 4; ++i)
+		{
+			XMVECTOR row = _mm_mul_ps(XMVectorSplatX(a.r[i]), b.r[0]);
+			row = _mm_add_ps(row, _mm_mul_ps(XMVectorSplatY(a.r[i]), b.r[1]));
+			row = _mm_add_ps(row, _mm_mul_ps(XMVectorSplatZ(a.r[i]), b.r[2]));
+			row = _mm_add_ps(row, _mm_mul_ps(XMVectorSplatW(a.r[i]), b.r[3]));
+			result.r[i] = row;
+		}
+		return result;
+	}
+
+	inline XMMATRIX& XMMATRIX::operator*=(FXMMATRIX other)
+	{
+		*this = XMMatrixMultiply(*this, other);
+		return *this;
+	}
+
+	inline XMMATRIX XMMATRIX::operator*(FXMMATRIX other) const
+	{
+		return XMMatrixMultiply(*this, other);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixTranspose(FXMMATRIX m)
+	{
+		XMMATRIX result = m;
+		_MM_TRANSPOSE4_PS(result.r[0], result.r[1], result.r[2], result.r[3]);
+		return result;
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixTranslation(float x, float y, float z)
+	{
+		return XMMATRIX(g_XMIdentityR0, g_XMIdentityR1, g_XMIdentityR2, XMVectorSet(x, y, z, 1.0f));
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixTranslationFromVector(FXMVECTOR offset)
+	{
+		return XMMATRIX(g_XMIdentityR0, g_XMIdentityR1, g_XMIdentityR2, XMVectorSetW(offset, 1.0f));
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixScaling(float x, float y, float z)
+	{
+		return XMMATRIX(XMVectorSet(x, 0.0f, 0.0f, 0.0f), XMVectorSet(0.0f, y, 0.0f, 0.0f), XMVectorSet(0.0f, 0.0f, z, 0.0f), g_XMIdentityR3);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixScalingFromVector(FXMVECTOR scale)
+	{
+		return XMMatrixScaling(XMVectorGetX(scale), XMVectorGetY(scale), XMVectorGetZ(scale));
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixRotationQuaternion(FXMVECTOR q)
+	{
+		alignas(16) float v[4];
+		_mm_store_ps(v, q);
+		float x = v[0], y = v[1], z = v[2], w = v[3];
+		return XMMATRIX(
+			1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f,
+			2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f,
+			2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMQuaternionRotationMatrix(FXMMATRIX m)
+	{
+		XMFLOAT4X4 a;
+		XMStoreFloat4x4(&a, m);
+		float trace = a._11 + a._22 + a._33;
+		if (trace > 0.0f)
+		{
+			float s = std::sqrt(trace + 1.0f) * 2.0f;
+			return XMVectorSet((a._23 - a._32) / s, (a._31 - a._13) / s, (a._12 - a._21) / s, 0.25f * s);
+		}
+		if (a._11 > a._22 && a._11 > a._33)
+		{
+			float s = std::sqrt(1.0f + a._11 - a._22 - a._33) * 2.0f;
+			return XMVectorSet(0.25f * s, (a._12 + a._21) / s, (a._13 + a._31) / s, (a._23 - a._32) / s);
+		}
+		if (a._22 > a._33)
+		{
+			float s = std::sqrt(1.0f + a._22 - a._11 - a._33) * 2.0f;
+			return XMVectorSet((a._12 + a._21) / s, 0.25f * s, (a._23 + a._32) / s, (a._31 - a._13) / s);
+		}
+		float s = std::sqrt(1.0f + a._33 - a._11 - a._22) * 2.0f;
+		return XMVectorSet((a._13 + a._31) / s, (a._23 + a._32) / s, 0.25f * s, (a._12 - a._21) / s);
+	}
+
+	// Rows are the scaled basis vectors; a mirrored basis folds its sign into the x scale.
+	inline bool XM_CALLCONV XMMatrixDecompose(XMVECTOR* outScale, XMVECTOR* outRotQuat, XMVECTOR* outTrans, FXMMATRIX m)
+	{
+		float sx = XMVectorGetX(XMVector3Length(m.r[0]));
+		float sy = XMVectorGetX(XMVector3Length(m.r[1]));
+		float sz = XMVectorGetX(XMVector3Length(m.r[2]));
+		if (sx < 1e-6f || sy < 1e-6f || sz < 1e-6f)
+		{
+			return false;
+		}
+		if (XMVectorGetX(XMVector3Dot(XMVector3Cross(m.r[0], m.r[1]), m.r[2])) < 0.0f)
+		{
+			sx = -sx;
+		}
+
+		XMMATRIX rotation(XMVectorSetW(_mm_div_ps(m.r[0], _mm_set_ps1(sx)), 0.0f), XMVectorSetW(_mm_div_ps(m.r[1], _mm_set_ps1(sy)), 0.0f),
+			XMVectorSetW(_mm_div_ps(m.r[2], _mm_set_ps1(sz)), 0.0f), g_XMIdentityR3);
+		*outScale = XMVectorSet(sx, sy, sz, 0.0f);
+		*outRotQuat = XMQuaternionRotationMatrix(rotation);
+		*outTrans = XMVectorSetW(m.r[3], 0.0f);
+		return true;
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixRotationRollPitchYaw(float pitch, float yaw, float roll)
+	{
+		return XMMatrixRotationQuaternion(XMQuaternionRotationRollPitchYaw(pitch, yaw, roll));
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixRotationAxis(FXMVECTOR axis, float angle)
+	{
+		return XMMatrixRotationQuaternion(XMQuaternionRotationAxis(axis, angle));
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixRotationX(float angle)
+	{
+		float sine, cosine;
+		XMScalarSinCos(&sine, &cosine, angle);
+		return XMMATRIX(1, 0, 0, 0, 0, cosine, sine, 0, 0, -sine, cosine, 0, 0, 0, 0, 1);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixRotationY(float angle)
+	{
+		float sine, cosine;
+		XMScalarSinCos(&sine, &cosine, angle);
+		return XMMATRIX(cosine, 0, -sine, 0, 0, 1, 0, 0, sine, 0, cosine, 0, 0, 0, 0, 1);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixRotationZ(float angle)
+	{
+		float sine, cosine;
+		XMScalarSinCos(&sine, &cosine, angle);
+		return XMMATRIX(cosine, sine, 0, 0, -sine, cosine, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixAffineTransformation(FXMVECTOR scaling, FXMVECTOR rotationOrigin, FXMVECTOR rotationQuaternion, GXMVECTOR translation)
+	{
+		XMMATRIX result = XMMatrixMultiply(XMMatrixScalingFromVector(scaling), XMMatrixTranslationFromVector(XMVectorNegate(rotationOrigin)));
+		result = XMMatrixMultiply(result, XMMatrixRotationQuaternion(rotationQuaternion));
+		return XMMatrixMultiply(result, XMMatrixTranslationFromVector(_mm_add_ps(rotationOrigin, translation)));
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixLookToLH(FXMVECTOR eyePosition, FXMVECTOR eyeDirection, FXMVECTOR upDirection)
+	{
+		XMVECTOR r2 = XMVector3Normalize(eyeDirection);
+		XMVECTOR r0 = XMVector3Normalize(XMVector3Cross(upDirection, r2));
+		XMVECTOR r1 = XMVector3Cross(r2, r0);
+		XMVECTOR negEye = XMVectorNegate(eyePosition);
+
+		XMMATRIX m(XMVectorSetW(r0, XMVectorGetX(XMVector3Dot(r0, negEye))),
+				   XMVectorSetW(r1, XMVectorGetX(XMVector3Dot(r1, negEye))),
+				   XMVectorSetW(r2, XMVectorGetX(XMVector3Dot(r2, negEye))),
+				   g_XMIdentityR3);
+		return XMMatrixTranspose(m);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixLookAtLH(FXMVECTOR eyePosition, FXMVECTOR focusPosition, FXMVECTOR upDirection)
+	{
+		return XMMatrixLookToLH(eyePosition, _mm_sub_ps(focusPosition, eyePosition), upDirection);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+	{
+		float sine, cosine;
+		XMScalarSinCos(&sine, &cosine, 0.5f * fovAngleY);
+		float height = cosine / sine;
+		float width = height / aspectRatio;
+		float range = farZ / (farZ - nearZ);
+		return XMMATRIX(width, 0, 0, 0, 0, height, 0, 0, 0, 0, range, 1.0f, 0, 0, -range * nearZ, 0);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixOrthographicLH(float viewWidth, float viewHeight, float nearZ, float farZ)
+	{
+		float range = 1.0f / (farZ - nearZ);
+		return XMMATRIX(2.0f / viewWidth, 0, 0, 0, 0, 2.0f / viewHeight, 0, 0, 0, 0, range, 0, 0, 0, -range * nearZ, 1.0f);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMMatrixDeterminant(FXMMATRIX m)
+	{
+		XMFLOAT4X4 a;
+		XMStoreFloat4x4(&a, m);
+		float s0 = a._11 * a._22 - a._21 * a._12, s1 = a._11 * a._23 - a._21 * a._13, s2 = a._11 * a._24 - a._21 * a._14;
+		float s3 = a._12 * a._23 - a._22 * a._13, s4 = a._12 * a._24 - a._22 * a._14, s5 = a._13 * a._24 - a._23 * a._14;
+		float c5 = a._33 * a._44 - a._43 * a._34, c4 = a._32 * a._44 - a._42 * a._34, c3 = a._32 * a._43 - a._42 * a._33;
+		float c2 = a._31 * a._44 - a._41 * a._34, c1 = a._31 * a._43 - a._41 * a._33, c0 = a._31 * a._42 - a._41 * a._32;
+		return _mm_set_ps1(s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixInverse(XMVECTOR* determinant, FXMMATRIX m)
+	{
+		XMFLOAT4X4 a;
+		XMStoreFloat4x4(&a, m);
+		float s0 = a._11 * a._22 - a._21 * a._12, s1 = a._11 * a._23 - a._21 * a._13, s2 = a._11 * a._24 - a._21 * a._14;
+		float s3 = a._12 * a._23 - a._22 * a._13, s4 = a._12 * a._24 - a._22 * a._14, s5 = a._13 * a._24 - a._23 * a._14;
+		float c5 = a._33 * a._44 - a._43 * a._34, c4 = a._32 * a._44 - a._42 * a._34, c3 = a._32 * a._43 - a._42 * a._33;
+		float c2 = a._31 * a._44 - a._41 * a._34, c1 = a._31 * a._43 - a._41 * a._33, c0 = a._31 * a._42 - a._41 * a._32;
+
+		float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		if (determinant)
+		{
+			*determinant = _mm_set_ps1(det);
+		}
+
+		float inv = 1.0f / det;
+		return XMMATRIX(
+			(a._22 * c5 - a._23 * c4 + a._24 * c3) * inv,
+			(-a._12 * c5 + a._13 * c4 - a._14 * c3) * inv,
+			(a._42 * s5 - a._43 * s4 + a._44 * s3) * inv,
+			(-a._32 * s5 + a._33 * s4 - a._34 * s3) * inv,
+
+			(-a._21 * c5 + a._23 * c2 - a._24 * c1) * inv,
+			(a._11 * c5 - a._13 * c2 + a._14 * c1) * inv,
+			(-a._41 * s5 + a._43 * s2 - a._44 * s1) * inv,
+			(a._31 * s5 - a._33 * s2 + a._34 * s1) * inv,
+
+			(a._21 * c4 - a._22 * c2 + a._24 * c0) * inv,
+			(-a._11 * c4 + a._12 * c2 - a._14 * c0) * inv,
+			(a._41 * s4 - a._42 * s2 + a._44 * s0) * inv,
+			(-a._31 * s4 + a._32 * s2 - a._34 * s0) * inv,
+
+			(-a._21 * c3 + a._22 * c1 - a._23 * c0) * inv,
+			(a._11 * c3 - a._12 * c1 + a._13 * c0) * inv,
+			(-a._41 * s3 + a._42 * s1 - a._43 * s0) * inv,
+			(a._31 * s3 - a._32 * s1 + a._33 * s0) * inv);
+	}
+}
+
+#endif
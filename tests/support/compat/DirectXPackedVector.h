@@ -0,0 +1,111 @@
+#ifndef __COMPAT_DIRECTXPACKEDVECTOR_H_
+#define __COMPAT_DIRECTXPACKEDVECTOR_H_
+
+// Subset of DirectXPackedVector used by the Render sources under test, for hosts
+// without the Windows SDK. Half conversions follow the SDK's scalar path: round
+// to nearest even, overflow to infinity, NaN kept as NaN.
+
+#include "DirectXMath.h"
+
+namespace DirectX
+{
+	namespace PackedVector
+	{
+		using HALF = uint16_t;
+
+		struct XMHALF4
+		{
+			HALF x, y, z, w;
+
+			XMHALF4() = default;
+			constexpr XMHALF4(HALF x, HALF y, HALF z, HALF w) : x(x), y(y), z(z), w(w) {}
+		};
+
+		inline float XMConvertHalfToFloat(HALF value)
+		{
+			uint32_t mantissa = value & 0x03FFu;
+			uint32_t exponent = value & 0x7C00u;
+			if (exponent == 0x7C00u)
+			{
+				// Infinity or NaN.
+				exponent = 0x8Fu;
+			}
+			else if (exponent != 0)
+			{
+				exponent = (value >> 10) & 0x1Fu;
+			}
+			else if (mantissa != 0)
+			{
+				// Denormal: renormalize the mantissa.
+				exponent = 1;
+				do
+				{
+					--exponent;
+					mantissa <<= 1;
+				} while ((mantissa & 0x0400u) == 0);
+				mantissa &= 0x03FFu;
+			}
+			else
+			{
+				exponent = static_cast<uint32_t>(-112);
+			}
+
+			uint32_t bits = ((value & 0x8000u) << 16) | ((exponent + 112) << 23) | (mantissa << 13);
+			float result;
+			memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+
+		inline HALF XMConvertFloatToHalf(float value)
+		{
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			uint32_t sign = (bits & 0x80000000u) >> 16;
+			bits &= 0x7FFFFFFFu;
+
+			uint32_t result;
+			if (bits >= 0x47800000u)
+			{
+				// Too large for a half: infinity, or NaN with the top mantissa bits kept.
+				result = 0x7C00u | (bits > 0x7F800000u ? (0x200u | ((bits >> 13) & 0x3FFu)) : 0u);
+			}
+			else if (bits <= 0x33000000u)
+			{
+				result = 0;
+			}
+			else if (bits < 0x38800000u)
+			{
+				// Too small for a normalized half: denormalize.
+				uint32_t shift = 125u - (bits >> 23);
+				bits = 0x800000u | (bits & 0x7FFFFFu);
+				result = bits >> (shift + 1);
+				uint32_t sticky = (bits & ((1u << shift) - 1)) != 0;
+				result += (result | sticky) & ((bits >> shift) & 1u);
+			}
+			else
+			{
+				// Rebias the exponent.
+				bits += 0xC8000000u;
+				result = ((bits + 0x0FFFu + ((bits >> 13) & 1u)) >> 13) & 0x7FFFu;
+			}
+			return static_cast<HALF>(result | sign);
+		}
+
+		inline XMVECTOR XM_CALLCONV XMLoadHalf4(const XMHALF4* source)
+		{
+			return XMVectorSet(XMConvertHalfToFloat(source->x), XMConvertHalfToFloat(source->y), XMConvertHalfToFloat(source->z), XMConvertHalfToFloat(source->w));
+		}
+
+		inline void XM_CALLCONV XMStoreHalf4(XMHALF4* destination, FXMVECTOR v)
+		{
+			alignas(16) float lanes[4];
+			_mm_store_ps(lanes, v);
+			destination->x = XMConvertFloatToHalf(lanes[0]);
+			destination->y = XMConvertFloatToHalf(lanes[1]);
+			destination->z = XMConvertFloatToHalf(lanes[2]);
+			destination->w = XMConvertFloatToHalf(lanes[3]);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef __APPLICATION_H_
+#define __APPLICATION_H_
+
+#include "Core.h"
+#include "TestDevice.h"
+
+// Searched on the include path rather than next to this file, so a target that copies the real
+// Render/GeometryArena.h gets it instead of the double.
+#include <GeometryArena.h>
+
+// Test double for Render/Application.h: a process-wide TestDevice and geometry arena, no window or queues.
+class Application
+{
+public:
+	static Application& Get()
+	{
+		static Application application;
+		return application;
+	}
+
+	ComPtr<ID3D12Device2> GetDevice() const
+	{
+		return mDevice;
+	}
+
+	TestDevice& GetTestDevice() const
+	{
+		return *static_cast<TestDevice*>(mDevice.Get());
+	}
+
+	GeometryArena& GetGeometryArena()
+	{
+		return mGeometryArena;
+	}
+
+	static uint64_t GetFrameCount()
+	{
+		return msFrameCount;
+	}
+
+	// Tests step the frame counter by hand; the real one advances once per rendered frame.
+	static void SetFrameCount(uint64_t frameCount)
+	{
+		msFrameCount = frameCount;
+	}
+
+private:
+	Application()
+	{
+		mDevice.Attach(new TestDevice());
+	}
+
+	ComPtr<ID3D12Device2> mDevice;
+	GeometryArena mGeometryArena;
+
+	static inline uint64_t msFrameCount = 0;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef __BUFFER_H_
+#define __BUFFER_H_
+
+#include "Core.h"
+#include "Resource.h"
+
+// Test double for Render/Buffer.h: a resource that remembers its element layout and keeps a
+// CPU copy of whatever the CommandList double uploaded or copied into it.
+class Buffer : public Resource
+{
+public:
+	explicit Buffer(const std::wstring& name = L"") : Resource(name), mElementNum(0), mElementSize(0) {}
+
+	virtual void CreateViews(size_t numElements, size_t elementSize)
+	{
+		mElementNum = numElements;
+		mElementSize = elementSize;
+	}
+
+	std::vector<uint8_t>& GetData()
+	{
+		return mData;
+	}
+
+	const std::vector<uint8_t>& GetData() const
+	{
+		return mData;
+	}
+
+protected:
+	size_t mElementNum;
+	size_t mElementSize;
+	std::vector<uint8_t> mData;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef __BYTEADDRESSBUFFER_H_
+#define __BYTEADDRESSBUFFER_H_
+
+#include "Core.h"
+#include "Buffer.h"
+
+// Test double for Render/ByteAddressBuffer.h.
+class ByteAddressBuffer : public Buffer
+{
+public:
+	ByteAddressBuffer(const std::wstring& name = L"") : Buffer(name) {}
+
+	size_t GetBufferSize() const
+	{
+		return mElementNum * mElementSize;
+	}
+};
+
+#endif
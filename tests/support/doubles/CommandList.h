@@ -0,0 +1,235 @@
+#ifndef __COMMANDLIST_H_
+#define __COMMANDLIST_H_
+
+#include "Core.h"
+#include "Buffer.h"
+#include "ByteAddressBuffer.h"
+#include "IndexBuffer.h"
+#include "Resource.h"
+#include "StructuredBuffer.h"
+#include "UploadBuffer.h"
+#include "VertexBuffer.h"
+
+class CommandSignature;
+class RootSignature;
+
+// Test double for Render/CommandList.h. Every call is appended to a log so tests
+// can check what a Render class recorded, in order.
+class CommandList
+{
+public:
+	struct Call
+	{
+		std::string Name;
+		ID3D12Resource* Resource;
+		D3D12_RESOURCE_STATES State;
+		std::vector<uint64_t> Arguments;
+	};
+
+	void TransitionBarrier(const Resource& resource, D3D12_RESOURCE_STATES stateAfter, UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, bool flushBarriers = false)
+	{
+		Record("TransitionBarrier", resource.GetD3D12Resource().Get(), stateAfter);
+	}
+
+	void UAVBarrier(const Resource& resource, bool flushBarriers = false)
+	{
+		Record("UAVBarrier", resource.GetD3D12Resource().Get());
+	}
+
+	void AliasingBarrier(ComPtr<ID3D12Resource> beforeResource, ComPtr<ID3D12Resource> afterResource, bool flushBarriers = false)
+	{
+		Record("AliasingBarrier", afterResource.Get());
+	}
+
+	UploadBuffer::BasePointer AllocateDynamicBuffer(size_t sizeInBytes, size_t alignment)
+	{
+		UploadBuffer::BasePointer allocation = mUploadBuffer.Allocate(sizeInBytes, alignment);
+		mDynamicAllocations.push_back({ allocation, sizeInBytes });
+		Record("AllocateDynamicBuffer", allocation.Resource, D3D12_RESOURCE_STATE_GENERIC_READ, { sizeInBytes, allocation.GPUAddress });
+		return allocation;
+	}
+
+	void CopyBufferRegion(Buffer& dstBuffer, size_t dstOffset, const Buffer& srcBuffer, size_t srcOffset, size_t numBytes)
+	{
+		assert(dstOffset + numBytes <= dstBuffer.GetData().size() && srcOffset + numBytes <= srcBuffer.GetData().size());
+		memcpy(dstBuffer.GetData().data() + dstOffset, srcBuffer.GetData().data() + srcOffset, numBytes);
+		Record("CopyBufferRegion", nullptr, D3D12_RESOURCE_STATE_COPY_DEST, { dstOffset, srcOffset, numBytes });
+	}
+
+	void UpdateBufferRegion(Buffer& buffer, size_t offset, size_t numBytes, const void* bufferData)
+	{
+		assert(offset + numBytes <= buffer.GetData().size());
+		memcpy(buffer.GetData().data() + offset, bufferData, numBytes);
+		Record("UpdateBufferRegion", nullptr, D3D12_RESOURCE_STATE_COPY_DEST, { offset, numBytes });
+	}
+
+	void CopyVertexBuffer(VertexBuffer& vertexBuffer, size_t numVertices, size_t vertexStride, const void* vertexBufferData)
+	{
+		CopyBuffer(vertexBuffer, numVertices, vertexStride, vertexBufferData);
+		Record("CopyVertexBuffer", nullptr, D3D12_RESOURCE_STATE_COMMON, { numVertices, vertexStride });
+	}
+
+	void CopyIndexBuffer(IndexBuffer& indexBuffer, size_t numIndicies, DXGI_FORMAT indexFormat, const void* indexBufferData)
+	{
+		CopyBuffer(indexBuffer, numIndicies, indexFormat == DXGI_FORMAT_R16_UINT ? 2 : 4, indexBufferData);
+		Record("CopyIndexBuffer", nullptr, D3D12_RESOURCE_STATE_COMMON, { numIndicies, static_cast<uint64_t>(indexFormat) });
+	}
+
+	void CopyByteAddressBuffer(ByteAddressBuffer& byteAddressBuffer, size_t bufferSize, const void* bufferData)
+	{
+		byteAddressBuffer.CreateViews(1, bufferSize);
+		Record("CopyByteAddressBuffer", nullptr, D3D12_RESOURCE_STATE_COMMON, { bufferSize });
+	}
+
+	void CopyStructuredBuffer(StructuredBuffer& structuredBuffer, size_t numElements, size_t elementSize, const void* bufferData)
+	{
+		structuredBuffer.CreateViews(numElements, elementSize);
+		Record("CopyStructuredBuffer", nullptr, D3D12_RESOURCE_STATE_COMMON, { numElements, elementSize });
+	}
+
+	template<typename T>
+	void CopyStructuredBuffer(StructuredBuffer& structuredBuffer, const std::vector<T>& bufferData)
+	{
+		CopyStructuredBuffer(structuredBuffer, bufferData.size(), sizeof(T), bufferData.data());
+	}
+
+	void CullIndirectCommands(D3D12_GPU_VIRTUAL_ADDRESS commands, D3D12_GPU_VIRTUAL_ADDRESS cullItems, uint32_t commandCount, uint32_t batchCount,
+							  const DirectX::XMFLOAT4 frustumPlanes[6], Buffer& culledCommands, Buffer& batchCounters)
+	{
+		Record("CullIndirectCommands", nullptr, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, { commands, cullItems, commandCount, batchCount });
+	}
+
+	void SetGraphics32BitConstants(uint32_t rootParameterIndex, uint32_t numConstants, const void* constants)
+	{
+		std::vector<uint64_t> arguments = { rootParameterIndex };
+		for (uint32_t i = 0; i < numConstants; ++i)
+		{
+			arguments.push_back(static_cast<const uint32_t*>(constants)[i]);
+		}
+		Record("SetGraphics32BitConstants", nullptr, D3D12_RESOURCE_STATE_COMMON, std::move(arguments));
+	}
+
+	template<typename T>
+	void SetGraphics32BitConstants(uint32_t rootParameterIndex, const T& constants)
+	{
+		static_assert(sizeof(T) % sizeof(uint32_t) == 0, "Size of type must be a multiple of 4 bytes");
+		SetGraphics32BitConstants(rootParameterIndex, sizeof(T) / sizeof(uint32_t), &constants);
+	}
+
+	void SetGraphicsRootSignature(const RootSignature& rootSignature)
+	{
+		Record("SetGraphicsRootSignature", nullptr, D3D12_RESOURCE_STATE_COMMON, { reinterpret_cast<uint64_t>(&rootSignature) });
+	}
+
+	void SetGraphicsRootShaderResourceView(uint32_t rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS bufferLocation)
+	{
+		Record("SetGraphicsRootShaderResourceView", nullptr, D3D12_RESOURCE_STATE_COMMON, { rootParameterIndex, bufferLocation });
+	}
+
+	void SetPipelineState(ComPtr<ID3D12PipelineState> pipelineState)
+	{
+		Record("SetPipelineState", nullptr, D3D12_RESOURCE_STATE_COMMON, { reinterpret_cast<uint64_t>(pipelineState.Get()) });
+	}
+
+	void SetShaderResourceView(uint32_t rootParameterIndex, uint32_t descriptorOffset, const Resource& resource,
+							   D3D12_RESOURCE_STATES stateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE)
+	{
+		Record("SetShaderResourceView", resource.GetD3D12Resource().Get(), stateAfter, { rootParameterIndex, descriptorOffset, reinterpret_cast<uint64_t>(&resource) });
+	}
+
+	void SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY primitiveTopology)
+	{
+		Record("SetPrimitiveTopology", nullptr, D3D12_RESOURCE_STATE_COMMON, { static_cast<uint64_t>(primitiveTopology) });
+	}
+
+	void SetVertexBuffer(uint32_t slot, const VertexBuffer& vertexBuffer)
+	{
+		Record("SetVertexBuffer", nullptr, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, { slot, reinterpret_cast<uint64_t>(&vertexBuffer) });
+	}
+
+	void SetIndexBuffer(const IndexBuffer& indexBuffer)
+	{
+		Record("SetIndexBuffer", nullptr, D3D12_RESOURCE_STATE_INDEX_BUFFER, { reinterpret_cast<uint64_t>(&indexBuffer) });
+	}
+
+	void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t startIndex = 0, int32_t baseVertex = 0, uint32_t startInstance = 0)
+	{
+		Record("DrawIndexed", nullptr, D3D12_RESOURCE_STATE_COMMON, { indexCount, instanceCount, startIndex, static_cast<uint64_t>(baseVertex), startInstance });
+	}
+
+	void ExecuteIndirect(const CommandSignature& commandSignature, uint32_t maxCommandCount, const UploadBuffer::BasePointer& arguments, uint64_t argumentOffset = 0)
+	{
+		Record("ExecuteIndirect", arguments.Resource, D3D12_RESOURCE_STATE_GENERIC_READ, { maxCommandCount, arguments.GPUAddress + argumentOffset });
+	}
+
+	void ExecuteIndirect(const CommandSignature& commandSignature, uint32_t maxCommandCount, const Buffer& argumentBuffer, uint64_t argumentOffset = 0,
+						 const Buffer* countBuffer = nullptr, uint64_t countOffset = 0)
+	{
+		Record("ExecuteIndirect", argumentBuffer.GetD3D12Resource().Get(), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, { maxCommandCount, argumentOffset, countBuffer != nullptr, countOffset });
+	}
+
+	void TrackResource(ComPtr<ID3D12Object> object)
+	{
+		mTrackedObjects.push_back(object);
+	}
+
+	void TrackResource(const Resource& res)
+	{
+		TrackResource(res.GetD3D12Resource());
+	}
+
+	const std::vector<Call>& GetCalls() const
+	{
+		return mCalls;
+	}
+
+	std::vector<Call> GetCalls(const std::string& name) const
+	{
+		std::vector<Call> calls;
+		for (const Call& call : mCalls)
+		{
+			if (call.Name == name) calls.push_back(call);
+		}
+		return calls;
+	}
+
+	// Every AllocateDynamicBuffer result with its requested size, in call order.
+	struct DynamicAllocation
+	{
+		UploadBuffer::BasePointer Pointer;
+		size_t Size;
+	};
+
+	const std::vector<DynamicAllocation>& GetDynamicAllocations() const
+	{
+		return mDynamicAllocations;
+	}
+
+	size_t GetTrackedObjectNum() const
+	{
+		return mTrackedObjects.size();
+	}
+
+	void Record(const std::string& name, ID3D12Resource* resource = nullptr, D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON, std::vector<uint64_t> arguments = {})
+	{
+		mCalls.push_back({ name, resource, state, std::move(arguments) });
+	}
+
+private:
+	void CopyBuffer(Buffer& buffer, size_t numElements, size_t elementSize, const void* bufferData)
+	{
+		buffer.CreateViews(numElements, elementSize);
+		buffer.GetData().assign(numElements * elementSize, 0);
+		if (bufferData)
+		{
+			memcpy(buffer.GetData().data(), bufferData, numElements * elementSize);
+		}
+	}
+
+	std::vector<Call> mCalls;
+	std::vector<DynamicAllocation> mDynamicAllocations;
+	UploadBuffer mUploadBuffer;
+	std::vector<ComPtr<ID3D12Object>> mTrackedObjects;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef __COMMANDSIGNATURE_H_
+#define __COMMANDSIGNATURE_H_
+
+#include "Core.h"
+
+class RootSignature;
+
+// Test double for Render/CommandSignature.h.
+class CommandSignature
+{
+public:
+	CommandSignature(const RootSignature& rootSignature, uint32_t objectIndexParameter) : mObjectIndexParameter(objectIndexParameter) {}
+	virtual ~CommandSignature() {}
+
+	uint32_t GetObjectIndexParameter() const
+	{
+		return mObjectIndexParameter;
+	}
+
+private:
+	CommandSignature(const CommandSignature& copy) = delete;
+	CommandSignature& operator=(const CommandSignature& other) = delete;
+
+	uint32_t mObjectIndexParameter;
+};
+
+#endif
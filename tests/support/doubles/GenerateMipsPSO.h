@@ -0,0 +1,26 @@
+#ifndef __GENERATEMIPSPSO_H_
+#define __GENERATEMIPSPSO_H_
+
+#include "Core.h"
+
+// Test double for Render/GenerateMipsPSO.h: no pipeline, only a count of how many were built. The
+// constructor pauses like real pipeline creation, so concurrent first requests overlap.
+class GenerateMipsPSO
+{
+public:
+	GenerateMipsPSO()
+	{
+		++msCreatedNum;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	static uint32_t GetCreatedNum()
+	{
+		return msCreatedNum;
+	}
+
+private:
+	static inline std::atomic_uint32_t msCreatedNum{ 0 };
+};
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef __GEOMETRYARENA_H_
+#define __GEOMETRYARENA_H_
+
+#include "Core.h"
+#include "CommandList.h"
+#include "IndexBuffer.h"
+#include "VertexBuffer.h"
+
+// Test double for Render/GeometryArena.h: one growing CPU pool per element size
+// and index format, so tests can read back what a mesh uploaded.
+class GeometryArena
+{
+public:
+	struct Allocation
+	{
+		uint32_t Pool;
+		uint32_t Offset;
+		uint32_t Count;
+	};
+
+	static const uint32_t InvalidPool = ~0u;
+
+	Allocation AllocateVertices(CommandList& commandList, size_t numVertices, size_t vertexStride, const void* vertexData)
+	{
+		return Allocate(FindPool(vertexStride, DXGI_FORMAT_UNKNOWN), numVertices, vertexData);
+	}
+
+	Allocation AllocateIndices(CommandList& commandList, size_t numIndices, DXGI_FORMAT indexFormat, const void* indexData)
+	{
+		return Allocate(FindPool(indexFormat == DXGI_FORMAT_R16_UINT ? 2 : 4, indexFormat), numIndices, indexData);
+	}
+
+	void Free(const Allocation& allocation)
+	{
+		if (allocation.Pool != InvalidPool)
+		{
+			++mFreeNum;
+		}
+	}
+
+	void SetVertexBuffer(CommandList& commandList, uint32_t slot, const Allocation& allocation) const
+	{
+		commandList.SetVertexBuffer(slot, mPools[allocation.Pool]->Vertices);
+	}
+
+	void SetIndexBuffer(CommandList& commandList, const Allocation& allocation) const
+	{
+		commandList.SetIndexBuffer(mPools[allocation.Pool]->Indices);
+	}
+
+	DXGI_FORMAT GetIndexFormat(const Allocation& allocation) const
+	{
+		return mPools[allocation.Pool]->IndexFormat;
+	}
+
+	const void* GetData(const Allocation& allocation) const
+	{
+		const Pool& pool = *mPools[allocation.Pool];
+		return pool.Data.data() + static_cast<size_t>(allocation.Offset) * pool.ElementSize;
+	}
+
+	uint32_t GetFreeNum() const
+	{
+		return mFreeNum;
+	}
+
+private:
+	struct Pool
+	{
+		VertexBuffer Vertices;
+		IndexBuffer Indices;
+		DXGI_FORMAT IndexFormat;
+		size_t ElementSize;
+		std::vector<uint8_t> Data;
+	};
+
+	uint32_t FindPool(size_t elementSize, DXGI_FORMAT indexFormat)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (uint32_t i = 0; i < mPools.size(); ++i)
+		{
+			if (mPools[i]->ElementSize == elementSize && mPools[i]->IndexFormat == indexFormat)
+			{
+				return i;
+			}
+		}
+
+		mPools.push_back(std::make_unique<Pool>());
+		mPools.back()->IndexFormat = indexFormat;
+		mPools.back()->ElementSize = elementSize;
+		return static_cast<uint32_t>(mPools.size() - 1);
+	}
+
+	Allocation Allocate(uint32_t poolIndex, size_t count, const void* data)
+	{
+		if (count == 0)
+		{
+			return { InvalidPool, 0, 0 };
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		Pool& pool = *mPools[poolIndex];
+		uint32_t offset = static_cast<uint32_t>(pool.Data.size() / pool.ElementSize);
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		pool.Data.insert(pool.Data.end(), bytes, bytes + count * pool.ElementSize);
+
+		size_t poolCount = pool.Data.size() / pool.ElementSize;
+		pool.Vertices.CreateViews(poolCount, pool.ElementSize);
+		pool.Indices.CreateViews(poolCount, pool.ElementSize);
+		return { poolIndex, offset, static_cast<uint32_t>(count) };
+	}
+
+	std::vector<std::unique_ptr<Pool>> mPools;
+	uint32_t mFreeNum = 0;
+	std::mutex mMutex;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef __INDEXBUFFER_H_
+#define __INDEXBUFFER_H_
+
+#include "Core.h"
+#include "Buffer.h"
+
+// Test double for Render/IndexBuffer.h.
+class IndexBuffer : public Buffer
+{
+public:
+	IndexBuffer(const std::wstring& name = L"") : Buffer(name) {}
+
+	virtual void CreateViews(size_t numElements, size_t elementSize) override
+	{
+		Buffer::CreateViews(numElements, elementSize);
+		mIndexFormat = elementSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	}
+
+	size_t GetNumIndicies() const
+	{
+		return mElementNum;
+	}
+
+	DXGI_FORMAT GetIndexFormat() const
+	{
+		return mIndexFormat;
+	}
+
+private:
+	DXGI_FORMAT mIndexFormat = DXGI_FORMAT_UNKNOWN;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __PANOTOCUBEMAPPSO_H_
+#define __PANOTOCUBEMAPPSO_H_
+
+#include "Core.h"
+
+// Test double for Render/PanoToCubemapPSO.h: no pipeline, only a count of how many were built. The
+// constructor pauses like real pipeline creation, so concurrent first requests overlap.
+class PanoToCubemapPSO
+{
+public:
+	PanoToCubemapPSO()
+	{
+		++msCreatedNum;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	static uint32_t GetCreatedNum()
+	{
+		return msCreatedNum;
+	}
+
+private:
+	static inline std::atomic_uint32_t msCreatedNum{ 0 };
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef __RESOURCE_H_
+#define __RESOURCE_H_
+
+#include "Core.h"
+
+// Test double for Render/Resource.h: keeps the D3D12 resource and its name, no views.
+class Resource
+{
+public:
+	explicit Resource(const std::wstring& name = L"") : mResourceName(name) {}
+	explicit Resource(ComPtr<ID3D12Resource> resource, const std::wstring& name = L"") : mResource(resource), mResourceName(name) {}
+	virtual ~Resource() {}
+
+	bool IsValid() const
+	{
+		return (mResource != nullptr);
+	}
+
+	ComPtr<ID3D12Resource> GetD3D12Resource() const
+	{
+		return mResource;
+	}
+
+	D3D12_RESOURCE_DESC GetD3D12ResourceDesc() const
+	{
+		D3D12_RESOURCE_DESC resDesc = {};
+		if (mResource)
+		{
+			resDesc = mResource->GetDesc();
+		}
+		return resDesc;
+	}
+
+	const std::wstring& GetName() const
+	{
+		return mResourceName;
+	}
+
+	virtual void SetResource(ComPtr<ID3D12Resource> resource)
+	{
+		mResource = resource;
+	}
+
+	virtual void Reset()
+	{
+		mResource.Reset();
+	}
+
+protected:
+	ComPtr<ID3D12Resource> mResource;
+	std::wstring mResourceName;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef __RESOURCESTATETRACKER_H_
+#define __RESOURCESTATETRACKER_H_
+
+#include "Core.h"
+
+// Test double for Render/ResourceStateTracker.h: only the global state map.
+class ResourceStateTracker
+{
+public:
+	static void AddGlobalResourceState(ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
+	{
+		GetGlobalResourceStates()[resource] = state;
+	}
+
+	static void RemoveGlobalResourceState(ID3D12Resource* resource)
+	{
+		GetGlobalResourceStates().erase(resource);
+	}
+
+	static std::map<ID3D12Resource*, D3D12_RESOURCE_STATES>& GetGlobalResourceStates()
+	{
+		static std::map<ID3D12Resource*, D3D12_RESOURCE_STATES> states;
+		return states;
+	}
+};
+
+#endif
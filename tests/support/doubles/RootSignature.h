@@ -0,0 +1,14 @@
+#ifndef __ROOTSIGNATURE_H_
+#define __ROOTSIGNATURE_H_
+
+#include "Core.h"
+
+// Test double for Render/RootSignature.h: only its identity matters to the callers under test.
+class RootSignature
+{
+public:
+	RootSignature() {}
+	virtual ~RootSignature() {}
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef __STRUCTUREDBUFFER_H_
+#define __STRUCTUREDBUFFER_H_
+
+#include "Core.h"
+#include "Buffer.h"
+#include "ByteAddressBuffer.h"
+
+// Test double for Render/StructuredBuffer.h.
+class StructuredBuffer : public Buffer
+{
+public:
+	StructuredBuffer(const std::wstring& name = L"") : Buffer(name) {}
+
+	virtual size_t GetNumElements() const
+	{
+		return mElementNum;
+	}
+
+	virtual size_t GetElementSize() const
+	{
+		return mElementSize;
+	}
+};
+
+#endif
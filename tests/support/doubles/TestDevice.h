@@ -0,0 +1,158 @@
+#ifndef __TESTDEVICE_H_
+#define __TESTDEVICE_H_
+
+#include "Core.h"
+
+// In-memory ID3D12Device: buffers get CPU storage that Map returns, textures and
+// heaps only keep their descs. Counts what was created so tests can assert on it.
+class TestResource : public ID3D12Resource
+{
+public:
+	TestResource(const D3D12_RESOURCE_DESC& desc, D3D12_GPU_VIRTUAL_ADDRESS address, ID3D12Heap* heap, uint64_t heapOffset)
+		: mDesc(desc), mAddress(address), mHeap(heap), mHeapOffset(heapOffset)
+	{
+		if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+		{
+			mData.resize(static_cast<size_t>(desc.Width));
+		}
+	}
+
+	HRESULT Map(UINT subresource, const D3D12_RANGE* readRange, void** data) override
+	{
+		if (mData.empty()) return E_FAIL;
+		*data = mData.data();
+		return S_OK;
+	}
+
+	void Unmap(UINT subresource, const D3D12_RANGE* writtenRange) override {}
+
+	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() override
+	{
+		return mAddress;
+	}
+
+	D3D12_RESOURCE_DESC GetDesc() override
+	{
+		return mDesc;
+	}
+
+	ID3D12Heap* GetHeap() const
+	{
+		return mHeap.Get();
+	}
+
+	uint64_t GetHeapOffset() const
+	{
+		return mHeapOffset;
+	}
+
+	std::vector<uint8_t>& GetData()
+	{
+		return mData;
+	}
+
+private:
+	D3D12_RESOURCE_DESC mDesc;
+	D3D12_GPU_VIRTUAL_ADDRESS mAddress;
+	ComPtr<ID3D12Heap> mHeap;
+	uint64_t mHeapOffset;
+	std::vector<uint8_t> mData;
+};
+
+class TestHeap : public ID3D12Heap
+{
+public:
+	explicit TestHeap(const D3D12_HEAP_DESC& desc) : mDesc(desc) {}
+
+	D3D12_HEAP_DESC GetDesc() override
+	{
+		return mDesc;
+	}
+
+private:
+	D3D12_HEAP_DESC mDesc;
+};
+
+class TestDevice : public ID3D12Device2
+{
+public:
+	using AllocationInfoFunction = std::function<D3D12_RESOURCE_ALLOCATION_INFO(const D3D12_RESOURCE_DESC& desc)>;
+
+	struct Statistics
+	{
+		uint32_t CommittedResourceNum;
+		uint32_t HeapNum;
+		uint32_t PlacedResourceNum;
+		uint64_t CommittedBytes;
+	};
+
+	TestDevice() : mNextAddress(0x10000), mStatistics() {}
+
+	HRESULT CreateCommittedResource(const D3D12_HEAP_PROPERTIES* heapProperties, D3D12_HEAP_FLAGS heapFlags, const D3D12_RESOURCE_DESC* desc,
+									D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue, REFIID riid, void** resource) override
+	{
+		*resource = new TestResource(*desc, AllocateAddress(desc->Width), nullptr, 0);
+		++mStatistics.CommittedResourceNum;
+		mStatistics.CommittedBytes += desc->Width;
+		return S_OK;
+	}
+
+	HRESULT CreateHeap(const D3D12_HEAP_DESC* desc, REFIID riid, void** heap) override
+	{
+		*heap = new TestHeap(*desc);
+		++mStatistics.HeapNum;
+		return S_OK;
+	}
+
+	HRESULT CreatePlacedResource(ID3D12Heap* heap, UINT64 heapOffset, const D3D12_RESOURCE_DESC* desc, D3D12_RESOURCE_STATES initialState,
+								 const D3D12_CLEAR_VALUE* clearValue, REFIID riid, void** resource) override
+	{
+		D3D12_RESOURCE_ALLOCATION_INFO info = GetResourceAllocationInfo(0, 1, desc);
+		if (heapOffset % info.Alignment != 0 || heapOffset + info.SizeInBytes > heap->GetDesc().SizeInBytes) return E_FAIL;
+
+		*resource = new TestResource(*desc, 0, heap, heapOffset);
+		++mStatistics.PlacedResourceNum;
+		return S_OK;
+	}
+
+	D3D12_RESOURCE_ALLOCATION_INFO GetResourceAllocationInfo(UINT visibleMask, UINT numResourceDescs, const D3D12_RESOURCE_DESC* resourceDescs) override
+	{
+		if (mAllocationInfo)
+		{
+			return mAllocationInfo(resourceDescs[0]);
+		}
+
+		const D3D12_RESOURCE_DESC& desc = resourceDescs[0];
+		uint64_t size = desc.Width * desc.Height * desc.DepthOrArraySize * 4;
+		return { Math::AlignUp(size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT), D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT };
+	}
+
+	void SetAllocationInfo(const AllocationInfoFunction& allocationInfo)
+	{
+		mAllocationInfo = allocationInfo;
+	}
+
+	const Statistics& GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void ResetStatistics()
+	{
+		mStatistics = {};
+	}
+
+private:
+	D3D12_GPU_VIRTUAL_ADDRESS AllocateAddress(uint64_t size)
+	{
+		D3D12_GPU_VIRTUAL_ADDRESS address = mNextAddress;
+		mNextAddress += Math::AlignUp(size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+		return address;
+	}
+
+	D3D12_GPU_VIRTUAL_ADDRESS mNextAddress;
+	Statistics mStatistics;
+	AllocationInfoFunction mAllocationInfo;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __TEXTURE_H_
+#define __TEXTURE_H_
+
+#include "Core.h"
+#include "Resource.h"
+#include "TextureUsage.h"
+
+// Test double for Render/Texture.h.
+class Texture : public Resource
+{
+public:
+	explicit Texture(TextureUsage textureUsage = TextureUsage::Albedo, const std::wstring& name = L"")
+		: Resource(name), mTextureUsage(textureUsage) {}
+	explicit Texture(ComPtr<ID3D12Resource> resource, TextureUsage textureUsage = TextureUsage::Albedo, const std::wstring& name = L"")
+		: Resource(resource, name), mTextureUsage(textureUsage) {}
+
+	TextureUsage GetTextureUsage() const
+	{
+		return mTextureUsage;
+	}
+
+private:
+	TextureUsage mTextureUsage;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef __UPLOADBUFFER_H_
+#define __UPLOADBUFFER_H_
+
+#include "Core.h"
+
+// Test double for Render/UploadBuffer.h: every allocation is its own heap block.
+// Targets that test the real paging copy Render/UploadBuffer.h, which takes precedence.
+class UploadBuffer
+{
+public:
+	struct BasePointer
+	{
+		void* CPUAddress;
+		D3D12_GPU_VIRTUAL_ADDRESS GPUAddress;
+		ID3D12Resource* Resource;
+		size_t Offset;
+	};
+
+	BasePointer Allocate(size_t allocateSize, size_t alignment)
+	{
+		mAllocations.emplace_back(allocateSize + alignment);
+		uint8_t* cpuAddress = Math::AlignUp(mAllocations.back().data(), alignment);
+		D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = Math::AlignUp(mNextAddress, alignment);
+		mNextAddress = gpuAddress + allocateSize;
+		return { cpuAddress, gpuAddress, nullptr, 0 };
+	}
+
+	void Reset()
+	{
+		mAllocations.clear();
+	}
+
+private:
+	std::deque<std::vector<uint8_t>> mAllocations;
+	D3D12_GPU_VIRTUAL_ADDRESS mNextAddress = 0x10000;
+};
+
+#endif
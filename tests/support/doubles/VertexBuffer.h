@@ -0,0 +1,24 @@
+#ifndef __VERTEXBUFFER_H_
+#define __VERTEXBUFFER_H_
+
+#include "Core.h"
+#include "Buffer.h"
+
+// Test double for Render/VertexBuffer.h.
+class VertexBuffer : public Buffer
+{
+public:
+	VertexBuffer(const std::wstring& name = L"") : Buffer(name) {}
+
+	size_t GetNumVertices() const
+	{
+		return mElementNum;
+	}
+
+	size_t GetVertexStride() const
+	{
+		return mElementSize;
+	}
+};
+
+#endif